@@ -1,13 +1,143 @@
 #include <QtGui/QApplication>
+#include <QStringList>
 #include "mainwindow.h"
 
 #include "FamiTracker.h"
+#include "SoundGen.h"
+#include "RenderBatch.h"
+
+#include <stdio.h>
+
+static CFamiTrackerDoc* loadModule(QString fileName)
+{
+   CMainFrame* pMainFrame;
+   CFamiTrackerDoc* pDoc;
+
+   // CPTODO: this is a hack
+   theApp.InitInstance();
+
+   pMainFrame = (CMainFrame*)theApp.m_pMainWnd;
+   pMainFrame->setFileName(fileName);
+
+   pDoc = (CFamiTrackerDoc*)pMainFrame->GetActiveDocument();
+   if ( !pDoc->IsFileLoaded() )
+   {
+      fprintf(stderr,"famitracker: could not load %s\n",fileName.toAscii().constData());
+      return NULL;
+   }
+   return pDoc;
+}
+
+// famitracker --render <module.ftm> <file.wav> [track] [loops]
+// renders a track of a module to a WAV file and quits.
+static int renderToWAV(QStringList args)
+{
+   CFamiTrackerDoc* pDoc;
+   int track = 0;
+   int loops = 1;
+   bool rendered;
+
+   if ( args.count() > 4 )
+   {
+      track = args.at(4).toInt();
+   }
+   if ( args.count() > 5 )
+   {
+      loops = args.at(5).toInt();
+   }
+
+   pDoc = loadModule(args.at(2));
+   if ( !pDoc )
+   {
+      theApp.ExitInstance();
+      return 1;
+   }
+
+   CSoundGen* pRenderer = new CSoundGen(pDoc);
+   rendered = pRenderer->RenderToFile((TCHAR*)args.at(3).toAscii().constData(),track,SONG_LOOP_LIMIT,loops);
+   delete pRenderer;
+
+   if ( !rendered )
+   {
+      fprintf(stderr,"famitracker: could not render track %d to %s\n",track,args.at(3).toAscii().constData());
+   }
+
+   theApp.ExitInstance();
+
+   return rendered ? 0 : 1;
+}
+
+// famitracker --render-all <module.ftm> <prefix> [loops]
+// renders every track of a module to <prefix>-<track>.wav on a thread pool.
+// famitracker --verify-render <module.ftm> [loops]
+// renders every track one after another and on the thread pool and checks
+// that both give the same WAV data.
+static int renderAll(QStringList args,bool verify)
+{
+   CFamiTrackerDoc* pDoc;
+   std::vector<stRenderJob> jobs;
+   int loops = 1;
+   bool ok;
+
+   if ( args.count() > (verify ? 3 : 4) )
+   {
+      loops = args.at(verify ? 3 : 4).toInt();
+   }
+
+   pDoc = loadModule(args.at(2));
+   if ( !pDoc )
+   {
+      theApp.ExitInstance();
+      return 1;
+   }
+
+   if ( verify )
+   {
+      ok = CRenderBatch::Verify(pDoc,SONG_LOOP_LIMIT,loops);
+      fprintf(stderr,"famitracker: sequential and parallel renders %s\n",ok ? "match" : "differ");
+   }
+   else
+   {
+      for ( unsigned int track = 0; track < pDoc->GetTrackCount(); track++ )
+      {
+         stRenderJob job;
+         job.Track = track;
+         job.File = QString("%1-%2.wav").arg(args.at(3)).arg(track);
+         job.Rendered = false;
+         jobs.push_back(job);
+      }
+
+      ok = CRenderBatch::Render(pDoc,jobs,SONG_LOOP_LIMIT,loops);
+      if ( !ok )
+      {
+         fprintf(stderr,"famitracker: could not render every track\n");
+      }
+   }
+
+   theApp.ExitInstance();
+
+   return ok ? 0 : 1;
+}
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    if ( (a.arguments().count() > 3) && (a.arguments().at(1) == "--render") )
+    {
+       return renderToWAV(a.arguments());
+    }
+    if ( (a.arguments().count() > 3) && (a.arguments().at(1) == "--render-all") )
+    {
+       return renderAll(a.arguments(),false);
+    }
+    if ( (a.arguments().count() > 2) && (a.arguments().at(1) == "--verify-render") )
+    {
+       return renderAll(a.arguments(),true);
+    }
+
     MainWindow w;
-    
+
     w.show();
 
     return a.exec();
@@ -0,0 +1,505 @@
+//    NESICIDE - an IDE for the 8-bit NES.
+//    Copyright (C) 2009  Christopher S. Pow
+
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <QMessageBox>
+#include <QFile>
+#include <QDir>
+#include <QTime>
+
+#include "c64builtinemulatorthread.h"
+
+#include "c64_emulator_core.h"
+
+#include "ccc65interface.h"
+
+#include "emulatorprefsdialog.h"
+#include "environmentsettingsdialog.h"
+#include "cobjectregistry.h"
+#include "breakpointwatcherthread.h"
+#include "main.h"
+
+// Frames the KERNAL needs to get from reset to the BASIC ready prompt.
+#define C64_BOOT_FRAMES 150
+
+// One PAL frame.
+#define C64_FRAME_MS    20
+
+QSemaphore c64BreakpointSemaphore(0);
+
+// Hook function endpoints.
+static void breakpointHook ( void )
+{
+   // Tell the world.
+   C64BuiltInEmulatorThread* emulator = dynamic_cast<C64BuiltInEmulatorThread*>(CObjectRegistry::getObject("Emulator"));
+   emulator->_breakpointHook();
+
+   // Put my thread to sleep.
+   c64BreakpointSemaphore.acquire();
+}
+
+void C64BuiltInEmulatorThread::_breakpointHook()
+{
+   emit breakpoint();
+}
+
+C64BuiltInEmulatorThread::C64BuiltInEmulatorThread(QObject*)
+{
+   int32_t i;
+
+   m_joy [ 0 ] = 0;
+   m_joy [ 1 ] = 0;
+   m_isStarting = false;
+   m_isRunning = false;
+   m_isPaused = false;
+   m_showOnPause = false;
+   m_isResetting = false;
+   m_isTerminating = false;
+   m_isPrimed = false;
+   m_debugFrame = 0;
+
+   // Clear image to set alpha channel...
+   m_tv = new int8_t [ C64_VISIBLE_X*C64_VISIBLE_Y*4 ];
+   for ( i = 0; i < C64_VISIBLE_X*C64_VISIBLE_Y*4; i+=4 )
+   {
+      m_tv[i] = 0;
+      m_tv[i+1] = 0;
+      m_tv[i+2] = 0;
+      m_tv[i+3] = 0xFF;
+   }
+   c64SetTVOut(m_tv);
+
+   if ( !loadROMs() )
+   {
+      QMessageBox::warning(0,"C64 ROMs not found!","The Commodore 64 kernal, BASIC and character ROM images could not be read.\n"
+                           "Please set the paths to them in NESICIDE's Emulator Preferences dialog.");
+   }
+
+   // Enable callbacks from the external emulator library.
+   c64SetBreakpointHook(breakpointHook);
+
+   BreakpointWatcherThread* breakpointWatcher = dynamic_cast<BreakpointWatcherThread*>(CObjectRegistry::getObject("Breakpoint Watcher"));
+   QObject::connect(this,SIGNAL(breakpoint()),breakpointWatcher,SLOT(breakpoint()));
+}
+
+C64BuiltInEmulatorThread::~C64BuiltInEmulatorThread()
+{
+   c64SetTVOut(NULL);
+   delete [] m_tv;
+}
+
+bool C64BuiltInEmulatorThread::loadROMs()
+{
+   QFile kernal(EmulatorPrefsDialog::getC64KernalROM());
+   QFile basic(EmulatorPrefsDialog::getC64BasicROM());
+   QFile chargen(EmulatorPrefsDialog::getC64CharROM());
+   QByteArray data;
+   bool ok = true;
+
+   // Short images are padded so the library always has a whole ROM to copy.
+   if ( kernal.open(QIODevice::ReadOnly) )
+   {
+      data = kernal.read(MEM_8KB);
+      data.append(QByteArray(MEM_8KB-data.size(),0));
+      c64SetKernalROM((uint8_t*)data.data());
+      kernal.close();
+   }
+   else
+   {
+      ok = false;
+   }
+   if ( basic.open(QIODevice::ReadOnly) )
+   {
+      data = basic.read(MEM_8KB);
+      data.append(QByteArray(MEM_8KB-data.size(),0));
+      c64SetBasicROM((uint8_t*)data.data());
+      basic.close();
+   }
+   else
+   {
+      ok = false;
+   }
+   if ( chargen.open(QIODevice::ReadOnly) )
+   {
+      data = chargen.read(MEM_4KB);
+      data.append(QByteArray(MEM_4KB-data.size(),0));
+      c64SetCharROM((uint8_t*)data.data());
+      chargen.close();
+   }
+   else
+   {
+      ok = false;
+   }
+
+   return ok;
+}
+
+void C64BuiltInEmulatorThread::kill()
+{
+   // Force hard-reset of the machine...
+   c64EnableBreakpoints(false);
+
+   m_isStarting = false;
+   m_isRunning = false;
+   m_isPaused = false;
+   m_showOnPause = false;
+   m_isTerminating = true;
+
+   start();
+
+   while ( !isFinished() )
+   {
+      c64BreakpointSemaphore.release();
+   }
+}
+
+void C64BuiltInEmulatorThread::breakpointsChanged()
+{
+   // unused, the library checks its breakpoint database as it runs.
+}
+
+void C64BuiltInEmulatorThread::resume()
+{
+   // If during the last run we were stopped at a breakpoint, clear it...
+   if ( !(c64BreakpointSemaphore.available()) )
+   {
+      c64BreakpointSemaphore.release();
+   }
+   start();
+}
+
+void C64BuiltInEmulatorThread::primeEmulator()
+{
+   if ( nesicideProject->isInitialized() )
+   {
+      m_isPrimed = true;
+   }
+}
+
+void C64BuiltInEmulatorThread::resetEmulator()
+{
+   // Force hard-reset of the machine...
+   c64EnableBreakpoints(false);
+
+   m_isResetting = true;
+   m_isStarting = false;
+   m_isRunning = false;
+   m_isPaused = true;
+   m_showOnPause = false;
+
+   resume();
+}
+
+void C64BuiltInEmulatorThread::startEmulation ()
+{
+   m_isStarting = true;
+
+   resume();
+}
+
+void C64BuiltInEmulatorThread::pauseEmulation (bool show)
+{
+   m_isStarting = false;
+   m_isRunning = false;
+   m_isPaused = true;
+   m_showOnPause = show;
+   start();
+}
+
+void C64BuiltInEmulatorThread::stepCPUEmulation ()
+{
+   uint32_t endAddr;
+   uint32_t addr;
+   uint32_t absAddr;
+
+   // Check if we have an end address to stop at from a debug information file.
+   // If we do, it'll be the valid end of a C statement or an assembly instruction.
+   addr = c64GetCPURegister(CPU_PC);
+   absAddr = c64GetAbsoluteAddressFromAddress(addr);
+   endAddr = CCC65Interface::getEndAddressFromAbsoluteAddress(addr,absAddr);
+
+   if ( endAddr != 0xFFFFFFFF )
+   {
+      c64SetGotoAddress(endAddr);
+   }
+   else
+   {
+      // Ensure we come right back...
+      c64StepCpu();
+   }
+
+   m_isStarting = true;
+   m_isPaused = false;
+
+   resume();
+}
+
+void C64BuiltInEmulatorThread::stepOverCPUEmulation ()
+{
+   uint32_t endAddr;
+   uint32_t addr;
+   uint32_t absAddr;
+   uint32_t instAbsAddr;
+   bool    isInstr;
+   uint8_t instr;
+
+   // Check if we have an end address to stop at from a debug information file.
+   // If we do, it'll be the valid end of a C statement or an assembly instruction.
+   addr = c64GetCPURegister(CPU_PC);
+   absAddr = c64GetAbsoluteAddressFromAddress(addr);
+   endAddr = CCC65Interface::getEndAddressFromAbsoluteAddress(addr,absAddr);
+
+   if ( endAddr != 0xFFFFFFFF )
+   {
+      // If the line has enough of an assembly-stream associated with it...
+      if ( endAddr-addr >= 2 )
+      {
+         // Check if last instruction on line is JSR...
+         // This is fairly typical of if conditions with function calls on the same line.
+         instr = c64GetMemory(endAddr-2);
+         instAbsAddr = c64GetAbsoluteAddressFromAddress(endAddr-2);
+         isInstr = CCC65Interface::isAbsoluteAddressAnOpcode(instAbsAddr);
+         if ( !isInstr )
+         {
+            instr = c64GetMemory(addr);
+         }
+      }
+      else
+      {
+         instr = c64GetMemory(addr);
+      }
+   }
+   else
+   {
+      // Check if the current instruction is a JSR...
+      instr = c64GetMemory(addr);
+
+      // Assume the instruction is JSR for loop below.
+      endAddr = addr+2;
+   }
+
+   // If the current instruction is a JSR we need to tell the emulator to
+   // go to the PC one past the JSR to 'step over' the JSR.
+   if ( instr == JSR_ABSOLUTE )
+   {
+      // Go to next opcode point in memory.
+      // This *should* be where the JSR will vector back to on RTS.
+      c64SetGotoAddress(endAddr+1);
+
+      m_isStarting = true;
+      m_isPaused = false;
+
+      resume();
+   }
+   else
+   {
+      stepCPUEmulation();
+   }
+}
+
+void C64BuiltInEmulatorThread::stepOutCPUEmulation ()
+{
+   // The return address is the word above the stack pointer, less one.
+   uint32_t sp = c64GetCPURegister(CPU_SP);
+   uint32_t addr = MAKE16(c64GetMemory(0x100+((sp+1)&0xFF)),c64GetMemory(0x100+((sp+2)&0xFF)));
+
+   c64SetGotoAddress(addr+1);
+
+   m_isStarting = true;
+   m_isPaused = false;
+
+   resume();
+}
+
+void C64BuiltInEmulatorThread::loadProgram()
+{
+   QDir dirProject(nesicideProject->getProjectOutputBasePath());
+   QString fileName = dirProject.toNativeSeparators(dirProject.absoluteFilePath(nesicideProject->getProjectLinkerOutputName()));
+   QFile file(fileName);
+   QByteArray data;
+   int32_t loadAddr;
+   int32_t a;
+
+   // Only programs can be put in memory, the library has no disk drive.
+   if ( !(fileName.endsWith(".c64",Qt::CaseInsensitive) ||
+          fileName.endsWith(".prg",Qt::CaseInsensitive)) )
+   {
+      return;
+   }
+
+   if ( file.open(QIODevice::ReadOnly) )
+   {
+      data = file.readAll();
+      file.close();
+   }
+
+   // Put the program where its load address says, as "load" does.
+   if ( c64LoadPRG((uint8_t*)data.data(),data.size()) )
+   {
+      loadAddr = CCC65Interface::getSegmentBase("STARTUP");
+      if ( loadAddr > 0 )
+      {
+         c64SetCPURegister(CPU_PC,loadAddr);
+      }
+   }
+
+   c64ClearOpcodeMasks();
+
+   // Update opcode masks to show proper disassembly...
+   for ( a = 0; a < MEM_64KB; a++ )
+   {
+      if ( CCC65Interface::isAbsoluteAddressAnOpcode(a) )
+      {
+         c64SetOpcodeMask(a,1);
+      }
+      else
+      {
+         c64SetOpcodeMask(a,0);
+      }
+   }
+}
+
+void C64BuiltInEmulatorThread::run ()
+{
+   QTime frameTime;
+   int32_t frame;
+   int32_t elapsed;
+   int32_t debuggerUpdateRate = EnvironmentSettingsDialog::debuggerUpdateRate();
+
+   // Special case for 1Hz debugger update to match system mode.
+   if ( debuggerUpdateRate == -1 )
+   {
+      debuggerUpdateRate = 50;
+   }
+
+   while ( m_isStarting || m_isRunning || m_isResetting || m_isPaused )
+   {
+      // Allow thread exit...
+      if ( m_isTerminating )
+      {
+         break;
+      }
+
+      // Allow thread to keep going...
+      if ( m_isStarting )
+      {
+         m_isStarting = false;
+         m_isRunning = true;
+         m_isPaused = false;
+
+         // Re-enable breakpoints that were previously enabled...
+         c64EnableBreakpoints(true);
+
+         // Trigger UI updates...
+         emit emulatorStarted();
+      }
+
+      // Properly coordinate C=64 reset with emulator...
+      if ( m_isResetting )
+      {
+         m_joy [ 0 ] = 0;
+         m_joy [ 1 ] = 0;
+
+         c64Reset();
+
+         // Let the KERNAL boot to the BASIC ready prompt before the
+         // program goes in, breakpoints are still off.
+         for ( frame = 0; frame < C64_BOOT_FRAMES; frame++ )
+         {
+            c64Run(m_joy);
+         }
+         c64ClearAudioSamplesAvailable();
+
+         if ( m_isPrimed )
+         {
+            loadProgram();
+            m_isPrimed = false;
+         }
+
+         // Re-enable breakpoints that were previously enabled...
+         c64EnableBreakpoints(true);
+
+         // Trigger inspector updates...
+         c64Disassemble();
+         emit machineReady();
+         emit updateDebuggers();
+         emit emulatedFrame();
+
+         // Trigger UI updates...
+         emit emulatorReset();
+
+         // Don't *keep* resetting...
+         m_isResetting = false;
+      }
+
+      // Pause?
+      if ( m_isPaused )
+      {
+         // Trigger inspector updates...
+         c64Disassemble();
+         emit updateDebuggers();
+
+         // Trigger UI updates...
+         emit emulatorPaused(m_showOnPause);
+
+         m_isPaused = false;
+         m_isRunning = false;
+
+         c64Break();
+      }
+
+      // Run the C=64...
+      if ( m_isRunning )
+      {
+         frameTime.start();
+
+         // Re-enable breakpoints that were previously enabled...
+         c64EnableBreakpoints(true);
+
+         // Make sure breakpoint semaphore is on the precipice...
+         c64BreakpointSemaphore.tryAcquire();
+
+         // Run emulator for one frame...
+         c64Run(m_joy);
+
+         // There's no audio output, don't let the samples pile up.
+         c64ClearAudioSamplesAvailable();
+
+         emit emulatedFrame();
+
+         if ( m_debugFrame )
+         {
+            m_debugFrame--;
+         }
+         if ( (!m_debugFrame) && (debuggerUpdateRate) )
+         {
+            m_debugFrame = debuggerUpdateRate;
+            if ( c64IsDebuggable() )
+            {
+               emit updateDebuggers();
+            }
+         }
+
+         // Keep to the speed of the real thing.
+         elapsed = frameTime.elapsed();
+         if ( elapsed < C64_FRAME_MS )
+         {
+            msleep(C64_FRAME_MS-elapsed);
+         }
+      }
+   }
+
+   return;
+}
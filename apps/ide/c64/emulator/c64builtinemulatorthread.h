@@ -0,0 +1,65 @@
+#ifndef C64BUILTINEMULATORTHREAD_H
+#define C64BUILTINEMULATORTHREAD_H
+
+#include <QThread>
+#include <QSemaphore>
+
+#include "c64_emulator_core.h"
+
+// Runs the C=64 in the emulator library instead of VICE.  It answers to
+// the same signals and slots as C64EmulatorThread, so the emulator
+// control, breakpoints and inspectors work with either of them.
+class C64BuiltInEmulatorThread : public QThread
+{
+   Q_OBJECT
+public:
+   C64BuiltInEmulatorThread ( QObject* parent = 0 );
+   virtual ~C64BuiltInEmulatorThread ();
+   void kill();
+
+   void _breakpointHook();
+
+   int8_t* tvOut() { return m_tv; }
+
+public slots:
+   void breakpointsChanged();
+   void primeEmulator ();
+   void resetEmulator ();
+   void startEmulation ();
+   void pauseEmulation (bool show);
+   void pauseEmulationAfter (int32_t /*frames*/) {}
+   void stepCPUEmulation ();
+   void stepOverCPUEmulation ();
+   void stepOutCPUEmulation ();
+
+signals:
+   void breakpoint();
+   void emulatedFrame();
+   void updateDebuggers();
+   void emulatorPaused(bool show);
+   void emulatorPausedAfter();
+   void emulatorReset();
+   void emulatorStarted();
+   void machineReady();
+   void emulatorWantsExit();
+
+protected:
+   virtual void run ();
+   bool loadROMs();
+   void loadProgram();
+   void resume();
+
+   int8_t*     m_tv;
+   uint32_t    m_joy [ 2 ];
+
+   bool        m_isStarting;
+   bool        m_isRunning;
+   bool        m_isPaused;
+   bool        m_showOnPause;
+   bool        m_isResetting;
+   bool        m_isTerminating;
+   bool        m_isPrimed;
+   int32_t     m_debugFrame;
+};
+
+#endif // C64BUILTINEMULATORTHREAD_H
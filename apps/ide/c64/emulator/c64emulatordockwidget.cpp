@@ -0,0 +1,34 @@
+#include "c64emulatordockwidget.h"
+
+#include <QImage>
+#include <QPixmap>
+
+#include "c64_emulator_core.h"
+
+C64EmulatorDockWidget::C64EmulatorDockWidget(int8_t* tv,QWidget *parent) :
+    QDockWidget(parent),
+    m_tv(tv)
+{
+   setObjectName("c64Emulator");
+   setWindowTitle("Emulator");
+
+   m_display = new QLabel(this);
+   m_display->setScaledContents(true);
+   m_display->setMinimumSize(C64_VISIBLE_X,C64_VISIBLE_Y);
+   setWidget(m_display);
+
+   renderData();
+}
+
+C64EmulatorDockWidget::~C64EmulatorDockWidget()
+{
+   delete m_display;
+}
+
+void C64EmulatorDockWidget::renderData()
+{
+   // The library writes R,G,B,A bytes, a little-endian RGB32 pixel is B,G,R,A.
+   QImage image((const uchar*)m_tv,C64_VISIBLE_X,C64_VISIBLE_Y,QImage::Format_RGB32);
+
+   m_display->setPixmap(QPixmap::fromImage(image.rgbSwapped()));
+}
@@ -0,0 +1,26 @@
+#ifndef C64EMULATORDOCKWIDGET_H
+#define C64EMULATORDOCKWIDGET_H
+
+#include <QDockWidget>
+#include <QLabel>
+
+#include <stdint.h>
+
+// Shows the picture of the built-in C=64 emulator.
+class C64EmulatorDockWidget : public QDockWidget
+{
+   Q_OBJECT
+
+public:
+   explicit C64EmulatorDockWidget(int8_t* tv,QWidget *parent = 0);
+   virtual ~C64EmulatorDockWidget();
+
+public slots:
+   void renderData();
+
+private:
+   int8_t* m_tv;
+   QLabel* m_display;
+};
+
+#endif // C64EMULATORDOCKWIDGET_H
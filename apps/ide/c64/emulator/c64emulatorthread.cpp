@@ -14,9 +14,8 @@
 //    You should have received a copy of the GNU General Public License
 //    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
-#include <QRegExp>
 #include <QMessageBox>
-#include <QVector>
+#include <QFile>
 
 #include <cdockwidgetregistry.h>
 
@@ -48,9 +47,9 @@ C64EmulatorThread::C64EmulatorThread(QObject*)
    QString viceStartup;
 
    viceStartup = dir.toNativeSeparators(dir.absoluteFilePath("x64sc"));
-   viceStartup += " -remotemonitor ";
+   viceStartup += " -binarymonitor ";
 
-   viceStartup += " -remotemonitoraddress ip4://127.0.0.1:";
+   viceStartup += " -binarymonitoraddress ip4://127.0.0.1:";
    viceStartup += QString::number(EmulatorPrefsDialog::getVICEMonitorPort());
 
    // Point to the kernal, BASIC, and character ROMs specified.
@@ -75,15 +74,30 @@ C64EmulatorThread::C64EmulatorThread(QObject*)
    // Enable breakpoint callbacks from the external emulator library.
    c64SetBreakpointHook(breakpointHook);
 
-   m_requestMutex = new QMutex();
+   m_pMonitor = NULL;
+   m_requestId = 0;
+   m_checkpointBatch = 0;
+   m_breakpointHit = false;
+   m_bankBits = 0;
+   m_resetPending = false;
+   m_loadPending = false;
+   m_loadCheckpoint = 0;
+   m_loadAddr = 0;
+   m_showOnPause = false;
+
+   // VICE's usual 6502 register IDs, until it tells us otherwise.
+   m_registerIds.insert(0,CPU_A);
+   m_registerIds.insert(1,CPU_X);
+   m_registerIds.insert(2,CPU_Y);
+   m_registerIds.insert(3,CPU_PC);
+   m_registerIds.insert(4,CPU_SP);
+   m_registerIds.insert(5,CPU_F);
 
    m_isRunning = false;
 }
 
 C64EmulatorThread::~C64EmulatorThread()
 {
-   delete m_requestMutex;
-
    QObject::disconnect(m_pViceApp,SIGNAL(error(QProcess::ProcessError)),this,SLOT(viceError(QProcess::ProcessError)));
    QObject::disconnect(m_pViceApp,SIGNAL(finished(int,QProcess::ExitStatus)),this,SLOT(viceFinished(int,QProcess::ExitStatus)));
 
@@ -102,14 +116,19 @@ void C64EmulatorThread::viceStarted()
 //   m_pViceApp->closeReadChannel(QProcess::StandardOutput);
 //   m_pViceApp->closeWriteChannel();
 
-   m_pClient = new TcpClient(EmulatorPrefsDialog::getVICEIPAddress(),EmulatorPrefsDialog::getVICEMonitorPort());
-   m_pClient->moveToThread(this);
+   m_pMonitor = new CViceBinaryMonitor(EmulatorPrefsDialog::getVICEIPAddress(),EmulatorPrefsDialog::getVICEMonitorPort());
+   m_pMonitor->moveToThread(this);
+
+   QObject::connect(m_pMonitor,SIGNAL(response(uint,int,int,QByteArray)),this,SLOT(processResponse(uint,int,int,QByteArray)));
+   QObject::connect(this,SIGNAL(sendCommand(uint,int,QByteArray)),m_pMonitor,SLOT(sendCommand(uint,int,QByteArray)));
+   QObject::connect(m_pMonitor,SIGNAL(monitorConnected()),this,SIGNAL(emulatorConnected()));
+   QObject::connect(m_pMonitor,SIGNAL(monitorDisconnected()),this,SIGNAL(emulatorDisconnected()));
+   QObject::connect(m_pMonitor,SIGNAL(monitorError(QString)),this,SLOT(monitorError(QString)));
 
-   QObject::connect(m_pClient,SIGNAL(responses(QStringList,QStringList)),this,SLOT(processResponses(QStringList,QStringList)));
-   QObject::connect(this,SIGNAL(sendRequests(QStringList,QList<int>)),m_pClient,SLOT(sendRequests(QStringList,QList<int>)));
-   QObject::connect(m_pClient,SIGNAL(traps(QString)),this,SLOT(processTraps(QString)));
-   QObject::connect(m_pClient,SIGNAL(clientConnected()),this,SIGNAL(emulatorConnected()));
-   QObject::connect(m_pClient,SIGNAL(clientDisconnected()),this,SIGNAL(emulatorDisconnected()));
+   // Find out what VICE calls the registers; sent once the connection is up.
+   QByteArray body;
+   CViceBinaryMonitor::appendU8(body,VICE_MEMSPACE_MAIN);
+   command(VICE_CMD_REGISTERS_AVAILABLE,body);
 
    qDebug("VICE started, starting thread.");
 
@@ -151,9 +170,9 @@ void C64EmulatorThread::viceError(QProcess::ProcessError error)
 
       dir.setPath(EmulatorPrefsDialog::getVICEExecutable());
       viceStartup = dir.toNativeSeparators(dir.absoluteFilePath("x64sc"));
-      viceStartup += " -remotemonitor ";
+      viceStartup += " -binarymonitor ";
 
-      viceStartup += " -remotemonitoraddress ip4://127.0.0.1:";
+      viceStartup += " -binarymonitoraddress ip4://127.0.0.1:";
       viceStartup += QString::number(EmulatorPrefsDialog::getVICEMonitorPort());
 
       // Point to the kernal, BASIC, and character ROMs specified.
@@ -196,9 +215,9 @@ void C64EmulatorThread::viceFinished(int /*exitCode*/,QProcess::ExitStatus /*exi
 
       dir.setPath(EmulatorPrefsDialog::getVICEExecutable());
       viceStartup = dir.toNativeSeparators(dir.absoluteFilePath("x64sc"));
-      viceStartup += " -remotemonitor ";
+      viceStartup += " -binarymonitor ";
 
-      viceStartup += " -remotemonitoraddress ip4://127.0.0.1:";
+      viceStartup += " -binarymonitoraddress ip4://127.0.0.1:";
       viceStartup += QString::number(EmulatorPrefsDialog::getVICEMonitorPort());
 
       // Point to the kernal, BASIC, and character ROMs specified.
@@ -225,11 +244,8 @@ void C64EmulatorThread::viceFinished(int /*exitCode*/,QProcess::ExitStatus /*exi
 
 void C64EmulatorThread::kill()
 {
-   lockRequestQueue();
-   clearRequestQueue();
-   addToRequestQueue("until $ffff",false); // using "exit" doesn't seem to work.
-   runRequestQueue();
-   unlockRequestQueue();
+   // Leave VICE running on its own.
+   command(VICE_CMD_EXIT);
 
    // Force hard-reset of the machine...
    c64EnableBreakpoints(false);
@@ -238,19 +254,87 @@ void C64EmulatorThread::kill()
    exit();
 }
 
+uint32_t C64EmulatorThread::command(int command,QByteArray body)
+{
+   uint32_t requestId = m_requestId;
+
+   m_requestId++;
+   if ( m_requestId == VICE_EVENT_ID )
+   {
+      m_requestId = 0;
+   }
+
+   emit sendCommand(requestId,command,body);
+
+   return requestId;
+}
+
 void C64EmulatorThread::breakpointsChanged()
 {
-   lockRequestQueue();
-   clearRequestQueue();
-   addToRequestQueue("break",true); // Get/update breakpoints on emulated machine.
+   syncBreakpoints();
 
    // If the emulator is running, restart it after this interruption.
    if ( m_isRunning )
    {
-      addToRequestQueue("until $ffff",false);
+      command(VICE_CMD_EXIT);
+   }
+}
+
+void C64EmulatorThread::syncBreakpoints()
+{
+   CBreakpointInfo* pBreakpoints = c64GetBreakpointDatabase();
+   QByteArray body;
+   uint8_t op;
+   int bp;
+
+   // Delete all checkpoints...
+   foreach ( uint32_t number, m_checkpoints.keys() )
+   {
+      body.clear();
+      CViceBinaryMonitor::appendU32(body,number);
+      command(VICE_CMD_CHECKPOINT_DELETE,body);
+   }
+   m_checkpoints.clear();
+
+   // Add all enabled breakpoints...
+   m_checkpointBatch = m_requestId;
+   for ( bp = 0; bp < pBreakpoints->GetNumBreakpoints(); bp++ )
+   {
+      BreakpointInfo* pBreakpoint = pBreakpoints->GetBreakpoint(bp);
+
+      if ( pBreakpoint->enabled )
+      {
+         if ( pBreakpoint->type == eBreakOnCPUExecution )
+         {
+            op = VICE_CHECKPOINT_EXEC;
+         }
+         else if ( pBreakpoint->type == eBreakOnCPUMemoryAccess )
+         {
+            op = VICE_CHECKPOINT_LOAD|VICE_CHECKPOINT_STORE;
+         }
+         else if ( pBreakpoint->type == eBreakOnCPUMemoryRead )
+         {
+            op = VICE_CHECKPOINT_LOAD;
+         }
+         else if ( pBreakpoint->type == eBreakOnCPUMemoryWrite )
+         {
+            op = VICE_CHECKPOINT_STORE;
+         }
+         else
+         {
+            continue;
+         }
+
+         body.clear();
+         CViceBinaryMonitor::appendU16(body,pBreakpoint->item1);
+         CViceBinaryMonitor::appendU16(body,pBreakpoint->item2);
+         CViceBinaryMonitor::appendU8(body,1); // stop when hit
+         CViceBinaryMonitor::appendU8(body,1); // enabled
+         CViceBinaryMonitor::appendU8(body,op);
+         CViceBinaryMonitor::appendU8(body,0); // not temporary
+         m_checkpointRequests.insert(command(VICE_CMD_CHECKPOINT_SET,body),bp);
+      }
    }
-   runRequestQueue();
-   unlockRequestQueue();
 }
 
 void C64EmulatorThread::primeEmulator()
@@ -267,47 +351,101 @@ void C64EmulatorThread::resetEmulator()
    {
       QDir dirProject(nesicideProject->getProjectOutputBasePath());
       QString fileName = dirProject.toNativeSeparators(dirProject.absoluteFilePath(nesicideProject->getProjectLinkerOutputName()));
-      QString request;
-      int addr;
+      QByteArray body;
 
       if ( fileName.endsWith(".c64",Qt::CaseInsensitive) ||
            fileName.endsWith(".prg",Qt::CaseInsensitive) )
       {
-         addr = CCC65Interface::getSegmentBase("STARTUP");
-
-         lockRequestQueue();
-         clearRequestQueue();
-         addToRequestQueue("until $a474",false);
-         addToRequestQueue("reset",true);
-         if ( addr > 0 )
-         {
-            request = "load \"" + fileName + "\" 0";
-            addToRequestQueue(request.toAscii(),true);
-            request = "r pc = $" + QString::number(addr,16);
-            addToRequestQueue(request,false);
-            addToRequestQueue("r",true);
-            addToRequestQueue("io",true);
-            addToRequestQueue("m $0 $cfff",true);
-            addToRequestQueue("break",true);
-         }
-         runRequestQueue();
-         unlockRequestQueue();
+         m_loadAddr = CCC65Interface::getSegmentBase("STARTUP");
+         m_loadFile = (m_loadAddr > 0) ? fileName : QString();
       }
       else if ( fileName.endsWith(".d64",Qt::CaseInsensitive) )
       {
-         lockRequestQueue();
-         clearRequestQueue();
-         addToRequestQueue("until $a474",false);
-         addToRequestQueue("reset",true);
-         request = "autostart \"" + fileName + "\"";
-         addToRequestQueue(request.toAscii(),true);
-         addToRequestQueue("r",true);
-         addToRequestQueue("io",true);
-         addToRequestQueue("m $0 $cfff",true);
-         addToRequestQueue("break",true);
-         runRequestQueue();
-         unlockRequestQueue();
+         m_loadFile = fileName;
+      }
+      else
+      {
+         return;
+      }
+
+      m_isRunning = false;
+      m_resetPending = true;
+      m_loadPending = false;
+
+      // Run to the BASIC ready prompt after the reset.
+      CViceBinaryMonitor::appendU16(body,0xa474);
+      CViceBinaryMonitor::appendU16(body,0xa474);
+      CViceBinaryMonitor::appendU8(body,1); // stop when hit
+      CViceBinaryMonitor::appendU8(body,1); // enabled
+      CViceBinaryMonitor::appendU8(body,VICE_CHECKPOINT_EXEC);
+      CViceBinaryMonitor::appendU8(body,1); // temporary
+      m_checkpointRequests.insert(command(VICE_CMD_CHECKPOINT_SET,body),-1);
+
+      body.clear();
+      CViceBinaryMonitor::appendU8(body,VICE_RESET_SOFT);
+      command(VICE_CMD_RESET,body);
+
+      m_dirtyPages.markAll();
+      command(VICE_CMD_EXIT);
+   }
+}
+
+void C64EmulatorThread::loadProgram()
+{
+   QByteArray body;
+   QByteArray data;
+   QFile file(m_loadFile);
+   uint32_t start;
+   uint32_t end;
+
+   if ( m_loadFile.isEmpty() )
+   {
+      syncMachineState(SyncPaused);
+   }
+   else if ( m_loadFile.endsWith(".d64",Qt::CaseInsensitive) )
+   {
+      CViceBinaryMonitor::appendU8(body,1); // run after loading
+      CViceBinaryMonitor::appendU16(body,0); // first file on the disk
+      CViceBinaryMonitor::appendU8(body,m_loadFile.toLocal8Bit().size());
+      body.append(m_loadFile.toLocal8Bit());
+      command(VICE_CMD_AUTOSTART,body);
+
+      syncBreakpoints();
+      syncMachineState(SyncPaused);
+   }
+   else
+   {
+      // Put the program where its load address says, as "load" does.
+      if ( file.open(QIODevice::ReadOnly) )
+      {
+         data = file.readAll();
+         file.close();
+      }
+      if ( data.size() > 2 )
+      {
+         start = CViceBinaryMonitor::getU16(data,0);
+         end = qMin(start+data.size()-3,(uint32_t)MEM_64KB-1);
+
+         CViceBinaryMonitor::appendU8(body,0); // no side effects
+         CViceBinaryMonitor::appendU16(body,start);
+         CViceBinaryMonitor::appendU16(body,end);
+         CViceBinaryMonitor::appendU8(body,VICE_MEMSPACE_MAIN);
+         CViceBinaryMonitor::appendU16(body,VICE_BANK_CPU);
+         body.append(data.mid(2,end-start+1));
+         command(VICE_CMD_MEMORY_SET,body);
+         m_dirtyPages.mark(start,end-start+1);
       }
+
+      body.clear();
+      CViceBinaryMonitor::appendU8(body,VICE_MEMSPACE_MAIN);
+      CViceBinaryMonitor::appendU16(body,1);
+      CViceBinaryMonitor::appendU8(body,3);
+      CViceBinaryMonitor::appendU8(body,m_registerIds.key(CPU_PC));
+      CViceBinaryMonitor::appendU16(body,m_loadAddr);
+      command(VICE_CMD_REGISTERS_SET,body);
+
+      syncBreakpoints();
+      syncMachineState(SyncLoaded);
    }
 }
 
@@ -315,58 +453,25 @@ void C64EmulatorThread::startEmulation ()
 {
    m_isRunning = true;
 
-   lockRequestQueue();
-   clearRequestQueue();
-   addToRequestQueue("until $ffff",false); // using "exit" doesn't seem to work.
-   runRequestQueue();
-   unlockRequestQueue();
+   // Anything could change while it runs.
+   m_dirtyPages.markAll();
+   command(VICE_CMD_EXIT);
 }
 
 void C64EmulatorThread::stepCPUEmulation ()
 {
-   QString request;
-   uint32_t endAddr;
-   uint32_t addr;
-   uint32_t absAddr;
+   QByteArray body;
 
-   // Check if we have an end address to stop at from a debug information file.
-   // If we do, it'll be the valid end of a C statement or an assembly instruction.
-   addr = c64GetCPURegister(CPU_PC);
-   absAddr = c64GetAbsoluteAddressFromAddress(addr);
-   endAddr = CCC65Interface::getEndAddressFromAbsoluteAddress(addr,absAddr);
+   markStepPagesDirty();
 
-#if 0
-// VICE doesn't give us what we need to step a full C language line yet.
-   if ( endAddr != 0xFFFFFFFF )
-   {
-      c64SetGotoAddress(endAddr);
-
-      lockRequestQueue();
-      clearRequestQueue();
-      request = "break load $" + QString::number(endAddr,16);
-      addToRequestQueue(request,true);
-      addToRequestQueue("r",true);
-//      addToRequestQueue("io",true);
-//      addToRequestQueue("m $0 $cfff",true);
-      runRequestQueue();
-   }
-   else
-#endif
-   {
-      lockRequestQueue();
-      clearRequestQueue();
-      addToRequestQueue("step",true);
-      addToRequestQueue("r",true);
-//      addToRequestQueue("io",true);
-//      addToRequestQueue("m $0 $cfff",true);
-      runRequestQueue();
-      unlockRequestQueue();
-   }
+   CViceBinaryMonitor::appendU8(body,0); // step into subroutines
+   CViceBinaryMonitor::appendU16(body,1);
+   command(VICE_CMD_ADVANCE_INSTRUCTIONS,body);
 }
 
 void C64EmulatorThread::stepOverCPUEmulation ()
 {
-   QString request;
+   QByteArray body;
    uint32_t endAddr;
    uint32_t addr;
    uint32_t absAddr;
@@ -417,15 +522,16 @@ void C64EmulatorThread::stepOverCPUEmulation ()
       // This *should* be where the JSR will vector back to on RTS.
       c64SetGotoAddress(endAddr+1);
 
-      lockRequestQueue();
-      clearRequestQueue();
-      request = "until $" + QString::number(endAddr+1,16);
-      addToRequestQueue(request,false);
-      addToRequestQueue("r",true);
-//      addToRequestQueue("io",true);
-//      addToRequestQueue("m $0 $cfff",true);
-      runRequestQueue();
-      unlockRequestQueue();
+      CViceBinaryMonitor::appendU16(body,endAddr+1);
+      CViceBinaryMonitor::appendU16(body,endAddr+1);
+      CViceBinaryMonitor::appendU8(body,1); // stop when hit
+      CViceBinaryMonitor::appendU8(body,1); // enabled
+      CViceBinaryMonitor::appendU8(body,VICE_CHECKPOINT_EXEC);
+      CViceBinaryMonitor::appendU8(body,1); // temporary
+      command(VICE_CMD_CHECKPOINT_SET,body);
+
+      m_dirtyPages.markAll();
+      command(VICE_CMD_EXIT);
    }
    else
    {
@@ -435,14 +541,8 @@ void C64EmulatorThread::stepOverCPUEmulation ()
 
 void C64EmulatorThread::stepOutCPUEmulation ()
 {
-   lockRequestQueue();
-   clearRequestQueue();
-   addToRequestQueue("next",true);
-   addToRequestQueue("r",true);
-//   addToRequestQueue("io",true);
-//   addToRequestQueue("m $0 $cfff",true);
-   runRequestQueue();
-   unlockRequestQueue();
+   m_dirtyPages.markAll();
+   command(VICE_CMD_EXECUTE_UNTIL_RETURN);
 }
 
 void C64EmulatorThread::pauseEmulation (bool show)
@@ -450,577 +550,327 @@ void C64EmulatorThread::pauseEmulation (bool show)
    m_isRunning = false;
    m_showOnPause = show;
 
-   lockRequestQueue();
-   clearRequestQueue();
-   addToRequestQueue("r",true);
-//   addToRequestQueue("io",true);
-   addToRequestQueue("m $0 $cfff",true);
-   runRequestQueue();
-   unlockRequestQueue();
+   // Any request stops the machine.
+   syncMachineState(SyncPaused);
 }
 
-void C64EmulatorThread::clearRequestQueue()
+void C64EmulatorThread::markStepPagesDirty()
 {
-   m_requests.clear();
-   m_responses.clear();
-   m_responseExpected.clear();
-}
+   uint32_t pc = c64GetCPURegister(CPU_PC);
+   uint8_t  op = c64GetMemory(pc);
+   uint32_t operand = c64GetMemory((pc+1)&0xFFFF)|(c64GetMemory((pc+2)&0xFFFF)<<8);
+   uint32_t ptr;
 
-void C64EmulatorThread::addToRequestQueue(QString request,bool expecting)
-{
-   request.append('\n');
-   m_requests.append(request);
-   m_responseExpected.append(expecting);
-}
+   // One instruction can only write to zero page, the stack, or where its
+   // operand points, worked out here from what we already have of memory.
+   m_dirtyPages.mark(0x0000,0x0200);
 
-void C64EmulatorThread::runRequestQueue()
-{
-   if ( m_requests.count() )
+   switch ( op&0x1F )
    {
-      m_requests.append("END");
-      m_responseExpected.append(false);
-
-      emit sendRequests(m_requests,m_responseExpected);
+   case 0x01:
+   case 0x03:
+      // (zp,X)
+      ptr = (operand+c64GetCPURegister(CPU_X))&0xFF;
+      m_dirtyPages.mark(c64GetMemory(ptr)|(c64GetMemory((ptr+1)&0xFF)<<8),1);
+      break;
+   case 0x11:
+   case 0x13:
+      // (zp),Y
+      ptr = operand&0xFF;
+      m_dirtyPages.mark(((c64GetMemory(ptr)|(c64GetMemory((ptr+1)&0xFF)<<8))+c64GetCPURegister(CPU_Y))&0xFFFF,1);
+      break;
+   case 0x0C:
+   case 0x0D:
+   case 0x0E:
+   case 0x0F:
+      // absolute
+      m_dirtyPages.mark(operand,1);
+      break;
+   case 0x19:
+   case 0x1B:
+   case 0x1C:
+   case 0x1D:
+   case 0x1E:
+   case 0x1F:
+      // absolute,X and absolute,Y
+      m_dirtyPages.mark(operand,0x100);
+      break;
    }
 }
 
-void C64EmulatorThread::processTraps(QString traps)
+void C64EmulatorThread::syncMachineState(SyncReason reason)
 {
-   CBreakpointInfo* pBreakpoints = c64GetBreakpointDatabase();
-   QStringList trapLines;
-   QRegExp bpRegex("[#]([0-9]+)[ \t]+[(]Stop[ \t]+on[ \t]+exec[ \t]+([0-9a-f]+)[)] ");
-   QString trap;
-   int bp;
-   int trapLine;
-   bool ok;
-   bool hook = false;
-
-   // First append this message chunk to the message string we're holding on to.
-   m_traps += traps;
+   QByteArray body;
 
-   // Then split the message string into lines, throwing away empties.
-   trapLines = m_traps.split(QRegExp("[\n]"),QString::SkipEmptyParts);
-
-   // For each line, check if it is a breakpoint hit indication.
-   // Don't check the last line as it may not yet be completely received.
-   for ( trapLine = 0; trapLine < trapLines.count()-1; trapLine++ )
-   {
-      trap = trapLines.at(trapLine);
-      if ( trap.contains(bpRegex) && (bpRegex.captureCount() == 2) )
-      {
-         qDebug("TRAP:");
-         qDebug(trap.toAscii().constData());
+   m_syncReason = reason;
+   m_bankBits = c64GetMemory(1)&0x07;
 
-         // Figure out which breakpoint hit this is.
-         for ( bp = 0; bp < pBreakpoints->GetNumBreakpoints(); bp++ )
-         {
-            BreakpointInfo* pBreakpoint = pBreakpoints->GetBreakpoint(bp);
-            uint32_t addr = bpRegex.cap(2).toInt(&ok,16);
+   CViceBinaryMonitor::appendU8(body,VICE_MEMSPACE_MAIN);
+   m_syncRequests.insert(command(VICE_CMD_REGISTERS_GET,body),0);
 
-            // And prepare to tell the UI.
-            pBreakpoint->hit = false;
-            if ( (pBreakpoint->item1 <= addr) && (pBreakpoint->item2 >= addr) )
-            {
-               pBreakpoint->hit = true;
-               hook = true;
-            }
-         }
-      }
-
-      // Since we've done something with this part of the
-      // trap message string, null it out so we don't do it again.
-      trapLines.replace(trapLine,"");
-   }
+   // The I/O registers change on their own.
+   m_dirtyPages.mark(0xD000,0x1000);
+   requestDirtyPages();
+}
 
-   // Finally, put the message string back together as one long bunch.
-   m_traps = trapLines.join("\n");
+void C64EmulatorThread::requestDirtyPages()
+{
+   QList<QByteArray> bodies;
+   QList<uint32_t> starts;
+   int idx;
 
-   // If we found a breakpoint hit, tell the UI.
-   if ( hook )
+   // Ask for each run of dirty pages in one go.
+   bodies = m_dirtyPages.take(&starts);
+   for ( idx = 0; idx < bodies.count(); idx++ )
    {
-      lockRequestQueue();
-      clearRequestQueue();
-      addToRequestQueue("r",true);
-      addToRequestQueue("io",true);
-      addToRequestQueue("m $0 $cfff",true);
-      runRequestQueue();
-      unlockRequestQueue();
-
-      breakpointHook();
+      m_syncRequests.insert(command(VICE_CMD_MEMORY_GET,bodies.at(idx)),starts.at(idx));
    }
 }
 
-void C64EmulatorThread::processResponses(QStringList requests,QStringList responses)
+void C64EmulatorThread::finishSync()
 {
-   CBreakpointInfo* pBreakpoints = c64GetBreakpointDatabase();
-   int resp;
    int32_t a;
-   int bp;
 
-#if 1
-   for ( int resp = 0; resp < requests.count(); resp++ )
+   // Writing the CPU port banks ROMs and I/O in and out.
+   if ( (c64GetMemory(1)&0x07) != m_bankBits )
    {
-      QString str;
-      if ( requests.at(resp) != "END" )
-      {
-         str = QString::number(resp);
-         str += " Request: \n";
-         str += requests.at(resp);
-         str += "\nResponse: \n";
-         if ( requests.at(resp).startsWith("m ") )
-         {
-            str += QString::number(responses.at(resp).length());
-         }
-         else
-         {
-            str += responses.at(resp);
-         }
-         qDebug(str.toAscii().constData());
-      }
+      m_bankBits = c64GetMemory(1)&0x07;
+      m_dirtyPages.mark(0xA000,0x2000);
+      m_dirtyPages.mark(0xD000,0x3000);
+      requestDirtyPages();
+      return;
    }
-#endif
 
-   for ( resp = 0; resp < responses.count(); resp++ )
+   switch ( m_syncReason )
    {
-      // Check if we need to update debuggers.
-      if ( requests.at(resp).contains("break\n") )
+   case SyncPaused:
+      emit emulatorPaused(m_showOnPause);
+      break;
+   case SyncBreakpoint:
+      breakpointHook();
+      emit emulatorPaused(m_showOnPause);
+      break;
+   case SyncLoaded:
+      c64ClearOpcodeMasks();
+
+      // Update opcode masks to show proper disassembly...
+      for ( a = 0; a < MEM_64KB; a++ )
       {
-         // Create a mapping of break address to breakpoint-number
-         QStringList targetBreakpoints = responses.at(resp).split(QRegExp("[\n]"),QString::SkipEmptyParts);
-         QVector<QString> bpVector;
-         QVector<QString>::const_iterator bpIterator;
-         QRegExp bpRegex("(BREAK|WATCH|UNTIL):[ \t]+([0-9]+)");
-         QString bpText;
-
-         // Find all breakpoints reported by the target.  Map them so we can use them.
-         foreach ( QString bpText, targetBreakpoints )
+         if ( CCC65Interface::isAbsoluteAddressAnOpcode(a) )
          {
-            if ( bpText.contains(bpRegex) && (bpRegex.captureCount() == 2) )
-            {
-               bpVector.append(bpRegex.cap(2));
-            }
+            c64SetOpcodeMask(a,1);
          }
-
-         // Delete all breakpoints...
-         lockRequestQueue();
-         clearRequestQueue();
-         for ( bpIterator = bpVector.constBegin();
-               bpIterator != bpVector.constEnd();
-               ++bpIterator )
+         else
          {
-            bpText = "delete ";
-            bpText += bpIterator;
-            addToRequestQueue(bpText,false);
+            c64SetOpcodeMask(a,0);
          }
-         runRequestQueue();
-         unlockRequestQueue();
+      }
 
-         // Add all enabled breakpoints...
-         lockRequestQueue();
-         clearRequestQueue();
-         for ( bp = 0; bp < pBreakpoints->GetNumBreakpoints(); bp++ )
-         {
-            BreakpointInfo* pBreakpoint = pBreakpoints->GetBreakpoint(bp);
+      emit machineReady();
+      emit emulatorPaused(m_showOnPause);
+      break;
+   }
+}
 
-            if ( pBreakpoint->enabled )
-            {
-               if ( pBreakpoint->type == eBreakOnCPUExecution )
-               {
-                  bpText = "break exec $";
-               }
-               else if ( pBreakpoint->type == eBreakOnCPUMemoryAccess )
-               {
-                  bpText = "break load store $";
-               }
-               else if ( pBreakpoint->type == eBreakOnCPUMemoryRead )
-               {
-                  bpText = "break load $";
-               }
-               else if ( pBreakpoint->type == eBreakOnCPUMemoryWrite )
-               {
-                  bpText = "break store $";
-               }
-               bpText += QString::number(pBreakpoint->item1,16);
-               if ( pBreakpoint->item2 != pBreakpoint->item1 )
-               {
-                  bpText += " $";
-                  bpText += QString::number(pBreakpoint->item2,16);
-               }
-               addToRequestQueue(bpText,false);
-            }
-         }
-         runRequestQueue();
-         unlockRequestQueue();
-      }
-      else if ( requests.at(resp).startsWith("reset") )
-      {
-         emit emulatorReset();
-      }
-      else if ( requests.at(resp).startsWith("until") )
-      {
-         emit emulatorStarted();
-      }
-      else if ( requests.at(resp).startsWith("r pc") )
-      {
-         c64ClearOpcodeMasks();
+void C64EmulatorThread::monitorError(QString message)
+{
+   generalTextLogger->write("<font color='red'>VICE monitor: "+message+"</font>");
+}
 
-         // Update opcode masks to show proper disassembly...
-         for ( a = 0; a < MEM_64KB; a++ )
-         {
-            if ( CCC65Interface::isAbsoluteAddressAnOpcode(a) )
-            {
-               c64SetOpcodeMask(a,1);
-            }
-            else
-            {
-               c64SetOpcodeMask(a,0);
-            }
-         }
+void C64EmulatorThread::processResponse(uint requestId,int type,int error,QByteArray body)
+{
+   QByteArray name;
+   int count;
+   int item;
+   int pos;
 
-         emit machineReady();
-      }
-      else if ( requests.at(resp) == "r\n" )
+   if ( error != VICE_ERROR_OK )
+   {
+      monitorError(QString("Request %1 failed with error %2.").arg(type,2,16,QChar('0')).arg(error,2,16,QChar('0')));
+   }
+   else
+   {
+      switch ( type )
       {
-         QStringList responseLines = responses.at(resp).split(QRegExp("[\r\n]"),QString::SkipEmptyParts);
-         QString responseHeader = responseLines.at(0);
-         QString responseData = responseLines.at(1);
-
-//         qDebug(responseHeader.toAscii().constData());
-         responseHeader.remove(QRegExp("^([ \r\n\t]*[(]C:[$][0-9a-f]+[)])*"));
-//         qDebug(responseData.toAscii().constData());
-         responseData.remove(QRegExp("^([ \r\n\t]*[(]C:[$][0-9a-f]+[)])*"));
-
-         QStringList responseHeaderParts = responseHeader.split(QRegExp("[ \t\n]"),QString::SkipEmptyParts);
-         QStringList responseDataParts = responseData.split(QRegExp("[ \t\n]"),QString::SkipEmptyParts);
-         QString str;
-         int part;
-         bool ok;
-
-         for ( part = 0; part < responseHeaderParts.count(); part++ )
+      case VICE_CMD_MEMORY_GET:
+         processMemory(requestId,body);
+         break;
+      case VICE_RESPONSE_REGISTER_INFO:
+         processRegisters(body);
+         break;
+      case VICE_RESPONSE_CHECKPOINT_INFO:
+         processCheckpoint(requestId,body);
+         break;
+      case VICE_CMD_REGISTERS_AVAILABLE:
+         m_registerIds.clear();
+         count = CViceBinaryMonitor::getU16(body,0);
+         for ( item = 0, pos = 2; (item < count) && (pos+4 <= body.size()); item++ )
          {
-            if ( responseHeaderParts.at(part) == "ADDR" )
+            name = body.mid(pos+4,CViceBinaryMonitor::getU8(body,pos+3));
+            if ( name == "PC" )
             {
-               str = responseDataParts.at(part);
-               str.remove(QRegExp("^([.;])*"));
-               c64SetCPURegister(CPU_PC,str.toInt(&ok,16));
+               m_registerIds.insert(CViceBinaryMonitor::getU8(body,pos+1),CPU_PC);
             }
-            if ( responseHeaderParts.at(part) == "AC" )
+            else if ( name == "A" )
             {
-               str = responseDataParts.at(part);
-               str.remove(QRegExp("^([.;])*"));
-               c64SetCPURegister(CPU_A,str.toInt(&ok,16));
+               m_registerIds.insert(CViceBinaryMonitor::getU8(body,pos+1),CPU_A);
             }
-            if ( responseHeaderParts.at(part) == "XR" )
+            else if ( name == "X" )
             {
-               str = responseDataParts.at(part);
-               str.remove(QRegExp("^([.;])*"));
-               c64SetCPURegister(CPU_X,str.toInt(&ok,16));
+               m_registerIds.insert(CViceBinaryMonitor::getU8(body,pos+1),CPU_X);
             }
-            if ( responseHeaderParts.at(part) == "YR" )
+            else if ( name == "Y" )
             {
-               str = responseDataParts.at(part);
-               str.remove(QRegExp("^([.;])*"));
-               c64SetCPURegister(CPU_Y,str.toInt(&ok,16));
+               m_registerIds.insert(CViceBinaryMonitor::getU8(body,pos+1),CPU_Y);
             }
-            if ( responseHeaderParts.at(part) == "SP" )
+            else if ( name == "SP" )
             {
-               str = responseDataParts.at(part);
-               str.remove(QRegExp("^([.;])*"));
-               c64SetCPURegister(CPU_SP,str.toInt(&ok,16));
+               m_registerIds.insert(CViceBinaryMonitor::getU8(body,pos+1),CPU_SP);
             }
-            if ( responseHeaderParts.at(part) == "NV-BDIZC" )
+            else if ( name == "FL" )
             {
-               str = responseDataParts.at(part);
-               str.remove(QRegExp("^([.;])*"));
-               c64SetCPURegister(CPU_F,str.toInt(&ok,2));
+               m_registerIds.insert(CViceBinaryMonitor::getU8(body,pos+1),CPU_F);
             }
+            pos += CViceBinaryMonitor::getU8(body,pos)+1;
          }
-
-         emit emulatorPaused(m_showOnPause);
-      }
-      else if ( requests.at(resp).startsWith("m "))
-      {
-         QStringList responseLines = responses.at(resp).split(QRegExp("[\r\n]"),QString::SkipEmptyParts);
-         foreach ( QString responseData, responseLines )
+         break;
+      case VICE_CMD_RESET:
+         emit emulatorReset();
+         break;
+      case VICE_CMD_EXIT:
+         if ( m_isRunning )
          {
-            responseData.remove(QRegExp("^([ \r\n\t]*[(]C:[$][0-9a-f]+[)])*"));
-
-            QStringList responseParts = responseData.split(QRegExp("[ \t]"),QString::SkipEmptyParts);
-            QString str;
-            uint32_t addr;
-            int part;
-            bool ok;
-
-            // Get address.
-            if ( responseParts.count() )
-            {
-               str = responseParts.at(0);
-               str.remove(QRegExp(">C:"));
-               addr = str.toInt(&ok,16);
-
-               for ( part = 0; part < responseParts.count()-1; part++ )
-               {
-                  str = responseParts.at(1+part);
-                  c64SetMemory(addr+part,str.toInt(&ok,16));
-               }
-            }
+            emit emulatorStarted();
          }
-      }
-      else if ( requests.at(resp).startsWith("io\n"))
-      {
-         QStringList responseLines = responses.at(resp).split(QRegExp("[\r\n]"),QString::SkipEmptyParts);
-         foreach ( QString responseData, responseLines )
+         break;
+      case VICE_RESPONSE_STOPPED:
+      case VICE_RESPONSE_JAM:
+         if ( m_resetPending )
          {
-            responseData.remove(QRegExp("^([ \r\n\t]*[(]C:[$][0-9a-f]+[)])*"));
-
-            QStringList responseParts = responseData.split(QRegExp("[ \t]"),QString::SkipEmptyParts);
-            QString str;
-            uint32_t addr;
-            int part;
-            bool ok;
-
-            // Get address.
-            if ( responseParts.count() )
+            // Requests made on the way to the ready prompt stop the machine
+            // too, only the temporary checkpoint means it is there.
+            if ( m_loadPending )
             {
-               str = responseParts.at(0);
-               str.remove(QRegExp(">C:"));
-               addr = str.toInt(&ok,16);
-
-               for ( part = 0; part < responseParts.count()-1; part++ )
-               {
-                  str = responseParts.at(1+part);
-                  c64SetMemory(addr+part,str.toInt(&ok,16));
-               }
+               m_resetPending = false;
+               m_loadPending = false;
+               loadProgram();
             }
          }
-#if 0
-         // Set up SID.
-         for ( addr = SID_BASE; addr < SID_END; addr++ )
+         else if ( m_breakpointHit )
          {
-            if ( (addr == 0xd400) ||
-                 (addr == 0xd402) ||
-                 (addr == 0xd407) ||
-                 (addr == 0xd409) ||
-                 (addr == 0xd40e) ||
-                 (addr == 0xd410) )
-            {
-               c64SetSID16Register(addr,(c64GetMemory(addr)<<8)|c64GetMemory(addr+1));
-            }
-            else
-            {
-               c64SetSID8Register(addr,c64GetMemory(addr));
-            }
+            m_breakpointHit = false;
+            m_isRunning = false;
+            syncMachineState(SyncBreakpoint);
          }
-#endif
+         else if ( (!m_isRunning) && m_syncRequests.isEmpty() )
+         {
+            // Finished a step.  When running, stops are the interruptions
+            // our own requests make.
+            syncMachineState(SyncPaused);
+         }
+         break;
       }
    }
-}
-
-void C64EmulatorThread::lockRequestQueue()
-{
-   m_requestMutex->lock();
-}
-
-void C64EmulatorThread::unlockRequestQueue()
-{
-   m_requestMutex->unlock();
-}
-
-TcpClient::TcpClient(QString monitorIPAddress,int monitorPort,QObject */*parent*/)
-   : m_ipAddress(monitorIPAddress),
-     m_port(monitorPort)
-{
-   m_clientMutex = new QMutex();
-
-   pSocket = new QTcpSocket(this);
-   QObject::connect(pSocket,SIGNAL(error(QAbstractSocket::SocketError)),this,SLOT(error(QAbstractSocket::SocketError)));
-   QObject::connect(pSocket,SIGNAL(connected()),this,SLOT(connected()));
-   QObject::connect(pSocket,SIGNAL(disconnected()),this,SLOT(disconnected()));
-   QObject::connect(pSocket,SIGNAL(readyRead()),this,SLOT(readyRead()));
-   QObject::connect(pSocket,SIGNAL(bytesWritten(qint64)),this,SLOT(bytesWritten(qint64)));
-   pSocket->connectToHost(m_ipAddress,m_port);
-
-   m_request = 0;
-}
-
-TcpClient::~TcpClient()
-{
-   pSocket->close();
-   delete pSocket;
-}
 
-void TcpClient::error(QAbstractSocket::SocketError error)
-{
-   qDebug("SOCKET ERROR");
-   qDebug(QString::number((int)error).toAscii().constData());
-   switch ( error )
+   if ( m_syncRequests.remove(requestId) && m_syncRequests.isEmpty() )
    {
-   case QAbstractSocket::ConnectionRefusedError:
-      pSocket->connectToHost(m_ipAddress,m_port);
-      break;
+      finishSync();
    }
-
-#if 0
-   QAbstractSocket::ConnectionRefusedError	0	The connection was refused by the peer (or timed out).
-   QAbstractSocket::RemoteHostClosedError	1	The remote host closed the connection. Note that the client socket (i.e., this socket) will be closed after the remote close notification has been sent.
-   QAbstractSocket::HostNotFoundError	2	The host address was not found.
-   QAbstractSocket::SocketAccessError	3	The socket operation failed because the application lacked the required privileges.
-   QAbstractSocket::SocketResourceError	4	The local system ran out of resources (e.g., too many sockets).
-   QAbstractSocket::SocketTimeoutError	5	The socket operation timed out.
-   QAbstractSocket::DatagramTooLargeError	6	The datagram was larger than the operating system's limit (which can be as low as 8192 bytes).
-   QAbstractSocket::NetworkError	7	An error occurred with the network (e.g., the network cable was accidentally plugged out).
-   QAbstractSocket::AddressInUseError	8	The address specified to QUdpSocket::bind() is already in use and was set to be exclusive.
-   QAbstractSocket::SocketAddressNotAvailableError	9	The address specified to QUdpSocket::bind() does not belong to the host.
-   QAbstractSocket::UnsupportedSocketOperationError	10	The requested socket operation is not supported by the local operating system (e.g., lack of IPv6 support).
-   QAbstractSocket::ProxyAuthenticationRequiredError	12	The socket is using a proxy, and the proxy requires authentication.
-   QAbstractSocket::SslHandshakeFailedError	13	The SSL/TLS handshake failed, so the connection was closed (only used in QSslSocket)
-   QAbstractSocket::UnfinishedSocketOperationError	11	Used by QAbstractSocketEngine only, The last operation attempted has not finished yet (still in progress in the background).
-   QAbstractSocket::ProxyConnectionRefusedError	14	Could not contact the proxy server because the connection to that server was denied
-   QAbstractSocket::ProxyConnectionClosedError	15	The connection to the proxy server was closed unexpectedly (before the connection to the final peer was established)
-   QAbstractSocket::ProxyConnectionTimeoutError	16	The connection to the proxy server timed out or the proxy server stopped responding in the authentication phase.
-   QAbstractSocket::ProxyNotFoundError	17	The proxy address set with setProxy() (or the application proxy) was not found.
-   QAbstractSocket::ProxyProtocolError	18	The connection negotiation with the proxy server because the response from the proxy server could not be understood.
-   QAbstractSocket::UnknownSocketError
-#endif
 }
 
-void TcpClient::connected()
+void C64EmulatorThread::processRegisters(QByteArray body)
 {
-   emit clientConnected();
+   int count;
+   int item;
+   int pos;
+   int id;
 
-   m_clientMutex->lock();
-   if ( m_requests.count() )
+   count = CViceBinaryMonitor::getU16(body,0);
+   for ( item = 0, pos = 2; (item < count) && (pos+4 <= body.size()); item++ )
    {
-      // Kick off writing anything that's been queued.
-      qDebug(m_requests.at(0).toAscii().constData());
-      pSocket->write(m_requests.at(0).toAscii());
-      qDebug("requests were pending");
+      id = CViceBinaryMonitor::getU8(body,pos+1);
+      if ( m_registerIds.contains(id) )
+      {
+         c64SetCPURegister(m_registerIds.value(id),CViceBinaryMonitor::getU16(body,pos+2));
+      }
+      pos += CViceBinaryMonitor::getU8(body,pos)+1;
    }
-   m_clientMutex->unlock();
-   qDebug("SOCKET CONNECTED!");
 }
 
-void TcpClient::disconnected()
+void C64EmulatorThread::processMemory(uint32_t requestId,QByteArray body)
 {
-   emit clientDisconnected();
-   qDebug("SOCKET DISCONNECTED!");
-}
-
-void TcpClient::sendRequests(QStringList requests,QList<int> expectings)
-{
-   int currentRequest;
-   int req;
-
-   m_clientMutex->lock();
-   currentRequest = m_request;
-   m_requests.append(requests);
-   for ( req = 0; req < m_requests.count(); req++ )
-   {
-      m_requestSent.append(false);
-   }
-   m_expectDataInResponse.append(expectings);
+   uint32_t addr;
+   int length;
+   int idx;
 
-   if ( (!currentRequest) &&
-        (currentRequest < m_requests.count()) &&
-        (!m_requestSent.at(currentRequest)) &&
-        (pSocket->state() == QAbstractSocket::ConnectedState) )
+   if ( m_syncRequests.contains(requestId) && (body.size() >= 2) )
    {
-      // Kick off if nothing going on.
-      qDebug(m_requests.at(0).toAscii().constData());
-      pSocket->write(m_requests.at(0).toAscii());
-      m_requestSent.replace(0,true);
+      addr = m_syncRequests.value(requestId);
+      length = qMin((int)CViceBinaryMonitor::getU16(body,0),body.size()-2);
+      for ( idx = 0; idx < length; idx++ )
+      {
+         c64SetMemory(addr+idx,CViceBinaryMonitor::getU8(body,2+idx));
+      }
    }
-   m_clientMutex->unlock();
 }
 
-void TcpClient::readyRead()
+void C64EmulatorThread::processCheckpoint(uint32_t requestId,QByteArray body)
 {
-   QStringList returnRequests;
-   QStringList returnResponses;
-   QString     receivedData;
-   QRegExp     regex("([\n][(]C:[$][0-9a-f]+[)]) ");
-   int count;
-   int currentRequest;
-   bool expecting;
-
-   receivedData = pSocket->readAll();
-   responseMessage.append(receivedData);
-
-   emit traps(receivedData);
-
-   m_clientMutex->lock();
-   count = m_requests.count();
-   currentRequest = m_request;
-   if ( currentRequest < m_requests.count() )
-   {
-      expecting = m_expectDataInResponse.at(currentRequest);
-   }
-   else
-   {
-      expecting = false;
-   }
-   m_clientMutex->unlock();
+   CBreakpointInfo* pBreakpoints = c64GetBreakpointDatabase();
+   QByteArray deleteBody;
+   uint32_t number;
+   int bp;
 
-   if ( currentRequest >= (count-1) )
+   if ( body.size() < 5 )
    {
-      responseMessage.clear();
       return;
    }
 
-   if ( (!expecting) || (responseMessage.lastIndexOf(regex) > 0) )
+   number = CViceBinaryMonitor::getU32(body,0);
+
+   if ( m_checkpointRequests.contains(requestId) )
    {
-      m_clientMutex->lock();
-      m_responses.append(responseMessage);
-      m_request++;
-      if ( m_requests.at(m_request) != "END" )
+      // A checkpoint we asked for has been made.
+      bp = m_checkpointRequests.take(requestId);
+      if ( bp == -1 )
+      {
+         m_loadCheckpoint = number;
+      }
+      else if ( requestId < m_checkpointBatch )
       {
-         qDebug(m_requests.at(m_request).toAscii().constData());
-         pSocket->write(m_requests.at(m_request).toAscii());
-         m_requestSent.replace(m_request,true);
+         CViceBinaryMonitor::appendU32(deleteBody,number);
+         command(VICE_CMD_CHECKPOINT_DELETE,deleteBody);
       }
       else
       {
-//         qDebug("FINISHED");
-         // Remove the "END" marker.
-         m_requests.removeAt(m_request);
-         m_responses.removeAt(m_request);
-         m_expectDataInResponse.removeAt(m_request);
-         m_requestSent.removeAt(m_request);
-
-         // Copy the requests/responses to return in this bundle.
-         do
+         m_checkpoints.insert(number,bp);
+      }
+   }
+   else if ( (requestId == VICE_EVENT_ID) && CViceBinaryMonitor::getU8(body,4) )
+   {
+      // A checkpoint has been hit, the machine is stopping.
+      if ( number == m_loadCheckpoint )
+      {
+         m_loadCheckpoint = 0;
+         m_loadPending = true;
+      }
+      else if ( m_checkpoints.contains(number) )
+      {
+         // Figure out which breakpoint hit this is, and prepare to tell the UI.
+         for ( bp = 0; bp < pBreakpoints->GetNumBreakpoints(); bp++ )
          {
-            m_request--;
-            returnRequests.prepend(m_requests.at(m_request));
-            returnResponses.prepend(m_responses.at(m_request));
-            m_requests.removeAt(m_request);
-            m_responses.removeAt(m_request);
-            m_expectDataInResponse.removeAt(m_request);
-            m_requestSent.removeAt(m_request);
-         } while ( m_request > 0 );
-
-         // Give the responses back to the requestor.
-         emit responses(returnRequests,returnResponses);
-
-         // If new requests have come in, process those.  Otherwise
-         // they'll be processed by the next bundle's arrival.
-         if ( m_requests.count() )
+            pBreakpoints->GetBreakpoint(bp)->hit = false;
+         }
+         bp = m_checkpoints.value(number);
+         if ( bp < pBreakpoints->GetNumBreakpoints() )
          {
-            qDebug(m_requests.at(0).toAscii().constData());
-            pSocket->write(m_requests.at(0).toAscii());
+            pBreakpoints->GetBreakpoint(bp)->hit = true;
+            m_breakpointHit = true;
          }
       }
-      m_clientMutex->unlock();
-      responseMessage.clear();
    }
 }
 
-void TcpClient::bytesWritten(qint64 /*bytes*/)
-{
-//   qDebug("bytesWritten");
-//   qDebug(QString::number(bytes).toAscii().constData());
-}
-
 bool C64EmulatorThread::serialize(QDomDocument& /*doc*/, QDomNode& /*node*/)
 {
    return true;
@@ -2,48 +2,14 @@
 #define C64EMULATORTHREAD_H
 
 #include <QThread>
-#include <QTcpSocket>
 #include <QProcess>
-#include <QSemaphore>
-#include <QMutex>
+#include <QHash>
 
 #include "ixmlserializable.h"
 
 #include "c64_emulator_core.h"
 
-class TcpClient : public QObject
-{
-   Q_OBJECT
-public:
-   explicit TcpClient(QString monitorIPAddress,int monitorPort,QObject *parent = 0);
-   ~TcpClient();
-
-private:
-   QTcpSocket* pSocket;
-   QString responseMessage;
-   QStringList m_requests;
-   QStringList m_responses;
-   QList<int> m_expectDataInResponse;
-   QList<bool> m_requestSent;
-   int m_request;
-   QString m_ipAddress;
-   int m_port;
-   QMutex*  m_clientMutex;
-
-signals:
-   void responses(QStringList requests,QStringList responses);
-   void traps(QString traps);
-   void clientConnected();
-   void clientDisconnected();
-
-private slots:
-   void sendRequests(QStringList requests,QList<int> expectings);
-   void error(QAbstractSocket::SocketError error);
-   void connected();
-   void disconnected();
-   void readyRead();
-   void bytesWritten(qint64);
-};
+#include "cvicebinarymonitor.h"
 
 class C64EmulatorThread : public QThread, public IXMLSerializable
 {
@@ -78,8 +44,8 @@ public slots:
    void stepCPUEmulation ();
    void stepOverCPUEmulation ();
    void stepOutCPUEmulation ();
-   void processResponses(QStringList requests,QStringList responses);
-   void processTraps(QString traps);
+   void processResponse(uint requestId,int type,int error,QByteArray body);
+   void monitorError(QString message);
 
 signals:
    void breakpoint();
@@ -93,27 +59,64 @@ signals:
    void emulatorStarted();
    void debugMessage(char* message);
    void machineReady();
-   void sendRequests(QStringList requests,QList<int> expectings);
+   void sendCommand(uint requestId,int command,QByteArray body);
    void emulatorWantsExit();
 
 protected:
-   void lockRequestQueue();
-   void clearRequestQueue();
-   void addToRequestQueue(QString command,bool expecting);
-   void runRequestQueue();
-   void unlockRequestQueue();
+   // What to tell the world once the machine state has been fetched.
+   enum SyncReason
+   {
+      SyncPaused,
+      SyncBreakpoint,
+      SyncLoaded
+   };
+
+   uint32_t command(int command,QByteArray body = QByteArray());
+   void loadProgram();
+   void requestDirtyPages();
+   void syncBreakpoints();
+   void syncMachineState(SyncReason reason);
+   void finishSync();
+   void markStepPagesDirty();
+   void processRegisters(QByteArray body);
+   void processMemory(uint32_t requestId,QByteArray body);
+   void processCheckpoint(uint32_t requestId,QByteArray body);
 
    QProcess*   m_pViceApp;
-   TcpClient*  m_pClient;
-   QMutex*  m_requestMutex;
+   CViceBinaryMonitor* m_pMonitor;
 
    QString     m_pFile;
    bool        m_showOnPause;
 
-   QStringList m_requests;
-   QStringList m_responses;
-   QList<int>  m_responseExpected;
-   QString     m_traps;
+   uint32_t    m_requestId;
+
+   // VICE's register IDs, mapped to ours.
+   QHash<int,int> m_registerIds;
+
+   // VICE's checkpoint numbers, mapped to our breakpoint indices.
+   // Checkpoints made by earlier batches than m_checkpointBatch are deleted
+   // as soon as VICE says what their numbers are.
+   QHash<uint32_t,int> m_checkpoints;
+   QHash<uint32_t,int> m_checkpointRequests;
+   uint32_t    m_checkpointBatch;
+   bool        m_breakpointHit;
+
+   // Memory that may have changed since it was last fetched.
+   CViceDirtyPages m_dirtyPages;
+
+   // Outstanding requests for registers and memory, mapped to the address
+   // of the memory asked for.
+   QHash<uint32_t,uint32_t> m_syncRequests;
+   SyncReason  m_syncReason;
+   uint8_t     m_bankBits;
+
+   // While resetting the machine runs until the temporary checkpoint at the
+   // BASIC ready prompt, then the program is loaded.
+   bool        m_resetPending;
+   bool        m_loadPending;
+   uint32_t    m_loadCheckpoint;
+   QString     m_loadFile;
+   int         m_loadAddr;
 
    bool m_isRunning;
 };
@@ -0,0 +1,212 @@
+//    NESICIDE - an IDE for the 8-bit NES.
+//    Copyright (C) 2009  Christopher S. Pow
+
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "cvicebinarymonitor.h"
+
+CViceBinaryMonitor::CViceBinaryMonitor(QString monitorIPAddress,int monitorPort,QObject *parent)
+   : QObject(parent),
+     m_ipAddress(monitorIPAddress),
+     m_port(monitorPort)
+{
+   m_pSocket = new QTcpSocket(this);
+   QObject::connect(m_pSocket,SIGNAL(error(QAbstractSocket::SocketError)),this,SLOT(error(QAbstractSocket::SocketError)));
+   QObject::connect(m_pSocket,SIGNAL(connected()),this,SLOT(connected()));
+   QObject::connect(m_pSocket,SIGNAL(disconnected()),this,SLOT(disconnected()));
+   QObject::connect(m_pSocket,SIGNAL(readyRead()),this,SLOT(readyRead()));
+   m_pSocket->connectToHost(m_ipAddress,m_port);
+}
+
+CViceBinaryMonitor::~CViceBinaryMonitor()
+{
+   m_pSocket->close();
+   delete m_pSocket;
+}
+
+void CViceBinaryMonitor::appendU8(QByteArray& body,uint8_t value)
+{
+   body.append((char)value);
+}
+
+void CViceBinaryMonitor::appendU16(QByteArray& body,uint16_t value)
+{
+   body.append((char)(value&0xFF));
+   body.append((char)(value>>8));
+}
+
+void CViceBinaryMonitor::appendU32(QByteArray& body,uint32_t value)
+{
+   appendU16(body,value&0xFFFF);
+   appendU16(body,value>>16);
+}
+
+uint8_t CViceBinaryMonitor::getU8(const QByteArray& body,int offset)
+{
+   return (uint8_t)body.at(offset);
+}
+
+uint16_t CViceBinaryMonitor::getU16(const QByteArray& body,int offset)
+{
+   return getU8(body,offset)|(getU8(body,offset+1)<<8);
+}
+
+uint32_t CViceBinaryMonitor::getU32(const QByteArray& body,int offset)
+{
+   return getU16(body,offset)|(getU16(body,offset+2)<<16);
+}
+
+void CViceBinaryMonitor::error(QAbstractSocket::SocketError error)
+{
+   switch ( error )
+   {
+   case QAbstractSocket::ConnectionRefusedError:
+      // VICE may not have opened the monitor port yet.
+      m_pSocket->connectToHost(m_ipAddress,m_port);
+      break;
+   default:
+      emit monitorError(m_pSocket->errorString());
+      break;
+   }
+}
+
+void CViceBinaryMonitor::connected()
+{
+   emit monitorConnected();
+
+   foreach ( QByteArray request, m_pending )
+   {
+      m_pSocket->write(request);
+   }
+   m_pending.clear();
+}
+
+void CViceBinaryMonitor::disconnected()
+{
+   m_received.clear();
+
+   emit monitorDisconnected();
+}
+
+void CViceBinaryMonitor::sendCommand(uint requestId,int command,QByteArray body)
+{
+   QByteArray request;
+
+   request.reserve(VICE_REQUEST_HEADER_SIZE+body.size());
+   appendU8(request,VICE_STX);
+   appendU8(request,VICE_API_VERSION);
+   appendU32(request,body.size());
+   appendU32(request,requestId);
+   appendU8(request,command);
+   request.append(body);
+
+   if ( m_pSocket->state() == QAbstractSocket::ConnectedState )
+   {
+      m_pSocket->write(request);
+   }
+   else
+   {
+      m_pending.append(request);
+   }
+}
+
+void CViceBinaryMonitor::readyRead()
+{
+   uint32_t length;
+
+   m_received.append(m_pSocket->readAll());
+
+   while ( m_received.size() >= VICE_RESPONSE_HEADER_SIZE )
+   {
+      // Skip anything that isn't the start of a response.
+      if ( getU8(m_received,0) != VICE_STX )
+      {
+         m_received.remove(0,1);
+         continue;
+      }
+
+      length = getU32(m_received,2);
+      if ( (uint32_t)m_received.size() < VICE_RESPONSE_HEADER_SIZE+length )
+      {
+         // Wait for the rest of it.
+         break;
+      }
+
+      emit response(getU32(m_received,8),
+                    getU8(m_received,6),
+                    getU8(m_received,7),
+                    m_received.mid(VICE_RESPONSE_HEADER_SIZE,length));
+
+      m_received.remove(0,VICE_RESPONSE_HEADER_SIZE+length);
+   }
+}
+
+CViceDirtyPages::CViceDirtyPages()
+   : m_pages(0x100,true)
+{
+}
+
+void CViceDirtyPages::markAll()
+{
+   m_pages.fill(true);
+}
+
+void CViceDirtyPages::mark(uint32_t addr,uint32_t length)
+{
+   uint32_t page;
+
+   if ( !length )
+   {
+      return;
+   }
+
+   for ( page = addr>>8; page <= ((addr+length-1)>>8); page++ )
+   {
+      m_pages.setBit(page&0xFF);
+   }
+}
+
+QList<QByteArray> CViceDirtyPages::take(QList<uint32_t>* starts)
+{
+   QList<QByteArray> bodies;
+   QByteArray body;
+   uint32_t page = 0;
+   uint32_t start;
+
+   while ( page < 0x100 )
+   {
+      if ( !m_pages.testBit(page) )
+      {
+         page++;
+         continue;
+      }
+
+      start = page;
+      while ( (page < 0x100) && m_pages.testBit(page) && (page-start < 0x40) )
+      {
+         m_pages.clearBit(page);
+         page++;
+      }
+
+      body.clear();
+      CViceBinaryMonitor::appendU8(body,0); // no side effects
+      CViceBinaryMonitor::appendU16(body,start<<8);
+      CViceBinaryMonitor::appendU16(body,(page<<8)-1);
+      CViceBinaryMonitor::appendU8(body,VICE_MEMSPACE_MAIN);
+      CViceBinaryMonitor::appendU16(body,VICE_BANK_CPU);
+      bodies.append(body);
+      starts->append(start<<8);
+   }
+   return bodies;
+}
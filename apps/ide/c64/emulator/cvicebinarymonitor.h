@@ -0,0 +1,129 @@
+#ifndef CVICEBINARYMONITOR_H
+#define CVICEBINARYMONITOR_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QByteArray>
+#include <QList>
+#include <QBitArray>
+
+#include <stdint.h>
+
+// VICE binary remote monitor protocol, enabled with -binarymonitor.
+//
+// Requests are STX, API version, body length (32-bit), request ID (32-bit),
+// command (8-bit) and the body.  Responses are STX, API version, body length
+// (32-bit), response type (8-bit), error code (8-bit), request ID (32-bit)
+// and the body.  All values are little-endian.  Responses VICE sends on its
+// own, such as when a checkpoint is hit, carry VICE_EVENT_ID.
+#define VICE_STX                      0x02
+#define VICE_API_VERSION              0x02
+#define VICE_REQUEST_HEADER_SIZE      11
+#define VICE_RESPONSE_HEADER_SIZE     12
+#define VICE_EVENT_ID                 0xFFFFFFFF
+
+// Commands, and the types of the responses to them.
+#define VICE_CMD_MEMORY_GET           0x01
+#define VICE_CMD_MEMORY_SET           0x02
+#define VICE_CMD_CHECKPOINT_GET       0x11
+#define VICE_CMD_CHECKPOINT_SET       0x12
+#define VICE_CMD_CHECKPOINT_DELETE    0x13
+#define VICE_CMD_CHECKPOINT_LIST      0x14
+#define VICE_CMD_REGISTERS_GET        0x31
+#define VICE_CMD_REGISTERS_SET        0x32
+#define VICE_CMD_ADVANCE_INSTRUCTIONS 0x71
+#define VICE_CMD_EXECUTE_UNTIL_RETURN 0x73
+#define VICE_CMD_REGISTERS_AVAILABLE  0x83
+#define VICE_CMD_EXIT                 0xAA
+#define VICE_CMD_RESET                0xCC
+#define VICE_CMD_AUTOSTART            0xDD
+
+// Response types that only ever come as events.
+#define VICE_RESPONSE_CHECKPOINT_INFO VICE_CMD_CHECKPOINT_GET
+#define VICE_RESPONSE_REGISTER_INFO   VICE_CMD_REGISTERS_GET
+#define VICE_RESPONSE_JAM             0x61
+#define VICE_RESPONSE_STOPPED         0x62
+#define VICE_RESPONSE_RESUMED         0x63
+
+#define VICE_ERROR_OK                 0x00
+
+// Checkpoint CPU operations.
+#define VICE_CHECKPOINT_LOAD          0x01
+#define VICE_CHECKPOINT_STORE         0x02
+#define VICE_CHECKPOINT_EXEC          0x04
+
+#define VICE_MEMSPACE_MAIN            0x00
+
+// Bank 0 is the CPU's view of memory.
+#define VICE_BANK_CPU                 0x0000
+
+// Reset types.
+#define VICE_RESET_SOFT               0x00
+#define VICE_RESET_HARD               0x01
+
+// Frames requests and responses on the monitor socket.  What the requests
+// mean is up to the user of the connection, this just hands each complete
+// response back as it arrives.
+class CViceBinaryMonitor : public QObject
+{
+   Q_OBJECT
+public:
+   explicit CViceBinaryMonitor(QString monitorIPAddress,int monitorPort,QObject *parent = 0);
+   virtual ~CViceBinaryMonitor();
+
+   // Helpers for building and picking apart request and response bodies.
+   static void appendU8(QByteArray& body,uint8_t value);
+   static void appendU16(QByteArray& body,uint16_t value);
+   static void appendU32(QByteArray& body,uint32_t value);
+   static uint8_t getU8(const QByteArray& body,int offset);
+   static uint16_t getU16(const QByteArray& body,int offset);
+   static uint32_t getU32(const QByteArray& body,int offset);
+
+signals:
+   void response(uint requestId,int type,int error,QByteArray body);
+   void monitorConnected();
+   void monitorDisconnected();
+   void monitorError(QString message);
+
+public slots:
+   void sendCommand(uint requestId,int command,QByteArray body);
+
+private slots:
+   void error(QAbstractSocket::SocketError error);
+   void connected();
+   void disconnected();
+   void readyRead();
+
+private:
+   QTcpSocket* m_pSocket;
+   QString     m_ipAddress;
+   int         m_port;
+
+   // Requests made before the connection is up are sent once it is.
+   QList<QByteArray> m_pending;
+
+   // Received bytes not yet making up a whole response.
+   QByteArray  m_received;
+};
+
+// 256-byte pages of the machine's memory that may have changed since they
+// were last fetched over the monitor.
+class CViceDirtyPages
+{
+public:
+   CViceDirtyPages();
+
+   void markAll();
+   void mark(uint32_t addr,uint32_t length);
+   bool isDirty(uint32_t addr) const { return m_pages.testBit((addr>>8)&0xFF); }
+
+   // Takes each run of dirty pages, a quarter of memory at most, as the
+   // body of a VICE_CMD_MEMORY_GET request for it, with the address the
+   // run starts at.  No pages are dirty afterwards.
+   QList<QByteArray> take(QList<uint32_t>* starts);
+
+private:
+   QBitArray m_pages;
+};
+
+#endif // CVICEBINARYMONITOR_H
@@ -8,6 +8,7 @@ CRendererBase::CRendererBase(int sizeX,int sizeY,int textureSizeXY,int maxZoom,c
       _scrollY(0),
       _textureSizeXY(textureSizeXY),
       _imageData(imageData),
+      _overlayData(0),
       _zoomFactor(100),
       _maxZoom(maxZoom)
 {
@@ -23,6 +24,7 @@ CRendererBase::CRendererBase(int sizeX,int sizeY,int maxZoom,char* imageData,QWi
     _scrollX(0),
     _scrollY(0),
     _imageData(imageData),
+    _overlayData(0),
     _zoomFactor(100),
     _maxZoom(maxZoom)
 {
@@ -47,11 +49,13 @@ CRendererBase::CRendererBase(int sizeX,int sizeY,int maxZoom,char* imageData,QWi
 CRendererBase::~CRendererBase()
 {
    glDeleteTextures(1,(GLuint*)&_textureID);
+   glDeleteTextures(1,(GLuint*)&_overlayTextureID);
 }
 
 void CRendererBase::initializeGL()
 {
    glGenTextures(1,(GLuint*)&_textureID);
+   glGenTextures(1,(GLuint*)&_overlayTextureID);
 
    // Enable flat shading
    glShadeModel(GL_FLAT);
@@ -98,6 +102,16 @@ void CRendererBase::initializeGL()
 
    // Load the actual texture
    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _textureSizeXY, _textureSizeXY, 0, GL_RGBA, GL_UNSIGNED_BYTE, _imageData);
+
+   // The overlay is a second texture of the same size, blended over the
+   // first by its alpha.
+   glBindTexture(GL_TEXTURE_2D, _overlayTextureID);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _textureSizeXY, _textureSizeXY, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+   glBindTexture(GL_TEXTURE_2D, _textureID);
 }
 
 void CRendererBase::reloadData(char* imageData)
@@ -107,6 +121,13 @@ void CRendererBase::reloadData(char* imageData)
    update();
 }
 
+void CRendererBase::reloadOverlay(char* overlayData)
+{
+   _overlayData = overlayData;
+
+   update();
+}
+
 void CRendererBase::setBGColor(QColor clr)
 {
    glClearColor((float)clr.red() / 255.0f, (float)clr.green() / 255.0f, (float)clr.blue() / 255.0f, 0.5f);
@@ -169,6 +190,27 @@ void CRendererBase::paintGL()
    glTexCoord2f (0.0, scaleY);
    glVertex3f(000.0f - _scrollX, _sizeY - _scrollY, 0.0f);
    glEnd();
+
+   if ( _overlayData )
+   {
+      glEnable(GL_BLEND);
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+      glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+      glBindTexture (GL_TEXTURE_2D, _overlayTextureID);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _textureSizeXY, _textureSizeXY, GL_RGBA, GL_UNSIGNED_BYTE, _overlayData);
+      glBegin(GL_QUADS);
+      glTexCoord2f (0.0, 0.0);
+      glVertex3f(000.0f - _scrollX, 000.0f - _scrollY, 0.0f);
+      glTexCoord2f (scaleX, 0.0);
+      glVertex3f(_sizeX - _scrollX, 000.0f - _scrollY, 0.0f);
+      glTexCoord2f (scaleX, scaleY);
+      glVertex3f(_sizeX - _scrollX, _sizeY - _scrollY, 0.0f);
+      glTexCoord2f (0.0, scaleY);
+      glVertex3f(000.0f - _scrollX, _sizeY - _scrollY, 0.0f);
+      glEnd();
+      glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_DECAL);
+      glDisable(GL_BLEND);
+   }
 }
 
 void CRendererBase::changeZoom(int newZoom)
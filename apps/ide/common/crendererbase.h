@@ -23,6 +23,7 @@ public:
    void paintGL();
    void changeZoom(int newZoom);
    void reloadData(char* imageData);
+   void reloadOverlay(char* overlayData);
    void setBGColor(QColor clr);
    void setScrollX(int scrollX) { _scrollX = scrollX; }
    void setScrollY(int scrollY) { _scrollY = scrollY; }
@@ -37,9 +38,11 @@ protected:
    int _scrollY;
    int _textureSizeXY;
    char* _imageData;
+   char* _overlayData;
    int _zoomFactor;
    int _maxZoom;
    GLuint _textureID;
+   GLuint _overlayTextureID;
 };
 
 #endif // CRENDERERBASE_H
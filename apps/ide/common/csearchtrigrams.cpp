@@ -0,0 +1,225 @@
+#include "csearchtrigrams.h"
+
+#include <QByteArray>
+#include <QtAlgorithms>
+
+static inline uchar foldCase(uchar c)
+{
+   return ((c >= 'A') && (c <= 'Z'))?(c+('a'-'A')):c;
+}
+
+void CSearchTrigrams::add(const uchar* text,int length,QVector<quint32>* trigrams)
+{
+   int idx;
+
+   for ( idx = 0; idx+2 < length; idx++ )
+   {
+      trigrams->append((foldCase(text[idx])<<16)|(foldCase(text[idx+1])<<8)|foldCase(text[idx+2]));
+   }
+}
+
+void CSearchTrigrams::sort(QVector<quint32>* trigrams)
+{
+   int from;
+   int to = 0;
+
+   qSort(trigrams->begin(),trigrams->end());
+   for ( from = 0; from < trigrams->count(); from++ )
+   {
+      if ( (to == 0) || (trigrams->at(from) != trigrams->at(to-1)) )
+      {
+         (*trigrams)[to++] = trigrams->at(from);
+      }
+   }
+   trigrams->resize(to);
+}
+
+// Reads the escape whose \ is at idx, leaving idx on its last character.
+// Returns the ASCII character it stands for, or -1 if it doesn't stand for
+// one.  QRegExp reads up to four hex digits after \x and up to three octal
+// digits after \0.
+int CSearchTrigrams::escape(const QString& text,int* idx)
+{
+   int value = 0;
+   int digits;
+   int digit;
+   char c;
+
+   if ( (*idx)+1 >= text.length() )
+   {
+      return -1;
+   }
+   (*idx)++;
+   if ( text.at(*idx).unicode() >= 0x80 )
+   {
+      return -1;
+   }
+   if ( !text.at(*idx).isLetterOrNumber() )
+   {
+      return text.at(*idx).toLatin1();
+   }
+
+   switch ( text.at(*idx).toLatin1() )
+   {
+      case 'a':
+         return '\a';
+      case 'f':
+         return '\f';
+      case 'n':
+         return '\n';
+      case 'r':
+         return '\r';
+      case 't':
+         return '\t';
+      case 'v':
+         return '\v';
+      case 'x':
+         for ( digits = 0; (digits < 4) && ((*idx)+1 < text.length()); digits++ )
+         {
+            c = text.at((*idx)+1).toLower().toLatin1();
+            if ( (c >= '0') && (c <= '9') )
+            {
+               digit = c-'0';
+            }
+            else if ( (c >= 'a') && (c <= 'f') )
+            {
+               digit = c-('a'-10);
+            }
+            else
+            {
+               break;
+            }
+            value = (value<<4)|digit;
+            (*idx)++;
+         }
+         return (digits && (value < 0x80))?value:-1;
+      case '0':
+         for ( digits = 0; (digits < 3) && ((*idx)+1 < text.length()); digits++ )
+         {
+            c = text.at((*idx)+1).toLatin1();
+            if ( (c < '0') || (c > '7') )
+            {
+               break;
+            }
+            value = (value<<3)|(c-'0');
+            (*idx)++;
+         }
+         return (value < 0x80)?value:-1;
+   }
+
+   // Classes like \d and \w, assertions like \b and back references.
+   return -1;
+}
+
+QVector<quint32> CSearchTrigrams::search(QString searchText,bool useRegex)
+{
+   QVector<quint32> trigrams;
+   QByteArray literal;
+   QChar c;
+   int depth = 0;
+   int value;
+   int idx;
+
+   if ( !useRegex )
+   {
+      literal = searchText.toLatin1();
+      for ( idx = 0; idx < searchText.length(); idx++ )
+      {
+         // Case folding beyond ASCII isn't modelled by the index.
+         if ( searchText.at(idx).unicode() >= 0x80 )
+         {
+            return trigrams;
+         }
+      }
+      add((const uchar*)literal.constData(),literal.length(),&trigrams);
+      sort(&trigrams);
+      return trigrams;
+   }
+
+   // Only runs of plain characters every match must contain are used;
+   // anything inside a group or character class, or made optional by a
+   // quantifier, ends the run it's in.  An alternation could match without
+   // any of them, so then every file is a candidate.
+   if ( searchText.contains('|') )
+   {
+      return trigrams;
+   }
+   for ( idx = 0; idx <= searchText.length(); idx++ )
+   {
+      c = (idx < searchText.length())?searchText.at(idx):QChar();
+
+      if ( depth )
+      {
+         if ( c == '\\' )
+         {
+            idx++;
+         }
+         else if ( c == '(' )
+         {
+            depth++;
+         }
+         else if ( c == ')' )
+         {
+            depth--;
+         }
+         continue;
+      }
+
+      if ( c == '\\' )
+      {
+         // The whole escape is read here, so none of its digits are taken
+         // for plain characters.
+         value = escape(searchText,&idx);
+         if ( value >= 0 )
+         {
+            literal.append((char)value);
+            continue;
+         }
+      }
+      else if ( (!c.isNull()) && (c.unicode() < 0x80) && (!QString(".^$[]()*+?{}").contains(c)) )
+      {
+         literal.append(c.toLatin1());
+         continue;
+      }
+
+      // The run ends here.
+      if ( (c == '*') || (c == '?') || (c == '{') )
+      {
+         literal.chop(1);
+      }
+      add((const uchar*)literal.constData(),literal.length(),&trigrams);
+      literal.clear();
+
+      if ( c == '(' )
+      {
+         depth++;
+      }
+      else if ( c == '{' )
+      {
+         idx = searchText.indexOf('}',idx);
+         if ( idx < 0 )
+         {
+            break;
+         }
+      }
+      else if ( c == '[' )
+      {
+         // A ] straight after the [ or [^ is one of the characters.
+         idx++;
+         if ( (idx < searchText.length()) && (searchText.at(idx) == '^') )
+         {
+            idx++;
+         }
+         for ( idx++; (idx < searchText.length()) && (searchText.at(idx) != ']'); idx++ )
+         {
+            if ( searchText.at(idx) == '\\' )
+            {
+               idx++;
+            }
+         }
+      }
+   }
+   sort(&trigrams);
+
+   return trigrams;
+}
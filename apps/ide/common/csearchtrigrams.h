@@ -0,0 +1,26 @@
+#ifndef CSEARCHTRIGRAMS_H
+#define CSEARCHTRIGRAMS_H
+
+#include <QString>
+#include <QVector>
+
+// Trigrams (three byte sequences, folded to lower case) of file contents
+// and of search text, for the search index.
+class CSearchTrigrams
+{
+public:
+   // Appends the trigrams of text; sort() makes them sorted and distinct.
+   static void add(const uchar* text,int length,QVector<quint32>* trigrams);
+   static void sort(QVector<quint32>* trigrams);
+
+   // The sorted, distinct trigrams every match of the search text contains.
+   // For a regular expression these are the trigrams of its runs of plain
+   // characters.  Escapes that stand for one character, \. \x41 \0101 \t
+   // and the like, are part of a run; any other escape ends it.
+   static QVector<quint32> search(QString searchText,bool useRegex);
+
+private:
+   static int escape(const QString& text,int* idx);
+};
+
+#endif // CSEARCHTRIGRAMS_H
@@ -19,6 +19,7 @@ public:
    void commonConstructor(bool showPalette);
    virtual ~PanZoomRenderer();
    void reloadData(char* imageData) { renderer->reloadData(imageData); }
+   void reloadOverlay(char* overlayData) { renderer->reloadOverlay(overlayData); }
    QColor getColor(int idx);
    void showPalette(bool show);
    bool pointToPixel(int ptx,int pty,int* pixx,int* pixy) { return renderer->pointToPixel(ptx,pty,pixx,pixy); }
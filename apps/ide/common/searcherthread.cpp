@@ -1,7 +1,86 @@
 #include "searcherthread.h"
+#include "csearchtrigrams.h"
 
 #include "main.h"
 
+#include <QRunnable>
+#include <QSet>
+#include <QtAlgorithms>
+
+// Number of candidate files matched by each task on the thread pool.
+#define SEARCH_BATCH_FILES 16
+
+// Matches a batch of files line by line.
+class SearchTask : public QRunnable
+{
+public:
+   SearchTask(SearcherThread* searcher,int batch,QStringList files,QString searchText,bool useRegex,bool caseSensitive)
+      : m_searcher(searcher),
+        m_batch(batch),
+        m_files(files),
+        m_searchText(searchText),
+        m_useRegex(useRegex),
+        m_caseSensitive(caseSensitive)
+   {
+   }
+
+   virtual void run()
+   {
+      QDir          base(QDir::currentPath());
+      QFile         file;
+      QString       content;
+      QStringList   contentLines;
+      QStringList   results;
+      QString       foundText;
+      bool          found;
+      int           line;
+      Qt::CaseSensitivity caseSensitivity = (m_caseSensitive)?Qt::CaseSensitive:Qt::CaseInsensitive;
+      QRegExp       regex;
+
+      // Each task has its own QRegExp; they keep match state.
+      regex = QRegExp(m_searchText);
+      regex.setCaseSensitivity(caseSensitivity);
+
+      foreach ( QString fileName, m_files )
+      {
+         file.setFileName(fileName);
+         if ( file.open(QIODevice::ReadOnly) )
+         {
+            content = file.readAll();
+            contentLines = content.split('\n');
+
+            for ( line = 0; line < contentLines.count(); line++ )
+            {
+               if ( m_useRegex )
+               {
+                  found = contentLines.at(line).contains(regex);
+               }
+               else
+               {
+                  found = contentLines.at(line).contains(m_searchText,caseSensitivity);
+               }
+               if ( found )
+               {
+                  foundText.sprintf("%s:%d:%s",base.relativeFilePath(fileName).toAscii().constData(),line+1,contentLines.at(line).toAscii().constData());
+                  results.append(foundText);
+               }
+            }
+            file.close();
+         }
+      }
+
+      m_searcher->batchDone(m_batch,results);
+   }
+
+private:
+   SearcherThread* m_searcher;
+   int m_batch;
+   QStringList m_files;
+   QString m_searchText;
+   bool m_useRegex;
+   bool m_caseSensitive;
+};
+
 SearcherThread::SearcherThread(QObject*)
 {
    m_found = 0;
@@ -15,6 +94,8 @@ SearcherThread::SearcherThread(QObject*)
 
 SearcherThread::~SearcherThread()
 {
+   m_pool.waitForDone();
+
    pThread->terminate();
    pThread->wait();
    delete pThread;
@@ -22,6 +103,14 @@ SearcherThread::~SearcherThread()
 
 void SearcherThread::search(QDir dir, QString searchText, QString pattern, bool subfolders, bool sourceSearchPaths, bool useRegex, bool caseSensitive)
 {
+   QStringList files;
+   QStringList candidates;
+   QStringList results;
+   QVector<quint32> trigrams;
+   int batches;
+   int batch;
+   int idx;
+
    m_dir = dir;
    m_searchText = searchText;
    m_pattern = pattern;
@@ -31,70 +120,147 @@ void SearcherThread::search(QDir dir, QString searchText, QString pattern, bool
    m_caseSensitive = caseSensitive;
 
    m_found = 0;
-   doSearch(m_dir,&m_found);
+   indexFiles(m_dir,m_subfolders,&files);
+   m_indexedDirs[m_dir.absolutePath()] |= m_subfolders;
    if ( m_sourceSearchPaths )
    {
       foreach ( QString searchPath, nesicideProject->getSourceSearchPaths() )
       {
          m_dir = searchPath;
-         doSearch(m_dir,&m_found);
+         indexFiles(m_dir,m_subfolders,&files);
+         m_indexedDirs[m_dir.absolutePath()] |= m_subfolders;
+      }
+   }
+   files.removeDuplicates();
+
+   // Only files holding every trigram of the search text can match.
+   trigrams = CSearchTrigrams::search(m_searchText,m_useRegex);
+   foreach ( QString fileName, files )
+   {
+      const QVector<quint32>& fileTrigrams = m_index[fileName].trigrams;
+
+      for ( idx = 0; idx < trigrams.count(); idx++ )
+      {
+         if ( qBinaryFind(fileTrigrams.constBegin(),fileTrigrams.constEnd(),trigrams.at(idx)) == fileTrigrams.constEnd() )
+         {
+            break;
+         }
       }
+      if ( idx == trigrams.count() )
+      {
+         candidates.append(fileName);
+      }
+   }
+
+   batches = (candidates.count()+SEARCH_BATCH_FILES-1)/SEARCH_BATCH_FILES;
+   for ( batch = 0; batch < batches; batch++ )
+   {
+      m_pool.start(new SearchTask(this,batch,candidates.mid(batch*SEARCH_BATCH_FILES,SEARCH_BATCH_FILES),m_searchText,m_useRegex,m_caseSensitive));
+   }
+
+   // Log each batch as soon as it and every batch before it are done.
+   batch = 0;
+   for ( idx = 0; idx < batches; idx++ )
+   {
+      m_batchesDone.acquire();
+
+      m_resultsMutex.lock();
+      while ( m_results.contains(batch) )
+      {
+         results = m_results.take(batch);
+         m_resultsMutex.unlock();
+
+         if ( results.count() )
+         {
+            searchTextLogger->write(results.join("<br>"));
+            m_found += results.count();
+         }
+         batch++;
+
+         m_resultsMutex.lock();
+      }
+      m_resultsMutex.unlock();
    }
    emit searchDone(m_found);
 }
 
-void SearcherThread::doSearch(QDir dir,int* finds)
+void SearcherThread::batchDone(int batch,QStringList results)
+{
+   m_resultsMutex.lock();
+   m_results.insert(batch,results);
+   m_resultsMutex.unlock();
+
+   m_batchesDone.release();
+}
+
+void SearcherThread::updateIndex()
+{
+   QHash<QString,bool>::const_iterator iter;
+   QStringList files;
+   QStringList removed;
+
+   // Forget files that have gone away...
+   foreach ( QString fileName, m_index.keys() )
+   {
+      if ( !QFile::exists(fileName) )
+      {
+         removed.append(fileName);
+      }
+   }
+   foreach ( QString fileName, removed )
+   {
+      m_index.remove(fileName);
+   }
+
+   // ...and pick up changes to the rest so the next search needn't.
+   for ( iter = m_indexedDirs.constBegin(); iter != m_indexedDirs.constEnd(); ++iter )
+   {
+      indexFiles(QDir(iter.key()),iter.value(),&files);
+   }
+}
+
+void SearcherThread::indexFiles(QDir dir,bool subfolders,QStringList* files)
 {
-   QDir          base(QDir::currentPath());
    QFileInfoList entries = dir.entryInfoList(QDir::AllDirs|QDir::NoDotAndDotDot|QDir::NoSymLinks|QDir::Files);
-   QFile         file;
-   QString       content;
-   QStringList   contentLines;
-   QString       foundText;
-   bool          found;
-   int           entry;
-   int           line;
-   Qt::CaseSensitivity caseSensitivity = (m_caseSensitive)?Qt::CaseSensitive:Qt::CaseInsensitive;
-   QRegExp       regex;
-
-   regex = QRegExp(m_searchText);
-   regex.setCaseSensitivity(caseSensitivity);
+   QHash<QString,SearchIndexEntry>::const_iterator indexed;
+   int entry;
 
    for ( entry = 0; entry < entries.count(); entry++ )
    {
-      if ( (m_subfolders) && (entries.at(entry).isDir()) )
+      if ( (subfolders) && (entries.at(entry).isDir()) )
       {
-         doSearch(QDir(entries.at(entry).filePath()),finds);
+         indexFiles(QDir(entries.at(entry).filePath()),subfolders,files);
       }
       else if ( entries.at(entry).isFile() )
       {
-         file.setFileName(entries.at(entry).filePath());
-         if ( file.open(QIODevice::ReadOnly) )
+         indexed = m_index.constFind(entries.at(entry).filePath());
+         if ( (indexed == m_index.constEnd()) ||
+              (indexed.value().modified != entries.at(entry).lastModified()) ||
+              (indexed.value().size != entries.at(entry).size()) )
          {
-            content.clear();
-            content = file.readAll();
-            contentLines.clear();
-            contentLines = content.split(QRegExp("[\n]"));
-
-            for ( line = 0; line < contentLines.count(); line++ )
-            {
-               if ( m_useRegex )
-               {
-                  found = contentLines.at(line).contains(regex);
-               }
-               else
-               {
-                  found = contentLines.at(line).contains(m_searchText,caseSensitivity);
-               }
-               if ( found )
-               {
-                  foundText.sprintf("%s:%d:%s",base.relativeFilePath(entries.at(entry).filePath()).toAscii().constData(),line+1,contentLines.at(line).toAscii().constData());
-                  searchTextLogger->write(foundText);
-                  (*finds)++;
-               }
-            }
-            file.close();
+            indexFile(entries.at(entry));
          }
+         files->append(entries.at(entry).filePath());
       }
    }
 }
+
+void SearcherThread::indexFile(QFileInfo fileInfo)
+{
+   QFile file(fileInfo.filePath());
+   SearchIndexEntry entry;
+   QByteArray content;
+
+   if ( file.open(QIODevice::ReadOnly) )
+   {
+      content = file.readAll();
+      file.close();
+   }
+
+   entry.modified = fileInfo.lastModified();
+   entry.size = fileInfo.size();
+   CSearchTrigrams::add((const uchar*)content.constData(),content.length(),&entry.trigrams);
+   CSearchTrigrams::sort(&entry.trigrams);
+
+   m_index.insert(fileInfo.filePath(),entry);
+}
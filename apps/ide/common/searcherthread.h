@@ -2,9 +2,32 @@
 #define SEARCHERTHREAD_H
 
 #include <QThread>
+#include <QThreadPool>
 #include <QDir>
+#include <QDateTime>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
 #include <QSemaphore>
+#include <QStringList>
+#include <QVector>
 
+// What the search index knows of one file: the sorted, distinct trigrams
+// (three byte sequences, folded to lower case) it contains, and the
+// modification time and size they were taken at.
+typedef struct
+{
+   QDateTime        modified;
+   qint64           size;
+   QVector<quint32> trigrams;
+} SearchIndexEntry;
+
+// Searches are answered from a trigram index of every file searched so
+// far.  Each search first checks the files under the search location
+// against the index, reading again only files whose modification time or
+// size has changed, then reads only the files holding every trigram of the
+// search text.  Candidate files are matched line by line in batches on a
+// thread pool and the results are logged a batch at a time, in file order.
 class SearcherThread : public QObject
 {
    Q_OBJECT
@@ -12,8 +35,12 @@ public:
    SearcherThread ( QObject* parent = 0 );
    virtual ~SearcherThread ();
 
+   // Called from the thread pool when a batch of files has been matched.
+   void batchDone(int batch,QStringList results);
+
 public slots:
    void search(QDir dir, QString searchText, QString pattern, bool subfolders, bool sourceSearchPaths, bool useRegex, bool caseSensitive);
+   void updateIndex();
 
 signals:
    void searchDone(int found);
@@ -21,7 +48,8 @@ signals:
 protected:
    QThread* pThread;
 
-   void doSearch(QDir dir,int* finds);
+   void indexFiles(QDir dir,bool subfolders,QStringList* files);
+   void indexFile(QFileInfo fileInfo);
    bool m_isTerminating;
    QDir m_dir;
    QString m_searchText;
@@ -31,6 +59,18 @@ protected:
    bool m_useRegex;
    bool m_caseSensitive;
    int m_found;
+
+   // The index, and the locations indexed so far with whether their
+   // subfolders were included.
+   QHash<QString,SearchIndexEntry> m_index;
+   QHash<QString,bool> m_indexedDirs;
+
+   // Matching is done on m_pool; finished batches wait in m_results until
+   // the batches before them are logged.
+   QThreadPool m_pool;
+   QMutex m_resultsMutex;
+   QSemaphore m_batchesDone;
+   QMap<int,QStringList> m_results;
 };
 
 #endif // SEARCHERTHREAD_H
@@ -1,6 +1,9 @@
 #include "ccc65interface.h"
 
+#include <QtAlgorithms>
+
 #include "cnesicideproject.h"
+#include "compilerthread.h"
 #include "iprojecttreeviewitem.h"
 
 #include "dbg_cnes6502.h"
@@ -10,17 +13,19 @@
 cc65_dbginfo        CCC65Interface::dbgInfo = NULL;
 QStringList         CCC65Interface::errors;
 QString             CCC65Interface::targetMachine = "none";
+unsigned int        CCC65Interface::debugInfoRevision = 0;
+QHash<QString,QList<SourceLineAddress> > CCC65Interface::lineAddresses;
 
 static const char* clangTargetRuleFmt =
       "vpath %<!extension!> $(foreach <!extension!>,$(SOURCES),$(dir $<!extension!>))\r\n\r\n"
-      "$(OBJDIR)/%.o: %.<!extension!>\r\n"
+      "$(OBJDIR)/%.o: %.<!extension!> | $(OBJDIR)\r\n"
       "\t$(COMPILE) --create-dep $(@:.o=.d) -S $(CFLAGS) -o $(@:.o=.s) $<\r\n\r\n"
       "\t$(ASSEMBLE) $(ASFLAGS) -o $@ $(@:.o=.s)\r\n\r\n"
       ;
 
 static const char* asmTargetRuleFmt =
       "vpath %<!extension!> $(foreach <!extension!>,$(SOURCES),$(dir $<!extension!>))\r\n\r\n"
-      "$(OBJDIR)/%.o: %.<!extension!>\r\n"
+      "$(OBJDIR)/%.o: %.<!extension!> | $(OBJDIR)\r\n"
       "\t$(ASSEMBLE) --create-dep $(@:.o=.d) $(ASFLAGS) -o $@ $<\r\n\r\n"
       ;
 
@@ -42,6 +47,8 @@ void CCC65Interface::clear()
 {
    cc65_free_dbginfo(dbgInfo);
    dbgInfo = 0;
+   lineAddresses.clear();
+   debugInfoRevision++;
 }
 
 QStringList CCC65Interface::getAssemblerSourcesFromProject()
@@ -235,14 +242,8 @@ void CCC65Interface::clean()
 
 bool CCC65Interface::assemble()
 {
-   QProcess                     make;
-   QProcessEnvironment          env = QProcessEnvironment::systemEnvironment();
-   QString                      invocationStr;
-   QString                      stdioStr;
-   QStringList                  stdioList;
    QDir                         outputDir(nesicideProject->getProjectLinkerOutputBasePath());
    QString                      outputName;
-   int                          exitCode;
    bool                         ok = true;
 
    if ( nesicideProject->getProjectLinkerOutputName().isEmpty() )
@@ -255,37 +256,12 @@ bool CCC65Interface::assemble()
    }
    buildTextLogger->write("<b>Building: "+outputName+"</b>");
 
-   // Copy the system environment to the child process.
-   make.setProcessEnvironment(env);
-   make.setWorkingDirectory(QDir::currentPath());
-
    // Clear the error storage.
    errors.clear();
 
    createMakefile();
 
-   invocationStr = "make -f nesicide.mk all";
-
-   buildTextLogger->write(invocationStr);
-
-   make.start(invocationStr);
-   make.waitForFinished();
-   make.waitForReadyRead();
-   exitCode = make.exitCode();
-   stdioStr = QString(make.readAllStandardOutput());
-   stdioList = stdioStr.split(QRegExp("[\r\n]"),QString::SkipEmptyParts);
-   foreach ( const QString& str, stdioList )
-   {
-      buildTextLogger->write("<font color='blue'>"+str+"</font>");
-   }
-   stdioStr = QString(make.readAllStandardError());
-   stdioList = stdioStr.split(QRegExp("[\r\n]"),QString::SkipEmptyParts);
-   errors.append(stdioList);
-   foreach ( const QString& str, stdioList )
-   {
-      buildTextLogger->write("<font color='red'>"+str+"</font>");
-   }
-   if ( exitCode )
+   if ( CompilerThread::make("-f nesicide.mk all",&errors) )
    {
       ok = false;
    }
@@ -834,6 +810,97 @@ unsigned int CCC65Interface::getSymbolSize(QString symbol, int index)
    return size;
 }
 
+bool CCC65Interface::getSymbolTypeLayout(QString symbol,int index,unsigned int* elementSize,bool* pointer)
+{
+   const cc65_symbolinfo* dbgSymbols;
+   const cc65_csyminfo* dbgCSymbols;
+   const cc65_typedata* dbgType;
+   unsigned int symbolId = CC65_INV_ID;
+   unsigned int typeId = CC65_INV_ID;
+   unsigned int csym;
+   int sym;
+   bool found = false;
+
+   // The C type of a symbol is only known if the symbol came from C source;
+   // the C symbol refers back to the assembler symbol it was emitted as.
+   if ( dbgInfo )
+   {
+      dbgSymbols = cc65_symbol_byname(dbgInfo,symbol.toAscii().constData());
+
+      if ( dbgSymbols )
+      {
+         for ( sym = 0; sym < dbgSymbols->count; sym++ )
+         {
+            if ( dbgSymbols->data[sym].export_id == CC65_INV_ID )
+            {
+               if ( !index )
+               {
+                  break;
+               }
+               index--;
+            }
+         }
+         if ( sym < dbgSymbols->count )
+         {
+            symbolId = dbgSymbols->data[sym].symbol_id;
+         }
+
+         cc65_free_symbolinfo(dbgInfo,dbgSymbols);
+      }
+
+      dbgCSymbols = cc65_get_csymlist(dbgInfo);
+
+      if ( dbgCSymbols && (symbolId != CC65_INV_ID) )
+      {
+         for ( csym = 0; csym < dbgCSymbols->count; csym++ )
+         {
+            if ( dbgCSymbols->data[csym].symbol_id == symbolId )
+            {
+               typeId = dbgCSymbols->data[csym].type_id;
+               break;
+            }
+         }
+      }
+      if ( dbgCSymbols )
+      {
+         cc65_free_csyminfo(dbgInfo,dbgCSymbols);
+      }
+
+      if ( typeId != CC65_INV_ID )
+      {
+         dbgType = cc65_type_byid(dbgInfo,typeId);
+
+         if ( dbgType )
+         {
+            switch ( dbgType->what )
+            {
+               case CC65_TYPE_ARRAY:
+                  (*elementSize) = dbgType->data.array.ele_type ? dbgType->data.array.ele_type->size : 0;
+                  (*pointer) = false;
+                  found = true;
+                  break;
+               case CC65_TYPE_PTR:
+               case CC65_TYPE_FARPTR:
+                  // Only void pointers are described at the moment, so
+                  // the pointed-to size is usually unknown.
+                  (*elementSize) = dbgType->data.ptr.ind_type ? dbgType->data.ptr.ind_type->size : 0;
+                  (*pointer) = true;
+                  found = true;
+                  break;
+               default:
+                  (*elementSize) = dbgType->size;
+                  (*pointer) = false;
+                  found = true;
+                  break;
+            }
+
+            cc65_free_typedata(dbgInfo,dbgType);
+         }
+      }
+   }
+   return found;
+}
+
 int CCC65Interface::getSymbolMatchCount(QString symbol)
 {
    const cc65_symbolinfo* dbgSymbols;
@@ -1370,6 +1437,88 @@ int CCC65Interface::getLineMatchCount(QString file, int source_line)
    return count;
 }
 
+static bool lessThanByAbsoluteAddress(const SourceLineAddress& a,const SourceLineAddress& b)
+{
+   return a.absAddr < b.absAddr;
+}
+
+QList<SourceLineAddress> CCC65Interface::getLineAddressesForFile(QString file)
+{
+   QHash<QString,QList<SourceLineAddress> >::const_iterator cached = lineAddresses.constFind(file);
+   QList<SourceLineAddress> addresses;
+   QList<int> sourceLines;
+   SourceLineAddress address;
+   const cc65_sourceinfo* dbgSources;
+   const cc65_lineinfo* dbgLines;
+   int fidx;
+   int idx;
+   int entry;
+   int count;
+
+   if ( cached != lineAddresses.constEnd() )
+   {
+      return cached.value();
+   }
+
+   if ( dbgInfo )
+   {
+      // Find the lines of the file that produced anything...
+      dbgSources = cc65_get_sourcelist(dbgInfo);
+
+      if ( dbgSources )
+      {
+         for ( fidx = 0; fidx < dbgSources->count; fidx++ )
+         {
+            if ( dbgSources->data[fidx].source_name == file )
+            {
+               dbgLines = cc65_line_bysource(dbgInfo,dbgSources->data[fidx].source_id);
+
+               if ( dbgLines )
+               {
+                  for ( idx = 0; idx < dbgLines->count; idx++ )
+                  {
+                     sourceLines.append(dbgLines->data[idx].source_line);
+                  }
+
+                  cc65_free_lineinfo(dbgInfo,dbgLines);
+               }
+               break;
+            }
+         }
+
+         cc65_free_sourceinfo(dbgInfo,dbgSources);
+      }
+
+      // ...and look each up the same way a single line is looked up.
+      qSort(sourceLines);
+      for ( idx = 0; idx < sourceLines.count(); idx++ )
+      {
+         if ( idx && (sourceLines.at(idx) == sourceLines.at(idx-1)) )
+         {
+            continue;
+         }
+
+         count = getLineMatchCount(file,sourceLines.at(idx));
+         for ( entry = 0; entry < count; entry++ )
+         {
+            address.line = sourceLines.at(idx);
+            address.addr = getAddressFromFileAndLine(file,address.line,entry);
+            address.absAddr = getAbsoluteAddressFromFileAndLine(file,address.line,entry);
+
+            if ( address.addr != (unsigned int)-1 )
+            {
+               addresses.append(address);
+            }
+         }
+      }
+      qStableSort(addresses.begin(),addresses.end(),lessThanByAbsoluteAddress);
+
+      lineAddresses.insert(file,addresses);
+   }
+
+   return addresses;
+}
+
 unsigned int CCC65Interface::getAddressFromFileAndLine(QString file,int source_line,int entry)
 {
    const cc65_sourceinfo* dbgSources;
@@ -2,11 +2,20 @@
 #define CCC65INTERFACE_H
 
 #include <QProcess>
+#include <QHash>
 
 #include "stdint.h"
 
 #include "dbginfo.h"
 
+// One of the addresses a source line was assembled to.
+typedef struct
+{
+   int          line;
+   unsigned int addr;
+   unsigned int absAddr;
+} SourceLineAddress;
+
 class CCC65Interface : public QObject
 {
    Q_OBJECT
@@ -15,6 +24,7 @@ public:
    CCC65Interface();
    virtual ~CCC65Interface();
    static void clear();
+   static unsigned int getDebugInfoRevision() { return debugInfoRevision; }
 
    // Makefile and target image APIs.
    static bool createMakefile();
@@ -39,10 +49,12 @@ public:
    static QString getSymbolSegmentName(QString symbol, int index = 0);
    static unsigned int getSymbolIndexFromSegment(QString symbol,int segment);
    static unsigned int getSymbolSize(QString symbol,int index = 0);
+   static bool getSymbolTypeLayout(QString symbol,int index,unsigned int* elementSize,bool* pointer);
    static int getSourceLineFromFileAndSymbol(QString file,QString symbol);
    static QString getSourceFileFromSymbol(QString symbol);
    static int getLineMatchCount(QString file,int source_line);
    static unsigned int getAddressFromFileAndLine(QString file,int source_line,int entry = -1);
+   static QList<SourceLineAddress> getLineAddressesForFile(QString file);
    static QStringList getErrors() { return errors; }
    static bool isErrorOnLineOfFile(QString file,int source_line);
    static bool isStringASymbol(QString string);
@@ -75,6 +87,14 @@ protected:
    static cc65_dbginfo        dbgInfo;
    static QStringList         errors;
    static QString             targetMachine;
+
+   // Bumped whenever the debug information is thrown away, so anything
+   // holding on to resolved symbols knows to resolve them again.
+   static unsigned int        debugInfoRevision;
+
+   // Every address of every line of each file asked about since the debug
+   // information was read, in absolute address order.
+   static QHash<QString,QList<SourceLineAddress> > lineAddresses;
 };
 
 #endif // CCC65INTERFACE_H
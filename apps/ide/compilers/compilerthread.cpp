@@ -5,6 +5,38 @@
 
 #include "main.h"
 
+#include <QProcess>
+#include <QFileInfo>
+#include <QDir>
+
+QHash<QString,QPair<QByteArray,QDateTime> > CompilerThread::m_outputs;
+
+// Pass along whatever complete lines the process has produced on the
+// specified channel to the build pane.  Once the process has finished
+// any partial last line is flushed too.
+static void writeProcessOutput(QProcess& process,QProcess::ProcessChannel channel,bool flush,QStringList* errors)
+{
+   QString color = (channel == QProcess::StandardError)?"red":"blue";
+   QString str;
+
+   process.setReadChannel(channel);
+
+   while ( process.canReadLine() || (flush && process.bytesAvailable()) )
+   {
+      str = QString(process.readLine());
+      str.remove(QRegExp("[\r\n]"));
+
+      if ( !str.isEmpty() )
+      {
+         if ( errors )
+         {
+            errors->append(str);
+         }
+         buildTextLogger->write("<font color='"+color+"'>"+str+"</font>");
+      }
+   }
+}
+
 CompilerThread::CompilerThread(QObject*)
 {
    m_assembledOk = false;
@@ -40,12 +72,79 @@ void CompilerThread::compile()
    emit compileDone(m_assembledOk);
 }
 
+int CompilerThread::make(QString arguments,QStringList* errors)
+{
+   QProcess            make;
+   QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+   QString             invocationStr;
+   int                 jobs;
+
+   // Copy the system environment to the child process.
+   make.setProcessEnvironment(env);
+   make.setWorkingDirectory(QDir::currentPath());
+
+   // Let make run as many recipes as there are cores to run them on.
+   jobs = QThread::idealThreadCount();
+   if ( jobs < 1 )
+   {
+      jobs = 1;
+   }
+
+   invocationStr = "make -j"+QString::number(jobs)+" "+arguments;
+
+   buildTextLogger->write(invocationStr);
+
+   make.start(invocationStr);
+   if ( !make.waitForStarted() )
+   {
+      buildTextLogger->write("<font color='red'>Error: could not run make: "+make.errorString()+"</font>");
+      return -1;
+   }
+
+   // Stream make's output to the build pane as it's produced rather
+   // than waiting for the whole build to finish.
+   while ( !make.waitForFinished(100) && (make.state() != QProcess::NotRunning) )
+   {
+      writeProcessOutput(make,QProcess::StandardOutput,false,NULL);
+      writeProcessOutput(make,QProcess::StandardError,false,errors);
+   }
+   writeProcessOutput(make,QProcess::StandardOutput,true,NULL);
+   writeProcessOutput(make,QProcess::StandardError,true,errors);
+
+   // A crashed make's exit code means nothing.
+   if ( make.exitStatus() != QProcess::NormalExit )
+   {
+      buildTextLogger->write("<font color='red'>Error: make did not finish: "+make.errorString()+"</font>");
+      return -1;
+   }
+
+   return make.exitCode();
+}
+
+bool CompilerThread::upToDate(QString outputName,QByteArray inputHash)
+{
+   QFileInfo fileInfo(outputName);
+
+   return m_outputs.contains(outputName) &&
+          (m_outputs.value(outputName).first == inputHash) &&
+          fileInfo.exists() &&
+          (m_outputs.value(outputName).second == fileInfo.lastModified());
+}
+
+void CompilerThread::madeFrom(QString outputName,QByteArray inputHash)
+{
+   QFileInfo fileInfo(outputName);
+
+   m_outputs.insert(outputName,QPair<QByteArray,QDateTime>(inputHash,fileInfo.lastModified()));
+}
+
 void CompilerThread::clean()
 {
    CCartridgeBuilder cartridgeBuilder;
    CMachineImageBuilder machineImageBuilder;
 
    emit cleanStarted();
+   m_outputs.clear();
    if ( !nesicideProject->getProjectTarget().compare("nes",Qt::CaseInsensitive) )
    {
       cartridgeBuilder.clean();
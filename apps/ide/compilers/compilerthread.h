@@ -3,6 +3,11 @@
 
 #include <QThread>
 #include <QSemaphore>
+#include <QStringList>
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QPair>
 
 enum
 {
@@ -20,6 +25,18 @@ public:
    bool assembledOk() { return m_assembledOk; }
    void reset() { m_assembledOk = false; }
 
+   // Runs make with the specified arguments and as many jobs as there are
+   // cores, passing its output to the build pane as it arrives.  Lines make
+   // writes to stderr are also added to errors.  Returns make's exit code,
+   // or -1 if make could not be run or did not exit normally.
+   static int make(QString arguments,QStringList* errors);
+
+   // The target builders record the hash of the inputs each output was
+   // made from, so an output whose inputs haven't changed since it was
+   // last made [and which hasn't been touched since] isn't made again.
+   static bool upToDate(QString outputName,QByteArray inputHash);
+   static void madeFrom(QString outputName,QByteArray inputHash);
+
 public slots:
    void compile();
    void clean();
@@ -35,6 +52,8 @@ protected:
    int  m_operation;
 
    QThread* pThread;
+
+   static QHash<QString,QPair<QByteArray,QDateTime> > m_outputs;
 };
 
 #endif // COMPILERTHREAD_H
@@ -16,6 +16,7 @@ CSymbolWatchModel::CSymbolWatchModel(bool editable,QObject *parent) :
    m_currentSortOrder = Qt::DescendingOrder;
    m_currentItemCount = 0;
    m_editable = editable;
+   m_debugInfoRevision = CCC65Interface::getDebugInfoRevision();
 }
 
 CSymbolWatchModel::~CSymbolWatchModel()
@@ -41,10 +42,7 @@ Qt::ItemFlags CSymbolWatchModel::flags(const QModelIndex& index) const
 
 QVariant CSymbolWatchModel::data(const QModelIndex& index, int role) const
 {
-   int addr;
-   int absAddr;
-   QString data;
-   int symbolIdx;
+   unsigned int addr;
    int size;
 
    if (role != Qt::DisplayRole)
@@ -55,53 +53,75 @@ QVariant CSymbolWatchModel::data(const QModelIndex& index, int role) const
    // Get data for columns...
    if ( index.row() < m_items.count() )
    {
-      // Get symbol's index in debug information from its segment.
-      symbolIdx = CCC65Interface::getSymbolIndexFromSegment(m_items.at(index.row()).symbol,m_items.at(index.row()).segment);
+      const WatchedItem& item = m_items.at(index.row());
+      const CWatchExpression& expression = item.expression;
 
+      // Symbols were resolved when the watch was compiled, so showing it
+      // only runs the compiled program and reads the memory.
       switch ( index.column() )
       {
          case SymbolWatchCol_Symbol:
-            return m_items.at(index.row()).symbol;
+            return item.symbol;
             break;
          case SymbolWatchCol_Address:
-            // Get symbol's information based on its name and index.
-            addr = CCC65Interface::getSymbolAddress(m_items.at(index.row()).symbol,symbolIdx);
-            absAddr = CCC65Interface::getSymbolAbsoluteAddress(m_items.at(index.row()).symbol,symbolIdx);
-            if ( addr != -1 )
+            if ( !expression.isValid() )
+            {
+               return QVariant("ERROR: "+expression.error());
+            }
+            else if ( expression.isSymbol() )
             {
-               nesGetPrintableAddressWithAbsolute(modelStringBuffer,addr,absAddr);
+               nesGetPrintableAddressWithAbsolute(modelStringBuffer,expression.symbolAddress(),expression.symbolAbsoluteAddress());
                return QVariant(modelStringBuffer);
             }
-            else
+            else if ( expression.isLvalue() )
             {
-               return QVariant("ERROR: Unresolved");
+               addr = expression.address();
+               if ( expression.space() == WatchSpace_CPU )
+               {
+                  nesGetPrintableAddress(modelStringBuffer,addr&0xFFFF);
+               }
+               else
+               {
+                  sprintf(modelStringBuffer,"%02X:%04X",addr/MEM_8KB,expression.cpuAddress(addr));
+               }
+               return QVariant(modelStringBuffer);
             }
             break;
          case SymbolWatchCol_Size:
-            size = CCC65Interface::getSymbolSize(m_items.at(index.row()).symbol,symbolIdx);
-            if ( size )
+            if ( expression.isLvalue() )
             {
-               return QVariant(size);
-            }
-            else
-            {
-               return QVariant("?");
+               size = expression.size();
+               if ( size )
+               {
+                  return QVariant(size);
+               }
+               else
+               {
+                  return QVariant("?");
+               }
             }
             break;
          case SymbolWatchCol_Value:
-            addr = CCC65Interface::getSymbolAddress(m_items.at(index.row()).symbol,symbolIdx);
-            if ( addr != -1 )
+            if ( !expression.isValid() )
+            {
+               return QVariant("ERROR: "+expression.error());
+            }
+            else if ( expression.isLvalue() )
             {
                char* bufferPtr = modelStringBuffer;
-               unsigned int symbolSize = CCC65Interface::getSymbolSize(m_items.at(index.row()).symbol,symbolIdx);
+               unsigned int symbolSize = expression.size();
+               uint8_t bytes [ 10 ];
 
                // If symbol size <= 10 print values as an array, seperated by commas
                if ((symbolSize > 0) && (symbolSize <= 10))
                {
+                  addr = expression.address();
+
                   unsigned int i=0;
                   for( ; i < symbolSize; ++i)
                   {
-                     bufferPtr += sprintf(bufferPtr, "%02X", nesGetMemory(addr + i));
+                     bytes[i] = expression.read(addr,i);
+                     bufferPtr += sprintf(bufferPtr, "%02X", bytes[i]);
                      if ( i < (symbolSize-1) )
                      {
                         bufferPtr += sprintf(bufferPtr, ",");
@@ -111,11 +131,11 @@ QVariant CSymbolWatchModel::data(const QModelIndex& index, int role) const
                   // If symbol is 2 bytes, print 16bit value in parentheses.
                   if (symbolSize == 2)
                   {
-                     sprintf(bufferPtr, " ($%02X%02X)",  nesGetMemory(addr + 1),  nesGetMemory(addr + 0));
+                     sprintf(bufferPtr, " ($%02X%02X)", bytes[1], bytes[0]);
                   }
                   else if (symbolSize == 3) // Same for 24 bit values.
                   {
-                     sprintf(bufferPtr, " ($%02X%02X%02X)",  nesGetMemory(addr + 2), nesGetMemory(addr + 1),  nesGetMemory(addr + 0));
+                     sprintf(bufferPtr, " ($%02X%02X%02X)", bytes[2], bytes[1], bytes[0]);
                   }
                }
                else
@@ -126,14 +146,22 @@ QVariant CSymbolWatchModel::data(const QModelIndex& index, int role) const
             }
             else
             {
-               return QVariant("ERROR: Unresolved");
+               addr = expression.value();
+               sprintf(modelStringBuffer,"$%X (%u)",addr,addr);
+               return QVariant(modelStringBuffer);
             }
             break;
          case SymbolWatchCol_Segment:
-            return CCC65Interface::getSymbolSegmentName(m_items.at(index.row()).symbol,symbolIdx);
+            if ( expression.isSymbol() )
+            {
+               return expression.symbolSegment();
+            }
             break;
          case SymbolWatchCol_File:
-            return CCC65Interface::getSourceFileFromSymbol(m_items.at(index.row()).symbol);
+            if ( expression.isSymbol() )
+            {
+               return expression.symbolFile();
+            }
             break;
       }
    }
@@ -169,6 +197,7 @@ bool CSymbolWatchModel::setData(const QModelIndex &index, const QVariant &value,
             {
                item.symbol = value.toString();
                item.segment = resolveSymbol(value.toString());
+               item.expression.compile(item.symbol,item.segment);
                m_items.replace(index.row(),item);
                emit layoutChanged();
                ok = true;
@@ -181,6 +210,7 @@ bool CSymbolWatchModel::setData(const QModelIndex &index, const QVariant &value,
                   beginInsertRows(QModelIndex(),m_items.count()+1,m_items.count()+1);
                   item.symbol = value.toString();
                   item.segment = resolveSymbol(value.toString());
+                  item.expression.compile(item.symbol,item.segment);
                   m_items.append(item);
                   endInsertRows();
 
@@ -195,10 +225,10 @@ bool CSymbolWatchModel::setData(const QModelIndex &index, const QVariant &value,
       case SymbolWatchCol_Value:
          if ( index.row() < m_items.count() )
          {
-            addr = CCC65Interface::getSymbolAddress(m_items.at(index.row()).symbol,CCC65Interface::getSymbolIndexFromSegment(value.toString(),m_items.at(index.row()).segment));
-            if ( addr != 0xFFFFFFFF )
+            const CWatchExpression& expression = m_items.at(index.row()).expression;
+            if ( expression.isLvalue() )
             {
-               nesSetCPUMemory(addr,value.toString().toInt(&ok,16));
+               expression.write(expression.address(),0,value.toString().toInt(&ok,16));
             }
             emit dataChanged(index,index);
          }
@@ -259,8 +289,32 @@ int CSymbolWatchModel::columnCount(const QModelIndex&) const
    return SymbolWatchCol_MAX;
 }
 
+void CSymbolWatchModel::setItems(QList<WatchedItem> items)
+{
+   int idx;
+
+   m_items = items;
+   for ( idx = 0; idx < m_items.count(); idx++ )
+   {
+      m_items[idx].expression.compile(m_items.at(idx).symbol,m_items.at(idx).segment);
+   }
+   m_debugInfoRevision = CCC65Interface::getDebugInfoRevision();
+}
+
 void CSymbolWatchModel::update()
 {
+   int idx;
+
+   // Symbols move whenever the project is rebuilt.
+   if ( m_debugInfoRevision != CCC65Interface::getDebugInfoRevision() )
+   {
+      for ( idx = 0; idx < m_items.count(); idx++ )
+      {
+         m_items[idx].expression.compile(m_items.at(idx).symbol,m_items.at(idx).segment);
+      }
+      m_debugInfoRevision = CCC65Interface::getDebugInfoRevision();
+   }
+
    sort(m_currentSortColumn,m_currentSortOrder);
 }
 
@@ -298,6 +352,7 @@ void CSymbolWatchModel::insertRow(QString text, int addr, const QModelIndex& par
    beginInsertRows(parent,m_items.count(),m_items.count());
    item.symbol = text;
    item.segment = resolveSymbol(text,addr);
+   item.expression.compile(item.symbol,item.segment);
    m_items.append(item);
    endInsertRows();
 }
@@ -4,6 +4,8 @@
 #include <QAbstractTableModel>
 #include <QList>
 
+#include "cwatchexpression.h"
+
 enum
 {
    SymbolWatchCol_Symbol = 0,
@@ -20,6 +22,9 @@ struct WatchedItem
    QString symbol;
    QString file;
    int     segment;
+
+   // The watched text compiled against the current debug information.
+   CWatchExpression expression;
 };
 
 class CSymbolWatchModel : public QAbstractTableModel
@@ -39,7 +44,7 @@ public:
    void insertRow(QString text, int addr = -1, const QModelIndex &parent = QModelIndex());
 
    QList<WatchedItem> getItems() { return m_items; }
-   void setItems(QList<WatchedItem> items) { m_items = items; }
+   void setItems(QList<WatchedItem> items);
 
    int resolveSymbol(QString text,int addr = -1);
 
@@ -53,6 +58,7 @@ private:
    Qt::SortOrder m_currentSortOrder;
    int m_currentItemCount;
    bool m_editable;
+   unsigned int m_debugInfoRevision;
 };
 
 #endif // CSYMBOLWATCHMODEL_H
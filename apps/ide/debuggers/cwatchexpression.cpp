@@ -0,0 +1,744 @@
+#include <QRegExp>
+
+#include <string.h>
+
+#include "cwatchexpression.h"
+
+#include "ccc65interface.h"
+#include "nes_emulator_core.h"
+
+// Stack machine instructions.  Each takes one word of program and one
+// word of operand.
+enum
+{
+   Op_Push = 0,
+   Op_Load,       // operand: space | (size<<4)
+   Op_Or,
+   Op_Xor,
+   Op_And,
+   Op_Shl,
+   Op_Shr,
+   Op_Add,
+   Op_Sub,
+   Op_Mul,
+   Op_Div,
+   Op_Mod,
+   Op_Neg,
+   Op_Not
+};
+
+#define WATCH_STACK_SIZE 16
+
+// Binary operators from lowest to highest precedence, with the
+// instruction each compiles to.
+static const struct
+{
+   const char* token;
+   int         level;
+   int         op;
+} binaryOps [] =
+{
+   { "<<", 3, Op_Shl },
+   { ">>", 3, Op_Shr },
+   { "|",  0, Op_Or },
+   { "^",  1, Op_Xor },
+   { "&",  2, Op_And },
+   { "+",  4, Op_Add },
+   { "-",  4, Op_Sub },
+   { "*",  5, Op_Mul },
+   { "/",  5, Op_Div },
+   { "%",  5, Op_Mod },
+   { NULL, 0, 0 }
+};
+
+#define BINARY_LEVELS 6
+
+static unsigned int binaryOp(int op,unsigned int a,unsigned int b)
+{
+   switch ( op )
+   {
+      case Op_Or:
+         return a|b;
+      case Op_Xor:
+         return a^b;
+      case Op_And:
+         return a&b;
+      case Op_Shl:
+         return (b < 32) ? (a<<b) : 0;
+      case Op_Shr:
+         return (b < 32) ? (a>>b) : 0;
+      case Op_Add:
+         return a+b;
+      case Op_Sub:
+         return a-b;
+      case Op_Mul:
+         return a*b;
+      case Op_Div:
+         return b ? (a/b) : 0;
+      case Op_Mod:
+         return b ? (a%b) : 0;
+   }
+   return 0;
+}
+
+CWatchExpression::CWatchExpression()
+{
+   m_segment = -1;
+   m_pos = 0;
+   m_symbolIndex = -1;
+   m_symbolAddress = 0;
+   m_symbolAbsoluteAddress = 0;
+   m_lvalue = false;
+   m_space = WatchSpace_CPU;
+   m_size = 0;
+   m_window = 0;
+   m_error = "empty expression";
+}
+
+bool CWatchExpression::compile(QString text,int segment)
+{
+   Operand result;
+   QString name;
+   int depth;
+   int maxDepth;
+   int idx;
+
+   m_text = text;
+   m_segment = segment;
+   m_pos = 0;
+   m_symbolIndex = -1;
+   m_symbolAddress = 0;
+   m_symbolAbsoluteAddress = 0;
+   m_symbolSegment.clear();
+   m_symbolFile.clear();
+   m_identifiers = 0;
+   m_window = 0;
+   m_error.clear();
+   m_code.clear();
+
+   parseBinary(result,0);
+   skipSpace();
+   if ( m_error.isEmpty() && (m_pos < m_text.length()) )
+   {
+      setError("unexpected '"+m_text.mid(m_pos)+"'");
+   }
+   if ( !m_error.isEmpty() )
+   {
+      m_code.clear();
+      return false;
+   }
+
+   // Arrays are still shown as the memory they occupy; only their use
+   // inside a larger expression decays them to an address.
+   materialize(result);
+   m_lvalue = result.lvalue;
+   m_space = result.space;
+   m_size = result.size;
+
+   // A lone symbol keeps the symbol's own details in the watch window.
+   if ( (m_identifiers == 1) &&
+        (m_code.count() == 2) &&
+        m_lvalue &&
+        (QRegExp("\\s*[A-Za-z_@][A-Za-z0-9_@]*\\s*").exactMatch(m_text)) )
+   {
+      name = m_text.trimmed();
+      m_symbolIndex = m_lastSymbolIndex;
+      m_symbolAddress = CCC65Interface::getSymbolAddress(name,m_symbolIndex);
+      m_symbolAbsoluteAddress = CCC65Interface::getSymbolAbsoluteAddress(name,m_symbolIndex);
+      m_symbolSegment = CCC65Interface::getSymbolSegmentName(name,m_symbolIndex);
+      m_symbolFile = CCC65Interface::getSourceFileFromSymbol(name);
+   }
+
+   // Folding can insert pushes in the middle of the program, so the stack
+   // it needs is only known once it is complete.
+   depth = 0;
+   maxDepth = 0;
+   for ( idx = 0; idx < m_code.count(); idx += 2 )
+   {
+      switch ( m_code.at(idx) )
+      {
+         case Op_Push:
+            depth++;
+            break;
+         case Op_Load:
+         case Op_Neg:
+         case Op_Not:
+            break;
+         default:
+            depth--;
+            break;
+      }
+      if ( depth > maxDepth )
+      {
+         maxDepth = depth;
+      }
+   }
+   if ( maxDepth > WATCH_STACK_SIZE )
+   {
+      setError("expression is too complex");
+      m_code.clear();
+      return false;
+   }
+
+   return true;
+}
+
+void CWatchExpression::setError(QString error)
+{
+   // Keep the first error; the ones after it are usually knock-on effects.
+   if ( m_error.isEmpty() )
+   {
+      m_error = error;
+   }
+}
+
+void CWatchExpression::skipSpace()
+{
+   while ( (m_pos < m_text.length()) && m_text.at(m_pos).isSpace() )
+   {
+      m_pos++;
+   }
+}
+
+bool CWatchExpression::match(const char* token)
+{
+   int len = strlen(token);
+
+   skipSpace();
+   if ( m_text.mid(m_pos,len) == token )
+   {
+      m_pos += len;
+      return true;
+   }
+   return false;
+}
+
+bool CWatchExpression::isIdentifierChar(QChar c,bool first) const
+{
+   if ( (c == '_') || (c == '@') || ((c.toAscii() >= 'A') && (c.toAscii() <= 'Z')) ||
+        ((c.toAscii() >= 'a') && (c.toAscii() <= 'z')) )
+   {
+      return true;
+   }
+   return (!first) && (c.toAscii() >= '0') && (c.toAscii() <= '9');
+}
+
+bool CWatchExpression::parseNumber(unsigned int* value)
+{
+   int base = 10;
+   int start;
+   int digit;
+   QChar c;
+
+   skipSpace();
+   if ( m_pos >= m_text.length() )
+   {
+      return false;
+   }
+   c = m_text.at(m_pos);
+   if ( c == '$' )
+   {
+      base = 16;
+      m_pos++;
+   }
+   else if ( (c == '%') &&
+             (m_pos+1 < m_text.length()) &&
+             ((m_text.at(m_pos+1) == '0') || (m_text.at(m_pos+1) == '1')) )
+   {
+      base = 2;
+      m_pos++;
+   }
+   else if ( (c == '0') &&
+             (m_pos+1 < m_text.length()) &&
+             ((m_text.at(m_pos+1) == 'x') || (m_text.at(m_pos+1) == 'X')) )
+   {
+      base = 16;
+      m_pos += 2;
+   }
+   else if ( !c.isDigit() )
+   {
+      return false;
+   }
+
+   (*value) = 0;
+   start = m_pos;
+   while ( m_pos < m_text.length() )
+   {
+      digit = m_text.at(m_pos).toLower().toAscii();
+      if ( (digit >= '0') && (digit <= '9') )
+      {
+         digit -= '0';
+      }
+      else if ( (digit >= 'a') && (digit <= 'f') )
+      {
+         digit -= ('a'-10);
+      }
+      else
+      {
+         break;
+      }
+      if ( digit >= base )
+      {
+         break;
+      }
+      (*value) = ((*value)*base)+digit;
+      m_pos++;
+   }
+   if ( m_pos == start )
+   {
+      setError("expected digits at '"+m_text.mid(start)+"'");
+   }
+   return true;
+}
+
+void CWatchExpression::parseBinary(Operand& result,int level)
+{
+   Operand rhs;
+   int mark;
+   int op;
+   int idx;
+
+   if ( level == BINARY_LEVELS )
+   {
+      parseUnary(result);
+      return;
+   }
+
+   parseBinary(result,level+1);
+
+   while ( m_error.isEmpty() )
+   {
+      for ( idx = 0; binaryOps[idx].token; idx++ )
+      {
+         if ( binaryOps[idx].level == level )
+         {
+            skipSpace();
+            if ( m_text.mid(m_pos,strlen(binaryOps[idx].token)) == binaryOps[idx].token )
+            {
+               break;
+            }
+         }
+      }
+      if ( !binaryOps[idx].token )
+      {
+         break;
+      }
+      m_pos += strlen(binaryOps[idx].token);
+      op = binaryOps[idx].op;
+
+      toRvalue(result);
+      mark = m_code.count();
+      parseBinary(rhs,level+1);
+      toRvalue(rhs);
+      fold(result,op,rhs,mark);
+   }
+}
+
+void CWatchExpression::parseUnary(Operand& result)
+{
+   if ( match("-") || match("~") )
+   {
+      int op = (m_text.at(m_pos-1) == '-') ? Op_Neg : Op_Not;
+
+      parseUnary(result);
+      toRvalue(result);
+      if ( result.constant )
+      {
+         result.value = (op == Op_Neg) ? (0-result.value) : (~result.value);
+      }
+      else
+      {
+         emitOp(op);
+      }
+      result.pointer = false;
+   }
+   else if ( match("*") )
+   {
+      // Dereference: what the operand points at, in CPU address space.
+      parseUnary(result);
+      toRvalue(result);
+      result.lvalue = true;
+      result.space = WatchSpace_CPU;
+      result.size = (result.pointer && result.elementSize) ? result.elementSize : 1;
+      result.elementSize = 0;
+      result.pointer = false;
+   }
+   else if ( match("&") )
+   {
+      parseUnary(result);
+      if ( !result.lvalue )
+      {
+         setError("can't take the address of a value");
+      }
+      result.lvalue = false;
+      result.elementSize = result.size;
+      result.pointer = true;
+      result.size = 2;
+   }
+   else
+   {
+      parsePostfix(result);
+   }
+}
+
+void CWatchExpression::parsePostfix(Operand& result)
+{
+   Operand base;
+   Operand index;
+   Operand scale;
+   unsigned int elementSize;
+   int mark;
+
+   parsePrimary(result);
+
+   while ( m_error.isEmpty() )
+   {
+      if ( match("[") )
+      {
+         // Arrays, and plain symbols treated as arrays of bytes, index from
+         // their own address.  Pointers index from where they point.
+         if ( result.lvalue && !result.pointer )
+         {
+            base = result;
+            base.lvalue = false;
+            elementSize = result.elementSize ? result.elementSize : 1;
+         }
+         else
+         {
+            toRvalue(result);
+            base = result;
+            base.space = WatchSpace_CPU;
+            elementSize = (result.pointer && result.elementSize) ? result.elementSize : 1;
+         }
+
+         mark = m_code.count();
+         parseBinary(index,0);
+         toRvalue(index);
+         if ( !match("]") )
+         {
+            setError("expected ']'");
+            return;
+         }
+
+         scale.lvalue = false;
+         scale.constant = true;
+         scale.value = elementSize;
+         scale.space = WatchSpace_CPU;
+         scale.size = 0;
+         scale.elementSize = 0;
+         scale.pointer = false;
+         fold(index,Op_Mul,scale,m_code.count());
+         fold(base,Op_Add,index,mark);
+
+         result = base;
+         result.lvalue = true;
+         result.size = elementSize;
+         result.elementSize = 0;
+         result.pointer = false;
+      }
+      else if ( match(".") )
+      {
+         setError("structure members aren't in cc65's debug information");
+      }
+      else
+      {
+         break;
+      }
+   }
+}
+
+void CWatchExpression::parsePrimary(Operand& result)
+{
+   unsigned int value;
+   unsigned int bank;
+   unsigned int addr;
+   unsigned int elementSize;
+   bool pointer;
+   int count;
+   int start;
+   QString name;
+
+   result.lvalue = false;
+   result.constant = true;
+   result.value = 0;
+   result.space = WatchSpace_CPU;
+   result.size = 0;
+   result.elementSize = 0;
+   result.pointer = false;
+
+   skipSpace();
+   if ( m_pos >= m_text.length() )
+   {
+      setError("expected a value");
+      return;
+   }
+
+   if ( match("(") )
+   {
+      parseBinary(result,0);
+      if ( !match(")") )
+      {
+         setError("expected ')'");
+      }
+   }
+   else if ( isIdentifierChar(m_text.at(m_pos),true) )
+   {
+      start = m_pos;
+      while ( (m_pos < m_text.length()) && isIdentifierChar(m_text.at(m_pos),false) )
+      {
+         m_pos++;
+      }
+      name = m_text.mid(start,m_pos-start);
+
+      count = CCC65Interface::getSymbolMatchCount(name);
+      if ( !count )
+      {
+         setError("unknown symbol '"+name+"'");
+         return;
+      }
+      m_lastSymbolIndex = 0;
+      if ( (count > 1) && (m_segment >= 0) )
+      {
+         m_lastSymbolIndex = CCC65Interface::getSymbolIndexFromSegment(name,m_segment);
+      }
+      m_identifiers++;
+
+      addr = CCC65Interface::getSymbolAddress(name,m_lastSymbolIndex);
+      if ( addr == 0xFFFFFFFF )
+      {
+         setError("unresolved symbol '"+name+"'");
+         return;
+      }
+      result.lvalue = true;
+      result.value = addr;
+      result.size = CCC65Interface::getSymbolSize(name,m_lastSymbolIndex);
+      if ( CCC65Interface::getSymbolTypeLayout(name,m_lastSymbolIndex,&elementSize,&pointer) )
+      {
+         result.pointer = pointer;
+         if ( pointer && (!result.size) )
+         {
+            result.size = 2;
+         }
+         if ( pointer || (elementSize < result.size) )
+         {
+            result.elementSize = elementSize;
+         }
+      }
+   }
+   else if ( parseNumber(&value) )
+   {
+      if ( match(":") )
+      {
+         // bank:address names a byte of PRG-ROM or SRAM by its physical
+         // location, the same way the debuggers print banked addresses.
+         bank = value;
+         if ( !parseNumber(&addr) )
+         {
+            setError("expected an address after the bank");
+            return;
+         }
+         if ( addr > 0xFFFF )
+         {
+            setError("address is out of range");
+            return;
+         }
+         if ( addr >= MEM_32KB )
+         {
+            result.space = WatchSpace_PRGROM;
+         }
+         else if ( addr >= SRAM_START )
+         {
+            result.space = WatchSpace_SRAM;
+         }
+         else
+         {
+            setError("only PRG-ROM and SRAM addresses have banks");
+            return;
+         }
+         m_window = addr&(~(MEM_8KB-1));
+         result.lvalue = true;
+         result.value = (bank*MEM_8KB)+(addr&(MEM_8KB-1));
+         result.size = 1;
+      }
+      else
+      {
+         result.value = value;
+      }
+   }
+   else
+   {
+      setError("unexpected '"+m_text.mid(m_pos)+"'");
+   }
+}
+
+void CWatchExpression::emitOp(int op,unsigned int operand)
+{
+   m_code.append(op);
+   m_code.append(operand);
+}
+
+void CWatchExpression::materialize(Operand& operand,int at)
+{
+   if ( operand.constant )
+   {
+      if ( (at < 0) || (at >= m_code.count()) )
+      {
+         emitOp(Op_Push,operand.value);
+      }
+      else
+      {
+         m_code.insert(at,operand.value);
+         m_code.insert(at,Op_Push);
+      }
+      operand.constant = false;
+   }
+}
+
+void CWatchExpression::toRvalue(Operand& operand)
+{
+   unsigned int size;
+
+   if ( !operand.lvalue )
+   {
+      return;
+   }
+   operand.lvalue = false;
+
+   // Arrays decay to the address of their first element.
+   if ( operand.elementSize && (!operand.pointer) && (operand.size > operand.elementSize) )
+   {
+      operand.pointer = true;
+      operand.size = 2;
+      return;
+   }
+
+   size = operand.size;
+   if ( (!size) || (size > 4) )
+   {
+      size = 1;
+   }
+   materialize(operand);
+   emitOp(Op_Load,operand.space|(size<<4));
+   operand.size = size;
+}
+
+void CWatchExpression::fold(Operand& result,int op,Operand& rhs,int at)
+{
+   if ( result.constant && rhs.constant )
+   {
+      if ( ((op == Op_Div) || (op == Op_Mod)) && (!rhs.value) )
+      {
+         setError("division by zero");
+      }
+      result.value = binaryOp(op,result.value,rhs.value);
+   }
+   else
+   {
+      // The left operand's code has to come before the right one's.
+      materialize(result,at);
+      materialize(rhs);
+      emitOp(op);
+   }
+   result.pointer = result.pointer && ((op == Op_Add) || (op == Op_Sub));
+   result.size = 0;
+}
+
+unsigned int CWatchExpression::run(const QVector<unsigned int>& code) const
+{
+   unsigned int stack [ WATCH_STACK_SIZE ];
+   const unsigned int* pc = code.constData();
+   const unsigned int* end = pc+code.count();
+   unsigned int value;
+   unsigned int size;
+   int sp = -1;
+
+   if ( pc == end )
+   {
+      return 0;
+   }
+
+   for ( ; pc < end; pc += 2 )
+   {
+      switch ( (*pc) )
+      {
+         case Op_Push:
+            stack[++sp] = (*(pc+1));
+            break;
+         case Op_Load:
+            value = 0;
+            for ( size = (*(pc+1))>>4; size; size-- )
+            {
+               value = (value<<8)|read(stack[sp],size-1,(*(pc+1))&0xF);
+            }
+            stack[sp] = value;
+            break;
+         case Op_Neg:
+            stack[sp] = 0-stack[sp];
+            break;
+         case Op_Not:
+            stack[sp] = ~stack[sp];
+            break;
+         default:
+            stack[sp-1] = binaryOp((*pc),stack[sp-1],stack[sp]);
+            sp--;
+            break;
+      }
+   }
+   return stack[0];
+}
+
+unsigned int CWatchExpression::address() const
+{
+   return run(m_code);
+}
+
+unsigned int CWatchExpression::value() const
+{
+   return run(m_code);
+}
+
+unsigned int CWatchExpression::cpuAddress(unsigned int address) const
+{
+   if ( m_space == WatchSpace_CPU )
+   {
+      return address&0xFFFF;
+   }
+   return m_window|(address&(MEM_8KB-1));
+}
+
+uint8_t CWatchExpression::read(unsigned int address,unsigned int offset,int space) const
+{
+   address += offset;
+
+   switch ( space )
+   {
+      case WatchSpace_PRGROM:
+         return (address < nesGetPRGROMSize()) ? nesGetPRGROMDataPhysical(address) : 0;
+      case WatchSpace_SRAM:
+         return (address < NUM_SRAM_BANKS*MEM_8KB) ? nesGetSRAMDataPhysical(address) : 0;
+   }
+   return nesGetMemory(address&0xFFFF);
+}
+
+uint8_t CWatchExpression::read(unsigned int address,unsigned int offset) const
+{
+   return read(address,offset,m_space);
+}
+
+void CWatchExpression::write(unsigned int address,unsigned int offset,uint8_t data) const
+{
+   address += offset;
+
+   switch ( m_space )
+   {
+      case WatchSpace_CPU:
+         nesSetCPUMemory(address&0xFFFF,data);
+         break;
+      case WatchSpace_SRAM:
+         if ( address < NUM_SRAM_BANKS*MEM_8KB )
+         {
+            nesSetSRAMDataPhysical(address,data);
+         }
+         break;
+   }
+}
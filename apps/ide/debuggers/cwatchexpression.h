@@ -0,0 +1,129 @@
+#ifndef CWATCHEXPRESSION_H
+#define CWATCHEXPRESSION_H
+
+#include <QString>
+#include <QVector>
+
+#include <stdint.h>
+
+// Where the memory an expression refers to lives.  Bank-qualified
+// addresses name a physical location in PRG-ROM or SRAM so they can
+// be watched whether or not the bank is mapped in.
+enum
+{
+   WatchSpace_CPU = 0,
+   WatchSpace_PRGROM,
+   WatchSpace_SRAM
+};
+
+// A symbol watch entry, compiled once into a short program for a small
+// stack machine.
+//
+// Expressions are C-like: symbols, $hex, 0x hex, %binary and decimal
+// numbers, bank-qualified addresses written bank:address, the usual
+// arithmetic, shift and bitwise operators, unary - ~ * and &, and array
+// indexing.  As in C a symbol stands for what is stored there and &symbol
+// for where it is.  Symbols are looked up in the debug information when the
+// expression is compiled; C arrays and pointers index by the element size
+// cc65 recorded for them, and any symbol can be indexed as bytes.  Offsets
+// added with + are always in bytes.  Structure members can't be watched;
+// cc65 doesn't describe structures in its debug information yet.
+//
+// Everything that doesn't depend on memory is folded into constants, so a
+// plain symbol, or an element of one at a constant index, compiles to a
+// single constant address and evaluating it costs no more than reading the
+// bytes.
+//
+// An expression that names memory (a symbol, a dereference, an indexed
+// element) is an lvalue: address() and read() give where it is and what
+// is there.  Anything else just has a value().  Compile again whenever the
+// debug information changes.
+class CWatchExpression
+{
+public:
+   CWatchExpression();
+
+   bool compile(QString text,int segment = -1);
+
+   QString text() const { return m_text; }
+   bool isValid() const { return m_error.isEmpty(); }
+   QString error() const { return m_error; }
+
+   // Whether the expression is just a symbol name, and if so, which of the
+   // symbols of that name it resolved to and where that symbol is.  These
+   // are looked up when the expression is compiled.
+   bool isSymbol() const { return m_symbolIndex >= 0; }
+   int symbolIndex() const { return m_symbolIndex; }
+   unsigned int symbolAddress() const { return m_symbolAddress; }
+   unsigned int symbolAbsoluteAddress() const { return m_symbolAbsoluteAddress; }
+   QString symbolSegment() const { return m_symbolSegment; }
+   QString symbolFile() const { return m_symbolFile; }
+
+   bool isLvalue() const { return m_lvalue; }
+   int space() const { return m_space; }
+   unsigned int size() const { return m_size; }
+   unsigned int address() const;
+   unsigned int cpuAddress(unsigned int address) const;
+   uint8_t read(unsigned int address,unsigned int offset) const;
+   void write(unsigned int address,unsigned int offset,uint8_t data) const;
+
+   unsigned int value() const;
+
+private:
+   typedef struct
+   {
+      bool         lvalue;
+      bool         constant;
+      unsigned int value;
+      int          space;
+      unsigned int size;
+      unsigned int elementSize;
+      bool         pointer;
+   } Operand;
+
+   // Parser.
+   void skipSpace();
+   bool match(const char* token);
+   bool isIdentifierChar(QChar c,bool first) const;
+   bool parseNumber(unsigned int* value);
+   void parseBinary(Operand& result,int level);
+   void parseUnary(Operand& result);
+   void parsePostfix(Operand& result);
+   void parsePrimary(Operand& result);
+   void setError(QString error);
+
+   // Code generation.  Constant operands emit nothing until they have to;
+   // "at" is where the right hand operand's code starts, so a constant left
+   // hand operand can be pushed ahead of it.
+   void emitOp(int op,unsigned int operand = 0);
+   void materialize(Operand& operand,int at = -1);
+   void toRvalue(Operand& operand);
+   void fold(Operand& result,int op,Operand& rhs,int at);
+
+   unsigned int run(const QVector<unsigned int>& code) const;
+   uint8_t read(unsigned int address,unsigned int offset,int space) const;
+
+   QString      m_text;
+   QString      m_error;
+   int          m_segment;
+   int          m_pos;
+   int          m_symbolIndex;
+   unsigned int m_symbolAddress;
+   unsigned int m_symbolAbsoluteAddress;
+   QString      m_symbolSegment;
+   QString      m_symbolFile;
+   int          m_lastSymbolIndex;
+   int          m_identifiers;
+
+   // The program leaves the address of an lvalue, or the value of anything
+   // else, on the stack.
+   QVector<unsigned int> m_code;
+   bool         m_lvalue;
+   int          m_space;
+   unsigned int m_size;
+
+   // The CPU address window a bank-qualified address was given in.
+   unsigned int m_window;
+};
+
+#endif // CWATCHEXPRESSION_H
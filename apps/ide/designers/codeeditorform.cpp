@@ -408,17 +408,26 @@ void CodeEditorForm::emulator_emulatorStarted()
    m_scintilla->markerDeleteAll(Marker_Highlight);
 }
 
+static bool lessThanByAbsoluteAddress(const SourceLineAddress& a,const SourceLineAddress& b)
+{
+   return a.absAddr < b.absAddr;
+}
+
 void CodeEditorForm::external_breakpointsChanged()
 {
    CMarker* markers = nesGetExecutionMarkerDatabase();
    MarkerSetInfo* pMarker;
-   unsigned int addr;
-   unsigned int absAddr;
+   QList<SourceLineAddress> addresses = CCC65Interface::getLineAddressesForFile(m_fileName);
+   QList<SourceLineAddress>::const_iterator address;
+   SourceLineAddress key;
+   QHash<int,unsigned int> lineMarkers;
+   QHash<int,unsigned int>::const_iterator lineMarker;
+   unsigned int markerMask;
+   unsigned int oldMask;
+   unsigned int newMask;
+   int marker;
    int line;
-   int index;
    int idx;
-   int asmcount;
-   int asmline;
 
    if ( !nesicideProject->getProjectTarget().compare("nes",Qt::CaseInsensitive) )
    {
@@ -429,65 +438,98 @@ void CodeEditorForm::external_breakpointsChanged()
       m_pBreakpoints = c64GetBreakpointDatabase();
    }
 
-   m_scintilla->getCursorPosition(&line,&index);
-
-   m_scintilla->markerDeleteAll(Marker_Breakpoint);
-   m_scintilla->markerDeleteAll(Marker_BreakpointDisabled);
+   // Work out which breakpoint and marker symbols each line should have.
+   // The file's addresses are sorted by absolute address, so each marker
+   // set and breakpoint only visits the lines it covers.
+   markerMask = (1<<Marker_Breakpoint)|(1<<Marker_BreakpointDisabled);
    for ( idx = 0; idx < markers->GetNumMarkers(); idx++ )
    {
-      m_scintilla->markerDeleteAll(Marker_Marker1+idx);
+      pMarker = markers->GetMarker(idx);
+      markerMask |= (1<<(Marker_Marker1+idx));
+
+      if ( (pMarker->state == eMarkerSet_Started) ||
+           (pMarker->state == eMarkerSet_Complete) )
+      {
+         key.absAddr = pMarker->startAbsAddr;
+         for ( address = qLowerBound(addresses.constBegin(),addresses.constEnd(),key,lessThanByAbsoluteAddress);
+               (address != addresses.constEnd()) && ((*address).absAddr <= pMarker->endAbsAddr);
+               ++address )
+         {
+            lineMarkers[(*address).line-1] |= (1<<(Marker_Marker1+idx));
+         }
+      }
    }
 
-   for ( line = 0; line < m_scintilla->lines(); line++ )
+   if ( m_pBreakpoints )
    {
-      asmcount = CCC65Interface::getLineMatchCount(m_fileName,line+1);
-      for ( asmline = 0; asmline < asmcount; asmline++ )
+      for ( idx = 0; idx < m_pBreakpoints->GetNumBreakpoints(); idx++ )
       {
-         addr = CCC65Interface::getAddressFromFileAndLine(m_fileName,line+1,asmline);
-         absAddr = CCC65Interface::getAbsoluteAddressFromFileAndLine(m_fileName,line+1,asmline);
+         BreakpointInfo* pBreakpoint = m_pBreakpoints->GetBreakpoint(idx);
 
-         if ( addr != (unsigned int)-1 )
+         if ( pBreakpoint->type == eBreakOnCPUExecution )
          {
-            for ( idx = 0; idx < markers->GetNumMarkers(); idx++ )
-            {
-               pMarker = markers->GetMarker(idx);
+            marker = (pBreakpoint->enabled)?Marker_Breakpoint:Marker_BreakpointDisabled;
 
-               if ( (pMarker->state == eMarkerSet_Started) ||
-                    (pMarker->state == eMarkerSet_Complete) )
+            // Lines at the breakpoint's absolute address...
+            key.absAddr = pBreakpoint->item1Absolute;
+            for ( address = qLowerBound(addresses.constBegin(),addresses.constEnd(),key,lessThanByAbsoluteAddress);
+                  (address != addresses.constEnd()) && ((*address).absAddr == pBreakpoint->item1Absolute);
+                  ++address )
+            {
+               if ( pBreakpoint->item1 <= (*address).addr )
                {
-                  if ( (absAddr >= pMarker->startAbsAddr) &&
-                       (absAddr <= pMarker->endAbsAddr) )
-                  {
-                     m_scintilla->markerAdd(line,Marker_Marker1+idx);
-                  }
+                  lineMarkers[(*address).line-1] |= (1<<marker);
                }
             }
 
-            if ( m_pBreakpoints )
+            // ...and lines with no absolute address, which sort last.
+            key.absAddr = (unsigned int)-1;
+            for ( address = qLowerBound(addresses.constBegin(),addresses.constEnd(),key,lessThanByAbsoluteAddress);
+                  address != addresses.constEnd();
+                  ++address )
             {
-               for ( idx = 0; idx < m_pBreakpoints->GetNumBreakpoints(); idx++ )
+               if ( pBreakpoint->item1 <= (*address).addr )
                {
-                  BreakpointInfo* pBreakpoint = m_pBreakpoints->GetBreakpoint(idx);
-
-                  if ( (pBreakpoint->enabled) &&
-                       (pBreakpoint->type == eBreakOnCPUExecution) &&
-                       (pBreakpoint->item1 <= addr) &&
-                       ((absAddr == (unsigned int)-1) || (absAddr == pBreakpoint->item1Absolute)) )
-                  {
-                     m_scintilla->markerAdd(line,Marker_Breakpoint);
-                  }
-                  else if ( (!pBreakpoint->enabled) &&
-                            (pBreakpoint->type == eBreakOnCPUExecution) &&
-                            (pBreakpoint->item1 <= addr) &&
-                            ((absAddr == (unsigned int)-1) || (absAddr == pBreakpoint->item1Absolute)) )
-                  {
-                     m_scintilla->markerAdd(line,Marker_BreakpointDisabled);
-                  }
+                  lineMarkers[(*address).line-1] |= (1<<marker);
                }
             }
          }
       }
    }
+
+   // Only touch lines whose symbols differ from what they have now.  Lines
+   // that have some now are found through Scintilla, since the markers move
+   // with the text as it's edited.
+   for ( line = m_scintilla->markerFindNext(0,markerMask); line >= 0; line = m_scintilla->markerFindNext(line+1,markerMask) )
+   {
+      if ( !lineMarkers.contains(line) )
+      {
+         lineMarkers.insert(line,0);
+      }
+   }
+   for ( lineMarker = lineMarkers.constBegin(); lineMarker != lineMarkers.constEnd(); ++lineMarker )
+   {
+      line = lineMarker.key();
+      if ( line >= m_scintilla->lines() )
+      {
+         continue;
+      }
+
+      oldMask = m_scintilla->markersAtLine(line)&markerMask;
+      newMask = lineMarker.value();
+
+      for ( marker = 0; marker < Marker_MarkerMAX; marker++ )
+      {
+         if ( (oldMask&~newMask)&(1<<marker) )
+         {
+            m_scintilla->markerDelete(line,marker);
+         }
+         else if ( (newMask&~oldMask)&(1<<marker) )
+         {
+            m_scintilla->markerAdd(line,marker);
+         }
+      }
+   }
 }
 
 void CodeEditorForm::breakpointHit()
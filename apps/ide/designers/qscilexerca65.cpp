@@ -1,9 +1,12 @@
 #include "qscilexerca65.h"
 
+#include <QByteArray>
 #include <QColor>
 #include <QFont>
 #include <QSettings>
 
+#include <string.h>
+
 #include "nes_emulator_core.h"
 #include "ccc65interface.h"
 
@@ -184,54 +187,134 @@ static const char* CA65_mnemonics[] =
    NULL
 };
 
-QsciLexerCA65::QsciLexerCA65(QObject */*parent*/)
+// Mnemonics are looked up in a table with a bit for every possible three
+// letter word.  Control commands are looked up in a perfect hash table, the
+// seed of the hash chosen when the table is built so that no two commands
+// share a slot.
+#define KEYWORD_HASH_SIZE 1024
+#define KEYWORD_MAX_LENGTH 16
+
+static uint8_t  mnemonicBits[((26*26*26)+7)/8];
+static uint8_t  keywordSlots[KEYWORD_HASH_SIZE];
+static uint32_t keywordSeed;
+static bool     lookupTablesBuilt = false;
+
+static inline bool isWordStart(char c)
 {
-   QString regex;
-   int rc;
+   return ((c >= 'A') && (c <= 'Z')) || ((c >= 'a') && (c <= 'z')) || (c == '_');
+}
 
-#ifdef Q_WS_MAC
-   setDefaultFont(QFont("Monaco", 11));
-#endif
-#ifdef Q_WS_X11
-   setDefaultFont(QFont("Monospace", 10));
-#endif
-#ifdef Q_WS_WIN
-   setDefaultFont(QFont("Consolas", 11));
-#endif
+static inline bool isWordChar(char c)
+{
+   return isWordStart(c) || ((c >= '0') && (c <= '9'));
+}
 
-   labelRegex = QRegExp("^(\\s*)((\\.|@)?\\w+\\b:)");
-   numberRegex = QRegExp("(\\b\\d+\\b)|(\\$\\b[0-9A-Fa-f]+\\b)|(\\b[0-9][0-9A-Fa-f]*h\\b)|(%\\b[01]+\\b)");
+static inline bool isHexDigit(char c)
+{
+   return ((c >= '0') && (c <= '9')) || ((c >= 'A') && (c <= 'F')) || ((c >= 'a') && (c <= 'f'));
+}
 
-   regex = "\\b(";
+static inline int mnemonicIndex(const char* word)
+{
+   return ((((word[0]|0x20)-'a')*26*26)+(((word[1]|0x20)-'a')*26)+((word[2]|0x20)-'a'));
+}
 
-   rc = 0;
-   while ( CA65_mnemonics[rc] )
+static inline bool isMnemonic(const char* word,int length)
+{
+   int idx;
+
+   if ( length != 3 )
    {
-      regex += CA65_mnemonics[rc];
-      if ( CA65_mnemonics[rc+1] )
+      return false;
+   }
+   for ( idx = 0; idx < 3; idx++ )
+   {
+      if ( !(((word[idx] >= 'A') && (word[idx] <= 'Z')) || ((word[idx] >= 'a') && (word[idx] <= 'z'))) )
       {
-         regex += '|';
+         return false;
       }
-      rc++;
    }
-   regex += ")\\b";
-   opcodeRegex.setPattern(regex);
-   opcodeRegex.setCaseSensitivity(Qt::CaseInsensitive);
+   idx = mnemonicIndex(word);
+   return mnemonicBits[idx>>3]&(1<<(idx&7));
+}
+
+static inline uint32_t keywordHash(const char* word,int length,uint32_t seed)
+{
+   uint32_t hash = seed;
+   int idx;
 
-   regex = "\\.(\\b(";
-   rc = 0;
-   while ( CA65_keyword[rc] )
+   for ( idx = 0; idx < length; idx++ )
    {
-      regex += CA65_keyword[rc];
-      if ( CA65_keyword[rc+1] )
+      hash = (hash^(uint8_t)(word[idx]|0x20))*16777619;
+   }
+   return (hash^(hash>>16))&(KEYWORD_HASH_SIZE-1);
+}
+
+static inline bool isKeyword(const char* word,int length)
+{
+   uint8_t slot;
+
+   if ( length > KEYWORD_MAX_LENGTH )
+   {
+      return false;
+   }
+   slot = keywordSlots[keywordHash(word,length,keywordSeed)];
+   return (slot != 0xFF) &&
+          (qstrnicmp(word,CA65_keyword[slot],length) == 0) &&
+          (CA65_keyword[slot][length] == 0);
+}
+
+static void buildLookupTables()
+{
+   uint32_t hash;
+   int idx;
+   bool collided;
+
+   for ( idx = 0; CA65_mnemonics[idx]; idx++ )
+   {
+      hash = mnemonicIndex(CA65_mnemonics[idx]);
+      mnemonicBits[hash>>3] |= (1<<(hash&7));
+   }
+
+   for ( keywordSeed = 2166136261u; ; keywordSeed++ )
+   {
+      memset(keywordSlots,0xFF,sizeof(keywordSlots));
+      collided = false;
+      for ( idx = 0; CA65_keyword[idx]; idx++ )
       {
-         regex += '|';
+         hash = keywordHash(CA65_keyword[idx],strlen(CA65_keyword[idx]),keywordSeed);
+         if ( keywordSlots[hash] != 0xFF )
+         {
+            collided = true;
+            break;
+         }
+         keywordSlots[hash] = idx;
       }
-      rc++;
+      if ( !collided )
+      {
+         break;
+      }
+   }
+
+   lookupTablesBuilt = true;
+}
+
+QsciLexerCA65::QsciLexerCA65(QObject */*parent*/)
+{
+#ifdef Q_WS_MAC
+   setDefaultFont(QFont("Monaco", 11));
+#endif
+#ifdef Q_WS_X11
+   setDefaultFont(QFont("Monospace", 10));
+#endif
+#ifdef Q_WS_WIN
+   setDefaultFont(QFont("Consolas", 11));
+#endif
+
+   if ( !lookupTablesBuilt )
+   {
+      buildLookupTables();
    }
-   regex += ")\\b)";
-   keywordRegex.setPattern(regex);
-   keywordRegex.setCaseSensitivity(Qt::CaseInsensitive);
 }
 
 QsciLexerCA65::~QsciLexerCA65()
@@ -300,119 +383,216 @@ const char *QsciLexerCA65::blockEnd(int *style) const
     return ".endproc";
 }
 
-void QsciLexerCA65::styleText(int start, int end)
+// Styles one line in a single pass, from the state the line before left,
+// and returns the state this line leaves.
+int QsciLexerCA65::styleLine(const char* text,int length,int state,char* styles)
 {
-   QByteArray   chars;
-   QString      text;
-   QStringList  lines;
-   int          pos;
-   int          lineLength;
-   int          lineNum;
-   int          index;
-
-   // Reset line styling.
-   startStyling(start,0xFF);
-   setStyling(end-start,CA65_Default);
-
-   // Get the text that is being styled.
-   chars.reserve((end-start)+1);
-   editor()->SendScintilla(QsciScintilla::SCI_GETTEXTRANGE,start,end,chars.data());
-
-   // Get the starting line index from the position.
-   editor()->lineIndexFromPosition(start,&lineNum,&index);
-
-   // Break the text into line chunks.
-   text = chars.constData();
-   lines = text.split(QRegExp("(\r\n|\n)"));
-
-   // Style the lines.
-   foreach ( const QString& line, lines )
+   bool labelAllowed = true;
+   bool opcodeSeen = false;
+   int  pos = 0;
+   int  token;
+   int  digit;
+   int  style;
+   char c;
+
+   memset(styles,CA65_Default,length);
+
+   while ( pos < length )
    {
-      // Get current line length.
-      lineLength = editor()->lineLength(lineNum);
+      c = text[pos];
+      token = 1;
+      style = CA65_Default;
 
-      if ( lineLength )
+      if ( state&CA65_State_InComment )
       {
-         // Look for opcodes.
-         pos = line.indexOf(opcodeRegex);
-         if ( pos != -1 )
+         while ( (pos+token < length) && !((text[pos+token-1] == '*') && (text[pos+token] == '/')) )
          {
-            startStyling(start+pos,0xFF);
-            setStyling(3,CA65_Opcode);
+            token++;
          }
-
-         // Look for numbers.
-         pos = 0;
-         do
+         if ( pos+token < length )
          {
-            pos = line.indexOf(numberRegex,pos);
-            if ( pos != -1 )
-            {
-               startStyling(start+pos,0xFF);
-               setStyling(numberRegex.matchedLength(),CA65_Number);
-               pos = pos+numberRegex.matchedLength();
-            }
-         } while ( pos != -1 );
-
-         // Look for labels.
-         pos = 0;
-         do
+            token++;
+            state &= ~CA65_State_InComment;
+         }
+         else
          {
-            pos = line.indexOf(labelRegex,pos);
-            if ( pos != -1 )
-            {
-               QString leading_space = labelRegex.cap( 1 );
-               QString label         = labelRegex.cap( 2 );
-               startStyling(start+pos+leading_space.length(),0xFF);
-               setStyling(label.length(),CA65_Label);
-               pos = pos+labelRegex.matchedLength();
-
-            }
-         } while ( pos != -1 );
-
-         // Look for quoted strings.
-         pos = 0;
-         do
+            token = length-pos;
+         }
+         style = CA65_Comment;
+      }
+      else if ( (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n') )
+      {
+         // Whitespace doesn't end the place a label can go.
+         pos++;
+         continue;
+      }
+      else if ( c == ';' )
+      {
+         token = length-pos;
+         style = CA65_Comment;
+      }
+      else if ( (state&CA65_State_CComments) && (c == '/') && (pos+1 < length) && (text[pos+1] == '*') )
+      {
+         token = 2;
+         state |= CA65_State_InComment;
+         style = CA65_Comment;
+      }
+      else if ( (c == '\"') || (c == '\'') )
+      {
+         while ( (pos+token < length) && (text[pos+token] != c) && (text[pos+token] != '\r') && (text[pos+token] != '\n') )
          {
-            pos = line.indexOf(QRegExp("\\\".*\\\""),pos);
-            if ( pos != -1 )
-            {
-               startStyling(start+pos,0xFF);
-               setStyling(line.indexOf('\"',pos+1)-pos+1,CA65_QuotedString);
-               pos = line.indexOf('\"',pos+1)+1;
-            }
-         } while ( pos != -1 );
-         pos = 0;
-         do
+            token++;
+         }
+         if ( (pos+token < length) && (text[pos+token] == c) )
+         {
+            token++;
+         }
+         style = CA65_QuotedString;
+      }
+      else if ( ((c == '.') || (c == '@')) && (pos+1 < length) && isWordStart(text[pos+1]) )
+      {
+         while ( (pos+token < length) && isWordChar(text[pos+token]) )
+         {
+            token++;
+         }
+         if ( labelAllowed && (pos+token < length) && (text[pos+token] == ':') )
+         {
+            token++;
+            style = CA65_Label;
+         }
+         else if ( (c == '.') && isKeyword(text+pos+1,token-1) )
          {
-            pos = line.indexOf(QRegExp("\\\'.*\\\'"),pos);
-            if ( pos != -1 )
+            style = CA65_Keyword;
+
+            // .feature c_comments turns on C style comments; a trailing -
+            // turns them off again.
+            if ( (token == 8) && (qstrnicmp(text+pos+1,"feature",7) == 0) )
             {
-               startStyling(start+pos,0xFF);
-               setStyling(line.indexOf('\'',pos+1)-pos+1,CA65_QuotedString);
-               pos = line.indexOf('\'',pos+1)+1;
+               QByteArray rest = QByteArray(text+pos+token,length-pos-token).simplified().toLower();
+               if ( rest.startsWith("c_comments") )
+               {
+                  if ( rest.mid(10).trimmed().startsWith('-') )
+                  {
+                     state &= ~CA65_State_CComments;
+                  }
+                  else
+                  {
+                     state |= CA65_State_CComments;
+                  }
+               }
             }
-         } while ( pos != -1 );
-
-         // Look for keywords.
-         pos = line.indexOf(keywordRegex);
-         if ( pos != -1 )
+         }
+      }
+      else if ( isWordStart(c) )
+      {
+         while ( (pos+token < length) && isWordChar(text[pos+token]) )
          {
-            startStyling(start+pos,0xFF);
-            setStyling(keywordRegex.matchedLength(),CA65_Keyword);
+            token++;
          }
-
-         // Look for comments. (Wash styling of comment over any previously applied).
-         pos = line.indexOf(';');
-         if ( pos != -1 )
+         if ( labelAllowed && (pos+token < length) && (text[pos+token] == ':') )
+         {
+            token++;
+            style = CA65_Label;
+         }
+         else if ( (!opcodeSeen) && isMnemonic(text+pos,token) )
          {
-            startStyling(start+pos,0xFF);
-            setStyling(lineLength-pos,CA65_Comment);
+            opcodeSeen = true;
+            style = CA65_Opcode;
          }
       }
+      else if ( (c >= '0') && (c <= '9') )
+      {
+         // Decimal, or hexadecimal with a trailing h.
+         while ( (pos+token < length) && isWordChar(text[pos+token]) )
+         {
+            token++;
+         }
+         for ( digit = 1; (digit < token) && (text[pos+digit] >= '0') && (text[pos+digit] <= '9'); digit++ )
+            ;
+         for ( ; (digit < token-1) && isHexDigit(text[pos+digit]); digit++ )
+            ;
+         if ( (digit == token) || ((digit == token-1) && ((text[pos+digit]|0x20) == 'h')) )
+         {
+            style = CA65_Number;
+         }
+      }
+      else if ( (c == '$') || (c == '%') )
+      {
+         // Hexadecimal or binary with a leading $ or %.
+         while ( (pos+token < length) && ((c == '$')?isHexDigit(text[pos+token]):((text[pos+token] == '0') || (text[pos+token] == '1'))) )
+         {
+            token++;
+         }
+         if ( (token > 1) && !((pos+token < length) && isWordChar(text[pos+token])) )
+         {
+            style = CA65_Number;
+         }
+         else
+         {
+            token = 1;
+         }
+      }
+
+      memset(styles+pos,style,token);
+      pos += token;
+      labelAllowed = false;
+   }
+
+   return state;
+}
 
-      start += lineLength;
-      lineNum++;
+void QsciLexerCA65::styleText(int start, int end)
+{
+   QByteArray text;
+   QByteArray styles;
+   int        line;
+   int        lastLine;
+   int        lineCount;
+   int        lineStart;
+   int        lineEnd;
+   int        state;
+   int        oldState;
+
+   line = editor()->SendScintilla(QsciScintilla::SCI_LINEFROMPOSITION,(unsigned long)start);
+   lastLine = editor()->SendScintilla(QsciScintilla::SCI_LINEFROMPOSITION,(unsigned long)end);
+   lineCount = editor()->SendScintilla(QsciScintilla::SCI_GETLINECOUNT);
+
+   // Pick up where the line before left off.
+   state = CA65_State_Default;
+   if ( line > 0 )
+   {
+      state = editor()->SendScintilla(QsciScintilla::SCI_GETLINESTATE,(unsigned long)(line-1));
+   }
+
+   for ( ; line < lineCount; line++ )
+   {
+      lineStart = editor()->SendScintilla(QsciScintilla::SCI_POSITIONFROMLINE,(unsigned long)line);
+      if ( line+1 < lineCount )
+      {
+         lineEnd = editor()->SendScintilla(QsciScintilla::SCI_POSITIONFROMLINE,(unsigned long)(line+1));
+      }
+      else
+      {
+         lineEnd = editor()->SendScintilla(QsciScintilla::SCI_GETLENGTH);
+      }
+
+      text.resize((lineEnd-lineStart)+1);
+      styles.resize(lineEnd-lineStart);
+      editor()->SendScintilla(QsciScintilla::SCI_GETTEXTRANGE,lineStart,lineEnd,text.data());
+
+      state = styleLine(text.constData(),lineEnd-lineStart,state,styles.data());
+
+      startStyling(lineStart,0xFF);
+      editor()->SendScintilla(QsciScintilla::SCI_SETSTYLINGEX,(unsigned long)(lineEnd-lineStart),styles.constData());
+
+      // Past the range asked for, carry on only while the state each line
+      // leaves differs from the one it left last time it was styled.
+      oldState = editor()->SendScintilla(QsciScintilla::SCI_GETLINESTATE,(unsigned long)line);
+      editor()->SendScintilla(QsciScintilla::SCI_SETLINESTATE,(unsigned long)line,(long)state);
+      if ( (line >= lastLine) && (state == oldState) )
+      {
+         break;
+      }
    }
 }
 
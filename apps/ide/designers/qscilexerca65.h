@@ -58,10 +58,16 @@ protected:
    bool writeProperties(QSettings &qs,const QString &prefix) const;
 
 protected:
-   QRegExp opcodeRegex;
-   QRegExp keywordRegex;
-   QRegExp labelRegex;
-   QRegExp numberRegex;
+   // What a line leaves behind for the next, kept as the Scintilla line
+   // state of each line.
+   enum
+   {
+      CA65_State_Default = 0x00,
+      CA65_State_CComments = 0x01,  // .feature c_comments in effect
+      CA65_State_InComment = 0x02   // inside a /* */ comment
+   };
+
+   static int styleLine(const char* text,int length,int state,char* styles);
 };
 
 #endif // QSCILEXERCA65_H
@@ -24,9 +24,11 @@
 #include <QApplication>
 #include <QStringList>
 #include <QMessageBox>
+#include <QInputDialog>
 #include <QSettings>
 
 #include "FamiTracker.h"
+#include "MainFrm.h"
 
 OutputPaneDockWidget* output = NULL;
 ProjectBrowserDockWidget* m_pProjectBrowser = NULL;
@@ -132,6 +134,7 @@ MainWindow::MainWindow(CProjectModel *projectModel, QWidget* parent) :
    QObject::connect(tabWidget,SIGNAL(tabAdded(int)),this,SLOT(tabWidget_tabAdded(int)));
    QObject::connect(tabWidget,SIGNAL(markProjectDirty(bool)),this,SLOT(markProjectDirty(bool)));
    QObject::connect(this,SIGNAL(checkOpenFiles(QDateTime)),tabWidget,SLOT(checkOpenFiles(QDateTime)));
+   QObject::connect(this,SIGNAL(checkOpenFiles(QDateTime)),searcher,SLOT(updateIndex()));
    QObject::connect(this,SIGNAL(applyProjectProperties()),tabWidget,SLOT(applyProjectProperties()));
    QObject::connect(this,SIGNAL(applyEnvironmentSettings()),tabWidget,SLOT(applyEnvironmentSettings()));
    QObject::connect(this,SIGNAL(updateTargetMachine(QString)),tabWidget,SIGNAL(updateTargetMachine(QString)));
@@ -513,6 +516,8 @@ void MainWindow::createNesUi()
    actionBinROM_Inspector->setObjectName(QString::fromUtf8("actionBinROM_Inspector"));
    actionPPUInformation_Inspector = new QAction("Information",this);
    actionPPUInformation_Inspector->setObjectName(QString::fromUtf8("actionPPUInformation_Inspector"));
+   actionRasterEffects_Inspector = new QAction("Raster Effects",this);
+   actionRasterEffects_Inspector->setObjectName(QString::fromUtf8("actionRasterEffects_Inspector"));
    actionJoypadLogger_Inspector = new QAction("Joypad Logger",this);
    actionJoypadLogger_Inspector->setObjectName(QString::fromUtf8("actionJoypadLogger_Inspector"));
    actionJoypadLogger_Inspector->setEnabled(false);
@@ -585,6 +590,11 @@ void MainWindow::createNesUi()
    actionWave_8N106->setCheckable(true);
    actionRun_Test_Suite = new QAction("Run Test Suite",this);
    actionRun_Test_Suite->setObjectName(QString::fromUtf8("actionRun_Test_Suite"));
+   actionRender_NSF_Song = new QAction("Render NSF Song to WAV...",this);
+   actionRender_NSF_Song->setObjectName(QString::fromUtf8("actionRender_NSF_Song"));
+   actionProfile_NSF_Music = new QAction("Profile Music Driver...",this);
+   actionProfile_NSF_Music->setObjectName(QString::fromUtf8("actionProfile_NSF_Music"));
+   m_pMusicProfiler = NULL;
    action1x = new QAction("1x",this);
    action1x->setObjectName(QString::fromUtf8("action1x"));
    action1x->setShortcut(QKeySequence("Ctrl+1"));
@@ -665,6 +675,7 @@ void MainWindow::createNesUi()
    menuAPU_Inpsectors->addAction(actionAPUInformation_Inspector);
    menuAPU_Inpsectors->addAction(actionBinAPURegister_Inspector);
    menuPPU_Inspectors->addAction(actionPPUInformation_Inspector);
+   menuPPU_Inspectors->addAction(actionRasterEffects_Inspector);
    menuPPU_Inspectors->addAction(actionBinPPURegister_Inspector);
    menuPPU_Inspectors->addSeparator();
    menuPPU_Inspectors->addAction(actionBinNameTableNESMemory_Inspector);
@@ -688,6 +699,8 @@ void MainWindow::createNesUi()
    menuEmulator->addAction(menuAudio->menuAction());
    menuEmulator->addSeparator();
    menuEmulator->addAction(actionRun_Test_Suite);
+   menuEmulator->addAction(actionRender_NSF_Song);
+   menuEmulator->addAction(actionProfile_NSF_Music);
    menuEmulator->addSeparator();
    menuEmulator->addAction(actionPreferences);
    menuSystem->addAction(actionNTSC);
@@ -865,6 +878,13 @@ void MainWindow::createNesUi()
    QObject::connect(m_pPPUInformationInspector,SIGNAL(markProjectDirty(bool)),this,SLOT(markProjectDirty(bool)));
    CDockWidgetRegistry::addWidget ( "PPU Information", m_pPPUInformationInspector );
 
+   m_pRasterEffectsInspector = new RasterEffectsDockWidget();
+   QObject::connect(this,SIGNAL(updateTargetMachine(QString)),m_pRasterEffectsInspector,SLOT(updateTargetMachine(QString)));
+   addDockWidget(Qt::BottomDockWidgetArea, m_pRasterEffectsInspector );
+   m_pRasterEffectsInspector->hide();
+   QObject::connect(m_pRasterEffectsInspector,SIGNAL(markProjectDirty(bool)),this,SLOT(markProjectDirty(bool)));
+   CDockWidgetRegistry::addWidget ( "Raster Effects", m_pRasterEffectsInspector );
+
    m_pBinAPURegisterInspector = new RegisterInspectorDockWidget(nesGetApuRegisterDatabase,nesGetBreakpointDatabase());
    QObject::connect(this,SIGNAL(updateTargetMachine(QString)),m_pBinAPURegisterInspector,SLOT(updateTargetMachine(QString)));
    m_pBinAPURegisterInspector->setObjectName("apuRegisterInspector");
@@ -974,6 +994,8 @@ void MainWindow::createNesUi()
    QObject::connect(actionBreakpoint_Inspector,SIGNAL(triggered()),this,SLOT(actionBreakpoint_Inspector_triggered()));
    QObject::connect(actionEmulation_Window,SIGNAL(triggered()),this,SLOT(actionEmulation_Window_triggered()));
    QObject::connect(actionRun_Test_Suite,SIGNAL(triggered()),this,SLOT(actionRun_Test_Suite_triggered()));
+   QObject::connect(actionRender_NSF_Song,SIGNAL(triggered()),this,SLOT(actionRender_NSF_Song_triggered()));
+   QObject::connect(actionProfile_NSF_Music,SIGNAL(triggered()),this,SLOT(actionProfile_NSF_Music_triggered()));
    QObject::connect(actionPreferences,SIGNAL(triggered()),this,SLOT(actionPreferences_triggered()));
    QObject::connect(actionCodeDataLogger_Inspector,SIGNAL(triggered()),this,SLOT(actionCodeDataLogger_Inspector_triggered()));
    QObject::connect(actionExecution_Visualizer_Inspector,SIGNAL(triggered()),this,SLOT(actionExecution_Visualizer_Inspector_triggered()));
@@ -993,6 +1015,7 @@ void MainWindow::createNesUi()
    QObject::connect(actionBinPPURegister_Inspector,SIGNAL(triggered()),this,SLOT(actionBinPPURegister_Inspector_triggered()));
    QObject::connect(actionBinMapperMemory_Inspector,SIGNAL(triggered()),this,SLOT(actionBinMapperMemory_Inspector_triggered()));
    QObject::connect(actionPPUInformation_Inspector,SIGNAL(triggered()),this,SLOT(actionPPUInformation_Inspector_triggered()));
+   QObject::connect(actionRasterEffects_Inspector,SIGNAL(triggered()),this,SLOT(actionRasterEffects_Inspector_triggered()));
    QObject::connect(actionAPUInformation_Inspector,SIGNAL(triggered()),this,SLOT(actionAPUInformation_Inspector_triggered()));
    QObject::connect(actionMapperInformation_Inspector,SIGNAL(triggered()),this,SLOT(actionMapperInformation_Inspector_triggered()));
    QObject::connect(actionJoypadLogger_Inspector,SIGNAL(triggered()),this,SLOT(actionJoypadLogger_Inspector_triggered()));
@@ -1083,6 +1106,8 @@ void MainWindow::destroyNesUi()
    delete m_pBinPPURegisterInspector;
    removeDockWidget(m_pPPUInformationInspector);
    delete m_pPPUInformationInspector;
+   removeDockWidget(m_pRasterEffectsInspector);
+   delete m_pRasterEffectsInspector;
    removeDockWidget(m_pBinAPURegisterInspector);
    delete m_pBinAPURegisterInspector;
    removeDockWidget(m_pAPUInformationInspector);
@@ -1130,6 +1155,7 @@ void MainWindow::destroyNesUi()
    delete actionBinMapperMemory_Inspector;
    delete actionBinROM_Inspector;
    delete actionPPUInformation_Inspector;
+   delete actionRasterEffects_Inspector;
    delete actionJoypadLogger_Inspector;
    delete actionCodeDataLogger_Inspector;
    delete actionExecution_Visualizer_Inspector;
@@ -1156,6 +1182,15 @@ void MainWindow::destroyNesUi()
    delete actionWave_7N106;
    delete actionWave_8N106;
    delete actionRun_Test_Suite;
+   delete actionRender_NSF_Song;
+   if ( m_pMusicProfiler )
+   {
+      QObject::disconnect(m_pMusicProfiler,0,this,0);
+      m_pMusicProfiler->wait();
+      delete m_pMusicProfiler;
+      m_pMusicProfiler = NULL;
+   }
+   delete actionProfile_NSF_Music;
    delete menuCPU_Inspectors;
    delete menuAPU_Inpsectors;
    delete menuPPU_Inspectors;
@@ -1234,14 +1269,36 @@ void MainWindow::createC64Ui()
    debuggerToolBar->setSizePolicy(sizePolicy1);
    addToolBar(Qt::TopToolBarArea, debuggerToolBar);
 
-   m_pC64EmulatorThread = new C64EmulatorThread();
-   CObjectRegistry::addObject("Emulator",m_pC64EmulatorThread);
-   QObject::connect(m_pC64EmulatorThread,SIGNAL(emulatorWantsExit()),this,SLOT(close()));
+   // Either VICE or the emulator library runs the program.
+   QThread* emulator;
+   m_pC64EmulatorThread = NULL;
+   m_pC64BuiltInEmulatorThread = NULL;
+   m_pC64Emulator = NULL;
+   if ( EmulatorPrefsDialog::getC64BuiltInEmulator() )
+   {
+      m_pC64BuiltInEmulatorThread = new C64BuiltInEmulatorThread();
+      emulator = m_pC64BuiltInEmulatorThread;
+   }
+   else
+   {
+      m_pC64EmulatorThread = new C64EmulatorThread();
+      emulator = m_pC64EmulatorThread;
+   }
+   CObjectRegistry::addObject("Emulator",emulator);
+   QObject::connect(emulator,SIGNAL(emulatorWantsExit()),this,SLOT(close()));
+
+   QObject::connect(this,SIGNAL(startEmulation()),emulator,SLOT(startEmulation()));
+   QObject::connect(this,SIGNAL(pauseEmulation(bool)),emulator,SLOT(pauseEmulation(bool)));
+   QObject::connect(this,SIGNAL(primeEmulator()),emulator,SLOT(primeEmulator()));
+   QObject::connect(this,SIGNAL(resetEmulator()),emulator,SLOT(resetEmulator()));
 
-   QObject::connect(this,SIGNAL(startEmulation()),m_pC64EmulatorThread,SLOT(startEmulation()));
-   QObject::connect(this,SIGNAL(pauseEmulation(bool)),m_pC64EmulatorThread,SLOT(pauseEmulation(bool)));
-   QObject::connect(this,SIGNAL(primeEmulator()),m_pC64EmulatorThread,SLOT(primeEmulator()));
-   QObject::connect(this,SIGNAL(resetEmulator()),m_pC64EmulatorThread,SLOT(resetEmulator()));
+   if ( m_pC64BuiltInEmulatorThread )
+   {
+      m_pC64Emulator = new C64EmulatorDockWidget(m_pC64BuiltInEmulatorThread->tvOut());
+      QObject::connect(m_pC64BuiltInEmulatorThread,SIGNAL(emulatedFrame()),m_pC64Emulator,SLOT(renderData()));
+      addDockWidget(Qt::RightDockWidgetArea, m_pC64Emulator );
+      CDockWidgetRegistry::addWidget ( "Emulator", m_pC64Emulator );
+   }
 
    m_pC64EmulatorControl = new C64EmulatorControl();
    debuggerToolBar->addWidget(m_pC64EmulatorControl);
@@ -1344,11 +1401,27 @@ void MainWindow::destroyC64Ui()
    delete debuggerToolBar;
 
    // Properly kill and destroy the thread we created above.
-   m_pC64EmulatorThread->kill();
-   m_pC64EmulatorThread->wait();
+   if ( m_pC64BuiltInEmulatorThread )
+   {
+      CDockWidgetRegistry::removeWidget ( "Emulator" );
+      removeDockWidget(m_pC64Emulator);
+      delete m_pC64Emulator;
+      m_pC64Emulator = NULL;
 
-   delete m_pC64EmulatorThread;
-   m_pC64EmulatorThread = NULL;
+      m_pC64BuiltInEmulatorThread->kill();
+      m_pC64BuiltInEmulatorThread->wait();
+
+      delete m_pC64BuiltInEmulatorThread;
+      m_pC64BuiltInEmulatorThread = NULL;
+   }
+   else
+   {
+      m_pC64EmulatorThread->kill();
+      m_pC64EmulatorThread->wait();
+
+      delete m_pC64EmulatorThread;
+      m_pC64EmulatorThread = NULL;
+   }
 
    CObjectRegistry::removeObject ( "Emulator" );
 
@@ -2502,6 +2575,11 @@ void MainWindow::actionPPUInformation_Inspector_triggered()
    m_pPPUInformationInspector->setVisible(true);
 }
 
+void MainWindow::actionRasterEffects_Inspector_triggered()
+{
+   m_pRasterEffectsInspector->setVisible(true);
+}
+
 void MainWindow::actionAPUInformation_Inspector_triggered()
 {
    m_pAPUInformationInspector->setVisible(true);
@@ -3226,6 +3304,183 @@ void MainWindow::actionRun_Test_Suite_triggered()
    testSuiteExecutive->show();
 }
 
+QByteArray MainWindow::openNSFFile(QString caption,QString* fileName)
+{
+   QFile nsfFile;
+   QByteArray nsfData;
+
+   (*fileName) = QFileDialog::getOpenFileName(this,caption,QDir::currentPath(),"NSF Files (*.nsf *.nsfe)");
+   if ( fileName->isEmpty() )
+   {
+      return nsfData;
+   }
+
+   nsfFile.setFileName(*fileName);
+   if ( nsfFile.open(QIODevice::ReadOnly) )
+   {
+      nsfData = nsfFile.readAll();
+      nsfFile.close();
+   }
+   if ( nsfData.isEmpty() )
+   {
+      QMessageBox::critical(this,caption,"Could not read "+(*fileName)+".");
+   }
+   return nsfData;
+}
+
+bool MainWindow::stopEmulatorForNSF(QString caption)
+{
+   // The emulator core is a single machine and the NSF takes the
+   // cartridge's place in it, so the emulator has to be stopped first.
+   emit pauseEmulation(false);
+   if ( !m_pNESEmulatorThread->wait(5000) )
+   {
+      QMessageBox::critical(this,caption,"The emulator could not be stopped; if it is at a breakpoint, stop debugging first.");
+      return false;
+   }
+   return true;
+}
+
+void MainWindow::actionRender_NSF_Song_triggered()
+{
+   QString nsfFileName;
+   QString wavFileName;
+   QByteArray nsfData;
+   bool romLoaded = nesROMIsLoaded();
+   bool rendered;
+   bool ok = false;
+   int song;
+   int seconds = 0;
+
+   nsfData = openNSFFile("Render NSF Song",&nsfFileName);
+   if ( nsfData.isEmpty() || !stopEmulatorForNSF("Render NSF Song") )
+   {
+      return;
+   }
+
+   if ( !nesLoadNSF((uint8_t*)nsfData.data(),nsfData.size()) )
+   {
+      QMessageBox::critical(this,"Render NSF Song",nsfFileName+" is not an NSF or NSFe file.");
+   }
+   else
+   {
+      song = QInputDialog::getInt(this,"Render NSF Song",QString("Song [1-%1]:").arg(nesGetNSFNumSongs()),
+                                  nesGetNSFStartSong()+1,1,nesGetNSFNumSongs(),1,&ok);
+      if ( ok )
+      {
+         seconds = QInputDialog::getInt(this,"Render NSF Song","Length in seconds:",120,1,3600,1,&ok);
+      }
+      if ( ok )
+      {
+         wavFileName = QFileDialog::getSaveFileName(this,"Render NSF Song",QFileInfo(nsfFileName).completeBaseName()+".wav","WAV Files (*.wav)");
+      }
+      if ( !wavFileName.isEmpty() )
+      {
+         QApplication::setOverrideCursor(Qt::WaitCursor);
+         rendered = nesRenderNSFSongToWAV(wavFileName.toLatin1().constData(),song-1,seconds);
+         QApplication::restoreOverrideCursor();
+
+         if ( rendered )
+         {
+            setStatusBarMessage("Rendered "+wavFileName);
+         }
+         else
+         {
+            QMessageBox::critical(this,"Render NSF Song","Could not write "+wavFileName+".");
+         }
+      }
+   }
+
+   // Put the project's cartridge back in the emulator.
+   if ( romLoaded )
+   {
+      emit primeEmulator();
+      emit resetEmulator();
+   }
+}
+
+void MainWindow::actionProfile_NSF_Music_triggered()
+{
+   CMainFrame* pMainFrame = (CMainFrame*)theApp.m_pMainWnd;
+   CFamiTrackerDoc* pDoc = (CFamiTrackerDoc*)pMainFrame->GetActiveDocument();
+   QString nsfFileName;
+   QByteArray nsfData;
+   bool romLoaded = nesROMIsLoaded();
+   bool ok;
+   int cycleBudget;
+
+   // The rows are worked out from the module, the cycles from the NSF
+   // exported from it.
+   if ( !pDoc->IsFileLoaded() )
+   {
+      QMessageBox::information(this,"Profile Music Driver","Open the module the NSF was exported from in the music editor first.");
+      return;
+   }
+
+   nsfData = openNSFFile("Profile Music Driver",&nsfFileName);
+   if ( nsfData.isEmpty() )
+   {
+      return;
+   }
+
+   cycleBudget = QInputDialog::getInt(this,"Profile Music Driver","CPU cycle budget per tick [0 for none]:",2000,0,29780,100,&ok);
+   if ( !ok || !stopEmulatorForNSF("Profile Music Driver") )
+   {
+      return;
+   }
+
+   // The emulator core is the profiler's until it's done.
+   m_profiledNSFFileName = nsfFileName;
+   m_profiledWithROMLoaded = romLoaded;
+   m_pMusicProfiler = new CMusicProfiler(pDoc,nsfData,cycleBudget);
+   QObject::connect(m_pMusicProfiler,SIGNAL(trackProfiled(int)),this,SLOT(musicProfiler_trackProfiled(int)));
+   QObject::connect(m_pMusicProfiler,SIGNAL(profilingComplete(bool)),this,SLOT(musicProfiler_profilingComplete(bool)));
+   actionProfile_NSF_Music->setEnabled(false);
+   actionRender_NSF_Song->setEnabled(false);
+   m_pNESEmulatorControl->setEnabled(false);
+
+   output->showPane(OutputPaneDockWidget::Output_General);
+   generalTextLogger->write("<b>Profiling "+nsfFileName+"...</b>");
+   m_pMusicProfiler->start();
+}
+
+void MainWindow::musicProfiler_trackProfiled(int track)
+{
+   generalTextLogger->write("Profiled track "+QString::number(track+1)+" of "+QString::number(m_pMusicProfiler->trackCount())+".");
+}
+
+void MainWindow::musicProfiler_profilingComplete(bool ok)
+{
+   // The signal comes from the profiler's thread just before run() returns.
+   m_pMusicProfiler->wait();
+
+   if ( ok )
+   {
+      generalTextLogger->write("<b>Music driver profile of "+m_profiledNSFFileName+":</b>");
+      foreach ( QString line, m_pMusicProfiler->report().split('\n',QString::SkipEmptyParts) )
+      {
+         // The report is indented with spaces, which the pane would collapse.
+         generalTextLogger->write(line.replace("  ","&nbsp;&nbsp;"));
+      }
+   }
+   else
+   {
+      generalTextLogger->write("<font color='red'><b>"+m_profiledNSFFileName+" is not an NSF or NSFe file.</b></font>");
+   }
+
+   delete m_pMusicProfiler;
+   m_pMusicProfiler = NULL;
+   actionProfile_NSF_Music->setEnabled(true);
+   actionRender_NSF_Song->setEnabled(true);
+   m_pNESEmulatorControl->setEnabled(true);
+
+   if ( m_profiledWithROMLoaded )
+   {
+      emit primeEmulator();
+      emit resetEmulator();
+   }
+}
+
 void MainWindow::on_actionE_xit_triggered()
 {
 }
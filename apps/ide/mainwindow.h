@@ -20,6 +20,7 @@
 #include "codebrowserdockwidget.h"
 #include "codedataloggerdockwidget.h"
 #include "ppuinformationdockwidget.h"
+#include "rastereffectsdockwidget.h"
 #include "apuinformationdockwidget.h"
 #include "mapperinformationdockwidget.h"
 #include "symbolwatchdockwidget.h"
@@ -34,7 +35,10 @@
 #include "nesemulatorthread.h"
 #include "nesemulatordockwidget.h"
 #include "nesemulatorcontrol.h"
+#include "cmusicprofiler.h"
 #include "c64emulatorthread.h"
+#include "c64builtinemulatorthread.h"
+#include "c64emulatordockwidget.h"
 #include "c64emulatorcontrol.h"
 #include "searchdockwidget.h"
 #include "cexpandablestatusbar.h"
@@ -119,6 +123,7 @@ protected:
    RegisterInspectorDockWidget* m_pBinMapperMemoryInspector;
    CodeDataLoggerDockWidget* m_pCodeDataLoggerInspector;
    PPUInformationDockWidget* m_pPPUInformationInspector;
+   RasterEffectsDockWidget* m_pRasterEffectsInspector;
    APUInformationDockWidget* m_pAPUInformationInspector;
    MapperInformationDockWidget* m_pMapperInformationInspector;
    JoypadLoggerDockWidget* m_pJoypadLoggerInspector;
@@ -146,6 +151,7 @@ protected:
    QAction *actionBinMapperMemory_Inspector;
    QAction *actionBinROM_Inspector;
    QAction *actionPPUInformation_Inspector;
+   QAction *actionRasterEffects_Inspector;
    QAction *actionJoypadLogger_Inspector;
    QAction *actionCodeDataLogger_Inspector;
    QAction *actionExecution_Visualizer_Inspector;
@@ -172,6 +178,11 @@ protected:
    QAction *actionWave_7N106;
    QAction *actionWave_8N106;
    QAction *actionRun_Test_Suite;
+   QAction *actionRender_NSF_Song;
+   QAction *actionProfile_NSF_Music;
+   CMusicProfiler* m_pMusicProfiler;
+   QString m_profiledNSFFileName;
+   bool m_profiledWithROMLoaded;
    QAction *action1x;
    QAction *action1_5x;
    QAction *action2x;
@@ -184,6 +195,8 @@ protected:
    // C64-specific UI elements.
    C64EmulatorControl* m_pC64EmulatorControl;
    C64EmulatorThread* m_pC64EmulatorThread;
+   C64BuiltInEmulatorThread* m_pC64BuiltInEmulatorThread;
+   C64EmulatorDockWidget* m_pC64Emulator;
    RegisterInspectorDockWidget* m_pBinSIDRegisterInspector;
    QMenu *menuSID_Inspectors;
    QAction *actionBinSIDRegister_Inspector;
@@ -202,6 +215,8 @@ private:
    bool closeProject();
    void explodeTemplate(QString templateDirName,QString localDirName,QString* projectFileName);
    void updateFromEmulatorPrefs(bool initial);
+   QByteArray openNSFFile(QString caption,QString* fileName);
+   bool stopEmulatorForNSF(QString caption);
 
 protected:
    virtual void closeEvent ( QCloseEvent* event );
@@ -302,6 +317,10 @@ private slots:
    void actionNTSC_triggered();
    void actionDendy_triggered();
    void actionRun_Test_Suite_triggered();
+   void actionRender_NSF_Song_triggered();
+   void actionProfile_NSF_Music_triggered();
+   void musicProfiler_trackProfiled(int track);
+   void musicProfiler_profilingComplete(bool ok);
    void actionCodeDataLogger_Inspector_triggered();
    void actionExecution_Visualizer_Inspector_triggered();
    void actionGfxCHRMemory_Inspector_triggered();
@@ -320,6 +339,7 @@ private slots:
    void actionBinPPURegister_Inspector_triggered();
    void actionBinMapperMemory_Inspector_triggered();
    void actionPPUInformation_Inspector_triggered();
+   void actionRasterEffects_Inspector_triggered();
    void actionAPUInformation_Inspector_triggered();
    void actionMapperInformation_Inspector_triggered();
    void actionJoypadLogger_Inspector_triggered();
@@ -0,0 +1,155 @@
+#include "apuspectrumwidget.h"
+
+#include "FFT/RealFft.h"
+
+#include <QPainter>
+
+#include <math.h>
+
+static const char* channelNames [ NUM_APU_CHANNELS+1 ] =
+{
+   "Square1",
+   "Square2",
+   "Triangle",
+   "Noise",
+   "DMC",
+   "Output"
+};
+
+// Full swing of each channel's DAC, and of the mixed output.
+static const float channelRange [ NUM_APU_CHANNELS+1 ] =
+{
+   15.0, 15.0, 15.0, 15.0, 127.0, 32767.0
+};
+
+#define LABEL_WIDTH        64
+#define METER_WIDTH        8
+#define SPECTRUM_MIN_HZ    20.0
+#define SPECTRUM_RANGE_DB  60.0
+
+APUSpectrumWidget::APUSpectrumWidget(QWidget *parent) :
+   QWidget(parent)
+{
+   int channel;
+
+   for ( channel = 0; channel <= NUM_APU_CHANNELS; channel++ )
+   {
+      m_pFft[channel] = new CRealFFT(APU_HISTORY_SIZE,SDL_SAMPLE_RATE);
+      m_level[channel] = 0.0;
+   }
+
+   setMinimumHeight((NUM_APU_CHANNELS+1)*24);
+}
+
+APUSpectrumWidget::~APUSpectrumWidget()
+{
+   int channel;
+
+   for ( channel = 0; channel <= NUM_APU_CHANNELS; channel++ )
+   {
+      delete m_pFft[channel];
+   }
+}
+
+void APUSpectrumWidget::updateSamples()
+{
+   int channel;
+   int idx;
+   int sum;
+   int mean;
+   int low;
+   int high;
+
+   for ( channel = 0; channel <= NUM_APU_CHANNELS; channel++ )
+   {
+      nesGetAPUHistory(channel,m_samples,APU_HISTORY_SIZE);
+
+      sum = 0;
+      low = m_samples[0];
+      high = m_samples[0];
+      for ( idx = 0; idx < APU_HISTORY_SIZE; idx++ )
+      {
+         sum += m_samples[idx];
+         low = qMin(low,(int)m_samples[idx]);
+         high = qMax(high,(int)m_samples[idx]);
+      }
+
+      // The DACs only swing one way, so take the offset out before it
+      // swamps the low bins.
+      mean = sum/APU_HISTORY_SIZE;
+      for ( idx = 0; idx < APU_HISTORY_SIZE; idx++ )
+      {
+         m_centered[idx] = m_samples[idx]-mean;
+      }
+
+      m_level[channel] = (high-low)/channelRange[channel];
+
+      // The history is a whole window so each transform replaces the last.
+      m_pFft[channel]->AddSamples(m_centered,APU_HISTORY_SIZE);
+      m_pFft[channel]->Transform();
+   }
+
+   update();
+}
+
+void APUSpectrumWidget::paintEvent(QPaintEvent */*event*/)
+{
+   QPainter p(this);
+   int rowHeight = height()/(NUM_APU_CHANNELS+1);
+   int left = LABEL_WIDTH+METER_WIDTH+4;
+   int columns = width()-left;
+   double maxHz = SDL_SAMPLE_RATE/2;
+   int channel;
+   int top;
+   int bar;
+   int x;
+   int bin;
+   int lowBin;
+   int highBin;
+   float magnitude;
+   float fullScale;
+   double db;
+
+   p.fillRect(rect(),Qt::black);
+
+   for ( channel = 0; channel <= NUM_APU_CHANNELS; channel++ )
+   {
+      CRealFFT* pFft = m_pFft[channel];
+
+      top = channel*rowHeight;
+
+      // A full swing square wave reads as about half its swing.
+      fullScale = channelRange[channel]/2.0;
+
+      p.setPen(Qt::white);
+      p.drawText(QRect(2,top,LABEL_WIDTH-2,rowHeight),Qt::AlignLeft|Qt::AlignVCenter,channelNames[channel]);
+
+      bar = qBound(0,(int)(m_level[channel]*(rowHeight-2)),rowHeight-2);
+      p.fillRect(LABEL_WIDTH,top+rowHeight-1-bar,METER_WIDTH,bar,Qt::green);
+
+      // Log frequency axis, each column shows the loudest bin it covers.
+      for ( x = 0; x < columns; x++ )
+      {
+         lowBin = pFft->HzToBin(SPECTRUM_MIN_HZ*pow(maxHz/SPECTRUM_MIN_HZ,(double)x/columns));
+         highBin = pFft->HzToBin(SPECTRUM_MIN_HZ*pow(maxHz/SPECTRUM_MIN_HZ,(double)(x+1)/columns));
+         lowBin = qBound(1,lowBin,pFft->Bins()-1);
+         highBin = qBound(lowBin,highBin,pFft->Bins()-1);
+
+         magnitude = 0.0;
+         for ( bin = lowBin; bin <= highBin; bin++ )
+         {
+            magnitude = qMax(magnitude,pFft->GetIntensity(bin));
+         }
+
+         db = 20.0*log10((magnitude/fullScale)+1e-9);
+         bar = qBound(0,(int)(((db+SPECTRUM_RANGE_DB)/SPECTRUM_RANGE_DB)*(rowHeight-2)),rowHeight-2);
+         if ( bar )
+         {
+            p.fillRect(left+x,top+rowHeight-1-bar,1,bar,QColor(128,160,255));
+         }
+      }
+
+      p.setPen(Qt::darkGray);
+      p.drawLine(0,top+rowHeight-1,width(),top+rowHeight-1);
+   }
+}
@@ -0,0 +1,32 @@
+#ifndef APUSPECTRUMWIDGET_H
+#define APUSPECTRUMWIDGET_H
+
+#include <QWidget>
+
+#include "nes_emulator_core.h"
+
+class CRealFFT;
+
+// Shows the level and spectrum of each APU channel and of the mixed output,
+// worked out from the samples the APU keeps for visualisers.
+class APUSpectrumWidget : public QWidget
+{
+   Q_OBJECT
+public:
+   explicit APUSpectrumWidget(QWidget *parent = 0);
+   virtual ~APUSpectrumWidget();
+
+   // Fetches and transforms the latest samples and schedules a repaint.
+   void updateSamples();
+
+protected:
+   void paintEvent(QPaintEvent *event);
+
+private:
+   CRealFFT* m_pFft[NUM_APU_CHANNELS+1];
+   float     m_level[NUM_APU_CHANNELS+1];
+   int16_t   m_samples[APU_HISTORY_SIZE];
+   int       m_centered[APU_HISTORY_SIZE];
+};
+
+#endif // APUSPECTRUMWIDGET_H
@@ -36,9 +36,46 @@ bool CGameDatabaseHandler::initialize(QString fileName)
       m_db.setContent(&res);
       res.close();
    }
+
+   buildIndex();
+
    return openedFile;
 }
 
+void CGameDatabaseHandler::buildIndex()
+{
+   QDomElement docElem = m_db.documentElement();
+   QDomNode    gameNode = docElem.firstChild();
+
+   m_sha1Index.clear();
+
+   // Index every cartridge in the loaded game database by its SHA1...
+   while (!gameNode.isNull())
+   {
+      QDomNode cartridgeNode = gameNode.firstChild();
+
+      while (!cartridgeNode.isNull())
+      {
+         QDomElement cartridgeElem = cartridgeNode.toElement(); // try to convert the node to an element.
+
+         if ( !cartridgeElem.isNull() && cartridgeElem.hasAttribute("sha1") )
+         {
+            QByteArray sha1key = QByteArray::fromHex(cartridgeElem.attribute("sha1").toLatin1());
+
+            // First entry wins, same as the old linear search...
+            if ( !m_sha1Index.contains(sha1key) )
+            {
+               m_sha1Index.insert(sha1key,cartridgeNode);
+            }
+         }
+
+         cartridgeNode = cartridgeNode.nextSibling();
+      }
+
+      gameNode = gameNode.nextSibling();
+   }
+}
+
 QString CGameDatabaseHandler::getGameDBTimestamp()
 {
    QDomElement        docElem = m_db.documentElement();
@@ -53,7 +90,6 @@ QString CGameDatabaseHandler::getGameDBAuthor()
 
 bool CGameDatabaseHandler::find(CCartridge* pCartridge)
 {
-   QDomElement        docElem = m_db.documentElement();
    QCryptographicHash sha1alg(QCryptographicHash::Sha1);
    QByteArray         sha1key;
    int                i;
@@ -79,34 +115,15 @@ bool CGameDatabaseHandler::find(CCartridge* pCartridge)
    // Get the resulting hash value from the crypto...
    sha1key = sha1alg.result();
 
-   // Search the loaded game database for the corresponding hash value...
-   QDomNode gameNode = docElem.firstChild();
+   // Look up the hash value in the loaded game database...
+   QHash<QByteArray,QDomNode>::const_iterator iter = m_sha1Index.constFind(sha1key);
 
-   while (!gameNode.isNull())
+   if ( iter != m_sha1Index.constEnd() )
    {
-      QDomElement gameElem = gameNode.toElement(); // try to convert the node to an element.
-
-      if (!gameElem.isNull())
-      {
-         QDomNode cartridgeNode = gameElem.firstChild();
-
-         while (!cartridgeNode.isNull())
-         {
-            QDomElement cartridgeElem = cartridgeNode.toElement(); // try to convert the node to an element.
-
-            if ( sha1key.toHex().toUpper() == cartridgeElem.attribute("sha1").toUpper() )
-            {
-               // Save found game for later reference...
-               m_game = gameNode.cloneNode();
-               m_cartridge = cartridgeNode.cloneNode();
-               return true;
-            }
-
-            cartridgeNode = cartridgeNode.nextSibling();
-         }
-      }
-
-      gameNode = gameNode.nextSibling();
+      // Save found game for later reference...
+      m_game = iter.value().parentNode().cloneNode();
+      m_cartridge = iter.value().cloneNode();
+      return true;
    }
 
    return false;
@@ -3,6 +3,8 @@
 
 #include <QDomDocument>
 #include <QDomElement>
+#include <QHash>
+#include <QByteArray>
 #include <QString>
 
 #include "ccartridge.h"
@@ -49,7 +51,13 @@ public:
    }
 
 protected:
+   void buildIndex();
+
    QDomDocument m_db;
+
+   // Cartridge nodes of the database keyed by their binary SHA1 so a
+   // ROM can be looked up without walking the document.
+   QHash<QByteArray,QDomNode> m_sha1Index;
    QDomNode     m_game;
    QDomNode     m_cartridge;
 };
@@ -2,49 +2,106 @@
 #include "cnessystempalette.h"
 #include "cdesignercommon.h"
 
+// The eight pixels of a bitplane byte, leftmost first, each 0 or 1.
+static uchar planeBits[256][8];
+static bool  planeBitsBuilt = false;
+
+void CImageConverters::decodeTile(const char* chrIn, uchar* pixels, int stride, uchar attrBits)
+{
+   const uchar* plane1;
+   const uchar* plane2;
+   int idx;
+   int x;
+   int y;
+
+   if ( !planeBitsBuilt )
+   {
+      for ( idx = 0; idx < 256; idx++ )
+      {
+         for ( x = 0; x < 8; x++ )
+         {
+            planeBits[idx][x] = (idx>>(7-x))&0x1;
+         }
+      }
+      planeBitsBuilt = true;
+   }
+
+   for ( y = 0; y < 8; y++ )
+   {
+      plane1 = planeBits[(uchar)chrIn[y]];
+      plane2 = planeBits[(uchar)chrIn[y+8]];
+      for ( x = 0; x < 8; x++ )
+      {
+         pixels[x] = plane1[x]|(plane2[x]<<1)|attrBits;
+      }
+      pixels += stride;
+   }
+}
+
+void CImageConverters::encodeTile(const uchar* pixels, int stride, char* chrOut)
+{
+   quint64 row;
+   int y;
+
+   for ( y = 0; y < 8; y++ )
+   {
+      // Gather a row's eight pixels into one word, leftmost in the low byte,
+      // then pick one bit of each byte out into a bitplane byte with a
+      // single multiply.
+      row = ((quint64)pixels[0])|((quint64)pixels[1]<<8)|((quint64)pixels[2]<<16)|((quint64)pixels[3]<<24)|
+            ((quint64)pixels[4]<<32)|((quint64)pixels[5]<<40)|((quint64)pixels[6]<<48)|((quint64)pixels[7]<<56);
+
+      chrOut[y] = (char)(((row&Q_UINT64_C(0x0101010101010101))*Q_UINT64_C(0x8040201008040201))>>56);
+      chrOut[y+8] = (char)((((row>>1)&Q_UINT64_C(0x0101010101010101))*Q_UINT64_C(0x8040201008040201))>>56);
+
+      pixels += stride;
+   }
+}
+
 QByteArray CImageConverters::fromIndexed8(QImage imgIn)
 {
    QByteArray chrOut;
-   int x = 0;
-   int y = 0;
-   int width = imgIn.width();
-   int height = imgIn.height();
    int tile;
-   int tileWidth = width/8;
-   int tileHeight = height/8;
    int tileX;
    int tileY;
-   int numTiles = (tileWidth*tileHeight);
-   char plane1[8];
-   char plane2[8];
-   const uchar* bits = imgIn.bits();
+   int tileWidth;
+   int tileHeight;
+   int tilesPerRow;
+   int numTiles;
+   char chr[16];
+
+   // One byte per pixel is assumed below.
+   if ( imgIn.format() != QImage::Format_Indexed8 )
+   {
+      imgIn = imgIn.convertToFormat(QImage::Format_Indexed8);
+   }
+
+   tileWidth = imgIn.width()/8;
+   tileHeight = imgIn.height()/8;
 
-   if ( tileWidth > 16 ) tileWidth = 16;
+   // Constrain to "left-and-right banks" for CHR images up to 128 pixels
+   // tall and wider than a bank, as toIndexed8 lays them out.
+   tilesPerRow = tileWidth;
+   if ( (tileHeight <= 16) && (tileWidth > 16) ) tilesPerRow = 16;
+   if ( !tilesPerRow ) return chrOut;
+
+   numTiles = tilesPerRow*tileHeight*((tileWidth+tilesPerRow-1)/tilesPerRow);
 
    for ( tile = 0; tile < numTiles; tile++ )
    {
-      tileX = (tile%tileWidth)*8;
-      tileY = (tile/tileWidth)*8;
+      tileX = (tile%tilesPerRow)*8;
+      tileY = (tile/tilesPerRow)*8;
 
-      if ( tile >= 256 )
+      if ( tilesPerRow < tileWidth )
       {
-         tileX += 128;
-         tileY -= 128;
+         tileX += (tile/(tilesPerRow*tileHeight))*128;
+         tileY -= (tile/(tilesPerRow*tileHeight))*tileHeight*8;
       }
 
-      for ( y = 0; y < 8; y++ )
-      {
-         for ( x = 0; x < 8; x++ )
-         {
-            plane1[y] <<= 1;
-            plane2[y] <<= 1;
+      if ( (tileX+8 > imgIn.width()) || (tileY+8 > imgIn.height()) ) continue;
 
-            plane1[y] |= bits[((tileY+y)*width)+tileX+x]&0x01;
-            plane2[y] |= ((bits[((tileY+y)*width)+tileX+x]&0x02)>>1);
-         }
-      }
-      chrOut.append(plane1,8);
-      chrOut.append(plane2,8);
+      encodeTile(imgIn.constScanLine(tileY)+tileX,imgIn.bytesPerLine(),chr);
+      chrOut.append(chr,16);
    }
 
    return chrOut;
@@ -54,17 +111,12 @@ QImage CImageConverters::toIndexed8(QByteArray chrIn, int xSize, int ySize)
 {
    QImage imgOut(xSize,ySize,QImage::Format_Indexed8);
 
-   int x;
-   int y;
    int tile;
    int tileX;
    int tileY;
    int tileWidth = xSize/8;
    int tileHeight = ySize/8;
    int numTiles = chrIn.count()/0x10;
-   char plane1;
-   char plane2;
-   char pixel;
 
    imgOut.setNumColors(16);
    imgOut.setColorCount(16);
@@ -91,20 +143,9 @@ QImage CImageConverters::toIndexed8(QByteArray chrIn, int xSize, int ySize)
          }
       }
 
-      for ( y = 0; y < 8; y++ )
-      {
-         plane1 = chrIn.at((tile<<4)+y);
-         plane2 = chrIn.at((tile<<4)+y+8);
+      if ( (tileX+8 > xSize) || (tileY+8 > ySize) ) continue;
 
-         for ( x = 0; x < 8; x++ )
-         {
-            pixel = (!!(plane1&0x80))
-                  | ((!!(plane2&0x80))<<1);
-            imgOut.setPixel(tileX+x,tileY+y,pixel);
-            plane1 <<= 1;
-            plane2 <<= 1;
-         }
-      }
+      decodeTile(chrIn.constData()+(tile<<4),imgOut.scanLine(tileY)+tileX,imgOut.bytesPerLine());
    }
 
    return imgOut;
@@ -114,17 +155,12 @@ QImage CImageConverters::toIndexed8(QByteArray chrIn, QList<int> colorTable, int
 {
    QImage imgOut(xSize,ySize,QImage::Format_Indexed8);
 
-   int x;
-   int y;
    int tile;
    int tileX;
    int tileY;
    int tileWidth = xSize/8;
    int tileHeight = ySize/8;
    int numTiles = chrIn.count()/0x10;
-   char plane1;
-   char plane2;
-   char pixel;
    int idx;
 
    // Constrain to "left-and-right banks" for 256x128 CHR image if necessary.
@@ -152,20 +188,9 @@ QImage CImageConverters::toIndexed8(QByteArray chrIn, QList<int> colorTable, int
          }
       }
 
-      for ( y = 0; y < 8; y++ )
-      {
-         plane1 = chrIn.at((tile<<4)+y);
-         plane2 = chrIn.at((tile<<4)+y+8);
+      if ( (tileX+8 > xSize) || (tileY+8 > ySize) ) continue;
 
-         for ( x = 0; x < 8; x++ )
-         {
-            pixel = (!!(plane1&0x80))
-                  | ((!!(plane2&0x80))<<1);
-            imgOut.setPixel(tileX+x,tileY+y,pixel);
-            plane1 <<= 1;
-            plane2 <<= 1;
-         }
-      }
+      decodeTile(chrIn.constData()+(tile<<4),imgOut.scanLine(tileY)+tileX,imgOut.bytesPerLine());
    }
 
    return imgOut;
@@ -175,18 +200,13 @@ QImage CImageConverters::toIndexed8(QByteArray chrIn, QByteArray attrIn, QList<u
 {
    QImage imgOut(xSize,ySize,QImage::Format_Indexed8);
 
-   int x;
-   int y;
    int tile;
    int tileX;
    int tileY;
    int tileWidth = xSize/8;
    int tileHeight = ySize/8;
    int numTiles = chrIn.count()/0x10;
-   char plane1;
-   char plane2;
    char plane34;
-   char pixel;
    int attrQuadsX;
    int attrQuadsY;
    int attrQuadX;
@@ -225,38 +245,25 @@ QImage CImageConverters::toIndexed8(QByteArray chrIn, QByteArray attrIn, QList<u
          }
       }
 
-      for ( y = 0; y < 8; y++ )
-      {
-         // Get bitplanes from image data.
-         plane1 = chrIn.at((tile<<4)+y);
-         plane2 = chrIn.at((tile<<4)+y+8);
-
-         // Get bitplanes from attribute data.
-         attrQuadX = PIXEL_TO_ATTRQUAD(tileX);
-         attrQuadY = PIXEL_TO_ATTRQUAD(tileY);
-         attrQuad = (attrQuadY*attrQuadsX)+attrQuadX;
-         if ( attrQuad < attrIn.count() )
-         {
-            plane34 = attrIn.at(attrQuad);
-         }
-         else
-         {
-            plane34 = 0x00;
-         }
-         plane34 >>= (PIXEL_TO_ATTRSECTION(tileX,tileY)<<1);
-         plane34 &= 0x03;
-         plane34 <<= 2;
+      if ( (tileX+8 > xSize) || (tileY+8 > ySize) ) continue;
 
-         for ( x = 0; x < 8; x++ )
-         {
-            pixel = (!!(plane1&0x80))
-                  | ((!!(plane2&0x80))<<1)
-                  | plane34;
-            imgOut.setPixel(tileX+x,tileY+y,pixel);
-            plane1 <<= 1;
-            plane2 <<= 1;
-         }
+      // Get bitplanes from attribute data.
+      attrQuadX = PIXEL_TO_ATTRQUAD(tileX);
+      attrQuadY = PIXEL_TO_ATTRQUAD(tileY);
+      attrQuad = (attrQuadY*attrQuadsX)+attrQuadX;
+      if ( attrQuad < attrIn.count() )
+      {
+         plane34 = attrIn.at(attrQuad);
+      }
+      else
+      {
+         plane34 = 0x00;
       }
+      plane34 >>= (PIXEL_TO_ATTRSECTION(tileX,tileY)<<1);
+      plane34 &= 0x03;
+      plane34 <<= 2;
+
+      decodeTile(chrIn.constData()+(tile<<4),imgOut.scanLine(tileY)+tileX,imgOut.bytesPerLine(),plane34);
    }
 
    return imgOut;
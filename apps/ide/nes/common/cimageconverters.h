@@ -23,6 +23,15 @@ public:
     // Create a x/y dimensioned CHR image from a byte stream using the given attribute map and color table.
     // Default x/y dimensions create a CHR bank image.
     static QImage     toIndexed8(QByteArray chrIn,QByteArray attrIn,QList<uint8_t> colorTable,int xSize=256,int ySize=128);
+
+    // Decode one 16-byte CHR tile into 8 rows of 8 color indexes (0-3), rows
+    // stride bytes apart, ORing attrBits into each.  Bitplane bytes are
+    // expanded through a lookup table rather than bit by bit.
+    static void       decodeTile(const char* chrIn,uchar* pixels,int stride,uchar attrBits=0);
+
+    // Encode 8 rows of 8 color indexes, rows stride bytes apart, into one
+    // 16-byte CHR tile.  Only bits 0-1 of each index are used.
+    static void       encodeTile(const uchar* pixels,int stride,char* chrOut);
 };
 
 #endif // CIMAGECONVERTERS_H
@@ -0,0 +1,547 @@
+#include "cimagequantizer.h"
+#include "cimageconverters.h"
+#include "cnessystempalette.h"
+
+#include <QHash>
+#include <QFile>
+#include <QtAlgorithms>
+
+#include <math.h>
+#include <string.h>
+
+#define SECTION_SIZE 16
+#define MAX_PASSES   16
+
+// The NES color nearest each 32x32x32 cell of RGB space, and the squared
+// distance between each pair of NES colors, both in L*a*b* space.  They're
+// built again if the system palette has changed since they were last built.
+static uint8_t colorLut[32*32*32];
+static int     colorDistance[64][64];
+static uint8_t colorLutRGB[64][3];
+static bool    colorTablesBuilt = false;
+
+// Only one of the NES's many blacks is offered, and none of the columns
+// that repeat other colors.
+static inline bool usableColor(int idx)
+{
+   return ((idx&0x0F) < 0x0D) || (idx == 0x0F);
+}
+
+static void toLab(int r,int g,int b,double* lab)
+{
+   double rgb[3] = { r/255.0, g/255.0, b/255.0 };
+   double xyz[3];
+   int idx;
+
+   for ( idx = 0; idx < 3; idx++ )
+   {
+      rgb[idx] = (rgb[idx] > 0.04045)?pow((rgb[idx]+0.055)/1.055,2.4):(rgb[idx]/12.92);
+   }
+
+   // Relative to the D65 white point.
+   xyz[0] = ((rgb[0]*0.4124)+(rgb[1]*0.3576)+(rgb[2]*0.1805))/0.95047;
+   xyz[1] = ((rgb[0]*0.2126)+(rgb[1]*0.7152)+(rgb[2]*0.0722));
+   xyz[2] = ((rgb[0]*0.0193)+(rgb[1]*0.1192)+(rgb[2]*0.9505))/1.08883;
+
+   for ( idx = 0; idx < 3; idx++ )
+   {
+      xyz[idx] = (xyz[idx] > 0.008856)?pow(xyz[idx],1.0/3.0):((7.787*xyz[idx])+(16.0/116.0));
+   }
+
+   lab[0] = (116.0*xyz[1])-16.0;
+   lab[1] = 500.0*(xyz[0]-xyz[1]);
+   lab[2] = 200.0*(xyz[1]-xyz[2]);
+}
+
+static inline double labDistance(const double* lab1,const double* lab2)
+{
+   return ((lab1[0]-lab2[0])*(lab1[0]-lab2[0]))+
+          ((lab1[1]-lab2[1])*(lab1[1]-lab2[1]))+
+          ((lab1[2]-lab2[2])*(lab1[2]-lab2[2]));
+}
+
+void CImageQuantizer::buildColorTables()
+{
+   double paletteLab[64][3];
+   double lab[3];
+   double distance;
+   double bestDistance;
+   bool changed = !colorTablesBuilt;
+   int idx1;
+   int idx2;
+   int r, g, b;
+
+   for ( idx1 = 0; idx1 < 64; idx1++ )
+   {
+      if ( (colorLutRGB[idx1][0] != (uint8_t)CBasePalette::GetPaletteR(idx1)) ||
+           (colorLutRGB[idx1][1] != (uint8_t)CBasePalette::GetPaletteG(idx1)) ||
+           (colorLutRGB[idx1][2] != (uint8_t)CBasePalette::GetPaletteB(idx1)) )
+      {
+         colorLutRGB[idx1][0] = CBasePalette::GetPaletteR(idx1);
+         colorLutRGB[idx1][1] = CBasePalette::GetPaletteG(idx1);
+         colorLutRGB[idx1][2] = CBasePalette::GetPaletteB(idx1);
+         changed = true;
+      }
+   }
+   if ( !changed )
+   {
+      return;
+   }
+
+   for ( idx1 = 0; idx1 < 64; idx1++ )
+   {
+      toLab(colorLutRGB[idx1][0],colorLutRGB[idx1][1],colorLutRGB[idx1][2],paletteLab[idx1]);
+   }
+   for ( idx1 = 0; idx1 < 64; idx1++ )
+   {
+      for ( idx2 = 0; idx2 < 64; idx2++ )
+      {
+         colorDistance[idx1][idx2] = (int)labDistance(paletteLab[idx1],paletteLab[idx2]);
+      }
+   }
+
+   // Each cell takes the color nearest its middle.
+   for ( r = 0; r < 32; r++ )
+   {
+      for ( g = 0; g < 32; g++ )
+      {
+         for ( b = 0; b < 32; b++ )
+         {
+            toLab((r<<3)|4,(g<<3)|4,(b<<3)|4,lab);
+
+            bestDistance = -1.0;
+            for ( idx1 = 0; idx1 < 64; idx1++ )
+            {
+               if ( usableColor(idx1) )
+               {
+                  distance = labDistance(lab,paletteLab[idx1]);
+                  if ( (bestDistance < 0.0) || (distance < bestDistance) )
+                  {
+                     bestDistance = distance;
+                     colorLut[(r<<10)|(g<<5)|b] = idx1;
+                  }
+               }
+            }
+         }
+      }
+   }
+
+   colorTablesBuilt = true;
+}
+
+CImageQuantizer::CImageQuantizer(QImage imgIn,int originX,int originY)
+{
+   QImage image = imgIn.convertToFormat(QImage::Format_RGB32);
+   const QRgb* line;
+   uint8_t color;
+   int section;
+   int x;
+   int y;
+
+   buildColorTables();
+
+   m_width = image.width();
+   m_height = image.height();
+   m_originX = ((originX%SECTION_SIZE)+SECTION_SIZE)%SECTION_SIZE;
+   m_originY = ((originY%SECTION_SIZE)+SECTION_SIZE)%SECTION_SIZE;
+   m_sectionsX = (m_originX+m_width+SECTION_SIZE-1)/SECTION_SIZE;
+   m_sectionsY = (m_originY+m_height+SECTION_SIZE-1)/SECTION_SIZE;
+
+   m_colors.resize(m_width*m_height);
+   m_counts = QVector<int>(m_sectionsX*m_sectionsY*64,0);
+   m_sectionPalette = QVector<uint8_t>(m_sectionsX*m_sectionsY,0);
+   memset(m_subPalettes,0x0F,sizeof(m_subPalettes));
+
+   for ( y = 0; y < m_height; y++ )
+   {
+      line = (const QRgb*)image.constScanLine(y);
+
+      for ( x = 0; x < m_width; x++ )
+      {
+         color = colorLut[((qRed(line[x])>>3)<<10)|((qGreen(line[x])>>3)<<5)|(qBlue(line[x])>>3)];
+         section = (((m_originY+y)/SECTION_SIZE)*m_sectionsX)+((m_originX+x)/SECTION_SIZE);
+
+         m_colors[(y*m_width)+x] = color;
+         m_counts[(section*64)+color]++;
+      }
+   }
+}
+
+qint64 CImageQuantizer::sectionCost(const int* counts,const uint8_t* colors)
+{
+   qint64 cost = 0;
+   int distance;
+   int color;
+
+   for ( color = 0; color < 64; color++ )
+   {
+      if ( counts[color] )
+      {
+         distance = qMin(qMin(colorDistance[color][colors[0]],colorDistance[color][colors[1]]),
+                         qMin(colorDistance[color][colors[2]],colorDistance[color][colors[3]]));
+         cost += (qint64)distance*counts[color];
+      }
+   }
+
+   return cost;
+}
+
+void CImageQuantizer::bestColors(const int* counts,uint8_t* colors)
+{
+   qint64 cost;
+   qint64 bestCost;
+   uint8_t bestColor;
+   int color;
+   int entry;
+
+   // colors[0] is the background color.  The rest are picked one at a time,
+   // each the color present that most improves on those picked before it.
+   for ( entry = 1; entry < 4; entry++ )
+   {
+      colors[entry] = colors[entry-1];
+      bestColor = colors[entry];
+      bestCost = sectionCost(counts,colors);
+
+      for ( color = 0; color < 64; color++ )
+      {
+         if ( counts[color] )
+         {
+            colors[entry] = color;
+            cost = sectionCost(counts,colors);
+            if ( cost < bestCost )
+            {
+               bestCost = cost;
+               bestColor = color;
+            }
+         }
+      }
+
+      colors[entry] = bestColor;
+   }
+}
+
+bool CImageQuantizer::assignSections()
+{
+   qint64 cost;
+   qint64 bestCost;
+   uint8_t bestPalette;
+   bool changed = false;
+   int section;
+   int palette;
+
+   for ( section = 0; section < m_sectionsX*m_sectionsY; section++ )
+   {
+      bestPalette = 0;
+      bestCost = sectionCost(m_counts.constData()+(section*64),m_subPalettes[0]);
+
+      for ( palette = 1; palette < 4; palette++ )
+      {
+         cost = sectionCost(m_counts.constData()+(section*64),m_subPalettes[palette]);
+         if ( cost < bestCost )
+         {
+            bestCost = cost;
+            bestPalette = palette;
+         }
+      }
+
+      if ( m_sectionPalette[section] != bestPalette )
+      {
+         m_sectionPalette[section] = bestPalette;
+         changed = true;
+      }
+   }
+
+   return changed;
+}
+
+void CImageQuantizer::choosePalette()
+{
+   QHash<int,int> candidates;
+   QHash<int,int>::const_iterator iter;
+   int totals[64] = { 0, };
+   int counts[64];
+   uint8_t colors[4];
+   uint8_t background = 0x0F;
+   int section;
+   int palette;
+   int color;
+   int pass;
+   int weight;
+   int best;
+
+   // The commonest color is the background color.
+   for ( section = 0; section < m_sectionsX*m_sectionsY; section++ )
+   {
+      for ( color = 0; color < 64; color++ )
+      {
+         totals[color] += m_counts[(section*64)+color];
+      }
+   }
+   for ( color = 0; color < 64; color++ )
+   {
+      if ( totals[color] > totals[background] )
+      {
+         background = color;
+      }
+   }
+
+   // Start from the sub-palettes that best suit the most pixels on their own.
+   for ( section = 0; section < m_sectionsX*m_sectionsY; section++ )
+   {
+      weight = 0;
+      for ( color = 0; color < 64; color++ )
+      {
+         weight += m_counts[(section*64)+color];
+      }
+
+      colors[0] = background;
+      bestColors(m_counts.constData()+(section*64),colors);
+      qSort(colors+1,colors+4);
+
+      candidates[(colors[1]<<16)|(colors[2]<<8)|colors[3]] += weight;
+   }
+   for ( palette = 0; palette < 4; palette++ )
+   {
+      best = -1;
+      for ( iter = candidates.constBegin(); iter != candidates.constEnd(); ++iter )
+      {
+         if ( (best < 0) || (iter.value() > candidates.value(best)) )
+         {
+            best = iter.key();
+         }
+      }
+
+      if ( best >= 0 )
+      {
+         candidates.remove(best);
+      }
+      else
+      {
+         // Fewer distinct sub-palettes than four; repeat the first.
+         best = (m_subPalettes[0][1]<<16)|(m_subPalettes[0][2]<<8)|m_subPalettes[0][3];
+      }
+
+      m_subPalettes[palette][0] = background;
+      m_subPalettes[palette][1] = (best>>16)&0xFF;
+      m_subPalettes[palette][2] = (best>>8)&0xFF;
+      m_subPalettes[palette][3] = best&0xFF;
+   }
+
+   for ( pass = 0; pass < MAX_PASSES; pass++ )
+   {
+      if ( (!assignSections()) && pass )
+      {
+         break;
+      }
+
+      for ( palette = 0; palette < 4; palette++ )
+      {
+         memset(counts,0,sizeof(counts));
+         weight = 0;
+         for ( section = 0; section < m_sectionsX*m_sectionsY; section++ )
+         {
+            if ( m_sectionPalette[section] == palette )
+            {
+               for ( color = 0; color < 64; color++ )
+               {
+                  counts[color] += m_counts[(section*64)+color];
+                  weight += m_counts[(section*64)+color];
+               }
+            }
+         }
+
+         // A sub-palette no section wants is left as it is.
+         if ( weight )
+         {
+            bestColors(counts,m_subPalettes[palette]);
+         }
+      }
+   }
+   assignSections();
+
+   m_palette.clear();
+   for ( palette = 0; palette < 4; palette++ )
+   {
+      for ( color = 0; color < 4; color++ )
+      {
+         m_palette.append(m_subPalettes[palette][color]);
+      }
+   }
+}
+
+void CImageQuantizer::setPalette(QList<uint8_t> palette)
+{
+   int entry;
+
+   m_palette = palette;
+
+   for ( entry = 0; entry < 16; entry++ )
+   {
+      m_subPalettes[entry>>2][entry&3] = (entry&3)?palette.at(entry):palette.at(0);
+   }
+
+   assignSections();
+}
+
+QImage CImageQuantizer::toIndexed8()
+{
+   QImage imgOut(m_width,m_height,QImage::Format_Indexed8);
+   const uint8_t* subPalette;
+   uint8_t* line;
+   uint8_t color;
+   int palette;
+   int entry;
+   int best;
+   int x;
+   int y;
+
+   imgOut.setColorCount(16);
+   for ( entry = 0; entry < m_palette.count(); entry++ )
+   {
+      imgOut.setColor(entry,qRgb((uint8_t)CBasePalette::GetPaletteR(m_palette.at(entry)),
+                                 (uint8_t)CBasePalette::GetPaletteG(m_palette.at(entry)),
+                                 (uint8_t)CBasePalette::GetPaletteB(m_palette.at(entry))));
+   }
+
+   for ( y = 0; y < m_height; y++ )
+   {
+      line = imgOut.scanLine(y);
+
+      for ( x = 0; x < m_width; x++ )
+      {
+         color = m_colors[(y*m_width)+x];
+         palette = m_sectionPalette[(((m_originY+y)/SECTION_SIZE)*m_sectionsX)+((m_originX+x)/SECTION_SIZE)];
+         subPalette = m_subPalettes[palette];
+
+         best = 0;
+         for ( entry = 1; entry < 4; entry++ )
+         {
+            if ( colorDistance[color][subPalette[entry]] < colorDistance[color][subPalette[best]] )
+            {
+               best = entry;
+            }
+         }
+
+         line[x] = (palette<<2)|best;
+      }
+   }
+
+   return imgOut;
+}
+
+QByteArray CImageQuantizer::toCHR()
+{
+   return CImageConverters::fromIndexed8(toIndexed8());
+}
+
+int CImageQuantizer::sectionPalette(int x,int y)
+{
+   int sectionX = (m_originX+x)/SECTION_SIZE;
+   int sectionY = (m_originY+y)/SECTION_SIZE;
+
+   if ( (sectionX >= m_sectionsX) || (sectionY >= m_sectionsY) )
+   {
+      return 0;
+   }
+
+   return m_sectionPalette[(sectionY*m_sectionsX)+sectionX];
+}
+
+void CImageQuantizer::toScreen(QByteArray* chrOut,QByteArray* nametableOut,QByteArray* attributesOut)
+{
+   QImage indexed = toIndexed8();
+   QHash<QByteArray,int> tiles;
+   QByteArray tile;
+   uchar pixels[8*8];
+   char chr[16];
+   int tilesX = (m_width+7)/8;
+   int tilesY = (m_height+7)/8;
+   int tileX;
+   int tileY;
+   int blockX;
+   int blockY;
+   int x;
+   int y;
+   uint8_t attr;
+
+   chrOut->clear();
+   nametableOut->clear();
+   attributesOut->clear();
+
+   for ( tileY = 0; tileY < tilesY; tileY++ )
+   {
+      for ( tileX = 0; tileX < tilesX; tileX++ )
+      {
+         // Tiles hanging off the right or bottom edge are filled out with
+         // the background color.
+         memset(pixels,0,sizeof(pixels));
+         for ( y = 0; (y < 8) && ((tileY*8)+y < m_height); y++ )
+         {
+            for ( x = 0; (x < 8) && ((tileX*8)+x < m_width); x++ )
+            {
+               pixels[(y*8)+x] = indexed.constScanLine((tileY*8)+y)[(tileX*8)+x];
+            }
+         }
+
+         CImageConverters::encodeTile(pixels,8,chr);
+         tile = QByteArray(chr,16);
+
+         if ( !tiles.contains(tile) )
+         {
+            tiles.insert(tile,chrOut->size()/16);
+            chrOut->append(tile);
+         }
+         nametableOut->append((char)(tiles.value(tile)&0xFF));
+      }
+   }
+
+   for ( blockY = 0; blockY < (m_height+31)/32; blockY++ )
+   {
+      for ( blockX = 0; blockX < (m_width+31)/32; blockX++ )
+      {
+         attr = sectionPalette(blockX*32,blockY*32)|
+                (sectionPalette((blockX*32)+16,blockY*32)<<2)|
+                (sectionPalette(blockX*32,(blockY*32)+16)<<4)|
+                (sectionPalette((blockX*32)+16,(blockY*32)+16)<<6);
+         attributesOut->append((char)attr);
+      }
+   }
+}
+
+static bool writeIfChanged(QString fileName,QByteArray data)
+{
+   QFile file(fileName);
+
+   if ( file.open(QIODevice::ReadOnly) )
+   {
+      if ( file.readAll() == data )
+      {
+         file.close();
+         return true;
+      }
+      file.close();
+   }
+
+   if ( !file.open(QIODevice::WriteOnly|QIODevice::Truncate) )
+   {
+      return false;
+   }
+   file.write(data);
+   file.close();
+
+   return true;
+}
+
+bool CImageQuantizer::saveScreen(QString baseName,QByteArray nametable,QByteArray attributes)
+{
+   QByteArray palette;
+   int entry;
+
+   for ( entry = 0; entry < m_palette.count(); entry++ )
+   {
+      palette.append((char)m_palette.at(entry));
+   }
+
+   return writeIfChanged(baseName+".nam",nametable+attributes) &&
+          writeIfChanged(baseName+".pal",palette);
+}
@@ -0,0 +1,84 @@
+#ifndef CIMAGEQUANTIZER_H
+#define CIMAGEQUANTIZER_H
+
+#include <QImage>
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+
+#include <stdint.h> // for standard base types...
+
+// Turns RGB art of any size into NES graphics.
+//
+// Each pixel is first matched to the nearest color of the NES master
+// palette, judged by distance in CIE L*a*b* space, through a lookup table
+// of 32x32x32 RGB cells built once for the current system palette.  The
+// image is then split into the 16x16 pixel sections an attribute byte
+// gives a sub-palette to.  choosePalette() picks a background color and
+// four sub-palettes of three colors to suit the sections, alternately
+// giving each section the sub-palette that draws it best and picking each
+// sub-palette's colors to best draw the sections given it, until no
+// section changes sub-palette.  Each pixel then takes the nearest color of
+// its section's sub-palette.
+class CImageQuantizer
+{
+public:
+   // originX and originY are where the image's top left pixel falls within
+   // the attribute section grid of whatever it's going to be drawn into.
+   CImageQuantizer(QImage imgIn,int originX = 0,int originY = 0);
+
+   // Chooses a background color and four sub-palettes that suit the image.
+   void choosePalette();
+
+   // Or uses the sixteen NES colors given; entry 0 is the background color.
+   void setPalette(QList<uint8_t> palette);
+   QList<uint8_t> palette() const { return m_palette; }
+
+   // The image as color indexes, bits 0-1 the color and bits 2-3 the
+   // sub-palette, the same layout the designers use.
+   QImage toIndexed8();
+
+   // The image as CHR tiles, in the order CImageConverters::fromIndexed8
+   // would give them.
+   QByteArray toCHR();
+
+   // The image as a screen: each distinct CHR tile once, in the order they
+   // first appear, a nametable byte per 8x8 tile and an attribute byte per
+   // 32x32 pixel block, both left to right and top to bottom.  A 256x240
+   // image gives exactly the 960 nametable and 64 attribute bytes of one
+   // PPU nametable.
+   void toScreen(QByteArray* chrOut,QByteArray* nametableOut,QByteArray* attributesOut);
+
+   // Writes the nametable bytes followed by the attribute bytes to
+   // baseName.nam and the sixteen palette entries to baseName.pal, as NES
+   // screen tools lay them out.  Files that already hold the same bytes
+   // are left alone.
+   bool saveScreen(QString baseName,QByteArray nametable,QByteArray attributes);
+
+private:
+   static void buildColorTables();
+   qint64 sectionCost(const int* counts,const uint8_t* colors);
+   void bestColors(const int* counts,uint8_t* colors);
+   bool assignSections();
+   int sectionPalette(int x,int y);
+
+   int m_width;
+   int m_height;
+   int m_originX;
+   int m_originY;
+   int m_sectionsX;
+   int m_sectionsY;
+
+   // The nearest NES color to each pixel, and how many pixels of each NES
+   // color each section has.
+   QVector<uint8_t> m_colors;
+   QVector<int> m_counts;
+
+   // The sub-palette given to each section, and the background color and
+   // three colors of each sub-palette.
+   QVector<uint8_t> m_sectionPalette;
+   uint8_t m_subPalettes[4][4];
+   QList<uint8_t> m_palette;
+};
+
+#endif // CIMAGEQUANTIZER_H
@@ -0,0 +1,252 @@
+#include "ctilificator.h"
+
+#include <string.h>
+
+#define TILE_SIZE 16
+
+// Reverses the bits of a byte, which flips a row of a tile horizontally.
+static unsigned char reversedBits[256];
+
+static void buildReversedBits()
+{
+   int idx;
+   int bit;
+
+   if ( reversedBits[0x80] )
+   {
+      return;
+   }
+   for ( idx = 0; idx < 256; idx++ )
+   {
+      reversedBits[idx] = 0;
+      for ( bit = 0; bit < 8; bit++ )
+      {
+         if ( idx&(1<<bit) )
+         {
+            reversedBits[idx] |= (0x80>>bit);
+         }
+      }
+   }
+}
+
+CTilificator::CTilificator(int bankSize)
+{
+   m_bankSize = bankSize;
+   m_tilesPerBank = bankSize/TILE_SIZE;
+
+   buildReversedBits();
+   clear();
+}
+
+void CTilificator::clear()
+{
+   m_bankItems.clear();
+   m_tilify.clear();
+   m_shareFlips.clear();
+   m_output.clear();
+   m_slotUsed.clear();
+   m_nextFreeSlot.clear();
+   m_placedTiles.clear();
+   m_remapSlot.clear();
+   m_remapFlips.clear();
+
+   m_tiles = 0;
+   m_lockedTiles = 0;
+   m_duplicateTiles = 0;
+   m_sharedFlippedTiles = 0;
+   m_flippedTiles = 0;
+   m_usedBytes = 0;
+}
+
+void CTilificator::addBank(QList<IChrRomBankItem*> items,bool tilify,bool shareFlips)
+{
+   m_bankItems.append(items);
+   m_tilify.append(tilify);
+   m_shareFlips.append(tilify&&shareFlips);
+}
+
+void CTilificator::flip(const char* tile,int flips,char* flipped)
+{
+   int row;
+   int fromRow;
+
+   // A tile is two planes of eight rows; flipping it vertically reverses
+   // the rows of each plane, horizontally the bits of each row.
+   for ( row = 0; row < 8; row++ )
+   {
+      fromRow = (flips&TILE_FLIP_V)?(7-row):row;
+      if ( flips&TILE_FLIP_H )
+      {
+         flipped[row] = reversedBits[(unsigned char)tile[fromRow]];
+         flipped[row+8] = reversedBits[(unsigned char)tile[fromRow+8]];
+      }
+      else
+      {
+         flipped[row] = tile[fromRow];
+         flipped[row+8] = tile[fromRow+8];
+      }
+   }
+}
+
+void CTilificator::place(const char* tile, int slot)
+{
+   QByteArray tileData(tile,TILE_SIZE);
+
+   memcpy(m_output.data()+(slot*TILE_SIZE),tile,TILE_SIZE);
+   m_slotUsed[slot] = true;
+
+   // The first copy placed is the one duplicates are drawn from.
+   if ( !m_placedTiles.contains(tileData) )
+   {
+      m_placedTiles.insert(tileData,slot);
+   }
+
+   if ( (slot+1)*TILE_SIZE > m_usedBytes )
+   {
+      m_usedBytes = (slot+1)*TILE_SIZE;
+   }
+}
+
+int CTilificator::freeSlot(int bank)
+{
+   int slot;
+
+   // Free slots are only ever taken, so each bank keeps a cursor to the
+   // first one it might still have.
+   for ( ; bank < m_nextFreeSlot.count(); bank++ )
+   {
+      for ( slot = m_nextFreeSlot.at(bank); slot < (bank+1)*m_tilesPerBank; slot++ )
+      {
+         if ( !m_slotUsed.at(slot) )
+         {
+            m_nextFreeSlot[bank] = slot+1;
+            return slot;
+         }
+      }
+      m_nextFreeSlot[bank] = slot;
+   }
+
+   // Every bank is full, add another.
+   m_output.append(QByteArray(m_bankSize,0));
+   m_slotUsed.resize(m_slotUsed.count()+m_tilesPerBank);
+   m_nextFreeSlot.append((bank*m_tilesPerBank)+1);
+
+   return bank*m_tilesPerBank;
+}
+
+QByteArray CTilificator::tilify()
+{
+   // The tiles that may move, the bank and number they came from.
+   QList<QByteArray> movableTiles;
+   QList<int> movableTileBanks;
+   QList<int> movableTileNumbers;
+   QByteArray itemData;
+   char tile[TILE_SIZE];
+   char flipped[TILE_SIZE];
+   const int flipsToTry[3] = { TILE_FLIP_H, TILE_FLIP_V, TILE_FLIP_H|TILE_FLIP_V };
+   int flips;
+   int bank;
+   int item;
+   int offset;
+   int slot;
+   int idx;
+
+   m_output = QByteArray(m_bankItems.count()*m_bankSize,0);
+   m_slotUsed = QVector<bool>(m_bankItems.count()*m_tilesPerBank,false);
+   m_nextFreeSlot.clear();
+   m_placedTiles.clear();
+   m_remapSlot.clear();
+   m_remapFlips.clear();
+   m_tiles = 0;
+   m_lockedTiles = 0;
+   m_duplicateTiles = 0;
+   m_sharedFlippedTiles = 0;
+   m_flippedTiles = 0;
+   m_usedBytes = 0;
+
+   // Locked tiles go in first, where they'd be without tilification.
+   for ( bank = 0; bank < m_bankItems.count(); bank++ )
+   {
+      m_nextFreeSlot.append(bank*m_tilesPerBank);
+      m_remapSlot.append(QVector<int>());
+      m_remapFlips.append(QVector<int>());
+
+      offset = 0;
+      for ( item = 0; item < m_bankItems.at(bank).count(); item++ )
+      {
+         IChrRomBankItem* bankItem = m_bankItems.at(bank).at(item);
+         bool locked = (!m_tilify.at(bank)) || (bankItem->getItemType() != "Tile");
+
+         itemData = bankItem->getChrRomBankItemData();
+
+         // A partial tile at the end of an item is padded out.
+         for ( idx = 0; idx < itemData.count(); idx += TILE_SIZE, offset += TILE_SIZE )
+         {
+            memset(tile,0,TILE_SIZE);
+            memcpy(tile,itemData.constData()+idx,qMin(TILE_SIZE,itemData.count()-idx));
+            m_tiles++;
+
+            m_remapSlot[bank].append(-1);
+            m_remapFlips[bank].append(0);
+
+            // Locked tiles that run off the end of their bank can't stay
+            // where they are, so they're placed like any other.
+            if ( locked && (offset < m_bankSize) )
+            {
+               slot = (bank*m_tilesPerBank)+(offset/TILE_SIZE);
+               place(tile,slot);
+               m_remapSlot[bank][offset/TILE_SIZE] = slot;
+               m_lockedTiles++;
+            }
+            else
+            {
+               movableTiles.append(QByteArray(tile,TILE_SIZE));
+               movableTileBanks.append(bank);
+               movableTileNumbers.append(offset/TILE_SIZE);
+            }
+         }
+      }
+   }
+
+   // Then one copy of each of the rest, in the order they were added.
+   for ( idx = 0; idx < movableTiles.count(); idx++ )
+   {
+      const QByteArray& tileData = movableTiles.at(idx);
+
+      bank = movableTileBanks.at(idx);
+
+      // Only tilified banks share tiles.
+      if ( m_tilify.at(bank) && m_placedTiles.contains(tileData) )
+      {
+         m_remapSlot[bank][movableTileNumbers.at(idx)] = m_placedTiles.value(tileData);
+         m_duplicateTiles++;
+         continue;
+      }
+
+      // A tile that is a flipped copy of a placed one is that tile drawn
+      // with the same flips, since flips undo themselves.
+      slot = -1;
+      for ( flips = 0; (slot < 0) && (flips < 3); flips++ )
+      {
+         flip(tileData.constData(),flipsToTry[flips],flipped);
+         slot = m_placedTiles.value(QByteArray(flipped,TILE_SIZE),-1);
+      }
+      if ( slot >= 0 )
+      {
+         if ( m_shareFlips.at(bank) )
+         {
+            m_remapSlot[bank][movableTileNumbers.at(idx)] = slot;
+            m_remapFlips[bank][movableTileNumbers.at(idx)] = flipsToTry[flips-1];
+            m_sharedFlippedTiles++;
+            continue;
+         }
+         m_flippedTiles++;
+      }
+
+      slot = freeSlot(bank);
+      place(tileData.constData(),slot);
+      m_remapSlot[bank][movableTileNumbers.at(idx)] = slot;
+   }
+
+   return m_output;
+}
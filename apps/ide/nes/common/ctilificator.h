@@ -0,0 +1,88 @@
+#ifndef CTILIFICATOR_H
+#define CTILIFICATOR_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+#include "ichrrombankitem.h"
+
+// Sprite attribute bits that draw a tile flipped.
+#define TILE_FLIP_H 0x40
+#define TILE_FLIP_V 0x80
+
+// Lays graphics bank items out into CHR banks.
+//
+// A bank's items are laid end to end, as they'd be without tilification,
+// unless the bank opts in to it.  In a bank that does, tiles from items
+// that aren't tile stamps, binary CHR files for instance, are still
+// locked: code refers to them by their position, so they stay at the
+// offset in their bank they'd have if the bank's items were simply laid
+// end to end.  Tile stamps are free to move.  Each is looked up by its
+// content in a hash of every tile placed so far, in any bank, and only
+// placed if it isn't there already, in the first free slot of its own bank
+// or failing that of the banks after it, adding banks when they're all full.
+//
+// A bank of sprites can also opt in to sharing flipped tiles.  A tile of
+// its tile stamps that is a flipped copy of a tile already placed isn't
+// placed; sprites draw it from the placed tile with the flip bits the
+// remap gives.  In other banks flipped copies are only counted.
+//
+// Since tiles of tilified banks move, the remap tells where each of them
+// went, by the number it had when the bank's items were laid end to end.
+class CTilificator
+{
+public:
+   CTilificator(int bankSize);
+
+   void clear();
+   void addBank(QList<IChrRomBankItem*> items,bool tilify = false,bool shareFlips = false);
+
+   // Returns the CHR data, a whole number of banks long.
+   QByteArray tilify();
+
+   int bankSize() const { return m_bankSize; }
+   int banks() const { return m_output.count()/m_bankSize; }
+   int tiles() const { return m_tiles; }
+   int lockedTiles() const { return m_lockedTiles; }
+   int duplicateTiles() const { return m_duplicateTiles; }
+   int sharedFlippedTiles() const { return m_sharedFlippedTiles; }
+   int flippedTiles() const { return m_flippedTiles; }
+   int usedBytes() const { return m_usedBytes; }
+
+   // The remap of the tiles of bank bank.  remappedSlot is the slot
+   // [bank*tiles per bank+tile] of the output tile oldTile ended up in and
+   // remappedFlips the TILE_FLIP_ bits that draw it from there.
+   bool tilified(int bank) const { return m_tilify.at(bank); }
+   int remappedTiles(int bank) const { return m_remapSlot.at(bank).count(); }
+   int remappedSlot(int bank,int oldTile) const { return m_remapSlot.at(bank).at(oldTile); }
+   int remappedFlips(int bank,int oldTile) const { return m_remapFlips.at(bank).at(oldTile); }
+
+private:
+   void flip(const char* tile,int flips,char* flipped);
+   void place(const char* tile,int slot);
+   int freeSlot(int bank);
+
+   int m_bankSize;
+   int m_tilesPerBank;
+   QList<QList<IChrRomBankItem*> > m_bankItems;
+   QList<bool> m_tilify;
+   QList<bool> m_shareFlips;
+
+   QByteArray m_output;
+   QVector<bool> m_slotUsed;
+   QVector<int> m_nextFreeSlot;
+   QHash<QByteArray,int> m_placedTiles;
+   QList<QVector<int> > m_remapSlot;
+   QList<QVector<int> > m_remapFlips;
+
+   int m_tiles;
+   int m_lockedTiles;
+   int m_duplicateTiles;
+   int m_sharedFlippedTiles;
+   int m_flippedTiles;
+   int m_usedBytes;
+};
+
+#endif // CTILIFICATOR_H
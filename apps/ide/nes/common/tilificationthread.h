@@ -18,12 +18,14 @@ signals:
    void tilificationComplete(QByteArray output);
 
 public slots:
-   void prepareToTilify();
+   void prepareToTilify(bool tilify,bool shareFlips);
    void addToTilificator(IChrRomBankItem* item);
    void tilify();
 
 private:
    QList<IChrRomBankItem*> m_input;
+   bool m_tilify;
+   bool m_shareFlips;
    QByteArray m_output;
 };
 
@@ -1,7 +1,10 @@
 #include "ccartridgebuilder.h"
 
+#include <QCryptographicHash>
+
 #include "ccc65interface.h"
 #include "cnesicideproject.h"
+#include "compilerthread.h"
 #include "main.h"
 
 CCartridgeBuilder::CCartridgeBuilder()
@@ -44,6 +47,7 @@ bool CCartridgeBuilder::build()
    QFile prgFile;
    QFile chrFile;
    QFile nesFile;
+   QByteArray inputHash;
    bool ok;
 
    if ( nesicideProject->getProjectLinkerOutputName().isEmpty() )
@@ -86,19 +90,18 @@ bool CCartridgeBuilder::build()
    {
       if ( !nesicideProject->getLinkerConfigFile().isEmpty() )
       {
+         // The CHR-ROM goes first, the code may .incbin it.
          ok = graphicsAssembler.assemble();
-         if ( ok )
+         if ( !ok )
          {
-            ok = sourceAssembler.assemble();
-            if ( !ok )
-            {
-               buildTextLogger->write("<font color='red'><b>Build failed while processing Source.</b></font>");
-               return false;
-            }
+            buildTextLogger->write("<font color='red'><b>Build failed while processing Graphics Banks.</b></font>");
+            return false;
          }
-         else
+
+         ok = sourceAssembler.assemble();
+         if ( !ok )
          {
-            buildTextLogger->write("<font color='red'><b>Build failed while processing Graphics Banks.</b></font>");
+            buildTextLogger->write("<font color='red'><b>Build failed while processing Source.</b></font>");
             return false;
          }
 
@@ -107,34 +110,45 @@ bool CCartridgeBuilder::build()
          {
             chrFile.open(QIODevice::ReadOnly);
          }
-         nesFile.open(QIODevice::ReadWrite|QIODevice::Truncate);
 
          if ( prgFile.isOpen() &&
               (((gfxBanks->getGraphicsBanks().count()) && (chrFile.isOpen())) ||
-              (!(gfxBanks->getGraphicsBanks().count()))) &&
-              nesFile.isOpen() )
+              (!(gfxBanks->getGraphicsBanks().count()))) )
          {
-            QByteArray prgBytes = prgFile.readAll();
-            QByteArray chrBytes;
+            QByteArray nesBytes = prgFile.readAll();
 
-            if ( gfxBanks->getGraphicsBanks().count() )
+            if ( (nesicideProject->getProjectUsesCHRROM()) &&
+                 (gfxBanks->getGraphicsBanks().count()) )
             {
-               chrBytes = chrFile.readAll();
+               nesBytes += chrFile.readAll();
             }
 
-            nesFile.write(prgBytes);
+            prgFile.close();
+            chrFile.close();
 
-            if ( (nesicideProject->getProjectUsesCHRROM()) &&
-                 (gfxBanks->getGraphicsBanks().count()) )
+            // Leave the NES ROM alone if neither the PRG-ROM nor CHR-ROM
+            // changed, so the ROM isn't considered stale for nothing.
+            inputHash = QCryptographicHash::hash(nesBytes,QCryptographicHash::Sha1);
+            if ( CompilerThread::upToDate(nesName,inputHash) )
             {
-               nesFile.write(chrBytes);
+               buildTextLogger->write("<b>Up to date: "+nesName+"</b>");
             }
+            else
+            {
+               nesFile.open(QIODevice::ReadWrite|QIODevice::Truncate);
+               if ( !nesFile.isOpen() )
+               {
+                  buildTextLogger->write("<font color='red'><b>Build failed.</b></font>");
+                  return false;
+               }
 
-            buildTextLogger->write("<b>Writing: "+nesName+"</b>");
+               nesFile.write(nesBytes);
+               nesFile.close();
 
-            prgFile.close();
-            chrFile.close();
-            nesFile.close();
+               CompilerThread::madeFrom(nesName,inputHash);
+
+               buildTextLogger->write("<b>Writing: "+nesName+"</b>");
+            }
          }
          else
          {
@@ -1,10 +1,102 @@
 #include "cgraphicsassembler.h"
 #include "cnesicideproject.h"
+#include "ctilificator.h"
+#include "compilerthread.h"
+
+#include <QCryptographicHash>
+#include <QFileInfo>
 
 #include "main.h"
 
+// 8KB of empty space
 static const char emptyBank[MEM_8KB] = { 0, };
 
+// Writes data to a file unless the file already holds it, so anything that
+// depends on the file isn't rebuilt for nothing.
+static bool writeIfChanged(QString fileName,const QByteArray& data,bool* changed)
+{
+   QFile file(fileName);
+
+   *changed = true;
+   file.open(QIODevice::ReadOnly);
+   if ( file.isOpen() )
+   {
+      QByteArray oldHash = QCryptographicHash::hash(file.readAll(),QCryptographicHash::Sha1);
+
+      file.close();
+
+      if ( oldHash == QCryptographicHash::hash(data,QCryptographicHash::Sha1) )
+      {
+         *changed = false;
+         return true;
+      }
+   }
+
+   file.open(QIODevice::ReadWrite|QIODevice::Truncate);
+   if ( file.isOpen() )
+   {
+      file.write(data);
+      file.close();
+      return true;
+   }
+   return false;
+}
+
+// Makes a graphics bank name usable in an assembler symbol.
+static QString symbolName(QString name)
+{
+   int idx;
+
+   for ( idx = 0; idx < name.length(); idx++ )
+   {
+      if ( !name.at(idx).isLetterOrNumber() || (name.at(idx).unicode() > 0x7F) )
+      {
+         name[idx] = '_';
+      }
+   }
+   return name.toUpper();
+}
+
+// Generates the include that tells code where the tiles of the tilified
+// banks went.  For tile n of bank NAME, counted as if the bank's items
+// were laid end to end, CHR_NAME_n is the tile number to use now,
+// CHR_NAME_n_BANK the 8KB CHR bank it's in and CHR_NAME_n_FLIP the sprite
+// attribute flip bits to draw it with.
+static QByteArray remapInclude(CGraphicsBanks* gfxBanks,const CTilificator& tilificator)
+{
+   QByteArray include;
+   int tilesPerBank = tilificator.bankSize()/16;
+   int bank;
+   int tile;
+
+   include += "; Generated by NESICIDE from the project's graphics banks, do not edit.\n";
+   include += "; CHR_<bank>_<tile> is where tile <tile> of a tilified bank went:\n";
+   include += "; its tile number, _BANK its 8KB CHR bank, _FLIP its sprite flip bits.\n";
+
+   for ( bank = 0; bank < gfxBanks->getGraphicsBanks().count(); bank++ )
+   {
+      if ( !tilificator.tilified(bank) )
+      {
+         continue;
+      }
+
+      QByteArray name = "CHR_"+symbolName(gfxBanks->getGraphicsBanks().at(bank)->caption()).toLatin1();
+
+      include += "\n; "+gfxBanks->getGraphicsBanks().at(bank)->caption().toLatin1()+"\n";
+      for ( tile = 0; tile < tilificator.remappedTiles(bank); tile++ )
+      {
+         int slot = tilificator.remappedSlot(bank,tile);
+         QByteArray symbol = name+"_"+QByteArray::number(tile);
+
+         include += symbol+" = $"+QByteArray::number(slot%tilesPerBank,16).rightJustified(2,'0').toUpper()+"\n";
+         include += symbol+"_BANK = "+QByteArray::number(slot/tilesPerBank)+"\n";
+         include += symbol+"_FLIP = $"+QByteArray::number(tilificator.remappedFlips(bank,tile),16).rightJustified(2,'0').toUpper()+"\n";
+      }
+   }
+
+   return include;
+}
+
 CGraphicsAssembler::CGraphicsAssembler()
 {
 }
@@ -38,37 +130,108 @@ bool CGraphicsAssembler::assemble()
 
    if ( gfxBanks->getGraphicsBanks().count() )
    {
-      buildTextLogger->write("<b>Building: "+outputName+"</b>");
+      CTilificator tilificator(MEM_8KB);
+      QCryptographicHash inputHash(QCryptographicHash::Sha1);
+      QByteArray chrRomData;
+      QString includeName;
+      bool tilified = false;
+      bool changed;
 
-      chrRomFile.setFileName(outputName);
-      chrRomFile.open(QIODevice::ReadWrite|QIODevice::Truncate);
-      if ( chrRomFile.isOpen() )
+      // The CHR-ROM only needs to be made again if the graphics in the
+      // banks or how they're laid out changed.
+      for (int gfxBankIdx = 0; gfxBankIdx < gfxBanks->getGraphicsBanks().count(); gfxBankIdx++)
       {
-         for (int gfxBankIdx = 0; gfxBankIdx < gfxBanks->getGraphicsBanks().count(); gfxBankIdx++)
+         CGraphicsBank* curGfxBank = gfxBanks->getGraphicsBanks().at(gfxBankIdx);
+
+         tilified |= curGfxBank->getTilify();
+
+         inputHash.addData(QByteArray::number(curGfxBank->getGraphics().count())+";");
+         inputHash.addData(QByteArray::number((int)curGfxBank->getTilify())+QByteArray::number((int)curGfxBank->getShareFlips())+";");
+         if ( curGfxBank->getTilify() )
+         {
+            inputHash.addData(curGfxBank->caption().toUtf8()+";");
+         }
+         for (int bankItemIdx = 0; bankItemIdx < curGfxBank->getGraphics().count(); bankItemIdx++)
          {
-            CGraphicsBank* curGfxBank = gfxBanks->getGraphicsBanks().at(gfxBankIdx);
+            IChrRomBankItem* bankItem = curGfxBank->getGraphics().at(bankItemIdx);
+
+            inputHash.addData(QByteArray::number(bankItem->getChrRomBankItemSize())+";");
+            inputHash.addData(bankItem->getChrRomBankItemData().data(),bankItem->getChrRomBankItemSize());
+         }
+      }
+      if ( CompilerThread::upToDate(outputName,inputHash.result()) )
+      {
+         buildTextLogger->write("<b>Up to date: "+outputName+"</b>");
+         return true;
+      }
+
+      buildTextLogger->write("<b>Building: "+outputName+"</b>");
+
+      for (int gfxBankIdx = 0; gfxBankIdx < gfxBanks->getGraphicsBanks().count(); gfxBankIdx++)
+      {
+         CGraphicsBank* curGfxBank = gfxBanks->getGraphicsBanks().at(gfxBankIdx);
 
-            buildTextLogger->write("Constructing '" + curGfxBank->caption() + "':");
+         buildTextLogger->write("Constructing '" + curGfxBank->caption() + "':");
 
-            if ( curGfxBank->getGraphics().count() )
+         if ( curGfxBank->getGraphics().count() )
+         {
+            for (int bankItemIdx = 0; bankItemIdx < curGfxBank->getGraphics().count(); bankItemIdx++)
             {
-               for (int bankItemIdx = 0; bankItemIdx < curGfxBank->getGraphics().count(); bankItemIdx++)
-               {
-                  IChrRomBankItem* bankItem = curGfxBank->getGraphics().at(bankItemIdx);
-                  IProjectTreeViewItem* ptvi = dynamic_cast<IProjectTreeViewItem*>(bankItem);
-                  buildTextLogger->write("&nbsp;&nbsp;&nbsp;Adding: "+ptvi->caption()+"("+QString::number(bankItem->getChrRomBankItemSize())+" bytes)");
+               IChrRomBankItem* bankItem = curGfxBank->getGraphics().at(bankItemIdx);
+               IProjectTreeViewItem* ptvi = dynamic_cast<IProjectTreeViewItem*>(bankItem);
+               buildTextLogger->write("&nbsp;&nbsp;&nbsp;Adding: "+ptvi->caption()+"("+QString::number(bankItem->getChrRomBankItemSize())+" bytes)");
 
-                  chrRomFile.write(bankItem->getChrRomBankItemData().data(), bankItem->getChrRomBankItemSize());
+               // Without tilification the banks' items are laid end to end.
+               if ( !tilified )
+               {
+                  chrRomData.append(bankItem->getChrRomBankItemData().data(),bankItem->getChrRomBankItemSize());
                }
             }
-            else
-            {
-               // 8KB of empty space
-               chrRomFile.write(emptyBank,MEM_8KB);
-            }
+         }
+         else if ( !tilified )
+         {
+            chrRomData.append(emptyBank,MEM_8KB);
+         }
+
+         tilificator.addBank(curGfxBank->getGraphics(),curGfxBank->getTilify(),curGfxBank->getShareFlips());
+      }
+
+      if ( tilified )
+      {
+         chrRomData = tilificator.tilify();
+
+         buildTextLogger->write("Tilified "+QString::number(tilificator.tiles())+" tiles ("+
+                                QString::number(tilificator.lockedTiles())+" locked in place): "+
+                                QString::number(tilificator.duplicateTiles())+" duplicates and "+
+                                QString::number(tilificator.sharedFlippedTiles())+" flipped copies removed, saving "+
+                                QString::number((tilificator.duplicateTiles()+tilificator.sharedFlippedTiles())*16)+" bytes.");
+         if ( tilificator.flippedTiles() )
+         {
+            buildTextLogger->write(QString::number(tilificator.flippedTiles())+" more tiles are flipped copies of others that sprite banks could share.");
+         }
+         if ( tilificator.banks() > gfxBanks->getGraphicsBanks().count() )
+         {
+            buildTextLogger->write("Tiles didn't fit in the graphics banks, "+QString::number(tilificator.banks()-gfxBanks->getGraphicsBanks().count())+" more 8KB banks were added.");
+         }
+
+         // Code finds the tiles that moved through the generated include.
+         includeName = QFileInfo(outputName).path()+"/"+QFileInfo(outputName).completeBaseName()+".inc";
+         if ( !writeIfChanged(includeName,remapInclude(gfxBanks,tilificator),&changed) )
+         {
+            buildTextLogger->write("<font color='red'>Error: could not write "+includeName+"</font>");
+            return false;
+         }
+         buildTextLogger->write((changed?"Tile remap written to ":"Tile remap unchanged: ")+includeName);
+      }
+
+      if ( writeIfChanged(outputName,chrRomData,&changed) )
+      {
+         if ( !changed )
+         {
+            buildTextLogger->write("CHR-ROM unchanged, not rewritten.");
          }
 
-         chrRomFile.close();
+         CompilerThread::madeFrom(outputName,inputHash.result());
 
          return true;
       }
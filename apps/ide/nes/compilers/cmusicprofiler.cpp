@@ -0,0 +1,286 @@
+#include "cmusicprofiler.h"
+
+#include "FamiTrackerDoc.h"
+
+#include "nes_emulator_core.h"
+
+#include <QSet>
+
+#include <string.h>
+
+#include <algorithm>
+
+// Songs that never loop or halt are profiled for at most this long.
+#define MAX_PROFILE_SECONDS 600
+
+CMusicProfiler::CMusicProfiler(CFamiTrackerDoc* pDoc,QByteArray nsfData,uint32_t cycleBudget,QObject* parent) :
+   QThread(parent)
+{
+   unsigned int track;
+
+   m_nsfData = nsfData;
+   m_cycleBudget = cycleBudget;
+
+   // The document belongs to the UI thread so everything the profiler
+   // needs from it is gathered up front.
+   for ( track = 0; track < pDoc->GetTrackCount(); track++ )
+   {
+      Timeline timeline;
+      buildTimeline(pDoc,track,timeline);
+      m_timelines.append(timeline);
+   }
+}
+
+void CMusicProfiler::buildTimeline(CFamiTrackerDoc* pDoc,int track,Timeline& timeline)
+{
+   QSet<int> visited;
+   stChanNote note;
+   int frameRate = pDoc->GetFrameRate();
+   int splitPoint = pDoc->GetSpeedSplitPoint();
+   int frames = pDoc->GetFrameCount(track);
+   int length = pDoc->GetPatternLength(track);
+   int channels = pDoc->GetChannelCount();
+   int speed = pDoc->GetSongSpeed(track);
+   int tempo = pDoc->GetSongTempo(track);
+   int decrement = (tempo*24)/speed;
+   int accum = 0;
+   int frame = 0;
+   int row = 0;
+   int jumpTo;
+   int skipTo;
+   bool halted = false;
+   int channel;
+   int column;
+   unsigned char param;
+
+   timeline.title = pDoc->GetTrackTitle(track);
+
+   // Follow the driver's tempo accumulator: a new row is read on every
+   // tick on which the accumulator has run out.
+   while ( timeline.tickRow.count() < frameRate*MAX_PROFILE_SECONDS )
+   {
+      if ( accum <= 0 )
+      {
+         if ( halted || visited.contains((frame<<8)|row) )
+         {
+            // The song has stopped or looped.
+            break;
+         }
+         visited.insert((frame<<8)|row);
+
+         accum += 60*frameRate;
+         timeline.rows.append(QPair<int,int>(frame,row));
+
+         jumpTo = -1;
+         skipTo = -1;
+         for ( channel = 0; channel < channels; channel++ )
+         {
+            pDoc->GetDataAtPattern(track,pDoc->GetPatternAtFrame(track,frame,channel),channel,row,&note);
+            for ( column = 0; column < (int)pDoc->GetEffColumns(track,channel)+1; column++ )
+            {
+               param = note.EffParam[column];
+               switch ( note.EffNumber[column] )
+               {
+                  case EF_SPEED:
+                     if ( !param )
+                     {
+                        param++;
+                     }
+                     if ( param >= splitPoint )
+                     {
+                        tempo = param;
+                     }
+                     else
+                     {
+                        speed = param;
+                     }
+                     decrement = (tempo*24)/speed;
+                     break;
+                  case EF_JUMP:
+                     jumpTo = param;
+                     break;
+                  case EF_SKIP:
+                     skipTo = param;
+                     break;
+                  case EF_HALT:
+                     halted = true;
+                     break;
+               }
+            }
+         }
+
+         // Move on to the row played next.
+         if ( jumpTo != -1 )
+         {
+            frame = std::min(jumpTo,frames-1);
+            row = 0;
+         }
+         else if ( skipTo != -1 )
+         {
+            frame = (frame+1)%frames;
+            row = std::min(skipTo,length-1);
+         }
+         else if ( ++row >= length )
+         {
+            frame = (frame+1)%frames;
+            row = 0;
+         }
+      }
+
+      timeline.tickRow.append(timeline.rows.count()-1);
+      accum -= decrement;
+   }
+}
+
+void CMusicProfiler::computeStats(QVector<uint32_t> samples,MusicProfileStats& stats)
+{
+   double total = 0.0;
+   int idx;
+
+   memset(&stats,0,sizeof(stats));
+   if ( samples.isEmpty() )
+   {
+      return;
+   }
+
+   std::sort(samples.begin(),samples.end());
+   for ( idx = 0; idx < samples.count(); idx++ )
+   {
+      total += samples.at(idx);
+   }
+
+   stats.min = samples.first();
+   stats.max = samples.last();
+   stats.avg = total/samples.count();
+   stats.p50 = samples.at(((samples.count()-1)*50)/100);
+   stats.p90 = samples.at(((samples.count()-1)*90)/100);
+   stats.p99 = samples.at(((samples.count()-1)*99)/100);
+}
+
+void CMusicProfiler::run()
+{
+   emit profilingComplete(profile());
+}
+
+bool CMusicProfiler::profile()
+{
+   QVector<uint32_t> tickCycles;
+   QVector<uint32_t> rowCycles;
+   uint32_t calls;
+   uint32_t tick;
+   int track;
+   int idx;
+
+   m_results.clear();
+
+   if ( !nesLoadNSF((uint8_t*)m_nsfData.data(),m_nsfData.size()) )
+   {
+      return false;
+   }
+
+   for ( track = 0; track < m_timelines.count(); track++ )
+   {
+      const Timeline& timeline = m_timelines.at(track);
+      MusicProfileTrack result;
+
+      tickCycles.resize(timeline.tickRow.count());
+      calls = nesProfileNSFSong(track,tickCycles.data(),tickCycles.count());
+      tickCycles.resize(calls);
+
+      result.track = track;
+      result.title = timeline.title;
+      result.ticks = calls;
+      result.rowsOverBudget = 0;
+      computeStats(tickCycles,result.tickStats);
+
+      for ( idx = 0; idx < timeline.rows.count(); idx++ )
+      {
+         MusicProfileRow row;
+         row.frame = timeline.rows.at(idx).first;
+         row.row = timeline.rows.at(idx).second;
+         row.totalCycles = 0;
+         row.peakCycles = 0;
+         row.overBudget = false;
+         result.rows.append(row);
+      }
+      for ( tick = 0; tick < calls; tick++ )
+      {
+         MusicProfileRow& row = result.rows[timeline.tickRow.at(tick)];
+         row.totalCycles += tickCycles.at(tick);
+         row.peakCycles = std::max(row.peakCycles,tickCycles.at(tick));
+      }
+
+      rowCycles.clear();
+      for ( idx = 0; idx < result.rows.count(); idx++ )
+      {
+         MusicProfileRow& row = result.rows[idx];
+
+         // A row is only as good as its worst tick; that is what has to
+         // fit in the game's frame.
+         if ( m_cycleBudget && (row.peakCycles > m_cycleBudget) )
+         {
+            row.overBudget = true;
+            result.rowsOverBudget++;
+         }
+         rowCycles.append(row.totalCycles);
+      }
+      computeStats(rowCycles,result.rowStats);
+
+      m_results.append(result);
+      emit trackProfiled(track);
+   }
+
+   return true;
+}
+
+QString CMusicProfiler::report() const
+{
+   QString str;
+   int track;
+   int idx;
+
+   for ( track = 0; track < m_results.count(); track++ )
+   {
+      const MusicProfileTrack& result = m_results.at(track);
+
+      str += QString("Track %1 \"%2\": %3 ticks, %4 rows\n")
+             .arg(result.track+1)
+             .arg(result.title)
+             .arg(result.ticks)
+             .arg(result.rows.count());
+      str += QString("   cycles/tick: min %1 avg %2 max %3 p50 %4 p90 %5 p99 %6\n")
+             .arg(result.tickStats.min)
+             .arg(result.tickStats.avg,0,'f',1)
+             .arg(result.tickStats.max)
+             .arg(result.tickStats.p50)
+             .arg(result.tickStats.p90)
+             .arg(result.tickStats.p99);
+      str += QString("   cycles/row:  min %1 avg %2 max %3 p50 %4 p90 %5 p99 %6\n")
+             .arg(result.rowStats.min)
+             .arg(result.rowStats.avg,0,'f',1)
+             .arg(result.rowStats.max)
+             .arg(result.rowStats.p50)
+             .arg(result.rowStats.p90)
+             .arg(result.rowStats.p99);
+
+      if ( m_cycleBudget )
+      {
+         str += QString("   %1 rows over the budget of %2 cycles\n")
+                .arg(result.rowsOverBudget)
+                .arg(m_cycleBudget);
+         for ( idx = 0; idx < result.rows.count(); idx++ )
+         {
+            const MusicProfileRow& row = result.rows.at(idx);
+            if ( row.overBudget )
+            {
+               str += QString("      frame %1 row %2: %3 cycles\n")
+                      .arg(row.frame,2,16,QChar('0'))
+                      .arg(row.row,2,16,QChar('0'))
+                      .arg(row.peakCycles);
+            }
+         }
+      }
+   }
+
+   return str;
+}
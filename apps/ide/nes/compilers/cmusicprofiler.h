@@ -0,0 +1,95 @@
+#ifndef CMUSICPROFILER_H
+#define CMUSICPROFILER_H
+
+#include <QThread>
+#include <QByteArray>
+#include <QVector>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+#include <stdint.h>
+
+class CFamiTrackerDoc;
+
+// CPU cycle statistics over a set of samples.
+struct MusicProfileStats
+{
+   uint32_t min;
+   uint32_t max;
+   double   avg;
+   uint32_t p50;
+   uint32_t p90;
+   uint32_t p99;
+};
+
+// A row of a track as the driver plays it.  A row is played for as many
+// ticks [calls to the driver's play routine] as the speed and tempo say.
+struct MusicProfileRow
+{
+   int      frame;
+   int      row;
+   uint32_t totalCycles;
+   uint32_t peakCycles;
+   bool     overBudget;
+};
+
+struct MusicProfileTrack
+{
+   int                     track;
+   QString                 title;
+   int                     ticks;
+   MusicProfileStats       tickStats;
+   MusicProfileStats       rowStats;
+   QList<MusicProfileRow>  rows;
+   int                     rowsOverBudget;
+};
+
+// Runs a FamiTracker module's exported NSF through the emulator core and
+// measures how many CPU cycles the driver's play routine takes on every
+// tick of every track.  The row each tick belongs to is worked out from
+// the module by following its speed, tempo and Bxx/Cxx/Dxx effects the way
+// the driver does, so that expensive rows can be pointed at in the editor.
+//
+// The emulator core is a single machine, so the profiler must not be
+// started while the emulator is running and profiles tracks one at a
+// time.  The timelines are worked out from the document when the profiler
+// is made; start() then profiles on the profiler's own thread, touching
+// neither the document nor the UI.
+class CMusicProfiler : public QThread
+{
+   Q_OBJECT
+public:
+   CMusicProfiler(CFamiTrackerDoc* pDoc,QByteArray nsfData,uint32_t cycleBudget,QObject* parent = 0);
+
+   int trackCount() const { return m_timelines.count(); }
+   const QList<MusicProfileTrack>& results() const { return m_results; }
+   QString report() const;
+
+signals:
+   void trackProfiled(int track);
+   void profilingComplete(bool ok);
+
+protected:
+   void run();
+
+private:
+   struct Timeline
+   {
+      QString           title;
+      QList<QPair<int,int> > rows;
+      QVector<int>      tickRow;
+   };
+
+   // Returns false if the NSF couldn't be loaded.
+   bool profile();
+   void buildTimeline(CFamiTrackerDoc* pDoc,int track,Timeline& timeline);
+   static void computeStats(QVector<uint32_t> samples,MusicProfileStats& stats);
+
+   QByteArray               m_nsfData;
+   uint32_t                 m_cycleBudget;
+   QList<Timeline>          m_timelines;
+   QList<MusicProfileTrack> m_results;
+};
+
+#endif // CMUSICPROFILER_H
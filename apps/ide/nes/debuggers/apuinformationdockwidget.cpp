@@ -12,6 +12,9 @@ APUInformationDockWidget::APUInformationDockWidget(QWidget *parent) :
     ui(new Ui::APUInformationDockWidget)
 {
    ui->setupUi(this);
+
+   m_spectrum = new APUSpectrumWidget();
+   ui->tabWidget->addTab(m_spectrum,"Spectrum");
 }
 
 APUInformationDockWidget::~APUInformationDockWidget()
@@ -97,6 +100,12 @@ void APUInformationDockWidget::updateInformation()
    ui->sampleBufferContents5->setText ( buffer );
    ui->sampleBufferFull5->setChecked ( m_nesState.apu.dmcDmaFull );
 
+   // Only pay for the transforms while the spectrum is being looked at.
+   if ( ui->tabWidget->currentWidget() == m_spectrum )
+   {
+      m_spectrum->updateSamples();
+   }
+
    // Check breakpoints for hits and highlight if necessary...
    for ( idx = 0; idx < pBreakpoints->GetNumBreakpoints(); idx++ )
    {
@@ -3,6 +3,8 @@
 
 #include "cdebuggerbase.h"
 
+#include "apuspectrumwidget.h"
+
 namespace Ui {
    class APUInformationDockWidget;
 }
@@ -26,6 +28,7 @@ public slots:
 
 private:
    Ui::APUInformationDockWidget *ui;
+   APUSpectrumWidget* m_spectrum;
 };
 
 #endif // APUINFORMATIONDOCKWIDGET_H
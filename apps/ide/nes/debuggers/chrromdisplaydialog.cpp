@@ -4,6 +4,7 @@
 #include "ui_chrromdisplaydialog.h"
 #include "cnessystempalette.h"
 #include "dbg_cnesppu.h"
+#include "cimageconverters.h"
 
 #include "cobjectregistry.h"
 #include "main.h"
@@ -243,12 +244,14 @@ void CHRROMDisplayDialog::repaintNeeded()
 
 void CHRROMDisplayDialog::renderData()
 {
-   unsigned int ppuAddr = 0x0000;
-   unsigned char patternData1;
-   unsigned char patternData2;
-   unsigned char bit1, bit2;
-   unsigned char colorIdx;
-   QColor color[4];
+   uchar indexes[8*8];
+   int32_t color[4][3];
+   int idx;
+   int tile;
+   int x;
+   int y;
+   int xf;
+   int yf;
 
    if ( m_usePPU )
    {
@@ -256,33 +259,29 @@ void CHRROMDisplayDialog::renderData()
    }
    else
    {
-      color[0] = renderer->getColor(0);
-      color[1] = renderer->getColor(1);
-      color[2] = renderer->getColor(2);
-      color[3] = renderer->getColor(3);
-
-      for (int y = 0; y < 128; y++)
+      for ( idx = 0; idx < 4; idx++ )
       {
-         for (int x = 0; x < 256; x += 8)
-         {
-            ppuAddr = ((y>>3)<<8)+((x%128)<<1)+(y&0x7);
-
-            if ( x >= 128 )
-            {
-               ppuAddr += 0x1000;
-            }
+         color[idx][0] = renderer->getColor(idx).red();
+         color[idx][1] = renderer->getColor(idx).green();
+         color[idx][2] = renderer->getColor(idx).blue();
+      }
 
-            patternData1 = *(chrrom+ppuAddr);
-            patternData2 = *(chrrom+ppuAddr+8);
+      for ( tile = 0; tile < (MEM_8KB>>4); tile++ )
+      {
+         CImageConverters::decodeTile((const char*)chrrom+(tile<<4),indexes,8);
 
-            for ( int xf = 0; xf < 8; xf++ )
+         // Tiles are laid out 16 to a row, the second pattern table to the
+         // right of the first.
+         x = ((tile&0xF)<<3)+((tile&0x100)>>1);
+         y = ((tile>>4)&0xF)<<3;
+         for ( yf = 0; yf < 8; yf++ )
+         {
+            for ( xf = 0; xf < 8; xf++ )
             {
-               bit1 = (patternData1>>(7-(xf)))&0x1;
-               bit2 = (patternData2>>(7-(xf)))&0x1;
-               colorIdx = (bit1|(bit2<<1));
-               imgData[((y<<8)<<2) + (x<<2) + (xf<<2) + 0] = color[colorIdx].red();
-               imgData[((y<<8)<<2) + (x<<2) + (xf<<2) + 1] = color[colorIdx].green();
-               imgData[((y<<8)<<2) + (x<<2) + (xf<<2) + 2] = color[colorIdx].blue();
+               idx = indexes[(yf<<3)+xf];
+               imgData[(((y+yf)<<8)<<2) + ((x+xf)<<2) + 0] = color[idx][0];
+               imgData[(((y+yf)<<8)<<2) + ((x+xf)<<2) + 1] = color[idx][1];
+               imgData[(((y+yf)<<8)<<2) + ((x+xf)<<2) + 2] = color[idx][2];
             }
          }
       }
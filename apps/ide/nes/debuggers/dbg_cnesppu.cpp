@@ -36,6 +36,22 @@ bool CPPUDBG::m_bOAMViewerShowVisible = false;
 
 PpuStateSnapshot CPPUDBG::m_ppuState;
 
+bool     CPPUDBG::m_bCHRMEMRedraw = true;
+uint32_t CPPUDBG::m_chrMemDrawnStamp = 0;
+uint32_t CPPUDBG::m_chrMemDrawnBank [] = { 0, };
+bool     CPPUDBG::m_bOAMRedraw = true;
+uint32_t CPPUDBG::m_oamDrawnStamp = 0;
+uint32_t CPPUDBG::m_oamDrawnBank [] = { 0, };
+uint8_t  CPPUDBG::m_oamDrawnCtrl = 0;
+bool     CPPUDBG::m_bNameTableRedraw = true;
+uint32_t CPPUDBG::m_nameTableDrawnStamp = 0;
+uint32_t CPPUDBG::m_nameTableDrawnBank [] = { 0, };
+uint8_t  CPPUDBG::m_nameTableDrawnCtrl = 0;
+int8_t*  CPPUDBG::m_pNameTableOverlayTV = NULL;
+bool     CPPUDBG::m_bNameTableOverlayRedraw = true;
+uint16_t CPPUDBG::m_xScrollDrawn [SCANLINES_VISIBLE];
+uint16_t CPPUDBG::m_yScrollDrawn [SCANLINES_VISIBLE];
+
 CPPUDBG::CPPUDBG()
 {
 }
@@ -123,159 +139,241 @@ void CPPUDBG::RENDERCODEDATALOGGER ( void )
    }
 }
 
-void CPPUDBG::RENDERCHRMEM ( void )
+// The inspectors only take the parts of the PPU's state they draw from; the
+// pattern data comes decoded from the emulator's CHR tile cache instead.
+static void SNAPSHOTPPU ( PpuStateSnapshot* pSnapshot, bool nameTables, bool scroll )
 {
-   uint32_t ppuAddr = 0x0000;
-   uint8_t patternData1;
-   uint8_t patternData2;
-   uint8_t bit1, bit2;
-   uint8_t colorIdx;
-   int32_t color[4][3];
-   int8_t* pTV;
+   int32_t idx;
+
+   for ( idx = 0; idx < NUM_PPU_REGS; idx++ )
+   {
+      *(pSnapshot->reg+idx) = nesGetPPURegister(idx);
+   }
+   for ( idx = 0; idx < MEM_256B; idx++ )
+   {
+      *(pSnapshot->oamMemory+idx) = nesGetPPUOAM(idx);
+   }
+   for ( idx = 0; idx < MEM_32B; idx++ )
+   {
+      *(pSnapshot->paletteMemory+idx) = nesGetPPUPaletteData(idx);
+   }
+   if ( nameTables )
+   {
+      for ( idx = 0x2000; idx < 0x3000; idx++ )
+      {
+         *(pSnapshot->memory+idx) = nesGetPPUNameTableData(idx);
+      }
+   }
+   if ( scroll )
+   {
+      nesGetScanlineScroll(pSnapshot->xScroll,pSnapshot->yScroll);
+   }
+}
 
-   pTV = (int8_t*)m_pCHRMEMInspectorTV;
+// Looks up the RGB value of each palette entry once per refresh rather than
+// once per pixel.
+static void PALETTERGB ( uint8_t* paletteMemory, uint8_t rgb[MEM_32B][3] )
+{
+   int32_t idx;
 
-   nesGetPpuSnapshot(&m_ppuState);
+   for ( idx = 0; idx < MEM_32B; idx++ )
+   {
+      rgb[idx][0] = CBasePalette::GetPaletteR(paletteMemory[idx]);
+      rgb[idx][1] = CBasePalette::GetPaletteG(paletteMemory[idx]);
+      rgb[idx][2] = CBasePalette::GetPaletteB(paletteMemory[idx]);
+   }
+}
 
-   color[0][0] = m_chrMemColor[0].red();
-   color[0][1] = m_chrMemColor[0].green();
-   color[0][2] = m_chrMemColor[0].blue();
-   color[1][0] = m_chrMemColor[1].red();
-   color[1][1] = m_chrMemColor[1].green();
-   color[1][2] = m_chrMemColor[1].blue();
-   color[2][0] = m_chrMemColor[2].red();
-   color[2][1] = m_chrMemColor[2].green();
-   color[2][2] = m_chrMemColor[2].blue();
-   color[3][0] = m_chrMemColor[3].red();
-   color[3][1] = m_chrMemColor[3].green();
-   color[3][2] = m_chrMemColor[3].blue();
+// Write stamps wrap, so they're compared by difference.
+static inline bool WRITTENSINCE ( uint32_t stamp, uint32_t drawnStamp )
+{
+   return ((int32_t)(stamp-drawnStamp)) > 0;
+}
+
+// Returns a bit for each 1KB CHR bank a mapper has switched since the last
+// time, and remembers the new mapping.
+static uint8_t CHRBANKSWITCHED ( uint32_t* pDrawnBank )
+{
+   uint8_t switched = 0;
+   uint32_t absAddr;
+   int32_t bank;
 
-   for (int y = 0; y < 128; y++)
+   for ( bank = 0; bank < 8; bank++ )
    {
-      for (int x = 0; x < 256; x += 8)
+      absAddr = nesGetCHRMEMAbsoluteAddress(bank<<10);
+      if ( absAddr != *(pDrawnBank+bank) )
       {
-         ppuAddr = ((y>>3)<<8)+((x%128)<<1)+(y&0x7);
+         switched |= (1<<bank);
+         *(pDrawnBank+bank) = absAddr;
+      }
+   }
+   return switched;
+}
 
-         if ( x >= 128 )
-         {
-            ppuAddr += 0x1000;
-         }
+// Whether the CHR tile at a PPU address may look different since it was drawn.
+static inline bool CHRTILECHANGED ( uint32_t addr, uint32_t drawnStamp, uint8_t banksSwitched )
+{
+   return ((banksSwitched>>((addr&0x1FFF)>>10))&1) ||
+          WRITTENSINCE(nesGetCHRMEMWriteStamp(addr),drawnStamp);
+}
 
-         patternData1 = m_ppuState.memory[ppuAddr];
-         patternData2 = m_ppuState.memory[ppuAddr+8];
+// Draws one row of a decoded tile: eight pixels, each color index ORed
+// with attribData and looked up in rgb.
+static inline void DRAWTILEROW ( int8_t* pTV, const uint8_t* pRow, uint8_t attribData, uint8_t rgb[][3], bool flipHoriz )
+{
+   uint8_t colorIdx;
+   int32_t xf;
 
-         for ( int32_t xf = 0; xf < 8; xf++ )
-         {
-            bit1 = (patternData1>>(7-(xf)))&0x1;
-            bit2 = (patternData2>>(7-(xf)))&0x1;
-            colorIdx = (bit1|(bit2<<1));
-            *pTV = color[colorIdx][0];
-            *(pTV+1) = color[colorIdx][1];
-            *(pTV+2) = color[colorIdx][2];
-
-            pTV += 4;
-         }
+   for ( xf = 0; xf < PATTERN_SIZE; xf++ )
+   {
+      colorIdx = attribData|(*(pRow+(flipHoriz?(7-xf):xf)));
+      *pTV = rgb[colorIdx][0];
+      *(pTV+1) = rgb[colorIdx][1];
+      *(pTV+2) = rgb[colorIdx][2];
+
+      pTV += 4;
+   }
+}
+
+void CPPUDBG::RENDERCHRMEM ( void )
+{
+   uint8_t color[4][3];
+   uint32_t stamp;
+   uint8_t banksSwitched;
+   int32_t tile;
+   int32_t tileX, tileY;
+   int32_t idx;
+   int32_t y;
+
+   if ( !m_pCHRMEMInspectorTV )
+   {
+      return;
+   }
+
+   // Take the stamp first so writes made while drawing are seen next time.
+   stamp = nesGetPPUWriteStamp();
+   banksSwitched = CHRBANKSWITCHED(m_chrMemDrawnBank);
+
+   for ( idx = 0; idx < 4; idx++ )
+   {
+      color[idx][0] = m_chrMemColor[idx].red();
+      color[idx][1] = m_chrMemColor[idx].green();
+      color[idx][2] = m_chrMemColor[idx].blue();
+   }
+
+   for ( tile = 0; tile < 512; tile++ )
+   {
+      if ( (!m_bCHRMEMRedraw) &&
+           (!CHRTILECHANGED(tile<<4,m_chrMemDrawnStamp,banksSwitched)) )
+      {
+         continue;
+      }
+
+      // Tiles are laid out 16 to a row, the second pattern table to the
+      // right of the first.
+      tileX = ((tile&0xF)<<3)+((tile&0x100)>>1);
+      tileY = ((tile>>4)&0xF)<<3;
+
+      for ( y = 0; y < PATTERN_SIZE; y++ )
+      {
+         DRAWTILEROW(m_pCHRMEMInspectorTV+((((tileY+y)<<8)+tileX)<<2),
+                     nesGetCHRMEMTile(tile<<4)+(y<<3),0,color,false);
       }
    }
+
+   m_chrMemDrawnStamp = stamp;
+   m_bCHRMEMRedraw = false;
 }
 
 void CPPUDBG::RENDEROAM ( void )
 {
-   int32_t x, xf, y, yf;
-   uint16_t spritePatBase = 0x0000;
+   int32_t xf, y, yf;
+   uint16_t spritePatBase;
    uint8_t patternIdx;
    uint8_t spriteAttr;
    int32_t spriteSize;
    int32_t sprite;
-   uint8_t spriteFlipVert;
-   uint8_t spriteFlipHoriz;
-   uint8_t patternData1;
-   uint8_t patternData2;
-   uint8_t attribData;
-   uint8_t bit1, bit2;
-   uint8_t colorIdx;
+   int32_t spriteX;
+   int32_t spriteRow;
+   bool spriteFlipVert;
+   bool spriteFlipHoriz;
    uint8_t spriteY;
-   QColor color[4];
+   uint16_t patternAddr;
+   uint8_t rgb[MEM_32B][3];
+   uint32_t stamp;
+   uint8_t banksSwitched;
+   bool redraw;
    int8_t* pTV;
 
-   pTV = (int8_t*)m_pOAMInspectorTV;
-
-   nesGetPpuSnapshot(&m_ppuState);
+   if ( !m_pOAMInspectorTV )
+   {
+      return;
+   }
 
-   color[0] = CBasePalette::GetPalette ( 0x0D );
-   color[1] = CBasePalette::GetPalette ( 0x10 );
-   color[2] = CBasePalette::GetPalette ( 0x20 );
-   color[3] = CBasePalette::GetPalette ( 0x30 );
+   // Take the stamp first so writes made while drawing are seen next time.
+   stamp = nesGetPPUWriteStamp();
+   banksSwitched = CHRBANKSWITCHED(m_oamDrawnBank);
 
-   spriteSize = ((!!(m_ppuState.reg[PPUCTRL_REG]&PPUCTRL_SPRITE_SIZE))+1)<<3;
+   SNAPSHOTPPU(&m_ppuState,false,false);
+   PALETTERGB(m_ppuState.paletteMemory,rgb);
 
-   if ( spriteSize == 8 )
+   // A new palette or a different sprite size or pattern table changes
+   // every sprite.
+   if ( (WRITTENSINCE(nesGetPPUPaletteWriteStamp(),m_oamDrawnStamp)) ||
+        ((m_ppuState.reg[PPUCTRL_REG]&(PPUCTRL_SPRITE_SIZE|PPUCTRL_SPRITE_PAT_TBL_ADDR)) != m_oamDrawnCtrl) )
    {
-      spritePatBase = (!!(m_ppuState.reg[PPUCTRL_REG]&PPUCTRL_SPRITE_PAT_TBL_ADDR))<<12;
+      m_bOAMRedraw = true;
    }
+   m_oamDrawnCtrl = m_ppuState.reg[PPUCTRL_REG]&(PPUCTRL_SPRITE_SIZE|PPUCTRL_SPRITE_PAT_TBL_ADDR);
 
-   for ( y = 0; y < spriteSize<<1; y++ )
-   {
-      for ( x = 0; x < 256; x += PATTERN_SIZE ) // pattern-slice rendering...
-      {
-         sprite = (spriteSize==8)?((y>>3)<<5)+(x>>3):
-                  ((y>>4)<<5)+(x>>3);
-         spriteY = m_ppuState.oamMemory[(sprite<<2)+SPRITEY];
-
-         if ( ((m_bOAMViewerShowVisible) && ((spriteY+1) < SPRITE_YMAX)) ||
-               (!m_bOAMViewerShowVisible) )
-         {
-            patternIdx = m_ppuState.oamMemory[(sprite<<2)+SPRITEPAT];
+   spriteSize = ((!!(m_ppuState.reg[PPUCTRL_REG]&PPUCTRL_SPRITE_SIZE))+1)<<3;
 
-            if ( spriteSize == 16 )
-            {
-               spritePatBase = (patternIdx&0x01)<<12;
-               patternIdx &= 0xFE;
-            }
+   for ( sprite = 0; sprite < NUM_SPRITES; sprite++ )
+   {
+      patternIdx = m_ppuState.oamMemory[(sprite<<2)+SPRITEPAT];
 
-            spriteAttr = m_ppuState.oamMemory[(sprite<<2)+SPRITEATT];
-            spriteFlipVert = !!(spriteAttr&SPRITE_FLIP_VERT);
-            spriteFlipHoriz = !!(spriteAttr&SPRITE_FLIP_HORIZ);
-            attribData = (spriteAttr&SPRITE_PALETTE_IDX_MSK)<<2;
+      if ( spriteSize == 16 )
+      {
+         spritePatBase = (patternIdx&0x01)<<12;
+         patternIdx &= 0xFE;
+      }
+      else
+      {
+         spritePatBase = (!!(m_ppuState.reg[PPUCTRL_REG]&PPUCTRL_SPRITE_PAT_TBL_ADDR))<<12;
+      }
+      patternAddr = spritePatBase+(patternIdx<<4);
 
-            // For 8x16 sprites...
-            if ( (spriteSize == 16) &&
-                  (((!spriteFlipVert) && (((y>>3)&1))) ||
-                   ((spriteFlipVert) && (!((y>>3)&1)))) )
-            {
-               patternIdx++;
-            }
+      redraw = m_bOAMRedraw ||
+               WRITTENSINCE(nesGetPPUOAMWriteStamp(sprite),m_oamDrawnStamp) ||
+               CHRTILECHANGED(patternAddr,m_oamDrawnStamp,banksSwitched) ||
+               ((spriteSize == 16) && CHRTILECHANGED(patternAddr+(1<<4),m_oamDrawnStamp,banksSwitched));
+      if ( !redraw )
+      {
+         continue;
+      }
 
-            yf = y&0x7;
+      // Sprites are laid out 32 to a row.
+      spriteX = (sprite&0x1F)<<3;
+      spriteRow = (sprite>>5)*spriteSize;
 
-            if ( spriteFlipVert )
-            {
-               yf = (7-yf);
-            }
+      spriteY = m_ppuState.oamMemory[(sprite<<2)+SPRITEY];
+      spriteAttr = m_ppuState.oamMemory[(sprite<<2)+SPRITEATT];
+      spriteFlipVert = !!(spriteAttr&SPRITE_FLIP_VERT);
+      spriteFlipHoriz = !!(spriteAttr&SPRITE_FLIP_HORIZ);
 
-            patternData1 = m_ppuState.memory[spritePatBase+(patternIdx<<4)+(yf)];
-            patternData2 = m_ppuState.memory[spritePatBase+(patternIdx<<4)+(yf)+PATTERN_SIZE];
+      for ( y = 0; y < spriteSize; y++ )
+      {
+         pTV = m_pOAMInspectorTV+((((spriteRow+y)<<8)+spriteX)<<2);
 
-            for ( xf = 0; xf < PATTERN_SIZE; xf++ )
-            {
-               if ( spriteFlipHoriz )
-               {
-                  bit1 = (patternData1>>((xf)))&0x1;
-                  bit2 = (patternData2>>((xf)))&0x1;
-               }
-               else
-               {
-                  bit1 = (patternData1>>(7-(xf)))&0x1;
-                  bit2 = (patternData2>>(7-(xf)))&0x1;
-               }
-
-               colorIdx = (attribData|bit1|(bit2<<1));
-               *pTV = CBasePalette::GetPaletteR(m_ppuState.paletteMemory[0x10+colorIdx]);
-               *(pTV+1) = CBasePalette::GetPaletteG(m_ppuState.paletteMemory[0x10+colorIdx]);
-               *(pTV+2) = CBasePalette::GetPaletteB(m_ppuState.paletteMemory[0x10+colorIdx]);
+         if ( ((m_bOAMViewerShowVisible) && ((spriteY+1) < SPRITE_YMAX)) ||
+               (!m_bOAMViewerShowVisible) )
+         {
+            // For 8x16 sprites the second tile is the bottom half, or the
+            // top half when flipped.
+            yf = spriteFlipVert?(spriteSize-1-y):y;
 
-               pTV += 4;
-            }
+            DRAWTILEROW(pTV,nesGetCHRMEMTile(patternAddr+((yf>>3)<<4))+((yf&0x7)<<3),
+                        0x10+((spriteAttr&SPRITE_PALETTE_IDX_MSK)<<2),rgb,spriteFlipHoriz);
          }
          else
          {
@@ -290,132 +388,120 @@ void CPPUDBG::RENDEROAM ( void )
          }
       }
    }
+
+   m_oamDrawnStamp = stamp;
+   m_bOAMRedraw = false;
 }
 
 void CPPUDBG::RENDERNAMETABLE ( void )
 {
-   int32_t x, xf, y;
-   int32_t lbx, ubx, lby, uby;
-
-   uint32_t ppuAddr = 0x0000;
-   uint16_t patternIdx;
+   int32_t x, y;
+   int32_t scanline;
    int32_t tileX;
    int32_t tileY;
+   int32_t nameTable;
    int32_t nameAddr;
    int32_t attribAddr;
    int32_t bkgndPatBase;
    uint8_t attribData;
-   uint8_t patternData1;
-   uint8_t patternData2;
-   uint8_t bit1, bit2;
-   uint8_t colorIdx;
+   uint16_t patternAddr;
+   uint8_t rgb[MEM_32B][3];
+   uint32_t stamp;
+   uint8_t banksSwitched;
    int8_t* pTV;
 
-   pTV = (int8_t*)m_pNameTableInspectorTV;
+   if ( !m_pNameTableInspectorTV )
+   {
+      return;
+   }
+
+   // Take the stamp first so writes made while drawing are seen next time.
+   stamp = nesGetPPUWriteStamp();
+   banksSwitched = CHRBANKSWITCHED(m_nameTableDrawnBank);
 
-   nesGetPpuSnapshot(&m_ppuState);
+   SNAPSHOTPPU(&m_ppuState,true,m_bPPUViewerShowVisible);
+   PALETTERGB(m_ppuState.paletteMemory,rgb);
 
-   for ( y = 0; y < 480; y++ )
+   // A new palette or background pattern table changes every tile.
+   if ( (WRITTENSINCE(nesGetPPUPaletteWriteStamp(),m_nameTableDrawnStamp)) ||
+        ((m_ppuState.reg[PPUCTRL_REG]&PPUCTRL_BKGND_PAT_TBL_ADDR) != m_nameTableDrawnCtrl) )
    {
-      for ( x = 0; x < 512; x += PATTERN_SIZE ) // pattern-slice rendering...
-      {
-         tileX = ppuAddr&0x001F;
-         tileY = (ppuAddr&0x03E0)>>5;
-         nameAddr = 0x2000 + (ppuAddr&0x0FFF);
-         attribAddr = 0x2000 + (ppuAddr&0x0C00) + 0x03C0 + ((tileY&0xFFFC)<<1) + (tileX>>2);
-         bkgndPatBase = (!!(m_ppuState.reg[PPUCTRL_REG]&PPUCTRL_BKGND_PAT_TBL_ADDR))<<12;
+      m_bNameTableRedraw = true;
+   }
+   m_nameTableDrawnCtrl = m_ppuState.reg[PPUCTRL_REG]&PPUCTRL_BKGND_PAT_TBL_ADDR;
 
-         patternIdx = bkgndPatBase+(m_ppuState.memory[nameAddr]<<4)+((ppuAddr&0x7000)>>12);
-         attribData = m_ppuState.memory[attribAddr];
-         patternData1 = m_ppuState.memory[patternIdx];
-         patternData2 = m_ppuState.memory[patternIdx+PATTERN_SIZE];
+   bkgndPatBase = (!!(m_ppuState.reg[PPUCTRL_REG]&PPUCTRL_BKGND_PAT_TBL_ADDR))<<12;
 
-         if ( (tileY&0x0002) == 0 )
+   // The four nametables are laid out two by two, 64x60 tiles in all.
+   for ( tileY = 0; tileY < 60; tileY++ )
+   {
+      for ( tileX = 0; tileX < 64; tileX++ )
+      {
+         nameTable = 0x2000+((tileX>>5)<<10)+((tileY/30)<<11);
+         nameAddr = nameTable+((tileY%30)<<5)+(tileX&0x1F);
+         attribAddr = nameTable+0x03C0+(((tileY%30)>>2)<<3)+((tileX&0x1F)>>2);
+         patternAddr = bkgndPatBase+(m_ppuState.memory[nameAddr]<<4);
+
+         if ( (!m_bNameTableRedraw) &&
+              (!WRITTENSINCE(nesGetPPUNameTableWriteStamp(nameAddr),m_nameTableDrawnStamp)) &&
+              (!WRITTENSINCE(nesGetPPUNameTableWriteStamp(attribAddr),m_nameTableDrawnStamp)) &&
+              (!CHRTILECHANGED(patternAddr,m_nameTableDrawnStamp,banksSwitched)) )
          {
-            if ( (tileX&0x0002) == 0 )
-            {
-               attribData = (attribData&0x03)<<2;
-            }
-            else
-            {
-               attribData = (attribData&0x0C);
-            }
+            continue;
          }
-         else
+
+         // Each attribute byte holds the sub-palettes of four 2x2 tile areas.
+         attribData = m_ppuState.memory[attribAddr];
+         attribData >>= ((((tileY%30)&0x2)<<1)|((tileX&0x2)));
+         attribData = (attribData&0x03)<<2;
+
+         for ( y = 0; y < PATTERN_SIZE; y++ )
          {
-            if ( (tileX&0x0002) == 0 )
-            {
-               attribData = (attribData&0x30)>>2;
-            }
-            else
-            {
-               attribData = (attribData&0xC0)>>4;
-            }
+            DRAWTILEROW(m_pNameTableInspectorTV+(((((tileY<<3)+y)<<9)+(tileX<<3))<<2),
+                        nesGetCHRMEMTile(patternAddr)+(y<<3),attribData,rgb,false);
          }
+      }
+   }
 
-         for ( xf = 0; xf < PATTERN_SIZE; xf++ )
-         {
-            bit1 = (patternData1>>(7-(xf)))&0x1;
-            bit2 = (patternData2>>(7-(xf)))&0x1;
-            colorIdx = (attribData|bit1|(bit2<<1));
-            *pTV = CBasePalette::GetPaletteR(m_ppuState.paletteMemory[colorIdx]);
-            *(pTV+1) = CBasePalette::GetPaletteG(m_ppuState.paletteMemory[colorIdx]);
-            *(pTV+2) = CBasePalette::GetPaletteB(m_ppuState.paletteMemory[colorIdx]);
-
-            if ( m_bPPUViewerShowVisible )
-            {
-               lbx = *(*(m_ppuState.xOffset+((x+xf)&0xFF))+(y%240));
-               ubx = lbx>>8?lbx&0xFF:lbx+255;
-               lby = *(*(m_ppuState.yOffset+((x+xf)&0xFF))+(y%240));
-               uby = lby/240?lby%240:lby+239;
-
-               if ( !( (((lbx <= ubx) && ((x+xf) >= lbx) && ((x+xf) <= ubx)) ||
-                        ((lbx > ubx) && (!(((x+xf) <= lbx) && ((x+xf) >= ubx))))) &&
-                       (((lby <= uby) && (y >= lby) && (y <= uby)) ||
-                        ((lby > uby) && (!((y <= lby) && (y >= uby))))) ) )
-               {
-                  *pTV &= 0xCF;
-                  *(pTV+1) &= 0xCF;
-                  *(pTV+2) &= 0xCF;
-               }
-            }
+   m_nameTableDrawnStamp = stamp;
+   m_bNameTableRedraw = false;
+
+   // The visible region is drawn on its own layer: black, partly transparent
+   // where the TV doesn't show the nametables, clear where it does.  Each
+   // scanline shows one 256 pixel row of the nametables, wrapping around
+   // them, from the scroll position it was drawn with.  It's only worked out
+   // again when those scroll positions change.
+   if ( (!m_bPPUViewerShowVisible) || (!m_pNameTableOverlayTV) ||
+        ((!m_bNameTableOverlayRedraw) &&
+         (!memcmp(m_xScrollDrawn,m_ppuState.xScroll,sizeof(m_xScrollDrawn))) &&
+         (!memcmp(m_yScrollDrawn,m_ppuState.yScroll,sizeof(m_yScrollDrawn)))) )
+   {
+      return;
+   }
+   memcpy(m_xScrollDrawn,m_ppuState.xScroll,sizeof(m_xScrollDrawn));
+   memcpy(m_yScrollDrawn,m_ppuState.yScroll,sizeof(m_yScrollDrawn));
+   m_bNameTableOverlayRedraw = false;
 
-            pTV += 4;
-         }
+   pTV = m_pNameTableOverlayTV;
 
-         ppuAddr++;
+   for ( x = 0; x < 512*480; x++ )
+   {
+      *pTV = 0x00;
+      *(pTV+1) = 0x00;
+      *(pTV+2) = 0x00;
+      *(pTV+3) = 0x60;
 
-         if ( x == 248 || x == 504 )
-         {
-            ppuAddr ^= 0x400;
-            ppuAddr -= 0x20;
-         }
-      }
+      pTV += 4;
+   }
 
-      if ( (ppuAddr&0x7000) == 0x7000 )
-      {
-         ppuAddr &= 0x8FFF;
+   for ( scanline = 0; scanline < SCANLINES_VISIBLE; scanline++ )
+   {
+      y = (m_ppuState.yScroll[scanline]+scanline)%480;
+      pTV = m_pNameTableOverlayTV+((y<<9)<<2);
 
-         if ( (ppuAddr&0x03E0) == 0x03A0 )
-         {
-            ppuAddr ^= 0x0800;
-            ppuAddr &= 0xFC1F;
-         }
-         else
-         {
-            if ( (ppuAddr&0x03E0) == 0x03E0 )
-            {
-               ppuAddr &= 0xFC1F;
-            }
-            else
-            {
-               ppuAddr += 0x0020;
-            }
-         }
-      }
-      else
+      for ( x = m_ppuState.xScroll[scanline]; x < m_ppuState.xScroll[scanline]+256; x++ )
       {
-         ppuAddr += 0x1000;
+         *(pTV+((x&0x1FF)<<2)+3) = 0x00;
       }
    }
 }
@@ -43,10 +43,12 @@ public:
    static inline void CHRMEMInspectorTV ( int8_t* pTV )
    {
       m_pCHRMEMInspectorTV = pTV;
+      m_bCHRMEMRedraw = true;
    }
    static inline void SetCHRMEMInspectorColor ( int32_t idx, QColor color )
    {
       m_chrMemColor[idx] = color;
+      m_bCHRMEMRedraw = true;
    }
 
    // The OAM memory rendering is performed by the PPU.  The OAM
@@ -56,6 +58,7 @@ public:
    static inline void OAMInspectorTV ( int8_t* pTV )
    {
       m_pOAMInspectorTV = pTV;
+      m_bOAMRedraw = true;
    }
 
    // The nametable memory rendering is performed by the PPU.  The nametable
@@ -65,6 +68,16 @@ public:
    static inline void NameTableInspectorTV ( int8_t* pTV )
    {
       m_pNameTableInspectorTV = pTV;
+      m_bNameTableRedraw = true;
+   }
+
+   // The nametable visualization inspector draws the region of the
+   // nametables visible on the TV as a separate layer, so the nametables
+   // don't have to be drawn again when only the scroll changes.
+   static inline void NameTableOverlayTV ( int8_t* pTV )
+   {
+      m_pNameTableOverlayTV = pTV;
+      m_bNameTableOverlayRedraw = true;
    }
 
    // These functions are invoked at appropriate points in the PPU
@@ -73,7 +86,8 @@ public:
    // game might change the CHR memory map in mid PPU frame.  The CHR
    // memory inspector allows visualization of the CHR memory at a
    // specified scanline, thus showing the state of the CHR memory
-   // before or after the change.
+   // before or after the change.  Each only redraws the tiles or sprites
+   // the emulator's write stamps show have changed since it last drew.
    static void RENDERCHRMEM ( void );
    static void RENDEROAM ( void );
    static void RENDERNAMETABLE ( void );
@@ -104,6 +118,7 @@ public:
    static void SetOAMViewerShowVisible ( bool visible )
    {
       m_bOAMViewerShowVisible = visible;
+      m_bOAMRedraw = true;
    }
 
    // This accessor method sets the flag indicating whether or not
@@ -112,6 +127,7 @@ public:
    static void SetPPUViewerShowVisible ( bool visible )
    {
       m_bPPUViewerShowVisible = visible;
+      m_bNameTableOverlayRedraw = true;
    }
 
    // The PPU's Code/Data Logger display is generated by the PPU core
@@ -145,6 +161,28 @@ public:
    static bool           m_bPPUViewerShowVisible;
 
    static PpuStateSnapshot m_ppuState;
+
+   // What each inspector last drew: the PPU write stamp it drew at, the
+   // CHR banks that were mapped, and the PPUCTRL bits it depends on.  The
+   // redraw flags force everything to be drawn again.
+   static bool           m_bCHRMEMRedraw;
+   static uint32_t       m_chrMemDrawnStamp;
+   static uint32_t       m_chrMemDrawnBank [ 8 ];
+   static bool           m_bOAMRedraw;
+   static uint32_t       m_oamDrawnStamp;
+   static uint32_t       m_oamDrawnBank [ 8 ];
+   static uint8_t        m_oamDrawnCtrl;
+   static bool           m_bNameTableRedraw;
+   static uint32_t       m_nameTableDrawnStamp;
+   static uint32_t       m_nameTableDrawnBank [ 8 ];
+   static uint8_t        m_nameTableDrawnCtrl;
+
+   // The visible region layer of the nametable inspector and the scroll
+   // values it was last worked out from.
+   static int8_t*        m_pNameTableOverlayTV;
+   static bool           m_bNameTableOverlayRedraw;
+   static uint16_t       m_xScrollDrawn [ SCANLINES_VISIBLE ];
+   static uint16_t       m_yScrollDrawn [ SCANLINES_VISIBLE ];
 };
 
 #endif
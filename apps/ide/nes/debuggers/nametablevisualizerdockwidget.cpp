@@ -15,6 +15,7 @@ NameTableVisualizerDockWidget::NameTableVisualizerDockWidget(QWidget *parent) :
 
    ui->setupUi(this);
    imgData = new char[512*512*4];
+   overlayData = new char[512*512*4];
 
    // Clear image...
    for ( i = 0; i < 512*512*4; i+=4 )
@@ -23,8 +24,13 @@ NameTableVisualizerDockWidget::NameTableVisualizerDockWidget(QWidget *parent) :
       imgData[i+1] = 0;
       imgData[i+2] = 0;
       imgData[i+3] = 0xFF;
+      overlayData[i] = 0;
+      overlayData[i+1] = 0;
+      overlayData[i+2] = 0;
+      overlayData[i+3] = 0;
    }
    CPPUDBG::NameTableInspectorTV((int8_t*)imgData);
+   CPPUDBG::NameTableOverlayTV((int8_t*)overlayData);
 
    renderer = new PanZoomRenderer(512,480,2000,imgData,false,ui->frame);
    ui->frame->layout()->addWidget(renderer);
@@ -40,6 +46,7 @@ NameTableVisualizerDockWidget::~NameTableVisualizerDockWidget()
 {
    delete ui;
    delete imgData;
+   delete overlayData;
    delete renderer;
    delete pThread;
 }
@@ -88,9 +95,11 @@ void NameTableVisualizerDockWidget::changeEvent(QEvent* e)
 void NameTableVisualizerDockWidget::renderData()
 {
    renderer->reloadData(imgData);
+   renderer->reloadOverlay(ui->showVisible->isChecked()?overlayData:0);
 }
 
 void NameTableVisualizerDockWidget::on_showVisible_toggled(bool checked)
 {
    CPPUDBG::SetPPUViewerShowVisible ( checked );
+   renderer->reloadOverlay(checked?overlayData:0);
 }
@@ -34,6 +34,7 @@ private slots:
 private:
    Ui::NameTableVisualizerDockWidget *ui;
    char* imgData;
+   char* overlayData;
    PanZoomRenderer* renderer;
    DebuggerUpdateThread* pThread;
    QPoint pressPos;
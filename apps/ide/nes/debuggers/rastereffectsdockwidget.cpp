@@ -0,0 +1,144 @@
+#include "rastereffectsdockwidget.h"
+#include "ui_rastereffectsdockwidget.h"
+
+#include "nes_emulator_core.h"
+
+#include "cobjectregistry.h"
+#include "main.h"
+
+enum
+{
+   RasterEffectsCol_Scanline,
+   RasterEffectsCol_Cycle,
+   RasterEffectsCol_Register,
+   RasterEffectsCol_Value,
+   RasterEffectsCol_Address,
+   RasterEffectsCol_ScrollX,
+   RasterEffectsCol_ScrollY,
+   RasterEffectsCol_Max
+};
+
+RasterEffectsDockWidget::RasterEffectsDockWidget(QWidget *parent) :
+    CDebuggerBase(parent),
+    ui(new Ui::RasterEffectsDockWidget)
+{
+   QStringList headers;
+
+   ui->setupUi(this);
+
+   headers << "Scanline" << "Cycle" << "Register" << "Value" << "Code Address" << "Scroll X" << "Scroll Y";
+   ui->tableWidget->setColumnCount(RasterEffectsCol_Max);
+   ui->tableWidget->setHorizontalHeaderLabels(headers);
+}
+
+RasterEffectsDockWidget::~RasterEffectsDockWidget()
+{
+   delete ui;
+}
+
+void RasterEffectsDockWidget::updateTargetMachine(QString /*target*/)
+{
+   QObject* breakpointWatcher = CObjectRegistry::getObject("Breakpoint Watcher");
+   QObject* emulator = CObjectRegistry::getObject("Emulator");
+
+   QObject::connect ( emulator, SIGNAL(machineReady()), this, SLOT(updateInformation()) );
+   QObject::connect ( emulator, SIGNAL(emulatorReset()), this, SLOT(updateInformation()) );
+   QObject::connect ( emulator, SIGNAL(emulatorPaused(bool)), this, SLOT(updateInformation()) );
+   QObject::connect ( breakpointWatcher, SIGNAL(breakpointHit()), this, SLOT(updateInformation()) );
+}
+
+void RasterEffectsDockWidget::changeEvent(QEvent* e)
+{
+   CDebuggerBase::changeEvent(e);
+
+   switch (e->type())
+   {
+      case QEvent::LanguageChange:
+         ui->retranslateUi(this);
+         break;
+      default:
+         break;
+   }
+}
+
+void RasterEffectsDockWidget::showEvent(QShowEvent* /*e*/)
+{
+   QObject* emulator = CObjectRegistry::getObject("Emulator");
+
+   QObject::connect ( emulator, SIGNAL(updateDebuggers()), this, SLOT(updateInformation()) );
+   updateInformation();
+}
+
+void RasterEffectsDockWidget::hideEvent(QHideEvent* /*e*/)
+{
+   QObject* emulator = CObjectRegistry::getObject("Emulator");
+
+   QObject::disconnect ( emulator, SIGNAL(updateDebuggers()), this, SLOT(updateInformation()) );
+}
+
+void RasterEffectsDockWidget::updateInformation()
+{
+   const char* registerStr [] = { "PPUCTRL", "PPUMASK", "", "", "", "PPUSCROLL", "PPUADDR", "" };
+   PpuRegisterWrite write;
+   uint16_t xScroll [ SCANLINES_VISIBLE ];
+   uint16_t yScroll [ SCANLINES_VISIBLE ];
+   uint32_t idx;
+   int32_t row;
+   char buffer[64];
+
+   // Only update the UI elements if the inspector is visible...
+   if ( !isVisible() )
+   {
+      return;
+   }
+
+   nesGetScanlineScroll(xScroll,yScroll);
+
+   ui->tableWidget->setRowCount(0);
+
+   for ( idx = 0; idx < nesGetPPURegisterWriteCount(); idx++ )
+   {
+      nesGetPPURegisterWrite(idx,&write);
+
+      // Writes outside the visible scanlines set up the frame rather than
+      // split it.
+      if ( write.scanline >= SCANLINES_VISIBLE )
+      {
+         continue;
+      }
+
+      row = ui->tableWidget->rowCount();
+      ui->tableWidget->insertRow(row);
+
+      sprintf ( buffer, "%d", write.scanline );
+      ui->tableWidget->setItem(row,RasterEffectsCol_Scanline,new QTableWidgetItem(buffer));
+      sprintf ( buffer, "%d", write.cycle );
+      ui->tableWidget->setItem(row,RasterEffectsCol_Cycle,new QTableWidgetItem(buffer));
+      sprintf ( buffer, "$%04X %s", write.addr, registerStr[write.addr&0x0007] );
+      ui->tableWidget->setItem(row,RasterEffectsCol_Register,new QTableWidgetItem(buffer));
+      sprintf ( buffer, "$%02X", write.data );
+      ui->tableWidget->setItem(row,RasterEffectsCol_Value,new QTableWidgetItem(buffer));
+      nesGetPrintableAddressWithAbsolute(buffer,write.pc,nesGetAbsoluteAddressFromAddress(write.pc));
+      ui->tableWidget->setItem(row,RasterEffectsCol_Address,new QTableWidgetItem(buffer));
+
+      // The scroll position the write leaves for the scanline after it.
+      if ( write.scanline+1 < SCANLINES_VISIBLE )
+      {
+         sprintf ( buffer, "%d", xScroll[write.scanline+1] );
+         ui->tableWidget->setItem(row,RasterEffectsCol_ScrollX,new QTableWidgetItem(buffer));
+         sprintf ( buffer, "%d", yScroll[write.scanline+1] );
+         ui->tableWidget->setItem(row,RasterEffectsCol_ScrollY,new QTableWidgetItem(buffer));
+      }
+   }
+
+   if ( nesGetPPURegisterWriteCount() == PPU_REGISTER_TIMELINE_SIZE )
+   {
+      sprintf ( buffer, "Timeline full, only the first %d writes are shown.", PPU_REGISTER_TIMELINE_SIZE );
+      ui->status->setText(buffer);
+   }
+   else
+   {
+      sprintf ( buffer, "Mid-frame writes: %d", ui->tableWidget->rowCount() );
+      ui->status->setText(buffer);
+   }
+}
@@ -0,0 +1,35 @@
+#ifndef RASTEREFFECTSDOCKWIDGET_H
+#define RASTEREFFECTSDOCKWIDGET_H
+
+#include "cdebuggerbase.h"
+
+namespace Ui {
+   class RasterEffectsDockWidget;
+}
+
+// Lists the writes to the PPU's rendering registers made during the visible
+// scanlines of the current frame, the mid-frame splits, with the address of
+// the code that made each one and the scroll position the next scanline is
+// drawn from.
+class RasterEffectsDockWidget : public CDebuggerBase
+{
+   Q_OBJECT
+
+public:
+   explicit RasterEffectsDockWidget(QWidget *parent = 0);
+   virtual ~RasterEffectsDockWidget();
+
+protected:
+   void showEvent(QShowEvent* e);
+   void hideEvent(QHideEvent* e);
+   void changeEvent(QEvent* e);
+
+public slots:
+   void updateInformation();
+   void updateTargetMachine(QString target);
+
+private:
+   Ui::RasterEffectsDockWidget *ui;
+};
+
+#endif // RASTEREFFECTSDOCKWIDGET_H
@@ -0,0 +1,97 @@
+#include "cindexedcanvas.h"
+
+#include <string.h>
+
+CIndexedCanvas::CIndexedCanvas(int sizeX,int sizeY,QObject* parent) :
+   QObject(parent),
+   m_sizeX(sizeX),
+   m_sizeY(sizeY)
+{
+   int idx;
+
+   m_indexData = new char[m_sizeX*m_sizeY];
+   m_imageData = new char[m_sizeX*m_sizeY*4];
+   memset(m_indexData,0,m_sizeX*m_sizeY);
+
+   for ( idx = 0; idx < 16; idx++ )
+   {
+      m_lut[idx][0] = 0x00;
+      m_lut[idx][1] = 0x00;
+      m_lut[idx][2] = 0x00;
+      m_lut[idx][3] = 0xFF;
+   }
+   invalidate();
+   flush();
+}
+
+CIndexedCanvas::~CIndexedCanvas()
+{
+   delete [] m_indexData;
+   delete [] m_imageData;
+}
+
+void CIndexedCanvas::setColor(int idx,QColor color)
+{
+   idx &= 0xF;
+
+   if ( (m_lut[idx][0] != color.red()) ||
+        (m_lut[idx][1] != color.green()) ||
+        (m_lut[idx][2] != color.blue()) )
+   {
+      m_lut[idx][0] = color.red();
+      m_lut[idx][1] = color.green();
+      m_lut[idx][2] = color.blue();
+      invalidate();
+   }
+}
+
+QColor CIndexedCanvas::color(int idx) const
+{
+   idx &= 0xF;
+   return QColor(m_lut[idx][0],m_lut[idx][1],m_lut[idx][2]);
+}
+
+void CIndexedCanvas::invalidate(QRect rect)
+{
+   rect &= QRect(0,0,m_sizeX,m_sizeY);
+   if ( !rect.isEmpty() )
+   {
+      m_dirty += rect;
+   }
+}
+
+void CIndexedCanvas::invalidate()
+{
+   m_dirty = QRegion(0,0,m_sizeX,m_sizeY);
+}
+
+void CIndexedCanvas::flush()
+{
+   QRegion region = m_dirty;
+   int x;
+   int y;
+
+   if ( region.isEmpty() )
+   {
+      return;
+   }
+   m_dirty = QRegion();
+
+   foreach ( QRect rect, region.rects() )
+   {
+      for ( y = rect.top(); y <= rect.bottom(); y++ )
+      {
+         const char* pIndex = m_indexData+(y*m_sizeX)+rect.left();
+         char* pImage = m_imageData+(((y*m_sizeX)+rect.left())<<2);
+
+         for ( x = rect.left(); x <= rect.right(); x++ )
+         {
+            memcpy(pImage,m_lut[(*pIndex)&0xF],4);
+            pIndex++;
+            pImage += 4;
+         }
+      }
+   }
+
+   emit imageChanged(region);
+}
@@ -0,0 +1,51 @@
+#ifndef CINDEXEDCANVAS_H
+#define CINDEXEDCANVAS_H
+
+#include <QObject>
+#include <QColor>
+#include <QRegion>
+
+#include <stdint.h>
+
+// An image kept as NES palette indexes, for the designers.
+//
+// Editors draw into the index plane; each entry selects one of the four
+// colors of one of the four sub-palettes (bits 0-1 the color, bits 2-3 the
+// sub-palette), the same layout the tile stamp and CHR bank editors already
+// use.  The canvas keeps the RGBA image the renderers display in step with
+// it.  Anything that changes the index plane marks the rectangle it changed
+// with invalidate(); flush() converts only the marked rectangles through a
+// 16-entry lookup table and tells the renderers which part of the image to
+// upload again.  Changing a palette entry marks the whole canvas.
+class CIndexedCanvas : public QObject
+{
+   Q_OBJECT
+public:
+   CIndexedCanvas(int sizeX,int sizeY,QObject* parent = 0);
+   virtual ~CIndexedCanvas();
+
+   int width() const { return m_sizeX; }
+   int height() const { return m_sizeY; }
+   char* indexData() { return m_indexData; }
+   char* imageData() { return m_imageData; }
+
+   void setColor(int idx,QColor color);
+   QColor color(int idx) const;
+
+   void invalidate(QRect rect);
+   void invalidate();
+   void flush();
+
+signals:
+   void imageChanged(QRegion region);
+
+private:
+   int m_sizeX;
+   int m_sizeY;
+   char* m_indexData;
+   char* m_imageData;
+   uint8_t m_lut[16][4];
+   QRegion m_dirty;
+};
+
+#endif // CINDEXEDCANVAS_H
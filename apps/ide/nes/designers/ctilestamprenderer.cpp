@@ -1,9 +1,9 @@
 #include "ctilestamprenderer.h"
 
-CTileStampRenderer::CTileStampRenderer(QWidget* parent, char* data)
+CTileStampRenderer::CTileStampRenderer(QWidget* parent, CIndexedCanvas* canvas)
    : QGLWidget(parent)
 {
-   imageData = data;
+   this->canvas = canvas;
    scrollX = 0;
    scrollY = 0;
    xSize = 8;
@@ -13,6 +13,8 @@ CTileStampRenderer::CTileStampRenderer(QWidget* parent, char* data)
    boxY1 = -1;
    boxX2 = -1;
    boxY2 = -1;
+
+   QObject::connect(canvas,SIGNAL(imageChanged(QRegion)),this,SLOT(canvas_imageChanged(QRegion)));
 }
 
 CTileStampRenderer::~CTileStampRenderer()
@@ -69,7 +71,15 @@ void CTileStampRenderer::initializeGL()
    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_DECAL);
 
    // Load the actual texture
-   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, 256, 0, GL_RGBA, GL_UNSIGNED_BYTE, imageData);
+   canvas->flush();
+   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, 256, 0, GL_RGBA, GL_UNSIGNED_BYTE, canvas->imageData());
+   pendingUpload = QRegion();
+}
+
+void CTileStampRenderer::canvas_imageChanged(QRegion region)
+{
+   pendingUpload += region;
+   update();
 }
 
 void CTileStampRenderer::setBGColor(QColor clr)
@@ -121,7 +131,18 @@ void CTileStampRenderer::paintGL()
 
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
    glBindTexture (GL_TEXTURE_2D, textureID);
-   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 256, 256, GL_RGBA, GL_UNSIGNED_BYTE, imageData);
+
+   // Bring the canvas up to date and load only what changed.
+   canvas->flush();
+   foreach ( QRect rect, pendingUpload.rects() )
+   {
+      glPixelStorei(GL_UNPACK_SKIP_PIXELS, rect.left());
+      glPixelStorei(GL_UNPACK_SKIP_ROWS, rect.top());
+      glTexSubImage2D(GL_TEXTURE_2D, 0, rect.left(), rect.top(), rect.width(), rect.height(), GL_RGBA, GL_UNSIGNED_BYTE, canvas->imageData());
+   }
+   glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+   glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+   pendingUpload = QRegion();
    glBegin(GL_QUADS);
    glTexCoord2f (0.0, 0.0);
    glVertex3f(000.0f, 000.0f, 0.0f);
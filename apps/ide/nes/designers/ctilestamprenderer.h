@@ -9,10 +9,13 @@
 #include <GL/glext.h>
 #endif
 
+#include "cindexedcanvas.h"
+
 class CTileStampRenderer : public QGLWidget
 {
+   Q_OBJECT
 public:
-   CTileStampRenderer(QWidget* parent, char* data);
+   CTileStampRenderer(QWidget* parent, CIndexedCanvas* canvas);
    virtual ~CTileStampRenderer();
    void initializeGL();
    void resizeGL(int width, int height);
@@ -26,15 +29,20 @@ public:
    void setGrid(bool enabled) { gridEnabled = enabled; }
    void setBox(int x1=-1,int y1=-1,int x2=-1,int y2=-1) { boxX1 = x1; boxY1 = y1; boxX2 = x2; boxY2 = y2; }
    void getBox(int* x1,int* y1,int* x2,int* y2) { (*x1) = boxX1; (*y1) = boxY1; (*x2) = boxX2; (*y2) = boxY2; }
+private slots:
+   void canvas_imageChanged(QRegion region);
 protected:
    int xSize;
    int ySize;
    int zoom;
    int scrollX;
    int scrollY;
-   char* imageData;
+   CIndexedCanvas* canvas;
    GLuint textureID;
 
+   // Parts of the canvas changed since the texture was last loaded.
+   QRegion pendingUpload;
+
    // Properties.
    bool gridEnabled;
    int boxX1;
@@ -4,38 +4,36 @@
 #include "ui_graphicsbankeditorform.h"
 
 #include "cdesignercommon.h"
+#include "cimageconverters.h"
 
 #include "nes_emulator_core.h"
 #include "cnessystempalette.h"
 
-GraphicsBankEditorForm::GraphicsBankEditorForm(QList<IChrRomBankItem*> bankItems,IProjectTreeViewItem* link,QWidget* parent) :
+GraphicsBankEditorForm::GraphicsBankEditorForm(QList<IChrRomBankItem*> bankItems,bool tilify,bool shareFlips,IProjectTreeViewItem* link,QWidget* parent) :
    CDesignerEditorBase(link,parent),
    ui(new Ui::GraphicsBankEditorForm)
 {
-   int i;
-
    ui->setupUi(this);
 
    info = new QLabel(this);
 
+   ui->tilify->blockSignals(true);
+   ui->shareFlips->blockSignals(true);
+   ui->tilify->setChecked(tilify);
+   ui->shareFlips->setChecked(shareFlips);
+   ui->shareFlips->setEnabled(tilify);
+   ui->tilify->blockSignals(false);
+   ui->shareFlips->blockSignals(false);
+
    pThread = new TilificationThread();
-   QObject::connect(this,SIGNAL(prepareToTilify()),pThread,SLOT(prepareToTilify()));
+   QObject::connect(this,SIGNAL(prepareToTilify(bool,bool)),pThread,SLOT(prepareToTilify(bool,bool)));
    QObject::connect(this,SIGNAL(addToTilificator(IChrRomBankItem*)),pThread,SLOT(addToTilificator(IChrRomBankItem*)));
    QObject::connect(this,SIGNAL(tilify()),pThread,SLOT(tilify()));
    QObject::connect(pThread,SIGNAL(tilificationComplete(QByteArray)),this,SLOT(renderData(QByteArray)));
 
-   imgData = new char[256*256*4];
+   m_canvas = new CIndexedCanvas(256,256,this);
 
-   // Clear image...
-   for ( i = 0; i < 256*256*4; i+=4 )
-   {
-      imgData[i] = 0;
-      imgData[i+1] = 0;
-      imgData[i+2] = 0;
-      imgData[i+3] = 0xFF;
-   }
-
-   renderer = new PanZoomRenderer(256,128,2000,imgData,true,ui->frame);
+   renderer = new PanZoomRenderer(256,128,2000,m_canvas->imageData(),true,ui->frame);
    ui->frame->layout()->addWidget(renderer);
    ui->frame->update();
 
@@ -69,7 +67,6 @@ GraphicsBankEditorForm::~GraphicsBankEditorForm()
 
    delete ui;
    delete model;
-   delete imgData;
    delete renderer;
    delete delegate;
    delete pThread;
@@ -80,6 +77,34 @@ QList<IChrRomBankItem*> GraphicsBankEditorForm::bankItems()
    return model->bankItems();
 }
 
+bool GraphicsBankEditorForm::isTilified()
+{
+   return ui->tilify->isChecked();
+}
+
+bool GraphicsBankEditorForm::isSharingFlips()
+{
+   return ui->shareFlips->isChecked();
+}
+
+void GraphicsBankEditorForm::on_tilify_toggled(bool checked)
+{
+   ui->shareFlips->setEnabled(checked);
+
+   updateChrRomBankItemList(bankItems());
+
+   setModified(true);
+   emit markProjectDirty(true);
+}
+
+void GraphicsBankEditorForm::on_shareFlips_toggled(bool /*checked*/)
+{
+   updateChrRomBankItemList(bankItems());
+
+   setModified(true);
+   emit markProjectDirty(true);
+}
+
 bool GraphicsBankEditorForm::eventFilter(QObject* obj,QEvent* event)
 {
    if ( obj == renderer )
@@ -142,7 +167,7 @@ void GraphicsBankEditorForm::updateUi()
 
    ui->tableView->resizeRowsToContents();
 
-   emit prepareToTilify();
+   emit prepareToTilify(ui->tilify->isChecked(),ui->shareFlips->isChecked());
 
    for (idx = 0; idx < model->bankItems().count(); idx++ )
    {
@@ -183,7 +208,7 @@ void GraphicsBankEditorForm::keyPressEvent(QKeyEvent *event)
          {
             model->removeRow(index.row(),QModelIndex());
 
-            emit prepareToTilify();
+            emit prepareToTilify(ui->tilify->isChecked(),ui->shareFlips->isChecked());
 
             for (idx = 0; idx < model->bankItems().count(); idx++ )
             {
@@ -213,7 +238,7 @@ void GraphicsBankEditorForm::updateChrRomBankItemList(QList<IChrRomBankItem*> ba
    model->update();
    ui->tableView->resizeRowsToContents();
 
-   emit prepareToTilify();
+   emit prepareToTilify(ui->tilify->isChecked(),ui->shareFlips->isChecked());
 
    for (idx = 0; idx < bankItems.count(); idx++ )
    {
@@ -225,7 +250,12 @@ void GraphicsBankEditorForm::updateChrRomBankItemList(QList<IChrRomBankItem*> ba
 
 void GraphicsBankEditorForm::renderData(QByteArray output)
 {
+   char* indexData = m_canvas->indexData();
+   unsigned int ppuAddr;
    int idx;
+   int tile;
+   int x;
+   int y;
 
    ui->gauge->setValue(output.count());
 
@@ -235,65 +265,41 @@ void GraphicsBankEditorForm::renderData(QByteArray output)
       output.append((char)0);
    }
 
-   tilifiedData.replace(0,MEM_8KB,output);
+   // Only the tiles the tilificator changed need decoding again.
+   for ( tile = 0; tile < (MEM_8KB>>4); tile++ )
+   {
+      ppuAddr = tile<<4;
+      if ( (tilifiedData.count() == MEM_8KB) &&
+           (!memcmp(tilifiedData.constData()+ppuAddr,output.constData()+ppuAddr,16)) )
+      {
+         continue;
+      }
+
+      // Tiles are laid out 16 to a row, the second pattern table to the
+      // right of the first.
+      x = ((tile&0xF)<<3)+((tile&0x100)?128:0);
+      y = ((tile>>4)&0xF)<<3;
+      CImageConverters::decodeTile(output.constData()+ppuAddr,(uchar*)indexData+(y<<8)+x,256);
+      m_canvas->invalidate(QRect(x,y,8,8));
+   }
+
+   tilifiedData = output;
 
    renderData();
 }
 
 void GraphicsBankEditorForm::renderData()
 {
-   unsigned int ppuAddr = 0x0000;
-   unsigned char patternData1;
-   unsigned char patternData2;
-   unsigned char bit1, bit2;
-   unsigned char colorIdx;
-   QColor color[4];
-   IChrRomBankItem* item;
-
-   color[0] = renderer->getColor(0);
-   color[1] = renderer->getColor(1);
-   color[2] = renderer->getColor(2);
-   color[3] = renderer->getColor(3);
-
-   for (int y = 0; y < 128; y++)
-   {
-      for (int x = 0; x < 256; x += 8)
-      {
-         ppuAddr = ((y>>3)<<8)+((x&0x7F)<<1)+(y&0x7);
-
-         if ( x >= 128 )
-         {
-            ppuAddr += 0x1000;
-         }
-
-         if ( ppuAddr < tilifiedData.count() )
-         {
-            patternData1 = tilifiedData.at(ppuAddr);
-            patternData2 = tilifiedData.at((ppuAddr)+8);
+   int idx;
 
-            for ( int xf = 0; xf < 8; xf++ )
-            {
-               bit1 = (patternData1>>(7-(xf)))&0x1;
-               bit2 = (patternData2>>(7-(xf)))&0x1;
-               colorIdx = (bit1|(bit2<<1));
-               imgData[((y<<8)<<2) + (x<<2) + (xf<<2) + 0] = color[colorIdx].red();
-               imgData[((y<<8)<<2) + (x<<2) + (xf<<2) + 1] = color[colorIdx].green();
-               imgData[((y<<8)<<2) + (x<<2) + (xf<<2) + 2] = color[colorIdx].blue();
-            }
-         }
-         else
-         {
-            for ( int xf = 0; xf < 8; xf++ )
-            {
-               imgData[((y<<8)<<2) + (x<<2) + (xf<<2) + 0] = 0x00;
-               imgData[((y<<8)<<2) + (x<<2) + (xf<<2) + 1] = 0x00;
-               imgData[((y<<8)<<2) + (x<<2) + (xf<<2) + 2] = 0x00;
-            }
-         }
-      }
+   // A color change only touches the canvas' lookup table.
+   for ( idx = 0; idx < 4; idx++ )
+   {
+      m_canvas->setColor(idx,renderer->getColor(idx));
    }
+   m_canvas->flush();
 
-   renderer->reloadData(imgData);
+   renderer->reloadData(m_canvas->imageData());
 }
 
 void GraphicsBankEditorForm::snapTo(QString item)
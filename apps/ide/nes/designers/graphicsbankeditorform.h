@@ -11,6 +11,7 @@
 #include "iprojecttreeviewitem.h"
 
 #include "panzoomrenderer.h"
+#include "cindexedcanvas.h"
 #include "tilificationthread.h"
 
 namespace Ui
@@ -22,12 +23,14 @@ class GraphicsBankEditorForm : public CDesignerEditorBase
 {
    Q_OBJECT
 public:
-   GraphicsBankEditorForm(QList<IChrRomBankItem*> bankItems,IProjectTreeViewItem* link = 0,QWidget* parent = 0);
+   GraphicsBankEditorForm(QList<IChrRomBankItem*> bankItems,bool tilify,bool shareFlips,IProjectTreeViewItem* link = 0,QWidget* parent = 0);
    virtual ~GraphicsBankEditorForm();
    void updateChrRomBankItemList(QList<IChrRomBankItem*> bankItems);
 
    // Member getters.
    QList<IChrRomBankItem*> bankItems();
+   bool isTilified();
+   bool isSharingFlips();
 
 protected:
    void changeEvent(QEvent* event);
@@ -46,7 +49,7 @@ private:
    CChrRomItemTableDisplayModel* model;
    PanZoomRenderer* renderer;
    CChrRomBankItemDelegate* delegate;
-   char* imgData;
+   CIndexedCanvas* m_canvas;
    TilificationThread* pThread;
    QByteArray tilifiedData;
 
@@ -58,9 +61,11 @@ private slots:
    void applyChangesToTab(QString uuid);
    void applyProjectPropertiesToTab();
    void updateTargetMachine(QString /*target*/) {}
+   void on_tilify_toggled(bool checked);
+   void on_shareFlips_toggled(bool checked);
 
 signals:
-   void prepareToTilify();
+   void prepareToTilify(bool tilify,bool shareFlips);
    void addToTilificator(IChrRomBankItem* item);
    void tilify();
 };
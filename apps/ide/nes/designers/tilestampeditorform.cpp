@@ -6,6 +6,7 @@
 #include "cattributetable.h"
 #include "cdesignercommon.h"
 #include "cimageconverters.h"
+#include "cimagequantizer.h"
 
 #include "main.h"
 
@@ -96,9 +97,10 @@ TileStampEditorForm::TileStampEditorForm(QByteArray data,QByteArray attr,QString
    QObject::connect(tilePropertyListModel,SIGNAL(dataChanged(QModelIndex,QModelIndex)),this,SLOT(tilePropertyListModel_dataChanged(QModelIndex,QModelIndex)));
    QObject::connect(ui->propertyTableView->selectionModel(),SIGNAL(currentChanged(QModelIndex,QModelIndex)),this,SLOT(propertyTableView_currentChanged(QModelIndex,QModelIndex)));
    
-   imgData = new char[256*256*4];
+   // The overlay is what's displayed, so it is the canvas' index plane.
+   m_canvas = new CIndexedCanvas(256,256,this);
    colorData = new char[256*256];
-   colorDataOverlay = new char[256*256];
+   colorDataOverlay = m_canvas->indexData();
    colorDataSelection = new char[256*256];
 
    m_xSize = xSize;
@@ -124,14 +126,14 @@ TileStampEditorForm::TileStampEditorForm(QByteArray data,QByteArray attr,QString
    m_colors.append(ui->pal3col2);
    m_colors.append(ui->pal3col3);
 
-   renderer = new CTileStampRenderer(ui->frame,imgData);
+   renderer = new CTileStampRenderer(ui->frame,m_canvas);
    renderer->setSize(m_xSize,m_ySize);
    renderer->setBGColor(QColor(100,100,100));
    ui->frame->layout()->addWidget(renderer);
    ui->frame->layout()->update();
    renderer->setMouseTracking(true);
 
-   previewer = new CTileStampRenderer(ui->frame,imgData);
+   previewer = new CTileStampRenderer(ui->frame,m_canvas);
    previewer->setSize(m_xSize,m_ySize);
    previewer->setBGColor(QColor(100,100,100));
    ui->preview->layout()->addWidget(previewer);
@@ -162,6 +164,8 @@ TileStampEditorForm::TileStampEditorForm(QByteArray data,QByteArray attr,QString
       }
    }
 
+   updateCanvasColors();
+
    // Set up image...
    for ( idx = 0; idx < 256*256; idx++ )
    {
@@ -358,7 +362,6 @@ TileStampEditorForm::TileStampEditorForm(QByteArray data,QByteArray attr,QString
 
 TileStampEditorForm::~TileStampEditorForm()
 {
-   delete imgData;
    delete renderer;
    delete previewer;
    delete tilePropertyListModel;
@@ -778,7 +781,6 @@ void TileStampEditorForm::attributeTable_currentIndexChanged(int index)
 {
    IProjectTreeViewItem* item;
    CAttributeTable* pAttrTbl;
-   QColor color;
    int idx;
 
    m_attrTblUUID = ui->attributeTable->itemData(index).toString();
@@ -800,13 +802,7 @@ void TileStampEditorForm::attributeTable_currentIndexChanged(int index)
    }
 
    // Re-color image.
-   for ( idx = 0; idx < 256*256*4; idx += 4 )
-   {
-      color = m_colors.at(colorData[idx>>2])->currentColor();
-      imgData[idx+0] = color.red();
-      imgData[idx+1] = color.green();
-      imgData[idx+2] = color.blue();
-   }
+   updateCanvasColors();
    renderer->repaint();
    previewer->repaint();
 
@@ -827,7 +823,6 @@ void TileStampEditorForm::grid_toggled(bool checked)
 void TileStampEditorForm::on_clear_clicked()
 {
    int idx;
-   QColor color;
 
    // Set up image...
    for ( idx = 0; idx < 256*256; idx++ )
@@ -835,14 +830,7 @@ void TileStampEditorForm::on_clear_clicked()
       colorData[idx] = 0;
       colorDataOverlay[idx] = 0;
    }
-   for ( idx = 0; idx < 256*256*4; idx +=4 )
-   {
-      color = m_colors.at(colorData[idx>>2])->currentColor();
-      imgData[idx+0] = color.red();
-      imgData[idx+1] = color.green();
-      imgData[idx+2] = color.blue();
-      imgData[idx+3] = 0xFF;
-   }
+   m_canvas->invalidate();
    renderer->repaint();
    previewer->repaint();
 
@@ -1153,6 +1141,7 @@ void TileStampEditorForm::on_cwRotate_clicked()
    }
 
    // Swap the overlay.
+   m_canvas->invalidate();
    oldTileData = tileData();
    oldAttributeData = attributeData();
    copyOverlayToNormal();
@@ -1192,6 +1181,7 @@ void TileStampEditorForm::on_ccwRotate_clicked()
    }
 
    // Swap the overlay.
+   m_canvas->invalidate();
    oldTileData = tileData();
    oldAttributeData = attributeData();
    copyOverlayToNormal();
@@ -1230,6 +1220,7 @@ void TileStampEditorForm::on_flipHorizontal_clicked()
    }
 
    // Swap the overlay.
+   m_canvas->invalidate();
    oldTileData = tileData();
    oldAttributeData = attributeData();
    copyOverlayToNormal();
@@ -1261,6 +1252,7 @@ void TileStampEditorForm::on_flipVertical_clicked()
    }
 
    // Swap the overlay.
+   m_canvas->invalidate();
    oldTileData = tileData();
    oldAttributeData = attributeData();
    copyOverlayToNormal();
@@ -1288,23 +1280,49 @@ void TileStampEditorForm::renderData()
 
 void TileStampEditorForm::paintNormal()
 {
-   int idx;
-   QColor color;
+   resetOverlay();
+   renderer->repaint();
+   previewer->repaint();
+}
 
-   for ( idx = 0; idx < 256*256*4; idx +=4 )
-   {
-      color = m_colors.at(colorData[idx>>2])->currentColor();
-      imgData[idx+0] = color.red();
-      imgData[idx+1] = color.green();
-      imgData[idx+2] = color.blue();
-      imgData[idx+3] = 0xFF;
+void TileStampEditorForm::resetOverlay()
+{
+   int x;
+   int y;
+   int left;
+   int right;
+   char* pOverlay;
+   char* pNormal;
 
-      // Reset overlay.
-      colorDataOverlay[idx>>2] = colorData[idx>>2];
+   // Put back only the pixels the overlay changed, so the canvas only has
+   // to convert those.
+   for ( y = 0; y < 256; y++ )
+   {
+      pOverlay = colorDataOverlay+(y*256);
+      pNormal = colorData+(y*256);
+      if ( memcmp(pOverlay,pNormal,256) )
+      {
+         for ( left = 0; pOverlay[left] == pNormal[left]; left++ );
+         for ( right = 255; pOverlay[right] == pNormal[right]; right-- );
+         for ( x = left; x <= right; x++ )
+         {
+            pOverlay[x] = pNormal[x];
+         }
+         m_canvas->invalidate(QRect(left,y,right-left+1,1));
+      }
    }
-   renderer->repaint();
-   previewer->repaint();
+}
+
+void TileStampEditorForm::updateCanvasColors()
+{
+   int idx;
 
+   // Changing a color re-converts the whole canvas; it is a no-op if none
+   // of them actually changed.
+   for ( idx = 0; idx < m_colors.count(); idx++ )
+   {
+      m_canvas->setColor(idx,m_colors.at(idx)->currentColor());
+   }
 }
 
 void TileStampEditorForm::clearSelection()
@@ -1328,7 +1346,6 @@ void TileStampEditorForm::clearSelection()
 void TileStampEditorForm::paintOverlay(QByteArray overlayData,QByteArray overlayAttr,int overlayXSize,int overlayYSize,int boxX1,int boxY1,int boxX2,int boxY2)
 {
    int idx;
-   QColor color;
    int x;
    int y;
    int posX;
@@ -1341,8 +1358,7 @@ void TileStampEditorForm::paintOverlay(QByteArray overlayData,QByteArray overlay
    int tileWidth;
    int tileHeight;
    int numTiles;
-   char plane1;
-   char plane2;
+   uchar pixels[8*8];
    char plane34;
    char pixel;
    int attrQuadsX;
@@ -1364,11 +1380,8 @@ void TileStampEditorForm::paintOverlay(QByteArray overlayData,QByteArray overlay
    if ( attrQuadsX == 0 ) attrQuadsX = 1;
    if ( attrQuadsY == 0 ) attrQuadsY = 1;
 
-   for ( idx = 0; idx < 256*256; idx++ )
-   {
-      // Reset overlay.
-      colorDataOverlay[idx] = colorData[idx];
-   }
+   resetOverlay();
+   m_canvas->invalidate(QRect(QPoint(boxX1,boxY1),QPoint(boxX2,boxY2)));
 
    while ( (posY < boxY2) && (posX < boxX2) )
    {
@@ -1379,36 +1392,30 @@ void TileStampEditorForm::paintOverlay(QByteArray overlayData,QByteArray overlay
 
          if ( ((posY+tileY) < boxY2) && ((posX+tileX) < boxX2) )
          {
-            for ( y = 0; y < 8; y++ )
+            // Get bitplanes from attribute data.
+            attrQuadX = PIXEL_TO_ATTRQUAD(tileX);
+            attrQuadY = PIXEL_TO_ATTRQUAD(tileY);
+            attrQuad = (attrQuadY*attrQuadsX)+attrQuadX;
+            if ( attrQuad < overlayAttr.count() )
             {
-               // Get bitplanes from image data.
-               plane1 = overlayData.at((tile<<4)+y);
-               plane2 = overlayData.at((tile<<4)+y+8);
-
-               // Get bitplanes from attribute data.
-               attrQuadX = PIXEL_TO_ATTRQUAD(tileX);
-               attrQuadY = PIXEL_TO_ATTRQUAD(tileY);
-               attrQuad = (attrQuadY*attrQuadsX)+attrQuadX;
-               if ( attrQuad < overlayAttr.count() )
-               {
-                  plane34 = overlayAttr.at(attrQuad);
-               }
-               else
-               {
-                  plane34 = 0x00;
-               }
-               plane34 >>= (PIXEL_TO_ATTRSECTION(tileX,tileY)<<1);
-               plane34 &= 0x03;
-               plane34 <<= 2;
+               plane34 = overlayAttr.at(attrQuad);
+            }
+            else
+            {
+               plane34 = 0x00;
+            }
+            plane34 >>= (PIXEL_TO_ATTRSECTION(tileX,tileY)<<1);
+            plane34 &= 0x03;
+            plane34 <<= 2;
+
+            CImageConverters::decodeTile(overlayData.constData()+(tile<<4),pixels,8,plane34);
 
+            for ( y = 0; y < 8; y++ )
+            {
                for ( x = 0; x < 8; x++ )
                {
-                  pixel = (!!(plane1&0x80))
-                        | ((!!(plane2&0x80))<<1)
-                        | plane34;
+                  pixel = pixels[(y<<3)+x];
                   colorDataOverlay[((posY+tileY+y)*256)+posX+tileX+x] = pixel;
-                  plane1 <<= 1;
-                  plane2 <<= 1;
 
                   // Recolor edge tiles if necessary.
                   if ( !recolorPointQueue.contains(QPoint(posX+tileX+x-((posX+tileX+x)%16),posY+tileY+y-((posY+tileY+y)%16))) )
@@ -1433,15 +1440,6 @@ void TileStampEditorForm::paintOverlay(QByteArray overlayData,QByteArray overlay
       // Force recoloration in this case since we're painting tiles.
       recolorTiles(recolorPointQueue.at(idx).x(),recolorPointQueue.at(idx).y(),recolorColorQueue.at(idx),true);
    }
-
-   for ( idx = 0; idx < 256*256*4; idx +=4 )
-   {
-      color = m_colors.at(colorDataOverlay[idx>>2])->currentColor();
-      imgData[idx+0] = color.red();
-      imgData[idx+1] = color.green();
-      imgData[idx+2] = color.blue();
-      imgData[idx+3] = 0xFF;
-   }
 }
 
 void TileStampEditorForm::paintOverlay(OverlayType type,int selectedColor,int boxX1,int boxY1,int boxX2,int boxY2)
@@ -1473,13 +1471,10 @@ void TileStampEditorForm::paintOverlay(OverlayType type,int selectedColor,int bo
    QClipboard* clipboard = QApplication::clipboard();
    QImage image;
    const uchar* bits;
+   bool fullColor;
    int targetColor;
 
-   for ( idx = 0; idx < 256*256; idx++ )
-   {
-      // Reset overlay.
-      colorDataOverlay[idx] = colorData[idx];
-   }
+   resetOverlay();
 
    switch ( type )
    {
@@ -2082,11 +2077,22 @@ void TileStampEditorForm::paintOverlay(OverlayType type,int selectedColor,int bo
             colorDataOverlay[(idxy*256)+idxx] = colorDataOverlay[(idxy*256)+idxx]&0xFC;
          }
       }
+      m_canvas->invalidate(QRect(QPoint(boxX1,boxY1),QPoint(boxX2,boxY2)));
       break;
    case Overlay_PasteClipboard:
       image = clipboard->image();
       if ( !(image.isNull()) )
       {
+         // Full color art from elsewhere is reduced to the stamp's palette,
+         // sub-palettes picked to suit the attribute sections it lands in.
+         fullColor = (image.format() != QImage::Format_Indexed8);
+         if ( fullColor )
+         {
+            CImageQuantizer quantizer(image,boxX1,boxY1);
+
+            quantizer.setPalette(m_colorIndexes);
+            image = quantizer.toIndexed8();
+         }
          bits = image.bits();
          for ( idxy = boxY1, idxcy = 0; idxy < (boxY1+image.height()); idxy++, idxcy++ )
          {
@@ -2097,11 +2103,19 @@ void TileStampEditorForm::paintOverlay(OverlayType type,int selectedColor,int bo
                     (idxy >= 0) &&
                     (idxy < m_ySize) )
                {
-                  colorDataOverlay[(idxy*256)+idxx] &= 0xFC;
-                  colorDataOverlay[(idxy*256)+idxx] |= (bits[(idxcy*image.bytesPerLine())+idxcx]&0x03);
+                  if ( fullColor )
+                  {
+                     colorDataOverlay[(idxy*256)+idxx] = (bits[(idxcy*image.bytesPerLine())+idxcx]&0x0F);
+                  }
+                  else
+                  {
+                     colorDataOverlay[(idxy*256)+idxx] &= 0xFC;
+                     colorDataOverlay[(idxy*256)+idxx] |= (bits[(idxcy*image.bytesPerLine())+idxcx]&0x03);
+                  }
                }
             }
          }
+         m_canvas->invalidate(QRect(boxX1,boxY1,image.width(),image.height()));
       }
       break;
    case Overlay_PasteSelection:
@@ -2119,24 +2133,13 @@ void TileStampEditorForm::paintOverlay(OverlayType type,int selectedColor,int bo
             }
          }
       }
+      m_canvas->invalidate(QRect(QPoint(boxX1,boxY1),QPoint(boxX2,boxY2)));
       break;
    }
-
-   for ( idx = 0; idx < 256*256*4; idx +=4 )
-   {
-      color = m_colors.at(colorDataOverlay[idx>>2])->currentColor();
-      imgData[idx+0] = color.red();
-      imgData[idx+1] = color.green();
-      imgData[idx+2] = color.blue();
-      imgData[idx+3] = 0xFF;
-   }
 }
 
 void TileStampEditorForm::paintOverlay(int selectedColor,int pixx,int pixy)
 {
-   QColor color;
-   int idx;
-
    // If the selected color is background, don't change the attribute, just nix the color.
    if ( selectedColor == 0 )
    {
@@ -2146,16 +2149,8 @@ void TileStampEditorForm::paintOverlay(int selectedColor,int pixx,int pixy)
    {
       colorDataOverlay[(pixy*256)+pixx] = selectedColor;
    }
+   m_canvas->invalidate(QRect(pixx,pixy,1,1));
    recolorTiles(pixx,pixy,selectedColor);
-
-   for ( idx = 0; idx < 256*256*4; idx +=4 )
-   {
-      color = m_colors.at(colorDataOverlay[idx>>2])->currentColor();
-      imgData[idx+0] = color.red();
-      imgData[idx+1] = color.green();
-      imgData[idx+2] = color.blue();
-      imgData[idx+3] = 0xFF;
-   }
 }
 
 void TileStampEditorForm::copyOverlayToNormal()
@@ -2197,47 +2192,32 @@ void TileStampEditorForm::copyNormalToSelection(int boxX1, int boxY1, int boxX2,
 
 void TileStampEditorForm::recolorTiles(int pixx,int pixy,int newColor,bool force)
 {
-   int aqx_in = PIXEL_TO_ATTRQUAD(pixx);
-   int aqy_in = PIXEL_TO_ATTRQUAD(pixy);
-   int as_in = PIXEL_TO_ATTRSECTION(pixx,pixy);
-   int aqx;
-   int aqy;
-   int as;
+   // The pixels sharing an attribute are the attribute section around the
+   // pixel, so that's all that needs visiting.
+   QRect section = QRect(pixx-(pixx%PIXELS_PER_ATTRSECTION),
+                         pixy-(pixy%PIXELS_PER_ATTRSECTION),
+                         PIXELS_PER_ATTRSECTION,
+                         PIXELS_PER_ATTRSECTION)&QRect(0,0,m_xSize,m_ySize);
    int idxx;
    int idxy;
-   int idx;
    int newColorTable;
-   QColor color;
+
+   // Every tool recolors the sections it painted in, so this is also
+   // where the painted area is marked for the canvas.
+   m_canvas->invalidate(section);
 
    if ( (force) || (newColor%4) )
    {
       newColorTable = newColor/4;
 
-      for ( idxy = 0; idxy < m_ySize; idxy++ )
+      for ( idxy = section.top(); idxy <= section.bottom(); idxy++ )
       {
-         for ( idxx = 0; idxx < m_xSize; idxx++ )
+         for ( idxx = section.left(); idxx <= section.right(); idxx++ )
          {
-            aqx = PIXEL_TO_ATTRQUAD(idxx);
-            aqy = PIXEL_TO_ATTRQUAD(idxy);
-            as = PIXEL_TO_ATTRSECTION(idxx,idxy);
-            if ( (aqx == aqx_in) &&
-                 (aqy == aqy_in) &&
-                 (as == as_in) )
-            {
-               colorDataOverlay[(idxy*256)+idxx] &= 0x3;
-               colorDataOverlay[(idxy*256)+idxx] |= (newColorTable<<2);
-            }
+            colorDataOverlay[(idxy*256)+idxx] &= 0x3;
+            colorDataOverlay[(idxy*256)+idxx] |= (newColorTable<<2);
          }
       }
-
-      // Re-color image.
-      for ( idx = 0; idx < 256*256*4; idx += 4 )
-      {
-         color = m_colors.at(colorDataOverlay[idx>>2])->currentColor();
-         imgData[idx+0] = color.red();
-         imgData[idx+1] = color.green();
-         imgData[idx+2] = color.blue();
-      }
    }
 }
 
@@ -2246,7 +2226,6 @@ void TileStampEditorForm::applyChangesToTab(QString uuid)
    IProjectTreeViewItemIterator iter;
    IProjectTreeViewItem* item;
    CAttributeTable* pAttrTbl;
-   QColor color;
    int idx;
 
    // Set up the attribute table list.
@@ -2292,13 +2271,7 @@ void TileStampEditorForm::applyChangesToTab(QString uuid)
       }
 
       // Re-color image.
-      for ( idx = 0; idx < 256*256*4; idx += 4 )
-      {
-         color = m_colors.at(colorData[idx>>2])->currentColor();
-         imgData[idx+0] = color.red();
-         imgData[idx+1] = color.green();
-         imgData[idx+2] = color.blue();
-      }
+      updateCanvasColors();
       renderer->repaint();
       previewer->repaint();
    }
@@ -2351,7 +2324,6 @@ void TileStampEditorForm::applyProjectPropertiesToTab()
 
 void TileStampEditorForm::initializeTile(QByteArray tileData,QByteArray attrData)
 {
-   int x;
    int y;
    int tile;
    int width = m_xSize;
@@ -2361,10 +2333,7 @@ void TileStampEditorForm::initializeTile(QByteArray tileData,QByteArray attrData
    int tileWidth = width/8;
    int tileHeight = height/8;
    int numTiles = tileData.count()/0x10;
-   char plane1;
-   char plane2;
    char plane34;
-   char pixel;
    int attrQuadsX = (tileWidth>>2);
    int attrQuadsY = (tileHeight>>2);
    int attrQuadX;
@@ -2379,40 +2348,31 @@ void TileStampEditorForm::initializeTile(QByteArray tileData,QByteArray attrData
       tileX = (tile%tileWidth)*8;
       tileY = (tile/tileWidth)*8;
 
-      for ( y = 0; y < 8; y++ )
+      // Get bitplanes from attribute data.
+      attrQuadX = PIXEL_TO_ATTRQUAD(tileX);
+      attrQuadY = PIXEL_TO_ATTRQUAD(tileY);
+      attrQuad = (attrQuadY*attrQuadsX)+attrQuadX;
+      if ( attrQuad < attrData.count() )
       {
-         // Get bitplanes from image data.
-         plane1 = tileData.at((tile<<4)+y);
-         plane2 = tileData.at((tile<<4)+y+8);
+         plane34 = attrData.at(attrQuad);
+      }
+      else
+      {
+         plane34 = 0x00;
+      }
+      plane34 >>= (PIXEL_TO_ATTRSECTION(tileX,tileY)<<1);
+      plane34 &= 0x03;
+      plane34 <<= 2;
 
-         // Get bitplanes from attribute data.
-         attrQuadX = PIXEL_TO_ATTRQUAD(tileX);
-         attrQuadY = PIXEL_TO_ATTRQUAD(tileY);
-         attrQuad = (attrQuadY*attrQuadsX)+attrQuadX;
-         if ( attrQuad < attrData.count() )
-         {
-            plane34 = attrData.at(attrQuad);
-         }
-         else
-         {
-            plane34 = 0x00;
-         }
-         plane34 >>= (PIXEL_TO_ATTRSECTION(tileX,tileY)<<1);
-         plane34 &= 0x03;
-         plane34 <<= 2;
+      CImageConverters::decodeTile(tileData.constData()+(tile<<4),(uchar*)colorData+(tileY*256)+tileX,256,plane34);
 
-         for ( x = 0; x < 8; x++ )
-         {
-            pixel = (!!(plane1&0x80))
-                  | ((!!(plane2&0x80))<<1)
-                  | (plane34);
-            colorData[((tileY+y)*256)+tileX+x] = pixel;
-            colorDataOverlay[((tileY+y)*256)+tileX+x] = pixel;
-            plane1 <<= 1;
-            plane2 <<= 1;
-         }
+      for ( y = 0; y < 8; y++ )
+      {
+         memcpy(colorDataOverlay+((tileY+y)*256)+tileX,colorData+((tileY+y)*256)+tileX,8);
       }
    }
+
+   m_canvas->invalidate();
 }
 
 QByteArray TileStampEditorForm::tileData(bool useOverlay)
@@ -2836,7 +2796,7 @@ void TileStampEditorForm::pencilTool(QMouseEvent *event)
    boxX2 = boxX1+16;
    boxY2 = boxY1+16;
    renderer->setBox(boxX1,boxY1,boxX2,boxY2);
-   renderer->repaint();
+   renderer->update();
 
    if ( selectedColor >= 0 )
    {
@@ -2869,12 +2829,14 @@ void TileStampEditorForm::pencilTool(QMouseEvent *event)
          }
          break;
       case QEvent::MouseMove:
+         // Freehand strokes only mark what they touch and let the renderers
+         // catch up at display rate rather than repainting on every event.
          boxX1 = pixx-(pixx%16);
          boxY1 = pixy-(pixy%16);
          boxX2 = boxX1+16;
          boxY2 = boxY1+16;
          renderer->setBox(boxX1,boxY1,boxX2,boxY2);
-         renderer->repaint();
+         renderer->update();
 
          if ( event->buttons() == Qt::LeftButton )
          {
@@ -2890,14 +2852,14 @@ void TileStampEditorForm::pencilTool(QMouseEvent *event)
                }
                paintOverlay(selectedColor,pixx,pixy);
             }
-            renderer->repaint();
-            previewer->repaint();
+            renderer->update();
+            previewer->update();
          }
          else if ( event->buttons() == Qt::RightButton )
          {
             paintOverlay(0,pixx,pixy);
-            renderer->repaint();
-            previewer->repaint();
+            renderer->update();
+            previewer->update();
          }
          m_anchor = QPoint(pixx,pixy);
          break;
@@ -7,6 +7,7 @@
 #include "cdesignereditorbase.h"
 #include "cdesignercommon.h"
 #include "ctilestamprenderer.h"
+#include "cindexedcanvas.h"
 #include "cpropertylistmodel.h"
 #include "cpropertyvaluedelegate.h"
 
@@ -80,6 +81,8 @@ protected:
    bool eventFilter(QObject *obj, QEvent *event);
    void updateScrollbars();
    void recolorTiles(int pixx,int pixy,int newColor,bool force=false);
+   void updateCanvasColors();
+   void resetOverlay();
    void recolorClipboard(int boxX1,int boxY1,int boxX2,int boxY2);
    void paintOverlay(QByteArray overlayData,QByteArray overlayAttr,int overlayXSize,int overlayYSize,int boxX1,int boxY1,int boxX2,int boxY2);
    void paintOverlay(OverlayType type,int selectedColor,int boxX1,int boxY1,int boxX2,int boxY2);
@@ -145,7 +148,7 @@ private:
    int m_ySize;
    QString m_attrTblUUID;
    bool m_gridEnabled;
-   char* imgData;
+   CIndexedCanvas* m_canvas;
    char* colorData;
    char* colorDataOverlay;
    char* colorDataSelection;
@@ -1,7 +1,10 @@
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
 
 #include "cchrrombank.h"
 #include "cimageconverters.h"
+#include "cimagequantizer.h"
 #include "cobjectregistry.h"
 #include "main.h"
 
@@ -90,7 +93,40 @@ void CCHRROMBank::importFromPNG()
    {
       imgIn.load(fileName);
 
-      chrData = CImageConverters::fromIndexed8(imgIn);
+      if ( imgIn.format() == QImage::Format_Indexed8 )
+      {
+         chrData = CImageConverters::fromIndexed8(imgIn);
+      }
+      else
+      {
+         // Full color art is a screen.  It's reduced to NES colors, its
+         // distinct tiles go in the bank and its nametable, attributes and
+         // palette are saved alongside the image.
+         CImageQuantizer quantizer(imgIn);
+         QFileInfo fileInfo(fileName);
+         QByteArray nametable;
+         QByteArray attributes;
+
+         quantizer.choosePalette();
+         quantizer.toScreen(&chrData,&nametable,&attributes);
+
+         if ( chrData.size() > MEM_8KB )
+         {
+            QMessageBox::warning(NULL,"Import CHR-ROM Bank from PNG",
+                                 "The image has "+QString::number(chrData.size()/16)+" different tiles, only the first 512 fit in the bank.");
+         }
+         if ( !quantizer.saveScreen(fileInfo.path()+"/"+fileInfo.completeBaseName(),nametable,attributes) )
+         {
+            QMessageBox::warning(NULL,"Import CHR-ROM Bank from PNG",
+                                 "The nametable and palette of "+fileInfo.fileName()+" couldn't be saved.");
+         }
+      }
+
+      // The bank is always 8KB, smaller images leave the rest of it empty.
+      if ( chrData.size() < MEM_8KB )
+      {
+         chrData.append(QByteArray(MEM_8KB-chrData.size(),0));
+      }
 
       setBankData(chrData.constData());
 
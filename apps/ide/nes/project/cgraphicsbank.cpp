@@ -14,6 +14,8 @@ CGraphicsBank::CGraphicsBank(IProjectTreeViewItem* parent)
 
    // Allocate attributes
    m_bankItems.clear();
+   m_tilify = false;
+   m_shareFlips = false;
 }
 
 CGraphicsBank::~CGraphicsBank()
@@ -36,6 +38,9 @@ bool CGraphicsBank::serialize(QDomDocument& doc, QDomNode& node)
       editor()->onSave();
    }
 
+   element.setAttribute("tilify",m_tilify);
+   element.setAttribute("shareflips",m_shareFlips);
+
    for (int i=0; i < m_bankItems.count(); i++)
    {
       QDomElement graphicsItemElement = addElement( doc, element, "graphicitem" );
@@ -95,6 +100,11 @@ bool CGraphicsBank::deserialize(QDomDocument& /*doc*/, QDomNode& node, QString&
 
    setUuid(element.attribute("uuid"));
 
+   // Banks saved before tilification was optional are laid out as they
+   // always were.
+   m_tilify = element.attribute("tilify","0").toInt();
+   m_shareFlips = element.attribute("shareflips","0").toInt();
+
    m_bankItems.clear();
 
    QDomNode childNode = node.firstChild();
@@ -180,7 +190,7 @@ void CGraphicsBank::openItemEvent(CProjectTabWidget* tabWidget)
    }
    else
    {
-      m_editor = new GraphicsBankEditorForm(m_bankItems,this);
+      m_editor = new GraphicsBankEditorForm(m_bankItems,m_tilify,m_shareFlips,this);
       tabWidget->addTab(m_editor, this->caption());
       tabWidget->setCurrentWidget(m_editor);
    }
@@ -189,6 +199,8 @@ void CGraphicsBank::openItemEvent(CProjectTabWidget* tabWidget)
 void CGraphicsBank::saveItemEvent()
 {
    m_bankItems = editor()->bankItems();
+   m_tilify = editor()->isTilified();
+   m_shareFlips = editor()->isSharingFlips();
 
    if ( m_editor )
    {
@@ -16,6 +16,8 @@ public:
 
    // Member getters
    QList<IChrRomBankItem*> getGraphics();
+   bool getTilify() { return m_tilify; }
+   bool getShareFlips() { return m_shareFlips; }
 
    GraphicsBankEditorForm* editor() { return dynamic_cast<GraphicsBankEditorForm*>(m_editor); }
    void exportAsPNG();
@@ -37,6 +39,11 @@ public:
 private:
    // Attributes
    QList<IChrRomBankItem*> m_bankItems;
+
+   // Whether the bank's tile stamps are tilified, and whether flipped
+   // copies of tiles are shared too [sprite banks only].
+   bool m_tilify;
+   bool m_shareFlips;
 };
 
 #endif // CGRAPHICSBANK_H
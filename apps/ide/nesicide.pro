@@ -105,6 +105,9 @@ mac {
    QMAKE_POST_LINK += install_name_tool -change libc64-emulator.1.dylib \
       @executable_path/../Frameworks/libc64-emulator.1.dylib \
       $${DESTDIR}/$${TARGET}.app/Contents/MacOS/nesicide $$escape_expand(\n\t)
+   QMAKE_POST_LINK += install_name_tool -change libnes-emulator.1.dylib \
+      @executable_path/../Frameworks/libnes-emulator.1.dylib \
+      $${DESTDIR}/$${TARGET}.app/Contents/Frameworks/libc64-emulator.1.dylib $$escape_expand(\n\t)
 
    QMAKE_POST_LINK += cp $$TOP/libs/famitracker/$${LIB_BUILD_TYPE_DIR}/libfamitracker.1.0.0.dylib \
       $${DESTDIR}/$${TARGET}.app/Contents/Frameworks/libfamitracker.1.dylib $$escape_expand(\n\t)
@@ -227,10 +230,13 @@ SOURCES += \
    aboutdialog.cpp \
    common/cbuildertextlogger.cpp \
    common/cdockwidgetregistry.cpp \
+   nes/common/apuspectrumwidget.cpp \
    nes/common/cgamedatabasehandler.cpp \
    common/checkboxlist.cpp \
    nes/common/chrbankitemstabwidget.cpp \
    nes/common/cimageconverters.cpp \
+   nes/common/cimagequantizer.cpp \
+   nes/common/ctilificator.cpp \
    nes/common/colorpushbutton.cpp \
    common/cprojecttabwidget.cpp \
    common/cpropertyitem.cpp \
@@ -242,12 +248,14 @@ SOURCES += \
    common/searchbar.cpp \
    common/searchdockwidget.cpp \
    common/searcherthread.cpp \
+   common/csearchtrigrams.cpp \
    common/sourcenavigator.cpp \
    nes/common/tilificationthread.cpp \
    compilers/cc65/ccc65interface.cpp \
    compilers/cc65/dbginfo.c \
    nes/compilers/ccartridgebuilder.cpp \
    nes/compilers/cgraphicsassembler.cpp \
+   nes/compilers/cmusicprofiler.cpp \
    compilers/compilerthread.cpp \
    compilers/csourceassembler.cpp \
    nes/debuggers/apuinformationdockwidget.cpp \
@@ -270,6 +278,7 @@ SOURCES += \
    nes/debuggers/codedataloggerdockwidget.cpp \
    debuggers/codeprofilerdockwidget.cpp \
    debuggers/csymbolwatchmodel.cpp \
+   debuggers/cwatchexpression.cpp \
    nes/debuggers/dbg_cnes.cpp \
    nes/debuggers/dbg_cnes6502.cpp \
    nes/debuggers/dbg_cnesapu.cpp \
@@ -284,6 +293,7 @@ SOURCES += \
    nes/debuggers/nametablevisualizerdockwidget.cpp \
    nes/debuggers/oamvisualizerdockwidget.cpp \
    nes/debuggers/ppuinformationdockwidget.cpp \
+   nes/debuggers/rastereffectsdockwidget.cpp \
    debuggers/registerinspectordockwidget.cpp \
    debuggers/symbolwatchdockwidget.cpp \
    nes/designers/attributetableeditorform.cpp \
@@ -301,12 +311,16 @@ SOURCES += \
    designers/projectpropertiesdialog.cpp \
    designers/propertyeditordialog.cpp \
    nes/designers/ctilestamprenderer.cpp \
+   nes/designers/cindexedcanvas.cpp \
    nes/designers/tilestampeditorform.cpp \
    nes/emulator/nesemulatordockwidget.cpp \
    nes/emulator/nesemulatorrenderer.cpp \
    nes/emulator/nesemulatorthread.cpp \
    $$TOP/common/emulatorprefsdialog.cpp \
    c64/emulator/c64emulatorthread.cpp \
+   c64/emulator/c64builtinemulatorthread.cpp \
+   c64/emulator/c64emulatordockwidget.cpp \
+   c64/emulator/cvicebinarymonitor.cpp \
    environmentsettingsdialog.cpp \
    main.cpp \
    mainwindow.cpp \
@@ -373,10 +387,13 @@ HEADERS += \
    common/cbuildertextlogger.h \
    common/cdesignercommon.h \
    common/cdockwidgetregistry.h \
+   nes/common/apuspectrumwidget.h \
    nes/common/cgamedatabasehandler.h \
    common/checkboxlist.h \
    nes/common/chrbankitemstabwidget.h \
    nes/common/cimageconverters.h \
+   nes/common/cimagequantizer.h \
+   nes/common/ctilificator.h \
    nes/common/colorpushbutton.h \
    nes/common/cpaletteitemdelegate.h \
    common/cprojecttabwidget.h \
@@ -389,12 +406,14 @@ HEADERS += \
    common/searchbar.h \
    common/searchdockwidget.h \
    common/searcherthread.h \
+   common/csearchtrigrams.h \
    common/sourcenavigator.h \
    nes/common/tilificationthread.h \
    compilers/cc65/ccc65interface.h \
    compilers/cc65/dbginfo.h \
    nes/compilers/ccartridgebuilder.h \
    nes/compilers/cgraphicsassembler.h \
+   nes/compilers/cmusicprofiler.h \
    compilers/compilerthread.h \
    compilers/csourceassembler.h \
    nes/debuggers/apuinformationdockwidget.h \
@@ -417,6 +436,7 @@ HEADERS += \
    nes/debuggers/codedataloggerdockwidget.h \
    debuggers/codeprofilerdockwidget.h \
    debuggers/csymbolwatchmodel.h \
+   debuggers/cwatchexpression.h \
    nes/debuggers/dbg_cnes.h \
    nes/debuggers/dbg_cnes6502.h \
    nes/debuggers/dbg_cnesapu.h \
@@ -431,6 +451,7 @@ HEADERS += \
    nes/debuggers/nametablevisualizerdockwidget.h \
    nes/debuggers/oamvisualizerdockwidget.h \
    nes/debuggers/ppuinformationdockwidget.h \
+   nes/debuggers/rastereffectsdockwidget.h \
    debuggers/registerinspectordockwidget.h \
    debuggers/symbolwatchdockwidget.h \
    nes/designers/attributetableeditorform.h \
@@ -448,11 +469,15 @@ HEADERS += \
    designers/projectpropertiesdialog.h \
    designers/propertyeditordialog.h \
    nes/designers/ctilestamprenderer.h \
+   nes/designers/cindexedcanvas.h \
    nes/designers/tilestampeditorform.h \
    nes/emulator/nesemulatordockwidget.h \
    nes/emulator/nesemulatorrenderer.h \
    nes/emulator/nesemulatorthread.h \
    c64/emulator/c64emulatorthread.h \
+   c64/emulator/c64builtinemulatorthread.h \
+   c64/emulator/c64emulatordockwidget.h \
+   c64/emulator/cvicebinarymonitor.h \
    $$TOP/common/emulatorprefsdialog.h \
    environmentsettingsdialog.h \
    interfaces/icenterwidgetitem.h \
@@ -544,6 +569,7 @@ FORMS += \
    nes/debuggers/nametablevisualizerdockwidget.ui \
    nes/debuggers/oamvisualizerdockwidget.ui \
    nes/debuggers/ppuinformationdockwidget.ui \
+   nes/debuggers/rastereffectsdockwidget.ui \
    debuggers/registerinspectordockwidget.ui \
    debuggers/symbolwatchdockwidget.ui \
    nes/designers/attributetableeditorform.ui \
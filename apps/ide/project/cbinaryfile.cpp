@@ -4,6 +4,7 @@
 #include "main.h"
 
 #include "cimageconverters.h"
+#include "cimagequantizer.h"
 
 CBinaryFile::CBinaryFile(IProjectTreeViewItem* parent)
 {
@@ -29,13 +30,38 @@ QImage CBinaryFile::getBinaryImage()
    return CImageConverters::toIndexed8(getBinaryData(),m_xSize,m_ySize);
 }
 
-void CBinaryFile::setBinaryData(const QByteArray& newBinaryData)
+// Lays a number of CHR tiles out the way a CHR bank image would be.
+static void tilesToSize(int tiles,int* xSize,int* ySize)
 {
-   QImage image;
-   int tiles;
    int tilesX;
    int tilesY;
 
+   tilesY = tiles/16;
+   if ( tilesY >= 1 )
+   {
+      tilesX = 16;
+   }
+   else
+   {
+      tilesX = tiles%16;
+   }
+   if ( tilesY == 0 )
+   {
+      tilesY = 1;
+   }
+   if ( tilesY > 16 )
+   {
+      tilesY = 16;
+      tilesX = 32;
+   }
+   (*xSize) = tilesX*8;
+   (*ySize) = tilesY*8;
+}
+
+void CBinaryFile::setBinaryData(const QByteArray& newBinaryData)
+{
+   QImage image;
+
    image.loadFromData(newBinaryData);
 
    switch ( image.format() )
@@ -46,31 +72,32 @@ void CBinaryFile::setBinaryData(const QByteArray& newBinaryData)
       m_xSize = image.width();
       m_ySize = image.height();
       break;
-   default:
+   case QImage::Format_Invalid:
       m_binaryData = newBinaryData;
 
       // Attempt to determine 'size' of binary data in tiles.
-      tiles = newBinaryData.length()/16;
-      tilesY = tiles/16;
-      if ( tilesY >= 1 )
-      {
-         tilesX = 16;
-      }
-      else
-      {
-         tilesX = tiles%16;
-      }
-      if ( tilesY == 0 )
-      {
-         tilesY = 1;
-      }
-      if ( tilesY > 16 )
+      tilesToSize(newBinaryData.length()/16,&m_xSize,&m_ySize);
+      break;
+   default:
       {
-         tilesY = 16;
-         tilesX = 32;
+         // Full color art is a screen.  It's reduced to NES colors and its
+         // distinct tiles are the file's data.  Its nametable, attributes
+         // and palette are saved alongside it.
+         CImageQuantizer quantizer(image);
+         QDir dir(QDir::currentPath());
+         QFileInfo fileInfo(dir.relativeFilePath(m_path));
+         QByteArray nametable;
+         QByteArray attributes;
+
+         quantizer.choosePalette();
+         quantizer.toScreen(&m_binaryData,&nametable,&attributes);
+
+         if ( !m_path.isEmpty() )
+         {
+            quantizer.saveScreen(fileInfo.path()+"/"+fileInfo.completeBaseName(),nametable,attributes);
+         }
       }
-      m_xSize = tilesX*8;
-      m_ySize = tilesY*8;
+      tilesToSize(m_binaryData.length()/16,&m_xSize,&m_ySize);
       break;
    }
 }
@@ -0,0 +1,19 @@
+# Checks the trigrams the project search looks files up by.
+QT += testlib
+QT -= gui
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TOP = ../../../..
+
+TARGET = searchtrigrams
+
+INCLUDEPATH += ../../common
+
+SOURCES += \
+   tst_searchtrigrams.cpp \
+   ../../common/csearchtrigrams.cpp
+
+HEADERS += \
+   ../../common/csearchtrigrams.h
@@ -0,0 +1,95 @@
+#include <QtTest>
+
+#include "csearchtrigrams.h"
+
+class SearchTrigramsTest : public QObject
+{
+   Q_OBJECT
+
+private slots:
+   void literal();
+   void regexEscapes_data();
+   void regexEscapes();
+   void regexRuns_data();
+   void regexRuns();
+};
+
+// The trigrams of some plain text, as the index would hold them.
+static QVector<quint32> trigramsOf(QByteArray text)
+{
+   QVector<quint32> trigrams;
+
+   CSearchTrigrams::add((const uchar*)text.constData(),text.length(),&trigrams);
+   CSearchTrigrams::sort(&trigrams);
+   return trigrams;
+}
+
+// The trigrams of runs of plain text separated by newlines, which no
+// search trigram holds.
+static QVector<quint32> trigramsOfRuns(QByteArray runs)
+{
+   QVector<quint32> trigrams;
+
+   foreach ( QByteArray run, runs.split('\n') )
+   {
+      trigrams += trigramsOf(run);
+   }
+   CSearchTrigrams::sort(&trigrams);
+   return trigrams;
+}
+
+void SearchTrigramsTest::literal()
+{
+   QCOMPARE(CSearchTrigrams::search("LDA #$41",false),trigramsOf("lda #$41"));
+   QCOMPARE(CSearchTrigrams::search("\\x41zz",false),trigramsOf("\\x41zz"));
+}
+
+void SearchTrigramsTest::regexEscapes_data()
+{
+   QTest::addColumn<QString>("searchText");
+   QTest::addColumn<QByteArray>("plain");
+
+   // An escape that stands for one character is that character; none of
+   // its digits are plain characters of their own.
+   QTest::newRow("hex") << "\\x41zz" << QByteArray("Azz");
+   QTest::newRow("hex, four digits") << "\\x0041zz" << QByteArray("Azz");
+   QTest::newRow("hex, mid-run") << "sta\\x20label" << QByteArray("sta label");
+   QTest::newRow("octal") << "\\0101zz" << QByteArray("Azz");
+   QTest::newRow("tab") << "lda\\t#0" << QByteArray("lda\t#0");
+   QTest::newRow("punctuation") << "foo\\.bar" << QByteArray("foo.bar");
+
+   // Any other escape ends the run it's in.
+   QTest::newRow("class escape") << "foo\\dbar" << QByteArray("foo\nbar");
+   QTest::newRow("non-ASCII hex") << "abc\\x4112zz" << QByteArray("abc");
+}
+
+void SearchTrigramsTest::regexEscapes()
+{
+   QFETCH(QString,searchText);
+   QFETCH(QByteArray,plain);
+
+   QCOMPARE(CSearchTrigrams::search(searchText,true),trigramsOfRuns(plain));
+}
+
+void SearchTrigramsTest::regexRuns_data()
+{
+   QTest::addColumn<QString>("searchText");
+   QTest::addColumn<QByteArray>("plain");
+
+   QTest::newRow("optional escape") << "ab\\x43*def" << QByteArray("def");
+   QTest::newRow("group") << "(abc)def" << QByteArray("def");
+   QTest::newRow("class") << "abc[\\x5d]def" << QByteArray("abc\ndef");
+   QTest::newRow("alternation") << "abc|def" << QByteArray();
+}
+
+void SearchTrigramsTest::regexRuns()
+{
+   QFETCH(QString,searchText);
+   QFETCH(QByteArray,plain);
+
+   QCOMPARE(CSearchTrigrams::search(searchText,true),trigramsOfRuns(plain));
+}
+
+QTEST_APPLESS_MAIN(SearchTrigramsTest)
+
+#include "tst_searchtrigrams.moc"
@@ -0,0 +1,97 @@
+#include "cfakevice.h"
+
+#include "cvicebinarymonitor.h"
+
+CFakeVice::CFakeVice(QObject* parent)
+   : QObject(parent),
+     m_pSocket(NULL),
+     m_memory(0x10000,0)
+{
+   int addr;
+
+   // Something other than zeroes so misplaced bytes show.
+   for ( addr = 0; addr < m_memory.size(); addr++ )
+   {
+      m_memory[addr] = (char)((addr>>8)^addr);
+   }
+
+   QObject::connect(&m_server,SIGNAL(newConnection()),this,SLOT(newConnection()));
+}
+
+bool CFakeVice::listen()
+{
+   return m_server.listen(QHostAddress::LocalHost);
+}
+
+QByteArray CFakeVice::response(int type,int error,uint32_t requestId,QByteArray body)
+{
+   QByteArray data;
+
+   CViceBinaryMonitor::appendU8(data,VICE_STX);
+   CViceBinaryMonitor::appendU8(data,VICE_API_VERSION);
+   CViceBinaryMonitor::appendU32(data,body.size());
+   CViceBinaryMonitor::appendU8(data,type);
+   CViceBinaryMonitor::appendU8(data,error);
+   CViceBinaryMonitor::appendU32(data,requestId);
+   data.append(body);
+
+   return data;
+}
+
+void CFakeVice::send(QByteArray data)
+{
+   m_pSocket->write(data);
+   m_pSocket->flush();
+}
+
+void CFakeVice::newConnection()
+{
+   m_pSocket = m_server.nextPendingConnection();
+   QObject::connect(m_pSocket,SIGNAL(readyRead()),this,SLOT(readyRead()));
+}
+
+void CFakeVice::readyRead()
+{
+   FakeViceRequest request;
+   QByteArray body;
+   uint32_t length;
+   uint32_t start;
+   uint32_t end;
+
+   m_received.append(m_pSocket->readAll());
+
+   while ( m_received.size() >= VICE_REQUEST_HEADER_SIZE )
+   {
+      length = CViceBinaryMonitor::getU32(m_received,2);
+      if ( (uint32_t)m_received.size() < VICE_REQUEST_HEADER_SIZE+length )
+      {
+         break;
+      }
+
+      request.requestId = CViceBinaryMonitor::getU32(m_received,6);
+      request.command = CViceBinaryMonitor::getU8(m_received,10);
+      request.body = m_received.mid(VICE_REQUEST_HEADER_SIZE,length);
+      m_requests.append(request);
+      m_received.remove(0,VICE_REQUEST_HEADER_SIZE+length);
+
+      // Memory requests are side effects, start, end, memspace and bank;
+      // a get is answered with the length and the bytes.
+      if ( (request.command == VICE_CMD_MEMORY_GET) ||
+           (request.command == VICE_CMD_MEMORY_SET) )
+      {
+         start = CViceBinaryMonitor::getU16(request.body,1);
+         end = CViceBinaryMonitor::getU16(request.body,3);
+         body.clear();
+         if ( request.command == VICE_CMD_MEMORY_GET )
+         {
+            CViceBinaryMonitor::appendU16(body,end-start+1);
+            body.append(m_memory.mid(start,end-start+1));
+         }
+         else
+         {
+            m_memory.replace(start,end-start+1,request.body.mid(8));
+         }
+         send(response(request.command,VICE_ERROR_OK,request.requestId,body));
+      }
+   }
+}
@@ -0,0 +1,51 @@
+#ifndef CFAKEVICE_H
+#define CFAKEVICE_H
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QByteArray>
+#include <QList>
+
+#include <stdint.h>
+
+// A request as the fake VICE received it.
+typedef struct
+{
+   uint32_t   requestId;
+   int        command;
+   QByteArray body;
+} FakeViceRequest;
+
+// Just enough of VICE's binary monitor to talk to: it takes requests off
+// the socket, keeps 64KB of memory, and answers memory gets and sets.
+// Other requests are only recorded.
+class CFakeVice : public QObject
+{
+   Q_OBJECT
+public:
+   CFakeVice(QObject* parent = 0);
+
+   bool listen();
+   int port() const { return m_server.serverPort(); }
+   bool isConnected() const { return m_pSocket != NULL; }
+
+   QByteArray& memory() { return m_memory; }
+   QList<FakeViceRequest>& requests() { return m_requests; }
+
+   // A whole response, and raw bytes written as they are.
+   static QByteArray response(int type,int error,uint32_t requestId,QByteArray body);
+   void send(QByteArray data);
+
+private slots:
+   void newConnection();
+   void readyRead();
+
+private:
+   QTcpServer  m_server;
+   QTcpSocket* m_pSocket;
+   QByteArray  m_received;
+   QByteArray  m_memory;
+   QList<FakeViceRequest> m_requests;
+};
+
+#endif // CFAKEVICE_H
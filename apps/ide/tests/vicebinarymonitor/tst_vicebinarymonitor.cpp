@@ -0,0 +1,186 @@
+#include <QtTest>
+
+#include "cvicebinarymonitor.h"
+#include "cfakevice.h"
+
+class ViceBinaryMonitorTest : public QObject
+{
+   Q_OBJECT
+
+private slots:
+   void init();
+   void cleanup();
+   void framing();
+   void changedMemoryFetch();
+
+private:
+   bool fetch(QByteArray* mirror);
+
+   CFakeVice*          m_pVice;
+   CViceBinaryMonitor* m_pMonitor;
+   CViceDirtyPages     m_dirtyPages;
+   uint                m_requestId;
+};
+
+// Runs the event loop until there are count signals in the spy, or a few
+// seconds have gone by.
+static bool waitFor(QSignalSpy& spy,int count)
+{
+   int waited;
+
+   for ( waited = 0; (spy.count() < count) && (waited < 5000); waited += 10 )
+   {
+      QTest::qWait(10);
+   }
+   return spy.count() >= count;
+}
+
+// Same, for requests to arrive at the fake VICE.
+static bool waitForRequests(CFakeVice* pVice,int count)
+{
+   int waited;
+
+   for ( waited = 0; (pVice->requests().count() < count) && (waited < 5000); waited += 10 )
+   {
+      QTest::qWait(10);
+   }
+   return pVice->requests().count() >= count;
+}
+
+void ViceBinaryMonitorTest::init()
+{
+   m_pVice = new CFakeVice();
+   QVERIFY(m_pVice->listen());
+   m_pMonitor = new CViceBinaryMonitor("127.0.0.1",m_pVice->port());
+   m_dirtyPages.markAll();
+   m_requestId = 1;
+}
+
+void ViceBinaryMonitorTest::cleanup()
+{
+   delete m_pMonitor;
+   delete m_pVice;
+}
+
+void ViceBinaryMonitorTest::framing()
+{
+   QSignalSpy connectedSpy(m_pMonitor,SIGNAL(monitorConnected()));
+   QSignalSpy responseSpy(m_pMonitor,SIGNAL(response(uint,int,int,QByteArray)));
+   QByteArray body;
+   QByteArray data;
+
+   // Made before the connection is up, so held until it is.
+   CViceBinaryMonitor::appendU8(body,VICE_RESET_SOFT);
+   m_pMonitor->sendCommand(0x12345678,VICE_CMD_RESET,body);
+   QVERIFY(waitFor(connectedSpy,1));
+   QVERIFY(waitForRequests(m_pVice,1));
+   QCOMPARE(m_pVice->requests().at(0).requestId,(uint32_t)0x12345678);
+   QCOMPARE(m_pVice->requests().at(0).command,VICE_CMD_RESET);
+   QCOMPARE(m_pVice->requests().at(0).body,body);
+
+   // A response that arrives in pieces comes out whole.
+   data = CFakeVice::response(VICE_CMD_RESET,VICE_ERROR_OK,0x12345678,QByteArray("abc"));
+   m_pVice->send(data.left(5));
+   QTest::qWait(50);
+   QCOMPARE(responseSpy.count(),0);
+   m_pVice->send(data.mid(5));
+   QVERIFY(waitFor(responseSpy,1));
+   QCOMPARE(responseSpy.at(0).at(0).toUInt(),(uint)0x12345678);
+   QCOMPARE(responseSpy.at(0).at(1).toInt(),VICE_CMD_RESET);
+   QCOMPARE(responseSpy.at(0).at(2).toInt(),VICE_ERROR_OK);
+   QCOMPARE(responseSpy.at(0).at(3).toByteArray(),QByteArray("abc"));
+
+   // Bytes ahead of the STX are skipped, and two responses in one write
+   // both come out.
+   data = QByteArray(1,'\xFF');
+   data += CFakeVice::response(VICE_RESPONSE_STOPPED,VICE_ERROR_OK,VICE_EVENT_ID,QByteArray("\x00\x10",2));
+   data += CFakeVice::response(VICE_RESPONSE_RESUMED,VICE_ERROR_OK,VICE_EVENT_ID,QByteArray("\x01\x10",2));
+   m_pVice->send(data);
+   QVERIFY(waitFor(responseSpy,3));
+   QCOMPARE(responseSpy.at(1).at(0).toUInt(),(uint)VICE_EVENT_ID);
+   QCOMPARE(responseSpy.at(1).at(1).toInt(),VICE_RESPONSE_STOPPED);
+   QCOMPARE(responseSpy.at(1).at(3).toByteArray(),QByteArray("\x00\x10",2));
+   QCOMPARE(responseSpy.at(2).at(1).toInt(),VICE_RESPONSE_RESUMED);
+   QCOMPARE(responseSpy.at(2).at(3).toByteArray(),QByteArray("\x01\x10",2));
+}
+
+// Fetches the dirty pages into the mirror the way the emulator thread does,
+// matching each response to the address its request started at.
+bool ViceBinaryMonitorTest::fetch(QByteArray* mirror)
+{
+   QSignalSpy responseSpy(m_pMonitor,SIGNAL(response(uint,int,int,QByteArray)));
+   QList<QByteArray> bodies;
+   QList<uint32_t> starts;
+   QMap<uint,uint32_t> requests;
+   QByteArray body;
+   int idx;
+
+   bodies = m_dirtyPages.take(&starts);
+   for ( idx = 0; idx < bodies.count(); idx++ )
+   {
+      requests.insert(m_requestId,starts.at(idx));
+      m_pMonitor->sendCommand(m_requestId++,VICE_CMD_MEMORY_GET,bodies.at(idx));
+   }
+   if ( !waitFor(responseSpy,bodies.count()) )
+   {
+      return false;
+   }
+
+   for ( idx = 0; idx < responseSpy.count(); idx++ )
+   {
+      if ( (responseSpy.at(idx).at(1).toInt() != VICE_CMD_MEMORY_GET) ||
+           (!requests.contains(responseSpy.at(idx).at(0).toUInt())) )
+      {
+         return false;
+      }
+      body = responseSpy.at(idx).at(3).toByteArray();
+      mirror->replace(requests.value(responseSpy.at(idx).at(0).toUInt()),
+                      CViceBinaryMonitor::getU16(body,0),
+                      body.mid(2));
+   }
+   return true;
+}
+
+void ViceBinaryMonitorTest::changedMemoryFetch()
+{
+   QByteArray mirror(0x10000,0);
+   int idx;
+
+   // Everything is dirty to start with, fetched a quarter at a time.
+   QVERIFY(fetch(&mirror));
+   QCOMPARE(m_pVice->requests().count(),4);
+   for ( idx = 0; idx < 4; idx++ )
+   {
+      QCOMPARE(CViceBinaryMonitor::getU16(m_pVice->requests().at(idx).body,1),(uint16_t)(idx*0x4000));
+      QCOMPARE(CViceBinaryMonitor::getU16(m_pVice->requests().at(idx).body,3),(uint16_t)(idx*0x4000+0x3FFF));
+   }
+   QVERIFY(mirror == m_pVice->memory());
+
+   // Nothing changed, nothing fetched; marking nothing changes nothing.
+   QList<uint32_t> starts;
+   QVERIFY(m_dirtyPages.take(&starts).isEmpty());
+   m_dirtyPages.mark(0x0000,0);
+   m_dirtyPages.mark(0x3000,0);
+   QVERIFY(m_dirtyPages.take(&starts).isEmpty());
+
+   // Only the pages that changed are fetched again.
+   m_pVice->requests().clear();
+   m_pVice->memory()[0x2010] = 0x5A;
+   m_pVice->memory()[0xD020] = 0x0E;
+   m_pVice->memory()[0xD0FF] = 0x01;
+   m_dirtyPages.mark(0x2010,1);
+   m_dirtyPages.mark(0xD020,0xE0);
+   QVERIFY(m_dirtyPages.isDirty(0x20FF));
+   QVERIFY(!m_dirtyPages.isDirty(0x2100));
+   QVERIFY(fetch(&mirror));
+   QCOMPARE(m_pVice->requests().count(),2);
+   QCOMPARE(CViceBinaryMonitor::getU16(m_pVice->requests().at(0).body,1),(uint16_t)0x2000);
+   QCOMPARE(CViceBinaryMonitor::getU16(m_pVice->requests().at(0).body,3),(uint16_t)0x20FF);
+   QCOMPARE(CViceBinaryMonitor::getU16(m_pVice->requests().at(1).body,1),(uint16_t)0xD000);
+   QCOMPARE(CViceBinaryMonitor::getU16(m_pVice->requests().at(1).body,3),(uint16_t)0xD0FF);
+   QVERIFY(mirror == m_pVice->memory());
+}
+
+QTEST_MAIN(ViceBinaryMonitorTest)
+
+#include "tst_vicebinarymonitor.moc"
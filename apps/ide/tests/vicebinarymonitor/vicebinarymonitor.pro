@@ -0,0 +1,21 @@
+# Checks the VICE binary monitor connection against a fake VICE.
+QT += network testlib
+QT -= gui
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TOP = ../../../..
+
+TARGET = vicebinarymonitor
+
+INCLUDEPATH += ../../c64/emulator
+
+SOURCES += \
+   tst_vicebinarymonitor.cpp \
+   cfakevice.cpp \
+   ../../c64/emulator/cvicebinarymonitor.cpp
+
+HEADERS += \
+   cfakevice.h \
+   ../../c64/emulator/cvicebinarymonitor.h
@@ -4,9 +4,69 @@
 
 #include "appeventfilter.h"
 
+#include "nes_emulator_core.h"
+
+#include <stdio.h>
+
 // Cartridge for NES emulator.
 CCartridge* cartridge = NULL;
 
+// Plays a movie against a ROM without bringing up the UI and reports
+// the first frame the machine state didn't match the recording.
+static int verifyMovie(QString movieFileName, QString romFileName)
+{
+   int32_t b;
+   int32_t result;
+
+   MainWindow::loadCartridge(romFileName);
+   if ( (!cartridge) || (!cartridge->getNumPrgRomBanks()) )
+   {
+      fprintf(stderr,"%s: cannot load ROM\n",romFileName.toLatin1().constData());
+      return 2;
+   }
+
+   nesUnloadROM();
+   for ( b = 0; b < cartridge->getNumPrgRomBanks(); b++ )
+   {
+      nesLoadPRGROMBank(b,(uint8_t*)cartridge->getPointerToPrgRomBank(b));
+   }
+   for ( b = 0; b < cartridge->getNumChrRomBanks(); b++ )
+   {
+      nesLoadCHRROMBank(b,(uint8_t*)cartridge->getPointerToChrRomBank(b));
+   }
+   nesLoadROM();
+   if ( cartridge->getMirrorMode() == HorizontalMirroring )
+   {
+      nesSetHorizontalMirroring();
+   }
+   else if ( cartridge->getMirrorMode() == VerticalMirroring )
+   {
+      nesSetVerticalMirroring();
+   }
+   if ( cartridge->getFourScreen() )
+   {
+      nesSetFourScreen();
+   }
+   nesResetInitial(cartridge->getMapperNumber());
+
+   result = nesVerifyMovie(movieFileName.toLocal8Bit().constData());
+   switch ( result )
+   {
+      case MOVIE_IN_SYNC:
+         printf("%s: in sync for all %u frames\n",movieFileName.toLatin1().constData(),nesGetMovieLength());
+         return 0;
+      case MOVIE_LOAD_FAILED:
+         fprintf(stderr,"%s: cannot load movie\n",movieFileName.toLatin1().constData());
+         return 2;
+      case MOVIE_WRONG_ROM:
+         fprintf(stderr,"%s: not recorded with %s\n",movieFileName.toLatin1().constData(),romFileName.toLatin1().constData());
+         return 2;
+      default:
+         printf("%s: desync at frame %d\n",movieFileName.toLatin1().constData(),result);
+         return 1;
+   }
+}
+
 int main(int argc, char* argv[])
 {
    // Main window of application.
@@ -20,6 +80,19 @@ int main(int argc, char* argv[])
    QCoreApplication::setOrganizationDomain("nesicide.com");
    QCoreApplication::setApplicationName("NESICIDE");
 
+   // nes-emulator --verify-movie <movie> <rom.nes> checks a movie and exits.
+   QStringList args = QApplication::arguments();
+   int verifyIdx = args.indexOf("--verify-movie");
+   if ( verifyIdx >= 0 )
+   {
+      if ( verifyIdx+2 >= args.count() )
+      {
+         fprintf(stderr,"usage: %s --verify-movie <movie> <rom.nes>\n",argv[0]);
+         return 2;
+      }
+      return verifyMovie(args.at(verifyIdx+1),args.at(verifyIdx+2));
+   }
+
    // Set up default OpenGL format.
    QGLFormat fmt = QGLFormat::defaultFormat();
 
@@ -22,11 +22,13 @@ public:
    virtual ~MainWindow();
    static QWidget* me() { return _me; }
 
+   // Reads an iNES ROM into the global cartridge.
+   static void loadCartridge ( QString fileName );
+
 protected:
    void dragEnterEvent ( QDragEnterEvent* event );
    void dragMoveEvent ( QDragMoveEvent* event );
    void dropEvent ( QDropEvent* event );
-   void loadCartridge ( QString fileName );
    void saveEmulatorState(QString fileName);
 
 protected:
@@ -491,6 +491,14 @@ void CFile::Close()
       _qfile.close();
 }
 
+const BYTE* CFile::Map()
+{
+   if ( _qfile.isOpen() && _qfile.size() )
+      return _qfile.map(0,_qfile.size());
+   else
+      return NULL;
+}
+
 CRect::CRect( )
 {
    _rect.top = 0;
@@ -277,6 +277,10 @@ public:
    virtual ULONGLONG GetLength( ) const;
    virtual void Close();
 
+   // Maps the whole open file into memory [not in MFC].  Returns NULL if
+   // the file can't be mapped.  The mapping goes away when the file is closed.
+   const BYTE* Map();
+
 private:
    QFile _qfile;
 };
@@ -520,6 +524,11 @@ public:
    {
       _qpainter = new QPainter(widget);
    }
+
+   void attach(QPaintDevice* device)
+   {
+      _qpainter = new QPainter(device);
+   }
    
    void detach()
    {
@@ -721,6 +730,10 @@ public:
    {
       return SetWindowOrg(point.x,point.y);
    }
+   CPoint GetWindowOrg( ) const
+   {
+      return _windowOrg;
+   }
 
    BOOL TextOut(
       int x,
@@ -54,6 +54,7 @@ QString EmulatorPrefsDialog::viceOptions;
 QString EmulatorPrefsDialog::c64KernalROM;
 QString EmulatorPrefsDialog::c64BasicROM;
 QString EmulatorPrefsDialog::c64CharROM;
+bool EmulatorPrefsDialog::c64BuiltInEmulator;
 
 EmulatorPrefsDialog::EmulatorPrefsDialog(QString target,QWidget* parent) :
    QDialog(parent),
@@ -108,6 +109,7 @@ EmulatorPrefsDialog::EmulatorPrefsDialog(QString target,QWidget* parent) :
    ui->c64KernalROM->setText(c64KernalROM);
    ui->c64BasicROM->setText(c64BasicROM);
    ui->c64CharROM->setText(c64CharROM);
+   ui->c64BuiltInEmulator->setChecked(c64BuiltInEmulator);
 
    if ( !target.compare("nes",Qt::CaseInsensitive) )
    {
@@ -258,6 +260,7 @@ void EmulatorPrefsDialog::readSettings()
       c64CharROM = viceExecutable+QDir::separator()+"C64"+QDir::separator()+"Char.rom";
    }
 #endif
+   c64BuiltInEmulator = settings.value("C64BuiltInEmulator",QVariant(true)).toBool();
    settings.endGroup();
 }
 
@@ -428,6 +431,7 @@ void EmulatorPrefsDialog::writeSettings()
    c64KernalROM = ui->c64KernalROM->text();
    c64BasicROM = ui->c64BasicROM->text();
    c64CharROM = ui->c64CharROM->text();
+   c64BuiltInEmulator = ui->c64BuiltInEmulator->isChecked();
 
    // Then save locals to QSettings.
    settings.beginGroup("EmulatorPreferences/General");
@@ -518,6 +522,7 @@ void EmulatorPrefsDialog::writeSettings()
    settings.setValue("C64KernalROM",c64KernalROM);
    settings.setValue("C64BasicROM",c64BasicROM);
    settings.setValue("C64CharROM",c64CharROM);
+   settings.setValue("C64BuiltInEmulator",c64BuiltInEmulator);
    settings.endGroup();
 }
 
@@ -1178,3 +1183,8 @@ QString EmulatorPrefsDialog::getC64CharROM()
 {
    return c64CharROM;
 }
+
+bool EmulatorPrefsDialog::getC64BuiltInEmulator()
+{
+   return c64BuiltInEmulator;
+}
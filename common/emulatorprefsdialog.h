@@ -67,6 +67,7 @@ public:
    static QString getC64KernalROM();
    static QString getC64BasicROM();
    static QString getC64CharROM();
+   static bool getC64BuiltInEmulator();
 
    // Modifiers (only provided for settings that are also found in menus not just in this dialog)
    static void setTVStandard(int standard);
@@ -141,6 +142,7 @@ private:
    static QString c64KernalROM;
    static QString c64BasicROM;
    static QString c64CharROM;
+   static bool c64BuiltInEmulator;
 
    // Query flags.
    static bool controllersUpdated;
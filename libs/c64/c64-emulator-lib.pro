@@ -24,9 +24,19 @@ mac {
       OBJECTS_DIR = release
       QMAKE_CXXFLAGS_RELEASE -= -O2
       QMAKE_CXXFLAGS_RELEASE += -Os
+      NES_LIBS = -L$$TOP/libs/nes/release -lnes-emulator
    } else {
       DESTDIR = debug
       OBJECTS_DIR = debug
+      NES_LIBS = -L$$TOP/libs/nes/debug -lnes-emulator
+   }
+}
+
+win32 {
+   CONFIG(release, debug|release) {
+      NES_LIBS = -L$$TOP/libs/nes/release -lnes-emulator
+   } else {
+      NES_LIBS = -L$$TOP/libs/nes/debug -lnes-emulator
    }
 }
 
@@ -43,24 +53,38 @@ unix:!mac {
 
    target.path = $$BINDIR
    INSTALLS += target
+
+   NES_LIBS = -L$$TOP/libs/nes -lnes-emulator
 }
 
+# The execution tracer, code/data logger and breakpoint list the CPU uses
+# are the NES library's, so there's only one copy of them in a process that
+# loads both.
+LIBS += $$NES_LIBS
+
 INCLUDEPATH += . \
                ./common \
                ./emulator \
-               $$TOP/common
+               $$TOP/common \
+               $$TOP/libs/nes \
+               $$TOP/libs/nes/emulator
 
 SOURCES += \
-   $$TOP/common/cbreakpointinfo.cpp \
    c64_emulator_core.cpp \
+   emulator/cc64.cpp \
    emulator/cc646502.cpp \
    emulator/cc64breakpointinfo.cpp \
    common/cc64systempalette.cpp \
+   emulator/cc64vic.cpp \
+   emulator/cc64cia.cpp \
    emulator/cc64sid.cpp
 
 HEADERS +=\
    c64_emulator_core.h \
+   emulator/cc64.h \
    emulator/cc646502.h \
    emulator/cc64breakpointinfo.h \
    common/cc64systempalette.h \
+   emulator/cc64vic.h \
+   emulator/cc64cia.h \
    emulator/cc64sid.h
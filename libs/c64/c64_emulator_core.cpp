@@ -1,8 +1,13 @@
 #include "c64_emulator_core.h"
 
+#include "cc64.h"
 #include "cc646502.h"
+#include "cc64vic.h"
+#include "cc64cia.h"
 #include "cc64sid.h"
 
+#include "cc64systempalette.h"
+
 static char __emu_version__ [] = "V1.000"
 #if defined ( QT_NO_DEBUG )
 " RELEASE";
@@ -61,10 +66,111 @@ void c64GetPrintableAddressWithAbsolute ( char* buffer, uint32_t addr, uint32_t
 
 void c64EnableBreakpoints ( bool enable )
 {
+   CC64::BREAKPOINTS(enable);
 }
 
 void c64StepCpu ( void )
 {
+   CC64::STEPCPUBREAKPOINT();
+}
+
+void c64SetKernalROM ( uint8_t* data )
+{
+   CC64::KERNAL(data);
+}
+
+void c64SetBasicROM ( uint8_t* data )
+{
+   CC64::BASIC(data);
+}
+
+void c64SetCharROM ( uint8_t* data )
+{
+   CC64::CHARGEN(data);
+}
+
+void c64Reset ( void )
+{
+   CC64::RESET();
+}
+
+void c64Run ( uint32_t* joy )
+{
+   CC64::RUN(joy);
+}
+
+bool c64LoadPRG ( uint8_t* data, uint32_t size )
+{
+   uint32_t addr;
+   uint32_t end;
+   uint32_t idx;
+
+   if ( size < 2 )
+   {
+      return false;
+   }
+
+   addr = MAKE16(data[0],data[1]);
+   end = addr+(size-2);
+   if ( end > MEM_64KB )
+   {
+      return false;
+   }
+
+   for ( idx = 2; idx < size; idx++ )
+   {
+      CC646502::_MEM(addr+idx-2,data[idx]);
+   }
+
+   // A BASIC program also needs the end of program pointers moved past
+   // it, as the KERNAL's LOAD would do.
+   if ( addr == 0x0801 )
+   {
+      CC646502::_MEM(0x2D,end&0xFF);
+      CC646502::_MEM(0x2E,end>>8);
+      CC646502::_MEM(0x2F,end&0xFF);
+      CC646502::_MEM(0x30,end>>8);
+      CC646502::_MEM(0x31,end&0xFF);
+      CC646502::_MEM(0x32,end>>8);
+      CC646502::_MEM(0xAE,end&0xFF);
+      CC646502::_MEM(0xAF,end>>8);
+   }
+   return true;
+}
+
+void c64SetKeyboardMatrix ( uint8_t* matrix, bool restore )
+{
+   CC64::KEYBOARD(matrix,restore);
+}
+
+void c64SetTVOut ( int8_t* tv )
+{
+   CVIC::TV(tv);
+}
+
+int8_t* c64GetTVOut ( void )
+{
+   return CVIC::TV();
+}
+
+int32_t c64GetAudioSamplesAvailable ( void )
+{
+   return CSID::SAMPLESAVAILABLE();
+}
+
+uint8_t* c64GetAudioSamples ( uint16_t samples )
+{
+   return CSID::PLAY(samples);
+}
+
+void c64ClearAudioSamplesAvailable ( void )
+{
+   CSID::CLEARSAMPLESAVAILABLE();
+}
+
+uint32_t c64GetCPUCycle ( void )
+{
+   return CC64::_CYCLES();
 }
 
 CBreakpointInfo* c64GetBreakpointDatabase ( void )
@@ -72,6 +178,16 @@ CBreakpointInfo* c64GetBreakpointDatabase ( void )
    return CC646502::BREAKPOINTS();
 }
 
+int32_t c64GetSizeOfCpuBreakpointEventDatabase ( void )
+{
+   return CC646502::NUMBREAKPOINTEVENTS();
+}
+
+CBreakpointEventInfo** c64GetCpuBreakpointEventDatabase ( void )
+{
+   return CC646502::BREAKPOINTEVENTS();
+}
+
 CRegisterDatabase* c64GetCpuRegisterDatabase()
 {
    return CC646502::REGISTERS();
@@ -82,6 +198,11 @@ CMemoryDatabase* c64GetCpuMemoryDatabase()
    return CC646502::MEMORY();
 }
 
+CCodeDataLogger* c64GetCpuCodeDataLoggerDatabase ( void )
+{
+   return CC646502::LOGGER();
+}
+
 void c64Disassemble ()
 {
    CC646502::DISASSEMBLE();
@@ -210,65 +331,121 @@ uint32_t c64GetCPURegister( uint32_t addr )
 
 uint32_t c64GetCPUFlagNegative ( void )
 {
-   return 0;
+   return !!(CC646502::_F()&FLAG_N);
 }
 
 uint32_t c64GetCPUFlagOverflow ( void )
 {
-   return 0;
+   return !!(CC646502::_F()&FLAG_V);
 }
 
 uint32_t c64GetCPUFlagBreak ( void )
 {
-   return 0;
+   return !!(CC646502::_F()&FLAG_B);
 }
 
 uint32_t c64GetCPUFlagDecimal ( void )
 {
-   return 0;
+   return !!(CC646502::_F()&FLAG_D);
 }
 
 uint32_t c64GetCPUFlagInterrupt ( void )
 {
-   return 0;
+   return !!(CC646502::_F()&FLAG_I);
 }
 
 uint32_t c64GetCPUFlagZero ( void )
 {
-   return 0;
+   return !!(CC646502::_F()&FLAG_Z);
 }
 
 uint32_t c64GetCPUFlagCarry ( void )
 {
-   return 0;
+   return !!(CC646502::_F()&FLAG_C);
 }
 
 void c64SetCPUFlagNegative ( uint32_t set )
 {
+   if ( set )
+   {
+      CC646502::_F(CC646502::_F()|FLAG_N);
+   }
+   else
+   {
+      CC646502::_F(CC646502::_F()&(~FLAG_N));
+   }
 }
 
 void c64SetCPUFlagOverflow ( uint32_t set )
 {
+   if ( set )
+   {
+      CC646502::_F(CC646502::_F()|FLAG_V);
+   }
+   else
+   {
+      CC646502::_F(CC646502::_F()&(~FLAG_V));
+   }
 }
 
 void c64SetCPUFlagBreak ( uint32_t set )
 {
+   if ( set )
+   {
+      CC646502::_F(CC646502::_F()|FLAG_B);
+   }
+   else
+   {
+      CC646502::_F(CC646502::_F()&(~FLAG_B));
+   }
 }
 
 void c64SetCPUFlagDecimal ( uint32_t set )
 {
+   if ( set )
+   {
+      CC646502::_F(CC646502::_F()|FLAG_D);
+   }
+   else
+   {
+      CC646502::_F(CC646502::_F()&(~FLAG_D));
+   }
 }
 
 void c64SetCPUFlagInterrupt ( uint32_t set )
 {
+   if ( set )
+   {
+      CC646502::_F(CC646502::_F()|FLAG_I);
+   }
+   else
+   {
+      CC646502::_F(CC646502::_F()&(~FLAG_I));
+   }
 }
 
 void c64SetCPUFlagZero ( uint32_t set )
 {
+   if ( set )
+   {
+      CC646502::_F(CC646502::_F()|FLAG_Z);
+   }
+   else
+   {
+      CC646502::_F(CC646502::_F()&(~FLAG_Z));
+   }
 }
 
 void c64SetCPUFlagCarry ( uint32_t set )
 {
+   if ( set )
+   {
+      CC646502::_F(CC646502::_F()|FLAG_C);
+   }
+   else
+   {
+      CC646502::_F(CC646502::_F()&(~FLAG_C));
+   }
 }
 
 uint32_t c64GetMemory ( uint32_t addr )
@@ -283,20 +460,17 @@ void c64SetMemory ( uint32_t addr, uint32_t data )
 
 uint32_t c64GetPaletteRedComponent(uint32_t idx)
 {
-//   return CBasePalette::GetPaletteR(idx)&0xFF;
-   return 0;
+   return CBasePalette::GetPaletteR(idx)&0xFF;
 }
 
 uint32_t c64GetPaletteGreenComponent(uint32_t idx)
 {
-//   return CBasePalette::GetPaletteG(idx)&0xFF;
-   return 0;
+   return CBasePalette::GetPaletteG(idx)&0xFF;
 }
 
 uint32_t c64GetPaletteBlueComponent(uint32_t idx)
 {
-//   return CBasePalette::GetPaletteB(idx)&0xFF;
-   return 0;
+   return CBasePalette::GetPaletteB(idx)&0xFF;
 }
 
 void    c64SetPaletteRedComponent(uint32_t idx,uint32_t r)
@@ -345,15 +519,14 @@ void c64SetSID16Register ( uint32_t addr, uint32_t data )
 void c64GetCpuSnapshot(C64CpuStateSnapshot* pSnapshot)
 {
    int idx;
-//   pSnapshot->pc = CC646502::__PC();
-//   pSnapshot->pcAtSync = CC646502::__PCSYNC();
-//   pSnapshot->sp = CC646502::_SP();
-//   pSnapshot->a = CC646502::_A();
-//   pSnapshot->x = CC646502::_X();
-//   pSnapshot->y = CC646502::_Y();
-//   pSnapshot->f = CC646502::_F();
+   pSnapshot->pc = CC646502::__PC();
+   pSnapshot->sp = CC646502::_SP();
+   pSnapshot->a = CC646502::_A();
+   pSnapshot->x = CC646502::_X();
+   pSnapshot->y = CC646502::_Y();
+   pSnapshot->f = CC646502::_F();
    for ( idx = 0; idx < MEM_64KB; idx++ )
    {
-      *(pSnapshot->memory+idx) = 0;//CC646502::_MEM(idx);
+      *(pSnapshot->memory+idx) = CC64::PEEK(idx);
    }
 }
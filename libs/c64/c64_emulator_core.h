@@ -25,6 +25,18 @@ typedef enum
    eC64Memory_CPUregs
 } eC64MemoryType;
 
+// CPU breakpoint events.
+enum
+{
+   C64_CPU_EVENT_EXECUTE_EXACT = 0,
+   C64_CPU_EVENT_UNDOCUMENTED,
+   C64_CPU_EVENT_UNDOCUMENTED_EXACT,
+   C64_CPU_EVENT_RESET,
+   C64_CPU_EVENT_IRQ_ENTERED,
+   C64_CPU_EVENT_NMI_ENTERED,
+   NUM_C64_CPU_EVENTS
+};
+
 #define MAKE16(lo,hi) ((((lo)&0xFF)|(((hi)&0xFF)<<8)))
 
 // CPU interrupt vector memory addresses.
@@ -100,8 +112,36 @@ typedef enum
 #define MASK_64KB 0xFFFF
 #define SHIFT_64KB_8KB 13
 
-#define SID_BASE 0xd400
-#define SID_END  0xd420
+// PAL system timing.  The system clock is the CPU clock; the VIC-II
+// produces eight pixels per system cycle.
+#define C64_CPU_CLOCK_HZ     985248
+#define VIC_CYCLES_PER_LINE  63
+#define VIC_LINES_PER_FRAME  312
+#define VIC_CYCLES_PER_FRAME (VIC_CYCLES_PER_LINE*VIC_LINES_PER_FRAME)
+
+// Visible picture, including the border.
+#define C64_VISIBLE_X 384
+#define C64_VISIBLE_Y 272
+
+// Audio output.
+#define C64_SAMPLE_RATE 44100
+#define SID_SAMPLES     (C64_SAMPLE_RATE/50)
+
+// I/O area.
+#define VIC_BASE       0xd000
+#define SID_BASE       0xd400
+#define SID_END        0xd420
+#define COLOR_RAM_BASE 0xd800
+#define CIA1_BASE      0xdc00
+#define CIA2_BASE      0xdd00
+
+// Joystick bits, active high.  Each joystick's state is passed to
+// c64Run as one of these masks.
+#define C64_JOY_UP    0x01
+#define C64_JOY_DOWN  0x02
+#define C64_JOY_LEFT  0x04
+#define C64_JOY_RIGHT 0x08
+#define C64_JOY_FIRE  0x10
 
 // sprintf() replacement macros for speed.
 extern const char* hex_char;
@@ -138,8 +178,21 @@ void c64UnlockCoreMutex ( void );
 
 // Exported interfaces.
 // The following interfaces are to be used by a UI to interact with the emulation
-// core and perform the necessary steps to interact with the VICE C=64 remote
-// monitor.
+// core.  The core is a complete C=64; the ROM images are provided by the UI
+// before the first reset.
+void c64SetKernalROM ( uint8_t* data );
+void c64SetBasicROM ( uint8_t* data );
+void c64SetCharROM ( uint8_t* data );
+void c64Reset ( void );
+void c64Run ( uint32_t* joy );
+bool c64LoadPRG ( uint8_t* data, uint32_t size );
+void c64SetKeyboardMatrix ( uint8_t* matrix, bool restore );
+void c64SetTVOut ( int8_t* tv );
+int8_t* c64GetTVOut ( void );
+int32_t c64GetAudioSamplesAvailable ( void );
+uint8_t* c64GetAudioSamples ( uint16_t samples );
+void c64ClearAudioSamplesAvailable ( void );
+uint32_t c64GetCPUCycle ( void );
 
 // Internal debug interfaces.
 extern bool __c64debug;
@@ -148,6 +201,9 @@ void c64Break ( void );
 
 CBreakpointInfo* c64GetBreakpointDatabase ( void );
 
+int32_t c64GetSizeOfCpuBreakpointEventDatabase ( void );
+CBreakpointEventInfo** c64GetCpuBreakpointEventDatabase ( void );
+
 CRegisterDatabase* c64GetCpuRegisterDatabase ( void );
 
 CMemoryDatabase* c64GetCpuMemoryDatabase ( void );
@@ -37,24 +37,25 @@ inline uint8_t blue(uint32_t rgb)
    return (rgb>>8)&0xFF;
 }
 
+// The sixteen VIC-II colours, as measured from a PAL machine.
 uint32_t CBasePalette::m_paletteBase [ 16 ] =
 {
-   RGB_VALUE ( 102, 102, 102 ),
-   RGB_VALUE ( 0, 42, 136 ),
-   RGB_VALUE ( 20, 18, 167 ),
-   RGB_VALUE ( 59, 0, 164 ),
-   RGB_VALUE ( 92, 0, 126 ),
-   RGB_VALUE ( 110, 0, 64 ),
-   RGB_VALUE ( 108, 6, 0 ),
-   RGB_VALUE ( 86, 29, 0 ),
-   RGB_VALUE ( 51, 53, 0 ),
-   RGB_VALUE ( 11, 72, 0 ),
-   RGB_VALUE ( 0, 82, 0 ),
-   RGB_VALUE ( 0, 79, 8 ),
-   RGB_VALUE ( 0, 64, 77 ),
    RGB_VALUE ( 0, 0, 0 ),
-   RGB_VALUE ( 0, 0, 0 ),
-   RGB_VALUE ( 0, 0, 0 )
+   RGB_VALUE ( 255, 255, 255 ),
+   RGB_VALUE ( 104, 55, 43 ),
+   RGB_VALUE ( 112, 164, 178 ),
+   RGB_VALUE ( 111, 61, 134 ),
+   RGB_VALUE ( 88, 141, 67 ),
+   RGB_VALUE ( 53, 40, 121 ),
+   RGB_VALUE ( 184, 199, 111 ),
+   RGB_VALUE ( 111, 79, 37 ),
+   RGB_VALUE ( 67, 57, 0 ),
+   RGB_VALUE ( 154, 103, 89 ),
+   RGB_VALUE ( 68, 68, 68 ),
+   RGB_VALUE ( 108, 108, 108 ),
+   RGB_VALUE ( 154, 210, 132 ),
+   RGB_VALUE ( 108, 94, 181 ),
+   RGB_VALUE ( 149, 149, 149 )
 };
 
 int8_t   CBasePalette::m_paletteRGBs [ 16 ] [ 3 ];
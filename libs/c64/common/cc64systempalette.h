@@ -9,7 +9,7 @@
 #include <string.h> // for memcpy...
 #include <stdio.h> // for sprintf...
 
-#define RGB_VALUE(r,g,b) ( ((r&0xFF)<<24)|((g&0xFF)<<16)|((b&0xFF)<<8) )
+#define RGB_VALUE(r,g,b) ( (((uint32_t)r&0xFF)<<24)|((g&0xFF)<<16)|((b&0xFF)<<8) )
 
 class CBasePalette
 {
@@ -0,0 +1,583 @@
+//    NESICIDE - an IDE for the 8-bit NES.
+//    Copyright (C) 2009  Christopher S. Pow
+
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "cc64.h"
+
+#include "cc64vic.h"
+#include "cc64cia.h"
+#include "cc64sid.h"
+
+int32_t  CC64::m_bankType [] = { 0, };
+uint8_t* CC64::m_bankROM [] = { NULL, };
+uint8_t  CC64::m_portDirection = 0x2F;
+uint8_t  CC64::m_portData = 0x37;
+uint8_t  CC64::m_kernal [] = { 0, };
+uint8_t  CC64::m_basic [] = { 0, };
+uint8_t  CC64::m_chargen [] = { 0, };
+uint8_t  CC64::m_colorRAM [] = { 0, };
+uint32_t CC64::m_vicBank = 0;
+bool     CC64::m_restore = false;
+uint32_t CC64::m_cycles = 0;
+uint32_t CC64::m_frame = 0;
+
+CTracer* CC64::m_tracer = NULL;
+
+bool     CC64::m_bBreakpointsEnabled = true;
+bool     CC64::m_bAtBreakpoint = false;
+bool     CC64::m_bStepCPUBreakpoint = false;
+
+static CC64 __init __attribute__((unused));
+
+CC64::CC64()
+{
+   m_tracer = new CTracer();
+
+   BANKSWITCH ();
+}
+
+CC64::~CC64()
+{
+   delete m_tracer;
+}
+
+void CC64::BANKSWITCH ( void )
+{
+   // Unconnected port lines are pulled high.
+   uint8_t port = (m_portData&m_portDirection)|((~m_portDirection)&0x07);
+   bool    loram = !!(port&0x01);
+   bool    hiram = !!(port&0x02);
+   bool    charen = !!(port&0x04);
+   int32_t page;
+
+   for ( page = 0; page < 16; page++ )
+   {
+      m_bankType[page] = eBank_RAM;
+      m_bankROM[page] = NULL;
+   }
+
+   if ( loram && hiram )
+   {
+      m_bankType[0xA] = eBank_ROM;
+      m_bankROM[0xA] = m_basic;
+      m_bankType[0xB] = eBank_ROM;
+      m_bankROM[0xB] = m_basic+MEM_4KB;
+   }
+   if ( hiram )
+   {
+      m_bankType[0xE] = eBank_ROM;
+      m_bankROM[0xE] = m_kernal;
+      m_bankType[0xF] = eBank_ROM;
+      m_bankROM[0xF] = m_kernal+MEM_4KB;
+   }
+   if ( loram || hiram )
+   {
+      if ( charen )
+      {
+         m_bankType[0xD] = eBank_IO;
+      }
+      else
+      {
+         m_bankType[0xD] = eBank_ROM;
+         m_bankROM[0xD] = m_chargen;
+      }
+   }
+}
+
+void CC64::CYCLE ( void )
+{
+   CVIC::CYCLE ();
+   CCIA::CYCLE ();
+   CSID::CYCLE ();
+
+   m_cycles++;
+
+   // Interrupt lines are sampled at the end of every cycle.
+   CC646502::IRQ ( CVIC::IRQ() || CCIA::IRQ(CIA1) );
+   CC646502::NMI ( CCIA::IRQ(CIA2) || m_restore );
+   CC646502::POLL ();
+}
+
+uint8_t CC64::LOAD ( uint32_t addr, int8_t* pTarget )
+{
+   int32_t page = addr>>UPSHIFT_4KB;
+
+   // A read can't complete while the VIC-II has the bus.
+   while ( CVIC::BA() )
+   {
+      if ( c64IsDebuggable() )
+      {
+         m_tracer->AddStolenCycle ( m_cycles, eC64Source_CPU );
+      }
+      CYCLE ();
+   }
+
+   CYCLE ();
+
+   if ( addr < 0x0002 )
+   {
+      (*pTarget) = eTarget_IORegister;
+      if ( addr == 0x0000 )
+      {
+         return m_portDirection;
+      }
+      return (m_portData&m_portDirection)|((~m_portDirection)&0x17);
+   }
+
+   switch ( m_bankType[page] )
+   {
+      case eBank_ROM:
+         (*pTarget) = eTarget_Mapper;
+         return *(m_bankROM[page]+(addr&MASK_4KB));
+      case eBank_IO:
+         if ( addr < SID_BASE )
+         {
+            (*pTarget) = eTarget_PPURegister;
+            return CVIC::REG ( addr );
+         }
+         else if ( addr < COLOR_RAM_BASE )
+         {
+            (*pTarget) = eTarget_APURegister;
+            return CSID::REG ( addr );
+         }
+         else if ( addr < CIA1_BASE )
+         {
+            // The upper four bits of color RAM aren't connected.
+            (*pTarget) = eTarget_RAM;
+            return (CVIC::LASTFETCH()&0xF0)|COLORRAM(addr);
+         }
+         else if ( addr < CIA2_BASE )
+         {
+            (*pTarget) = eTarget_IORegister;
+            return CCIA::REG ( CIA1, addr );
+         }
+         else if ( addr < 0xDE00 )
+         {
+            (*pTarget) = eTarget_IORegister;
+            return CCIA::REG ( CIA2, addr );
+         }
+         // Nothing is connected to the expansion port's I/O areas.
+         (*pTarget) = eTarget_Unknown;
+         return CVIC::LASTFETCH();
+      default:
+         (*pTarget) = eTarget_RAM;
+         return CC646502::_MEM(addr);
+   }
+}
+
+void CC64::STORE ( uint32_t addr, uint8_t data, int8_t* pTarget )
+{
+   CYCLE ();
+
+   if ( addr < 0x0002 )
+   {
+      (*pTarget) = eTarget_IORegister;
+      if ( addr == 0x0000 )
+      {
+         m_portDirection = data;
+      }
+      else
+      {
+         m_portData = data;
+      }
+      BANKSWITCH ();
+
+      // The write also goes to the RAM beneath the port.
+      CC646502::_MEM(addr,data);
+      return;
+   }
+
+   if ( m_bankType[addr>>UPSHIFT_4KB] == eBank_IO )
+   {
+      if ( addr < SID_BASE )
+      {
+         (*pTarget) = eTarget_PPURegister;
+         CVIC::REG ( addr, data );
+      }
+      else if ( addr < COLOR_RAM_BASE )
+      {
+         (*pTarget) = eTarget_APURegister;
+         CSID::REG ( addr, data );
+      }
+      else if ( addr < CIA1_BASE )
+      {
+         (*pTarget) = eTarget_RAM;
+         COLORRAM ( addr, data );
+      }
+      else if ( addr < CIA2_BASE )
+      {
+         (*pTarget) = eTarget_IORegister;
+         CCIA::REG ( CIA1, addr, data );
+      }
+      else if ( addr < 0xDE00 )
+      {
+         (*pTarget) = eTarget_IORegister;
+         CCIA::REG ( CIA2, addr, data );
+      }
+      else
+      {
+         (*pTarget) = eTarget_Unknown;
+      }
+      return;
+   }
+
+   // Writes to ROM areas land in the RAM beneath.
+   (*pTarget) = eTarget_RAM;
+   CC646502::_MEM(addr,data);
+}
+
+uint8_t CC64::PEEK ( uint32_t addr )
+{
+   int32_t page = addr>>UPSHIFT_4KB;
+
+   if ( addr == 0x0000 )
+   {
+      return m_portDirection;
+   }
+   else if ( addr == 0x0001 )
+   {
+      return (m_portData&m_portDirection)|((~m_portDirection)&0x17);
+   }
+
+   switch ( m_bankType[page] )
+   {
+      case eBank_ROM:
+         return *(m_bankROM[page]+(addr&MASK_4KB));
+      case eBank_IO:
+         if ( addr < SID_BASE )
+         {
+            return CVIC::PEEK ( addr );
+         }
+         else if ( addr < COLOR_RAM_BASE )
+         {
+            return CSID::PEEK ( addr );
+         }
+         else if ( addr < CIA1_BASE )
+         {
+            return (CVIC::LASTFETCH()&0xF0)|COLORRAM(addr);
+         }
+         else if ( addr < CIA2_BASE )
+         {
+            return CCIA::PEEK ( CIA1, addr );
+         }
+         else if ( addr < 0xDE00 )
+         {
+            return CCIA::PEEK ( CIA2, addr );
+         }
+         return CVIC::LASTFETCH();
+      default:
+         return CC646502::_MEM(addr);
+   }
+}
+
+void CC64::KEYBOARD ( uint8_t* matrix, bool restore )
+{
+   CCIA::KEYBOARD ( matrix );
+   m_restore = restore;
+}
+
+void CC64::RESET ( void )
+{
+   uint32_t addr;
+
+   m_portDirection = 0x2F;
+   m_portData = 0x37;
+   BANKSWITCH ();
+
+   // RAM powers up in a pattern of alternating blocks of $00 and $FF.
+   for ( addr = 0; addr < MEM_64KB; addr++ )
+   {
+      CC646502::_MEM(addr,(addr&0x40)?0xFF:0x00);
+   }
+   memset(m_colorRAM,0,sizeof(m_colorRAM));
+
+   m_vicBank = 0;
+   m_restore = false;
+   m_cycles = 0;
+   m_frame = 0;
+
+   m_bAtBreakpoint = false;
+   m_bStepCPUBreakpoint = false;
+
+   if ( c64IsDebuggable() )
+   {
+      m_tracer->ClearSampleBuffer ();
+      CC646502::LOGGER()->ClearData ();
+   }
+
+   CVIC::RESET ();
+   CCIA::RESET ();
+   CSID::RESET ();
+   CC646502::RESET ();
+}
+
+void CC64::RUN ( uint32_t* joy )
+{
+   uint32_t frame = CVIC::_FRAME();
+
+   CCIA::JOY ( 0, *(joy+0) );
+   CCIA::JOY ( 1, *(joy+1) );
+
+   m_frame = frame;
+
+   if ( c64IsDebuggable() )
+   {
+      m_tracer->SetFrame ( m_frame );
+
+      // Emit start-of-frame indication to Tracer...
+      m_tracer->AddSample ( m_cycles, eTracer_StartPPUFrame, eC64Source_CPU, 0, 0, 0 );
+   }
+
+   // Run instructions until the VIC-II has finished the frame.
+   while ( CVIC::_FRAME() == frame )
+   {
+      CC646502::EXECUTE ();
+   }
+
+   // Bring the SID's output up to date for the audio output.
+   CSID::SYNC ();
+}
+
+void CC64::CHECKBREAKPOINT ( eBreakpointTarget target, eBreakpointType type, int32_t data, int32_t event )
+{
+   CBreakpointInfo* pBreakpoints = CC646502::BREAKPOINTS();
+   int32_t idx;
+   BreakpointInfo* pBreakpoint;
+   CRegisterData* pRegister;
+   CBitfieldData* pBitfield;
+   uint32_t addr = 0;
+   int32_t value = 0;
+   bool force = false;
+
+   // If stepping, break...
+   if ( (m_bStepCPUBreakpoint) &&
+        (target == eBreakInCPU) &&
+        (type == eBreakOnCPUExecution) )
+   {
+      m_bStepCPUBreakpoint = false;
+      force = true;
+   }
+   // For all breakpoints...if we're not stepping...
+   else
+   {
+      for ( idx = 0; idx < pBreakpoints->GetNumBreakpoints(); idx++ )
+      {
+         // Get breakpoint data...
+         pBreakpoint = pBreakpoints->GetBreakpoint(idx);
+
+         // Not hit yet...
+         pBreakpoint->hit = false;
+
+         // Is this breakpoint enabled?
+         if ( (pBreakpoint->enabled) && (pBreakpoint->target == target) )
+         {
+            // Promote "Access" types...
+            if ( (pBreakpoint->type == eBreakOnCPUMemoryAccess) &&
+                 ((type == eBreakOnCPUMemoryRead) || (type == eBreakOnCPUMemoryWrite)) )
+            {
+               type = eBreakOnCPUMemoryAccess;
+            }
+
+            if ( pBreakpoint->type == type )
+            {
+               switch ( pBreakpoint->type )
+               {
+                  case eBreakOnCPUExecution:
+                     addr = CC646502::__PCSYNC();
+
+                     if ( (addr >= pBreakpoint->item1) &&
+                          (addr <= pBreakpoint->item2) &&
+                          (((!pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask)) ||
+                           ((pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask) && ((addr&(~pBreakpoint->itemMask)) == 0))) )
+                     {
+                        pBreakpoint->itemActual = addr;
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     break;
+                  case eBreakOnCPUMemoryAccess:
+                  case eBreakOnCPUMemoryRead:
+                  case eBreakOnCPUMemoryWrite:
+                     addr = CC646502::_EA();
+
+                     if ( (addr >= pBreakpoint->item1) &&
+                          (addr <= pBreakpoint->item2) &&
+                          (((!pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask)) ||
+                           ((pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask) && ((addr&(~pBreakpoint->itemMask)) == 0))) )
+                     {
+                        pBreakpoint->itemActual = addr;
+
+                        if ( pBreakpoint->condition == eBreakIfAnything )
+                        {
+                           pBreakpoint->hit = true;
+                           force = true;
+                        }
+                        else if ( (pBreakpoint->condition == eBreakIfEqual) &&
+                                  (data == pBreakpoint->data) )
+                        {
+                           pBreakpoint->hit = true;
+                           force = true;
+                        }
+                        else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
+                                  (data != pBreakpoint->data) )
+                        {
+                           pBreakpoint->hit = true;
+                           force = true;
+                        }
+                        else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
+                                  (data < pBreakpoint->data) )
+                        {
+                           pBreakpoint->hit = true;
+                           force = true;
+                        }
+                        else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
+                                  (data > pBreakpoint->data) )
+                        {
+                           pBreakpoint->hit = true;
+                           force = true;
+                        }
+                        else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
+                                  (data&pBreakpoint->data) )
+                        {
+                           pBreakpoint->hit = true;
+                           force = true;
+                        }
+                        else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
+                                  (data&pBreakpoint->data) &&
+                                  ((data&(~pBreakpoint->data)) == 0) )
+                        {
+                           pBreakpoint->hit = true;
+                           force = true;
+                        }
+                     }
+                     break;
+                  case eBreakOnCPUState:
+
+                     // Is the breakpoint on this register?
+                     if ( pBreakpoint->item1 == (uint32_t)data )
+                     {
+                        pRegister = CC646502::REGISTERS()->GetRegister(pBreakpoint->item1);
+                        pBitfield = pRegister->GetBitfield(pBreakpoint->item2);
+
+                        // Get actual register data...
+                        switch ( pBreakpoint->item1 )
+                        {
+                           case CPU_PC:
+                              value = CC646502::__PC();
+                              break;
+                           case CPU_A:
+                              value = CC646502::_A();
+                              break;
+                           case CPU_X:
+                              value = CC646502::_X();
+                              break;
+                           case CPU_Y:
+                              value = CC646502::_Y();
+                              break;
+                           case CPU_SP:
+                              value = CC646502::_SP();
+                              break;
+                           case CPU_F:
+                              value = CC646502::_F();
+                              break;
+                        }
+
+                        if ( pBreakpoint->condition == eBreakIfAnything )
+                        {
+                           pBreakpoint->hit = true;
+                           force = true;
+                        }
+                        else if ( (pBreakpoint->condition == eBreakIfEqual) &&
+                                  (pBreakpoint->data == pBitfield->GetValueRaw(value)) )
+                        {
+                           pBreakpoint->hit = true;
+                           force = true;
+                        }
+                        else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
+                                  (pBreakpoint->data != pBitfield->GetValueRaw(value)) )
+                        {
+                           pBreakpoint->hit = true;
+                           force = true;
+                        }
+                        else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
+                                  (pBitfield->GetValueRaw(value) < pBreakpoint->data) )
+                        {
+                           pBreakpoint->hit = true;
+                           force = true;
+                        }
+                        else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
+                                  (pBitfield->GetValueRaw(value) > pBreakpoint->data) )
+                        {
+                           pBreakpoint->hit = true;
+                           force = true;
+                        }
+                        else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
+                                  (pBitfield->GetValueRaw(value)&pBreakpoint->data) &&
+                                  ((pBitfield->GetValueRaw(value)&(~pBreakpoint->data)) == 0) )
+                        {
+                           pBreakpoint->hit = true;
+                           force = true;
+                        }
+                        else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
+                                  (pBitfield->GetValueRaw(value)&pBreakpoint->data) )
+                        {
+                           pBreakpoint->hit = true;
+                           force = true;
+                        }
+                     }
+                     break;
+                  case eBreakOnCPUEvent:
+
+                     // If this is the right event to check, check it...
+                     if ( (pBreakpoint->event == event) && (pBreakpoint->pEvent) )
+                     {
+                        pBreakpoint->hit = pBreakpoint->pEvent->Evaluate(pBreakpoint,data);
+
+                        if ( pBreakpoint->hit )
+                        {
+                           force = true;
+                        }
+                     }
+                     break;
+                  default:
+                     // Only the CPU is checked for breakpoints.
+                     break;
+               }
+            }
+         }
+      }
+   }
+
+   if ( force )
+   {
+      FORCEBREAKPOINT();
+   }
+}
+
+void CC64::FORCEBREAKPOINT ( void )
+{
+   if ( m_bBreakpointsEnabled )
+   {
+      m_bAtBreakpoint = true;
+
+      // Hook back to IDE to force it to update...
+      c64Break();
+   }
+}
+
+CTracer* c64GetExecutionTracerDatabase ( void )
+{
+   return CC64::TRACER();
+}
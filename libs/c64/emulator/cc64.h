@@ -0,0 +1,180 @@
+#if !defined ( C64_H )
+#define C64_H
+
+#include "c64_emulator_core.h"
+
+#include "cc646502.h"
+
+#include "ctracer.h"
+
+// The CC64 class is the implementation of the C=64 as a complete
+// emulatable machine.  It owns the system bus: every CPU read or write
+// goes through LOAD or STORE, which clock the VIC-II, both CIAs and the
+// SID for one system cycle before the access is made.  This keeps the
+// chips in lock-step with the CPU at single cycle granularity, which is
+// what raster effects and timer-driven code rely on.
+//
+// The bus also implements the PLA: the CPU's processor port at $00/$01
+// selects whether BASIC, KERNAL, the character ROM and the I/O area are
+// visible in place of the RAM beneath them.  Writes always land in RAM
+// unless the I/O area is visible.
+//
+// The VIC-II takes the bus away from the CPU during badlines and sprite
+// DMA by pulling BA low.  A CPU read is held off until BA goes high again;
+// writes are allowed through, as the 6510 cannot be stopped during them.
+//
+// Like CNES, the C64 object holds the execution tracer and performs the
+// breakpoint checks for the CPU.
+class CC64
+{
+public:
+   CC64();
+   ~CC64();
+
+   // This method performs a full C=64 reset.  The ROMs must have been
+   // loaded beforehand for the CPU to find anything to run.
+   static void RESET ( void );
+
+   // This method emulates a PAL video frame and passes the current state
+   // of the joysticks to the emulation engine.
+   static void RUN ( uint32_t* joy );
+
+   // ROM images.
+   static void KERNAL ( uint8_t* data )
+   {
+      memcpy(m_kernal,data,MEM_8KB);
+   }
+   static void BASIC ( uint8_t* data )
+   {
+      memcpy(m_basic,data,MEM_8KB);
+   }
+   static void CHARGEN ( uint8_t* data )
+   {
+      memcpy(m_chargen,data,MEM_4KB);
+   }
+
+   // Bus cycles performed by the CPU.  The target is set to what was
+   // accessed, for the execution tracer.
+   static uint8_t LOAD ( uint32_t addr, int8_t* pTarget );
+   static void STORE ( uint32_t addr, uint8_t data, int8_t* pTarget );
+
+   // Return what the CPU would read at an address, without the side
+   // effects of reading I/O registers.  Used by the debugger.
+   static uint8_t PEEK ( uint32_t addr );
+
+   // Bus cycle performed by the VIC-II.  The address is the 14-bit address
+   // within the bank selected by CIA2.
+   static inline uint8_t VICLOAD ( uint32_t addr )
+   {
+      addr &= MASK_16KB;
+      if ( (!(m_vicBank&0x4000)) && ((addr&0x3000) == 0x1000) )
+      {
+         return *(m_chargen+(addr&MASK_4KB));
+      }
+      return CC646502::_MEM(m_vicBank|addr);
+   }
+
+   // Selects the 16KB bank the VIC-II sees.
+   static void VICBANK ( uint8_t bank )
+   {
+      m_vicBank = (bank&3)<<14;
+   }
+
+   // Color RAM is only four bits wide.
+   static inline uint8_t COLORRAM ( uint32_t addr )
+   {
+      return *(m_colorRAM+(addr&MASK_1KB));
+   }
+   static inline void COLORRAM ( uint32_t addr, uint8_t data )
+   {
+      *(m_colorRAM+(addr&MASK_1KB)) = data&0x0F;
+   }
+
+   // Keyboard state as an 8x8 matrix.  Each byte holds the keys of one
+   // column (driven by CIA1 port A) as set bits in row order (read on
+   // CIA1 port B).  RESTORE is wired to the NMI line and not the matrix.
+   static void KEYBOARD ( uint8_t* matrix, bool restore );
+
+   // Accessor method to retrieve the C64 object's frame counter.
+   static uint32_t FRAME ()
+   {
+      return m_frame;
+   }
+
+   // Number of system cycles since reset.
+   static uint32_t _CYCLES ( void )
+   {
+      return m_cycles;
+   }
+
+   // Accessor method to retrieve the execution tracer database.
+   static inline CTracer* TRACER ( void )
+   {
+      return m_tracer;
+   }
+
+   // Breakpoint handling, as for CNES.
+   static void BREAKPOINTS ( bool enable )
+   {
+      m_bBreakpointsEnabled = enable;
+   }
+   static void CHECKBREAKPOINT ( eBreakpointTarget target, eBreakpointType type = (eBreakpointType)-1, int32_t data = 0, int32_t event = 0 );
+   static void FORCEBREAKPOINT ( void );
+   static bool ATBREAKPOINT ( void )
+   {
+      return m_bAtBreakpoint;
+   }
+   static void CLEARBREAKPOINT ( void )
+   {
+      m_bAtBreakpoint = false;
+   }
+   static void STEPCPUBREAKPOINT ( void )
+   {
+      m_bStepCPUBreakpoint = true;
+   }
+
+protected:
+   // Clocks every chip other than the CPU through one system cycle.
+   static void CYCLE ( void );
+
+   // Recomputes what the CPU sees in each 4KB page from the processor port.
+   static void BANKSWITCH ( void );
+
+   // What the CPU sees in each 4KB page.
+   enum
+   {
+      eBank_RAM = 0,
+      eBank_ROM,
+      eBank_IO
+   };
+   static int32_t  m_bankType [ 16 ];
+   static uint8_t* m_bankROM [ 16 ];
+
+   // The processor port, data direction register at $00 and data at $01.
+   static uint8_t  m_portDirection;
+   static uint8_t  m_portData;
+
+   static uint8_t  m_kernal [ MEM_8KB ];
+   static uint8_t  m_basic [ MEM_8KB ];
+   static uint8_t  m_chargen [ MEM_4KB ];
+   static uint8_t  m_colorRAM [ MEM_1KB ];
+
+   static uint32_t m_vicBank;
+   static bool     m_restore;
+
+   static uint32_t m_cycles;
+   static uint32_t m_frame;
+
+   // The execution tracer database.
+   static CTracer* m_tracer;
+
+   // These flags determine the breakpoint state and behavior
+   // of the emulation engine.
+   static bool     m_bBreakpointsEnabled;
+   static bool     m_bAtBreakpoint;
+   static bool     m_bStepCPUBreakpoint;
+};
+
+CTracer* c64GetExecutionTracerDatabase ( void );
+
+#endif
@@ -15,6 +15,7 @@
 //    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "cc646502.h"
+#include "cc64.h"
 
 #include "c64_emulator_core.h"
 
@@ -110,6 +111,38 @@ static CMemoryDatabase* dbMemory = new CMemoryDatabase(eMemory_CPU,
 
 CMemoryDatabase* CC646502::m_dbMemory = dbMemory;
 
+// CPU Event breakpoints
+static bool c64CpuAlwaysFireEvent(BreakpointInfo*,int)
+{
+   // This breakpoint is checked in the right place
+   // so if this breakpoint is enabled it should always fire when called.
+   return true;
+}
+
+static bool c64CpuOpcodeExactEvent(BreakpointInfo* pBreakpoint,int data)
+{
+   // If opcode executing is one specified, break...
+   if ( pBreakpoint->item1 == (uint32_t)data )
+   {
+      return true;
+   }
+
+   return false;
+}
+
+static CBreakpointEventInfo* tblCPUEvents [] =
+{
+   new CBreakpointEventInfo("Specific Instruction Execution", c64CpuOpcodeExactEvent, 1, "Break if opcode %02X is executed", 16, "Opcode:"),
+   new CBreakpointEventInfo("Any Undocumented Instruction Execution", c64CpuAlwaysFireEvent, 0, "Break if any undocumented opcode is executed", 16),
+   new CBreakpointEventInfo("Specific Undocumented Instruction Execution", c64CpuOpcodeExactEvent, 1, "Break if undocumented opcode %02X is executed", 16, "Opcode:"),
+   new CBreakpointEventInfo("Reset", c64CpuAlwaysFireEvent, 0, "Break if CPU is reset", 10),
+   new CBreakpointEventInfo("IRQ Handler Entered", c64CpuAlwaysFireEvent, 0, "Break if CPU IRQ handler entered", 10),
+   new CBreakpointEventInfo("NMI Handler Entered", c64CpuAlwaysFireEvent, 0, "Break if CPU NMI handler entered", 10)
+};
+
+CBreakpointEventInfo** CC646502::m_tblBreakpointEvents = tblCPUEvents;
+int32_t                CC646502::m_numBreakpointEvents = NUM_C64_CPU_EVENTS;
+
 uint8_t*  CC646502::m_6502memory = NULL;
 uint8_t   CC646502::m_a;
 uint8_t   CC646502::m_x;
@@ -118,12 +151,23 @@ uint8_t   CC646502::m_f;
 uint16_t  CC646502::m_pc;
 uint8_t   CC646502::m_sp;
 uint32_t  CC646502::m_pcGoto = 0xFFFFFFFF;
+uint16_t  CC646502::m_pcSync = VECTOR_RESET;
+uint32_t  CC646502::m_ea = 0;
+uint32_t  CC646502::m_eaBase = 0;
+bool      CC646502::m_irqAsserted = false;
+bool      CC646502::m_irqCurrent = false;
+bool      CC646502::m_irqPrevious = false;
+bool      CC646502::m_nmiAsserted = false;
+bool      CC646502::m_nmiPending = false;
+bool      CC646502::m_nmiCurrent = false;
+bool      CC646502::m_nmiPrevious = false;
+bool      CC646502::m_jammed = false;
 
 #if 0
 CMarker*         CC646502::m_marker = NULL;
+#endif
 
 CCodeDataLogger* CC646502::m_logger = NULL;
-#endif
 
 uint8_t*   CC646502::m_RAMopcodeMask = NULL;
 char**     CC646502::m_RAMdisassembly = NULL;
@@ -425,6 +469,122 @@ static CC646502_opcode m_6502opcode [ 256 ] =
    { 0xFF, "INS", AM_ABSOLUTE_INDEXED_X, 7, false, true, 0x40 }  // INS - Absolute,X (undocumented)
 };
 
+// Instructions, as named in the opcode table.
+enum
+{
+   eInstr_ADC = 0,
+   eInstr_ALR,
+   eInstr_ANC,
+   eInstr_AND,
+   eInstr_ARR,
+   eInstr_ASL,
+   eInstr_ASO,
+   eInstr_AXA,
+   eInstr_AXS,
+   eInstr_BCC,
+   eInstr_BCS,
+   eInstr_BEQ,
+   eInstr_BIT,
+   eInstr_BMI,
+   eInstr_BNE,
+   eInstr_BPL,
+   eInstr_BRK,
+   eInstr_BVC,
+   eInstr_BVS,
+   eInstr_CLC,
+   eInstr_CLD,
+   eInstr_CLI,
+   eInstr_CLV,
+   eInstr_CMP,
+   eInstr_CPX,
+   eInstr_CPY,
+   eInstr_DCM,
+   eInstr_DEC,
+   eInstr_DEX,
+   eInstr_DEY,
+   eInstr_DOP,
+   eInstr_EOR,
+   eInstr_INC,
+   eInstr_INS,
+   eInstr_INX,
+   eInstr_INY,
+   eInstr_JMP,
+   eInstr_JSR,
+   eInstr_KIL,
+   eInstr_LAS,
+   eInstr_LAX,
+   eInstr_LDA,
+   eInstr_LDX,
+   eInstr_LDY,
+   eInstr_LSE,
+   eInstr_LSR,
+   eInstr_NOP,
+   eInstr_OAL,
+   eInstr_ORA,
+   eInstr_PHA,
+   eInstr_PHP,
+   eInstr_PLA,
+   eInstr_PLP,
+   eInstr_RLA,
+   eInstr_ROL,
+   eInstr_ROR,
+   eInstr_RRA,
+   eInstr_RTI,
+   eInstr_RTS,
+   eInstr_SAX,
+   eInstr_SAY,
+   eInstr_SBC,
+   eInstr_SEC,
+   eInstr_SED,
+   eInstr_SEI,
+   eInstr_STA,
+   eInstr_STX,
+   eInstr_STY,
+   eInstr_TAS,
+   eInstr_TAX,
+   eInstr_TAY,
+   eInstr_TOP,
+   eInstr_TSX,
+   eInstr_TXA,
+   eInstr_TXS,
+   eInstr_TYA,
+   eInstr_XAA,
+   eInstr_XAS,
+   NUM_INSTRUCTIONS
+};
+
+static const char* instructionNames [ NUM_INSTRUCTIONS ] =
+{
+   "ADC", "ALR", "ANC", "AND", "ARR", "ASL", "ASO", "AXA",
+   "AXS", "BCC", "BCS", "BEQ", "BIT", "BMI", "BNE", "BPL",
+   "BRK", "BVC", "BVS", "CLC", "CLD", "CLI", "CLV", "CMP",
+   "CPX", "CPY", "DCM", "DEC", "DEX", "DEY", "DOP", "EOR",
+   "INC", "INS", "INX", "INY", "JMP", "JSR", "KIL", "LAS",
+   "LAX", "LDA", "LDX", "LDY", "LSE", "LSR", "NOP", "OAL",
+   "ORA", "PHA", "PHP", "PLA", "PLP", "RLA", "ROL", "ROR",
+   "RRA", "RTI", "RTS", "SAX", "SAY", "SBC", "SEC", "SED",
+   "SEI", "STA", "STX", "STY", "TAS", "TAX", "TAY", "TOP",
+   "TSX", "TXA", "TXS", "TYA", "XAA", "XAS"
+};
+
+static uint8_t m_6502instruction [ 256 ];
+
+static uint8_t INSTRUCTION ( const char* name )
+{
+   int32_t instr;
+
+   for ( instr = 0; instr < NUM_INSTRUCTIONS; instr++ )
+   {
+      if ( !strcmp(name,instructionNames[instr]) )
+      {
+         return instr;
+      }
+   }
+
+   // Every opcode is named, this is just for safety.
+   return eInstr_KIL;
+}
+
 static CC646502 __init __attribute((unused));
 
 CC646502::CC646502()
@@ -444,11 +604,17 @@ CC646502::CC646502()
 
    m_6502memory = new uint8_t[MEM_64KB];
 
-#if 0
-   m_logger = new CCodeDataLogger ( MEM_32KB, MASK_32KB );
+   m_logger = new CCodeDataLogger ( MEM_64KB, MASK_64KB );
 
+#if 0
    m_marker = new CMarker;
 #endif
+
+   // Work out what each opcode does from its name.
+   for ( addr = 0; addr < 256; addr++ )
+   {
+      m_6502instruction[addr] = INSTRUCTION(m_6502opcode[addr].name);
+   }
 }
 
 CC646502::~CC646502()
@@ -468,9 +634,9 @@ CC646502::~CC646502()
 
    delete [] m_6502memory;
 
-#if 0
    delete m_logger;
 
+#if 0
    delete m_marker;
 #endif
 }
@@ -612,3 +778,859 @@ void CC646502::DISASSEMBLE ( char** disassembly, uint8_t* binary, int32_t binary
       (*sourceLength)++;
    }
 }
+
+uint8_t CC646502::CC64LOAD ( uint32_t addr, int8_t* pTarget )
+{
+   return CC64::LOAD ( addr, pTarget );
+}
+
+void CC646502::CC64STORE ( uint32_t addr, uint8_t data, int8_t* pTarget )
+{
+   CC64::STORE ( addr, data, pTarget );
+}
+
+uint8_t CC646502::FETCH ( void )
+{
+   int8_t target;
+   uint8_t data = CC64LOAD ( m_pc, &target );
+
+   if ( c64IsDebuggable() )
+   {
+      CC64::TRACER()->AddSample ( CC64::_CYCLES(), eTracer_OperandFetch, eC64Source_CPU, target, m_pc, data );
+      m_logger->LogAccess ( CC64::_CYCLES(), m_pc, data, eLogger_OperandFetch, eC64Source_CPU );
+   }
+
+   m_pc++;
+
+   return data;
+}
+
+uint8_t CC646502::READ ( uint32_t addr )
+{
+   int8_t target;
+   uint8_t data;
+
+   m_ea = addr;
+
+   data = CC64LOAD ( addr, &target );
+
+   if ( c64IsDebuggable() )
+   {
+      CC64::TRACER()->AddSample ( CC64::_CYCLES(), eTracer_DataRead, eC64Source_CPU, target, addr, data );
+      m_logger->LogAccess ( CC64::_CYCLES(), addr, data, eLogger_DataRead, eC64Source_CPU );
+
+      CC64::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUMemoryRead, data );
+   }
+
+   return data;
+}
+
+void CC646502::WRITE ( uint32_t addr, uint8_t data )
+{
+   int8_t target;
+
+   m_ea = addr;
+
+   CC64STORE ( addr, data, &target );
+
+   if ( c64IsDebuggable() )
+   {
+      CC64::TRACER()->AddSample ( CC64::_CYCLES(), eTracer_DataWrite, eC64Source_CPU, target, addr, data );
+      m_logger->LogAccess ( CC64::_CYCLES(), addr, data, eLogger_DataWrite, eC64Source_CPU );
+
+      CC64::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUMemoryWrite, data );
+   }
+}
+
+void CC646502::RESET ( void )
+{
+   int8_t target;
+
+   m_a = 0;
+   m_x = 0;
+   m_y = 0;
+   m_f = FLAG_I|FLAG_MISC;
+   m_sp = 0xFD;
+
+   m_irqAsserted = false;
+   m_irqCurrent = false;
+   m_irqPrevious = false;
+   m_nmiAsserted = false;
+   m_nmiPending = false;
+   m_nmiCurrent = false;
+   m_nmiPrevious = false;
+   m_jammed = false;
+
+   if ( c64IsDebuggable() )
+   {
+      CC64::TRACER()->AddRESET ();
+      CC64::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUEvent, 0, C64_CPU_EVENT_RESET );
+   }
+
+   // The reset sequence is seven cycles, the last two fetch the vector.
+   m_pc = CC64LOAD(VECTOR_RESET,&target);
+   m_pc |= (CC64LOAD(VECTOR_RESET+1,&target)<<8);
+
+   m_pcSync = m_pc;
+}
+
+uint32_t CC646502::ADDRESS ( int32_t amode, bool alwaysFixup )
+{
+   uint32_t addr;
+   uint8_t  index;
+   uint8_t  ptr;
+
+   switch ( amode )
+   {
+      case AM_ZEROPAGE:
+         addr = FETCH();
+         m_eaBase = addr;
+         break;
+
+      case AM_ZEROPAGE_INDEXED_X:
+      case AM_ZEROPAGE_INDEXED_Y:
+         addr = FETCH();
+         m_eaBase = addr;
+         DUMMYREAD ( addr );
+         addr = (addr+((amode == AM_ZEROPAGE_INDEXED_X)?m_x:m_y))&0xFF;
+         break;
+
+      case AM_ABSOLUTE:
+         addr = FETCH();
+         addr |= (FETCH()<<8);
+         m_eaBase = addr;
+         break;
+
+      case AM_ABSOLUTE_INDEXED_X:
+      case AM_ABSOLUTE_INDEXED_Y:
+         index = (amode == AM_ABSOLUTE_INDEXED_X)?m_x:m_y;
+         m_eaBase = FETCH();
+         m_eaBase |= (FETCH()<<8);
+         addr = (m_eaBase+index)&MASK_64KB;
+
+         // The CPU first reads with the high byte not yet fixed up.
+         if ( alwaysFixup || ((addr&0xFF00) != (m_eaBase&0xFF00)) )
+         {
+            DUMMYREAD ( (m_eaBase&0xFF00)|(addr&0xFF) );
+         }
+         break;
+
+      case AM_PREINDEXED_INDIRECT:
+         ptr = FETCH();
+         DUMMYREAD ( ptr );
+         ptr += m_x;
+         addr = READ ( ptr );
+         ptr++;
+         addr |= (READ(ptr)<<8);
+         m_eaBase = addr;
+         break;
+
+      case AM_POSTINDEXED_INDIRECT:
+         ptr = FETCH();
+         m_eaBase = READ ( ptr );
+         ptr++;
+         m_eaBase |= (READ(ptr)<<8);
+         addr = (m_eaBase+m_y)&MASK_64KB;
+
+         if ( alwaysFixup || ((addr&0xFF00) != (m_eaBase&0xFF00)) )
+         {
+            DUMMYREAD ( (m_eaBase&0xFF00)|(addr&0xFF) );
+         }
+         break;
+
+      default:
+         // Immediate operands are read from the instruction stream.
+         addr = m_pc;
+         m_pc++;
+         m_eaBase = addr;
+         break;
+   }
+
+   return addr;
+}
+
+void CC646502::INTERRUPT ( uint16_t vector, bool brk )
+{
+   uint8_t f = m_f|FLAG_MISC;
+
+   if ( brk )
+   {
+      f |= FLAG_B;
+   }
+   else
+   {
+      f &= (~FLAG_B);
+   }
+
+   PUSH ( m_pc>>8 );
+   PUSH ( m_pc&0xFF );
+
+   // An NMI arriving while an IRQ or BRK is pushing the return address
+   // takes over the vector fetch.
+   if ( (vector != VECTOR_NMI) && m_nmiPending )
+   {
+      m_nmiPending = false;
+      vector = VECTOR_NMI;
+   }
+
+   PUSH ( f );
+
+   m_f |= FLAG_I;
+
+   m_pc = READ ( vector );
+   m_pc |= (READ(vector+1)<<8);
+}
+
+void CC646502::ADC ( uint8_t data )
+{
+   uint32_t result;
+   uint32_t lo;
+   uint8_t  carry = m_f&FLAG_C;
+
+   if ( m_f&FLAG_D )
+   {
+      // NMOS decimal mode, with its Z from the binary result and N and V
+      // from the result before the high nibble is adjusted.
+      lo = (m_a&0x0F)+(data&0x0F)+carry;
+      if ( lo >= 0x0A )
+      {
+         lo = ((lo+0x06)&0x0F)+0x10;
+      }
+      result = (m_a&0xF0)+(data&0xF0)+lo;
+
+      m_f &= (~(FLAG_N|FLAG_V|FLAG_Z|FLAG_C));
+      m_f |= (((m_a+data+carry)&0xFF)?0:FLAG_Z);
+      m_f |= (result&FLAG_N);
+      m_f |= ((~(m_a^data))&(m_a^result)&0x80)?FLAG_V:0;
+
+      if ( result >= 0xA0 )
+      {
+         result += 0x60;
+      }
+      m_f |= (result >= 0x100)?FLAG_C:0;
+
+      m_a = result&0xFF;
+   }
+   else
+   {
+      result = m_a+data+carry;
+
+      m_f &= (~(FLAG_V|FLAG_C));
+      m_f |= ((~(m_a^data))&(m_a^result)&0x80)?FLAG_V:0;
+      m_f |= (result >= 0x100)?FLAG_C:0;
+
+      m_a = result&0xFF;
+      NZ ( m_a );
+   }
+}
+
+void CC646502::SBC ( uint8_t data )
+{
+   int32_t  result;
+   int32_t  lo;
+   uint8_t  borrow = (m_f&FLAG_C)?0:1;
+   uint32_t binary = m_a-data-borrow;
+
+   // The flags always come from the binary result on the NMOS part.
+   m_f &= (~(FLAG_V|FLAG_C));
+   m_f |= ((m_a^data)&(m_a^binary)&0x80)?FLAG_V:0;
+   m_f |= (binary < 0x100)?FLAG_C:0;
+   NZ ( binary&0xFF );
+
+   if ( m_f&FLAG_D )
+   {
+      lo = (m_a&0x0F)-(data&0x0F)-borrow;
+      if ( lo < 0 )
+      {
+         lo = ((lo-0x06)&0x0F)-0x10;
+      }
+      result = (m_a&0xF0)-(data&0xF0)+lo;
+      if ( result < 0 )
+      {
+         result -= 0x60;
+      }
+
+      m_a = result&0xFF;
+   }
+   else
+   {
+      m_a = binary&0xFF;
+   }
+}
+
+void CC646502::COMPARE ( uint8_t reg, uint8_t data )
+{
+   m_f &= (~FLAG_C);
+   m_f |= (reg >= data)?FLAG_C:0;
+   NZ ( reg-data );
+}
+
+void CC646502::BRANCH ( bool taken )
+{
+   bool     irq = m_irqCurrent;
+   bool     nmi = m_nmiCurrent;
+   int8_t   offset = FETCH();
+   uint16_t target;
+
+   if ( taken )
+   {
+      DUMMYREAD ( m_pc );
+
+      target = m_pc+offset;
+
+      if ( (target&0xFF00) != (m_pc&0xFF00) )
+      {
+         DUMMYREAD ( (m_pc&0xFF00)|(target&0xFF) );
+      }
+      else
+      {
+         // A taken branch that stays in its page doesn't poll the
+         // interrupt lines on its extra cycle.
+         m_irqPrevious = irq;
+         m_nmiPrevious = nmi;
+      }
+
+      m_pc = target;
+   }
+}
+
+void CC646502::EXECUTE ( void )
+{
+   CC646502_opcode* pOp;
+   TracerInfo* pSample = NULL;
+   uint8_t  opcode [ 3 ];
+   uint8_t  op;
+   uint8_t  instr;
+   uint8_t  data;
+   uint8_t  result;
+   uint8_t  carry;
+   uint32_t addr = 0;
+   int8_t   target;
+
+   if ( m_jammed )
+   {
+      // A jammed CPU keeps the bus busy with nothing useful.
+      DUMMYREAD ( 0xFFFF );
+      return;
+   }
+
+   // Take an interrupt recognized at the end of the last instruction.
+   if ( m_nmiPrevious || m_irqPrevious )
+   {
+      DUMMYREAD ( m_pc );
+      DUMMYREAD ( m_pc );
+
+      if ( m_nmiPrevious )
+      {
+         m_nmiPending = false;
+
+         if ( c64IsDebuggable() )
+         {
+            CC64::TRACER()->AddNMI ( CC64::_CYCLES(), eC64Source_CPU );
+         }
+
+         INTERRUPT ( VECTOR_NMI, false );
+
+         if ( c64IsDebuggable() )
+         {
+            CC64::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUEvent, 0, C64_CPU_EVENT_NMI_ENTERED );
+         }
+      }
+      else
+      {
+         if ( c64IsDebuggable() )
+         {
+            CC64::TRACER()->AddIRQ ( CC64::_CYCLES(), eC64Source_CPU );
+         }
+
+         INTERRUPT ( VECTOR_IRQ, false );
+
+         if ( c64IsDebuggable() )
+         {
+            CC64::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUEvent, 0, C64_CPU_EVENT_IRQ_ENTERED );
+         }
+      }
+
+      m_nmiPrevious = false;
+      m_irqPrevious = false;
+      return;
+   }
+
+   // Opcode fetch.
+   m_pcSync = m_pc;
+   op = CC64LOAD ( m_pc, &target );
+   pOp = m_6502opcode+op;
+   instr = m_6502instruction[op];
+
+   if ( c64IsDebuggable() )
+   {
+      pSample = CC64::TRACER()->AddSample ( CC64::_CYCLES(), eTracer_InstructionFetch, eC64Source_CPU, target, m_pc, op );
+      CC64::TRACER()->SetRegisters ( pSample, m_a, m_x, m_y, m_sp, m_f|FLAG_MISC );
+      m_logger->LogAccess ( CC64::_CYCLES(), m_pc, op, eLogger_InstructionFetch, eC64Source_CPU );
+
+      // Keep the runtime disassembly of what's executed.
+      opcode[0] = op;
+      opcode[1] = CC64::PEEK((m_pc+1)&MASK_64KB);
+      opcode[2] = CC64::PEEK((m_pc+2)&MASK_64KB);
+      CC64::TRACER()->SetDisassembly ( pSample, opcode );
+      OPCODEMASK ( m_pc, 1 );
+
+      if ( m_pc == m_pcGoto )
+      {
+         CC64::STEPCPUBREAKPOINT();
+         m_pcGoto = 0xFFFFFFFF;
+      }
+
+      CC64::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUExecution );
+
+      // Check for undocumented breakpoint...
+      if ( !pOp->documented )
+      {
+         CC64::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUEvent, 0, C64_CPU_EVENT_UNDOCUMENTED );
+         CC64::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUEvent, op, C64_CPU_EVENT_UNDOCUMENTED_EXACT );
+      }
+      else
+      {
+         CC64::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUEvent, op, C64_CPU_EVENT_EXECUTE_EXACT );
+      }
+   }
+
+   m_pc++;
+
+   switch ( instr )
+   {
+      // Loads and other instructions that only read their operand.
+      case eInstr_LDA:
+         m_a = READ(ADDRESS(pOp->amode,false));
+         NZ ( m_a );
+         break;
+      case eInstr_LDX:
+         m_x = READ(ADDRESS(pOp->amode,false));
+         NZ ( m_x );
+         break;
+      case eInstr_LDY:
+         m_y = READ(ADDRESS(pOp->amode,false));
+         NZ ( m_y );
+         break;
+      case eInstr_LAX:
+         m_a = READ(ADDRESS(pOp->amode,false));
+         m_x = m_a;
+         NZ ( m_a );
+         break;
+      case eInstr_AND:
+         m_a &= READ(ADDRESS(pOp->amode,false));
+         NZ ( m_a );
+         break;
+      case eInstr_ORA:
+         m_a |= READ(ADDRESS(pOp->amode,false));
+         NZ ( m_a );
+         break;
+      case eInstr_EOR:
+         m_a ^= READ(ADDRESS(pOp->amode,false));
+         NZ ( m_a );
+         break;
+      case eInstr_ADC:
+         ADC ( READ(ADDRESS(pOp->amode,false)) );
+         break;
+      case eInstr_SBC:
+         SBC ( READ(ADDRESS(pOp->amode,false)) );
+         break;
+      case eInstr_CMP:
+         COMPARE ( m_a, READ(ADDRESS(pOp->amode,false)) );
+         break;
+      case eInstr_CPX:
+         COMPARE ( m_x, READ(ADDRESS(pOp->amode,false)) );
+         break;
+      case eInstr_CPY:
+         COMPARE ( m_y, READ(ADDRESS(pOp->amode,false)) );
+         break;
+      case eInstr_BIT:
+         data = READ(ADDRESS(pOp->amode,false));
+         m_f &= (~(FLAG_N|FLAG_V|FLAG_Z));
+         m_f |= (data&(FLAG_N|FLAG_V));
+         m_f |= (m_a&data)?0:FLAG_Z;
+         break;
+      case eInstr_DOP:
+      case eInstr_TOP:
+         READ(ADDRESS(pOp->amode,false));
+         break;
+      case eInstr_ANC:
+         m_a &= READ(ADDRESS(pOp->amode,false));
+         NZ ( m_a );
+         m_f = (m_f&(~FLAG_C))|((m_a&0x80)?FLAG_C:0);
+         break;
+      case eInstr_ALR:
+         m_a &= READ(ADDRESS(pOp->amode,false));
+         m_f = (m_f&(~FLAG_C))|(m_a&FLAG_C);
+         m_a >>= 1;
+         NZ ( m_a );
+         break;
+      case eInstr_ARR:
+         data = m_a&READ(ADDRESS(pOp->amode,false));
+         carry = m_f&FLAG_C;
+         m_a = (data>>1)|(carry<<7);
+         NZ ( m_a );
+         m_f &= (~(FLAG_V|FLAG_C));
+         if ( m_f&FLAG_D )
+         {
+            m_f |= ((data^m_a)&0x40)?FLAG_V:0;
+            if ( ((data&0x0F)+(data&0x01)) > 0x05 )
+            {
+               m_a = (m_a&0xF0)|((m_a+0x06)&0x0F);
+            }
+            if ( ((data&0xF0)+(data&0x10)) > 0x50 )
+            {
+               m_a += 0x60;
+               m_f |= FLAG_C;
+            }
+         }
+         else
+         {
+            m_f |= (m_a&0x40)?FLAG_C:0;
+            m_f |= ((m_a^(m_a<<1))&0x40)?FLAG_V:0;
+         }
+         break;
+      case eInstr_XAA:
+         // The constant ORed in varies between chips.
+         m_a = (m_a|0xEE)&m_x&READ(ADDRESS(pOp->amode,false));
+         NZ ( m_a );
+         break;
+      case eInstr_OAL:
+         m_a = (m_a|0xEE)&READ(ADDRESS(pOp->amode,false));
+         m_x = m_a;
+         NZ ( m_a );
+         break;
+      case eInstr_SAX:
+         data = READ(ADDRESS(pOp->amode,false));
+         m_f = (m_f&(~FLAG_C))|(((m_a&m_x) >= data)?FLAG_C:0);
+         m_x = ((m_a&m_x)-data)&0xFF;
+         NZ ( m_x );
+         break;
+      case eInstr_LAS:
+         m_a = READ(ADDRESS(pOp->amode,false))&m_sp;
+         m_x = m_a;
+         m_sp = m_a;
+         NZ ( m_a );
+         break;
+
+      // Stores.
+      case eInstr_STA:
+         WRITE ( ADDRESS(pOp->amode,true), m_a );
+         break;
+      case eInstr_STX:
+         WRITE ( ADDRESS(pOp->amode,true), m_x );
+         break;
+      case eInstr_STY:
+         WRITE ( ADDRESS(pOp->amode,true), m_y );
+         break;
+      case eInstr_AXS:
+         WRITE ( ADDRESS(pOp->amode,true), m_a&m_x );
+         break;
+
+      // The unstable stores AND the value with the high byte of the base
+      // address plus one, and on a page crossing that value also becomes
+      // the high byte of the address written.
+      case eInstr_AXA:
+      case eInstr_SAY:
+      case eInstr_XAS:
+      case eInstr_TAS:
+         addr = ADDRESS(pOp->amode,true);
+         if ( instr == eInstr_AXA )
+         {
+            data = m_a&m_x;
+         }
+         else if ( instr == eInstr_SAY )
+         {
+            data = m_y;
+         }
+         else if ( instr == eInstr_XAS )
+         {
+            data = m_x;
+         }
+         else
+         {
+            m_sp = m_a&m_x;
+            data = m_sp;
+         }
+         data &= ((m_eaBase>>8)+1);
+         if ( (addr&0xFF00) != (m_eaBase&0xFF00) )
+         {
+            addr = (data<<8)|(addr&0xFF);
+         }
+         WRITE ( addr, data );
+         break;
+
+      // Read-modify-write.  The unmodified value is written back first.
+      case eInstr_ASL:
+      case eInstr_LSR:
+      case eInstr_ROL:
+      case eInstr_ROR:
+      case eInstr_INC:
+      case eInstr_DEC:
+      case eInstr_ASO:
+      case eInstr_RLA:
+      case eInstr_LSE:
+      case eInstr_RRA:
+      case eInstr_DCM:
+      case eInstr_INS:
+         if ( pOp->amode == AM_ACCUMULATOR )
+         {
+            DUMMYREAD ( m_pc );
+            data = m_a;
+         }
+         else
+         {
+            addr = ADDRESS(pOp->amode,true);
+            data = READ ( addr );
+            DUMMYWRITE ( addr, data );
+         }
+
+         carry = m_f&FLAG_C;
+         switch ( instr )
+         {
+            case eInstr_ASL:
+            case eInstr_ASO:
+               m_f = (m_f&(~FLAG_C))|(data>>7);
+               result = data<<1;
+               break;
+            case eInstr_LSR:
+            case eInstr_LSE:
+               m_f = (m_f&(~FLAG_C))|(data&FLAG_C);
+               result = data>>1;
+               break;
+            case eInstr_ROL:
+            case eInstr_RLA:
+               m_f = (m_f&(~FLAG_C))|(data>>7);
+               result = (data<<1)|carry;
+               break;
+            case eInstr_ROR:
+            case eInstr_RRA:
+               m_f = (m_f&(~FLAG_C))|(data&FLAG_C);
+               result = (data>>1)|(carry<<7);
+               break;
+            case eInstr_INC:
+            case eInstr_INS:
+               result = data+1;
+               break;
+            default:
+               result = data-1;
+               break;
+         }
+         NZ ( result );
+
+         if ( pOp->amode == AM_ACCUMULATOR )
+         {
+            m_a = result;
+         }
+         else
+         {
+            WRITE ( addr, result );
+         }
+
+         // The illegal ones go on to combine the result with A.
+         switch ( instr )
+         {
+            case eInstr_ASO:
+               m_a |= result;
+               NZ ( m_a );
+               break;
+            case eInstr_RLA:
+               m_a &= result;
+               NZ ( m_a );
+               break;
+            case eInstr_LSE:
+               m_a ^= result;
+               NZ ( m_a );
+               break;
+            case eInstr_RRA:
+               ADC ( result );
+               break;
+            case eInstr_DCM:
+               COMPARE ( m_a, result );
+               break;
+            case eInstr_INS:
+               SBC ( result );
+               break;
+         }
+         break;
+
+      // Implied.
+      case eInstr_NOP:
+      case eInstr_CLC:
+      case eInstr_SEC:
+      case eInstr_CLI:
+      case eInstr_SEI:
+      case eInstr_CLD:
+      case eInstr_SED:
+      case eInstr_CLV:
+      case eInstr_TAX:
+      case eInstr_TAY:
+      case eInstr_TXA:
+      case eInstr_TYA:
+      case eInstr_TSX:
+      case eInstr_TXS:
+      case eInstr_INX:
+      case eInstr_INY:
+      case eInstr_DEX:
+      case eInstr_DEY:
+         DUMMYREAD ( m_pc );
+         switch ( instr )
+         {
+            case eInstr_CLC:
+               m_f &= (~FLAG_C);
+               break;
+            case eInstr_SEC:
+               m_f |= FLAG_C;
+               break;
+            case eInstr_CLI:
+               m_f &= (~FLAG_I);
+               break;
+            case eInstr_SEI:
+               m_f |= FLAG_I;
+               break;
+            case eInstr_CLD:
+               m_f &= (~FLAG_D);
+               break;
+            case eInstr_SED:
+               m_f |= FLAG_D;
+               break;
+            case eInstr_CLV:
+               m_f &= (~FLAG_V);
+               break;
+            case eInstr_TAX:
+               m_x = m_a;
+               NZ ( m_x );
+               break;
+            case eInstr_TAY:
+               m_y = m_a;
+               NZ ( m_y );
+               break;
+            case eInstr_TXA:
+               m_a = m_x;
+               NZ ( m_a );
+               break;
+            case eInstr_TYA:
+               m_a = m_y;
+               NZ ( m_a );
+               break;
+            case eInstr_TSX:
+               m_x = m_sp;
+               NZ ( m_x );
+               break;
+            case eInstr_TXS:
+               m_sp = m_x;
+               break;
+            case eInstr_INX:
+               m_x++;
+               NZ ( m_x );
+               break;
+            case eInstr_INY:
+               m_y++;
+               NZ ( m_y );
+               break;
+            case eInstr_DEX:
+               m_x--;
+               NZ ( m_x );
+               break;
+            case eInstr_DEY:
+               m_y--;
+               NZ ( m_y );
+               break;
+         }
+         break;
+
+      // Branches.
+      case eInstr_BPL:
+         BRANCH ( !(m_f&FLAG_N) );
+         break;
+      case eInstr_BMI:
+         BRANCH ( m_f&FLAG_N );
+         break;
+      case eInstr_BVC:
+         BRANCH ( !(m_f&FLAG_V) );
+         break;
+      case eInstr_BVS:
+         BRANCH ( m_f&FLAG_V );
+         break;
+      case eInstr_BCC:
+         BRANCH ( !(m_f&FLAG_C) );
+         break;
+      case eInstr_BCS:
+         BRANCH ( m_f&FLAG_C );
+         break;
+      case eInstr_BNE:
+         BRANCH ( !(m_f&FLAG_Z) );
+         break;
+      case eInstr_BEQ:
+         BRANCH ( m_f&FLAG_Z );
+         break;
+
+      // Stack and flow control.
+      case eInstr_PHA:
+         DUMMYREAD ( m_pc );
+         PUSH ( m_a );
+         break;
+      case eInstr_PHP:
+         DUMMYREAD ( m_pc );
+         PUSH ( m_f|FLAG_B|FLAG_MISC );
+         break;
+      case eInstr_PLA:
+         DUMMYREAD ( m_pc );
+         DUMMYREAD ( 0x100|m_sp );
+         m_a = POP();
+         NZ ( m_a );
+         break;
+      case eInstr_PLP:
+         DUMMYREAD ( m_pc );
+         DUMMYREAD ( 0x100|m_sp );
+         m_f = (POP()&(~FLAG_B))|FLAG_MISC;
+         break;
+      case eInstr_JMP:
+         if ( pOp->amode == AM_INDIRECT )
+         {
+            addr = FETCH();
+            addr |= (FETCH()<<8);
+            m_pc = READ ( addr );
+            // The pointer's high byte doesn't carry into the next page.
+            m_pc |= (READ((addr&0xFF00)|((addr+1)&0xFF))<<8);
+         }
+         else
+         {
+            addr = FETCH();
+            addr |= (FETCH()<<8);
+            m_pc = addr;
+         }
+         break;
+      case eInstr_JSR:
+         addr = FETCH();
+         DUMMYREAD ( 0x100|m_sp );
+         PUSH ( m_pc>>8 );
+         PUSH ( m_pc&0xFF );
+         addr |= (FETCH()<<8);
+         m_pc = addr;
+         break;
+      case eInstr_RTS:
+         DUMMYREAD ( m_pc );
+         DUMMYREAD ( 0x100|m_sp );
+         m_pc = POP();
+         m_pc |= (POP()<<8);
+         DUMMYREAD ( m_pc );
+         m_pc++;
+         break;
+      case eInstr_RTI:
+         DUMMYREAD ( m_pc );
+         DUMMYREAD ( 0x100|m_sp );
+         m_f = (POP()&(~FLAG_B))|FLAG_MISC;
+         m_pc = POP();
+         m_pc |= (POP()<<8);
+         break;
+      case eInstr_BRK:
+         FETCH();
+         INTERRUPT ( VECTOR_IRQ, true );
+         break;
+      case eInstr_KIL:
+         m_jammed = true;
+         m_pc--;
+         break;
+   }
+}
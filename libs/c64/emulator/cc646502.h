@@ -4,43 +4,41 @@
 #include "c64_emulator_core.h"
 
 //#include "cmarker.h"
-//#include "ctracer.h"
-//#include "ccodedatalogger.h"
+#include "ctracer.h"
+#include "ccodedatalogger.h"
 #include "cregisterdata.h"
 #include "cmemorydata.h"
 #include "cc64breakpointinfo.h"
 
-// The CC646502 class is the implementation of the core CPU of the NES.
-// It provides CPU-fetch-cycle granular emulation of the CPU core, including
+#define FLAG_C    0x01
+#define FLAG_Z    0x02
+#define FLAG_I    0x04
+#define FLAG_D    0x08
+#define FLAG_B    0x10
+#define FLAG_MISC 0x20
+#define FLAG_V    0x40
+#define FLAG_N    0x80
+
+// The CC646502 class is the implementation of the 6510 CPU of the C=64.
+// It provides bus-cycle granular emulation of the CPU core, including
 // undocumented and illegal instructions.  It handles vectoring to
 // the three interrupt sources (reset, NMI, IRQ) at the appropriate
 // times.  It is implemented as a static object so that accesses to its
 // internal data via accessor functions does not require a class object.
 //
 // The class internally maintains the state of the CPU's registers
-// and of the 2KB of RAM that is on the NES mainboard, dedicated to the CPU.
+// and of the 64KB of RAM in the C=64.  ROM and I/O that may be banked in
+// over the RAM are the business of the C64 object's bus, see CC64.
 // The class also maintains several data structures used by debugger inspectors.
 //
-// CPU instruction dispatch is via a main execution method that is
-// invoked by other elements of the NES architecture (see PPU) whenever
-// there is at least one CPU cycle time that needs to be
-// executed.  This main execution method invokes a step method which
-// executes CPU instructions until there are no CPU cycles remaining.
-//
-// The execution step method performs the required number of instruction
-// fetch cycles (1, 2, or 3 depending on addressing mode of fetched opcode),
-// and then uses a table-of-function-pointers dispatch method
-// to execute instructions once the instruction fetch cycles are completed.
-// The step method returns control to the caller after each phase of the
-// instruction fetch to provide CPU-cycle granular accuracy with respect
-// to the calling element's cycle.  For example, if the PPU invokes the
-// CPU's execute method with only one CPU cycle needing to be executed, the
-// CPU will execute one fetch cycle and immediately return.  However,
-// if the CPU is ready to execute a fetched instruction it will finish the
-// execution of the instruction even though it was asked to only execute
-// one actual CPU cycle.  This is a limitation that could be removed in
-// future updates to the CPU core, but currently adequate accuracy is obtained
-// with this method.
+// EXECUTE runs one whole instruction.  Every cycle of the instruction,
+// including the dummy reads and writes the real CPU makes, is a separate
+// access on the C64 bus and the bus clocks the rest of the machine for
+// each one.  So although the CPU only returns to its caller at instruction
+// boundaries, every chip sees each access at the cycle it really happens.
+// Interrupt lines are sampled by the bus each cycle; the state at the end
+// of the second-to-last cycle of an instruction decides whether the
+// interrupt sequence runs next, as on the real CPU.
 class CC646502
 {
 public:
@@ -66,12 +64,49 @@ public:
    static void DISASSEMBLE ( char** disassembly, uint8_t* binary, int32_t binaryLength, uint8_t* opcodeMask, uint16_t* sloc2addr, uint32_t* addr2sloc, uint32_t* sourceLength );
    static char* Disassemble ( uint8_t* pOpcode, char* buffer );
 
-#if 0
    static inline CCodeDataLogger* LOGGER ( void )
    {
       return m_logger;
    }
-#endif
+
+   // Puts the CPU into its reset state and loads the PC from the reset
+   // vector.
+   static void RESET ( void );
+
+   // Executes one instruction, or the interrupt sequence if an interrupt
+   // was recognized at the end of the last instruction.
+   static void EXECUTE ( void );
+
+   // Interrupt inputs.  IRQ is level sensitive, NMI is edge sensitive.
+   static inline void IRQ ( bool asserted )
+   {
+      m_irqAsserted = asserted;
+   }
+   static inline void NMI ( bool asserted )
+   {
+      if ( asserted && (!m_nmiAsserted) )
+      {
+         m_nmiPending = true;
+      }
+      m_nmiAsserted = asserted;
+   }
+
+   // Called by the bus at the end of every cycle to sample the interrupt
+   // inputs.
+   static inline void POLL ( void )
+   {
+      m_irqPrevious = m_irqCurrent;
+      m_irqCurrent = m_irqAsserted && (!(m_f&FLAG_I));
+      m_nmiPrevious = m_nmiCurrent;
+      m_nmiCurrent = m_nmiPending;
+   }
+
+   // The CPU has executed one of the KIL opcodes and stopped.  Only reset
+   // gets it going again.
+   static inline bool JAMMED ( void )
+   {
+      return m_jammed;
+   }
 
    static void GOTO ( uint32_t pcGoto )
    {
@@ -91,6 +126,14 @@ public:
    {
       return m_pc;
    }
+   static uint32_t __PCSYNC ( void )
+   {
+      return m_pcSync;
+   }
+   static uint32_t _EA ( void )
+   {
+      return m_ea;
+   }
    static void __PC ( uint16_t pc )
    {
       m_pc = pc;
@@ -176,6 +219,18 @@ public:
       return m_breakpoints;
    }
 
+   // Interface to retrieve the database of CPU core
+   // breakpoint events.  CPU breakpoint events are declared in
+   // the source file.
+   static CBreakpointEventInfo** BREAKPOINTEVENTS()
+   {
+      return m_tblBreakpointEvents;
+   }
+   static int32_t NUMBREAKPOINTEVENTS()
+   {
+      return m_numBreakpointEvents;
+   }
+
    // The following routines are support for the runtime
    // disassembly of RAM if it is executed by the CPU core.
    // An "opcode mask" is tracked for each byte of accessible
@@ -220,6 +275,54 @@ public:
    }
 
 protected:
+   // Bus cycles.  Dummy accesses have the same effect on the machine as
+   // the real ones but aren't traced or checked for breakpoints.
+   static uint8_t FETCH ( void );
+   static uint8_t READ ( uint32_t addr );
+   static void WRITE ( uint32_t addr, uint8_t data );
+   static inline uint8_t DUMMYREAD ( uint32_t addr )
+   {
+      int8_t target;
+      return CC64LOAD ( addr, &target );
+   }
+   static inline void DUMMYWRITE ( uint32_t addr, uint8_t data )
+   {
+      int8_t target;
+      CC64STORE ( addr, data, &target );
+   }
+   static inline void PUSH ( uint8_t data )
+   {
+      WRITE ( 0x100|m_sp, data );
+      m_sp--;
+   }
+   static inline uint8_t POP ( void )
+   {
+      m_sp++;
+      return READ ( 0x100|m_sp );
+   }
+   static uint8_t CC64LOAD ( uint32_t addr, int8_t* pTarget );
+   static void CC64STORE ( uint32_t addr, uint8_t data, int8_t* pTarget );
+
+   // Works out the effective address of the current instruction's operand,
+   // doing the bus cycles the real CPU does along the way.  For the indexed
+   // modes a read instruction only pays for the dummy read when the index
+   // crosses a page, a read-modify-write or write instruction always does.
+   static uint32_t ADDRESS ( int32_t amode, bool alwaysFixup );
+
+   // Runs the interrupt sequence through the given vector.  BRK shares
+   // it, with the B flag set in the pushed flags.
+   static void INTERRUPT ( uint16_t vector, bool brk );
+
+   // Arithmetic shared by several instructions.
+   static void ADC ( uint8_t data );
+   static void SBC ( uint8_t data );
+   static void COMPARE ( uint8_t reg, uint8_t data );
+   static void BRANCH ( bool taken );
+   static inline void NZ ( uint8_t data )
+   {
+      m_f = (m_f&(~(FLAG_N|FLAG_Z)))|(data&FLAG_N)|((!data)<<1);
+   }
+
    // The CPU core maintains the 64KB of RAM visible to the CPU.
    static uint8_t*  m_6502memory;
 
@@ -231,6 +334,26 @@ protected:
    static uint16_t  m_pc;
    static uint8_t   m_sp;
 
+   // Address of the opcode of the instruction being executed, and the
+   // last address accessed on the CPU's behalf.
+   static uint16_t  m_pcSync;
+   static uint32_t  m_ea;
+
+   // The effective address before indexing.  The unstable store
+   // instructions need it.
+   static uint32_t  m_eaBase;
+
+   // Interrupt state.  The current/previous pairs hold the sampled inputs
+   // at the end of the last two cycles.
+   static bool      m_irqAsserted;
+   static bool      m_irqCurrent;
+   static bool      m_irqPrevious;
+   static bool      m_nmiAsserted;
+   static bool      m_nmiPending;
+   static bool      m_nmiCurrent;
+   static bool      m_nmiPrevious;
+   static bool      m_jammed;
+
    // The address to break at on a "run to here" go.
    static uint32_t            m_pcGoto;
 
@@ -240,12 +363,13 @@ protected:
    // instructions that are marked.
    static CMarker*         m_marker;
 
+#endif
+
    // Database used by the Code/Data Logger debugger inspector.  The data structure
-   // is maintained by the CPU core as it performs fetches, reads,
-   // writes, and DMA transfers to/from its managed RAM.  The
-   // Code/Data Logger displays the collected information graphically.
+   // is maintained by the CPU core as it performs fetches, reads and
+   // writes on the bus.  The Code/Data Logger displays the collected
+   // information graphically.
    static CCodeDataLogger* m_logger;
-#endif
 
    // The database for CPU core registers.  Declaration
    // is in source file.
@@ -257,6 +381,11 @@ protected:
    // This is the database of active breakpoints.
    static CBreakpointInfo* m_breakpoints;
 
+   // The database for CPU core breakpoint events.  Declaration
+   // is in source file.
+   static CBreakpointEventInfo** m_tblBreakpointEvents;
+   static int32_t                m_numBreakpointEvents;
+
    // The data structures that support runtime disassembly of executed code.
    static uint8_t*   m_RAMopcodeMask;
    static char**           m_RAMdisassembly;
@@ -292,4 +421,6 @@ typedef struct _CC646502_opcode
    uint8_t checkInterruptCycleMap;
 } CC646502_opcode;
 
+CCodeDataLogger* c64GetCpuCodeDataLoggerDatabase ( void );
+
 #endif
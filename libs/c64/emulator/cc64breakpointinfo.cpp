@@ -23,6 +23,8 @@ void CC64BreakpointInfo::ModifyBreakpoint ( BreakpointInfo* pBreakpoint, int typ
       case eBreakOnCPUMemoryAccess:
       case eBreakOnCPUMemoryRead:
       case eBreakOnCPUMemoryWrite:
+      case eBreakOnCPUState:
+      case eBreakOnCPUEvent:
          pBreakpoint->target = eBreakInCPU;
          break;
    }
@@ -32,8 +34,10 @@ void CC64BreakpointInfo::ModifyBreakpoint ( BreakpointInfo* pBreakpoint, int typ
    pBreakpoint->itemType = itemType;
    pBreakpoint->event = event;
 
-   // Events not supported yet.
-   pBreakpoint->pEvent = NULL;
+   if ( (type == eBreakOnCPUEvent) && (event >= 0) && (event < NUM_C64_CPU_EVENTS) )
+   {
+      pBreakpoint->pEvent = CC646502::BREAKPOINTEVENTS()[event];
+   }
 
    pBreakpoint->item1 = item1;
    pBreakpoint->item1Absolute = item1Absolute;
@@ -438,6 +442,11 @@ void CC64BreakpointInfo::GetPrintable ( int idx, char* msg )
             break;
          }
          break;
+      case eBreakOnCPUEvent:
+         sprintf ( msg, m_breakpoint[idx].pEvent->GetDisplayFormat(),
+                   m_breakpoint[idx].item1,
+                   m_breakpoint[idx].item2 );
+         break;
    }
 }
 
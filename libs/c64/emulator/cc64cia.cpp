@@ -0,0 +1,544 @@
+//    NESICIDE - an IDE for the 8-bit NES.
+//    Copyright (C) 2009  Christopher S. Pow
+
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "cc64cia.h"
+#include "cc64.h"
+
+// Registers.
+#define CIA_PRA      0x0
+#define CIA_PRB      0x1
+#define CIA_DDRA     0x2
+#define CIA_DDRB     0x3
+#define CIA_TALO     0x4
+#define CIA_TAHI     0x5
+#define CIA_TBLO     0x6
+#define CIA_TBHI     0x7
+#define CIA_TOD10THS 0x8
+#define CIA_TODSEC   0x9
+#define CIA_TODMIN   0xA
+#define CIA_TODHR    0xB
+#define CIA_SDR      0xC
+#define CIA_ICR      0xD
+#define CIA_CRA      0xE
+#define CIA_CRB      0xF
+
+#define CR_START     0x01
+#define CR_RUNMODE   0x08
+#define CR_LOAD      0x10
+#define CRA_INMODE   0x20
+#define CRA_SPMODE   0x40
+#define CRA_TODIN    0x80
+#define CRB_INMODE   0x60
+#define CRB_ALARM    0x80
+
+#define ICR_TA       0x01
+#define ICR_TB       0x02
+#define ICR_ALARM    0x04
+#define ICR_SP       0x08
+#define ICR_IR       0x80
+
+// Cycles between ticks of the 50Hz mains input on a PAL machine.
+#define TOD_CYCLES_PER_TICK (C64_CPU_CLOCK_HZ/50)
+
+uint8_t  CCIA::m_pra [ NUM_CIAS ];
+uint8_t  CCIA::m_prb [ NUM_CIAS ];
+uint8_t  CCIA::m_ddra [ NUM_CIAS ];
+uint8_t  CCIA::m_ddrb [ NUM_CIAS ];
+uint16_t CCIA::m_timerA [ NUM_CIAS ];
+uint16_t CCIA::m_timerB [ NUM_CIAS ];
+uint16_t CCIA::m_latchA [ NUM_CIAS ];
+uint16_t CCIA::m_latchB [ NUM_CIAS ];
+uint8_t  CCIA::m_cra [ NUM_CIAS ];
+uint8_t  CCIA::m_crb [ NUM_CIAS ];
+uint8_t  CCIA::m_sdr [ NUM_CIAS ];
+int32_t  CCIA::m_sdrBits [ NUM_CIAS ];
+uint8_t  CCIA::m_icr [ NUM_CIAS ];
+uint8_t  CCIA::m_icrMask [ NUM_CIAS ];
+bool     CCIA::m_irq [ NUM_CIAS ];
+bool     CCIA::m_startA [ NUM_CIAS ];
+bool     CCIA::m_startB [ NUM_CIAS ];
+uint8_t  CCIA::m_tod [ NUM_CIAS ][ 4 ];
+uint8_t  CCIA::m_todAlarm [ NUM_CIAS ][ 4 ];
+uint8_t  CCIA::m_todLatch [ NUM_CIAS ][ 4 ];
+bool     CCIA::m_todLatched [ NUM_CIAS ];
+bool     CCIA::m_todStopped [ NUM_CIAS ];
+int32_t  CCIA::m_todDivider [ NUM_CIAS ];
+int32_t  CCIA::m_todCycles = 0;
+uint8_t  CCIA::m_keyboard [ 8 ];
+uint8_t  CCIA::m_joy [ 2 ];
+
+static CCIA __init __attribute((unused));
+
+CCIA::CCIA()
+{
+   RESET();
+}
+
+CCIA::~CCIA()
+{
+}
+
+void CCIA::RESET ( void )
+{
+   int32_t cia;
+   int32_t idx;
+
+   for ( cia = 0; cia < NUM_CIAS; cia++ )
+   {
+      m_pra[cia] = 0;
+      m_prb[cia] = 0;
+      m_ddra[cia] = 0;
+      m_ddrb[cia] = 0;
+      m_timerA[cia] = 0xFFFF;
+      m_timerB[cia] = 0xFFFF;
+      m_latchA[cia] = 0xFFFF;
+      m_latchB[cia] = 0xFFFF;
+      m_cra[cia] = 0;
+      m_crb[cia] = 0;
+      m_sdr[cia] = 0;
+      m_sdrBits[cia] = 0;
+      m_icr[cia] = 0;
+      m_icrMask[cia] = 0;
+      m_irq[cia] = false;
+      m_startA[cia] = false;
+      m_startB[cia] = false;
+      for ( idx = 0; idx < 4; idx++ )
+      {
+         m_tod[cia][idx] = 0;
+         m_todAlarm[cia][idx] = 0;
+         m_todLatch[cia][idx] = 0;
+      }
+      // The clock powers up at 1:00:00.0 AM.
+      m_tod[cia][3] = 0x01;
+      m_todLatched[cia] = false;
+      m_todStopped[cia] = false;
+      m_todDivider[cia] = 0;
+   }
+   m_todCycles = 0;
+
+   for ( idx = 0; idx < 8; idx++ )
+   {
+      m_keyboard[idx] = 0;
+   }
+   m_joy[0] = 0;
+   m_joy[1] = 0;
+}
+
+void CCIA::INTERRUPT ( int32_t cia, uint8_t source )
+{
+   m_icr[cia] |= source;
+   if ( m_icr[cia]&m_icrMask[cia] )
+   {
+      m_irq[cia] = true;
+   }
+}
+
+void CCIA::TIMERS ( int32_t cia )
+{
+   bool underflowA = false;
+   bool countB;
+
+   // Timer A counts cycles unless set to count CNT, which is never driven.
+   if ( (m_cra[cia]&CR_START) && (!(m_cra[cia]&CRA_INMODE)) )
+   {
+      if ( m_startA[cia] )
+      {
+         m_startA[cia] = false;
+      }
+      else if ( m_timerA[cia] == 0 )
+      {
+         underflowA = true;
+         m_timerA[cia] = m_latchA[cia];
+         if ( m_cra[cia]&CR_RUNMODE )
+         {
+            m_cra[cia] &= (~CR_START);
+         }
+         INTERRUPT ( cia, ICR_TA );
+
+         // The serial port shifts a bit out every two underflows.
+         if ( (m_cra[cia]&CRA_SPMODE) && m_sdrBits[cia] )
+         {
+            m_sdrBits[cia]--;
+            if ( !m_sdrBits[cia] )
+            {
+               INTERRUPT ( cia, ICR_SP );
+            }
+         }
+      }
+      else
+      {
+         m_timerA[cia]--;
+      }
+   }
+
+   // Timer B counts cycles or timer A underflows.  With CNT never driven,
+   // counting timer A underflows while CNT is high is the same thing.
+   switch ( m_crb[cia]&CRB_INMODE )
+   {
+      case 0x00:
+         countB = true;
+         break;
+      case 0x20:
+         countB = false;
+         break;
+      default:
+         countB = underflowA;
+         break;
+   }
+
+   if ( m_crb[cia]&CR_START )
+   {
+      if ( m_startB[cia] )
+      {
+         m_startB[cia] = false;
+      }
+      else if ( countB )
+      {
+         if ( m_timerB[cia] == 0 )
+         {
+            m_timerB[cia] = m_latchB[cia];
+            if ( m_crb[cia]&CR_RUNMODE )
+            {
+               m_crb[cia] &= (~CR_START);
+            }
+            INTERRUPT ( cia, ICR_TB );
+         }
+         else
+         {
+            m_timerB[cia]--;
+         }
+      }
+   }
+}
+
+void CCIA::TOD ( int32_t cia )
+{
+   int32_t idx;
+
+   // Tenths are counted from five or six mains cycles depending on how
+   // the program says the machine is powered.
+   m_todDivider[cia]++;
+   if ( m_todDivider[cia] < ((m_cra[cia]&CRA_TODIN)?5:6) )
+   {
+      return;
+   }
+   m_todDivider[cia] = 0;
+
+   if ( m_todStopped[cia] )
+   {
+      return;
+   }
+
+   m_tod[cia][0] = (m_tod[cia][0]+1)&0x0F;
+   if ( m_tod[cia][0] == 0x0A )
+   {
+      m_tod[cia][0] = 0;
+
+      for ( idx = 1; idx <= 2; idx++ )
+      {
+         m_tod[cia][idx]++;
+         if ( (m_tod[cia][idx]&0x0F) == 0x0A )
+         {
+            m_tod[cia][idx] += 0x06;
+         }
+         if ( m_tod[cia][idx] != 0x60 )
+         {
+            break;
+         }
+         m_tod[cia][idx] = 0;
+      }
+
+      if ( idx > 2 )
+      {
+         // Hours run 1-12 with the AM/PM flag toggled going to 12.
+         uint8_t pm = m_tod[cia][3]&0x80;
+         uint8_t hr = m_tod[cia][3]&0x1F;
+
+         if ( hr == 0x12 )
+         {
+            hr = 0x01;
+         }
+         else
+         {
+            hr++;
+            if ( (hr&0x0F) == 0x0A )
+            {
+               hr += 0x06;
+            }
+            if ( hr == 0x12 )
+            {
+               pm ^= 0x80;
+            }
+         }
+         m_tod[cia][3] = pm|hr;
+      }
+   }
+
+   if ( !memcmp(m_tod[cia],m_todAlarm[cia],4) )
+   {
+      INTERRUPT ( cia, ICR_ALARM );
+   }
+}
+
+void CCIA::CYCLE ( void )
+{
+   bool tick = false;
+
+   m_todCycles++;
+   if ( m_todCycles >= TOD_CYCLES_PER_TICK )
+   {
+      m_todCycles = 0;
+      tick = true;
+   }
+
+   TIMERS ( CIA1 );
+   TIMERS ( CIA2 );
+
+   if ( tick )
+   {
+      TOD ( CIA1 );
+      TOD ( CIA2 );
+   }
+}
+
+uint8_t CCIA::PORTA ( int32_t cia )
+{
+   uint8_t data = m_pra[cia]|(~m_ddra[cia]);
+   uint8_t rows;
+   int32_t col;
+
+   if ( cia == CIA1 )
+   {
+      // Joystick 2, and keys in rows driven low on port B pulling their
+      // columns low.
+      data &= (~m_joy[1]);
+      rows = (m_prb[cia]|(~m_ddrb[cia]))&(~m_joy[0]);
+      for ( col = 0; col < 8; col++ )
+      {
+         if ( m_keyboard[col]&(~rows) )
+         {
+            data &= (~(1<<col));
+         }
+      }
+   }
+   else
+   {
+      // Serial bus inputs read back what the C=64 drives onto the bus,
+      // through the inverting drivers.
+      data = (data&0x3F)|((m_pra[cia]&0x10)?0x00:0x40)|((m_pra[cia]&0x20)?0x00:0x80);
+   }
+
+   return data;
+}
+
+uint8_t CCIA::PORTB ( int32_t cia )
+{
+   uint8_t data = m_prb[cia]|(~m_ddrb[cia]);
+   uint8_t cols;
+   int32_t col;
+
+   if ( cia == CIA1 )
+   {
+      // Joystick 1, and keys in columns driven low on port A pulling their
+      // rows low.
+      data &= (~m_joy[0]);
+      cols = (m_pra[cia]|(~m_ddra[cia]))&(~m_joy[1]);
+      for ( col = 0; col < 8; col++ )
+      {
+         if ( !(cols&(1<<col)) )
+         {
+            data &= (~m_keyboard[col]);
+         }
+      }
+   }
+
+   return data;
+}
+
+uint8_t CCIA::PEEK ( int32_t cia, uint32_t addr )
+{
+   uint8_t* tod = m_todLatched[cia]?m_todLatch[cia]:m_tod[cia];
+
+   switch ( addr&0x0F )
+   {
+      case CIA_PRA:
+         return PORTA(cia);
+      case CIA_PRB:
+         return PORTB(cia);
+      case CIA_DDRA:
+         return m_ddra[cia];
+      case CIA_DDRB:
+         return m_ddrb[cia];
+      case CIA_TALO:
+         return m_timerA[cia]&0xFF;
+      case CIA_TAHI:
+         return m_timerA[cia]>>8;
+      case CIA_TBLO:
+         return m_timerB[cia]&0xFF;
+      case CIA_TBHI:
+         return m_timerB[cia]>>8;
+      case CIA_TOD10THS:
+         return tod[0];
+      case CIA_TODSEC:
+         return tod[1];
+      case CIA_TODMIN:
+         return tod[2];
+      case CIA_TODHR:
+         return tod[3];
+      case CIA_SDR:
+         return m_sdr[cia];
+      case CIA_ICR:
+         return m_icr[cia]|(m_irq[cia]?ICR_IR:0);
+      case CIA_CRA:
+         return m_cra[cia]&(~CR_LOAD);
+      case CIA_CRB:
+         return m_crb[cia]&(~CR_LOAD);
+   }
+   return 0xFF;
+}
+
+uint8_t CCIA::REG ( int32_t cia, uint32_t addr )
+{
+   uint8_t data = PEEK ( cia, addr );
+
+   switch ( addr&0x0F )
+   {
+      case CIA_TOD10THS:
+         m_todLatched[cia] = false;
+         break;
+      case CIA_TODHR:
+         memcpy(m_todLatch[cia],m_tod[cia],4);
+         m_todLatched[cia] = true;
+         break;
+      case CIA_ICR:
+         // Reading acknowledges everything.
+         m_icr[cia] = 0;
+         m_irq[cia] = false;
+         break;
+   }
+
+   return data;
+}
+
+void CCIA::REG ( int32_t cia, uint32_t addr, uint8_t data )
+{
+   uint8_t* tod = (m_crb[cia]&CRB_ALARM)?m_todAlarm[cia]:m_tod[cia];
+
+   switch ( addr&0x0F )
+   {
+      case CIA_PRA:
+         m_pra[cia] = data;
+         break;
+      case CIA_PRB:
+         m_prb[cia] = data;
+         break;
+      case CIA_DDRA:
+         m_ddra[cia] = data;
+         break;
+      case CIA_DDRB:
+         m_ddrb[cia] = data;
+         break;
+      case CIA_TALO:
+         m_latchA[cia] = (m_latchA[cia]&0xFF00)|data;
+         break;
+      case CIA_TAHI:
+         m_latchA[cia] = (m_latchA[cia]&0x00FF)|(data<<8);
+         if ( !(m_cra[cia]&CR_START) )
+         {
+            m_timerA[cia] = m_latchA[cia];
+         }
+         break;
+      case CIA_TBLO:
+         m_latchB[cia] = (m_latchB[cia]&0xFF00)|data;
+         break;
+      case CIA_TBHI:
+         m_latchB[cia] = (m_latchB[cia]&0x00FF)|(data<<8);
+         if ( !(m_crb[cia]&CR_START) )
+         {
+            m_timerB[cia] = m_latchB[cia];
+         }
+         break;
+      case CIA_TOD10THS:
+         tod[0] = data&0x0F;
+         if ( !(m_crb[cia]&CRB_ALARM) )
+         {
+            m_todStopped[cia] = false;
+         }
+         break;
+      case CIA_TODSEC:
+         tod[1] = data&0x7F;
+         break;
+      case CIA_TODMIN:
+         tod[2] = data&0x7F;
+         break;
+      case CIA_TODHR:
+         tod[3] = data&0x9F;
+         if ( !(m_crb[cia]&CRB_ALARM) )
+         {
+            m_todStopped[cia] = true;
+         }
+         break;
+      case CIA_SDR:
+         m_sdr[cia] = data;
+         if ( m_cra[cia]&CRA_SPMODE )
+         {
+            m_sdrBits[cia] = 16;
+         }
+         break;
+      case CIA_ICR:
+         if ( data&0x80 )
+         {
+            m_icrMask[cia] |= (data&0x1F);
+         }
+         else
+         {
+            m_icrMask[cia] &= (~data);
+         }
+         if ( m_icr[cia]&m_icrMask[cia] )
+         {
+            m_irq[cia] = true;
+         }
+         break;
+      case CIA_CRA:
+         if ( (data&CR_START) && (!(m_cra[cia]&CR_START)) )
+         {
+            m_startA[cia] = true;
+         }
+         if ( data&CR_LOAD )
+         {
+            m_timerA[cia] = m_latchA[cia];
+         }
+         m_cra[cia] = data&(~CR_LOAD);
+         break;
+      case CIA_CRB:
+         if ( (data&CR_START) && (!(m_crb[cia]&CR_START)) )
+         {
+            m_startB[cia] = true;
+         }
+         if ( data&CR_LOAD )
+         {
+            m_timerB[cia] = m_latchB[cia];
+         }
+         m_crb[cia] = data&(~CR_LOAD);
+         break;
+   }
+
+   // CIA2 port A selects the VIC-II's bank, inverted.
+   if ( (cia == CIA2) && (((addr&0x0F) == CIA_PRA) || ((addr&0x0F) == CIA_DDRA)) )
+   {
+      CC64::VICBANK ( (~(m_pra[cia]|(~m_ddra[cia])))&0x03 );
+   }
+}
@@ -0,0 +1,97 @@
+#ifndef CC64CIA_H
+#define CC64CIA_H
+
+#include "c64_emulator_core.h"
+
+#define NUM_CIAS 2
+#define CIA1     0
+#define CIA2     1
+
+// The CCIA class is the implementation of the two 6526 CIAs.  Each
+// method takes the index of the CIA it applies to, in the same way the
+// NES joypad classes take a controller index.
+//
+// CIA1 scans the keyboard and reads the joysticks, and its interrupt
+// output is wired to the CPU's IRQ line.  CIA2 drives the serial bus and
+// selects the VIC-II's memory bank, and its interrupt output is wired to
+// NMI.
+//
+// Both timers count system cycles, underflowing every latch+1 cycles, or
+// timer B can count timer A underflows.  The time of day clock is driven
+// from the 50Hz mains frequency of a PAL machine.
+class CCIA
+{
+public:
+   CCIA();
+   virtual ~CCIA();
+
+   static void RESET ( void );
+
+   // Clocks both CIAs through one system cycle.
+   static void CYCLE ( void );
+
+   // The CIA's interrupt output.
+   static inline bool IRQ ( int32_t cia )
+   {
+      return m_irq[cia];
+   }
+
+   // Register access by the CPU.  PEEK has no side effects.
+   static uint8_t REG ( int32_t cia, uint32_t addr );
+   static void REG ( int32_t cia, uint32_t addr, uint8_t data );
+   static uint8_t PEEK ( int32_t cia, uint32_t addr );
+
+   // What is connected to CIA1's ports.  See CC64::KEYBOARD for the layout
+   // of the keyboard matrix.  Joysticks are active high, in C64_JOY_ bits.
+   static inline void KEYBOARD ( uint8_t* matrix )
+   {
+      memcpy(m_keyboard,matrix,8);
+   }
+   static inline void JOY ( int32_t port, uint8_t data )
+   {
+      m_joy[port] = data;
+   }
+
+protected:
+   static void TIMERS ( int32_t cia );
+   static void TOD ( int32_t cia );
+   static void INTERRUPT ( int32_t cia, uint8_t source );
+   static uint8_t PORTA ( int32_t cia );
+   static uint8_t PORTB ( int32_t cia );
+
+   static uint8_t  m_pra [ NUM_CIAS ];
+   static uint8_t  m_prb [ NUM_CIAS ];
+   static uint8_t  m_ddra [ NUM_CIAS ];
+   static uint8_t  m_ddrb [ NUM_CIAS ];
+   static uint16_t m_timerA [ NUM_CIAS ];
+   static uint16_t m_timerB [ NUM_CIAS ];
+   static uint16_t m_latchA [ NUM_CIAS ];
+   static uint16_t m_latchB [ NUM_CIAS ];
+   static uint8_t  m_cra [ NUM_CIAS ];
+   static uint8_t  m_crb [ NUM_CIAS ];
+   static uint8_t  m_sdr [ NUM_CIAS ];
+   static int32_t  m_sdrBits [ NUM_CIAS ];
+   static uint8_t  m_icr [ NUM_CIAS ];
+   static uint8_t  m_icrMask [ NUM_CIAS ];
+   static bool     m_irq [ NUM_CIAS ];
+
+   // Timers don't count in the cycle they are started.
+   static bool     m_startA [ NUM_CIAS ];
+   static bool     m_startB [ NUM_CIAS ];
+
+   // Time of day clock and alarm, in BCD.  Reading the hours latches the
+   // clock until the tenths are read; writing the hours stops it until
+   // the tenths are written.
+   static uint8_t  m_tod [ NUM_CIAS ][ 4 ];
+   static uint8_t  m_todAlarm [ NUM_CIAS ][ 4 ];
+   static uint8_t  m_todLatch [ NUM_CIAS ][ 4 ];
+   static bool     m_todLatched [ NUM_CIAS ];
+   static bool     m_todStopped [ NUM_CIAS ];
+   static int32_t  m_todDivider [ NUM_CIAS ];
+   static int32_t  m_todCycles;
+
+   static uint8_t  m_keyboard [ 8 ];
+   static uint8_t  m_joy [ 2 ];
+};
+
+#endif // CC64CIA_H
@@ -18,6 +18,8 @@
 
 #include "c64_emulator_core.h"
 
+#include <math.h>
+
 // CPU Registers
 static CBitfieldData* tblFrequencyBitfields [] =
 {
@@ -89,3 +91,413 @@ static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_SIDregs,3,
 CRegisterDatabase* CSID::m_dbRegisters = dbRegisters;
 
 uint8_t CSID::m_SIDmemory[] = { 0, };
+
+uint32_t CSID::m_cycles = 0;
+uint32_t CSID::m_accumulator [] = { 0, };
+uint32_t CSID::m_noise [] = { 0, };
+bool     CSID::m_msbRising [] = { false, };
+bool     CSID::m_gate [] = { false, };
+int32_t  CSID::m_envelopeState [] = { 0, };
+uint8_t  CSID::m_envelope [] = { 0, };
+uint32_t CSID::m_rateCounter [] = { 0, };
+uint32_t CSID::m_exponentialCounter [] = { 0, };
+uint32_t CSID::m_osc3 = 0;
+float    CSID::m_lowPass = 0.0;
+float    CSID::m_bandPass = 0.0;
+float    CSID::m_highPass = 0.0;
+int32_t  CSID::m_sampleSum = 0;
+uint32_t CSID::m_sampleCycles = 0;
+uint32_t CSID::m_samplePhase = 0;
+int16_t* CSID::m_waveBuf = NULL;
+int32_t  CSID::m_waveBufProduce = 0;
+int32_t  CSID::m_waveBufConsume = 0;
+int32_t  CSID::m_samplesAvailable = 0;
+
+// Number of system cycles between envelope steps for each attack, decay
+// and release setting.  Decay and release steps are further divided by
+// the exponential counter.
+static const uint32_t m_envelopeRate [ 16 ] =
+{
+   9, 32, 63, 95, 149, 220, 267, 313, 392, 977, 1954, 3126, 3907, 11720, 19532, 31251
+};
+
+static CSID __init;
+
+CSID::CSID()
+{
+   m_waveBuf = new int16_t[SID_BUFFER_SIZE];
+   memset(m_waveBuf,0,SID_BUFFER_SIZE*sizeof(int16_t));
+}
+
+CSID::~CSID()
+{
+   delete [] m_waveBuf;
+}
+
+void CSID::RESET ( void )
+{
+   int32_t voice;
+
+   memset(m_SIDmemory,0,sizeof(m_SIDmemory));
+
+   for ( voice = 0; voice < NUM_SID_VOICES; voice++ )
+   {
+      m_accumulator[voice] = 0;
+      m_noise[voice] = 0x7FFFF8;
+      m_msbRising[voice] = false;
+      m_gate[voice] = false;
+      m_envelopeState[voice] = eEnvelope_Release;
+      m_envelope[voice] = 0;
+      m_rateCounter[voice] = 0;
+      m_exponentialCounter[voice] = 0;
+   }
+   m_osc3 = 0;
+
+   m_lowPass = 0.0;
+   m_bandPass = 0.0;
+   m_highPass = 0.0;
+
+   m_cycles = 0;
+   m_sampleSum = 0;
+   m_sampleCycles = 0;
+   m_samplePhase = 0;
+   m_waveBufProduce = 0;
+   m_waveBufConsume = 0;
+   m_samplesAvailable = 0;
+}
+
+void CSID::GATE ( int32_t voice )
+{
+   bool gate = !!(m_SIDmemory[(voice*7)+4]&0x01);
+
+   if ( gate && (!m_gate[voice]) )
+   {
+      m_envelopeState[voice] = eEnvelope_Attack;
+   }
+   else if ( (!gate) && m_gate[voice] )
+   {
+      m_envelopeState[voice] = eEnvelope_Release;
+   }
+   m_gate[voice] = gate;
+}
+
+uint32_t CSID::WAVEFORM ( int32_t voice )
+{
+   uint8_t  control = m_SIDmemory[(voice*7)+4];
+   uint32_t acc = m_accumulator[voice];
+   uint32_t noise = m_noise[voice];
+   uint32_t pw = MAKE16(m_SIDmemory[(voice*7)+2],m_SIDmemory[(voice*7)+3])&0xFFF;
+   uint32_t msb;
+   uint32_t wave = 0xFFF;
+
+   if ( !(control&0xF0) )
+   {
+      return 0;
+   }
+
+   // Selecting more than one waveform ANDs them together.
+   if ( control&0x10 )
+   {
+      msb = acc&0x800000;
+      if ( control&0x04 )
+      {
+         msb ^= m_accumulator[(voice+2)%NUM_SID_VOICES]&0x800000;
+      }
+      wave &= ((msb?~acc:acc)>>11)&0xFFF;
+   }
+   if ( control&0x20 )
+   {
+      wave &= acc>>12;
+   }
+   if ( control&0x40 )
+   {
+      wave &= ((control&0x08)||((acc>>12) >= pw))?0xFFF:0x000;
+   }
+   if ( control&0x80 )
+   {
+      wave &= (((noise>>20)&1)<<11)|
+              (((noise>>18)&1)<<10)|
+              (((noise>>14)&1)<<9)|
+              (((noise>>11)&1)<<8)|
+              (((noise>>9)&1)<<7)|
+              (((noise>>5)&1)<<6)|
+              (((noise>>2)&1)<<5)|
+              ((noise&1)<<4);
+   }
+   return wave;
+}
+
+void CSID::ENVELOPE ( int32_t voice )
+{
+   uint8_t  ad = m_SIDmemory[(voice*7)+5];
+   uint8_t  sr = m_SIDmemory[(voice*7)+6];
+   uint8_t  envelope = m_envelope[voice];
+   uint32_t rate;
+   uint32_t exponential;
+
+   switch ( m_envelopeState[voice] )
+   {
+   case eEnvelope_Attack:
+      rate = m_envelopeRate[ad>>4];
+      break;
+   case eEnvelope_DecaySustain:
+      rate = m_envelopeRate[ad&0x0F];
+      break;
+   default:
+      rate = m_envelopeRate[sr&0x0F];
+      break;
+   }
+
+   m_rateCounter[voice]++;
+   if ( m_rateCounter[voice] < rate )
+   {
+      return;
+   }
+   m_rateCounter[voice] = 0;
+
+   if ( m_envelopeState[voice] == eEnvelope_Attack )
+   {
+      m_exponentialCounter[voice] = 0;
+      envelope++;
+      if ( envelope == 0xFF )
+      {
+         m_envelopeState[voice] = eEnvelope_DecaySustain;
+      }
+      m_envelope[voice] = envelope;
+      return;
+   }
+
+   // Decay and release follow an approximately exponential curve by
+   // stepping less often as the level falls.
+   if ( envelope > 0x5D )
+   {
+      exponential = 1;
+   }
+   else if ( envelope > 0x36 )
+   {
+      exponential = 2;
+   }
+   else if ( envelope > 0x1A )
+   {
+      exponential = 4;
+   }
+   else if ( envelope > 0x0E )
+   {
+      exponential = 8;
+   }
+   else if ( envelope > 0x06 )
+   {
+      exponential = 16;
+   }
+   else
+   {
+      exponential = 30;
+   }
+
+   m_exponentialCounter[voice]++;
+   if ( m_exponentialCounter[voice] < exponential )
+   {
+      return;
+   }
+   m_exponentialCounter[voice] = 0;
+
+   if ( m_envelopeState[voice] == eEnvelope_DecaySustain )
+   {
+      if ( envelope > ((sr>>4)*0x11) )
+      {
+         envelope--;
+      }
+   }
+   else if ( envelope )
+   {
+      envelope--;
+   }
+   m_envelope[voice] = envelope;
+}
+
+void CSID::SYNC ( void )
+{
+   int32_t  voice;
+   uint32_t previous;
+   uint8_t  control;
+   int32_t  output [ NUM_SID_VOICES ];
+   int32_t  filterIn;
+   int32_t  mix;
+   int32_t  sample;
+   uint8_t  routing = m_SIDmemory[0x17];
+   uint8_t  mode = m_SIDmemory[0x18];
+   int32_t  volume = mode&0x0F;
+   uint32_t cutoff = (m_SIDmemory[0x15]&0x07)|(m_SIDmemory[0x16]<<3);
+   float    w;
+   float    damping;
+
+   // The filter's cutoff is roughly linear in the register value, from
+   // about 30Hz to 12kHz on a 6581.
+   w = 2.0*sin(3.14159265*(30.0+(cutoff*5.8))/C64_CPU_CLOCK_HZ);
+   damping = 1.41-((routing>>4)*0.08);
+
+   for ( voice = 0; voice < NUM_SID_VOICES; voice++ )
+   {
+      GATE(voice);
+   }
+
+   for ( ; m_cycles; m_cycles-- )
+   {
+      for ( voice = 0; voice < NUM_SID_VOICES; voice++ )
+      {
+         control = m_SIDmemory[(voice*7)+4];
+         previous = m_accumulator[voice];
+
+         if ( control&0x08 )
+         {
+            // The test bit holds the oscillator at zero.
+            m_accumulator[voice] = 0;
+            m_msbRising[voice] = false;
+         }
+         else
+         {
+            m_accumulator[voice] += MAKE16(m_SIDmemory[(voice*7)+0],m_SIDmemory[(voice*7)+1]);
+            m_accumulator[voice] &= 0xFFFFFF;
+            m_msbRising[voice] = (!(previous&0x800000)) && (m_accumulator[voice]&0x800000);
+
+            // The noise generator is clocked by bit 19 of the accumulator.
+            if ( (!(previous&0x080000)) && (m_accumulator[voice]&0x080000) )
+            {
+               m_noise[voice] = ((m_noise[voice]<<1)|(((m_noise[voice]>>22)^(m_noise[voice]>>17))&1))&0x7FFFFF;
+            }
+         }
+      }
+
+      // Hard sync resets a voice when the previous voice's oscillator wraps.
+      for ( voice = 0; voice < NUM_SID_VOICES; voice++ )
+      {
+         if ( (m_SIDmemory[(voice*7)+4]&0x02) &&
+              m_msbRising[(voice+2)%NUM_SID_VOICES] )
+         {
+            m_accumulator[voice] = 0;
+         }
+      }
+
+      for ( voice = 0; voice < NUM_SID_VOICES; voice++ )
+      {
+         ENVELOPE(voice);
+         output[voice] = ((((int32_t)WAVEFORM(voice))-0x800)*m_envelope[voice])>>8;
+      }
+
+      mix = 0;
+      filterIn = 0;
+      for ( voice = 0; voice < NUM_SID_VOICES; voice++ )
+      {
+         if ( routing&(1<<voice) )
+         {
+            filterIn += output[voice];
+         }
+         else if ( (voice != 2) || (!(mode&0x80)) )
+         {
+            mix += output[voice];
+         }
+      }
+
+      m_highPass = filterIn-m_lowPass-(damping*m_bandPass);
+      m_bandPass += w*m_highPass;
+      m_lowPass += w*m_bandPass;
+
+      if ( mode&0x10 )
+      {
+         mix += (int32_t)m_lowPass;
+      }
+      if ( mode&0x20 )
+      {
+         mix += (int32_t)m_bandPass;
+      }
+      if ( mode&0x40 )
+      {
+         mix += (int32_t)m_highPass;
+      }
+
+      m_sampleSum += mix*volume;
+      m_sampleCycles++;
+
+      // Produce a sample each time enough system cycles have gone by.
+      m_samplePhase += C64_SAMPLE_RATE;
+      if ( m_samplePhase >= C64_CPU_CLOCK_HZ )
+      {
+         m_samplePhase -= C64_CPU_CLOCK_HZ;
+
+         sample = (m_sampleSum/(int32_t)m_sampleCycles)>>2;
+         if ( sample > 32767 )
+         {
+            sample = 32767;
+         }
+         else if ( sample < -32768 )
+         {
+            sample = -32768;
+         }
+
+         *(m_waveBuf+m_waveBufProduce) = sample;
+         m_waveBufProduce++;
+         m_waveBufProduce %= SID_BUFFER_SIZE;
+         m_samplesAvailable++;
+
+         m_sampleSum = 0;
+         m_sampleCycles = 0;
+      }
+   }
+
+   m_osc3 = WAVEFORM(2);
+}
+
+uint8_t CSID::REG ( uint32_t addr )
+{
+   SYNC();
+   return PEEK(addr);
+}
+
+void CSID::REG ( uint32_t addr, uint8_t data )
+{
+   addr &= MASK_32B;
+
+   SYNC();
+   if ( addr < 0x19 )
+   {
+      m_SIDmemory[addr] = data;
+      if ( (addr%7) == 4 )
+      {
+         GATE(addr/7);
+      }
+   }
+}
+
+uint8_t CSID::PEEK ( uint32_t addr )
+{
+   addr &= MASK_32B;
+
+   switch ( addr )
+   {
+   case 0x19:
+   case 0x1A:
+      // No paddles are connected.
+      return 0xFF;
+   case 0x1B:
+      return m_osc3>>4;
+   case 0x1C:
+      return m_envelope[2];
+   default:
+      // The rest of the registers are write-only.
+      return 0x00;
+   }
+}
+
+uint8_t* CSID::PLAY ( uint16_t samples )
+{
+   int16_t* waveBuf;
+
+   waveBuf = m_waveBuf + m_waveBufConsume;
+
+   m_waveBufConsume += samples;
+   m_waveBufConsume %= SID_BUFFER_SIZE;
+
+   m_samplesAvailable -= samples;
+
+   return (uint8_t*)waveBuf;
+}
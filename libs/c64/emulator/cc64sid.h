@@ -5,12 +5,58 @@
 
 #include "cregisterdata.h"
 
+#define NUM_SID_VOICES 3
+#define NUM_SID_BUFS 32
+#define SID_BUFFER_SIZE (NUM_SID_BUFS*SID_SAMPLES)
+
+// The CSID class is the implementation of the 6581 SID.
+//
+// Each voice has the 24-bit phase accumulator, the four waveforms (ANDed
+// together when more than one is selected), the 23-bit noise shift
+// register, hard sync and ring modulation from the previous voice, and
+// an ADSR envelope generator that steps at the chip's own rate periods
+// with the exponential decay and release curve.  The mixed voices go
+// through a state-variable filter with low, band and high pass outputs.
+//
+// The C64 bus clocks the SID once per system cycle, but that only counts
+// the cycle.  The synthesis itself is run in a batch when a register is
+// accessed, when the frame ends, or when samples are asked for, which
+// gives the same output as running it each cycle because nothing can
+// change what the SID does between register accesses.  The output is
+// averaged down to C64_SAMPLE_RATE samples per second.
 class CSID
 {
 public:
    CSID();
    virtual ~CSID();
 
+   static void RESET ( void );
+
+   // Counts one system cycle for the next batch.
+   static inline void CYCLE ( void )
+   {
+      m_cycles++;
+   }
+
+   // Runs the synthesis for the cycles counted so far.
+   static void SYNC ( void );
+
+   // Register access by the CPU.  PEEK has no side effects.
+   static uint8_t REG ( uint32_t addr );
+   static void REG ( uint32_t addr, uint8_t data );
+   static uint8_t PEEK ( uint32_t addr );
+
+   // Produced samples, for the audio output.
+   static uint8_t* PLAY ( uint16_t samples );
+   static inline int32_t SAMPLESAVAILABLE ( void )
+   {
+      return m_samplesAvailable;
+   }
+   static inline void CLEARSAMPLESAVAILABLE ( void )
+   {
+      m_samplesAvailable = 0;
+   }
+
    // Interface to retrieve the database defining the registers
    // of the CPU core in a "human readable" form that is used by
    // the Register-type debugger inspector.  The hexadecimal world
@@ -47,12 +93,50 @@ public:
    }
 
 protected:
+   static void GATE ( int32_t voice );
+   static uint32_t WAVEFORM ( int32_t voice );
+   static void ENVELOPE ( int32_t voice );
+
    // The database for CPU core registers.  Declaration
    // is in source file.
    static CRegisterDatabase* m_dbRegisters;
 
    // SID register data.
    static uint8_t m_SIDmemory[32];
+
+   // Cycles not yet synthesized.
+   static uint32_t m_cycles;
+
+   // Voice state.
+   enum
+   {
+      eEnvelope_Attack = 0,
+      eEnvelope_DecaySustain,
+      eEnvelope_Release
+   };
+   static uint32_t m_accumulator [ NUM_SID_VOICES ];
+   static uint32_t m_noise [ NUM_SID_VOICES ];
+   static bool     m_msbRising [ NUM_SID_VOICES ];
+   static bool     m_gate [ NUM_SID_VOICES ];
+   static int32_t  m_envelopeState [ NUM_SID_VOICES ];
+   static uint8_t  m_envelope [ NUM_SID_VOICES ];
+   static uint32_t m_rateCounter [ NUM_SID_VOICES ];
+   static uint32_t m_exponentialCounter [ NUM_SID_VOICES ];
+   static uint32_t m_osc3;
+
+   // Filter state.
+   static float    m_lowPass;
+   static float    m_bandPass;
+   static float    m_highPass;
+
+   // Output.  Samples are averaged over the cycles making up each one.
+   static int32_t  m_sampleSum;
+   static uint32_t m_sampleCycles;
+   static uint32_t m_samplePhase;
+   static int16_t* m_waveBuf;
+   static int32_t  m_waveBufProduce;
+   static int32_t  m_waveBufConsume;
+   static int32_t  m_samplesAvailable;
 };
 
 #endif // CC64SID_H
@@ -0,0 +1,687 @@
+//    NESICIDE - an IDE for the 8-bit NES.
+//    Copyright (C) 2009  Christopher S. Pow
+
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "cc64vic.h"
+#include "cc64.h"
+
+#include "cc64systempalette.h"
+
+// Registers.
+#define VIC_SPRITE_X_MSB     0x10
+#define VIC_CONTROL1         0x11
+#define VIC_RASTER           0x12
+#define VIC_LIGHTPEN_X       0x13
+#define VIC_LIGHTPEN_Y       0x14
+#define VIC_SPRITE_ENABLE    0x15
+#define VIC_CONTROL2         0x16
+#define VIC_SPRITE_EXPAND_Y  0x17
+#define VIC_MEMORY_POINTERS  0x18
+#define VIC_IRQ_LATCH        0x19
+#define VIC_IRQ_ENABLE       0x1A
+#define VIC_SPRITE_PRIORITY  0x1B
+#define VIC_SPRITE_MULTI     0x1C
+#define VIC_SPRITE_EXPAND_X  0x1D
+#define VIC_SPRITE_SPRITE    0x1E
+#define VIC_SPRITE_DATA      0x1F
+#define VIC_BORDER_COLOR     0x20
+#define VIC_BACKGROUND0      0x21
+#define VIC_SPRITE_MULTI0    0x25
+#define VIC_SPRITE_MULTI1    0x26
+#define VIC_SPRITE_COLOR     0x27
+
+#define CONTROL1_YSCROLL     0x07
+#define CONTROL1_RSEL        0x08
+#define CONTROL1_DEN         0x10
+#define CONTROL1_BMM         0x20
+#define CONTROL1_ECM         0x40
+#define CONTROL2_XSCROLL     0x07
+#define CONTROL2_CSEL        0x08
+#define CONTROL2_MCM         0x10
+
+#define IRQ_RASTER           0x01
+#define IRQ_SPRITE_DATA      0x02
+#define IRQ_SPRITE_SPRITE    0x04
+
+// Where the output window sits in the VIC-II's own coordinates, which are
+// the ones sprite positions are given in.
+#define VISIBLE_FIRST_X      (-8)
+#define VISIBLE_FIRST_LINE   16
+
+uint8_t  CVIC::m_regs [ 64 ];
+uint8_t  CVIC::m_irqLatch = 0;
+uint8_t  CVIC::m_irqMask = 0;
+uint32_t CVIC::m_rasterCompare = 0;
+uint8_t  CVIC::m_spriteSpriteCollision = 0;
+uint8_t  CVIC::m_spriteDataCollision = 0;
+uint32_t CVIC::m_raster = 0;
+uint32_t CVIC::m_cycle = 1;
+uint32_t CVIC::m_frame = 0;
+bool     CVIC::m_badline = false;
+bool     CVIC::m_denSeen = false;
+bool     CVIC::m_displayState = false;
+bool     CVIC::m_verticalBorder = true;
+uint32_t CVIC::m_vc = 0;
+uint32_t CVIC::m_vcBase = 0;
+uint32_t CVIC::m_rc = 0;
+uint8_t  CVIC::m_videoMatrix [ 40 ];
+uint8_t  CVIC::m_colorLine [ 40 ];
+uint8_t  CVIC::m_lastFetch = 0xFF;
+uint8_t  CVIC::m_spriteDma = 0;
+uint8_t  CVIC::m_spriteDisplay = 0;
+uint8_t  CVIC::m_spriteExpandFF = 0xFF;
+uint32_t CVIC::m_mc [ 8 ];
+uint32_t CVIC::m_mcBase [ 8 ];
+uint32_t CVIC::m_spriteData [ 8 ];
+int8_t*  CVIC::m_pTV = NULL;
+
+static CVIC __init __attribute((unused));
+
+CVIC::CVIC()
+{
+   RESET();
+}
+
+CVIC::~CVIC()
+{
+}
+
+void CVIC::RESET ( void )
+{
+   int32_t idx;
+
+   for ( idx = 0; idx < 64; idx++ )
+   {
+      m_regs[idx] = 0;
+   }
+   for ( idx = 0; idx < 8; idx++ )
+   {
+      m_mc[idx] = 0;
+      m_mcBase[idx] = 0;
+      m_spriteData[idx] = 0;
+   }
+   for ( idx = 0; idx < 40; idx++ )
+   {
+      m_videoMatrix[idx] = 0;
+      m_colorLine[idx] = 0;
+   }
+
+   m_irqLatch = 0;
+   m_irqMask = 0;
+   m_rasterCompare = 0;
+   m_spriteSpriteCollision = 0;
+   m_spriteDataCollision = 0;
+   m_raster = 0;
+   m_cycle = 1;
+   m_badline = false;
+   m_denSeen = false;
+   m_displayState = false;
+   m_verticalBorder = true;
+   m_vc = 0;
+   m_vcBase = 0;
+   m_rc = 0;
+   m_spriteDma = 0;
+   m_spriteDisplay = 0;
+   m_spriteExpandFF = 0xFF;
+}
+
+uint8_t CVIC::FETCH ( uint32_t addr )
+{
+   m_lastFetch = CC64::VICLOAD ( addr );
+   return m_lastFetch;
+}
+
+void CVIC::BADLINE ( void )
+{
+   // DEN must have been set at some point during line $30 for there to be
+   // any badlines in the frame.
+   if ( (m_raster == 0x30) && (m_regs[VIC_CONTROL1]&CONTROL1_DEN) )
+   {
+      m_denSeen = true;
+   }
+
+   m_badline = m_denSeen &&
+               (m_raster >= 0x30) && (m_raster <= 0xF7) &&
+               ((m_raster&CONTROL1_YSCROLL) == (uint32_t)(m_regs[VIC_CONTROL1]&CONTROL1_YSCROLL));
+
+   if ( m_badline )
+   {
+      m_displayState = true;
+   }
+}
+
+void CVIC::RASTERCOMPARE ( void )
+{
+   if ( m_raster == m_rasterCompare )
+   {
+      m_irqLatch |= IRQ_RASTER;
+   }
+}
+
+void CVIC::SPRITEDMA ( void )
+{
+   int32_t sprite;
+   uint8_t bit;
+
+   for ( sprite = 0, bit = 1; sprite < 8; sprite++, bit <<= 1 )
+   {
+      if ( (m_regs[VIC_SPRITE_ENABLE]&bit) &&
+           (m_regs[(sprite<<1)+1] == (m_raster&0xFF)) &&
+           (!(m_spriteDma&bit)) )
+      {
+         m_spriteDma |= bit;
+         m_mcBase[sprite] = 0;
+         if ( m_regs[VIC_SPRITE_EXPAND_Y]&bit )
+         {
+            m_spriteExpandFF &= (~bit);
+         }
+      }
+   }
+}
+
+void CVIC::CYCLE ( void )
+{
+   int32_t  sprite;
+   uint8_t  bit;
+   uint32_t vm;
+   uint32_t ptr;
+   uint32_t idx;
+
+   m_cycle++;
+   if ( m_cycle > VIC_CYCLES_PER_LINE )
+   {
+      m_cycle = 1;
+      m_raster++;
+      if ( m_raster == VIC_LINES_PER_FRAME )
+      {
+         m_raster = 0;
+         m_frame++;
+         m_denSeen = false;
+         m_vcBase = 0;
+      }
+   }
+
+   switch ( m_cycle )
+   {
+      case 1:
+         RASTERCOMPARE();
+         BADLINE();
+         break;
+
+      case 14:
+         m_vc = m_vcBase;
+         if ( m_badline )
+         {
+            m_rc = 0;
+         }
+         break;
+
+      case 15:
+      case 16:
+         // MCBASE moves on by the three bytes fetched, but only on lines
+         // where the Y expansion flip flop lets it.
+         for ( sprite = 0, bit = 1; sprite < 8; sprite++, bit <<= 1 )
+         {
+            if ( m_spriteExpandFF&bit )
+            {
+               m_mcBase[sprite] += (m_cycle == 15)?2:1;
+            }
+            if ( (m_cycle == 16) && (m_mcBase[sprite] >= 63) )
+            {
+               m_spriteDma &= (~bit);
+               m_spriteDisplay &= (~bit);
+            }
+         }
+         break;
+
+      case 55:
+         for ( sprite = 0, bit = 1; sprite < 8; sprite++, bit <<= 1 )
+         {
+            if ( m_regs[VIC_SPRITE_EXPAND_Y]&bit )
+            {
+               m_spriteExpandFF ^= bit;
+            }
+            else
+            {
+               m_spriteExpandFF |= bit;
+            }
+         }
+         SPRITEDMA();
+         break;
+
+      case 56:
+         SPRITEDMA();
+         break;
+
+      case 58:
+         RENDERSCANLINE();
+
+         // Graphics counters.
+         if ( m_displayState )
+         {
+            m_vc = (m_vc+40)&MASK_1KB;
+         }
+         if ( m_rc == 7 )
+         {
+            m_vcBase = m_vc;
+            if ( !m_badline )
+            {
+               m_displayState = false;
+            }
+         }
+         if ( m_displayState )
+         {
+            m_rc = (m_rc+1)&7;
+         }
+
+         // Sprite counters, and the s-accesses for the next line.
+         vm = (m_regs[VIC_MEMORY_POINTERS]&0xF0)<<6;
+         for ( sprite = 0, bit = 1; sprite < 8; sprite++, bit <<= 1 )
+         {
+            m_mc[sprite] = m_mcBase[sprite];
+            if ( (m_spriteDma&bit) &&
+                 (m_regs[(sprite<<1)+1] == (m_raster&0xFF)) )
+            {
+               m_spriteDisplay |= bit;
+            }
+
+            ptr = FETCH(vm|0x3F8|sprite)<<6;
+            if ( m_spriteDma&bit )
+            {
+               m_spriteData[sprite] = FETCH(ptr|(m_mc[sprite]&0x3F))<<16;
+               m_mc[sprite]++;
+               m_spriteData[sprite] |= FETCH(ptr|(m_mc[sprite]&0x3F))<<8;
+               m_mc[sprite]++;
+               m_spriteData[sprite] |= FETCH(ptr|(m_mc[sprite]&0x3F));
+               m_mc[sprite]++;
+            }
+         }
+         break;
+
+      case 63:
+         // Vertical border comparison at the end of the line.
+         if ( m_raster == ((m_regs[VIC_CONTROL1]&CONTROL1_RSEL)?251:247) )
+         {
+            m_verticalBorder = true;
+         }
+         else if ( (m_raster == ((m_regs[VIC_CONTROL1]&CONTROL1_RSEL)?51:55)) &&
+                   (m_regs[VIC_CONTROL1]&CONTROL1_DEN) )
+         {
+            m_verticalBorder = false;
+         }
+         break;
+   }
+
+   // c-accesses of a badline, one a cycle.
+   if ( m_badline && (m_cycle >= 15) && (m_cycle <= 54) )
+   {
+      idx = m_cycle-15;
+      vm = (m_regs[VIC_MEMORY_POINTERS]&0xF0)<<6;
+      m_videoMatrix[idx] = FETCH(vm|((m_vc+idx)&MASK_1KB));
+      m_colorLine[idx] = CC64::COLORRAM(m_vc+idx);
+   }
+}
+
+void CVIC::RENDERSCANLINE ( void )
+{
+   // Line buffers in VIC-II X coordinates, with room for sprites that run
+   // off the right hand side.
+   static uint8_t pixel [ 512 ];
+   static uint8_t foreground [ 512 ];
+   static uint8_t spritePixel [ 512 ];
+   static uint8_t spriteOwner [ 512 ];
+   uint8_t  control1 = m_regs[VIC_CONTROL1];
+   uint8_t  control2 = m_regs[VIC_CONTROL2];
+   uint8_t  mode = ((control1&(CONTROL1_ECM|CONTROL1_BMM))|(control2&CONTROL2_MCM))>>4;
+   uint32_t charBase = (m_regs[VIC_MEMORY_POINTERS]&0x0E)<<10;
+   uint32_t bitmapBase = (m_regs[VIC_MEMORY_POINTERS]&0x08)<<10;
+   uint8_t* bkgnd = m_regs+VIC_BACKGROUND0;
+   int32_t  left = (control2&CONTROL2_CSEL)?24:31;
+   int32_t  right = (control2&CONTROL2_CSEL)?344:335;
+   int32_t  x;
+   int32_t  start;
+   int32_t  column;
+   int32_t  bitIdx;
+   int32_t  sprite;
+   int32_t  sx;
+   int32_t  width;
+   uint8_t  bit;
+   uint8_t  code;
+   uint8_t  color;
+   uint8_t  gdata;
+   uint8_t  pair;
+   uint8_t  collided;
+   uint8_t  idx;
+   uint32_t data;
+   uint8_t  c[4];
+   int8_t*  pTV;
+
+   // The left edge of the display window also resets the vertical border
+   // on the top line, or sets it on the bottom one.
+   if ( m_raster == ((control1&CONTROL1_RSEL)?251:247) )
+   {
+      m_verticalBorder = true;
+   }
+   else if ( (m_raster == ((control1&CONTROL1_RSEL)?51:55)) &&
+             (control1&CONTROL1_DEN) )
+   {
+      m_verticalBorder = false;
+   }
+
+   // Graphics.
+   memset(foreground,0,sizeof(foreground));
+   start = 24+(control2&CONTROL2_XSCROLL);
+   for ( x = 24; x < start; x++ )
+   {
+      pixel[x] = bkgnd[0];
+   }
+   for ( column = 0; column < 40; column++ )
+   {
+      if ( m_displayState )
+      {
+         code = m_videoMatrix[column];
+         color = m_colorLine[column];
+         if ( control1&CONTROL1_BMM )
+         {
+            gdata = FETCH(bitmapBase|(((m_vc+column)&MASK_1KB)<<3)|m_rc);
+         }
+         else
+         {
+            gdata = FETCH(charBase|((code&((control1&CONTROL1_ECM)?0x3F:0xFF))<<3)|m_rc);
+         }
+      }
+      else
+      {
+         // Idle state shows the last byte of the bank in black.
+         code = 0;
+         color = 0;
+         gdata = FETCH((control1&CONTROL1_ECM)?0x39FF:0x3FFF);
+      }
+
+      x = start+(column<<3);
+
+      switch ( mode )
+      {
+         case 0:
+            // Standard text.
+            c[0] = bkgnd[0];
+            c[1] = color;
+            for ( bitIdx = 7; bitIdx >= 0; bitIdx--, x++ )
+            {
+               pixel[x] = c[(gdata>>bitIdx)&1];
+               foreground[x] = (gdata>>bitIdx)&1;
+            }
+            break;
+         case 1:
+            // Multicolor text, per character.
+            if ( color&0x08 )
+            {
+               c[0] = bkgnd[0];
+               c[1] = bkgnd[1];
+               c[2] = bkgnd[2];
+               c[3] = color&0x07;
+               for ( bitIdx = 6; bitIdx >= 0; bitIdx -= 2, x += 2 )
+               {
+                  pair = (gdata>>bitIdx)&3;
+                  pixel[x] = c[pair];
+                  pixel[x+1] = c[pair];
+                  foreground[x] = (pair >= 2);
+                  foreground[x+1] = (pair >= 2);
+               }
+            }
+            else
+            {
+               c[0] = bkgnd[0];
+               c[1] = color&0x07;
+               for ( bitIdx = 7; bitIdx >= 0; bitIdx--, x++ )
+               {
+                  pixel[x] = c[(gdata>>bitIdx)&1];
+                  foreground[x] = (gdata>>bitIdx)&1;
+               }
+            }
+            break;
+         case 2:
+            // Standard bitmap.
+            c[0] = code&0x0F;
+            c[1] = code>>4;
+            for ( bitIdx = 7; bitIdx >= 0; bitIdx--, x++ )
+            {
+               pixel[x] = c[(gdata>>bitIdx)&1];
+               foreground[x] = (gdata>>bitIdx)&1;
+            }
+            break;
+         case 3:
+            // Multicolor bitmap.
+            c[0] = bkgnd[0];
+            c[1] = code>>4;
+            c[2] = code&0x0F;
+            c[3] = color;
+            for ( bitIdx = 6; bitIdx >= 0; bitIdx -= 2, x += 2 )
+            {
+               pair = (gdata>>bitIdx)&3;
+               pixel[x] = c[pair];
+               pixel[x+1] = c[pair];
+               foreground[x] = (pair >= 2);
+               foreground[x+1] = (pair >= 2);
+            }
+            break;
+         case 4:
+            // Extended background color text.
+            c[0] = bkgnd[code>>6];
+            c[1] = color;
+            for ( bitIdx = 7; bitIdx >= 0; bitIdx--, x++ )
+            {
+               pixel[x] = c[(gdata>>bitIdx)&1];
+               foreground[x] = (gdata>>bitIdx)&1;
+            }
+            break;
+         default:
+            // The invalid modes output black, but the foreground is still
+            // there for collisions.
+            for ( bitIdx = 7; bitIdx >= 0; bitIdx--, x++ )
+            {
+               pixel[x] = 0;
+               foreground[x] = (gdata>>((mode&1)?(bitIdx|1):bitIdx))&1;
+            }
+            break;
+      }
+   }
+
+   // Sprites.  Lower numbered sprites are in front of higher numbered ones.
+   memset(spriteOwner,0xFF,sizeof(spriteOwner));
+   m_spriteDisplay &= m_regs[VIC_SPRITE_ENABLE];
+   for ( sprite = 0, bit = 1; (sprite < 8) && m_spriteDisplay; sprite++, bit <<= 1 )
+   {
+      if ( !(m_spriteDisplay&bit) )
+      {
+         continue;
+      }
+
+      sx = m_regs[sprite<<1]|((m_regs[VIC_SPRITE_X_MSB]&bit)?0x100:0);
+      data = m_spriteData[sprite];
+      width = (m_regs[VIC_SPRITE_EXPAND_X]&bit)?2:1;
+      c[1] = m_regs[VIC_SPRITE_MULTI0];
+      c[2] = m_regs[VIC_SPRITE_COLOR+sprite];
+      c[3] = m_regs[VIC_SPRITE_MULTI1];
+
+      for ( bitIdx = 23; bitIdx >= 0; bitIdx-- )
+      {
+         if ( m_regs[VIC_SPRITE_MULTI]&bit )
+         {
+            pair = (data>>(bitIdx&(~1)))&3;
+            idx = pair;
+         }
+         else
+         {
+            idx = ((data>>bitIdx)&1)?2:0;
+         }
+
+         for ( column = 0; column < width; column++ )
+         {
+            x = sx+(((23-bitIdx)*width)+column);
+            if ( idx && (x < 504) )
+            {
+               if ( spriteOwner[x] == 0xFF )
+               {
+                  spriteOwner[x] = sprite;
+                  spritePixel[x] = c[idx];
+               }
+               else
+               {
+                  // Sprite to sprite collision.
+                  collided = (1<<spriteOwner[x])|bit;
+                  if ( !m_spriteSpriteCollision )
+                  {
+                     m_irqLatch |= IRQ_SPRITE_SPRITE;
+                  }
+                  m_spriteSpriteCollision |= collided;
+               }
+
+               if ( (x >= 24) && (x < 344) && foreground[x] )
+               {
+                  if ( !m_spriteDataCollision )
+                  {
+                     m_irqLatch |= IRQ_SPRITE_DATA;
+                  }
+                  m_spriteDataCollision |= bit;
+               }
+            }
+         }
+      }
+   }
+
+   if ( (!m_pTV) ||
+        (m_raster < VISIBLE_FIRST_LINE) ||
+        (m_raster >= (VISIBLE_FIRST_LINE+C64_VISIBLE_Y)) )
+   {
+      return;
+   }
+
+   pTV = m_pTV+(((m_raster-VISIBLE_FIRST_LINE)*C64_VISIBLE_X)<<2);
+
+   for ( x = VISIBLE_FIRST_X; x < (VISIBLE_FIRST_X+C64_VISIBLE_X); x++, pTV += 4 )
+   {
+      if ( m_verticalBorder || (x < left) || (x >= right) )
+      {
+         color = m_regs[VIC_BORDER_COLOR];
+      }
+      else if ( (x >= 0) &&
+                (spriteOwner[x] != 0xFF) &&
+                (!((m_regs[VIC_SPRITE_PRIORITY]&(1<<spriteOwner[x])) && foreground[x])) )
+      {
+         color = spritePixel[x];
+      }
+      else
+      {
+         color = pixel[x];
+      }
+
+      *pTV = CBasePalette::GetPaletteR(color&0x0F);
+      *(pTV+1) = CBasePalette::GetPaletteG(color&0x0F);
+      *(pTV+2) = CBasePalette::GetPaletteB(color&0x0F);
+   }
+}
+
+uint8_t CVIC::PEEK ( uint32_t addr )
+{
+   addr &= 0x3F;
+
+   switch ( addr )
+   {
+      case VIC_CONTROL1:
+         return (m_regs[VIC_CONTROL1]&0x7F)|((m_raster&0x100)>>1);
+      case VIC_RASTER:
+         return m_raster&0xFF;
+      case VIC_CONTROL2:
+         return m_regs[addr]|0xC0;
+      case VIC_MEMORY_POINTERS:
+         return m_regs[addr]|0x01;
+      case VIC_IRQ_LATCH:
+         return m_irqLatch|0x70|(IRQ()?0x80:0x00);
+      case VIC_IRQ_ENABLE:
+         return m_irqMask|0xF0;
+      case VIC_SPRITE_SPRITE:
+         return m_spriteSpriteCollision;
+      case VIC_SPRITE_DATA:
+         return m_spriteDataCollision;
+   }
+
+   if ( addr >= 0x2F )
+   {
+      return 0xFF;
+   }
+   if ( addr >= VIC_BORDER_COLOR )
+   {
+      return m_regs[addr]|0xF0;
+   }
+   return m_regs[addr];
+}
+
+uint8_t CVIC::REG ( uint32_t addr )
+{
+   uint8_t data = PEEK ( addr );
+
+   // Reading the collision registers clears them.
+   switch ( addr&0x3F )
+   {
+      case VIC_SPRITE_SPRITE:
+         m_spriteSpriteCollision = 0;
+         break;
+      case VIC_SPRITE_DATA:
+         m_spriteDataCollision = 0;
+         break;
+   }
+
+   return data;
+}
+
+void CVIC::REG ( uint32_t addr, uint8_t data )
+{
+   uint32_t compare;
+
+   addr &= 0x3F;
+
+   switch ( addr )
+   {
+      case VIC_CONTROL1:
+      case VIC_RASTER:
+         m_regs[addr] = data;
+         compare = m_regs[VIC_RASTER]|((m_regs[VIC_CONTROL1]&0x80)<<1);
+         if ( compare != m_rasterCompare )
+         {
+            m_rasterCompare = compare;
+            RASTERCOMPARE();
+         }
+         BADLINE();
+         break;
+      case VIC_IRQ_LATCH:
+         // Writing a one acknowledges that interrupt.
+         m_irqLatch &= ((~data)&0x0F);
+         break;
+      case VIC_IRQ_ENABLE:
+         m_irqMask = data&0x0F;
+         break;
+      case VIC_SPRITE_SPRITE:
+      case VIC_SPRITE_DATA:
+         // Read only.
+         break;
+      default:
+         if ( addr < 0x2F )
+         {
+            m_regs[addr] = data;
+         }
+         break;
+   }
+}
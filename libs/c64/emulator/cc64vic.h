@@ -0,0 +1,145 @@
+#ifndef CC64VIC_H
+#define CC64VIC_H
+
+#include "c64_emulator_core.h"
+
+// The CVIC class is the implementation of the PAL VIC-II (6569).
+//
+// It is clocked once per system cycle by the C64 bus.  A PAL frame is
+// 312 raster lines of 63 cycles.  The chip's timing is followed at the
+// cycle level where the rest of the machine can see it: the raster
+// counter and raster interrupt, the badline condition and the 40 cycles
+// the CPU loses on a badline, and the cycles lost to sprite DMA.  The
+// c-accesses of a badline are made in the cycle they happen on the real
+// chip, so code changing the screen under the raster sees the same thing
+// it would on real hardware.
+//
+// Pixels are produced a whole raster line at a time, in cycle 58 when the
+// VIC-II finishes the line's graphics accesses, from the register values
+// at that moment.  Effects that change registers in the middle of the
+// visible part of a line (split colors within a line, for example) are not
+// reproduced; those changing them between lines are.
+//
+// The output is C64_VISIBLE_X by C64_VISIBLE_Y pixels, four bytes per
+// pixel (red, green, blue, unused), covering the display window and the
+// usual amount of border around it.
+class CVIC
+{
+public:
+   CVIC();
+   virtual ~CVIC();
+
+   static void RESET ( void );
+
+   // Clocks the VIC-II through one system cycle.
+   static void CYCLE ( void );
+
+   // The VIC-II wants the bus in the coming cycle.  The CPU can't read
+   // while it does.
+   static inline bool BA ( void )
+   {
+      int32_t sprite;
+      int32_t idx = m_cycle%VIC_CYCLES_PER_LINE;
+
+      if ( m_badline && (idx >= 11) && (idx <= 53) )
+      {
+         return true;
+      }
+      if ( m_spriteDma )
+      {
+         for ( sprite = 0; sprite < 8; sprite++ )
+         {
+            if ( (m_spriteDma&(1<<sprite)) &&
+                 (((idx-((54+(sprite<<1))%VIC_CYCLES_PER_LINE)+VIC_CYCLES_PER_LINE)%VIC_CYCLES_PER_LINE) < 5) )
+            {
+               return true;
+            }
+         }
+      }
+      return false;
+   }
+
+   // The VIC-II's interrupt output.
+   static inline bool IRQ ( void )
+   {
+      return !!(m_irqLatch&m_irqMask);
+   }
+
+   // Register access by the CPU.  PEEK has no side effects.
+   static uint8_t REG ( uint32_t addr );
+   static void REG ( uint32_t addr, uint8_t data );
+   static uint8_t PEEK ( uint32_t addr );
+
+   // The last byte the VIC-II read, which is what the CPU sees when it
+   // reads from an unconnected part of the I/O area.
+   static inline uint8_t LASTFETCH ( void )
+   {
+      return m_lastFetch;
+   }
+
+   static inline uint32_t _RASTER ( void )
+   {
+      return m_raster;
+   }
+   static inline uint32_t _CYCLE ( void )
+   {
+      return m_cycle;
+   }
+   static inline uint32_t _FRAME ( void )
+   {
+      return m_frame;
+   }
+
+   static inline void TV ( int8_t* pTV )
+   {
+      m_pTV = pTV;
+   }
+   static inline int8_t* TV ( void )
+   {
+      return m_pTV;
+   }
+
+protected:
+   static inline uint8_t FETCH ( uint32_t addr );
+   static void BADLINE ( void );
+   static void RASTERCOMPARE ( void );
+   static void SPRITEDMA ( void );
+   static void RENDERSCANLINE ( void );
+
+   // Register file.
+   static uint8_t  m_regs [ 64 ];
+   static uint8_t  m_irqLatch;
+   static uint8_t  m_irqMask;
+   static uint32_t m_rasterCompare;
+   static uint8_t  m_spriteSpriteCollision;
+   static uint8_t  m_spriteDataCollision;
+
+   // Beam position.  Cycles are numbered from 1 as in the data sheets.
+   static uint32_t m_raster;
+   static uint32_t m_cycle;
+   static uint32_t m_frame;
+
+   // Video matrix and graphics sequencing.
+   static bool     m_badline;
+   static bool     m_denSeen;
+   static bool     m_displayState;
+   static bool     m_verticalBorder;
+   static uint32_t m_vc;
+   static uint32_t m_vcBase;
+   static uint32_t m_rc;
+   static uint8_t  m_videoMatrix [ 40 ];
+   static uint8_t  m_colorLine [ 40 ];
+   static uint8_t  m_lastFetch;
+
+   // Sprite sequencing.
+   static uint8_t  m_spriteDma;
+   static uint8_t  m_spriteDisplay;
+   static uint8_t  m_spriteExpandFF;
+   static uint32_t m_mc [ 8 ];
+   static uint32_t m_mcBase [ 8 ];
+   static uint32_t m_spriteData [ 8 ];
+
+   static int8_t*  m_pTV;
+};
+
+#endif // CC64VIC_H
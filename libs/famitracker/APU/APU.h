@@ -23,6 +23,8 @@
 
 #include <QObject>
 
+#include <vector>
+
 //#define LOGGING
 
 #include "../common.h"
@@ -122,6 +124,8 @@ private:
 	CDPCM		*m_pDPCM;
 
 	// Expansion chips
+	std::vector<CExternal*> m_vExChips;			// Enabled expansion chips
+
 	CVRC6		*m_pVRC6;
 	CMMC5		*m_pMMC5;
 	CFDS		*m_pFDS;
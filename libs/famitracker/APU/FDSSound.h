@@ -1,11 +1,17 @@
 #ifndef _FDSSOUND_H_
 #define _FDSSOUND_H_
 
-void __fastcall FDSSoundReset(void);
-uint8 __fastcall FDSSoundRead(uint16 address);
-void __fastcall FDSSoundWrite(uint16 address, uint8 value);
-int32 __fastcall FDSSoundRender(void);
-void __fastcall FDSSoundVolume(unsigned int volume);
+// State of one FDS sound unit, each CFDS owns its own
+typedef struct FDSSOUND_tag FDSSOUND;
+
+FDSSOUND *FDSSoundAlloc(void);
+void FDSSoundFree(FDSSOUND *fdssound);
+
+void __fastcall FDSSoundReset(FDSSOUND *fdssound);
+uint8 __fastcall FDSSoundRead(FDSSOUND *fdssound, uint16 address);
+void __fastcall FDSSoundWrite(FDSSOUND *fdssound, uint16 address, uint8 value);
+int32 __fastcall FDSSoundRender(FDSSOUND *fdssound);
+void __fastcall FDSSoundVolume(FDSSOUND *fdssound, unsigned int volume);
 void FDSSoundInstall3(void);
 
 #endif /* _FDSSOUND_H_ */
@@ -77,6 +77,9 @@ CMixer::CMixer()
 	m_fLevelFDS = 1.0f;
 
 	m_bNamcoMixing = false;
+
+	m_dSumSS = 0.0;
+	m_dSumTND = 0.0;
 }
 
 CMixer::~CMixer()
@@ -239,14 +242,6 @@ int CMixer::FinishBuffer(int t)
 {
 	BlipBuffer.end_frame(t);
 
-	// Get channel levels for VRC7
-	for (int i = 0; i < 6; ++i)
-		StoreChannelLevel(CHANID_VRC7_CH1 + i, OPLL_getchanvol(i));
-
-	// Get channel levels for Sunsoft
-	for (int i = 0; i < 3; ++i)
-		StoreChannelLevel(CHANID_S5B_CH1 + i, PSG_getchanvol(i));
-
 	for (int i = 0; i < CHANNELS; ++i) {
 		if (m_iChanLevelFallOff[i] > 0)
 			m_iChanLevelFallOff[i]--;
@@ -269,7 +264,6 @@ int CMixer::FinishBuffer(int t)
 
 void CMixer::MixInternal1(int Time)
 {
-	static double LastSum;
 	double Sum, Delta;
 
 #ifdef LINEAR_MIXING
@@ -279,14 +273,13 @@ void CMixer::MixInternal1(int Time)
 	Sum = CalcPin1(m_iChannels[CHANID_SQUARE1], m_iChannels[CHANID_SQUARE2]);
 #endif
 
-	Delta = (Sum - LastSum) * AMP_2A03;
+	Delta = (Sum - m_dSumSS) * AMP_2A03;
 	Synth2A03SS.offset(Time, (int)Delta, &BlipBuffer);
-	LastSum = Sum;
+	m_dSumSS = Sum;
 }
 
 void CMixer::MixInternal2(int Time)
 {
-	static double LastSum;
 	double Sum, Delta;
 
 #ifdef LINEAR_MIXING
@@ -296,9 +289,9 @@ void CMixer::MixInternal2(int Time)
 	Sum = CalcPin2(m_iChannels[CHANID_TRIANGLE], m_iChannels[CHANID_NOISE], m_iChannels[CHANID_DPCM]);
 #endif
 
-	Delta = (Sum - LastSum) * AMP_2A03;
+	Delta = (Sum - m_dSumTND) * AMP_2A03;
 	Synth2A03TND.offset(Time, (int)Delta, &BlipBuffer);
-	LastSum = Sum;
+	m_dSumTND = Sum;
 }
 
 void CMixer::MixN163(int Value, int Time)
@@ -88,6 +88,7 @@ class CMixer
 		int		ReadBuffer(int Size, void *Buffer, bool Stereo);
 
 		int32	GetChanOutput(uint8 Chan) const;
+		void	StoreChannelLevel(int Channel, int Value);
 
 		void	SetChipLevel(int Chip, float Level);
 
@@ -108,8 +109,6 @@ class CMixer
 		void MixMMC5(int Value, int Time);
 		void MixS5B(int Value, int Time);
 
-		void StoreChannelLevel(int Channel, int Value);
-
 		// Blip buffer synths
 		Blip_Synth<blip_good_quality, -500>		Synth2A03SS;
 		Blip_Synth<blip_good_quality, -500>		Synth2A03TND;
@@ -146,6 +145,9 @@ class CMixer
 		float		m_fLevelFDS;
 
 		bool		m_bNamcoMixing;
+
+		double		m_dSumSS;						// Last output of APU audio pin 1
+		double		m_dSumTND;						// Last output of APU audio pin 2
 };
 
 #endif /* _MIXER_H_ */
\ No newline at end of file
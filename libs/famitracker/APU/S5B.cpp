@@ -25,8 +25,6 @@
 
 // Sunsoft 5B (YM2149)
 
-PSG *psg;
-
 float CS5B::AMPLIFY = 2.0f;
 
 CS5B::CS5B(CMixer *pMixer)
@@ -35,13 +33,15 @@ CS5B::CS5B(CMixer *pMixer)
 
 	m_fVolume = AMPLIFY;
 
-	psg = NULL;
+	m_pPSG = NULL;
+	m_iBufferPtr = 0;
+	m_iLastSample = 0;
 }
 
 CS5B::~CS5B()
 {
-	if (psg)
-		PSG_delete(psg);
+	if (m_pPSG)
+		PSG_delete(m_pPSG);
 }
 
 void CS5B::Reset()
@@ -55,9 +55,6 @@ void CS5B::Process(uint32 Time)
 	m_iTime += Time;
 }
 
-int16 m_pBuffer[4000];
-uint32 m_iBufferPtr = 0;
-
 void CS5B::EndFrame()
 {
 	GetMixMono();
@@ -65,15 +62,13 @@ void CS5B::EndFrame()
 
 void CS5B::GetMixMono()
 {
-	static int32 LastSample = 0;
-
 	uint32 WantSamples = m_pMixer->GetMixSampleCount(m_iTime);
 
 	// Generate samples
 	while (m_iBufferPtr < WantSamples) {
-		int32 Sample = int32(float(PSG_calc(psg)) * m_fVolume);
-		m_pBuffer[m_iBufferPtr++] = int16((Sample + LastSample) >> 1);
-		LastSample = Sample;
+		int32 Sample = int32(float(PSG_calc(m_pPSG)) * m_fVolume);
+		m_pBuffer[m_iBufferPtr++] = int16((Sample + m_iLastSample) >> 1);
+		m_iLastSample = Sample;
 	}
 
 	m_pMixer->MixSamples((blip_sample_t*)m_pBuffer, WantSamples);
@@ -89,7 +84,7 @@ void CS5B::Write(uint16 Address, uint8 Value)
 			m_iRegister = Value & 0xF;
 			break;
 		case 0xE000:
-			PSG_writeReg(psg, m_iRegister, Value);
+			PSG_writeReg(m_pPSG, m_iRegister, Value);
 			break;
 	}
 }
@@ -101,16 +96,24 @@ uint8 CS5B::Read(uint16 Address, bool &Mapped)
 	return 0;
 }
 
+int32 CS5B::GetChannelLevel(int Channel)
+{
+	if (m_pPSG == NULL)
+		return 0;
+
+	return PSG_getchanvol(m_pPSG, Channel);
+}
+
 void CS5B::SetSampleSpeed(uint32 SampleRate, double ClockRate, uint32 FrameRate)
 {
-	if (psg != NULL) {
-		PSG_delete(psg);
+	if (m_pPSG != NULL) {
+		PSG_delete(m_pPSG);
 	}
 
 	//PSG_init((uint32)ClockRate, SampleRate);
-	psg = PSG_new((uint32)ClockRate, SampleRate);
-	PSG_setVolumeMode(psg, 1);
-	PSG_reset(psg);
+	m_pPSG = PSG_new((uint32)ClockRate, SampleRate);
+	PSG_setVolumeMode(m_pPSG, 1);
+	PSG_reset(m_pPSG);
 
 //	psg = PSG_new();
 
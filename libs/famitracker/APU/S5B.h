@@ -3,6 +3,7 @@
 
 #include "external.h"
 #include "channel.h"
+#include "emu2149.h"
 
 class CS5B : public CExternal {
 public:
@@ -15,6 +16,7 @@ public:
 	uint8 	Read(uint16 Address, bool &Mapped);
 	void	SetSampleSpeed(uint32 SampleRate, double ClockRate, uint32 FrameRate);
 	void	SetVolume(float fVol);
+	int32	GetChannelLevel(int Channel);
 //	void	SetChannelVolume(int Chan, int LevelL, int LevelR);
 protected:
 	void	GetMixMono();
@@ -28,6 +30,11 @@ private:
 
 	float	m_fVolume;
 
+	PSG		*m_pPSG;
+	int16	m_pBuffer[4000];
+	uint32	m_iBufferPtr;
+	int32	m_iLastSample;
+
 };
 
 #endif /* _S5B_H_ */
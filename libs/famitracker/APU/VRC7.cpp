@@ -26,7 +26,7 @@
 const float  CVRC7::AMPLIFY	  = 2.88f;		// Mixing amplification, VRC7 patch 14 is 4,88 times stronger than a 50% square @ v=15
 const uint32 CVRC7::OPL_CLOCK = 3579545;	// Clock frequency
 
-CVRC7::CVRC7(CMixer *pMixer) : CExternal(pMixer), m_pBuffer(NULL), m_pOPLLInt(NULL), m_fVolume(1.0f)
+CVRC7::CVRC7(CMixer *pMixer) : CExternal(pMixer), m_pBuffer(NULL), m_pOPLLInt(NULL), m_fVolume(1.0f), m_iLastSample(0)
 {
 	Reset();
 }
@@ -92,13 +92,11 @@ void CVRC7::EndFrame()
 {
 	uint32 WantSamples = m_pMixer->GetMixSampleCount(m_iTime);
 
-	static int32 LastSample = 0;
-
 	// Generate VRC7 samples
 	while (m_iBufferPtr < WantSamples) {
 		int32 Sample = int(float(OPLL_calc(m_pOPLLInt)) * m_fVolume);
-		m_pBuffer[m_iBufferPtr++] = int16((Sample + LastSample) >> 1);
-		LastSample = Sample;
+		m_pBuffer[m_iBufferPtr++] = int16((Sample + m_iLastSample) >> 1);
+		m_iLastSample = Sample;
 	}
 
 	m_pMixer->MixSamples((blip_sample_t*)m_pBuffer, WantSamples);
@@ -107,6 +105,15 @@ void CVRC7::EndFrame()
 	m_iTime = 0;
 }
 
+int32 CVRC7::GetChannelLevel(int Channel)
+{
+	// Reading the level also resets the peak
+	if (m_pOPLLInt == NULL)
+		return 0;
+
+	return OPLL_getchanvol(m_pOPLLInt, Channel);
+}
+
 void CVRC7::Process(uint32 Time)
 {
 	// This cannot run in sync, fetch all samples at end of frame instead
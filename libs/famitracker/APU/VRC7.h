@@ -36,6 +36,7 @@ public:
 	uint8 Read(uint16 Address, bool &Mapped);
 	void EndFrame();
 	void Process(uint32 Time);
+	int32 GetChannelLevel(int Channel);
 
 protected:
 	static const float  AMPLIFY;
@@ -48,6 +49,7 @@ private:
 
 	int16	*m_pBuffer;
 	uint32	m_iBufferPtr;
+	int32	m_iLastSample;
 
 	uint8	m_iSoundReg;
 
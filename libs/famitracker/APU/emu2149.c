@@ -39,7 +39,6 @@ static uint32 voltbl[2][32] = {
 
 #define GETA_BITS 24
 
-int32 psg_volumes[3];
 
 static void
 internal_refresh (PSG * psg)
@@ -81,6 +80,8 @@ PSG_new (uint32 c, uint32 r)
   if (psg == NULL)
     return NULL;
 
+  memset (psg->chanvol, 0, sizeof (psg->chanvol));
+
   PSG_setVolumeMode (psg, EMU2149_VOL_DEFAULT);
   psg->clk = c;
   psg->rate = r ? r : 44100;
@@ -273,7 +274,7 @@ calc (PSG * psg)
       else
         psg->cout[i] = psg->voltbl[psg->env_ptr];
 
-	  psg_volumes[i] = psg->cout[i];
+	  psg->chanvol[i] = psg->cout[i];
 	  mix += psg->cout[i];
     }
 
@@ -367,7 +368,7 @@ PSG_writeReg (PSG * psg, uint32 reg, uint32 val)
 }
 
 
-int32 PSG_getchanvol(int i)
+int32 PSG_getchanvol(PSG *psg, int i)
 {
-	return psg_volumes[i];
+	return psg->chanvol[i];
 }
\ No newline at end of file
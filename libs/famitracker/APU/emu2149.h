@@ -78,6 +78,9 @@ extern "C"
     /* I/O Ctrl */
     uint32 adr;
 
+    /* Channel levels for the meters */
+    int32 chanvol[3];
+
   }
   PSG;
 
@@ -95,7 +98,7 @@ extern "C"
   EMU2149_API uint32 PSG_setMask (PSG *, uint32 mask);
   EMU2149_API uint32 PSG_toggleMask (PSG *, uint32 mask);
 
-  int32 PSG_getchanvol(int i);
+  int32 PSG_getchanvol(PSG * psg, int i);
 
 #ifdef __cplusplus
 }
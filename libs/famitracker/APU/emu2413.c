@@ -209,7 +209,6 @@ static int32 rksTable[2][8][2];
 static uint32 dphaseTable[512][8][16];
 
 // Added by jsr
-int32 opll_volumes[10];
 
 /***************************************************
  
@@ -1407,8 +1406,8 @@ calc (OPLL * opll)
 		int32 absval, val = calc_slot_car (CAR(opll,i), calc_slot_mod(MOD(opll,i)));
 		inst += val;
 		absval = abs(val);
-		if (absval > opll_volumes[i])
-			opll_volumes[i] = val;
+		if (absval > opll->chanvol[i])
+			opll->chanvol[i] = val;
 	  }
 
   /* CH6 */
@@ -1861,9 +1860,9 @@ OPLL_calc_stereo (OPLL * opll, int32 out[2])
 #endif /* EMU2413_COMPACTION */
 
 
-int32 OPLL_getchanvol(int i)
+int32 OPLL_getchanvol(OPLL *opll, int i)
 {
-	int retval = opll_volumes[i];
-	opll_volumes[i] = 0;
+	int retval = opll->chanvol[i];
+	opll->chanvol[i] = 0;
 	return retval;
 }
\ No newline at end of file
@@ -26,6 +26,7 @@ const int VOL_SHIFT = 3;
 //enum {SEQ_RUN, SEQ_DISABLED, SEQ_RELEASE, SEQ_WAIT, SEQ_HALT};
 
 class CAPU;
+class CSoundGen;
 
 // TODO: A lot of cleanup is needed in these files!
 
@@ -43,7 +44,7 @@ public:
 	void ReleaseNote();												// Called on note release commands
 
 	// Public functions
-	void InitChannel(CAPU *pAPU, int *pVibTable, CFamiTrackerDoc *pDoc);
+	void InitChannel(CAPU *pAPU, int *pVibTable, CFamiTrackerDoc *pDoc, CSoundGen *pSoundGen);
 	void KillChannel();
 	void MakeSilent();
 	void Arpeggiate(unsigned int Note);
@@ -167,6 +168,7 @@ protected:
 	// Misc 
 	CAPU				*m_pAPU;
 	CFamiTrackerDoc		*m_pDocument;
+	CSoundGen			*m_pSoundGen;				// The sound generator this channel plays in
 
 	unsigned int		*m_pNoteLookupTable;		// Note->period table
 	int					*m_pVibratoTable;			// Vibrato table
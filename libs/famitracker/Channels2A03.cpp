@@ -27,6 +27,7 @@
 #include "ChannelHandler.h"
 #include "Channels2A03.h"
 #include "Settings.h"
+#include "SoundGen.h"
 
 #ifdef _DEBUG
 void ClearLog();
@@ -408,7 +409,7 @@ void CNoiseChan::ClearRegisters()
 
 unsigned int CNoiseChan::TriggerNote(int Note)
 {
-	theApp.RegisterKeyState(m_iChannelID, Note);
+	m_pSoundGen->RegisterKeyState(m_iChannelID, Note);
 	return Note;
 }
 
@@ -538,7 +539,7 @@ void CDPCMChan::PlayChannelNote(stChanNote *pNoteData, int EffColumns)
 		}
 	}
 
-	theApp.RegisterKeyState(m_iChannelID, (Note - 1) + (Octave * 12));
+	m_pSoundGen->RegisterKeyState(m_iChannelID, (Note - 1) + (Octave * 12));
 }
 
 void CDPCMChan::RefreshChannel()
@@ -594,7 +595,7 @@ void CDPCMChan::ClearRegisters()
 	m_pAPU->Write(0x4015, 0x0F);
 	m_pAPU->Write(0x4010, 0);
 	
-	if (!theApp.GetSettings()->General.bNoDPCMReset || theApp.IsPlaying()) {
+	if (!theApp.GetSettings()->General.bNoDPCMReset || m_pSoundGen->IsPlaying()) {
 		m_pAPU->Write(0x4011, 0);		// regain full volume for TN
 	}
 
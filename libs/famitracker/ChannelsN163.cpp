@@ -264,6 +264,6 @@ void CChannelHandlerN163::LoadWave()
 void CChannelHandlerN163::CheckWaveUpdate()
 {
 	// Check wave changes
-	if (theApp.GetSoundGenerator()->HasWaveChanged())
+	if (m_pSoundGen->HasWaveChanged())
 		m_bLoadWave = true;
 }
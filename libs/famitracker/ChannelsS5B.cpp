@@ -29,88 +29,82 @@
 
 //const int CChannelHandlerS5B::SEQ_TYPES[] = {SEQ_VOLUME, SEQ_ARPEGGIO, SEQ_PITCH, SEQ_HIPITCH, SEQ_SUNSOFT_NOISE};
 
-static int gModes = 0;
-static int gNoiseFreq = 0;
-static unsigned char gEnvFreqHi = 0;
-static unsigned char gEnvFreqLo = 0;
-static int gEnvType = 0;
-static bool gRegsDirty = false;
-
-static void SetEnvelopeHigh(int Val)
+CChannelHandlerS5B::CChannelHandlerS5B(stS5BSharedRegs *pSharedRegs) : CChannelHandler(), m_pSharedRegs(pSharedRegs), m_iNoiseOffset(0), m_bUpdate(false)
 {
-	gEnvFreqHi = Val;
-	gRegsDirty = true;
+	SetMaxPeriod(0xFFF);
+}
+
+void CChannelHandlerS5B::SetEnvelopeHigh(int Val)
+{
+	m_pSharedRegs->EnvFreqHi = Val;
+	m_pSharedRegs->Dirty = true;
 }
 
-static void SetEnvelopeLow(int Val)
+void CChannelHandlerS5B::SetEnvelopeLow(int Val)
 {
-	gEnvFreqLo = Val;
-	gRegsDirty = true;
+	m_pSharedRegs->EnvFreqLo = Val;
+	m_pSharedRegs->Dirty = true;
 }
 
-static void SetEnvelopeType(int Val)
+void CChannelHandlerS5B::SetEnvelopeType(int Val)
 {
-	gEnvType = Val;
-	gRegsDirty = true;
+	m_pSharedRegs->EnvType = Val;
+	m_pSharedRegs->Dirty = true;
 }
 
-static void SetMode(int Chan, int Square, int Noise)
+void CChannelHandlerS5B::SetMode(int Chan, int Square, int Noise)
 {
-	int initModes = gModes;
+	int initModes = m_pSharedRegs->Modes;
 
 	switch (Chan) {
 		case 0:
-			gModes &= 0x36;
+			m_pSharedRegs->Modes &= 0x36;
 			break;
 		case 1:
-			gModes &= 0x2D;
+			m_pSharedRegs->Modes &= 0x2D;
 			break;
 		case 2:
-			gModes &= 0x1B;
+			m_pSharedRegs->Modes &= 0x1B;
 			break;
 	}
 
-	gModes |= (Noise << (3 + Chan)) | (Square << Chan);
+	m_pSharedRegs->Modes |= (Noise << (3 + Chan)) | (Square << Chan);
 	
-	if (gModes != initModes) {
-		gRegsDirty = true;
+	if (m_pSharedRegs->Modes != initModes) {
+		m_pSharedRegs->Dirty = true;
 	}
 }
 
-static void SetNoiseFreq(int Freq)
+void CChannelHandlerS5B::SetNoiseFreq(int Freq)
 {
-	gNoiseFreq = Freq;
-	gRegsDirty = true;
+	m_pSharedRegs->NoiseFreq = Freq;
+	m_pSharedRegs->Dirty = true;
 }
 
-static void UpdateRegs(CAPU *pAPU)
+void CChannelHandlerS5B::UpdateRegs()
 {
-	if (!gRegsDirty)
+	if (!m_pSharedRegs->Dirty)
 		return;
 
 	// Done only once
-	pAPU->ExternalWrite(0xC000, 0x07);
-	pAPU->ExternalWrite(0xE000, gModes);
+	m_pAPU->ExternalWrite(0xC000, 0x07);
+	m_pAPU->ExternalWrite(0xE000, m_pSharedRegs->Modes);
 
-	pAPU->ExternalWrite(0xC000, 0x06);
-	pAPU->ExternalWrite(0xE000, gNoiseFreq);
+	m_pAPU->ExternalWrite(0xC000, 0x06);
+	m_pAPU->ExternalWrite(0xE000, m_pSharedRegs->NoiseFreq);
 
-	pAPU->ExternalWrite(0xC000, 0x0B);
-	pAPU->ExternalWrite(0xE000, gEnvFreqLo);
+	m_pAPU->ExternalWrite(0xC000, 0x0B);
+	m_pAPU->ExternalWrite(0xE000, m_pSharedRegs->EnvFreqLo);
 
-	pAPU->ExternalWrite(0xC000, 0x0C);
-	pAPU->ExternalWrite(0xE000, gEnvFreqHi);
+	m_pAPU->ExternalWrite(0xC000, 0x0C);
+	m_pAPU->ExternalWrite(0xE000, m_pSharedRegs->EnvFreqHi);
 
-	pAPU->ExternalWrite(0xC000, 0x0D);
-	pAPU->ExternalWrite(0xE000, gEnvType);
+	m_pAPU->ExternalWrite(0xC000, 0x0D);
+	m_pAPU->ExternalWrite(0xE000, m_pSharedRegs->EnvType);
 
-	gRegsDirty = false;
+	m_pSharedRegs->Dirty = false;
 }
 
-CChannelHandlerS5B::CChannelHandlerS5B() : CChannelHandler(), m_iNoiseOffset(0), m_bUpdate(false)
-{
-	SetMaxPeriod(0xFFF);
-}
 /*
 bool NoteValid(int Note)
 {
@@ -255,7 +249,7 @@ void CS5BChannel1::RefreshChannel()
 	if (!Noise)
 		SetNoiseFreq(NoisePeriod);
 
-//	UpdateRegs(m_pAPU);
+//	UpdateRegs();
 
 //	m_bEnabled = false;
 }
@@ -335,7 +329,7 @@ void CS5BChannel3::RefreshChannel()
 	if (!Noise)
 		SetNoiseFreq(NoisePeriod);
 
-	UpdateRegs(m_pAPU);
+	UpdateRegs();
 }
 
 void CS5BChannel3::ClearRegisters()
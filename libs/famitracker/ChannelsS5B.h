@@ -24,9 +24,20 @@
 // Derived channels, 5B
 //
 
+// Registers the three channels share, they are written when channel 3 is refreshed
+struct stS5BSharedRegs {
+	stS5BSharedRegs() : Modes(0), NoiseFreq(0), EnvFreqHi(0), EnvFreqLo(0), EnvType(0), Dirty(false) {};
+	int Modes;
+	int NoiseFreq;
+	unsigned char EnvFreqHi;
+	unsigned char EnvFreqLo;
+	int EnvType;
+	bool Dirty;
+};
+
 class CChannelHandlerS5B : public CChannelHandler {
 public:
-	CChannelHandlerS5B();
+	CChannelHandlerS5B(stS5BSharedRegs *pSharedRegs);
 	virtual void ProcessChannel();
 
 protected:
@@ -35,7 +46,16 @@ protected:
 protected:
 	void WriteReg(int Reg, int Value);
 
+	void SetEnvelopeHigh(int Val);
+	void SetEnvelopeLow(int Val);
+	void SetEnvelopeType(int Val);
+	void SetMode(int Chan, int Square, int Noise);
+	void SetNoiseFreq(int Freq);
+	void UpdateRegs();
+
 protected:
+	stS5BSharedRegs *m_pSharedRegs;
+
 	int m_iNoiseOffset;
 	bool m_bEnvEnable;
 
@@ -54,19 +74,22 @@ protected:
 
 };
 
-// Channel 1
+// Channel 1, owns the shared registers
 class CS5BChannel1 : public CChannelHandlerS5B {
 public:
-	CS5BChannel1() : CChannelHandlerS5B() { m_iDefaultDuty = 0; m_bEnabled = false; };
+	CS5BChannel1() : CChannelHandlerS5B(&m_SharedRegs) { m_iDefaultDuty = 0; m_bEnabled = false; };
 	void RefreshChannel();
+	stS5BSharedRegs *GetSharedRegs() { return &m_SharedRegs; };
 protected:
 	void ClearRegisters();
+private:
+	stS5BSharedRegs m_SharedRegs;
 };
 
 // Channel 2
 class CS5BChannel2 : public CChannelHandlerS5B {
 public:
-	CS5BChannel2() : CChannelHandlerS5B() { m_iDefaultDuty = 0; m_bEnabled = false; };
+	CS5BChannel2(stS5BSharedRegs *pSharedRegs) : CChannelHandlerS5B(pSharedRegs) { m_iDefaultDuty = 0; m_bEnabled = false; };
 	void RefreshChannel();
 protected:
 	void ClearRegisters();
@@ -75,7 +98,7 @@ protected:
 // Channel 3
 class CS5BChannel3 : public CChannelHandlerS5B {
 public:
-	CS5BChannel3() : CChannelHandlerS5B() { m_iDefaultDuty = 0; m_bEnabled = false; };
+	CS5BChannel3(stS5BSharedRegs *pSharedRegs) : CChannelHandlerS5B(pSharedRegs) { m_iDefaultDuty = 0; m_bEnabled = false; };
 	void RefreshChannel();
 protected:
 	void ClearRegisters();
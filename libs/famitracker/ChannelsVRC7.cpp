@@ -25,6 +25,7 @@
 #include "FamiTrackerDoc.h"
 #include "ChannelHandler.h"
 #include "ChannelsVRC7.h"
+#include "SoundGen.h"
 
 #define OPL_NOTE_ON 0x10
 #define OPL_SUSTAIN_ON 0x20
@@ -179,12 +180,12 @@ void CChannelHandlerVRC7::PlayChannelNote(stChanNote *pNoteData, int EffColumns)
 	if (pNoteData->Note == HALT) {
 		// Halt
 		m_iCommand = CMD_NOTE_HALT;
-		theApp.RegisterKeyState(m_iChannelID, -1);
+		m_pSoundGen->RegisterKeyState(m_iChannelID, -1);
 	}
 	else if (pNoteData->Note == RELEASE) {
 		// Release
 		m_iCommand = CMD_NOTE_RELEASE;
-		theApp.RegisterKeyState(m_iChannelID, -1);
+		m_pSoundGen->RegisterKeyState(m_iChannelID, -1);
 	}
 	else if (pNoteData->Note != NONE) {
 
@@ -287,7 +288,7 @@ void CChannelHandlerVRC7::ResetChannel()
 unsigned int CChannelHandlerVRC7::TriggerNote(int Note)
 {
 	m_iTriggeredNote = Note;
-	theApp.RegisterKeyState(m_iChannelID, Note);
+	m_pSoundGen->RegisterKeyState(m_iChannelID, Note);
 	if (m_iCommand != CMD_NOTE_TRIGGER && m_iCommand != CMD_NOTE_HALT)
 		m_iCommand = CMD_NOTE_ON;
 	m_bEnabled = true;
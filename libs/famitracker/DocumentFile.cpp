@@ -41,16 +41,40 @@ const unsigned int CDocumentFile::BLOCK_SIZE = 0x10000;
 
 CDocumentFile::CDocumentFile() : 
 	m_pBlockData(NULL),
-	m_cBlockID(new char[16])
+	m_cBlockID(new char[16]),
+	m_pMapData(NULL),
+	m_iMapSize(0),
+	m_iMapPos(0),
+	m_bBlockMapped(false)
 {
 }
 
 CDocumentFile::~CDocumentFile()
 {
-	SAFE_RELEASE_ARRAY(m_pBlockData);
+	ReleaseBlock();
 	SAFE_RELEASE_ARRAY(m_cBlockID);
 }
 
+void CDocumentFile::Close()
+{
+	// Blocks read in place go away with the mapping
+	ReleaseBlock();
+	m_pMapData = NULL;
+	m_iMapSize = 0;
+
+	CFile::Close();
+}
+
+void CDocumentFile::ReleaseBlock()
+{
+	if (m_bBlockMapped)
+		m_pBlockData = NULL;
+	else
+		SAFE_RELEASE_ARRAY(m_pBlockData);
+
+	m_bBlockMapped = false;
+}
+
 bool CDocumentFile::Finished() const
 {
 	return m_bFileDone;
@@ -94,6 +118,7 @@ void CDocumentFile::CreateBlock(const char *ID, int Version)
 
 	m_iMaxBlockSize = BLOCK_SIZE;
 
+	ReleaseBlock();
 	m_pBlockData = new char[m_iMaxBlockSize];
 
 	ASSERT(m_pBlockData != NULL);
@@ -176,6 +201,32 @@ bool CDocumentFile::FlushBlock()
 	return true;
 }
 
+bool CDocumentFile::MapFile()
+{
+	// Maps the file so blocks can be read without copying them, call
+	// after CheckValidity. Blocks are read from the file if this fails.
+
+	m_pMapData = Map();
+	m_iMapSize = m_pMapData ? (unsigned int)GetLength() : 0;
+	m_iMapPos = (unsigned int)strlen(FILE_HEADER_ID) + 4;
+
+	return m_pMapData != NULL;
+}
+
+unsigned int CDocumentFile::ReadData(void *Buffer, unsigned int Size)
+{
+	if (!m_pMapData)
+		return Read(Buffer, Size);
+
+	if (Size > m_iMapSize - m_iMapPos)
+		Size = m_iMapSize - m_iMapPos;
+
+	memcpy(Buffer, m_pMapData + m_iMapPos, Size);
+	m_iMapPos += Size;
+
+	return Size;
+}
+
 bool CDocumentFile::CheckValidity()
 {
 	// Checks if loaded file is valid
@@ -211,9 +262,9 @@ bool CDocumentFile::ReadBlock()
 	
 	memset(m_cBlockID, 0, 16);
 
-	BytesRead = Read(m_cBlockID, 16);
-	Read(&m_iBlockVersion, sizeof(int));
-	Read(&m_iBlockSize, sizeof(int));
+	BytesRead = ReadData(m_cBlockID, 16);
+	ReadData(&m_iBlockVersion, sizeof(int));
+	ReadData(&m_iBlockSize, sizeof(int));
 
 	if (m_iBlockSize > 50000000) {
 		// File is probably corrupt
@@ -221,10 +272,23 @@ bool CDocumentFile::ReadBlock()
 		return true;
 	}
 
-	SAFE_RELEASE_ARRAY(m_pBlockData);
-	m_pBlockData = new char[m_iBlockSize];
-
-	Read(m_pBlockData, m_iBlockSize);
+	ReleaseBlock();
+
+	if (m_pMapData) {
+		// Read the block in place
+		if (m_iBlockSize > m_iMapSize - m_iMapPos) {
+			memset(m_cBlockID, 0, 16);
+			m_bIncomplete = true;
+			return true;
+		}
+		m_pBlockData = (char*)(m_pMapData + m_iMapPos);
+		m_bBlockMapped = true;
+		m_iMapPos += m_iBlockSize;
+	}
+	else {
+		m_pBlockData = new char[m_iBlockSize];
+		Read(m_pBlockData, m_iBlockSize);
+	}
 
 	if (strcmp(m_cBlockID, FILE_END_ID) == 0)
 		m_bFileDone = true;
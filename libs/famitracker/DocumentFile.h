@@ -30,6 +30,8 @@ public:
 
 	bool		Finished() const;
 
+	virtual void Close();
+
 	// Write functions
 	bool		BeginDocument();
 	bool		EndDocument();
@@ -42,6 +44,7 @@ public:
 	bool		FlushBlock();
 
 	// Read functions
+	bool		MapFile();
 	bool		CheckValidity();
 	unsigned int GetFileVersion() const;
 
@@ -75,6 +78,8 @@ public:
 
 protected:
 	void ReallocateBlock();
+	void ReleaseBlock();
+	unsigned int ReadData(void *Buffer, unsigned int Size);
 
 protected:
 	unsigned int	m_iFileVersion;
@@ -89,4 +94,10 @@ protected:
 	unsigned int	m_iMaxBlockSize;
 
 	unsigned int	m_iBlockPointer;	
+
+	// Memory mapped file, blocks are read in place
+	const BYTE		*m_pMapData;
+	unsigned int	m_iMapSize;
+	unsigned int	m_iMapPos;
+	bool			m_bBlockMapped;
 };
@@ -0,0 +1,247 @@
+//    NESICIDE - an IDE for the 8-bit NES.
+//    Copyright (C) 2009  Christopher S. Pow
+
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <math.h>
+#include <string.h>
+#include "RealFft.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FFT_AVX
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define FFT_SSE
+#endif
+
+static const double FFT_PI = 3.14159265358979323846;
+
+template <class T>
+static void FillTape(float *pTape, int Points, int &Pos, const T *pSamples, int Count)
+{
+	// Only the last window's worth matters
+	if (Count > Points) {
+		pSamples += Count - Points;
+		Count = Points;
+	}
+
+	for (int i = 0; i < Count; ++i) {
+		pTape[Pos] = float(pSamples[i]);
+		Pos = (Pos + 1) & (Points - 1);
+	}
+}
+
+// One radix-2 stage of a group, A += W * B and B = A - W * B
+static void Butterflies(float *pAr, float *pAi, float *pBr, float *pBi, const float *pWr, const float *pWi, int Count)
+{
+	int i = 0;
+
+#ifdef FFT_AVX
+	for (; i + 8 <= Count; i += 8) {
+		__m256 Wr = _mm256_loadu_ps(pWr + i);
+		__m256 Wi = _mm256_loadu_ps(pWi + i);
+		__m256 Br = _mm256_loadu_ps(pBr + i);
+		__m256 Bi = _mm256_loadu_ps(pBi + i);
+		__m256 Tr = _mm256_sub_ps(_mm256_mul_ps(Br, Wr), _mm256_mul_ps(Bi, Wi));
+		__m256 Ti = _mm256_add_ps(_mm256_mul_ps(Br, Wi), _mm256_mul_ps(Bi, Wr));
+		__m256 Ar = _mm256_loadu_ps(pAr + i);
+		__m256 Ai = _mm256_loadu_ps(pAi + i);
+		_mm256_storeu_ps(pBr + i, _mm256_sub_ps(Ar, Tr));
+		_mm256_storeu_ps(pBi + i, _mm256_sub_ps(Ai, Ti));
+		_mm256_storeu_ps(pAr + i, _mm256_add_ps(Ar, Tr));
+		_mm256_storeu_ps(pAi + i, _mm256_add_ps(Ai, Ti));
+	}
+#endif
+
+#ifdef FFT_SSE
+	for (; i + 4 <= Count; i += 4) {
+		__m128 Wr = _mm_loadu_ps(pWr + i);
+		__m128 Wi = _mm_loadu_ps(pWi + i);
+		__m128 Br = _mm_loadu_ps(pBr + i);
+		__m128 Bi = _mm_loadu_ps(pBi + i);
+		__m128 Tr = _mm_sub_ps(_mm_mul_ps(Br, Wr), _mm_mul_ps(Bi, Wi));
+		__m128 Ti = _mm_add_ps(_mm_mul_ps(Br, Wi), _mm_mul_ps(Bi, Wr));
+		__m128 Ar = _mm_loadu_ps(pAr + i);
+		__m128 Ai = _mm_loadu_ps(pAi + i);
+		_mm_storeu_ps(pBr + i, _mm_sub_ps(Ar, Tr));
+		_mm_storeu_ps(pBi + i, _mm_sub_ps(Ai, Ti));
+		_mm_storeu_ps(pAr + i, _mm_add_ps(Ar, Tr));
+		_mm_storeu_ps(pAi + i, _mm_add_ps(Ai, Ti));
+	}
+#endif
+
+	for (; i < Count; ++i) {
+		float Tr = pBr[i] * pWr[i] - pBi[i] * pWi[i];
+		float Ti = pBr[i] * pWi[i] + pBi[i] * pWr[i];
+		pBr[i] = pAr[i] - Tr;
+		pBi[i] = pAi[i] - Ti;
+		pAr[i] += Tr;
+		pAi[i] += Ti;
+	}
+}
+
+CRealFFT::CRealFFT(int Points, int SampleRate) :
+	m_iPoints(Points),
+	m_iHalf(Points / 2),
+	m_iSampleRate(SampleRate),
+	m_iTapePos(0),
+	m_bNewSamples(false)
+{
+	int Bits = 0;
+
+	m_pTape = new float[m_iPoints];
+	m_pWindow = new float[m_iPoints];
+	m_pBitReverse = new int[m_iHalf];
+	m_pTwiddleRe = new float[m_iHalf];
+	m_pTwiddleIm = new float[m_iHalf];
+	m_pSplitRe = new float[m_iHalf];
+	m_pSplitIm = new float[m_iHalf];
+	m_pRe = new float[m_iHalf];
+	m_pIm = new float[m_iHalf];
+	m_pMagnitude = new float[m_iHalf];
+
+	// Hann window, scaled so a full scale sine reads as its amplitude
+	for (int i = 0; i < m_iPoints; ++i)
+		m_pWindow[i] = float(0.5 - 0.5 * cos(2.0 * FFT_PI * i / m_iPoints));
+	m_fScale = 4.0f / float(m_iPoints);
+
+	while ((1 << Bits) < m_iHalf)
+		++Bits;
+	for (int i = 0; i < m_iHalf; ++i) {
+		int Rev = 0;
+		for (int b = 0; b < Bits; ++b) {
+			if (i & (1 << b))
+				Rev |= 1 << (Bits - 1 - b);
+		}
+		m_pBitReverse[i] = Rev;
+	}
+
+	// Stage with groups of 2 * Half points starts at Half - 4
+	for (int Half = 4; Half < m_iHalf; Half <<= 1) {
+		for (int j = 0; j < Half; ++j) {
+			m_pTwiddleRe[Half - 4 + j] = float(cos(FFT_PI * j / Half));
+			m_pTwiddleIm[Half - 4 + j] = float(-sin(FFT_PI * j / Half));
+		}
+	}
+
+	for (int k = 0; k < m_iHalf; ++k) {
+		m_pSplitRe[k] = float(cos(2.0 * FFT_PI * k / m_iPoints));
+		m_pSplitIm[k] = float(-sin(2.0 * FFT_PI * k / m_iPoints));
+	}
+
+	Clear();
+}
+
+CRealFFT::~CRealFFT()
+{
+	delete [] m_pTape;
+	delete [] m_pWindow;
+	delete [] m_pBitReverse;
+	delete [] m_pTwiddleRe;
+	delete [] m_pTwiddleIm;
+	delete [] m_pSplitRe;
+	delete [] m_pSplitIm;
+	delete [] m_pRe;
+	delete [] m_pIm;
+	delete [] m_pMagnitude;
+}
+
+void CRealFFT::AddSamples(const int *pSamples, int Count)
+{
+	FillTape(m_pTape, m_iPoints, m_iTapePos, pSamples, Count);
+	m_bNewSamples = m_bNewSamples || (Count > 0);
+}
+
+void CRealFFT::AddSamples(const short *pSamples, int Count)
+{
+	FillTape(m_pTape, m_iPoints, m_iTapePos, pSamples, Count);
+	m_bNewSamples = m_bNewSamples || (Count > 0);
+}
+
+void CRealFFT::Clear()
+{
+	memset(m_pTape, 0, sizeof(float) * m_iPoints);
+	memset(m_pMagnitude, 0, sizeof(float) * m_iHalf);
+	m_iTapePos = 0;
+	m_bNewSamples = false;
+}
+
+bool CRealFFT::Transform()
+{
+	const int Mask = m_iPoints - 1;
+
+	if (!m_bNewSamples)
+		return false;
+
+	m_bNewSamples = false;
+
+	// Window the tape, oldest sample first, and pack even and odd samples
+	// into one complex sequence in bit reversed order
+	for (int n = 0; n < m_iHalf; ++n) {
+		int Pos = (m_iTapePos + 2 * n) & Mask;
+		int Rev = m_pBitReverse[n];
+		m_pRe[Rev] = m_pTape[Pos] * m_pWindow[2 * n];
+		m_pIm[Rev] = m_pTape[(Pos + 1) & Mask] * m_pWindow[2 * n + 1];
+	}
+
+	ComplexTransform();
+
+	// Split into the spectra of the even and odd samples, E and O, and
+	// combine them into X[k] = E[k] + W^k * O[k]
+	m_pMagnitude[0] = fabsf(m_pRe[0] + m_pIm[0]) * m_fScale * 0.5f;
+
+	for (int k = 1; k < m_iHalf; ++k) {
+		float Ar = m_pRe[k], Ai = m_pIm[k];
+		float Br = m_pRe[m_iHalf - k], Bi = m_pIm[m_iHalf - k];
+		float Er = Ar + Br, Ei = Ai - Bi;
+		float Or = Ai + Bi, Oi = Br - Ar;
+		float Xr = Er + m_pSplitRe[k] * Or - m_pSplitIm[k] * Oi;
+		float Xi = Ei + m_pSplitRe[k] * Oi + m_pSplitIm[k] * Or;
+		m_pMagnitude[k] = sqrtf(Xr * Xr + Xi * Xi) * m_fScale * 0.5f;
+	}
+
+	return true;
+}
+
+void CRealFFT::ComplexTransform()
+{
+	float *pRe = m_pRe;
+	float *pIm = m_pIm;
+
+	// First two stages, twiddles are 1 and -i
+	for (int k = 0; k < m_iHalf; k += 4) {
+		float T0r = pRe[k] + pRe[k + 1], T0i = pIm[k] + pIm[k + 1];
+		float T1r = pRe[k] - pRe[k + 1], T1i = pIm[k] - pIm[k + 1];
+		float T2r = pRe[k + 2] + pRe[k + 3], T2i = pIm[k + 2] + pIm[k + 3];
+		float T3r = pRe[k + 2] - pRe[k + 3], T3i = pIm[k + 2] - pIm[k + 3];
+		pRe[k] = T0r + T2r;
+		pIm[k] = T0i + T2i;
+		pRe[k + 2] = T0r - T2r;
+		pIm[k + 2] = T0i - T2i;
+		pRe[k + 1] = T1r + T3i;
+		pIm[k + 1] = T1i - T3r;
+		pRe[k + 3] = T1r - T3i;
+		pIm[k + 3] = T1i + T3r;
+	}
+
+	for (int Half = 4; Half < m_iHalf; Half <<= 1) {
+		const float *pWr = m_pTwiddleRe + Half - 4;
+		const float *pWi = m_pTwiddleIm + Half - 4;
+		for (int k = 0; k < m_iHalf; k += Half * 2)
+			Butterflies(pRe + k, pIm + k, pRe + k + Half, pIm + k + Half, pWr, pWi, Half);
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+// Real-input FFT for the spectrum displays
+//
+// An N point real transform is done as an N/2 point complex transform of
+// the even and odd samples packed into the real and imaginary parts,
+// followed by a pass that splits the two spectra apart again. Real and
+// imaginary parts are kept in separate arrays so the butterflies can be
+// done four or eight at a time with SSE/AVX. The first two stages have
+// trivial twiddles and are done as one radix-4 pass.
+//
+// Samples go into a sliding window of the last N samples and a transform
+// uses whatever is in the window, so consecutive transforms overlap by
+// however much the caller feeds in between them. A Hann window is applied
+// before transforming.
+
+class CRealFFT
+{
+public:
+	// Points must be a power of 2, 8 or more
+	CRealFFT(int Points, int SampleRate);
+	~CRealFFT();
+
+	int Points() const { return m_iPoints; }
+	int Bins() const { return m_iPoints / 2; }
+	int SampleRate() const { return m_iSampleRate; }
+
+	void AddSamples(const int *pSamples, int Count);
+	void AddSamples(const short *pSamples, int Count);
+	void Clear();
+
+	// Transforms the window, does nothing and returns false if no samples
+	// have been added since the last transform
+	bool Transform();
+
+	// Amplitude of the sine wave at a bin, in sample units
+	float GetIntensity(int Bin) const { return m_pMagnitude[Bin]; }
+
+	int GetFrequency(int Bin) const { return int((long long)m_iSampleRate * Bin / m_iPoints); }
+	int HzToBin(int Freq) const { return int((long long)m_iPoints * Freq / m_iSampleRate); }
+
+private:
+	void ComplexTransform();
+
+	int		m_iPoints;
+	int		m_iHalf;
+	int		m_iSampleRate;
+
+	// Sliding window, m_iTapePos is the oldest sample
+	float	*m_pTape;
+	int		m_iTapePos;
+	bool	m_bNewSamples;
+
+	float	*m_pWindow;
+	int		*m_pBitReverse;
+
+	// Twiddles of the radix-2 stages, one table per stage back to back
+	float	*m_pTwiddleRe;
+	float	*m_pTwiddleIm;
+
+	// Twiddles of the split pass
+	float	*m_pSplitRe;
+	float	*m_pSplitIm;
+
+	float	*m_pRe;
+	float	*m_pIm;
+	float	*m_pMagnitude;
+	float	m_fScale;
+};
@@ -1371,6 +1371,19 @@ bool CFamiTrackerDoc::WriteBlock_Patterns(CDocumentFile *pDocFile) const
 #endif
 
 	for (unsigned t = 0; t <= m_iTracks; ++t) {
+		if (m_pTunes[t]->IsEncoded()) {
+			// Never decoded, so unchanged since it was loaded
+			for (unsigned e = 0; e < m_pTunes[t]->GetEncodedEntryCount(); ++e) {
+				unsigned int Size;
+				const char *pEntry = m_pTunes[t]->GetEncodedEntry(e, Size);
+				if (m_pTunes[t]->GetEncodedEntryChannel(e) < (int)m_iChannelsAvailable) {
+					pDocFile->WriteBlockInt(t);
+					pDocFile->WriteBlock(pEntry, Size);
+				}
+			}
+			continue;
+		}
+
 		for (unsigned i = 0; i < m_iChannelsAvailable; ++i) {
 			for (unsigned x = 0; x < MAX_PATTERN; ++x) {
 				unsigned Items = 0;
@@ -1511,6 +1524,9 @@ BOOL CFamiTrackerDoc::OpenDocument(LPCTSTR lpszPathName)
 	else if (iVersion >= 0x0200) {
 		// New file version
 
+		// Read blocks in place from a mapping of the file if possible
+		OpenFile.MapFile();
+
 		// Try to open file, create new if it fails
 		if (!OpenDocumentNew(OpenFile))
 			return FALSE;
@@ -2362,6 +2378,10 @@ bool CFamiTrackerDoc::ReadBlock_Patterns(CDocumentFile *pDocFile)
 {
 	unsigned int Version = pDocFile->GetBlockVersion();
 
+	// Current patterns need no conversion and are decoded when first used
+	if (Version >= 5 && m_iFileVersion > 0x0200)
+		return IndexBlock_Patterns(pDocFile);
+
 	if (Version == 1) {
 		int PatternLen = pDocFile->GetBlockInt();
 		ASSERT_FILE_DATA(PatternLen <= MAX_PATTERN_LENGTH);
@@ -2509,6 +2529,58 @@ bool CFamiTrackerDoc::ReadBlock_Patterns(CDocumentFile *pDocFile)
 	return false;
 }
 
+bool CFamiTrackerDoc::IndexBlock_Patterns(CDocumentFile *pDocFile)
+{
+	// Only checks the patterns and hands each track its part of the block,
+	// see CPatternData::SetEncodedPatterns
+
+	std::vector<char> Data[MAX_TRACKS];
+	std::vector<unsigned int> Entries[MAX_TRACKS];
+
+	while (!pDocFile->BlockDone()) {
+		unsigned Track	 = pDocFile->GetBlockInt();
+		unsigned Channel = pDocFile->GetBlockInt();
+		unsigned Pattern = pDocFile->GetBlockInt();
+		unsigned Items	 = pDocFile->GetBlockInt();
+
+		if (Channel > MAX_CHANNELS)
+			return false;
+
+		ASSERT_FILE_DATA(Track < MAX_TRACKS);
+		ASSERT_FILE_DATA(Track <= m_iTracks);
+		ASSERT_FILE_DATA(Channel < MAX_CHANNELS);
+		ASSERT_FILE_DATA(Pattern < MAX_PATTERN);
+		ASSERT_FILE_DATA((Items - 1) < MAX_PATTERN_LENGTH);
+
+		unsigned ItemSize = 8 + (m_pTunes[Track]->GetEffectColumnCount(Channel) + 1) * 2;
+		unsigned Start = Data[Track].size();
+
+		ASSERT_FILE_DATA(pDocFile->GetBlockPos() + Items * ItemSize <= (unsigned)pDocFile->GetBlockSize());
+
+		// Entry as stored, minus the track
+		Data[Track].resize(Start + 12 + Items * ItemSize);
+		memcpy(&Data[Track][Start], &Channel, 4);
+		memcpy(&Data[Track][Start + 4], &Pattern, 4);
+		memcpy(&Data[Track][Start + 8], &Items, 4);
+		pDocFile->GetBlock(&Data[Track][Start + 12], Items * ItemSize);
+
+		for (unsigned i = 0; i < Items; ++i) {
+			unsigned Row;
+			memcpy(&Row, &Data[Track][Start + 12 + i * ItemSize], 4);
+			ASSERT_FILE_DATA(Row < MAX_PATTERN_LENGTH);
+		}
+
+		Entries[Track].push_back(Start);
+	}
+
+	for (unsigned i = 0; i <= m_iTracks; ++i) {
+		if (!Entries[i].empty())
+			m_pTunes[i]->SetEncodedPatterns(&Data[i][0], Data[i].size(), Entries[i]);
+	}
+
+	return false;
+}
+
 bool CFamiTrackerDoc::ReadBlock_DSamples(CDocumentFile *pDocFile)
 {
 	int Count = 0, i, Item, Len, Size;
@@ -4547,7 +4619,8 @@ int CFamiTrackerDoc::ScanActualLength(int Track, int Count) const
 		for (int j = 0; j < GetChannelCount() && JumpTo == -1; ++j) {
 			for (unsigned k = 0; k < GetPatternLength(Track) && JumpTo == -1; ++k) {
 				stChanNote Note;
-				GetNoteData(i, j, k, &Note);
+				// Track's own patterns, not the selected track's
+				GetDataAtPattern(Track, GetPatternAtFrame(Track, i, j), j, k, &Note);
 				for (unsigned l = 0; l < GetEffColumns(Track, j) + 1; ++l) {
 					switch (Note.EffNumber[l]) {
 						case EF_JUMP:
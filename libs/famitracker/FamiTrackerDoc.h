@@ -412,6 +412,7 @@ protected:
 	bool			ReadBlock_Sequences(CDocumentFile *pDocFile);
 	bool			ReadBlock_Frames(CDocumentFile *pDocFile);
 	bool			ReadBlock_Patterns(CDocumentFile *pDocFile);
+	bool			IndexBlock_Patterns(CDocumentFile *pDocFile);
 	bool			ReadBlock_DSamples(CDocumentFile *pDocFile);
 	bool			ReadBlock_SequencesVRC6(CDocumentFile *pDocFile);
 	bool			ReadBlock_SequencesN163(CDocumentFile *pDocFile);
@@ -4,12 +4,16 @@
 #include "FamiTracker.h"
 #include "FamiTrackerView.h"
 #include "SampleWindow.h"
+#include "SoundGen.h"
 
 #include "famitrackermodulepropertiesdialog.h"
 
 #include <QFrame>
 #include <QLayout>
 #include <QAction>
+#include <QApplication>
+#include <QFileDialog>
+#include <QMessageBox>
 
 // DPI variables
 static const int DEFAULT_DPI = 96;
@@ -98,6 +102,13 @@ CMainFrame::CMainFrame(QWidget *parent) :
       trackerActions.insert(trackerAction,actionHandlers[idx]);
       toolBar->addAction(trackerAction);
    }
+
+   // There's no image for rendering in the toolbar strip.
+   trackerAction = new QAction("WAV",this);
+   trackerAction->setToolTip("Render the track to a WAV file");
+   QObject::connect(trackerAction,SIGNAL(triggered()),this,SLOT(trackerAction_triggered()));
+   trackerActions.insert(trackerAction,&CMainFrame::trackerAction_createWAV);
+   toolBar->addAction(trackerAction);
    
    octaveLabel = new QLabel("Octave");
    toolBar->addSeparator();
@@ -349,6 +360,37 @@ void CMainFrame::trackerAction_createNSF()
    qDebug("createNSF");
 }
 
+void CMainFrame::trackerAction_createWAV()
+{
+   CFamiTrackerDoc* pDoc = (CFamiTrackerDoc*)GetActiveDocument();
+   QString fileName;
+   bool rendered;
+
+   if ( !pDoc->IsFileLoaded() )
+   {
+      return;
+   }
+
+   fileName = QFileDialog::getSaveFileName(this,"Render to WAV",QString(),"WAV Files (*.wav)");
+   if ( fileName.isEmpty() )
+   {
+      return;
+   }
+
+   // Render with a sound generator of its own, the player and the views
+   // carry on as they were.
+   CSoundGen renderer(pDoc);
+
+   QApplication::setOverrideCursor(Qt::WaitCursor);
+   rendered = renderer.RenderToFile((TCHAR*)fileName.toAscii().constData(),pDoc->GetSelectedTrack(),SONG_LOOP_LIMIT,1);
+   QApplication::restoreOverrideCursor();
+
+   if ( !rendered )
+   {
+      QMessageBox::critical(this,"Render to WAV","Could not render the track to "+fileName+".");
+   }
+}
+
 void CMainFrame::on_frameInc_clicked()
 {
    CFamiTrackerView* pView = (CFamiTrackerView*)GetActiveView();
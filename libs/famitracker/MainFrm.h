@@ -161,6 +161,7 @@ public slots:
    void trackerAction_nextTrack();
    void trackerAction_settings();
    void trackerAction_createNSF();
+   void trackerAction_createWAV();
    void updateViews(long hint);
    
 signals:
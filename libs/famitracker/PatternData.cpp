@@ -25,7 +25,9 @@
 // This class contains pattern data
 // A list of these objects exists inside the document one for each song
 
-CPatternData::CPatternData(unsigned int PatternLength, unsigned int Speed, unsigned int Tempo)
+CPatternData::CPatternData(unsigned int PatternLength, unsigned int Speed, unsigned int Tempo) :
+	m_iArenaFree(0),
+	m_bEncoded(false)
 {
 	// Clear memory
 	memset(m_iFrameList, 0, sizeof(short) * MAX_FRAMES * MAX_CHANNELS);
@@ -37,19 +39,14 @@ CPatternData::CPatternData(unsigned int PatternLength, unsigned int Speed, unsig
 	m_iSongSpeed	 = Speed;
 	m_iSongTempo	 = Tempo;
 
-	// Pre-allocate pattern 0 for all channels
-	for (int i = 0; i < MAX_CHANNELS; ++i)
-		AllocatePattern(i, 0);
+	// Patterns are allocated on first access, so a track that is never
+	// looked at costs no pattern memory
 }
 
 CPatternData::~CPatternData()
 {
 	// Deallocate memory
-	for (int i = 0; i < MAX_CHANNELS; ++i) {
-		for (int j = 0; j < MAX_PATTERN; ++j) {
-			SAFE_RELEASE_ARRAY(m_pPatternData[i][j]);
-		}
-	}
+	ReleaseArena();
 }
 
 void CPatternData::SetEffect(unsigned int Channel, unsigned int Pattern, unsigned int Row, unsigned int Column, char EffNumber, char EffParam)
@@ -80,6 +77,12 @@ void CPatternData::SetVolume(unsigned int Channel, unsigned int Pattern, unsigne
 
 bool CPatternData::IsCellFree(unsigned int Channel, unsigned int Pattern, unsigned int Row)
 {
+	DecodePatterns();
+
+	// Don't allocate patterns just to find them empty
+	if (!m_pPatternData[Channel][Pattern])
+		return true;
+
 	stChanNote *Note = GetPatternData(Channel, Pattern, Row);
 
 	bool IsFree = Note->Note == NONE && 
@@ -92,6 +95,11 @@ bool CPatternData::IsCellFree(unsigned int Channel, unsigned int Pattern, unsign
 
 bool CPatternData::IsPatternEmpty(unsigned int Channel, unsigned int Pattern)
 {
+	DecodePatterns();
+
+	if (!m_pPatternData[Channel][Pattern])
+		return true;
+
 	// Check if pattern is empty
 	for (unsigned int i = 0; i < m_iPatternLength; i++) {
 		if (!IsCellFree(Channel, Pattern, i))
@@ -112,6 +120,8 @@ bool CPatternData::IsPatternInUse(unsigned int Channel, unsigned int Pattern)
 
 stChanNote *CPatternData::GetPatternData(int Channel, int Pattern, int Row)
 {
+	DecodePatterns();
+
 	if (!m_pPatternData[Channel][Pattern])		// Allocate pattern if accessed for the first time
 		AllocatePattern(Channel, Pattern);
 
@@ -120,8 +130,19 @@ stChanNote *CPatternData::GetPatternData(int Channel, int Pattern, int Row)
 
 void CPatternData::AllocatePattern(int Channel, int Pattern)
 {
-	// Allocate memory
-	m_pPatternData[Channel][Pattern] = new stChanNote[MAX_PATTERN_LENGTH];
+	// Take a released pattern or the next one from the arena
+	if (!m_vFreePatterns.empty()) {
+		m_pPatternData[Channel][Pattern] = m_vFreePatterns.back();
+		m_vFreePatterns.pop_back();
+	}
+	else {
+		if (m_iArenaFree == 0) {
+			m_vArenaBlocks.push_back(new stChanNote[MAX_PATTERN_LENGTH * ARENA_PATTERNS]);
+			m_iArenaFree = ARENA_PATTERNS;
+		}
+		m_pPatternData[Channel][Pattern] = m_vArenaBlocks.back() + (ARENA_PATTERNS - m_iArenaFree) * MAX_PATTERN_LENGTH;
+		--m_iArenaFree;
+	}
 
 	// Clear memory
 	for (int i = 0; i < MAX_PATTERN_LENGTH; i++) {
@@ -137,6 +158,26 @@ void CPatternData::AllocatePattern(int Channel, int Pattern)
 	}
 }
 
+void CPatternData::ReleasePattern(int Channel, int Pattern)
+{
+	if (m_pPatternData[Channel][Pattern]) {
+		m_vFreePatterns.push_back(m_pPatternData[Channel][Pattern]);
+		m_pPatternData[Channel][Pattern] = NULL;
+	}
+}
+
+void CPatternData::ReleaseArena()
+{
+	for (unsigned int i = 0; i < m_vArenaBlocks.size(); ++i)
+		delete [] m_vArenaBlocks[i];
+
+	m_vArenaBlocks.clear();
+	m_vFreePatterns.clear();
+	m_iArenaFree = 0;
+
+	memset(m_pPatternData, 0, sizeof(stChanNote*) * MAX_CHANNELS * MAX_PATTERN);
+}
+
 void CPatternData::ClearEverything()
 {
 	// Resets everything
@@ -145,14 +186,11 @@ void CPatternData::ClearEverything()
 	memset(m_iFrameList, 0, sizeof(short) * MAX_FRAMES * MAX_CHANNELS);
 	
 	// Patterns, deallocate everything
-	for (int i = 0; i < MAX_CHANNELS; i++) {
-		for (int j = 0; j < MAX_PATTERN; j++) {
-			if (m_pPatternData[i][j]) {
-				delete [] m_pPatternData[i][j];
-				m_pPatternData[i][j] = NULL;
-			}
-		}
-	}
+	ReleaseArena();
+
+	m_bEncoded = false;
+	m_vEncoded.clear();
+	m_vEncodedEntries.clear();
 
 	m_iFrameCount = 1;
 }
@@ -160,7 +198,90 @@ void CPatternData::ClearEverything()
 void CPatternData::ClearPattern(int Channel, int Pattern)
 {
 	// Deletes a specified pattern in a channel
-	SAFE_RELEASE_ARRAY(m_pPatternData[Channel][Pattern]);
+	DecodePatterns();
+	ReleasePattern(Channel, Pattern);
+}
+
+void CPatternData::SetEncodedPatterns(const char *pData, unsigned int Size, const std::vector<unsigned int> &Entries)
+{
+	m_vEncoded.assign(pData, pData + Size);
+	m_vEncodedEntries = Entries;
+	m_bEncoded = !Entries.empty();
+}
+
+const char *CPatternData::GetEncodedEntry(unsigned int Entry, unsigned int &Size) const
+{
+	unsigned int End = (Entry + 1 < m_vEncodedEntries.size()) ? m_vEncodedEntries[Entry + 1] : m_vEncoded.size();
+
+	Size = End - m_vEncodedEntries[Entry];
+
+	return &m_vEncoded[m_vEncodedEntries[Entry]];
+}
+
+int CPatternData::GetEncodedEntryChannel(unsigned int Entry) const
+{
+	return ReadEncodedInt(&m_vEncoded[m_vEncodedEntries[Entry]]);
+}
+
+int CPatternData::ReadEncodedInt(const char *pData)
+{
+	int Value;
+	memcpy(&Value, pData, sizeof(int));
+	return Value;
+}
+
+void CPatternData::DecodePatterns()
+{
+	// The pattern editor and the player can both get here first, so the
+	// flag is only trusted under the lock
+	m_DecodeLock.Lock();
+
+	if (m_bEncoded)
+		DecodeEncodedPatterns();
+
+	m_DecodeLock.Unlock();
+}
+
+void CPatternData::DecodeEncodedPatterns()
+{
+	for (unsigned int e = 0; e < m_vEncodedEntries.size(); ++e) {
+		const char *pData = &m_vEncoded[m_vEncodedEntries[e]];
+
+		int Channel = ReadEncodedInt(pData);
+		int Pattern = ReadEncodedInt(pData + 4);
+		int Items	= ReadEncodedInt(pData + 8);
+		int EffColumns = m_iEffectColumns[Channel] + 1;
+
+		pData += 12;
+
+		if (!m_pPatternData[Channel][Pattern])
+			AllocatePattern(Channel, Pattern);
+
+		for (int i = 0; i < Items; ++i) {
+			// Rows were checked when the block was loaded
+			stChanNote *Note = m_pPatternData[Channel][Pattern] + ReadEncodedInt(pData);
+			memset(Note, 0, sizeof(stChanNote));
+
+			Note->Note		 = pData[4];
+			Note->Octave	 = pData[5];
+			Note->Instrument = pData[6];
+			Note->Vol		 = pData[7];
+
+			for (int n = 0; n < EffColumns; ++n) {
+				Note->EffNumber[n] = pData[8 + n * 2];
+				Note->EffParam[n]  = pData[9 + n * 2];
+			}
+
+			if (Note->Vol > 0x10)
+				Note->Vol &= 0x0F;
+
+			pData += 8 + EffColumns * 2;
+		}
+	}
+
+	m_vEncoded.clear();
+	m_vEncodedEntries.clear();
+	m_bEncoded = false;
 }
 
 unsigned short CPatternData::GetFramePattern(int Frame, int Channel) const
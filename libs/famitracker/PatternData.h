@@ -21,6 +21,8 @@
 
 #pragma once
 
+#include <vector>
+
 // Channel note struct, holds the data for each row in patterns
 struct stChanNote {
 	unsigned char Note;
@@ -70,8 +72,20 @@ public:
 	int GetEffectColumnCount(int Channel) const
 		{ return m_iEffectColumns[Channel]; };
 
+	// Encoded patterns are stored with the column count they were saved with
 	void SetEffectColumnCount(int Channel, int Count)
-		{ m_iEffectColumns[Channel] = Count; };
+		{ DecodePatterns(); m_iEffectColumns[Channel] = Count; };
+
+	// Patterns can be left as they are stored in the PATTERNS block of a
+	// module and decoded the first time the track's pattern data is used.
+	// Each entry is a pattern without the leading track number.
+	void SetEncodedPatterns(const char *pData, unsigned int Size, const std::vector<unsigned int> &Entries);
+	bool IsEncoded() const
+		{ return m_bEncoded; };
+	unsigned int GetEncodedEntryCount() const
+		{ return m_vEncodedEntries.size(); };
+	const char *GetEncodedEntry(unsigned int Entry, unsigned int &Size) const;
+	int GetEncodedEntryChannel(unsigned int Entry) const;
 
 	void ClearEverything();
 	void ClearPattern(int Channel, int Pattern);
@@ -93,6 +107,13 @@ public:
 
 private:
 	void AllocatePattern(int Channel, int Patterns);
+	void ReleasePattern(int Channel, int Pattern);
+	void ReleaseArena();
+
+	void DecodePatterns();
+	void DecodeEncodedPatterns();
+
+	static int ReadEncodedInt(const char *pData);
 
 	// Pattern data
 private:
@@ -110,4 +131,18 @@ private:
 
 	// All accesses to m_pPatternData must go through GetPatternData()
 	stChanNote *m_pPatternData[MAX_CHANNELS][MAX_PATTERN];
+
+	// Patterns are carved out of blocks of ARENA_PATTERNS patterns owned by
+	// the track, released patterns are kept for reuse
+	static const int ARENA_PATTERNS = 16;
+
+	std::vector<stChanNote*> m_vArenaBlocks;
+	std::vector<stChanNote*> m_vFreePatterns;
+	int m_iArenaFree;
+
+	// Patterns not decoded yet
+	bool m_bEncoded;
+	std::vector<char> m_vEncoded;
+	std::vector<unsigned int> m_vEncodedEntries;
+	CMutex m_DecodeLock;
 };
@@ -81,6 +81,11 @@ const int CPatternView::DEFAULT_HEADER_FONT_SIZE = 11;
 // Numbers of pixels until selection is initiated
 const int CPatternView::SELECT_THRESHOLD = 5;
 
+// Characters in the glyph atlas, and the space around each glyph
+const int CPatternView::GLYPH_FIRST = 0x20;
+const int CPatternView::GLYPH_LAST = 0x7E;
+const int CPatternView::GLYPH_MARGIN = 2;
+
 void CPatternView::resizeEvent(QResizeEvent *event)
 {
    // CP: counteract unnecessary math in SetWindowSize...
@@ -187,6 +192,8 @@ CPatternView::CPatternView() :
 	m_iFastRedraws(0),
 	m_iErases(0),
 	m_iBuffers(0),
+	m_iGlyphWidth(0),
+	m_iGlyphHeight(0),
 	m_bForcePlayRowUpdate(false)
 {
    ui->setupUi(this);
@@ -451,6 +458,9 @@ void CPatternView::ApplyColorScheme()
 	m_colHead3 = GetSysColor(COLOR_APPWORKSPACE);
 	m_colHead4 = BLEND(m_colHead3, 0x4040F0, 80);
 
+	CreateGlyphAtlas();
+	FlushRowCache();
+
 	m_bForceFullRedraw = true;
 }
 
@@ -484,6 +494,7 @@ void CPatternView::SetDocument(CFamiTrackerDoc *pDoc, CFamiTrackerView *pView)
 
 	m_iScrolling = SCROLL_NONE;
 
+	FlushRowCache();
 	Invalidate(true);
 
 	ResetSelection();
@@ -1016,14 +1027,14 @@ void CPatternView::DrawRowArea(CDC *pDC)
 
 	for (int i = 0; i < m_iVisibleRows; ++i) {
 		if (Row >= 0 && Row < m_iPatternLength) {
-			DrawRow(pDC, Row, i, m_iDrawFrame, false);
+			DrawCachedRow(pDC, Row, i, m_iDrawFrame, false);
 		}
 		else if (theApp.GetSettings()->General.bFramePreview) {
 			// Next frame
 			if (m_iDrawFrame < signed(m_pDocument->GetFrameCount() - 1) && Row >= m_iPatternLength) {
 				int PatternRow = (Row - m_iPatternLength);
 				if (PatternRow >= 0 && PatternRow < m_iNextPatternLength)
-					DrawRow(pDC, PatternRow, i, m_iDrawFrame + 1, true);
+					DrawCachedRow(pDC, PatternRow, i, m_iDrawFrame + 1, true);
 				else
 					ClearRow(pDC, i);
 			}
@@ -1031,7 +1042,7 @@ void CPatternView::DrawRowArea(CDC *pDC)
 			else if (m_iDrawFrame > 0 && Row < 0) {
 				int PatternRow = (m_iPrevPatternLength + Row);
 				if (PatternRow >= 0 && PatternRow < m_iPrevPatternLength)
-					DrawRow(pDC, PatternRow, i, m_iDrawFrame - 1, true);
+					DrawCachedRow(pDC, PatternRow, i, m_iDrawFrame - 1, true);
 				else
 					ClearRow(pDC, i);
 			}
@@ -1044,6 +1055,16 @@ void CPatternView::DrawRowArea(CDC *pDC)
 		++Row;
 	}
 
+	// Drop the rows that scrolled out of view
+	QMutableHashIterator<int, RowStrip_t> it(m_rowStrips);
+	while (it.hasNext()) {
+		it.next();
+		if (!it.value().Used)
+			it.remove();
+		else
+			it.value().Used = false;
+	}
+
 	// Last unvisible row
 	ClearRow(pDC, m_iVisibleRows);
 
@@ -1339,6 +1360,119 @@ void CPatternView::DrawRow(CDC *pDC, int Row, int Line, int Frame, bool bPreview
 	}
 }
 
+// Draw a row from the row cache, rendering it only if it has changed
+void CPatternView::DrawCachedRow(CDC *pDC, int Row, int Line, int Frame, bool bPreview)
+{
+	const int Width = ROW_COL_WIDTH + m_iPatternWidth;
+	const int Index = (Frame << 9) | (Row << 1) | (bPreview ? 1 : 0);
+
+	QByteArray Key = GetRowKey(Row, Frame, bPreview);
+	RowStrip_t &Strip = m_rowStrips[Index];
+
+	if (Strip.Key != Key || Strip.Strip.width() != Width || Strip.Strip.height() != m_iRowHeight) {
+		CDC StripDC;
+
+		if (Strip.Strip.width() != Width || Strip.Strip.height() != m_iRowHeight)
+			Strip.Strip = QPixmap(Width, m_iRowHeight);
+
+		// Areas the row doesn't paint show through as before
+		Strip.Strip.fill(Qt::transparent);
+
+		// DrawRow places the row at its screen line, move that line to the strip
+		StripDC.attach(&Strip.Strip);
+		StripDC.painter()->translate(0, -(HEADER_HEIGHT + Line * m_iRowHeight));
+		StripDC.SelectObject(&m_fontPattern);
+		StripDC.SetBkMode(TRANSPARENT);
+		DrawRow(&StripDC, Row, Line, Frame, bPreview);
+		StripDC.detach();
+
+		Strip.Key = Key;
+	}
+
+	Strip.Used = true;
+
+	pDC->SetWindowOrg(0, 0);
+	pDC->painter()->drawPixmap(0, HEADER_HEIGHT + Line * m_iRowHeight, Strip.Strip);
+}
+
+QByteArray CPatternView::GetRowKey(int Row, int Frame, bool bPreview) const
+{
+	// Collects everything DrawRow's output depends on, except for the
+	// settings and color scheme which flush the cache when they change
+	const CSettings *pSettings = theApp.GetSettings();
+	const int Channels = m_iFirstChannel + m_iChannelsVisible;
+
+	QByteArray Key;
+	stChanNote NoteData;
+	int State[16];
+	int Count = 0;
+
+#define KEY_APPEND(v) { int Value = (v); Key.append((const char*)&Value, sizeof(int)); }
+
+	State[Count++] = m_iCurrentFrame;
+	State[Count++] = m_pDocument->GetFrameCount();
+	State[Count++] = m_iHighlight;
+	State[Count++] = m_iHighlightSecond;
+	State[Count++] = m_iFirstChannel;
+	State[Count++] = m_iChannelsVisible;
+	State[Count++] = (pSettings->General.bFramePreview ? 1 : 0) | (pSettings->General.bRowInHex ? 2 : 0) | (pSettings->General.bPatternColor ? 4 : 0);
+
+	// Cursor row
+	if (!bPreview && Row == m_iDrawCursorRow) {
+		State[Count++] = (m_bHasFocus ? 1 : 0) | (m_pView->GetEditMode() ? 2 : 0);
+		State[Count++] = m_cpCursorPos.m_iChannel;
+		State[Count++] = m_cpCursorPos.m_iColumn;
+	}
+	else
+		State[Count++] = -1;
+
+	// Play row
+	State[Count++] = (!m_bFollowMode && Row == m_iPlayRow && Frame == m_iPlayFrame && theApp.IsPlaying()) ? 1 : 0;
+
+	Key.append((const char*)State, Count * sizeof(int));
+
+	// Selection and drag area
+	if (m_bSelecting && !bPreview && Row >= m_selection.GetRowStart() && Row <= m_selection.GetRowEnd()) {
+		KEY_APPEND(m_selection.GetChanStart());
+		KEY_APPEND(m_selection.GetChanEnd());
+		KEY_APPEND(m_selection.GetColStart());
+		KEY_APPEND(m_selection.GetColEnd());
+		KEY_APPEND((Row == m_selection.GetRowStart() ? 1 : 0) | (Row == m_selection.GetRowEnd() ? 2 : 0));
+	}
+	else
+		KEY_APPEND(-1);
+
+	if (m_bDragging && !bPreview && Row >= m_selDrag.GetRowStart() && Row <= m_selDrag.GetRowEnd()) {
+		KEY_APPEND(m_selDrag.GetChanStart());
+		KEY_APPEND(m_selDrag.GetChanEnd());
+		KEY_APPEND(m_selDrag.GetColStart());
+		KEY_APPEND(m_selDrag.GetColEnd());
+	}
+	else
+		KEY_APPEND(-1);
+
+	// Pattern data
+	if (Frame < signed(m_pDocument->GetFrameCount())) {
+		for (int i = m_iFirstChannel; i < Channels; ++i) {
+			m_pDocument->GetNoteData(Frame, i, Row, &NoteData);
+			KEY_APPEND(m_iChannelWidths[i]);
+			KEY_APPEND(NoteData.Note | (NoteData.Octave << 8) | (NoteData.Vol << 16));
+			KEY_APPEND(NoteData.Instrument | ((NoteData.Instrument < MAX_INSTRUMENTS && m_pDocument->IsInstrumentUsed(NoteData.Instrument)) ? 0x10000 : 0));
+			for (int j = 0; j < MAX_EFFECT_COLUMNS; ++j)
+				KEY_APPEND(NoteData.EffNumber[j] | (NoteData.EffParam[j] << 8));
+		}
+	}
+
+#undef KEY_APPEND
+
+	return Key;
+}
+
+void CPatternView::FlushRowCache()
+{
+	m_rowStrips.clear();
+}
+
 void CPatternView::DrawCell(int PosX, int Column, int Channel, bool bInvert, stChanNote *pNoteData, CDC *pDC, RowColorInfo_t *pColorInfo)
 {
 	const char NOTES_A[] = {'C', 'C', 'D', 'D', 'E', 'F', 'F', 'G', 'G', 'A', 'A', 'B'};
@@ -1858,11 +1992,60 @@ void CPatternView::SetDPCMState(stDPCMState State)
 // Draws a colored character
 void CPatternView::DrawChar(int x, int y, TCHAR c, COLORREF Color, CDC *pDC)
 {
-	pDC->SetTextColor(Color);
-	pDC->TextOut(x, y, &c, 1);
+	if (m_imgGlyphMask.isNull() || c < GLYPH_FIRST || c > GLYPH_LAST) {
+		pDC->SetTextColor(Color);
+		pDC->TextOut(x, y, &c, 1);
+	}
+	else {
+		// Blit from the glyph atlas, in the same place TextOut would draw
+		CPoint Org = pDC->GetWindowOrg();
+		pDC->painter()->drawPixmap(x - Org.x - GLYPH_MARGIN, y - Org.y, GetGlyphAtlas(Color),
+			(c - GLYPH_FIRST) * m_iGlyphWidth, 0, m_iGlyphWidth, m_iGlyphHeight);
+	}
 	++m_iCharsDrawn;
 }
 
+void CPatternView::CreateGlyphAtlas()
+{
+	// Rasterize the printable characters of the pattern font once, as an
+	// alpha mask.  Tinted copies are made on demand for each text color.
+	QFont Font = (QFont)m_fontPattern;
+	QFontMetrics Metrics(Font);
+
+	m_glyphAtlas.clear();
+
+	m_iGlyphWidth = Metrics.maxWidth() + GLYPH_MARGIN * 2;
+	m_iGlyphHeight = Metrics.height() + Metrics.descent();
+
+	m_imgGlyphMask = QImage(m_iGlyphWidth * (GLYPH_LAST - GLYPH_FIRST + 1), m_iGlyphHeight, QImage::Format_ARGB32_Premultiplied);
+	m_imgGlyphMask.fill(Qt::transparent);
+
+	QPainter Painter(&m_imgGlyphMask);
+	Painter.setFont(Font);
+	Painter.setPen(Qt::white);
+
+	for (int c = GLYPH_FIRST; c <= GLYPH_LAST; ++c) {
+		// Baseline as used by CDC::TextOut
+		Painter.drawText((c - GLYPH_FIRST) * m_iGlyphWidth + GLYPH_MARGIN, Metrics.height() - 1, QString(QChar(c)));
+	}
+}
+
+const QPixmap &CPatternView::GetGlyphAtlas(COLORREF Color)
+{
+	QHash<COLORREF, QPixmap>::const_iterator it = m_glyphAtlas.constFind(Color);
+
+	if (it != m_glyphAtlas.constEnd())
+		return it.value();
+
+	QImage Tinted = m_imgGlyphMask;
+	QPainter Painter(&Tinted);
+	Painter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+	Painter.fillRect(Tinted.rect(), QColor(GetRValue(Color), GetGValue(Color), GetBValue(Color)));
+	Painter.end();
+
+	return m_glyphAtlas.insert(Color, QPixmap::fromImage(Tinted)).value();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 // Private /////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////
@@ -28,6 +28,10 @@ enum {TRANSPOSE_DEC_NOTES, TRANSPOSE_INC_NOTES, TRANSPOSE_DEC_OCTAVES, TRANSPOSE
 
 #include "cqtmfc.h"
 
+#include <QHash>
+#include <QImage>
+#include <QPixmap>
+
 // Graphical layout of pattern editor
 
 // Top header (channel names etc)
@@ -292,6 +296,12 @@ private:
 
 	void DrawCell(int PosX, int Column, int Channel, bool bInvert, stChanNote *pNoteData, CDC *pDC, RowColorInfo_t *pColorInfo);
 	void DrawChar(int x, int y, TCHAR c, COLORREF Color, CDC *pDC);
+	void DrawCachedRow(CDC *pDC, int Row, int Line, int Frame, bool bPreview);
+	QByteArray GetRowKey(int Row, int Frame, bool bPreview) const;
+	void FlushRowCache();
+
+	void CreateGlyphAtlas();
+	const QPixmap &GetGlyphAtlas(COLORREF Color);
 	void DrawNoteColumn(unsigned int PosX, unsigned int PosY, CDC *pDC);
 	void DrawInstrumentColumn(unsigned int PosX, unsigned int PosY, CDC *pDC);
 
@@ -320,6 +330,10 @@ private:
 
 	static const int SELECT_THRESHOLD;
 
+	static const int GLYPH_FIRST;
+	static const int GLYPH_LAST;
+	static const int GLYPH_MARGIN;
+
 	// Variables
 private:
 	CFamiTrackerDoc	 *m_pDocument;
@@ -420,6 +434,19 @@ private:
 	CFont	m_fontPattern;
 	CFont	m_fontCourierNew;
 
+	// Pattern font glyphs, rasterized once and tinted per text color
+	QImage	m_imgGlyphMask;
+	QHash<COLORREF, QPixmap> m_glyphAtlas;
+	int		m_iGlyphWidth, m_iGlyphHeight;
+
+	// Rendered rows, keyed by frame and row so they survive scrolling
+	struct RowStrip_t {
+		QByteArray Key;			// Everything the row's look depends on
+		QPixmap Strip;
+		bool Used;				// Drawn in the current paint
+	};
+	QHash<int, RowStrip_t> m_rowStrips;
+
 	// Scrolling
 	CPoint	m_ptScrollMousePos;
 	UINT	m_nScrollFlags;
@@ -0,0 +1,113 @@
+#include "stdafx.h"
+#include "FamiTrackerDoc.h"
+#include "SoundGen.h"
+#include "RenderBatch.h"
+
+#include <QRunnable>
+#include <QThreadPool>
+
+QMutex CRenderBatch::m_SetupMutex;
+
+// Renders one job with a sound generator of its own
+class CRenderTask : public QRunnable
+{
+public:
+	CRenderTask(CFamiTrackerDoc *pDoc, stRenderJob *pJob, int SongEndType, int SongEndParam) :
+		m_pDocument(pDoc), m_pJob(pJob), m_iSongEndType(SongEndType), m_iSongEndParam(SongEndParam) {};
+
+	void run() {
+		CRenderBatch::m_SetupMutex.lock();
+		CSoundGen *pSoundGen = new CSoundGen(m_pDocument);
+		CRenderBatch::m_SetupMutex.unlock();
+
+		if (m_pJob->File.isEmpty())
+			m_pJob->Rendered = pSoundGen->RenderToBuffer(&m_pJob->Data, m_pJob->Track, m_iSongEndType, m_iSongEndParam);
+		else
+			m_pJob->Rendered = pSoundGen->RenderToFile((TCHAR*)m_pJob->File.toAscii().constData(), m_pJob->Track, m_iSongEndType, m_iSongEndParam);
+
+		delete pSoundGen;
+	}
+
+private:
+	CFamiTrackerDoc *m_pDocument;
+	stRenderJob *m_pJob;
+	int m_iSongEndType;
+	int m_iSongEndParam;
+};
+
+void CRenderBatch::PrepareDocument(CFamiTrackerDoc *pDoc, const std::vector<stRenderJob> &Jobs)
+{
+	// Reading a pattern decodes its track and allocates the pattern, do it
+	// for every pattern the jobs play before the workers start reading
+	stChanNote Note;
+
+	for (unsigned int i = 0; i < Jobs.size(); ++i) {
+		int Track = Jobs[i].Track;
+
+		if (Track < 0 || Track >= (int)pDoc->GetTrackCount())
+			continue;
+
+		for (unsigned int Frame = 0; Frame < pDoc->GetFrameCount(Track); ++Frame) {
+			for (unsigned int Channel = 0; Channel < pDoc->GetAvailableChannels(); ++Channel)
+				pDoc->GetDataAtPattern(Track, pDoc->GetPatternAtFrame(Track, Frame, Channel), Channel, 0, &Note);
+		}
+	}
+}
+
+bool CRenderBatch::Render(CFamiTrackerDoc *pDoc, std::vector<stRenderJob> &Jobs, int SongEndType, int SongEndParam, int Threads)
+{
+	QThreadPool Pool;
+	bool Rendered = true;
+
+	PrepareDocument(pDoc, Jobs);
+
+	if (Threads > 0)
+		Pool.setMaxThreadCount(Threads);
+
+	for (unsigned int i = 0; i < Jobs.size(); ++i) {
+		Jobs[i].Rendered = false;
+		Pool.start(new CRenderTask(pDoc, &Jobs[i], SongEndType, SongEndParam));
+	}
+
+	Pool.waitForDone();
+
+	for (unsigned int i = 0; i < Jobs.size(); ++i)
+		Rendered = Rendered && Jobs[i].Rendered;
+
+	return Rendered;
+}
+
+bool CRenderBatch::Verify(CFamiTrackerDoc *pDoc, int SongEndType, int SongEndParam)
+{
+	std::vector<stRenderJob> Sequential;
+	std::vector<stRenderJob> Parallel;
+
+	for (unsigned int i = 0; i < pDoc->GetTrackCount(); ++i) {
+		stRenderJob Job;
+		Job.Track = i;
+		Job.Rendered = false;
+		Sequential.push_back(Job);
+	}
+
+	Parallel = Sequential;
+
+	PrepareDocument(pDoc, Sequential);
+
+	// One after another on this thread
+	for (unsigned int i = 0; i < Sequential.size(); ++i) {
+		CRenderTask Task(pDoc, &Sequential[i], SongEndType, SongEndParam);
+		Task.run();
+	}
+
+	if (!Render(pDoc, Parallel, SongEndType, SongEndParam))
+		return false;
+
+	for (unsigned int i = 0; i < Sequential.size(); ++i) {
+		if (!Sequential[i].Rendered || Sequential[i].Data != Parallel[i].Data) {
+			qDebug("RenderBatch: Track %i differs between sequential and parallel rendering", i);
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+
+class CFamiTrackerDoc;
+
+struct stRenderJob {
+	int Track;
+	QString File;			// WAV file to write, the WAV data is kept in Data if empty
+	QByteArray Data;
+	bool Rendered;
+};
+
+/*
+ * Renders tracks of a document on a thread pool, each job with a sound generator
+ * and APU of its own. Only the document is shared between the jobs and it is only read.
+ */
+class CRenderBatch
+{
+public:
+	// Threads = 0 uses as many threads as there are cores, returns false if a job failed
+	static bool Render(CFamiTrackerDoc *pDoc, std::vector<stRenderJob> &Jobs, int SongEndType, int SongEndParam, int Threads = 0);
+
+	// Renders every track in memory one after another and then on the pool,
+	// returns true if both give the same bytes for every track
+	static bool Verify(CFamiTrackerDoc *pDoc, int SongEndType, int SongEndParam);
+
+	// Sound generators are created one at a time, the VRC7 tables are shared
+	static QMutex m_SetupMutex;
+
+private:
+	static void PrepareDocument(CFamiTrackerDoc *pDoc, const std::vector<stRenderJob> &Jobs);
+};
@@ -54,10 +54,6 @@ void CSWSpectrum::Activate()
 	m_pBlitBuffer = new int[WIN_WIDTH * WIN_HEIGHT * 2];
 	memset(m_pBlitBuffer, 0, WIN_WIDTH * WIN_HEIGHT * sizeof(int));
 
-	SAFE_RELEASE(m_pFftObject);
-
-//	m_pFftObject = new Fft(FFT_POINTS, 44100);
-
 	// Set default sample-rate
 	SetSampleRate(44100);
 }
@@ -72,41 +68,16 @@ void CSWSpectrum::SetSampleRate(int SampleRate)
 {
 	SAFE_RELEASE(m_pFftObject);
 
-	m_pFftObject = new Fft(FFT_POINTS, SampleRate);
+	m_pFftObject = new CRealFFT(FFT_POINTS, SampleRate);
 
-	memset(m_iFftPoint, 0, sizeof(int) * FFT_POINTS);
-
-	m_iCount = 0;
-	m_iFillPos = 0;
+	memset(m_iBarPeak, 0, sizeof(int) * WIN_WIDTH);
 }
 
 void CSWSpectrum::SetSampleData(int *pSamples, unsigned int iCount)
 {
-	m_iCount = iCount;
-	m_pSamples = pSamples;
-
-	int size, offset = 0;
-
-	if (m_iFillPos > 0) {
-		size = FFT_POINTS - m_iFillPos;
-		memcpy(m_pSampleBuffer + m_iFillPos, pSamples, size*4);
-		m_pFftObject->CopyIn(FFT_POINTS, m_pSampleBuffer);
-		m_pFftObject->Transform();
-		offset += size;
-		iCount -= size;
-	}
-
-	while (iCount >= FFT_POINTS) {
-		m_pFftObject->CopyIn(FFT_POINTS, pSamples + offset);
-		m_pFftObject->Transform();
-		offset += FFT_POINTS;
-		iCount -= FFT_POINTS;
-	}
-
-	// Copy rest
-	size = iCount;
-	memcpy(m_pSampleBuffer, pSamples + offset, size*4);
-	m_iFillPos = size;
+	// Only fill the window here, the transform is done once per redraw
+	// however many sample blocks came in since the last one
+	m_pFftObject->AddSamples(pSamples, iCount);
 }
 
 void CSWSpectrum::Draw(CDC *pDC, bool bMessage)
@@ -116,23 +87,34 @@ void CSWSpectrum::Draw(CDC *pDC, bool bMessage)
 	if (bMessage)
 		return;
 
-	float Stepping = (float)(FFT_POINTS) / (float(WIN_WIDTH) * 4.0f);
+	m_pFftObject->Transform();
+
+	// Show the lower half of the spectrum, each column shows the loudest
+	// bin in its range
+	float Stepping = float(m_pFftObject->Bins()) / (float(WIN_WIDTH) * 2.0f);
 	float Step = 0;
 
 	for (i = 0; i < WIN_WIDTH; i++) {
-		bar = (int)m_pFftObject->GetIntensity(int(Step)) / 400;
+		float Intensity = 0.0f;
+
+		for (int Bin = int(Step); Bin < int(Step + Stepping); ++Bin) {
+			if (m_pFftObject->GetIntensity(Bin) > Intensity)
+				Intensity = m_pFftObject->GetIntensity(Bin);
+		}
+
+		bar = int(Intensity / 50.0f);
 
 		if (bar < 0)
 			bar = 0;
 		if (bar > WIN_HEIGHT)
 			bar = WIN_HEIGHT;
 
-		if (bar > m_iFftPoint[(int)Step])
-			m_iFftPoint[(int)Step] = bar;
+		if (bar > m_iBarPeak[i])
+			m_iBarPeak[i] = bar;
 		else
-			m_iFftPoint[(int)Step] -= 2;
+			m_iBarPeak[i] -= 2;
 
-		bar = m_iFftPoint[(int)Step];
+		bar = m_iBarPeak[i];
 
 		for (y = 0; y < WIN_HEIGHT; y++) {
 			if (y < bar)
@@ -21,9 +21,9 @@
 #pragma once
 
 #include "SampleWindow.h"
-#include "fft\fft.h"
+#include "FFT/RealFft.h"
 
-const int FFT_POINTS = 256;
+const int FFT_POINTS = 4096;
 
 class CSWSpectrum : public CSampleWinState
 {
@@ -38,20 +38,12 @@ public:
 	void Draw(CDC *pDC, bool bMessage);
 
 private:
-	unsigned int m_iCount;
-
-	int	*m_pSamples;
 	int	*m_pBlitBuffer;
-	int	m_iWindowBufPtr, *m_pWindowBuf;
 
 	int	m_iLogTable[WIN_HEIGHT];
 
-	int m_iFillPos;
-
 	BITMAPINFO bmi;
 
-	Fft	*m_pFftObject;
-	int	m_iFftPoint[FFT_POINTS];
-
-	int m_pSampleBuffer[FFT_POINTS];
+	CRealFFT *m_pFftObject;
+	int	m_iBarPeak[WIN_WIDTH];
 };
@@ -21,7 +21,6 @@
 #include "stdafx.h"
 #include "FamiTracker.h"
 #include "SampleWindow.h"
-#include "fft\fft.h"
 #include "resource.h"
 #include "Settings.h"
 
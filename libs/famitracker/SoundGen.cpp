@@ -95,7 +95,8 @@ CSoundGen::CSoundGen() :
 	m_iTempo(0),
 	m_bPlayerHalted(false),
 	m_bWaveChanged(false),
-	m_iMachineType(NTSC)
+	m_iMachineType(NTSC),
+	m_bOffline(false)
 {
    pThread = new QThread();
 
@@ -123,8 +124,59 @@ CSoundGen::CSoundGen() :
 	m_pAPU->SetNamcoMixing(theApp.GetSettings()->m_bNamcoMixing);
 }
 
+CSoundGen::CSoundGen(CFamiTrackerDoc *pDoc) :
+	pThread(NULL),
+	m_pAPU(NULL),
+	m_pSampleMem(NULL),
+	m_pDSound(NULL),
+	m_pDSoundChannel(NULL),
+	m_pAccumBuffer(NULL),
+	m_iGraphBuffer(NULL),
+	m_pDocument(NULL),
+	m_pTrackerView(NULL),
+	m_bRendering(false),
+	m_bPlaying(false),
+	m_pPreviewSample(NULL),
+	m_pSampleWnd(NULL),
+	m_iSpeed(0),
+	m_iTempo(0),
+	m_bPlayerHalted(false),
+	m_bWaveChanged(false),
+	m_iMachineType(NTSC),
+	m_bOffline(true),
+	m_iPlayTrack(0),
+	m_iPlayFrame(0),
+	m_iPlayRow(0)
+{
+	// DPCM sample interface
+	m_pSampleMem = new CSampleMem();
+
+	// Create APU
+	m_pAPU = new CAPU(this, m_pSampleMem);
+
+	// Create all kinds of channels
+	CreateChannels();
+
+	m_pAPU->SetNamcoMixing(theApp.GetSettings()->m_bNamcoMixing);
+
+	// Set up for the document the way loading it sets up the player
+	m_pDocument = pDoc;
+
+	InitInstance();
+
+	GenerateVibratoTable(pDoc->GetVibratoStyle());
+	SelectChip(pDoc->GetExpansionChip());
+	LoadMachineSettings(pDoc->GetMachine(), pDoc->GetEngineSpeed());
+}
+
 CSoundGen::~CSoundGen()
 {
+	// The player thread frees these on exit, there isn't one when rendering
+	if (m_bOffline) {
+		SAFE_RELEASE_ARRAY(m_iGraphBuffer);
+		SAFE_RELEASE_ARRAY(m_pAccumBuffer);
+	}
+
 	// Delete APU
 	SAFE_RELEASE(m_pAPU);
 	SAFE_RELEASE(m_pSampleMem);
@@ -194,9 +246,10 @@ void CSoundGen::CreateChannels()
 	AssignChannel(new CTrackerChannel(_T("Namco 8"), SNDCHIP_N163, CHANID_N163_CHAN8), new CChannelHandlerN163());
 
 	// Sunsoft 5B
-	AssignChannel(new CTrackerChannel(_T("Square 1"), SNDCHIP_S5B, CHANID_S5B_CH1), new CS5BChannel1());
-	AssignChannel(new CTrackerChannel(_T("Square 2"), SNDCHIP_S5B, CHANID_S5B_CH2), new CS5BChannel2());
-	AssignChannel(new CTrackerChannel(_T("Square 3"), SNDCHIP_S5B, CHANID_S5B_CH3), new CS5BChannel3());
+	CS5BChannel1 *pS5BChannel1 = new CS5BChannel1();
+	AssignChannel(new CTrackerChannel(_T("Square 1"), SNDCHIP_S5B, CHANID_S5B_CH1), pS5BChannel1);
+	AssignChannel(new CTrackerChannel(_T("Square 2"), SNDCHIP_S5B, CHANID_S5B_CH2), new CS5BChannel2(pS5BChannel1->GetSharedRegs()));
+	AssignChannel(new CTrackerChannel(_T("Square 3"), SNDCHIP_S5B, CHANID_S5B_CH3), new CS5BChannel3(pS5BChannel1->GetSharedRegs()));
 }
 
 
@@ -221,7 +274,7 @@ void CSoundGen::SetupChannels()
 	// Initialize channels
 	for (int i = 0; i < CHANNELS; ++i) {
 		if (m_pChannels[i]) {
-			m_pChannels[i]->InitChannel(m_pAPU, m_iVibratoTable, m_pDocument);
+			m_pChannels[i]->InitChannel(m_pAPU, m_iVibratoTable, m_pDocument, this);
 			m_pChannels[i]->MakeSilent();
 		}
 	}
@@ -251,7 +304,7 @@ void CSoundGen::AssignDocument(CFamiTrackerDoc *pDoc)
 	// Setup all channels
 	for (int i = 0; i < CHANNELS; ++i) {
 		if (m_pChannels[i])
-			m_pChannels[i]->InitChannel(m_pAPU, m_iVibratoTable, m_pDocument);
+			m_pChannels[i]->InitChannel(m_pAPU, m_iVibratoTable, m_pDocument, this);
 	}
 }
 
@@ -463,36 +516,43 @@ bool CSoundGen::ResetSound()
 	m_iAudioUnderruns = 0;
 	m_iBufferPtr = 0;
 
-	// Close the old sound channel
-	if (m_pDSoundChannel) {
-		m_pDSound->CloseChannel(m_pDSoundChannel);
-		m_pDSoundChannel = NULL;
+	if (m_bOffline) {
+		// Renders go to the file in blocks of the buffer length
+		m_iBufSizeSamples = (SampleRate * BufferLen) / 1000;
+		m_iBufSizeBytes	  = m_iBufSizeSamples * (SampleSize / 8);
 	}
+	else {
+		// Close the old sound channel
+		if (m_pDSoundChannel) {
+			m_pDSound->CloseChannel(m_pDSoundChannel);
+			m_pDSoundChannel = NULL;
+		}
 
-	// Reinitialize direct sound
-   if (!m_pDSound->Init(0,0,0)) {//m_hWnd, m_hNotificationEvent, theApp.GetSettings()->Sound.iDevice)) {
-//		AfxMessageBox(_T("Direct sound error!"));
-		return false;
-	}
+		// Reinitialize direct sound
+		if (!m_pDSound->Init(0,0,0)) {//m_hWnd, m_hNotificationEvent, theApp.GetSettings()->Sound.iDevice)) {
+//			AfxMessageBox(_T("Direct sound error!"));
+			return false;
+		}
 
-	int iBlocks = 1;	// default = 2
+		int iBlocks = 1;	// default = 2
 
-	// Create more blocks if a bigger buffer than 100ms is used to enhance program response
-	if (BufferLen > 100)
-		iBlocks = (BufferLen / 66);
+		// Create more blocks if a bigger buffer than 100ms is used to enhance program response
+		if (BufferLen > 100)
+			iBlocks = (BufferLen / 66);
 
-	// Create channel
-	m_pDSoundChannel = m_pDSound->OpenChannel(SampleRate, SampleSize, 1, BufferLen, iBlocks);
+		// Create channel
+		m_pDSoundChannel = m_pDSound->OpenChannel(SampleRate, SampleSize, 1, BufferLen, iBlocks);
 
-	// Channel failed
-	if (m_pDSoundChannel == NULL) {
-//		AfxMessageBox(_T("Direct sound error: Could not create buffer!"));
-		return false;
-	}
+		// Channel failed
+		if (m_pDSoundChannel == NULL) {
+//			AfxMessageBox(_T("Direct sound error: Could not create buffer!"));
+			return false;
+		}
 
-	// Create a buffer
-	m_iBufSizeBytes	  = m_pDSoundChannel->GetBlockSize();
-	m_iBufSizeSamples = m_iBufSizeBytes / (SampleSize / 8);
+		// Create a buffer
+		m_iBufSizeBytes	  = m_pDSoundChannel->GetBlockSize();
+		m_iBufSizeSamples = m_iBufSizeBytes / (SampleSize / 8);
+	}
 
 	// Temp. audio buffer
 	SAFE_RELEASE(m_pAccumBuffer);
@@ -576,7 +636,7 @@ void CSoundGen::FlushBuffer(int16 *pBuffer, uint32 Size)
 	const int SAMPLE_MAX = 32767;
 	const int SAMPLE_MIN = -32768;
 
-	if (!m_pDSoundChannel)
+	if (!m_pDSoundChannel && !m_bOffline)
 		return;
 
 	BOOL bLocked = m_csDocumentLock.Unlock();
@@ -625,9 +685,9 @@ void CSoundGen::FlushBuffer(int16 *pBuffer, uint32 Size)
 		if (m_iBufferPtr >= m_iBufSizeSamples) {
 
 			if (m_bRendering) {
-//				// Output to file
-//				m_wfWaveFile.WriteWave((char*)m_pAccumBuffer, m_iBufSizeBytes);
-//				m_iBufferPtr = 0;
+				// Output to file
+				m_wfWaveFile.WriteWave((char*)m_pAccumBuffer, m_iBufSizeBytes);
+				m_iBufferPtr = 0;
 			}
 			else {
 				// Output to direct sound
@@ -759,29 +819,29 @@ void CSoundGen::BeginPlayer(int Mode)
 //	// Called from player thread
 //	ASSERT(GetCurrentThreadId() == m_nThreadID);
 
-	if (!m_pDSoundChannel || !m_pDocument || !m_pDocument->IsFileLoaded())
+	if ((!m_pDSoundChannel && !m_bOffline) || !m_pDocument || !m_pDocument->IsFileLoaded())
 		return;
 
 	switch (Mode) {
 		// Play from top of pattern
 		case MODE_PLAY:
 			m_bPlayLooping = false;
-			m_pTrackerView->PlayerCommand(CMD_MOVE_TO_TOP, 0);
+			PlayerCommand(CMD_MOVE_TO_TOP, 0);
 			break;
 		// Repeat pattern
 		case MODE_PLAY_REPEAT:
 			m_bPlayLooping = true;
-			m_pTrackerView->PlayerCommand(CMD_MOVE_TO_TOP, 0);
+			PlayerCommand(CMD_MOVE_TO_TOP, 0);
 			break;
 		// Start of song
 		case MODE_PLAY_START:
 			m_bPlayLooping = false;
-			m_pTrackerView->PlayerCommand(CMD_MOVE_TO_START, 0);
+			PlayerCommand(CMD_MOVE_TO_START, 0);
 			break;
 		// From cursor
 		case MODE_PLAY_CURSOR:
 			m_bPlayLooping = false;
-			m_pTrackerView->PlayerCommand(CMD_MOVE_TO_CURSOR, 0);
+			PlayerCommand(CMD_MOVE_TO_CURSOR, 0);
 			break;
 	}
 
@@ -798,7 +858,10 @@ void CSoundGen::BeginPlayer(int Mode)
 
 //	LoadMachineSettings(m_pDocument->GetMachine(), m_pDocument->GetEngineSpeed());
 
-	theApp.SilentEverything();
+	if (m_bOffline)
+		MakeSilent();
+	else
+		theApp.SilentEverything();
 }
 
 void CSoundGen::HaltPlayer()
@@ -839,6 +902,13 @@ void CSoundGen::AddCycles(int Count)
 	m_pAPU->AddTime(Count);
 }
 
+void CSoundGen::RegisterKeyState(int Channel, int Note)
+{
+	// Only the player shows the notes it plays
+	if (!m_bOffline)
+		theApp.RegisterKeyState(Channel, Note);
+}
+
 void CSoundGen::MakeSilent()
 {
 //	// Called from player thread
@@ -865,8 +935,8 @@ void CSoundGen::ResetTempo()
 	if (!m_pDocument)
 		return;
 
-	m_iSpeed = m_pDocument->GetSongSpeed();
-	m_iTempo = m_pDocument->GetSongTempo();
+	m_iSpeed = m_pDocument->GetSongSpeed(GetPlayerTrack());
+	m_iTempo = m_pDocument->GetSongTempo(GetPlayerTrack());
 
 	m_iTempoAccum = 0;
 	m_iTempoDecrement = (m_iTempo * 24) / m_iSpeed;
@@ -887,7 +957,7 @@ void CSoundGen::RunFrame()
 
 	int TicksPerSec = m_pDocument->GetFrameRate();
 
-	m_pTrackerView->PlayerCommand(CMD_TICK, 0);
+	PlayerCommand(CMD_TICK, 0);
 
 	if (m_bPlaying) {
 
@@ -904,7 +974,7 @@ void CSoundGen::RunFrame()
 		}
 
 		// Calculate playtime
-		m_pTrackerView->PlayerCommand(CMD_TIME, (m_iPlayTime * 10) / TicksPerSec);
+		PlayerCommand(CMD_TIME, (m_iPlayTime * 10) / TicksPerSec);
 
 		m_iStepRows = 0;
 
@@ -916,7 +986,7 @@ void CSoundGen::RunFrame()
 				m_iStepRows++;
 //			}
 			m_bUpdateRow = true;
-			m_pTrackerView->PlayerCommand(CMD_READ_ROW, 0);
+			PlayerCommand(CMD_READ_ROW, 0);
 		}
 		else {
 			m_bUpdateRow = false;
@@ -924,6 +994,70 @@ void CSoundGen::RunFrame()
 	}
 }
 
+int CSoundGen::PlayerCommand(char Command, int Value)
+{
+	// The player moves the play cursor of the view, a sound generator
+	// that only renders keeps its own place in the song
+	if (!m_bOffline)
+		return m_pTrackerView->PlayerCommand(Command, Value);
+
+	int Frames = m_pDocument->GetFrameCount(m_iPlayTrack);
+	int Rows = m_pDocument->GetPatternLength(m_iPlayTrack);
+	stChanNote NoteData;
+
+	switch (Command) {
+		// Move to top of pattern
+		case CMD_MOVE_TO_TOP:
+			m_iPlayRow = 0;
+			break;
+		// Move to start of song, there is no cursor to start from
+		case CMD_MOVE_TO_START:
+		case CMD_MOVE_TO_CURSOR:
+			m_iPlayFrame = 0;
+			m_iPlayRow = 0;
+			break;
+		// Move player to next row
+		case CMD_STEP_DOWN:
+			// Value = 0: not looping
+			// Value = 1: looping
+			if (++m_iPlayRow >= Rows) {
+				m_iPlayRow = 0;
+				FrameIsDone(1);
+				if (!Value && ++m_iPlayFrame >= Frames)
+					m_iPlayFrame = 0;
+			}
+			break;
+		// Jump to frame
+		case CMD_JUMP_TO:
+			FrameIsDone(1);
+			m_iPlayFrame = min(Value + 1, Frames - 1);
+			m_iPlayRow = 0;
+			break;
+		// Skip to next frame
+		case CMD_SKIP_TO:
+			FrameIsDone(1);
+			if (++m_iPlayFrame >= Frames)
+				m_iPlayFrame = 0;
+			m_iPlayRow = min(Value, Rows - 1);
+			break;
+		// Play next row
+		case CMD_READ_ROW:
+			for (unsigned int i = 0; i < m_pDocument->GetAvailableChannels(); ++i) {
+				int Pattern = m_pDocument->GetPatternAtFrame(m_iPlayTrack, m_iPlayFrame, i);
+				m_pDocument->GetDataAtPattern(m_iPlayTrack, Pattern, i, m_iPlayRow, &NoteData);
+				m_pTrackerChannels[m_pDocument->GetChannelType(i)]->SetNote(NoteData);
+			}
+			break;
+	}
+
+	return 0;
+}
+
+unsigned int CSoundGen::GetPlayerTrack() const
+{
+	return m_bOffline ? m_iPlayTrack : m_pDocument->GetSelectedTrack();
+}
+
 void CSoundGen::CheckControl()
 {
 	// This function takes care of jumping and skipping
@@ -932,22 +1066,22 @@ void CSoundGen::CheckControl()
 		// If looping, halt when a jump or skip command are encountered
 		if (m_bPlayLooping) {
 			if (m_iJumpToPattern != -1 || m_iSkipToRow != -1)
-				m_pTrackerView->PlayerCommand(CMD_MOVE_TO_TOP, 0);
+				PlayerCommand(CMD_MOVE_TO_TOP, 0);
 			else
 				while (m_iStepRows--)
-					m_pTrackerView->PlayerCommand(CMD_STEP_DOWN, 1);
+					PlayerCommand(CMD_STEP_DOWN, 1);
 		}
 		else {
 			// Jump
 			if (m_iJumpToPattern != -1)
-				m_pTrackerView->PlayerCommand(CMD_JUMP_TO, m_iJumpToPattern - 1);
+				PlayerCommand(CMD_JUMP_TO, m_iJumpToPattern - 1);
 			// Skip
 			else if (m_iSkipToRow != -1)
-				m_pTrackerView->PlayerCommand(CMD_SKIP_TO, m_iSkipToRow);
+				PlayerCommand(CMD_SKIP_TO, m_iSkipToRow);
 			// or just move on
 			else
 				while (m_iStepRows--)
-					m_pTrackerView->PlayerCommand(CMD_STEP_DOWN, 0);
+					PlayerCommand(CMD_STEP_DOWN, 0);
 		}
 
 		m_iJumpToPattern = -1;
@@ -1254,37 +1388,67 @@ void CSoundGen::EvaluateGlobalEffects(stChanNote *NoteData, int EffColumns)
 
 // File rendering functions
 
-//bool CSoundGen::RenderToFile(LPTSTR pFile, int SongEndType, int SongEndParam)
-//{
-//	// Called from player thread
-//	//ASSERT(GetCurrentThreadId() == m_nThreadID);
+bool CSoundGen::RenderToFile(LPCTSTR pFile, int Track, int SongEndType, int SongEndParam)
+{
+	if (!SetupRender(Track, SongEndType, SongEndParam))
+		return false;
 
-//	CFamiTrackerDoc *pDoc = CFamiTrackerDoc::GetDoc();
+	if (!m_wfWaveFile.OpenFile(pFile, theApp.GetSettings()->Sound.iSampleRate, theApp.GetSettings()->Sound.iSampleSize, 1)) {
+		TRACE0("SoundGen: Could not open file for rendering\n");
+		return false;
+	}
 
-//	if (m_bPlaying)
-//		HaltPlayer();
+	Render();
 
-//	m_iRenderEndWhen = (RENDER_END)SongEndType;
-//	m_iRenderEndParam = SongEndParam;
-//	m_iRenderedFrames = 0;
+	return true;
+}
 
-//	if (m_iRenderEndWhen == SONG_TIME_LIMIT) {
-//		// This variable is stored in seconds, convert to frames
-//		m_iRenderEndParam *= pDoc->GetFrameRate();
-//	}
-//	else if (m_iRenderEndWhen == SONG_LOOP_LIMIT) {
-//		m_iRenderEndParam = pDoc->ScanActualLength(pDoc->GetSelectedTrack(), m_iRenderEndParam);
-//	}
+bool CSoundGen::RenderToBuffer(QByteArray *pData, int Track, int SongEndType, int SongEndParam)
+{
+	if (!SetupRender(Track, SongEndType, SongEndParam))
+		return false;
 
-//	if (!m_wfWaveFile.OpenFile(pFile, theApp.GetSettings()->Sound.iSampleRate, theApp.GetSettings()->Sound.iSampleSize, 1)) {
-//		AfxMessageBox(IDS_FILE_OPEN_ERROR);
-//		return false;
-//	}
-//	else
-//		PostThreadMessage(WM_USER_START_RENDER, 0, 0);
+	if (!m_wfWaveFile.OpenBuffer(pData, theApp.GetSettings()->Sound.iSampleRate, theApp.GetSettings()->Sound.iSampleSize, 1))
+		return false;
 
-//	return true;
-//}
+	Render();
+
+	return true;
+}
+
+bool CSoundGen::SetupRender(int Track, int SongEndType, int SongEndParam)
+{
+	// Renders on the caller's thread, only sound generators made for
+	// rendering have no sound card to keep up with
+	if (!m_bOffline || !m_pDocument || !m_pDocument->IsFileLoaded())
+		return false;
+
+	if (Track < 0 || Track >= (int)m_pDocument->GetTrackCount())
+		return false;
+
+	m_iPlayTrack = Track;
+	m_iRenderEndWhen = (RENDER_END)SongEndType;
+	m_iRenderEndParam = SongEndParam;
+	m_iRenderedFrames = 0;
+
+	if (m_iRenderEndWhen == SONG_TIME_LIMIT) {
+		// This variable is stored in seconds, convert to frames
+		m_iRenderEndParam *= m_pDocument->GetFrameRate();
+	}
+	else if (m_iRenderEndWhen == SONG_LOOP_LIMIT) {
+		m_iRenderEndParam = m_pDocument->ScanActualLength(Track, m_iRenderEndParam);
+	}
+
+	return true;
+}
+
+void CSoundGen::Render()
+{
+	OnStartRender(0, 0);
+
+	while (m_bRendering)
+		OnIdle(0);
+}
 
 void CSoundGen::StopRendering()
 {
@@ -1295,21 +1459,24 @@ void CSoundGen::StopRendering()
 	m_bPlayerHalted = false;
 
 	m_bRendering = false;
-	m_pTrackerView->PlayerCommand(CMD_MOVE_TO_START, 0);
-   qDebug("rendering to wav needs to be implemented...");
-//	m_wfWaveFile.CloseFile();
+	PlayerCommand(CMD_MOVE_TO_START, 0);
+
+	// Write what's left of the last block
+	if (m_iBufferPtr > 0)
+		m_wfWaveFile.WriteWave((char*)m_pAccumBuffer, m_iBufferPtr * (m_iSampleSize / 8));
+	m_wfWaveFile.CloseFile();
 
 	MakeSilent();
 	ResetBuffer();
 }
 
-//void CSoundGen::GetRenderStat(int &Frame, int &Time, bool &Done, int &FramesToRender)
-//{
-//	Frame = m_iRenderedFrames;
-//	Time = m_iPlayTime / m_pTrackerView->GetDocument()->GetFrameRate();
-//	Done = m_bRendering;
-//	FramesToRender = m_iRenderEndParam;
-//}
+void CSoundGen::GetRenderStat(int &Frame, int &Time, bool &Done, int &FramesToRender)
+{
+	Frame = m_iRenderedFrames;
+	Time = m_iPlayTime / m_pDocument->GetFrameRate();
+	Done = m_bRendering;
+	FramesToRender = m_iRenderEndParam;
+}
 
 bool CSoundGen::IsRendering()
 {
@@ -1462,7 +1629,7 @@ BOOL CSoundGen::OnIdle(LONG lCount)
 	// Access the document object
 	m_csDocumentLock.Lock();
 
-	if (!m_pDocument || !m_pDSoundChannel) {
+	if (!m_pDocument || (!m_pDSoundChannel && !m_bOffline)) {
 		// Document is unloaded or no sound
 		m_csDocumentLock.Unlock();
 		// Wait for kill signal
@@ -1482,7 +1649,7 @@ BOOL CSoundGen::OnIdle(LONG lCount)
 			int Channel = m_pDocument->GetChannelType(i);
 
 			// TODO: clean up!
-			if (m_pTrackerView->Arpeggiate[i] > 0) {
+			if (m_pTrackerView && m_pTrackerView->Arpeggiate[i] > 0) {
 				m_pChannels[Channel]->Arpeggiate(m_pTrackerView->Arpeggiate[i]);
 				m_pTrackerView->Arpeggiate[i] = 0;
 			}
@@ -1491,7 +1658,7 @@ BOOL CSoundGen::OnIdle(LONG lCount)
 			if (m_pTrackerChannels[Channel]->NewNoteData()) {
 				stChanNote Note = m_pTrackerChannels[Channel]->GetNote();
 				//PlayNote(Channel, &Note, m_pTrackerChannels[Channel]->GetColumnCount() + 1);
-				PlayNote(Channel, &Note, m_pDocument->GetEffColumns(i) + 1);
+				PlayNote(Channel, &Note, m_pDocument->GetEffColumns(GetPlayerTrack(), i) + 1);
 			}
 
 			// Pitch wheel
@@ -1502,11 +1669,13 @@ BOOL CSoundGen::OnIdle(LONG lCount)
 			m_pTrackerChannels[Channel]->SetVolumeMeter(m_pAPU->GetVol(Channel));
 		}
 
-		int SelectedChan = m_pTrackerView->GetSelectedChannel();
-
 		// Instrument sequence visualization
-		if (m_pChannels[SelectedChan])
-			m_pChannels[SelectedChan]->UpdateSequencePlayPos();
+		if (m_pTrackerView) {
+			int SelectedChan = m_pTrackerView->GetSelectedChannel();
+
+			if (m_pChannels[SelectedChan])
+				m_pChannels[SelectedChan]->UpdateSequencePlayPos();
+		}
 	}
 
 
@@ -1578,7 +1747,10 @@ BOOL CSoundGen::OnIdle(LONG lCount)
 	if (m_iDelayedStart > 0) {
 		--m_iDelayedStart;
 		if (!m_iDelayedStart) {
-			PostThreadMessage(WM_USER_PLAY, MODE_PLAY_START, 0);
+			if (m_bOffline)
+				BeginPlayer(MODE_PLAY_START);
+			else
+				PostThreadMessage(WM_USER_PLAY, MODE_PLAY_START, 0);
 		}
 	}
 
@@ -28,6 +28,7 @@
 #include "Common.h"
 
 #include "FamiTrackerDoc.h"
+#include "WaveFile.h"
 
 //
 // This thread will take care of the NES sound generation
@@ -88,6 +89,10 @@ signals:
    void DrawSamples(int *Samples, int Count);
 public:
 	CSoundGen();
+	// Creates a sound generator that only renders pDoc to files. It has
+	// no sound card, views or thread of its own and runs on the caller's
+	// thread.
+	CSoundGen(CFamiTrackerDoc *pDoc);
 	virtual ~CSoundGen();
 
 	//
@@ -145,10 +150,11 @@ public:
 	void		 EvaluateGlobalEffects(stChanNote *NoteData, int EffColumns);
 	stDPCMState	 GetDPCMState() const;
 
-	// Rendering
-//	bool		 RenderToFile(char *File, int SongEndType, int SongEndParam);
+	// Rendering, only for sound generators made for rendering
+	bool		 RenderToFile(LPCTSTR pFile, int Track, int SongEndType, int SongEndParam);
+	bool		 RenderToBuffer(QByteArray *pData, int Track, int SongEndType, int SongEndParam);
 	void		 StopRendering();
-//	void		 GetRenderStat(int &Frame, int &Time, bool &Done);
+	void		 GetRenderStat(int &Frame, int &Time, bool &Done, int &FramesToRender);
 	bool		 IsRendering();
 	void		 CheckRenderStop();
 	void		 SongIsDone();
@@ -162,6 +168,7 @@ public:
 
 	// Used by channels
 	void		AddCycles(int Count);
+	void		RegisterKeyState(int Channel, int Note);
 
 	// Other
 	uint8		GetReg(int Chip, int Reg) const { return m_pAPU->GetReg(Chip, Reg); };
@@ -186,7 +193,13 @@ private:
 	bool		ResetSound();
 	void		CloseSound();
 
+	// Rendering
+	bool		SetupRender(int Track, int SongEndType, int SongEndParam);
+	void		Render();
+
 	// Player
+	int			PlayerCommand(char Command, int Value);
+	unsigned int GetPlayerTrack() const;
 	void	 	PlayNote(int Channel, stChanNote *NoteData, int EffColumns);
 	void		RunFrame();
 	void		CheckControl();
@@ -277,6 +290,10 @@ private:
 	unsigned int		m_iMachineType;						// NTSC/PAL
 
 	// Rendering
+	bool				m_bOffline;							// Only renders, has no sound card or views
+	int					m_iPlayTrack;						// Where a render is in the song
+	int					m_iPlayFrame;
+	int					m_iPlayRow;
 	RENDER_END			m_iRenderEndWhen;
 	int					m_iRenderEndParam;
 	int					m_iRenderedFrames;
@@ -291,7 +308,7 @@ private:
 	bool				m_bRequestRenderStop;
 	bool				m_bPlayerHalted;
 
-//	CWaveFile			m_wfWaveFile;
+	CWaveFile			m_wfWaveFile;
 
 	// FDS & N163 waves
 	bool				m_bWaveChanged;
@@ -0,0 +1,140 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2012  Jonathan Liss
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, 
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU 
+** Library General Public License for more details.  To obtain a 
+** copy of the GNU Library General Public License, write to the Free 
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+#include "stdafx.h"
+#include "WaveFile.h"
+
+// Size of the RIFF header with a single fmt chunk and the data chunk header
+static const int WAVE_HEADER_SIZE = 44;
+
+static void WriteLE(QIODevice *pDevice, unsigned int Value, int Bytes)
+{
+	char Data[4];
+
+	for (int i = 0; i < Bytes; ++i) {
+		Data[i] = (char)(Value & 0xFF);
+		Value >>= 8;
+	}
+
+	pDevice->write(Data, Bytes);
+}
+
+CWaveFile::CWaveFile() :
+	m_pDevice(NULL),
+	m_iSampleRate(0),
+	m_iSampleSize(0),
+	m_iChannels(0),
+	m_iDataSize(0)
+{
+}
+
+CWaveFile::~CWaveFile()
+{
+	CloseFile();
+}
+
+bool CWaveFile::OpenFile(LPCTSTR Filename, int SampleRate, int SampleSize, int Channels)
+{
+	CloseFile();
+
+	m_iSampleRate = SampleRate;
+	m_iSampleSize = SampleSize;
+	m_iChannels = Channels;
+	m_iDataSize = 0;
+
+	m_File.setFileName((const QString&)CString(Filename));
+
+	if (!m_File.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+
+	m_pDevice = &m_File;
+
+	// Sizes are unknown until the file is closed, they are patched then
+	WriteHeader();
+
+	return true;
+}
+
+bool CWaveFile::OpenBuffer(QByteArray *pData, int SampleRate, int SampleSize, int Channels)
+{
+	CloseFile();
+
+	m_iSampleRate = SampleRate;
+	m_iSampleSize = SampleSize;
+	m_iChannels = Channels;
+	m_iDataSize = 0;
+
+	m_Buffer.setBuffer(pData);
+
+	if (!m_Buffer.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+
+	m_pDevice = &m_Buffer;
+
+	WriteHeader();
+
+	return true;
+}
+
+void CWaveFile::CloseFile()
+{
+	if (!IsOpen())
+		return;
+
+	// Fill in the chunk sizes now that all data is written
+	m_pDevice->seek(0);
+	WriteHeader();
+
+	m_pDevice->close();
+	m_pDevice = NULL;
+}
+
+void CWaveFile::WriteWave(char *Data, int Size)
+{
+	if (!IsOpen())
+		return;
+
+	m_pDevice->write(Data, Size);
+	m_iDataSize += Size;
+}
+
+void CWaveFile::WriteHeader()
+{
+	int BlockAlign = m_iChannels * (m_iSampleSize / 8);
+
+	// RIFF chunk
+	m_pDevice->write("RIFF", 4);
+	WriteLE(m_pDevice, WAVE_HEADER_SIZE - 8 + m_iDataSize, 4);
+	m_pDevice->write("WAVE", 4);
+
+	// Format chunk, PCM
+	m_pDevice->write("fmt ", 4);
+	WriteLE(m_pDevice, 16, 4);
+	WriteLE(m_pDevice, 1, 2);
+	WriteLE(m_pDevice, m_iChannels, 2);
+	WriteLE(m_pDevice, m_iSampleRate, 4);
+	WriteLE(m_pDevice, m_iSampleRate * BlockAlign, 4);
+	WriteLE(m_pDevice, BlockAlign, 2);
+	WriteLE(m_pDevice, m_iSampleSize, 2);
+
+	// Data chunk
+	m_pDevice->write("data", 4);
+	WriteLE(m_pDevice, m_iDataSize, 4);
+}
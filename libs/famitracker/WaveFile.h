@@ -0,0 +1,56 @@
+/*
+** FamiTracker - NES/Famicom sound tracker
+** Copyright (C) 2005-2012  Jonathan Liss
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, 
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU 
+** Library General Public License for more details.  To obtain a 
+** copy of the GNU Library General Public License, write to the Free 
+** Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** Any permitted reproduction of these routines, in whole or in part,
+** must bear this legend.
+*/
+
+#pragma once
+
+#include <QBuffer>
+#include <QFile>
+
+#include "cqtmfc.h"
+
+//
+// PCM wave file writer, used when rendering a song to disk or to memory
+//
+
+class CWaveFile
+{
+public:
+	CWaveFile();
+	~CWaveFile();
+
+	bool OpenFile(LPCTSTR Filename, int SampleRate, int SampleSize, int Channels);
+	bool OpenBuffer(QByteArray *pData, int SampleRate, int SampleSize, int Channels);
+	void CloseFile();
+	void WriteWave(char *Data, int Size);
+
+	bool IsOpen() const { return m_pDevice && m_pDevice->isOpen(); };
+
+private:
+	void WriteHeader();
+
+private:
+	QFile	m_File;
+	QBuffer	m_Buffer;
+	QIODevice *m_pDevice;				// The file or the buffer
+	int		m_iSampleRate;
+	int		m_iSampleSize;
+	int		m_iChannels;
+	unsigned int m_iDataSize;
+};
@@ -63,6 +63,8 @@ LIBS += $$SDL_LIBS
 SOURCES += \
     TrackerChannel.cpp \
     SoundGen.cpp \
+    RenderBatch.cpp \
+    WaveFile.cpp \
     Settings.cpp \
     Sequence.cpp \
     PatternEditor.cpp \
@@ -111,7 +113,7 @@ SOURCES += \
     APU/emu2413.c \
     APU/emu2149.c \
     Blip_Buffer/Blip_Buffer.cpp \
-    FFT/Fft.cpp \
+    FFT/RealFft.cpp \
     ../../common/cqtmfc.cpp \
     FamiTrackerView.cpp \
     FamiTracker.cpp \
@@ -123,6 +125,8 @@ SOURCES += \
 HEADERS += \
     TrackerChannel.h \
     SoundGen.h \
+    RenderBatch.h \
+    WaveFile.h \
     Settings.h \
     Sequence.h \
     PatternEditor.h \
@@ -181,8 +185,7 @@ HEADERS += \
     drivers/drv_fds.h \
     drivers/drv_2a03.h \
     drivers/config.h \
-    FFT/Fft.h \
-    FFT/Complex.h \
+    FFT/RealFft.h \
     ../../common/cqtmfc.h \
     FamiTrackerView.h \
     FamiTracker.h \
@@ -21,6 +21,8 @@
 #include "cnesios.h"
 #include "cnesio.h"
 #include "cnesapu.h"
+#include "cnesmovie.h"
+#include "cnesscheduler.h"
 
 int32_t  CNES::m_videoMode = MODE_NTSC;
 int32_t  CNES::m_controllerType [] = { IO_StandardJoypad, IO_Zapper };
@@ -267,6 +269,10 @@ uint32_t CNES::ABSADDR ( uint32_t addr )
 
 void CNES::RESET ( uint32_t mapper, bool soft )
 {
+   // Forget anything the old machine had scheduled; each element
+   // schedules what it needs as it is reset below.
+   CScheduler::RESET ();
+
    if ( nesIsDebuggable() )
    {
       // Clear execution tracer sample buffer...
@@ -894,6 +900,9 @@ void CNES::RUN ( uint32_t* joy )
    *(ljoy+CONTROLLER1) = *(joy+CONTROLLER1);
    *(ljoy+CONTROLLER2) = *(joy+CONTROLLER2);
 
+   // Record the input into a movie, or take it from one...
+   CMovie::INPUT ( ljoy );
+
    if ( m_bRecord )
    {
       CIOStandardJoypad::LOGGER(0)->AddSample ( C6502::_CYCLES(), *(ljoy+CONTROLLER1) );
@@ -1033,6 +1042,10 @@ void CNES::RUN ( uint32_t* joy )
    // Pre-render scanline...
    CPPU::RENDERSCANLINE ( -1 );
 
+   // Bring the APU up to the end of the frame so all of the
+   // frame's audio samples are available...
+   CAPU::SYNC ();
+
    if ( nesIsDebuggable() )
    {
       // Emit end-of-prerender scanline indication to Tracer...
@@ -817,7 +817,7 @@ void C6502::ADVANCE ( bool stealing )
    // Tell mappers that look at CPU cycles that a CPU cycle has whisked by...
    MAPPERFUNC->sync_cpu();
 
-   // Run APU for one cycle...
+   // Let the APU, and anything else waiting on this cycle, see it...
    CAPU::EMULATE ();
 
    // Increment running cycle counters...
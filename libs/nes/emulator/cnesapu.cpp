@@ -17,6 +17,9 @@
 #include "cnesapu.h"
 #include "cnes6502.h"
 #include "cnesppu.h"
+#include "cnesrom.h"
+#include "cnesmappers.h"
+#include "cnesscheduler.h"
 
 //#define OUTPUT_WAV
 
@@ -234,7 +237,13 @@ uint16_t*      CAPU::m_waveBuf = NULL;
 int32_t        CAPU::m_waveBufProduce = 0;
 int32_t        CAPU::m_waveBufConsume = 0;
 
+uint8_t        CAPU::m_dacHistory [ NUM_APU_CHANNELS ][ APU_HISTORY_SIZE ];
+int32_t        CAPU::m_dacHistoryPos = 0;
+
 uint32_t CAPU::m_cycles = 0;
+uint32_t CAPU::m_sequencerCycle = 0xFFFFFFFF;
+uint32_t CAPU::m_syncCycle = 0;
+bool     CAPU::m_lockstep = false;
 
 float        CAPU::m_sampleSpacer = 0.0;
 
@@ -270,6 +279,88 @@ static int32_t m_seq5 [ 5 ] =
    0
 };
 
+// Frame sequencer schedule.  Each entry gives the APU cycle at which
+// the sequencer has something to do and what it is.  The frame
+// sequencer schedules its next entry with the scheduler rather than
+// checking its cycle count against all of these every APU cycle.
+enum
+{
+   APU_SEQ_ACTION_TICK0 = 0,
+   APU_SEQ_ACTION_TICK1,
+   APU_SEQ_ACTION_TICK2,
+   APU_SEQ_ACTION_TICK3,
+   APU_SEQ_ACTION_STEP,
+   APU_SEQ_ACTION_IRQ
+};
+
+typedef struct _APUSequencerEvent
+{
+   uint32_t cycle;
+   int32_t  action;
+} APUSequencerEvent;
+
+static APUSequencerEvent m_seqEventsNTSC4 [] =
+{
+   { 7459, APU_SEQ_ACTION_TICK0 },
+   { 14915, APU_SEQ_ACTION_TICK1 },
+   { 22373, APU_SEQ_ACTION_TICK2 },
+   { 29830, APU_SEQ_ACTION_IRQ },
+   { 29831, APU_SEQ_ACTION_TICK3 },
+   { 29832, APU_SEQ_ACTION_IRQ }
+};
+
+static APUSequencerEvent m_seqEventsNTSC5 [] =
+{
+   { 1, APU_SEQ_ACTION_TICK0 },
+   { 7459, APU_SEQ_ACTION_TICK1 },
+   { 14915, APU_SEQ_ACTION_TICK2 },
+   { 22373, APU_SEQ_ACTION_TICK3 },
+   { 29829, APU_SEQ_ACTION_STEP }
+};
+
+static APUSequencerEvent m_seqEventsPAL4 [] =
+{
+   { 8315, APU_SEQ_ACTION_TICK0 },
+   { 16629, APU_SEQ_ACTION_TICK1 },
+   { 24941, APU_SEQ_ACTION_TICK2 },
+   { 33254, APU_SEQ_ACTION_IRQ },
+   { 33255, APU_SEQ_ACTION_TICK3 },
+   { 33256, APU_SEQ_ACTION_IRQ }
+};
+
+static APUSequencerEvent m_seqEventsPAL5 [] =
+{
+   { 1, APU_SEQ_ACTION_TICK0 },
+   { 8315, APU_SEQ_ACTION_TICK1 },
+   { 16629, APU_SEQ_ACTION_TICK2 },
+   { 24941, APU_SEQ_ACTION_TICK3 },
+   { 33255, APU_SEQ_ACTION_STEP }
+};
+
+static inline APUSequencerEvent* SEQUENCEREVENTS ( int32_t sequencerMode, int32_t* count )
+{
+   if ( (CNES::VIDEOMODE() == MODE_NTSC) || (CNES::VIDEOMODE() == MODE_DENDY) )
+   {
+      if ( sequencerMode )
+      {
+         (*count) = sizeof(m_seqEventsNTSC5)/sizeof(APUSequencerEvent);
+         return m_seqEventsNTSC5;
+      }
+      (*count) = sizeof(m_seqEventsNTSC4)/sizeof(APUSequencerEvent);
+      return m_seqEventsNTSC4;
+   }
+   else
+   {
+      if ( sequencerMode )
+      {
+         (*count) = sizeof(m_seqEventsPAL5)/sizeof(APUSequencerEvent);
+         return m_seqEventsPAL5;
+      }
+      (*count) = sizeof(m_seqEventsPAL4)/sizeof(APUSequencerEvent);
+      return m_seqEventsPAL4;
+   }
+}
+
 static uint8_t m_lengthLUT [ 32 ] =
 {
    0x0A,
@@ -326,6 +417,151 @@ CAPU::CAPU()
 
    m_waveBuf = new uint16_t [ APU_BUFFER_SIZE ];
    memset( m_waveBuf, 0, APU_BUFFER_SIZE * sizeof m_waveBuf[ 0 ] );
+
+   memset( m_dacHistory, 0, sizeof m_dacHistory );
+   m_dacHistoryPos = 0;
+
+   CScheduler::HANDLER ( SCHEDULER_EVENT_APU, CAPU::SYNCEVENT );
+}
+
+void CAPU::SCHEDULESEQUENCER ( bool now )
+{
+   APUSequencerEvent* pEvents;
+   int32_t count;
+   int32_t idx;
+
+   pEvents = SEQUENCEREVENTS ( m_sequencerMode, &count );
+
+   // Find the next thing the sequencer needs to do.  If the cycle counter
+   // was just reset something might need to happen on this very cycle.
+   for ( idx = 0; idx < count; idx++ )
+   {
+      if ( (pEvents[idx].cycle > m_cycles) ||
+           (now && (pEvents[idx].cycle == m_cycles)) )
+      {
+         m_sequencerCycle = pEvents[idx].cycle;
+         return;
+      }
+   }
+
+   // Nothing more to do until the cycle counter wraps...
+   m_sequencerCycle = 0xFFFFFFFF;
+}
+
+uint32_t CAPU::FRAMECYCLES ( void )
+{
+   // The cycle counter is reset when it gets here...
+   if ( (CNES::VIDEOMODE() == MODE_NTSC) || (CNES::VIDEOMODE() == MODE_DENDY) )
+   {
+      return m_sequencerMode?37283:37289;
+   }
+   return m_sequencerMode?41567:41569;
+}
+
+void CAPU::SCHEDULESYNC ( void )
+{
+   uint32_t cycles = 0xFFFFFFFF;
+   int32_t  dmaCycles;
+
+   if ( m_changeModes >= 0 )
+   {
+      // The frame sequencer is about to be restarted...
+      cycles = m_changeModes;
+   }
+   else if ( m_irqEnabled )
+   {
+      // The CPU needs to see the frame IRQ on the right cycle.  The
+      // sequencer is restarted at the end of the frame...
+      cycles = FRAMECYCLES()-m_cycles;
+
+      if ( (m_sequencerCycle >= m_cycles) &&
+           (m_sequencerCycle-m_cycles < cycles) )
+      {
+         cycles = m_sequencerCycle-m_cycles;
+      }
+   }
+
+   // The CPU needs to be asked for DMC sample data on the right cycle.
+   dmaCycles = m_dmc.DMACYCLES ();
+   if ( (dmaCycles >= 0) && (((uint32_t)dmaCycles) < cycles) )
+   {
+      cycles = dmaCycles;
+   }
+
+   if ( cycles != 0xFFFFFFFF )
+   {
+      CScheduler::SCHEDULE ( SCHEDULER_EVENT_APU, m_syncCycle+cycles );
+   }
+   else
+   {
+      CScheduler::CANCEL ( SCHEDULER_EVENT_APU );
+   }
+}
+
+void CAPU::SYNC ( uint32_t cycle )
+{
+   int32_t cycles = (int32_t)(cycle-m_syncCycle);
+
+   if ( cycles > 0 )
+   {
+      m_syncCycle = cycle;
+      RUN ( cycles );
+      SCHEDULESYNC ();
+   }
+}
+
+void CAPU::SYNCEVENT ( void )
+{
+   // The event is dispatched before the scheduler clock moves past
+   // the CPU cycle it was scheduled for, so run that cycle too.
+   SYNC ( CScheduler::CYCLES()+1 );
+}
+
+void CAPU::SEQUENCER ( void )
+{
+   APUSequencerEvent* pEvents;
+   int32_t count;
+   int32_t idx;
+
+   pEvents = SEQUENCEREVENTS ( m_sequencerMode, &count );
+
+   for ( idx = 0; idx < count; idx++ )
+   {
+      if ( pEvents[idx].cycle == m_cycles )
+      {
+         if ( pEvents[idx].action == APU_SEQ_ACTION_IRQ )
+         {
+            if ( m_irqEnabled )
+            {
+               m_irqAsserted = true;
+               C6502::ASSERTIRQ(eNESSource_APU);
+
+               if ( nesIsDebuggable() )
+               {
+                  // Check for IRQ breakpoint...
+                  CNES::CHECKBREAKPOINT(eBreakInAPU,eBreakOnAPUEvent,0,APU_EVENT_IRQ);
+               }
+            }
+         }
+         else
+         {
+            if ( nesIsDebuggable() )
+            {
+               // Emit frame-end indication to Tracer...
+               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
+            }
+
+            if ( pEvents[idx].action != APU_SEQ_ACTION_STEP )
+            {
+               // IRQ in 4-step mode is asserted inside SEQTICK...
+               SEQTICK ( pEvents[idx].action );
+            }
+         }
+         break;
+      }
+   }
+
+   SCHEDULESEQUENCER ( false );
 }
 
 uint8_t* CAPU::PLAY ( uint16_t samples )
@@ -342,6 +578,36 @@ uint8_t* CAPU::PLAY ( uint16_t samples )
    return (uint8_t*)waveBuf;
 }
 
+void CAPU::HISTORY ( int32_t channel, int16_t* samples, uint32_t count )
+{
+   int32_t pos;
+   uint32_t idx;
+
+   if ( count > APU_HISTORY_SIZE )
+   {
+      count = APU_HISTORY_SIZE;
+   }
+
+   if ( channel < NUM_APU_CHANNELS )
+   {
+      pos = (m_dacHistoryPos+APU_HISTORY_SIZE-count)%APU_HISTORY_SIZE;
+      for ( idx = 0; idx < count; idx++ )
+      {
+         samples[idx] = m_dacHistory[channel][pos];
+         pos = (pos+1)%APU_HISTORY_SIZE;
+      }
+   }
+   else
+   {
+      pos = (m_waveBufProduce+APU_BUFFER_SIZE-count)%APU_BUFFER_SIZE;
+      for ( idx = 0; idx < count; idx++ )
+      {
+         samples[idx] = (int16_t)m_waveBuf[pos];
+         pos = (pos+1)%APU_BUFFER_SIZE;
+      }
+   }
+}
+
 uint16_t CAPU::AMPLITUDE ( void )
 {
    float famp;
@@ -557,8 +823,15 @@ void CAPU::RESET ( void )
       m_sampleSpacer = APU_SAMPLE_SPACE_PAL;
    }
 
-   m_cycles = 0;
+   // Mappers that mix in their own audio are clocked on every
+   // CPU cycle so the APU has to keep up with them.
+   m_lockstep = (MAPPERFUNC->amplitude != CROM::AMPLITUDE);
+   m_syncCycle = CScheduler::CYCLES();
+
+   RESETCYCLECOUNTER(0);
    apuDataAvailable = 0;
+
+   SCHEDULESYNC ();
 }
 
 CAPUOscillator::CAPUOscillator (uint8_t periodAdjust) :
@@ -1347,6 +1620,24 @@ void CAPUDMC::DMASAMPLE ( uint8_t data )
    }
 }
 
+int32_t CAPUDMC::DMACYCLES ( void ) const
+{
+   int32_t cycles;
+
+   // The DMA reader only asks for more sample data when the sample buffer
+   // is emptied into the output shift register, which happens on the
+   // divider clock that finds the output shift register empty.
+   if ( (!m_period) || (!m_sampleBufferFull) || (!m_lengthCounter) || (m_dmaSource != NULL) )
+   {
+      return -1;
+   }
+
+   cycles = (m_periodCounter > 1)?(m_periodCounter-1):0;
+   cycles += m_outputShiftCounter*m_period;
+
+   return cycles;
+}
+
 void CAPUDMC::DMAREADER ( void )
 {
    if ( !m_sampleBufferFull )
@@ -1422,275 +1713,12 @@ void CAPUDMC::TIMERTICK ( void )
    }
 }
 
-void CAPU::EMULATE ( void )
+static float takeSample = 0.0f;
+
+void CAPU::TICK ( void )
 {
-   static float takeSample = 0.0f;
    uint16_t* pWaveBuf;
 
-   // Handle APU clock jitter.  Mode changes occur
-   // only on even APU clocks.  On a mode change write
-   // to $4017, m_changeModes is set to either 0 or
-   // 1 indicating that the mode change should happen
-   // in 0 or 1 clocks from now.  Do the mode change
-   // when m_changeModes is 0; decrement it if it isn't 0.
-   if ( m_changeModes == 0 )
-   {
-      // Do mode-change now...
-      m_changeModes--;
-      m_sequencerMode = m_newSequencerMode;
-      m_sequenceStep = 0;
-      RESETCYCLECOUNTER(0);
-
-      if ( nesIsDebuggable() )
-      {
-         // Emit frame-start indication to Tracer...
-         CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_StartAPUFrame, eNESSource_APU, 0, 0, 0 );
-      }
-   }
-
-   if ( m_changeModes > 0 )
-   {
-      m_changeModes--;
-   }
-
-   // Clock the 240Hz sequencer.
-   // NTSC APU
-   if ( (CNES::VIDEOMODE() == MODE_NTSC) || (CNES::VIDEOMODE() == MODE_DENDY) )
-   {
-      // APU sequencer mode 1
-      if ( m_sequencerMode )
-      {
-         if ( m_cycles == 1 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            SEQTICK ( 0 );
-         }
-         else if ( m_cycles == 7459 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            SEQTICK ( 1 );
-         }
-         else if ( m_cycles == 14915 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            SEQTICK ( 2 );
-         }
-         else if ( m_cycles == 22373 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            SEQTICK ( 3 );
-         }
-         else if ( m_cycles == 29829 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            // Nothing to do this "tick"...
-         }
-      }
-      // APU sequencer mode 0
-      else
-      {
-         if ( m_cycles == 7459 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            SEQTICK ( 0 );
-         }
-         else if ( m_cycles == 14915 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            SEQTICK ( 1 );
-         }
-         else if ( m_cycles == 22373 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            SEQTICK ( 2 );
-         }
-         else if ( (m_cycles == 29830) ||
-                   (m_cycles == 29832) )
-         {
-            if ( m_irqEnabled )
-            {
-               m_irqAsserted = true;
-               C6502::ASSERTIRQ(eNESSource_APU);
-
-               if ( nesIsDebuggable() )
-               {
-                  // Check for IRQ breakpoint...
-                  CNES::CHECKBREAKPOINT(eBreakInAPU,eBreakOnAPUEvent,0,APU_EVENT_IRQ);
-               }
-            }
-         }
-         else if ( m_cycles == 29831 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            // IRQ asserted inside SEQTICK...
-            SEQTICK ( 3 );
-         }
-      }
-   }
-   // PAL APU
-   else
-   {
-      // APU sequencer mode 1
-      if ( m_sequencerMode )
-      {
-         if ( m_cycles == 1 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            SEQTICK ( 0 );
-         }
-         else if ( m_cycles == 8315 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            SEQTICK ( 1 );
-         }
-         else if ( m_cycles == 16629 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            SEQTICK ( 2 );
-         }
-         else if ( m_cycles == 24941 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            SEQTICK ( 3 );
-         }
-         else if ( m_cycles == 33255 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            // Nothing to do this "tick"...
-         }
-      }
-      // APU sequencer mode 0
-      else
-      {
-         if ( m_cycles == 8315 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            SEQTICK ( 0 );
-         }
-         else if ( m_cycles == 16629 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            SEQTICK ( 1 );
-         }
-         else if ( m_cycles == 24941 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            SEQTICK ( 2 );
-         }
-         else if ( (m_cycles == 33254) ||
-                   (m_cycles == 33256) )
-         {
-            if ( m_irqEnabled )
-            {
-               m_irqAsserted = true;
-               C6502::ASSERTIRQ(eNESSource_APU);
-
-               if ( nesIsDebuggable() )
-               {
-                  // Check for IRQ breakpoint...
-                  CNES::CHECKBREAKPOINT(eBreakInAPU,eBreakOnAPUEvent,0,APU_EVENT_IRQ);
-               }
-            }
-         }
-         else if ( m_cycles == 33255 )
-         {
-            if ( nesIsDebuggable() )
-            {
-               // Emit frame-end indication to Tracer...
-               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
-            }
-
-            // IRQ asserted inside SEQTICK...
-            SEQTICK ( 3 );
-         }
-      }
-   }
-
    // Clock the individual channels.
    m_square[0].TIMERTICK ();
    m_square[1].TIMERTICK ();
@@ -1732,6 +1760,17 @@ if ( wavOut )
 
       m_waveBufProduce %= APU_BUFFER_SIZE;
 
+      // Keep the channels' DACs for visualisers.
+      m_dacHistory[0][m_dacHistoryPos] = m_square[0].GETDAC();
+      m_dacHistory[1][m_dacHistoryPos] = m_square[1].GETDAC();
+      m_dacHistory[2][m_dacHistoryPos] = m_triangle.GETDAC();
+      m_dacHistory[3][m_dacHistoryPos] = m_noise.GETDAC();
+      m_dacHistory[4][m_dacHistoryPos] = m_dmc.GETDAC();
+
+      m_dacHistoryPos++;
+
+      m_dacHistoryPos %= APU_HISTORY_SIZE;
+
       apuDataAvailable++;
 
       if ( apuDataAvailable >= APU_BUFFER_PRERENDER )
@@ -1739,21 +1778,29 @@ if ( wavOut )
          nesBreakAudio();
       }
    }
+}
 
-   // Go to next cycle and restart if necessary...
-   m_cycles++;
-
-   if ( (CNES::VIDEOMODE() == MODE_NTSC) || (CNES::VIDEOMODE() == MODE_DENDY) )
-   {
-      if ( (m_sequencerMode) && (m_cycles >= 37283) )
+void CAPU::RUN ( uint32_t cycles )
+{
+   uint32_t frameCycles;
+   uint32_t span;
+   uint32_t idx;
+
+   while ( cycles )
+   {
+      // Handle APU clock jitter.  Mode changes occur
+      // only on even APU clocks.  On a mode change write
+      // to $4017, m_changeModes is set to either 0 or
+      // 1 indicating that the mode change should happen
+      // in 0 or 1 clocks from now.  Do the mode change
+      // when m_changeModes is 0; decrement it if it isn't 0.
+      if ( m_changeModes == 0 )
       {
-         if ( nesIsDebuggable() )
-         {
-            // Emit frame-end indication to Tracer...
-            CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_EndAPUFrame, eNESSource_APU, 0, 0, 0 );
-         }
-
-         RESETCYCLECOUNTER(1);
+         // Do mode-change now...
+         m_changeModes--;
+         m_sequencerMode = m_newSequencerMode;
+         m_sequenceStep = 0;
+         RESETCYCLECOUNTER(0);
 
          if ( nesIsDebuggable() )
          {
@@ -1761,55 +1808,115 @@ if ( wavOut )
             CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_StartAPUFrame, eNESSource_APU, 0, 0, 0 );
          }
       }
-      else if ( (!m_sequencerMode) && (m_cycles >= 37289) )
+
+      if ( m_changeModes > 0 )
       {
-         if ( nesIsDebuggable() )
-         {
-            // Emit frame-end indication to Tracer...
-            CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_EndAPUFrame, eNESSource_APU, 0, 0, 0 );
-         }
+         m_changeModes--;
+      }
 
-         RESETCYCLECOUNTER(7459);
+      // Clock the 240Hz sequencer if it's due.
+      if ( m_cycles == m_sequencerCycle )
+      {
+         SEQUENCER ();
+      }
 
-         if ( nesIsDebuggable() )
+      // Nothing but the channels needs attention until the next
+      // sequencer step, the end of the frame, or a mode change.
+      span = 1;
+      frameCycles = FRAMECYCLES ();
+
+      if ( (m_changeModes < 0) && (m_cycles < frameCycles) )
+      {
+         span = frameCycles-m_cycles;
+
+         if ( (m_sequencerCycle > m_cycles) &&
+              (m_sequencerCycle-m_cycles < span) )
          {
-            // Emit frame-start indication to Tracer...
-            CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_StartAPUFrame, eNESSource_APU, 0, 0, 0 );
+            span = m_sequencerCycle-m_cycles;
+         }
+         if ( span > cycles )
+         {
+            span = cycles;
          }
       }
-   }
-   else // MODE_PAL
-   {
-      if ( (m_sequencerMode) && (m_cycles >= 41567) )
+
+      for ( idx = 0; idx < span; idx++ )
       {
-         if ( nesIsDebuggable() )
+         TICK ();
+      }
+      cycles -= span;
+
+      // Go to next cycle and restart if necessary...
+      m_cycles += span;
+
+      if ( (CNES::VIDEOMODE() == MODE_NTSC) || (CNES::VIDEOMODE() == MODE_DENDY) )
+      {
+         if ( (m_sequencerMode) && (m_cycles >= 37283) )
          {
-            // Emit frame-end indication to Tracer...
-            CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_EndAPUFrame, eNESSource_APU, 0, 0, 0 );
-         }
+            if ( nesIsDebuggable() )
+            {
+               // Emit frame-end indication to Tracer...
+               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_EndAPUFrame, eNESSource_APU, 0, 0, 0 );
+            }
 
-         RESETCYCLECOUNTER(1);
+            RESETCYCLECOUNTER(1);
 
-         if ( nesIsDebuggable() )
+            if ( nesIsDebuggable() )
+            {
+               // Emit frame-start indication to Tracer...
+               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_StartAPUFrame, eNESSource_APU, 0, 0, 0 );
+            }
+         }
+         else if ( (!m_sequencerMode) && (m_cycles >= 37289) )
          {
-            // Emit frame-start indication to Tracer...
-            CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_StartAPUFrame, eNESSource_APU, 0, 0, 0 );
+            if ( nesIsDebuggable() )
+            {
+               // Emit frame-end indication to Tracer...
+               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_EndAPUFrame, eNESSource_APU, 0, 0, 0 );
+            }
+
+            RESETCYCLECOUNTER(7459);
+
+            if ( nesIsDebuggable() )
+            {
+               // Emit frame-start indication to Tracer...
+               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_StartAPUFrame, eNESSource_APU, 0, 0, 0 );
+            }
          }
       }
-      else if ( (!m_sequencerMode) && (m_cycles >= 41569) )
+      else // MODE_PAL
       {
-         if ( nesIsDebuggable() )
+         if ( (m_sequencerMode) && (m_cycles >= 41567) )
          {
-            // Emit frame-end indication to Tracer...
-            CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_EndAPUFrame, eNESSource_APU, 0, 0, 0 );
-         }
+            if ( nesIsDebuggable() )
+            {
+               // Emit frame-end indication to Tracer...
+               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_EndAPUFrame, eNESSource_APU, 0, 0, 0 );
+            }
 
-         RESETCYCLECOUNTER(8315);
+            RESETCYCLECOUNTER(1);
 
-         if ( nesIsDebuggable() )
+            if ( nesIsDebuggable() )
+            {
+               // Emit frame-start indication to Tracer...
+               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_StartAPUFrame, eNESSource_APU, 0, 0, 0 );
+            }
+         }
+         else if ( (!m_sequencerMode) && (m_cycles >= 41569) )
          {
-            // Emit frame-start indication to Tracer...
-            CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_StartAPUFrame, eNESSource_APU, 0, 0, 0 );
+            if ( nesIsDebuggable() )
+            {
+               // Emit frame-end indication to Tracer...
+               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_EndAPUFrame, eNESSource_APU, 0, 0, 0 );
+            }
+
+            RESETCYCLECOUNTER(8315);
+
+            if ( nesIsDebuggable() )
+            {
+               // Emit frame-start indication to Tracer...
+               CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_StartAPUFrame, eNESSource_APU, 0, 0, 0 );
+            }
          }
       }
    }
@@ -1827,6 +1934,9 @@ uint32_t CAPU::APU ( uint32_t addr )
 {
    uint32_t data = 0x00;
 
+   // Bring the APU up to the cycle the CPU is reading on...
+   SYNC ();
+
    if ( addr == APUCTRL )
    {
       data |= (m_square[0].LENGTH()?0x01:0x00);
@@ -1857,6 +1967,9 @@ uint32_t CAPU::APU ( uint32_t addr )
 
 void CAPU::APU ( uint32_t addr, uint8_t data )
 {
+   // Bring the APU up to the cycle the CPU is writing on...
+   SYNC ();
+
    // For APU recording...
    m_APUreg [ addr&0x1F ] = data;
    m_APUregDirty [ addr&0x1F ] = 1;
@@ -1910,6 +2023,9 @@ void CAPU::APU ( uint32_t addr, uint8_t data )
       m_changeModes = C6502::_CYCLES()&1;
    }
 
+   // The write may have changed when the APU next needs attention...
+   SCHEDULESYNC ();
+
    if ( nesIsDebuggable() )
    {
       CNES::CHECKBREAKPOINT(eBreakInAPU,eBreakOnAPUState,addr&0x1F);
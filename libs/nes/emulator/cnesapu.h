@@ -3,6 +3,7 @@
 
 #include "nes_emulator_core.h"
 
+#include "cnesscheduler.h"
 #include "cregisterdata.h"
 #include "cbreakpointinfo.h"
 
@@ -488,6 +489,11 @@ public:
 
    void DMASAMPLE ( uint8_t data );
 
+   // This method returns how many APU cycles from now the DMA reader
+   // will next ask the CPU for sample data, or -1 if it won't until
+   // something outside the channel changes its state.
+   int32_t DMACYCLES ( void ) const;
+
    // These methods deal with the delta-modulation channel's interrupt flag.
    bool IRQASSERTED ( void ) const
    {
@@ -586,9 +592,33 @@ public:
    static void RESET ( void );
    static uint32_t APU ( uint32_t addr );
    static void APU ( uint32_t addr, uint8_t data );
-   static void EMULATE ( void );
    static uint8_t* PLAY ( uint16_t samples );
 
+   // The APU is not run on every CPU cycle.  Instead it catches up in
+   // batches whenever the CPU touches it or when its scheduler event
+   // comes due.  Its event is due on the cycle of the next frame
+   // sequencer step, $4017 mode change, or DMC DMA request since those
+   // are the only things the APU does that the rest of the NES can see
+   // without asking.  It is run in lock-step with the CPU when the
+   // debuggers are watching or when the mapper mixes in its own audio.
+   static inline void EMULATE ( void )
+   {
+      CScheduler::DISPATCH ();
+      CScheduler::CLOCK ();
+
+      if ( m_lockstep || nesIsDebuggable() )
+      {
+         SYNC ();
+      }
+   }
+
+   // Run the APU up to the current CPU cycle.
+   static inline void SYNC ( void )
+   {
+      SYNC ( CScheduler::CYCLES() );
+   }
+   static void SYNC ( uint32_t cycle );
+
    static void DMASOURCE ( uint8_t* source )
    {
       m_dmc.DMASOURCE ( source );
@@ -596,7 +626,9 @@ public:
 
    static void DMASAMPLE ( uint8_t data )
    {
+      SYNC ();
       m_dmc.DMASAMPLE ( data );
+      SCHEDULESYNC ();
    }
 
    static uint8_t MUTED ( void )
@@ -633,11 +665,21 @@ public:
 
    static void RELEASEIRQ ( void );
    static inline void SEQTICK ( int32_t sequence );
+   static void SEQUENCER ( void );
+   static void SCHEDULESEQUENCER ( bool now );
+   static void SCHEDULESYNC ( void );
+   static void SYNCEVENT ( void );
+   static void RUN ( uint32_t cycles );
+   static inline void TICK ( void );
+   static inline uint32_t FRAMECYCLES ( void );
    static inline uint16_t AMPLITUDE ( void );
 
    static inline void RESETCYCLECOUNTER ( uint32_t cycle )
    {
       m_cycles = cycle;
+
+      // Frame sequencer needs to know where it is now...
+      SCHEDULESEQUENCER ( true );
    }
    static inline uint32_t CYCLES ( void )
    {
@@ -692,6 +734,10 @@ public:
       (*full) = m_dmc.SAMPLEBUFFERFULL();
    }
 
+   // Most recent samples of a channel's DAC or, for NUM_APU_CHANNELS,
+   // the mixed output, oldest first.
+   static void HISTORY ( int32_t channel, int16_t* samples, uint32_t count );
+
    static CRegisterDatabase* REGISTERS()
    {
       return m_dbRegisters;
@@ -726,8 +772,20 @@ protected:
    static int32_t m_waveBufProduce;
    static int32_t m_waveBufConsume;
 
+   static uint8_t m_dacHistory [ NUM_APU_CHANNELS ][ APU_HISTORY_SIZE ];
+   static int32_t m_dacHistoryPos;
+
    static uint32_t   m_cycles;
 
+   // The APU cycle on which the frame sequencer next has something to do.
+   static uint32_t   m_sequencerCycle;
+
+   // The CPU cycle, as counted by the scheduler, the APU has been run up to.
+   static uint32_t   m_syncCycle;
+
+   // Whether or not the APU must be run on every CPU cycle.
+   static bool       m_lockstep;
+
    static float m_sampleSpacer;
 
    static CRegisterDatabase* m_dbRegisters;
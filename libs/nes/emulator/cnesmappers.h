@@ -3,6 +3,9 @@
 
 #include "nes_emulator_core.h"
 
+// Mapper table entry for the NSF player; it follows the iNES mappers.
+#define MAPPER_NSF 256
+
 typedef void (*RESETFUNC)(bool soft);
 typedef uint32_t (*MAPPERRFUNC)(uint32_t addr);
 typedef void (*MAPPERWFUNC)(uint32_t addr, uint8_t data);
@@ -0,0 +1,616 @@
+//    NESICIDE - an IDE for the 8-bit NES.
+//    Copyright (C) 2009  Christopher S. Pow
+
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "cnesmovie.h"
+
+#include "cnes.h"
+#include "cnes6502.h"
+#include "cnesppu.h"
+#include "cnesapu.h"
+#include "cnesrom.h"
+
+#include <stdio.h>
+#include <string.h>
+
+bool      CMovie::m_recording = false;
+bool      CMovie::m_playing = false;
+uint32_t  CMovie::m_frame = 0;
+int32_t   CMovie::m_desyncFrame = MOVIE_IN_SYNC;
+uint8_t   CMovie::m_romSHA1 [ 20 ];
+uint8_t   CMovie::m_systemMode = MODE_NTSC;
+uint8_t   CMovie::m_controller [ NUM_CONTROLLERS ];
+bool      CMovie::m_settingsSaved = false;
+uint8_t   CMovie::m_savedSystemMode = MODE_NTSC;
+uint8_t   CMovie::m_savedController [ NUM_CONTROLLERS ];
+uint32_t  CMovie::m_checksumInterval = MOVIE_DEFAULT_INTERVAL;
+uint8_t*  CMovie::m_sram = NULL;
+uint32_t  CMovie::m_sramSize = 0;
+uint8_t*  CMovie::m_input = NULL;
+uint32_t  CMovie::m_inputCapacity = 0;
+uint32_t  CMovie::m_numFrames = 0;
+uint8_t*  CMovie::m_checksums = NULL;
+uint32_t  CMovie::m_checksumsCapacity = 0;
+uint32_t  CMovie::m_numChecksums = 0;
+
+static const uint8_t movieMagic [ 4 ] = { 'N', 'M', 'V', 0x1A };
+
+static inline void moviePut32 ( uint8_t* buffer, uint32_t data )
+{
+   *(buffer+0) = data&0xFF;
+   *(buffer+1) = (data>>8)&0xFF;
+   *(buffer+2) = (data>>16)&0xFF;
+   *(buffer+3) = (data>>24)&0xFF;
+}
+
+static inline uint32_t movieGet32 ( const uint8_t* buffer )
+{
+   return (*(buffer+0))|((*(buffer+1))<<8)|((*(buffer+2))<<16)|((*(buffer+3))<<24);
+}
+
+// SHA-1, as used to identify ROMs in the game database.
+typedef struct
+{
+   uint32_t h [ 5 ];
+   uint8_t  block [ 64 ];
+   uint32_t used;
+   uint32_t length;
+} SHA1Context;
+
+#define SHA1ROL(x,n) ( ((x)<<(n))|((x)>>(32-(n))) )
+
+static void sha1Init ( SHA1Context* ctx )
+{
+   ctx->h[0] = 0x67452301;
+   ctx->h[1] = 0xEFCDAB89;
+   ctx->h[2] = 0x98BADCFE;
+   ctx->h[3] = 0x10325476;
+   ctx->h[4] = 0xC3D2E1F0;
+   ctx->used = 0;
+   ctx->length = 0;
+}
+
+static void sha1Block ( SHA1Context* ctx )
+{
+   uint32_t w [ 80 ];
+   uint32_t a, b, c, d, e, f, k, t;
+   int32_t  i;
+
+   for ( i = 0; i < 16; i++ )
+   {
+      w[i] = (ctx->block[i*4]<<24)|(ctx->block[i*4+1]<<16)|(ctx->block[i*4+2]<<8)|ctx->block[i*4+3];
+   }
+   for ( ; i < 80; i++ )
+   {
+      w[i] = SHA1ROL(w[i-3]^w[i-8]^w[i-14]^w[i-16],1);
+   }
+
+   a = ctx->h[0];
+   b = ctx->h[1];
+   c = ctx->h[2];
+   d = ctx->h[3];
+   e = ctx->h[4];
+
+   for ( i = 0; i < 80; i++ )
+   {
+      if ( i < 20 )
+      {
+         f = (b&c)|((~b)&d);
+         k = 0x5A827999;
+      }
+      else if ( i < 40 )
+      {
+         f = b^c^d;
+         k = 0x6ED9EBA1;
+      }
+      else if ( i < 60 )
+      {
+         f = (b&c)|(b&d)|(c&d);
+         k = 0x8F1BBCDC;
+      }
+      else
+      {
+         f = b^c^d;
+         k = 0xCA62C1D6;
+      }
+      t = SHA1ROL(a,5)+f+e+k+w[i];
+      e = d;
+      d = c;
+      c = SHA1ROL(b,30);
+      b = a;
+      a = t;
+   }
+
+   ctx->h[0] += a;
+   ctx->h[1] += b;
+   ctx->h[2] += c;
+   ctx->h[3] += d;
+   ctx->h[4] += e;
+}
+
+static inline void sha1Byte ( SHA1Context* ctx, uint8_t data )
+{
+   ctx->block[ctx->used++] = data;
+   ctx->length++;
+   if ( ctx->used == 64 )
+   {
+      sha1Block(ctx);
+      ctx->used = 0;
+   }
+}
+
+static void sha1Final ( SHA1Context* ctx, uint8_t* digest )
+{
+   uint32_t bits = ctx->length<<3;
+   uint32_t bitsHigh = ctx->length>>29;
+   int32_t  i;
+
+   ctx->block[ctx->used++] = 0x80;
+   if ( ctx->used > 56 )
+   {
+      while ( ctx->used < 64 )
+      {
+         ctx->block[ctx->used++] = 0;
+      }
+      sha1Block(ctx);
+      ctx->used = 0;
+   }
+   while ( ctx->used < 56 )
+   {
+      ctx->block[ctx->used++] = 0;
+   }
+   for ( i = 0; i < 4; i++ )
+   {
+      ctx->block[56+i] = (bitsHigh>>(24-(i*8)))&0xFF;
+      ctx->block[60+i] = (bits>>(24-(i*8)))&0xFF;
+   }
+   sha1Block(ctx);
+
+   for ( i = 0; i < 20; i++ )
+   {
+      *(digest+i) = (ctx->h[i>>2]>>(24-((i&3)*8)))&0xFF;
+   }
+}
+
+// FNV-1a, for the state checksums.
+#define FNVBYTE(h,b) ( h = ((h)^(uint8_t)(b))*16777619 )
+
+CMovie::CMovie()
+{
+}
+
+CMovie::~CMovie()
+{
+}
+
+void CMovie::CLEAR ( void )
+{
+   delete [] m_sram;
+   m_sram = NULL;
+   m_sramSize = 0;
+   m_numFrames = 0;
+   m_numChecksums = 0;
+   m_frame = 0;
+   m_desyncFrame = MOVIE_IN_SYNC;
+}
+
+void CMovie::APPEND ( uint8_t** buffer, uint32_t* capacity, uint32_t size, const uint8_t* data, uint32_t length )
+{
+   uint8_t* grown;
+
+   if ( size+length > (*capacity) )
+   {
+      (*capacity) = ((*capacity)<MEM_4KB)?MEM_4KB:(*capacity);
+      while ( size+length > (*capacity) )
+      {
+         (*capacity) <<= 1;
+      }
+      grown = new uint8_t [ (*capacity) ];
+      if ( size )
+      {
+         memcpy(grown,(*buffer),size);
+      }
+      delete [] (*buffer);
+      (*buffer) = grown;
+   }
+   memcpy((*buffer)+size,data,length);
+}
+
+void CMovie::ROMSHA1 ( uint8_t* sha1 )
+{
+   SHA1Context ctx;
+   uint32_t    addr;
+   uint32_t    size;
+
+   sha1Init(&ctx);
+   size = CROM::NUMPRGROMBANKS()*MEM_8KB;
+   for ( addr = 0; addr < size; addr++ )
+   {
+      sha1Byte(&ctx,CROM::PRGROMPHYS(addr));
+   }
+   size = CROM::NUMCHRROMBANKS()*MEM_8KB;
+   for ( addr = 0; addr < size; addr++ )
+   {
+      sha1Byte(&ctx,CROM::CHRROMPHYS(addr));
+   }
+   sha1Final(&ctx,sha1);
+}
+
+uint32_t CMovie::CHECKSUM ( void )
+{
+   uint32_t hash = 2166136261U;
+   uint8_t* pRAM = C6502::_MEMPTR();
+   uint32_t idx;
+
+   FNVBYTE(hash,C6502::__PC());
+   FNVBYTE(hash,C6502::__PC()>>8);
+   FNVBYTE(hash,C6502::_SP());
+   FNVBYTE(hash,C6502::_A());
+   FNVBYTE(hash,C6502::_X());
+   FNVBYTE(hash,C6502::_Y());
+   FNVBYTE(hash,C6502::_F());
+   for ( idx = 0; idx < 32; idx += 8 )
+   {
+      FNVBYTE(hash,C6502::_CYCLES()>>idx);
+   }
+   for ( idx = 0; idx < MEM_2KB; idx++ )
+   {
+      FNVBYTE(hash,*(pRAM+idx));
+   }
+   for ( idx = 0; idx < NUM_PPU_REGS; idx++ )
+   {
+      FNVBYTE(hash,CPPU::_PPU(idx));
+   }
+   for ( idx = 0; idx < MEM_4KB; idx++ )
+   {
+      FNVBYTE(hash,CPPU::_NAMETABLE(0x2000+idx));
+   }
+   for ( idx = 0; idx < MEM_32B; idx++ )
+   {
+      FNVBYTE(hash,CPPU::_PALETTE(idx));
+   }
+   for ( idx = 0; idx < MEM_256B; idx++ )
+   {
+      FNVBYTE(hash,CPPU::_OAM(idx&3,idx>>2));
+   }
+   if ( !CROM::IsWriteProtected() )
+   {
+      for ( idx = 0; idx < MEM_8KB; idx++ )
+      {
+         FNVBYTE(hash,CROM::CHRMEM(idx));
+      }
+   }
+   for ( idx = 0; idx < NUM_SRAM_BANKS*MEM_8KB; idx++ )
+   {
+      FNVBYTE(hash,CROM::SRAMPHYS(idx));
+   }
+   for ( idx = 0; idx < NUM_APU_REGS; idx++ )
+   {
+      FNVBYTE(hash,CAPU::_APU(0x4000+idx));
+   }
+
+   return hash;
+}
+
+void CMovie::POWERON ( void )
+{
+   uint32_t addr;
+   int32_t  port;
+
+   CNES::VIDEOMODE(m_systemMode);
+   for ( port = 0; port < NUM_CONTROLLERS; port++ )
+   {
+      CNES::CONTROLLER(port,m_controller[port]);
+   }
+
+   CNES::RESET(CROM::MAPPER(),false);
+
+   // A reset leaves SRAM and CHR-RAM alone.
+   for ( addr = 0; addr < NUM_SRAM_BANKS*MEM_8KB; addr++ )
+   {
+      CROM::SRAMPHYS(addr,(addr<m_sramSize)?(*(m_sram+addr)):0,false);
+   }
+   if ( !CROM::IsWriteProtected() )
+   {
+      for ( addr = 0; addr < MEM_8KB; addr++ )
+      {
+         CROM::CHRMEM(addr,0);
+      }
+   }
+
+   m_frame = 0;
+   m_desyncFrame = MOVIE_IN_SYNC;
+}
+
+void CMovie::RECORD ( uint32_t checksumInterval )
+{
+   uint32_t addr;
+   int32_t  port;
+
+   CLEAR();
+
+   ROMSHA1(m_romSHA1);
+   m_systemMode = CNES::VIDEOMODE();
+   for ( port = 0; port < NUM_CONTROLLERS; port++ )
+   {
+      m_controller[port] = CNES::CONTROLLER(port);
+   }
+   m_checksumInterval = checksumInterval?checksumInterval:MOVIE_DEFAULT_INTERVAL;
+
+   // Keep the battery-backed RAM the game powers on with, without the
+   // unused space at the end.
+   for ( m_sramSize = NUM_SRAM_BANKS*MEM_8KB; m_sramSize; m_sramSize-- )
+   {
+      if ( CROM::SRAMPHYS(m_sramSize-1) )
+      {
+         break;
+      }
+   }
+   if ( m_sramSize )
+   {
+      m_sram = new uint8_t [ m_sramSize ];
+      for ( addr = 0; addr < m_sramSize; addr++ )
+      {
+         *(m_sram+addr) = CROM::SRAMPHYS(addr);
+      }
+   }
+
+   POWERON();
+
+   m_playing = false;
+   m_recording = true;
+}
+
+bool CMovie::PLAY ( void )
+{
+   uint8_t sha1 [ 20 ];
+   int32_t port;
+
+   STOP();
+
+   ROMSHA1(sha1);
+   if ( memcmp(sha1,m_romSHA1,20) )
+   {
+      return false;
+   }
+
+   // The movie's system mode and controllers replace the user's for the
+   // length of the playback only.
+   m_savedSystemMode = CNES::VIDEOMODE();
+   for ( port = 0; port < NUM_CONTROLLERS; port++ )
+   {
+      m_savedController[port] = CNES::CONTROLLER(port);
+   }
+   m_settingsSaved = true;
+
+   POWERON();
+
+   m_playing = true;
+
+   return true;
+}
+
+void CMovie::STOP ( void )
+{
+   uint8_t data [ 4 ];
+   int32_t port;
+
+   // Keep the checksum of the state the last frame left the machine in, so
+   // playback can check right up to the end of the movie.
+   if ( m_recording &&
+        m_frame &&
+        (!(m_frame%m_checksumInterval)) &&
+        ((m_frame/m_checksumInterval) == m_numChecksums+1) )
+   {
+      moviePut32(data,CHECKSUM());
+      APPEND(&m_checksums,&m_checksumsCapacity,m_numChecksums*4,data,4);
+      m_numChecksums++;
+   }
+
+   if ( m_settingsSaved )
+   {
+      CNES::VIDEOMODE(m_savedSystemMode);
+      for ( port = 0; port < NUM_CONTROLLERS; port++ )
+      {
+         CNES::CONTROLLER(port,m_savedController[port]);
+      }
+      m_settingsSaved = false;
+   }
+
+   m_recording = false;
+   m_playing = false;
+}
+
+void CMovie::INPUT ( uint32_t* joy )
+{
+   uint8_t  data [ 4 ];
+   uint32_t checksum;
+   uint32_t idx;
+   int32_t  port;
+
+   if ( !(m_recording || m_playing) )
+   {
+      return;
+   }
+
+   // Check the state the frames so far have left the machine in.
+   if ( m_frame && (!(m_frame%m_checksumInterval)) )
+   {
+      idx = (m_frame/m_checksumInterval)-1;
+      checksum = CHECKSUM();
+
+      if ( m_recording )
+      {
+         if ( idx == m_numChecksums )
+         {
+            moviePut32(data,checksum);
+            APPEND(&m_checksums,&m_checksumsCapacity,m_numChecksums*4,data,4);
+            m_numChecksums++;
+         }
+      }
+      else if ( (idx < m_numChecksums) &&
+                (m_desyncFrame == MOVIE_IN_SYNC) &&
+                (checksum != movieGet32(m_checksums+(idx*4))) )
+      {
+         m_desyncFrame = m_frame;
+      }
+   }
+
+   if ( m_recording )
+   {
+      for ( port = 0; port < NUM_CONTROLLERS; port++ )
+      {
+         data[port] = (*(joy+port))&0xFF;
+      }
+      APPEND(&m_input,&m_inputCapacity,m_numFrames*NUM_CONTROLLERS,data,NUM_CONTROLLERS);
+      m_numFrames++;
+   }
+   else
+   {
+      if ( m_frame >= m_numFrames )
+      {
+         m_playing = false;
+         return;
+      }
+      for ( port = 0; port < NUM_CONTROLLERS; port++ )
+      {
+         *(joy+port) = *(m_input+(m_frame*NUM_CONTROLLERS)+port);
+      }
+   }
+
+   m_frame++;
+}
+
+bool CMovie::SAVE ( const char* fileName )
+{
+   FILE*   movie;
+   uint8_t header [ MOVIE_HEADER_SIZE ];
+   bool    ok;
+
+   movie = fopen(fileName,"wb");
+   if ( !movie )
+   {
+      return false;
+   }
+
+   memset(header,0,MOVIE_HEADER_SIZE);
+   memcpy(header,movieMagic,4);
+   moviePut32(header+4,MOVIE_VERSION);
+   memcpy(header+8,m_romSHA1,20);
+   header[28] = m_systemMode;
+   header[29] = m_controller[CONTROLLER1];
+   header[30] = m_controller[CONTROLLER2];
+   moviePut32(header+32,m_checksumInterval);
+   moviePut32(header+36,m_numFrames);
+   moviePut32(header+40,m_numChecksums);
+   moviePut32(header+44,m_sramSize);
+
+   ok = (fwrite(header,1,MOVIE_HEADER_SIZE,movie) == MOVIE_HEADER_SIZE);
+   ok = ok && (fwrite(m_sram,1,m_sramSize,movie) == m_sramSize);
+   ok = ok && (fwrite(m_input,NUM_CONTROLLERS,m_numFrames,movie) == m_numFrames);
+   ok = ok && (fwrite(m_checksums,4,m_numChecksums,movie) == m_numChecksums);
+
+   fclose(movie);
+
+   return ok;
+}
+
+bool CMovie::LOAD ( const char* fileName )
+{
+   FILE*    movie;
+   uint8_t  header [ MOVIE_HEADER_SIZE ];
+   uint32_t numFrames;
+   uint32_t numChecksums;
+   uint32_t sramSize;
+   uint32_t interval;
+   uint64_t fileSize;
+   uint8_t* data;
+   bool     ok = false;
+
+   STOP();
+
+   movie = fopen(fileName,"rb");
+   if ( !movie )
+   {
+      return false;
+   }
+
+   fseek(movie,0,SEEK_END);
+   fileSize = ftell(movie);
+   fseek(movie,0,SEEK_SET);
+
+   if ( (fread(header,1,MOVIE_HEADER_SIZE,movie) == MOVIE_HEADER_SIZE) &&
+        (!memcmp(header,movieMagic,4)) &&
+        (movieGet32(header+4) == MOVIE_VERSION) )
+   {
+      interval = movieGet32(header+32);
+      numFrames = movieGet32(header+36);
+      numChecksums = movieGet32(header+40);
+      sramSize = movieGet32(header+44);
+
+      // The sizes in the header must account for the file exactly.  They
+      // are added up in 64 bits so a corrupt header can't wrap them around
+      // into something that passes.
+      if ( interval &&
+           (sramSize <= NUM_SRAM_BANKS*MEM_8KB) &&
+           (numChecksums <= (numFrames/interval)+1) &&
+           (fileSize <= 0x7FFFFFFF) &&
+           (fileSize == (uint64_t)MOVIE_HEADER_SIZE+
+                        (uint64_t)sramSize+
+                        ((uint64_t)numFrames*NUM_CONTROLLERS)+
+                        ((uint64_t)numChecksums*4)) )
+      {
+         CLEAR();
+
+         memcpy(m_romSHA1,header+8,20);
+         m_systemMode = header[28];
+         m_controller[CONTROLLER1] = header[29];
+         m_controller[CONTROLLER2] = header[30];
+         m_checksumInterval = interval;
+
+         ok = true;
+         if ( sramSize )
+         {
+            m_sram = new uint8_t [ sramSize ];
+            ok = (fread(m_sram,1,sramSize,movie) == sramSize);
+            m_sramSize = sramSize;
+         }
+         if ( ok && numFrames )
+         {
+            data = new uint8_t [ numFrames*NUM_CONTROLLERS ];
+            ok = (fread(data,NUM_CONTROLLERS,numFrames,movie) == numFrames);
+            APPEND(&m_input,&m_inputCapacity,0,data,numFrames*NUM_CONTROLLERS);
+            delete [] data;
+            m_numFrames = numFrames;
+         }
+         if ( ok && numChecksums )
+         {
+            data = new uint8_t [ numChecksums*4 ];
+            ok = (fread(data,4,numChecksums,movie) == numChecksums);
+            APPEND(&m_checksums,&m_checksumsCapacity,0,data,numChecksums*4);
+            delete [] data;
+            m_numChecksums = numChecksums;
+         }
+         if ( !ok )
+         {
+            CLEAR();
+         }
+      }
+   }
+
+   fclose(movie);
+
+   return ok;
+}
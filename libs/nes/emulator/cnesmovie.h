@@ -0,0 +1,114 @@
+#if !defined ( NESMOVIE_H )
+#define NESMOVIE_H
+
+#include "nes_emulator_core.h"
+
+#define MOVIE_VERSION            1
+#define MOVIE_HEADER_SIZE        48
+#define MOVIE_DEFAULT_INTERVAL   1
+
+// The CMovie class records and plays back input movies.
+//
+// A movie always starts from power-on, so what happens in it depends only
+// on the ROM, the power-on state recorded in its header and the input it
+// holds for each frame.  The header identifies the ROM by the SHA-1 of its
+// PRG-ROM followed by its CHR-ROM, and holds the system mode, the type of
+// controller in each port and the battery-backed SRAM contents at
+// power-on.  The input is one byte per controller port per frame.
+//
+// Every checksum interval frames a checksum of the machine state [CPU and
+// PPU registers, CPU RAM, nametables, palette, OAM, CHR-RAM, SRAM and the
+// APU registers] is stored while recording.  Playback compares the state
+// against those checksums and remembers the first frame that didn't match,
+// which is the frame the playback desynced on when the interval is one.
+//
+// The file is little-endian:
+//
+//    0  "NMV",$1A
+//    4  version
+//    8  ROM SHA-1 [20 bytes]
+//   28  system mode, controller 1 type, controller 2 type, unused
+//   32  checksum interval
+//   36  number of frames
+//   40  number of checksums
+//   44  size of the SRAM image that follows the header
+//   48  SRAM image, then two bytes of input per frame, then the checksums
+class CMovie
+{
+public:
+   CMovie();
+   virtual ~CMovie();
+
+   // Recording and playback both power the system on first; the ROM must
+   // already be loaded.  PLAY returns false if the loaded ROM isn't the one
+   // the movie was recorded with.  Playback switches to the movie's system
+   // mode and controllers; STOP puts back the ones that were set before.
+   static void RECORD ( uint32_t checksumInterval );
+   static bool PLAY ( void );
+   static void STOP ( void );
+   static inline bool RECORDING ( void )
+   {
+      return m_recording;
+   }
+   static inline bool PLAYING ( void )
+   {
+      return m_playing;
+   }
+
+   static bool LOAD ( const char* fileName );
+   static bool SAVE ( const char* fileName );
+
+   static inline uint32_t FRAME ( void )
+   {
+      return m_frame;
+   }
+   static inline uint32_t FRAMES ( void )
+   {
+      return m_numFrames;
+   }
+   static inline int32_t DESYNCFRAME ( void )
+   {
+      return m_desyncFrame;
+   }
+
+   // Called at the start of each frame with the live controller input,
+   // which is recorded, or replaced by the movie's during playback.
+   static void INPUT ( uint32_t* joy );
+
+   static uint32_t CHECKSUM ( void );
+   static void ROMSHA1 ( uint8_t* sha1 );
+
+protected:
+   static void POWERON ( void );
+   static void APPEND ( uint8_t** buffer, uint32_t* capacity, uint32_t size, const uint8_t* data, uint32_t length );
+   static void CLEAR ( void );
+
+   static bool      m_recording;
+   static bool      m_playing;
+   static uint32_t  m_frame;
+   static int32_t   m_desyncFrame;
+
+   // Header.
+   static uint8_t   m_romSHA1 [ 20 ];
+   static uint8_t   m_systemMode;
+   static uint8_t   m_controller [ NUM_CONTROLLERS ];
+   static uint32_t  m_checksumInterval;
+
+   // The system mode and controllers in use before playback started.
+   static bool      m_settingsSaved;
+   static uint8_t   m_savedSystemMode;
+   static uint8_t   m_savedController [ NUM_CONTROLLERS ];
+
+   // Power-on SRAM, input and checksums.  The buffers grow as a recording
+   // gets longer.
+   static uint8_t*  m_sram;
+   static uint32_t  m_sramSize;
+   static uint8_t*  m_input;
+   static uint32_t  m_inputCapacity;
+   static uint32_t  m_numFrames;
+   static uint8_t*  m_checksums;
+   static uint32_t  m_checksumsCapacity;
+   static uint32_t  m_numChecksums;
+};
+
+#endif
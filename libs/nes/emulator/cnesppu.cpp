@@ -20,6 +20,7 @@
 #include "cnes6502.h"
 #include "cnesrom.h"
 #include "cnesapu.h"
+#include "cnesscheduler.h"
 
 #include "nes_emulator_core.h"
 
@@ -711,8 +712,18 @@ CCodeDataLogger* CPPU::m_logger = NULL;
 
 uint8_t  CPPU::m_last2005x = 0;
 uint8_t  CPPU::m_last2005y = 0;
-uint16_t** CPPU::m_2005x = NULL;
-uint16_t** CPPU::m_2005y = NULL;
+PpuRegisterWrite CPPU::m_registerWrites [] = { };
+uint32_t CPPU::m_numRegisterWrites = 0;
+uint16_t CPPU::m_frameStartPpuAddr = 0x0000;
+uint16_t CPPU::m_frameStartPpuAddrLatch = 0x0000;
+uint8_t  CPPU::m_frameStartScrollX = 0x00;
+uint8_t  CPPU::m_frameStartMask = 0x00;
+uint32_t CPPU::m_writeStamp = 0;
+uint32_t CPPU::m_nameTableWriteStamp [] = { 0, };
+uint32_t CPPU::m_nameTableMapWriteStamp = 0;
+uint32_t CPPU::m_paletteWriteStamp = 0;
+uint32_t CPPU::m_oamWriteStamp [] = { 0, };
+uint32_t CPPU::m_chrWriteStamp [] = { 0, };
 uint8_t  CPPU::m_lastSprite0HitX = 0;
 uint8_t  CPPU::m_lastSprite0HitY = 0;
 uint8_t  CPPU::m_x = 0xFF;
@@ -726,17 +737,6 @@ CPPU::CPPU()
 
    m_logger = new CCodeDataLogger ( MEM_16KB, MASK_16KB );
 
-   m_2005x = new uint16_t*[256];
-   for ( idx = 0; idx < 256; idx++ )
-   {
-      m_2005x[idx] = new uint16_t[240];
-   }
-   m_2005y = new uint16_t*[256];
-   for ( idx = 0; idx < 256; idx++ )
-   {
-      m_2005y[idx] = new uint16_t[240];
-   }
-
    m_PPUmemory = new uint8_t[MEM_4KB];
 
    // Set up default mapping.
@@ -748,37 +748,15 @@ CPPU::CPPU()
 
 CPPU::~CPPU()
 {
-   int idx;
-
    delete m_logger;
-   for ( idx = 0; idx < 256; idx++ )
-   {
-      delete [] m_2005x[idx];
-   }
-   delete [] m_2005x;
-   for ( idx = 0; idx < 256; idx++ )
-   {
-      delete [] m_2005y[idx];
-   }
-   delete [] m_2005y;
 
    delete [] m_PPUmemory;
 }
 
 void CPPU::EMULATE(uint32_t cycles)
 {
-   uint32_t idxx = 0xffffffff;
-   uint32_t idxy = 0xffffffff;
-
    for ( ; cycles > 0; cycles-- )
    {
-      // Get VBLANK raster position.
-      if ( m_cycles >= startVblank )
-      {
-         idxy = (m_cycles-startVblank)/PPU_CYCLES_PER_SCANLINE;
-         idxx = (m_cycles-startVblank)%PPU_CYCLES_PER_SCANLINE;
-      }
-
       // We're emulating one PPU cycle...
       m_curCycles += CPU_CYCLE_ADJUST;
 
@@ -851,46 +829,121 @@ void CPPU::EMULATE(uint32_t cycles)
       // Adjust current cycle count...
       m_curCycles %= cycleRatio;
 
-      // Turn off NMI choking if it shouldn't be...
-      if ( m_cycles > startVblank+1 )
-      {
-         NMICHOKED ( false );
-      }
-
-      // Turn off NMI re-enablement if it shouldn't be...
-      if ( m_cycles > vblankEndCycle )
-      {
-         NMIREENABLED ( false );
-      }
-
       if ( nesIsDebuggable() )
       {
          // Check for breakpoints...
          CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnPPUCycle );
       }
 
-      if ( (rPPU(PPUCTRL)&PPUCTRL_GENERATE_NMI) &&
-            (((!NMICHOKED()) && (idxy == 0) && (idxx == 1)) ||
-             ((NMIREENABLED()) && (idxy <= vblankScanlines-1) && (idxx < PPU_CYCLES_PER_SCANLINE-1))) )
-      {
-         C6502::ASSERTNMI ();
+      // Handle NMI assertion and OAM address clearing if this is
+      // one of the PPU cycles they can happen on...
+      CScheduler::DISPATCH ( SCHEDULER_DOMAIN_PPU );
+
+      // Internal cycle counter keeps track of stuff needing to happen
+      // at particular PPU frame cycles.  It is reset at the end of a frame.
+      m_cycles++;
+      CScheduler::CLOCK ( SCHEDULER_DOMAIN_PPU );
+   }
+}
+
+void CPPU::SCHEDULEFRAME ( void )
+{
+   // The OAM address is cleared at a fixed point in every frame.
+   // Note the appropriate point comes from blargg's discussion on nesdev forum:
+   // http://nesdev.parodius.com/bbs/viewtopic.php?t=1366&highlight=sprite+address+clear
+   CScheduler::SCHEDULEIN ( SCHEDULER_EVENT_PPU_OAMADDR, (startVblank+(19*PPU_CYCLES_PER_SCANLINE)+316)-m_cycles );
+
+   SCHEDULENMI ( m_cycles );
+}
 
-         // Check for PPU NMI breakpoint...
-         CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnPPUEvent, 0, PPU_EVENT_NMI );
+void CPPU::SCHEDULENMI ( uint32_t cycle )
+{
+   uint32_t next = 0xFFFFFFFF;
+   uint32_t reenabled;
+
+   // NMI is asserted at the start of VBLANK unless it was choked, and
+   // choking is forgotten on the cycle after that.
+   if ( cycle <= startVblank+1 )
+   {
+      next = startVblank+1;
+   }
+   else if ( cycle <= startVblank+2 )
+   {
+      next = startVblank+2;
+   }
+
+   // A re-enabled NMI is asserted on the next cycle that NMI is enabled,
+   // or is forgotten when VBLANK ends, whichever comes first.
+   if ( m_nmiReenabled )
+   {
+      if ( rPPU(PPUCTRL)&PPUCTRL_GENERATE_NMI )
+      {
+         reenabled = cycle;
+      }
+      else
+      {
+         reenabled = (cycle > vblankEndCycle)?cycle:vblankEndCycle+1;
       }
 
-      // Clear OAM at appropriate point...
-      // Note the appropriate point comes from blargg's discussion on nesdev forum:
-      // http://nesdev.parodius.com/bbs/viewtopic.php?t=1366&highlight=sprite+address+clear
-      if ( (rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) == (PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES)) &&
-           (idxy == 19) && (idxx == 316) )
+      if ( reenabled < next )
       {
-         m_oamAddr = 0x00;
+         next = reenabled;
       }
+   }
 
-      // Internal cycle counter keeps track of stuff needing to happen
-      // at particular PPU frame cycles.  It is reset at the end of a frame.
-      m_cycles++;
+   if ( next != 0xFFFFFFFF )
+   {
+      CScheduler::SCHEDULEIN ( SCHEDULER_EVENT_PPU_NMI, next-m_cycles );
+   }
+   else
+   {
+      CScheduler::CANCEL ( SCHEDULER_EVENT_PPU_NMI );
+   }
+}
+
+void CPPU::NMIEVENT ( void )
+{
+   uint32_t idxx = 0xffffffff;
+   uint32_t idxy = 0xffffffff;
+
+   // Get VBLANK raster position.
+   if ( m_cycles >= startVblank )
+   {
+      idxy = (m_cycles-startVblank)/PPU_CYCLES_PER_SCANLINE;
+      idxx = (m_cycles-startVblank)%PPU_CYCLES_PER_SCANLINE;
+   }
+
+   // Turn off NMI choking if it shouldn't be...
+   if ( m_cycles > startVblank+1 )
+   {
+      NMICHOKED ( false );
+   }
+
+   // Turn off NMI re-enablement if it shouldn't be...
+   if ( m_cycles > vblankEndCycle )
+   {
+      NMIREENABLED ( false );
+   }
+
+   if ( (rPPU(PPUCTRL)&PPUCTRL_GENERATE_NMI) &&
+         (((!NMICHOKED()) && (idxy == 0) && (idxx == 1)) ||
+          ((NMIREENABLED()) && (idxy <= vblankScanlines-1) && (idxx < PPU_CYCLES_PER_SCANLINE-1))) )
+   {
+      C6502::ASSERTNMI ();
+
+      // Check for PPU NMI breakpoint...
+      CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnPPUEvent, 0, PPU_EVENT_NMI );
+   }
+
+   SCHEDULENMI ( m_cycles+1 );
+}
+
+void CPPU::OAMADDREVENT ( void )
+{
+   // Clear OAM at appropriate point...
+   if ( ((rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES)) == (PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES)) )
+   {
+      m_oamAddr = 0x00;
    }
 }
 
@@ -951,6 +1004,8 @@ uint32_t CPPU::LOAD ( uint32_t addr, int8_t source, int8_t type, bool trace )
 
 void CPPU::STORE ( uint32_t addr, uint8_t data, int8_t source, int8_t type, bool trace )
 {
+   uint8_t* pPage;
+
    addr &= 0x3FFF;
 
    if ( addr < 0x2000 )
@@ -964,6 +1019,7 @@ void CPPU::STORE ( uint32_t addr, uint8_t data, int8_t source, int8_t type, bool
       if ( CROM::IsWriteProtected() == false )
       {
          CROM::CHRMEM ( addr, data );
+         CHRMEMWRITTEN ( addr );
       }
 
       return;
@@ -988,6 +1044,7 @@ void CPPU::STORE ( uint32_t addr, uint8_t data, int8_t source, int8_t type, bool
          {
             *(m_PALETTEmemory+(addr&0x1F)) = data;
          }
+         m_paletteWriteStamp = ++m_writeStamp;
 
          return;
       }
@@ -1008,7 +1065,35 @@ void CPPU::STORE ( uint32_t addr, uint8_t data, int8_t source, int8_t type, bool
       }
    }
 
-   *((*(m_pPPUmemory+((addr&0x1FFF)>>10)))+(addr&0x3FF)) = data;
+   pPage = *(m_pPPUmemory+((addr&0x1FFF)>>10));
+   *(pPage+(addr&0x3FF)) = data;
+
+   if ( (pPage >= m_PPUmemory) && (pPage < m_PPUmemory+MEM_4KB) )
+   {
+      *(m_nameTableWriteStamp+(pPage-m_PPUmemory)+(addr&0x3FF)) = ++m_writeStamp;
+   }
+}
+
+void CPPU::CHRMEMWRITTEN ( void )
+{
+   int32_t tile;
+
+   m_writeStamp++;
+   for ( tile = 0; tile < (MEM_8KB>>4); tile++ )
+   {
+      *(m_chrWriteStamp+tile) = m_writeStamp;
+   }
+}
+
+void CPPU::OAMWRITTEN ( void )
+{
+   int32_t sprite;
+
+   m_writeStamp++;
+   for ( sprite = 0; sprite < NUM_SPRITES; sprite++ )
+   {
+      *(m_oamWriteStamp+sprite) = m_writeStamp;
+   }
 }
 
 uint32_t CPPU::RENDER ( uint32_t addr, int8_t target )
@@ -1105,6 +1190,10 @@ void CPPU::RESET ( bool soft )
    m_nmiChoked = false;
    m_nmiReenabled = false;
 
+   CScheduler::HANDLER ( SCHEDULER_EVENT_PPU_NMI, NMIEVENT );
+   CScheduler::HANDLER ( SCHEDULER_EVENT_PPU_OAMADDR, OAMADDREVENT );
+   SCHEDULEFRAME ();
+
    m_ppuAddr = 0x0000;
    m_ppuAddrLatch = 0x0000;
    m_ppuAddrIncrement = 1;
@@ -1120,6 +1209,12 @@ void CPPU::RESET ( bool soft )
    m_ppuIOLatchDecayFrames [ 6 ] = 0;
    m_ppuIOLatchDecayFrames [ 7 ] = 0;
 
+   m_numRegisterWrites = 0;
+   m_frameStartPpuAddr = 0x0000;
+   m_frameStartPpuAddrLatch = 0x0000;
+   m_frameStartScrollX = 0x00;
+   m_frameStartMask = 0x00;
+
    m_spriteTemporaryMemory.count = 0;
    m_spriteTemporaryMemory.yByte = SPRITEY;
    m_spriteTemporaryMemory.rolling = 0;
@@ -1256,6 +1351,7 @@ void CPPU::PPU ( uint32_t addr, uint8_t data )
    uint16_t oldPpuAddr;
    uint8_t  old2000;
    int32_t  bit;
+   PpuRegisterWrite* pWrite;
 
    // Set I/O latch for bus hold-up emulation...
    m_ppuIOLatch = data;
@@ -1294,6 +1390,9 @@ void CPPU::PPU ( uint32_t addr, uint8_t data )
 
    if ( fixAddr == PPUCTRL_REG )
    {
+      // Changing NMI enablement may change when NMI is next asserted...
+      SCHEDULENMI ( m_cycles );
+
       m_ppuAddrLatch &= 0x73FF;
       m_ppuAddrLatch |= ((((uint16_t)data&PPUCTRL_BASE_NAM_TBL_ADDR_MSK))<<10);
       m_ppuAddrIncrement = (((!!(data&PPUCTRL_VRAM_ADDR_INC))*31)+1);
@@ -1305,6 +1404,7 @@ void CPPU::PPU ( uint32_t addr, uint8_t data )
    else if ( fixAddr == OAMDATA_REG )
    {
       *(m_PPUoam+m_oamAddr) = data;
+      *(m_oamWriteStamp+(m_oamAddr>>2)) = ++m_writeStamp;
 
       if ( nesIsDebuggable() )
       {
@@ -1388,11 +1488,119 @@ void CPPU::PPU ( uint32_t addr, uint8_t data )
 
    if ( nesIsDebuggable() )
    {
+      // Add writes that affect rendering to the register timeline...
+      if ( ((fixAddr == PPUCTRL_REG) || (fixAddr == PPUMASK_REG) ||
+            (fixAddr == PPUSCROLL_REG) || (fixAddr == PPUADDR_REG)) &&
+           (m_numRegisterWrites < PPU_REGISTER_TIMELINE_SIZE) )
+      {
+         pWrite = m_registerWrites+m_numRegisterWrites;
+         pWrite->scanline = m_cycles/PPU_CYCLES_PER_SCANLINE;
+         pWrite->cycle = m_cycles%PPU_CYCLES_PER_SCANLINE;
+         pWrite->addr = PPUCTRL+fixAddr;
+         pWrite->data = data;
+         pWrite->fineX = m_ppuScrollX;
+         pWrite->pc = C6502::__PCSYNC();
+         pWrite->ppuAddr = m_ppuAddr;
+         pWrite->ppuAddrLatch = m_ppuAddrLatch;
+         m_numRegisterWrites++;
+      }
+
       // Check for breakpoint...
       CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnPPUState, fixAddr );
    }
 }
 
+void CPPU::SCANLINESCROLL ( uint16_t* x, uint16_t* y )
+{
+   // The PPU moves its address on to the next row at cycle 251 of each
+   // visible scanline and copies the horizontal position from the latch at
+   // cycle 257, the same points EMULATE does, so writes are replayed up to
+   // each of those in turn.
+   static const uint16_t replayTo [ 3 ] = { 251, 257, PPU_CYCLES_PER_SCANLINE };
+   const PpuRegisterWrite* pWrite = m_registerWrites;
+   const PpuRegisterWrite* pEnd = m_registerWrites+m_numRegisterWrites;
+   uint16_t ppuAddr = m_frameStartPpuAddr;
+   uint16_t ppuAddrLatch = m_frameStartPpuAddrLatch;
+   uint16_t horizontal = m_frameStartPpuAddrLatch&0x41F;
+   uint8_t  scrollX = m_frameStartScrollX;
+   uint8_t  mask = m_frameStartMask;
+   int32_t  scanline;
+   int32_t  phase;
+   int32_t  row;
+
+   for ( scanline = 0; scanline < SCANLINES_VISIBLE; scanline++ )
+   {
+      // A scanline is drawn from the horizontal position last copied from the
+      // latch, and the row the PPU address is on as the scanline starts.  The
+      // PPU address itself steps across the scanline as tiles are fetched, so
+      // the horizontal position is kept apart from it.
+      *(x+scanline) = ((horizontal&0x400)>>2)|((horizontal&0x1F)<<3)|scrollX;
+      row = (((ppuAddr&0x800)>>11)*240)+(((ppuAddr&0x3E0)>>5)<<3)+((ppuAddr&0x7000)>>12);
+      *(y+scanline) = (row+480-scanline)%480;
+
+      for ( phase = 0; phase < 3; phase++ )
+      {
+         while ( (pWrite < pEnd) &&
+                 ((pWrite->scanline < scanline) ||
+                  ((pWrite->scanline == scanline) && (pWrite->cycle < replayTo[phase]))) )
+         {
+            ppuAddrLatch = pWrite->ppuAddrLatch;
+            scrollX = pWrite->fineX;
+
+            if ( pWrite->addr == PPUMASK )
+            {
+               mask = pWrite->data;
+            }
+            // The second write to $2006 is the one that loads the PPU address
+            // from the latch.
+            else if ( (pWrite->addr == PPUADDR) &&
+                      (pWrite->ppuAddr == pWrite->ppuAddrLatch) )
+            {
+               ppuAddr = pWrite->ppuAddr;
+               horizontal = ppuAddr&0x41F;
+            }
+
+            pWrite++;
+         }
+
+         if ( mask&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) )
+         {
+            if ( phase == 0 )
+            {
+               if ( (ppuAddr&0x7000) == 0x7000 )
+               {
+                  ppuAddr &= 0x8FFF;
+
+                  if ( (ppuAddr&0x03E0) == 0x03A0 )
+                  {
+                     ppuAddr ^= 0x0800;
+                     ppuAddr &= 0xFC1F;
+                  }
+                  else if ( (ppuAddr&0x03E0) == 0x03E0 )
+                  {
+                     ppuAddr &= 0xFC1F;
+                  }
+                  else
+                  {
+                     ppuAddr += 0x0020;
+                  }
+               }
+               else
+               {
+                  ppuAddr += 0x1000;
+               }
+            }
+            else if ( phase == 1 )
+            {
+               ppuAddr &= 0xFBE0;
+               ppuAddr |= ppuAddrLatch&0x41F;
+               horizontal = ppuAddrLatch&0x41F;
+            }
+         }
+      }
+   }
+}
+
 void CPPU::MIRROR ( int32_t oneScreen, bool vert, bool extraVRAM )
 {
    m_oneScreen = oneScreen;
@@ -1585,10 +1793,6 @@ void CPPU::RENDERSCANLINE ( int32_t scanlines )
             {
                m_x = idxx;
 
-               // Update variables for PPU viewer
-               *(*(m_2005x+m_x)+m_y) = m_last2005x+((rPPU(PPUCTRL)&0x1)<<8);
-               *(*(m_2005y+m_x)+m_y) = m_last2005y+(((rPPU(PPUCTRL)&0x2)>>1)*240);
-
                // Check for PPU pixel-at breakpoint...
                CNES::CHECKBREAKPOINT(eBreakInPPU,eBreakOnPPUEvent,0,PPU_EVENT_PIXEL_XY);
             }
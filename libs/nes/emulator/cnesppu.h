@@ -223,6 +223,7 @@ public:
    static inline void OAM ( uint32_t oam, uint32_t sprite, uint8_t data )
    {
       *(m_PPUoam+(sprite*OAM_SIZE)+oam) = data;
+      *(m_oamWriteStamp+sprite) = ++m_writeStamp;
    }
 
    // Read a byte from the PPU's internal OAM memory.
@@ -235,6 +236,7 @@ public:
    static inline void _OAM ( uint32_t oam, uint32_t sprite, uint8_t data )
    {
       *(m_PPUoam+(sprite*OAM_SIZE)+oam) = data;
+      *(m_oamWriteStamp+sprite) = ++m_writeStamp;
    }
 
    // Return the current cycle index of the PPU core.
@@ -260,10 +262,19 @@ public:
    }
 
    // Every PPU frame starts at PPU cycle 0.
+   // Every PPU frame also starts a new register timeline.
    static inline void RESETCYCLECOUNTER ( void )
    {
       m_cycles = 0;
       m_frame++;
+
+      m_numRegisterWrites = 0;
+      m_frameStartPpuAddr = m_ppuAddr;
+      m_frameStartPpuAddrLatch = m_ppuAddrLatch;
+      m_frameStartScrollX = m_ppuScrollX;
+      m_frameStartMask = rPPU(PPUMASK);
+
+      SCHEDULEFRAME ();
    }
 
    // Accessor methods to set up or clear the state of the nametable memory
@@ -271,10 +282,12 @@ public:
    static void MEMSET ( uint32_t addr, uint8_t* data, uint32_t length )
    {
       memcpy(m_PPUmemory+addr,data,length);
+      m_nameTableMapWriteStamp = ++m_writeStamp;
    }
    static void MEMCLR ( void )
    {
       memset(m_PPUmemory,0,MEM_4KB);
+      m_nameTableMapWriteStamp = ++m_writeStamp;
    }
 
    // Accessor methods to set up or clear the state of the OAM memory
@@ -282,10 +295,12 @@ public:
    static void OAMSET ( uint32_t addr, uint8_t* data, uint32_t length )
    {
       memcpy(m_PPUoam+addr,data,length);
+      OAMWRITTEN ();
    }
    static void OAMCLR ( void )
    {
       memset(m_PPUoam,0,MEM_256B);
+      OAMWRITTEN ();
    }
 
    // Routines to configure or retrieve information about the current
@@ -442,19 +457,65 @@ public:
       (*sc4) = ((uint8_t*)m_pPPUmemory[3]-(uint8_t*)m_PPUmemory)+MEM_8KB;
    }
 
-   // Accessor functions for the database of scroll values indexed by pixel
-   // location.  At each PPU cycle that is rendering a visible pixel the scroll
-   // register values are stored so that a representation of the visible portions
-   // of the nametable may be overlaid upon the actual nametable in the nametable visual
-   // inspector.
-   static inline uint16_t _SCROLLX ( int32_t x, int32_t y )
+   // Write stamps for the debugger inspectors.  Each write to nametable,
+   // palette, OAM or CHR memory takes the next value of a running count and
+   // records it against the byte, sprite or tile it changed.  An inspector
+   // remembers the count it last drew at and redraws only what carries a
+   // later stamp, comparing by difference since the count wraps.  Remapping
+   // the nametables or reloading any of these memories wholesale stamps
+   // everything it covers.
+   static inline uint32_t _WRITESTAMP ( void )
+   {
+      return m_writeStamp;
+   }
+   static inline uint32_t _NAMETABLEWRITESTAMP ( uint16_t addr )
+   {
+      uint8_t* pPage = *(m_pPPUmemory+((addr&0x0FFF)>>10));
+      uint32_t stamp = m_writeStamp;
+
+      // Nametables mapped onto cartridge memory aren't tracked.
+      if ( (pPage >= m_PPUmemory) && (pPage < m_PPUmemory+MEM_4KB) )
+      {
+         stamp = *(m_nameTableWriteStamp+(pPage-m_PPUmemory)+(addr&0x3FF));
+      }
+      // Stamps wrap, so compare them by difference.
+      return ((int32_t)(stamp-m_nameTableMapWriteStamp)>0)?stamp:m_nameTableMapWriteStamp;
+   }
+   static inline uint32_t _PALETTEWRITESTAMP ( void )
    {
-      return *(*(m_2005x+x)+y);
+      return m_paletteWriteStamp;
    }
-   static inline uint16_t _SCROLLY ( int32_t x, int32_t y )
+   static inline uint32_t _OAMWRITESTAMP ( uint32_t sprite )
    {
-      return *(*(m_2005y+x)+y);
+      return *(m_oamWriteStamp+sprite);
    }
+   static inline uint32_t _CHRMEMWRITESTAMP ( uint32_t addr )
+   {
+      return *(m_chrWriteStamp+((addr&0x1FFF)>>4));
+   }
+   static inline void CHRMEMWRITTEN ( uint32_t addr )
+   {
+      *(m_chrWriteStamp+((addr&0x1FFF)>>4)) = ++m_writeStamp;
+   }
+   static void CHRMEMWRITTEN ( void );
+   static void OAMWRITTEN ( void );
+
+   // Accessor functions for the register timeline, the writes to $2000,
+   // $2001, $2005 and $2006 made so far this frame.  SCANLINESCROLL replays
+   // the timeline from the state the PPU's address registers were in at the
+   // start of the frame to find the scroll position each visible scanline was
+   // drawn from, so that a representation of the visible portions of the
+   // nametable may be overlaid upon the actual nametable in the nametable
+   // visual inspector.
+   static inline uint32_t _REGISTERWRITECOUNT ( void )
+   {
+      return m_numRegisterWrites;
+   }
+   static inline const PpuRegisterWrite& _REGISTERWRITE ( uint32_t idx )
+   {
+      return *(m_registerWrites+idx);
+   }
+   static void SCANLINESCROLL ( uint16_t* x, uint16_t* y );
    static inline void _SCROLL ( uint8_t* x, uint8_t* y )
    {
       (*x) = m_last2005x;
@@ -508,6 +569,7 @@ public:
       if ( bank >= 8 )
       {
          m_pPPUmemory[bank-8] = point;
+         m_nameTableMapWriteStamp = ++m_writeStamp;
       }
    }
 
@@ -584,10 +646,19 @@ protected:
    // X-scroll pickoff.
    static inline void PIXELPIPELINES ( int32_t pickoff, uint8_t* a, uint8_t* b1, uint8_t* b2 );
 
+   // Routines that schedule and handle the PPU events that used to be
+   // checked for on every PPU cycle: NMI assertion (and the choking and
+   // re-enablement that go with it) and the OAM address clear.
+   static void SCHEDULEFRAME ( void );
+   static void SCHEDULENMI ( uint32_t cycle );
+   static void NMIEVENT ( void );
+   static void OAMADDREVENT ( void );
+
    // Routine that initializes the PPU's palette memory on reset.
    static void PALETTESET ( uint8_t* data )
    {
       memcpy(m_PALETTEmemory,data,MEM_32B);
+      m_paletteWriteStamp = ++m_writeStamp;
    }
 
 protected:
@@ -738,14 +809,30 @@ protected:
    // by the dialog class and passed to the PPU.
    static int8_t*          m_pTV;
 
-   // These items are the database that keeps track of the status of the
-   // x and y scroll values for each rendered pixel.  This information is
+   // These items are the last values written to $2005, and the register
+   // timeline for the current frame along with the state of the PPU's
+   // address registers and mask at the start of it.  This information is
    // used by the nametable visualizer to highlight areas of the nametable
-   // memory internal to the PPU that are being rendered to the screen.
+   // memory internal to the PPU that are being rendered to the screen, and
+   // to list the writes that change the scroll position mid-frame.
    static uint8_t  m_last2005x;
    static uint8_t  m_last2005y;
-   static uint16_t** m_2005x;
-   static uint16_t** m_2005y;
+   static PpuRegisterWrite m_registerWrites [ PPU_REGISTER_TIMELINE_SIZE ];
+   static uint32_t m_numRegisterWrites;
+   static uint16_t m_frameStartPpuAddr;
+   static uint16_t m_frameStartPpuAddrLatch;
+   static uint8_t  m_frameStartScrollX;
+   static uint8_t  m_frameStartMask;
+
+   // Write stamps for the debugger inspectors, see _WRITESTAMP.  Nametable
+   // stamps are kept per byte of the PPU's own video RAM, CHR stamps per
+   // tile of the PPU's pattern address space.
+   static uint32_t m_writeStamp;
+   static uint32_t m_nameTableWriteStamp [ MEM_4KB ];
+   static uint32_t m_nameTableMapWriteStamp;
+   static uint32_t m_paletteWriteStamp;
+   static uint32_t m_oamWriteStamp [ NUM_SPRITES ];
+   static uint32_t m_chrWriteStamp [ MEM_8KB>>4 ];
 
    // These items are the position of the last sprite-0 hit event on the
    // last rendered PPU frame.  They are invalidated at the start of each
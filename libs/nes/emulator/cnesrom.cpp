@@ -220,13 +220,14 @@ CROM::CROM()
    m_CHRmemory = new uint8_t*[NUM_CHR_BANKS];
    for ( bank = 0; bank < NUM_CHR_BANKS; bank++ )
    {
-      m_CHRmemory[bank] = new uint8_t[MEM_1KB+1]; // Leave room for bank ID.
+      m_CHRmemory[bank] = new uint8_t[CHRBANK_SIZE]; // Leave room for bank ID and decoded tiles.
 
       // Store bank ID in bank data at the end.  This is used only
       // by code that needs to calculate absolute address stuff.
       // Since the banks are stored non-contiguously this is a cheap
       // way to get the bank ID without having to implement a structure.
       m_CHRmemory[bank][MEM_1KB] = bank;
+      memset ( CHRBANK_TILEVALID(m_CHRmemory[bank]), 0, MEM_64B );
    }
 
    // Assume identity-mapped SRAM...
@@ -312,8 +313,39 @@ void CROM::SetCHRBank ( int32_t bank, uint8_t* data )
    for ( ibank = 0; ibank < 8; ibank++ )
    {
       memcpy ( m_CHRmemory[(bank<<3)+ibank], data+(ibank*MEM_1KB), MEM_1KB );
+      memset ( CHRBANK_TILEVALID(m_CHRmemory[(bank<<3)+ibank]), 0, MEM_64B );
    }
    m_numChrBanks = bank + 1;
+
+   // Anything the inspectors drew from the old CHR is stale now...
+   CPPU::CHRMEMWRITTEN();
+}
+
+void CROM::CHRTILEDECODE ( uint8_t* pBank, uint32_t tile )
+{
+   uint8_t* pPattern = pBank+(tile<<4);
+   uint8_t* pTile = CHRBANK_TILES(pBank)+(tile<<6);
+   uint8_t patternData1;
+   uint8_t patternData2;
+   int32_t y;
+   int32_t x;
+
+   // Mark the tile valid before decoding it so a CHR write that lands while
+   // the debugger is decoding leaves it marked for decoding again.
+   *(CHRBANK_TILEVALID(pBank)+tile) = 1;
+
+   for ( y = 0; y < 8; y++ )
+   {
+      patternData1 = *(pPattern+y);
+      patternData2 = *(pPattern+y+8);
+      for ( x = 7; x >= 0; x-- )
+      {
+         *(pTile+x) = (patternData1&0x1)|((patternData2&0x1)<<1);
+         patternData1 >>= 1;
+         patternData2 >>= 1;
+      }
+      pTile += 8;
+   }
 }
 
 void CROM::DoneLoadingBanks ()
@@ -27,6 +27,11 @@
 #define CHRBANK_OFF(addr) ( addr&MASK_1KB )
 // Resolve an address to one of the 8KB CHR memory banks [the absolute physical address]
 #define CHRBANK_PHYS(addr) ( *((*(m_pCHRmemory+CHRBANK_VIRT(addr)))+MEM_1KB) )
+// Each 1KB CHR bank carries its 64 tiles decoded to one color index per pixel
+// after the bank data and bank ID, preceded by a valid flag for each tile.
+#define CHRBANK_TILEVALID(pBank) ( (pBank)+MEM_1KB+1 )
+#define CHRBANK_TILES(pBank) ( (pBank)+MEM_1KB+1+MEM_64B )
+#define CHRBANK_SIZE ( MEM_1KB+1+MEM_64B+MEM_4KB )
 
 #define SRAMBANK_VIRT(addr) ( ((addr-SRAM_START)&MASK_64KB)>>SHIFT_64KB_8KB )
 #define SRAMBANK_OFF(addr) ( addr&MASK_8KB )
@@ -87,14 +92,37 @@ public:
    {
       return *(*(m_PRGROMmemory+PRGBANK_ABSBANK(addr))+PRGBANK_OFF(addr));
    }
+   static inline uint32_t CHRROMPHYS ( uint32_t addr )
+   {
+      return *(*(m_CHRmemory+(addr>>SHIFT_8KB_1KB))+CHRBANK_OFF(addr));
+   }
    static inline void CHRMEM ( uint32_t addr, uint8_t data )
    {
-      *(*(m_pCHRmemory+CHRBANK_VIRT(addr))+CHRBANK_OFF(addr)) = data;
+      uint8_t* pBank = *(m_pCHRmemory+CHRBANK_VIRT(addr));
+      *(pBank+CHRBANK_OFF(addr)) = data;
+      *(CHRBANK_TILEVALID(pBank)+(CHRBANK_OFF(addr)>>4)) = 0;
    }
    static inline uint32_t CHRMEM ( uint32_t addr )
    {
       return *(*(m_pCHRmemory+CHRBANK_VIRT(addr))+CHRBANK_OFF(addr));
    }
+
+   // Decoded CHR tiles for the debugger inspectors.  Returns the 8x8 tile
+   // containing the address as 64 color indexes (0-3), row by row.  Tiles
+   // are cached with the physical bank they belong to, so a mapper switching
+   // CHR banks only changes which cached tiles are looked at; a write to CHR
+   // memory marks its tile to be decoded again the next time it's asked for.
+   static inline const uint8_t* CHRTILE ( uint32_t addr )
+   {
+      uint8_t* pBank = *(m_pCHRmemory+CHRBANK_VIRT(addr));
+      uint32_t tile = CHRBANK_OFF(addr)>>4;
+      if ( !(*(CHRBANK_TILEVALID(pBank)+tile)) )
+      {
+         CHRTILEDECODE ( pBank, tile );
+      }
+      return CHRBANK_TILES(pBank)+(tile<<6);
+   }
+   static void CHRTILEDECODE ( uint8_t* pBank, uint32_t tile );
    static inline uint32_t SRAMABSADDR ( uint32_t addr )
    {
       return (SRAMBANK_PHYS(addr)*MEM_8KB)+SRAMBANK_OFF(addr);
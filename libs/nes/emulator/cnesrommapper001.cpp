@@ -16,6 +16,7 @@
 
 #include "cnesrommapper001.h"
 #include "cnesppu.h"
+#include "cnesscheduler.h"
 
 #include "cregisterdata.h"
 
@@ -70,7 +71,6 @@ uint8_t  CROMMapper001::m_sr = 0x00;
 uint8_t  CROMMapper001::m_sel = 0x00;
 uint8_t  CROMMapper001::m_srCount = 0;
 uint32_t CROMMapper001::m_cpuCycleOfLastWrite = 0xFFFFFFFF;
-uint32_t CROMMapper001::m_cpuCycle = 0xFFFFFFFF;
 
 CROMMapper001::CROMMapper001()
 {
@@ -94,7 +94,6 @@ void CROMMapper001::RESET ( bool soft )
    m_srCount = 0;
 
    m_cpuCycleOfLastWrite = 0xFFFFFFFF;
-   m_cpuCycle = 0xFFFFFFFF;
 
    for ( idx = 0; idx < 4; idx++ )
    {
@@ -109,12 +108,6 @@ void CROMMapper001::RESET ( bool soft )
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
 
-void CROMMapper001::SYNCCPU()
-{
-   // This may not be the actual CPU cycle but it doesn't matter.
-   m_cpuCycle++;
-}
-
 uint32_t CROMMapper001::DEBUGINFO ( uint32_t addr )
 {
    return m_reg [ (addr-MEM_32KB)/MEM_8KB ];
@@ -125,13 +118,13 @@ void CROMMapper001::HMAPPER ( uint32_t addr, uint8_t data )
    uint8_t bank = 0;
 
    // Discard this write if it's immediately following another write.
-   if ( m_cpuCycle == m_cpuCycleOfLastWrite+1 )
+   if ( CScheduler::CYCLES() == m_cpuCycleOfLastWrite+1 )
    {
       return;
    }
 
    // Keep track of when we last wrote.
-   m_cpuCycleOfLastWrite = m_cpuCycle;
+   m_cpuCycleOfLastWrite = CScheduler::CYCLES();
 
    // Shift bits into registers...
    if ( data&0x80 )
@@ -11,7 +11,6 @@ public:
 
    static void RESET ( bool soft );
    static void HMAPPER ( uint32_t addr, uint8_t data );
-   static void SYNCCPU ( void );
    static uint32_t DEBUGINFO ( uint32_t addr );
 
    // Internal accessors for mapper information inspector...
@@ -33,7 +32,6 @@ protected:
    static uint8_t  m_sel;
    static uint8_t  m_srCount;
    static uint32_t m_cpuCycleOfLastWrite;
-   static uint32_t m_cpuCycle;
 };
 
 #endif
@@ -17,6 +17,7 @@
 #include "cnesrommapper016.h"
 #include "cnes6502.h"
 #include "cnesppu.h"
+#include "cnesscheduler.h"
 
 #include "cregisterdata.h"
 
@@ -88,6 +89,7 @@ static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper
 
 uint8_t  CROMMapper016::m_reg [] = { 0x00, };
 uint16_t CROMMapper016::m_irqCounter = 0;
+uint32_t CROMMapper016::m_irqSyncCycle = 0;
 bool     CROMMapper016::m_irqEnabled = false;
 bool     CROMMapper016::m_irqAsserted = false;
 uint8_t  CROMMapper016::m_eepromBitCounter = 0;
@@ -127,6 +129,12 @@ void CROMMapper016::RESET016 ( bool soft )
    m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
 
    // CHR ROM/RAM already set up in CROM::RESET()...
+
+   // The IRQ counter is caught up lazily; the scheduler tells us
+   // when it next needs stepping.
+   CScheduler::HANDLER ( SCHEDULER_EVENT_MAPPER_IRQ, IRQEVENT );
+   m_irqSyncCycle = CScheduler::CYCLES();
+   SCHEDULEIRQ ();
 }
 
 
@@ -152,6 +160,12 @@ void CROMMapper016::RESET159 ( bool soft )
    m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
 
    // CHR ROM/RAM already set up in CROM::RESET()...
+
+   // The IRQ counter is caught up lazily; the scheduler tells us
+   // when it next needs stepping.
+   CScheduler::HANDLER ( SCHEDULER_EVENT_MAPPER_IRQ, IRQEVENT );
+   m_irqSyncCycle = CScheduler::CYCLES();
+   SCHEDULEIRQ ();
 }
 
 void CROMMapper016::SYNCCPU ( void )
@@ -174,6 +188,47 @@ void CROMMapper016::SYNCCPU ( void )
    }
 }
 
+void CROMMapper016::SYNCIRQ ( void )
+{
+   uint32_t cycles = CScheduler::CYCLES()-m_irqSyncCycle;
+
+   // Apply the counter steps of the cycles since we last looked.  None
+   // of them expires the counter; that cycle is always an IRQ event.
+   if ( m_irqEnabled )
+   {
+      m_irqCounter -= cycles;
+   }
+   m_irqSyncCycle = CScheduler::CYCLES();
+}
+
+void CROMMapper016::SCHEDULEIRQ ( void )
+{
+   if ( nesIsDebuggable() )
+   {
+      // Step the counter every cycle so the inspectors and breakpoints
+      // see it as it happens.
+      CScheduler::SCHEDULE ( SCHEDULER_EVENT_MAPPER_IRQ, m_irqSyncCycle );
+   }
+   else if ( m_irqEnabled )
+   {
+      // The counter expires on the step that takes it to zero.
+      CScheduler::SCHEDULE ( SCHEDULER_EVENT_MAPPER_IRQ, m_irqSyncCycle+(m_irqCounter?m_irqCounter:0x10000)-1 );
+   }
+   else
+   {
+      CScheduler::CANCEL ( SCHEDULER_EVENT_MAPPER_IRQ );
+   }
+}
+
+void CROMMapper016::IRQEVENT ( void )
+{
+   // Catch up to this cycle and then step the counter through it.
+   SYNCIRQ ();
+   SYNCCPU ();
+   m_irqSyncCycle++;
+   SCHEDULEIRQ ();
+}
+
 uint32_t CROMMapper016::DEBUGINFO ( uint32_t addr )
 {
    switch ( addr&0x000F )
@@ -285,6 +340,8 @@ void CROMMapper016::HMAPPER ( uint32_t addr, uint8_t data )
 {
    uint32_t reg;
 
+   SYNCIRQ ();
+
    switch ( addr&0x000F )
    {
    case 0x0000:
@@ -489,6 +546,9 @@ void CROMMapper016::HMAPPER ( uint32_t addr, uint8_t data )
       break;
    }
 
+   // The write may have moved the next counter expiry.
+   SCHEDULEIRQ ();
+
    if ( nesIsDebuggable() )
    {
       // Check mapper state breakpoints...
@@ -15,6 +15,7 @@ public:
    static uint32_t LMAPPER ( uint32_t addr );
    static void LMAPPER ( uint32_t addr, uint8_t data );
    static void SYNCCPU ( void );
+   static void IRQEVENT ( void );
    static uint32_t DEBUGINFO ( uint32_t addr );
 
    // Internal accessors for mapper information inspector...
@@ -53,8 +54,12 @@ public:
    }
 
 protected:
+   static void SYNCIRQ ( void );
+   static void SCHEDULEIRQ ( void );
+
    static uint8_t  m_reg [ 14 ];
    static uint16_t m_irqCounter;
+   static uint32_t m_irqSyncCycle;
    static bool     m_irqEnabled;
    static bool     m_irqAsserted;
    static uint8_t  m_eepromBitCounter;
@@ -17,6 +17,7 @@
 #include "cnesrommapper018.h"
 #include "cnes6502.h"
 #include "cnesppu.h"
+#include "cnesscheduler.h"
 
 #include "cregisterdata.h"
 
@@ -134,8 +135,34 @@ uint8_t  CROMMapper018::m_prg [] = { 0x00, };
 uint8_t  CROMMapper018::m_chr [] = { 0x00, };
 uint16_t CROMMapper018::m_irqReload = 0;
 uint16_t CROMMapper018::m_irqCounter = 0;
+uint32_t CROMMapper018::m_irqSyncCycle = 0;
 bool     CROMMapper018::m_irqEnabled = false;
 
+// The IRQ control register selects how many of the counter's bits count.
+static uint16_t irqCounterMask ( uint8_t control )
+{
+   uint8_t size = ((control&0x0E)>>1);
+
+   if ( size == 0 )
+   {
+      // 16 bits
+      return 0xFFFF;
+   }
+   else if ( size == 1 )
+   {
+      // 12 bits
+      return 0x0FFF;
+   }
+   else if ( size < 4 )
+   {
+      // 8 bits
+      return 0x00FF;
+   }
+
+   // 4 bits
+   return 0x000F;
+}
+
 CROMMapper018::CROMMapper018()
 {
 }
@@ -164,39 +191,23 @@ void CROMMapper018::RESET ( bool soft )
    m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
 
    // CHR ROM/RAM already set up in CROM::RESET()...
+
+   // The IRQ counter is caught up lazily; the scheduler tells us
+   // when it next needs stepping.
+   CScheduler::HANDLER ( SCHEDULER_EVENT_MAPPER_IRQ, IRQEVENT );
+   m_irqSyncCycle = CScheduler::CYCLES();
+   SCHEDULEIRQ ();
 }
 
 void CROMMapper018::SYNCCPU ( void )
 {
    uint16_t counterMask;
    uint16_t counter;
-   uint8_t  size;
-
-   size = ((m_reg[27]&0x0E)>>1);
 
    if ( m_irqEnabled )
    {
       // Get relevant counter bits.
-      if ( size == 0 )
-      {
-         // 16 bits
-         counterMask = 0xFFFF;
-      }
-      else if ( size == 1 )
-      {
-         // 12 bits
-         counterMask = 0x0FFF;
-      }
-      else if ( size < 4 )
-      {
-         // 8 bits
-         counterMask = 0x00FF;
-      }
-      else
-      {
-         // 4 bits
-         counterMask = 0x000F;
-      }
+      counterMask = irqCounterMask(m_reg[27]);
 
       counter = m_irqCounter&counterMask;
       counter--;
@@ -216,6 +227,48 @@ void CROMMapper018::SYNCCPU ( void )
    }
 }
 
+void CROMMapper018::SYNCIRQ ( void )
+{
+   uint32_t cycles = CScheduler::CYCLES()-m_irqSyncCycle;
+   uint16_t counterMask = irqCounterMask(m_reg[27]);
+
+   // Apply the counter steps of the cycles since we last looked.  None
+   // of them expires the counter; that cycle is always an IRQ event.
+   if ( m_irqEnabled )
+   {
+      m_irqCounter = (m_irqCounter&(~counterMask))|((m_irqCounter-cycles)&counterMask);
+   }
+   m_irqSyncCycle = CScheduler::CYCLES();
+}
+
+void CROMMapper018::SCHEDULEIRQ ( void )
+{
+   if ( nesIsDebuggable() )
+   {
+      // Step the counter every cycle so the inspectors and breakpoints
+      // see it as it happens.
+      CScheduler::SCHEDULE ( SCHEDULER_EVENT_MAPPER_IRQ, m_irqSyncCycle );
+   }
+   else if ( m_irqEnabled )
+   {
+      // The counter expires on the step that takes it past zero.
+      CScheduler::SCHEDULE ( SCHEDULER_EVENT_MAPPER_IRQ, m_irqSyncCycle+(m_irqCounter&irqCounterMask(m_reg[27])) );
+   }
+   else
+   {
+      CScheduler::CANCEL ( SCHEDULER_EVENT_MAPPER_IRQ );
+   }
+}
+
+void CROMMapper018::IRQEVENT ( void )
+{
+   // Catch up to this cycle and then step the counter through it.
+   SYNCIRQ ();
+   SYNCCPU ();
+   m_irqSyncCycle++;
+   SCHEDULEIRQ ();
+}
+
 uint32_t CROMMapper018::DEBUGINFO ( uint32_t addr )
 {
    switch ( addr )
@@ -314,6 +367,8 @@ void CROMMapper018::HMAPPER ( uint32_t addr, uint8_t data )
 {
    uint32_t reg;
 
+   SYNCIRQ ();
+
    switch ( addr )
    {
    case 0x8000:
@@ -523,6 +578,9 @@ void CROMMapper018::HMAPPER ( uint32_t addr, uint8_t data )
       break;
    }
 
+   // The write may have moved the next counter expiry.
+   SCHEDULEIRQ ();
+
    if ( nesIsDebuggable() )
    {
       // Check mapper state breakpoints...
@@ -12,14 +12,19 @@ public:
    static void RESET ( bool soft );
    static void HMAPPER ( uint32_t addr, uint8_t data );
    static void SYNCCPU ( void );
+   static void IRQEVENT ( void );
    static uint32_t DEBUGINFO ( uint32_t addr );
 
 protected:
+   static void SYNCIRQ ( void );
+   static void SCHEDULEIRQ ( void );
+
    // VRC2+VRC4
    static uint8_t  m_reg [ 23 ];
    static uint8_t  m_chr [ 8 ];
    static uint8_t  m_irqReload;
    static uint8_t  m_irqCounter;
+   static uint32_t m_irqSyncCycle;
    static uint8_t  m_irqPrescaler;
    static uint8_t  m_irqPrescalerPhase;
    static bool     m_irqEnabled;
@@ -17,6 +17,7 @@
 #include "cnesrommapper025.h"
 #include "cnes6502.h"
 #include "cnesppu.h"
+#include "cnesscheduler.h"
 
 #include "cregisterdata.h"
 
@@ -139,6 +140,7 @@ uint8_t  CROMMapper025::m_reg [] = { 0x00, };
 uint8_t  CROMMapper025::m_chr [] = { 0, };
 uint8_t  CROMMapper025::m_irqReload = 0;
 uint8_t  CROMMapper025::m_irqCounter = 0;
+uint32_t CROMMapper025::m_irqSyncCycle = 0;
 uint8_t  CROMMapper025::m_irqPrescaler = 0;
 uint8_t  CROMMapper025::m_irqPrescalerPhase = 0;
 bool     CROMMapper025::m_irqEnabled = false;
@@ -173,6 +175,12 @@ void CROMMapper025::RESET ( bool soft )
    m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
 
    // CHR ROM/RAM already set up in CROM::RESET()...
+
+   // The IRQ counter is caught up lazily; the scheduler tells us
+   // when it next needs stepping.
+   CScheduler::HANDLER ( SCHEDULER_EVENT_MAPPER_IRQ, IRQEVENT );
+   m_irqSyncCycle = CScheduler::CYCLES();
+   SCHEDULEIRQ ();
 }
 
 void CROMMapper025::SYNCCPU ( void )
@@ -230,6 +238,93 @@ void CROMMapper025::SYNCCPU ( void )
    }
 }
 
+void CROMMapper025::SYNCIRQ ( void )
+{
+   uint8_t  phases[3] = { 114, 114, 113 };
+   uint32_t cycles = CScheduler::CYCLES()-m_irqSyncCycle;
+   uint32_t expiry;
+
+   // Apply the counter steps of the cycles since we last looked.  None
+   // of them expires the counter; that cycle is always an IRQ event.
+   if ( m_reg[21]&0x02 )
+   {
+      if ( m_reg[21]&0x04 )
+      {
+         // Cycle mode counter
+         m_irqCounter += cycles;
+      }
+      else
+      {
+         // Scanline mode counter; step the prescaler a phase at a time.
+         while ( cycles )
+         {
+            expiry = (m_irqPrescaler < phases[m_irqPrescalerPhase])?phases[m_irqPrescalerPhase]-m_irqPrescaler:1;
+            if ( cycles < expiry )
+            {
+               m_irqPrescaler += cycles;
+               break;
+            }
+            cycles -= expiry;
+            m_irqPrescaler = 0;
+            m_irqPrescalerPhase++;
+            m_irqPrescalerPhase %= 3;
+            m_irqCounter++;
+         }
+      }
+   }
+   m_irqSyncCycle = CScheduler::CYCLES();
+}
+
+void CROMMapper025::SCHEDULEIRQ ( void )
+{
+   uint8_t  phases[3] = { 114, 114, 113 };
+   uint32_t offset;
+   uint8_t  phase;
+   uint8_t  counter;
+
+   if ( nesIsDebuggable() )
+   {
+      // Step the counter every cycle so the inspectors and breakpoints
+      // see it as it happens.
+      CScheduler::SCHEDULE ( SCHEDULER_EVENT_MAPPER_IRQ, m_irqSyncCycle );
+   }
+   else if ( m_reg[21]&0x02 )
+   {
+      // The counter expires on the step that takes it past 0xFF.
+      if ( m_reg[21]&0x04 )
+      {
+         // Cycle mode counter
+         offset = 0xFF-m_irqCounter;
+      }
+      else
+      {
+         // Scanline mode counter; the counter steps each time the
+         // prescaler runs through its current phase.
+         phase = m_irqPrescalerPhase;
+         offset = ((m_irqPrescaler < phases[phase])?phases[phase]-m_irqPrescaler:1)-1;
+         for ( counter = m_irqCounter; counter != 0xFF; counter++ )
+         {
+            phase = (phase+1)%3;
+            offset += phases[phase];
+         }
+      }
+      CScheduler::SCHEDULE ( SCHEDULER_EVENT_MAPPER_IRQ, m_irqSyncCycle+offset );
+   }
+   else
+   {
+      CScheduler::CANCEL ( SCHEDULER_EVENT_MAPPER_IRQ );
+   }
+}
+
+void CROMMapper025::IRQEVENT ( void )
+{
+   // Catch up to this cycle and then step the counter through it.
+   SYNCIRQ ();
+   SYNCCPU ();
+   m_irqSyncCycle++;
+   SCHEDULEIRQ ();
+}
+
 uint32_t CROMMapper025::DEBUGINFO ( uint32_t addr )
 {
    switch ( addr )
@@ -345,6 +440,8 @@ void CROMMapper025::HMAPPER ( uint32_t addr, uint8_t data )
 {
    uint32_t reg;
 
+   SYNCIRQ ();
+
    switch ( addr )
    {
    case 0x8000:
@@ -586,6 +683,9 @@ void CROMMapper025::HMAPPER ( uint32_t addr, uint8_t data )
       break;
    }
 
+   // The write may have moved the next counter expiry.
+   SCHEDULEIRQ ();
+
    if ( nesIsDebuggable() )
    {
       // Check mapper state breakpoints...
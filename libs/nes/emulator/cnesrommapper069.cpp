@@ -17,6 +17,7 @@
 #include "cnesrommapper069.h"
 #include "cnes6502.h"
 #include "cnesppu.h"
+#include "cnesscheduler.h"
 
 #include "cregisterdata.h"
 
@@ -65,6 +66,7 @@ uint8_t  CROMMapper069::m_reg [] = { 0x00, 0x00, 0x00, 0x00 };
 uint8_t  CROMMapper069::m_subReg [];
 bool           CROMMapper069::m_irqAsserted = false;
 uint16_t  CROMMapper069::m_irqCounter = 0x0000;
+uint32_t CROMMapper069::m_irqSyncCycle = 0;
 bool           CROMMapper069::m_irqEnable = false;
 bool           CROMMapper069::m_irqCountEnable = false;
 uint8_t  CROMMapper069::m_prg [ 4 ] = { 0, 0, 0, 0 };
@@ -115,6 +117,12 @@ void CROMMapper069::RESET ( bool soft )
    m_sramAreaEnabled = false;
 
    // CHR ROM/RAM already set up in CROM::RESET()...
+
+   // The IRQ counter is caught up lazily; the scheduler tells us
+   // when it next needs stepping.
+   CScheduler::HANDLER ( SCHEDULER_EVENT_MAPPER_IRQ, IRQEVENT );
+   m_irqSyncCycle = CScheduler::CYCLES();
+   SCHEDULEIRQ ();
 }
 
 void CROMMapper069::SYNCCPU ( void )
@@ -139,6 +147,52 @@ void CROMMapper069::SYNCCPU ( void )
    }
 }
 
+void CROMMapper069::SYNCIRQ ( void )
+{
+   uint32_t cycles = CScheduler::CYCLES()-m_irqSyncCycle;
+
+   // Apply the counter steps of the cycles since we last looked.  None
+   // of them asserts the IRQ; that cycle is always an IRQ event.
+   if ( m_irqCountEnable )
+   {
+      m_irqCounter -= cycles;
+   }
+   m_irqSyncCycle = CScheduler::CYCLES();
+}
+
+void CROMMapper069::SCHEDULEIRQ ( void )
+{
+   if ( nesIsDebuggable() )
+   {
+      // Step the counter every cycle so the inspectors and breakpoints
+      // see it as it happens.
+      CScheduler::SCHEDULE ( SCHEDULER_EVENT_MAPPER_IRQ, m_irqSyncCycle );
+   }
+   else if ( m_irqEnable && m_irqCountEnable )
+   {
+      // The IRQ is asserted on the step that starts from zero.
+      CScheduler::SCHEDULE ( SCHEDULER_EVENT_MAPPER_IRQ, m_irqSyncCycle+m_irqCounter );
+   }
+   else if ( m_irqEnable && (!m_irqCounter) )
+   {
+      // A stopped counter at zero asserts the IRQ on every step.
+      CScheduler::SCHEDULE ( SCHEDULER_EVENT_MAPPER_IRQ, m_irqSyncCycle );
+   }
+   else
+   {
+      CScheduler::CANCEL ( SCHEDULER_EVENT_MAPPER_IRQ );
+   }
+}
+
+void CROMMapper069::IRQEVENT ( void )
+{
+   // Catch up to this cycle and then step the counter through it.
+   SYNCIRQ ();
+   SYNCCPU ();
+   m_irqSyncCycle++;
+   SCHEDULEIRQ ();
+}
+
 void CROMMapper069::SETCPU ( void )
 {
    m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ m_prg[1] ];
@@ -167,6 +221,9 @@ uint32_t CROMMapper069::DEBUGINFO ( uint32_t addr )
 void CROMMapper069::HMAPPER ( uint32_t addr, uint8_t data )
 {
    int32_t reg = ((addr-0x8000)/MEM_8KB);
+
+   SYNCIRQ ();
+
    m_reg [ reg ] = data;
 
    switch ( addr&0xE000 )
@@ -247,6 +304,9 @@ void CROMMapper069::HMAPPER ( uint32_t addr, uint8_t data )
          break;
    }
 
+   // The write may have moved the next counter expiry.
+   SCHEDULEIRQ ();
+
    if ( nesIsDebuggable() )
    {
       // Check mapper state breakpoints...
@@ -14,6 +14,7 @@ public:
    static uint32_t LMAPPER ( uint32_t addr );
    static void LMAPPER ( uint32_t addr, uint8_t data );
    static void SYNCCPU ( void );
+   static void IRQEVENT ( void );
    static void SETCPU ( void );
    static void SETPPU ( void );
    static uint32_t DEBUGINFO ( uint32_t addr );
@@ -58,11 +59,15 @@ public:
    }
 
 protected:
+   static void SYNCIRQ ( void );
+   static void SCHEDULEIRQ ( void );
+
    // MMC3
    static uint8_t  m_reg [ 4 ];
    static uint8_t  m_subReg [ 16 ];
    static bool           m_irqAsserted;
    static uint16_t  m_irqCounter;
+   static uint32_t m_irqSyncCycle;
    static bool           m_irqEnable;
    static bool           m_irqCountEnable;
    static uint8_t  m_prg [ 4 ];
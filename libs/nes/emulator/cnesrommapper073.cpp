@@ -17,6 +17,7 @@
 #include "cnesrommapper073.h"
 #include "cnes6502.h"
 #include "cnesppu.h"
+#include "cnesscheduler.h"
 
 #include "cregisterdata.h"
 
@@ -84,6 +85,7 @@ static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper
 uint8_t  CROMMapper073::m_reg [] = { 0x00, };
 uint16_t CROMMapper073::m_irqReload = 0;
 uint16_t CROMMapper073::m_irqCounter = 0;
+uint32_t CROMMapper073::m_irqSyncCycle = 0;
 bool     CROMMapper073::m_irqEnabled = false;
 
 CROMMapper073::CROMMapper073()
@@ -114,6 +116,12 @@ void CROMMapper073::RESET ( bool soft )
    m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
 
    // CHR ROM/RAM already set up in CROM::RESET()...
+
+   // The IRQ counter is caught up lazily; the scheduler tells us
+   // when it next needs stepping.
+   CScheduler::HANDLER ( SCHEDULER_EVENT_MAPPER_IRQ, IRQEVENT );
+   m_irqSyncCycle = CScheduler::CYCLES();
+   SCHEDULEIRQ ();
 }
 
 void CROMMapper073::SYNCCPU ( void )
@@ -157,6 +165,50 @@ void CROMMapper073::SYNCCPU ( void )
    }
 }
 
+void CROMMapper073::SYNCIRQ ( void )
+{
+   uint32_t cycles = CScheduler::CYCLES()-m_irqSyncCycle;
+   uint16_t counterMask = (m_reg[4]&0x04)?0x00FF:0xFFFF;
+
+   // Apply the counter steps of the cycles since we last looked.  None
+   // of them expires the counter; that cycle is always an IRQ event.
+   if ( m_irqEnabled )
+   {
+      m_irqCounter = (m_irqCounter&(~counterMask))|((m_irqCounter+cycles)&counterMask);
+   }
+   m_irqSyncCycle = CScheduler::CYCLES();
+}
+
+void CROMMapper073::SCHEDULEIRQ ( void )
+{
+   if ( nesIsDebuggable() )
+   {
+      // Step the counter every cycle so the inspectors and breakpoints
+      // see it as it happens.
+      CScheduler::SCHEDULE ( SCHEDULER_EVENT_MAPPER_IRQ, m_irqSyncCycle );
+   }
+   else if ( m_irqEnabled )
+   {
+      uint16_t counterMask = (m_reg[4]&0x04)?0x00FF:0xFFFF;
+
+      // The counter expires on the step that takes it past its mask.
+      CScheduler::SCHEDULE ( SCHEDULER_EVENT_MAPPER_IRQ, m_irqSyncCycle+(counterMask-(m_irqCounter&counterMask)) );
+   }
+   else
+   {
+      CScheduler::CANCEL ( SCHEDULER_EVENT_MAPPER_IRQ );
+   }
+}
+
+void CROMMapper073::IRQEVENT ( void )
+{
+   // Catch up to this cycle and then step the counter through it.
+   SYNCIRQ ();
+   SYNCCPU ();
+   m_irqSyncCycle++;
+   SCHEDULEIRQ ();
+}
+
 uint32_t CROMMapper073::DEBUGINFO ( uint32_t addr )
 {
    switch ( addr )
@@ -189,6 +241,8 @@ void CROMMapper073::HMAPPER ( uint32_t addr, uint8_t data )
 {
    uint32_t reg;
 
+   SYNCIRQ ();
+
    switch ( addr )
    {
    case 0x8000:
@@ -245,6 +299,9 @@ void CROMMapper073::HMAPPER ( uint32_t addr, uint8_t data )
       break;
    }
 
+   // The write may have moved the next counter expiry.
+   SCHEDULEIRQ ();
+
    if ( nesIsDebuggable() )
    {
       // Check mapper state breakpoints...
@@ -12,13 +12,18 @@ public:
    static void RESET ( bool soft );
    static void HMAPPER ( uint32_t addr, uint8_t data );
    static void SYNCCPU ( void );
+   static void IRQEVENT ( void );
    static uint32_t DEBUGINFO ( uint32_t addr );
 
 protected:
+   static void SYNCIRQ ( void );
+   static void SCHEDULEIRQ ( void );
+
    // VRC3
    static uint8_t  m_reg [ 7 ];
    static uint16_t m_irqReload;
    static uint16_t m_irqCounter;
+   static uint32_t m_irqSyncCycle;
    static bool     m_irqEnabled;
 };
 
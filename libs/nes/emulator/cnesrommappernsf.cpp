@@ -0,0 +1,587 @@
+//    NESICIDE - an IDE for the 8-bit NES.
+//    Copyright (C) 2009  Christopher S. Pow
+
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "cnesrommappernsf.h"
+#include "cnesrommapper005.h"
+#include "cnesrommapper019.h"
+#include "cnesrommapper024.h"
+#include "cnesscheduler.h"
+#include "cnes6502.h"
+
+// CPU clock rates used to turn the header's play rate into CPU cycles.
+#define NSF_CLOCK_NTSC  1789773
+#define NSF_CLOCK_PAL   1662607
+#define NSF_CLOCK_DENDY 1773448
+
+// Play rates [in microseconds] of tunes that don't specify one.
+#define NSF_SPEED_NTSC 16639
+#define NSF_SPEED_PAL  19997
+
+// Player BIOS.  It is copied into m_bios and the song number, region
+// and INIT/PLAY addresses are patched in at the offsets below.
+#define BIOS_SONG   0x1D
+#define BIOS_REGION 0x1F
+#define BIOS_INIT   0x21
+#define BIOS_PLAY   0x2F
+#define BIOS_RTI    0x37
+
+static const uint8_t biosTemplate [] =
+{
+   0x78,             // 4100: SEI
+   0xD8,             // 4101: CLD
+   0xA2, 0xFF,       // 4102: LDX #$FF
+   0x9A,             // 4104: TXS
+   0xA9, 0x00,       // 4105: LDA #$00
+   0xA2, 0x13,       // 4107: LDX #$13
+   0x9D, 0x00, 0x40, // 4109: STA $4000,X
+   0xCA,             // 410C: DEX
+   0x10, 0xFA,       // 410D: BPL $4109
+   0xA9, 0x0F,       // 410F: LDA #$0F
+   0x8D, 0x15, 0x40, // 4111: STA $4015
+   0xA9, 0x40,       // 4114: LDA #$40
+   0x8D, 0x17, 0x40, // 4116: STA $4017
+   0x8D, 0xF0, 0x41, // 4119: STA $41F0 [INIT starting]
+   0xA9, 0x00,       // 411C: LDA #song
+   0xA2, 0x00,       // 411E: LDX #region
+   0x20, 0x00, 0x00, // 4120: JSR init
+   0x8D, 0xF1, 0x41, // 4123: STA $41F1 [INIT done]
+   0xAD, 0xF0, 0x41, // 4126: LDA $41F0 [PLAY due?]
+   0xF0, 0xFB,       // 4129: BEQ $4126
+   0x8D, 0xF0, 0x41, // 412B: STA $41F0 [PLAY starting]
+   0x20, 0x00, 0x00, // 412E: JSR play
+   0x8D, 0xF1, 0x41, // 4131: STA $41F1 [PLAY done]
+   0x4C, 0x26, 0x41, // 4134: JMP $4126
+   0x40              // 4137: RTI
+};
+
+uint16_t CROMMapperNSF::m_loadAddr = 0;
+uint16_t CROMMapperNSF::m_initAddr = 0;
+uint16_t CROMMapperNSF::m_playAddr = 0;
+uint32_t CROMMapperNSF::m_numSongs = 0;
+uint32_t CROMMapperNSF::m_startSong = 0;
+uint32_t CROMMapperNSF::m_song = 0;
+uint16_t CROMMapperNSF::m_speedNTSC = NSF_SPEED_NTSC;
+uint16_t CROMMapperNSF::m_speedPAL = NSF_SPEED_PAL;
+uint8_t  CROMMapperNSF::m_region = 0;
+uint8_t  CROMMapperNSF::m_chips = 0;
+uint8_t  CROMMapperNSF::m_initBank [] = { 0, };
+bool     CROMMapperNSF::m_bankswitched = false;
+uint32_t CROMMapperNSF::m_numPages = 0;
+uint8_t  CROMMapperNSF::m_bank [] = { 0, };
+uint8_t* CROMMapperNSF::m_pPage [] = { NULL, };
+uint8_t  CROMMapperNSF::m_bios [] = { 0, };
+bool     CROMMapperNSF::m_playDue = false;
+uint32_t CROMMapperNSF::m_playFraction = 0;
+bool     CROMMapperNSF::m_inInit = false;
+uint32_t CROMMapperNSF::m_routineStart = 0;
+uint32_t CROMMapperNSF::m_initCycles = 0;
+uint32_t CROMMapperNSF::m_playCycles = 0;
+uint32_t CROMMapperNSF::m_playCyclesMax = 0;
+uint32_t* CROMMapperNSF::m_pPlayLog = NULL;
+uint32_t CROMMapperNSF::m_playLogSize = 0;
+uint32_t CROMMapperNSF::m_playLogCount = 0;
+
+static inline uint16_t GET16 ( uint8_t* data )
+{
+   return (*data)|((*(data+1))<<8);
+}
+
+static inline uint32_t GET32 ( uint8_t* data )
+{
+   return (*data)|((*(data+1))<<8)|((*(data+2))<<16)|((*(data+3))<<24);
+}
+
+CROMMapperNSF::CROMMapperNSF()
+{
+}
+
+CROMMapperNSF::~CROMMapperNSF()
+{
+}
+
+bool CROMMapperNSF::LOAD ( uint8_t* data, uint32_t size )
+{
+   uint8_t* progData = NULL;
+   uint32_t progSize = 0;
+   uint8_t* chunk;
+   uint32_t chunkSize;
+   uint32_t offset;
+   uint8_t* image;
+   uint32_t imageSize;
+   uint32_t padding;
+   uint32_t bank;
+   bool     haveInfo = false;
+
+   m_numSongs = 0;
+   m_startSong = 0;
+   m_speedNTSC = 0;
+   m_speedPAL = 0;
+   m_region = 0;
+   m_chips = 0;
+   memset ( m_initBank, 0, sizeof(m_initBank) );
+
+   if ( (size >= 0x80) && (!memcmp(data,"NESM\x1A",5)) )
+   {
+      m_numSongs = data[0x06];
+      m_startSong = data[0x07];
+      m_loadAddr = GET16(data+0x08);
+      m_initAddr = GET16(data+0x0A);
+      m_playAddr = GET16(data+0x0C);
+      m_speedNTSC = GET16(data+0x6E);
+      memcpy ( m_initBank, data+0x70, 8 );
+      m_speedPAL = GET16(data+0x78);
+      m_region = data[0x7A];
+      m_chips = data[0x7B];
+
+      progData = data+0x80;
+      progSize = size-0x80;
+
+      // NSF2 files may have metadata after the program.
+      if ( data[0x05] >= 2 )
+      {
+         offset = data[0x7D]|(data[0x7E]<<8)|(data[0x7F]<<16);
+         if ( offset && (offset < progSize) )
+         {
+            progSize = offset;
+         }
+      }
+   }
+   else if ( (size >= 4) && (!memcmp(data,"NSFE",4)) )
+   {
+      offset = 4;
+      while ( offset+8 <= size )
+      {
+         chunkSize = GET32(data+offset);
+         chunk = data+offset+4;
+         offset += 8;
+
+         if ( chunkSize > size-offset )
+         {
+            return false;
+         }
+
+         if ( !memcmp(chunk,"INFO",4) )
+         {
+            // The song count and first song may be left off.
+            if ( chunkSize < 8 )
+            {
+               return false;
+            }
+            m_loadAddr = GET16(data+offset);
+            m_initAddr = GET16(data+offset+2);
+            m_playAddr = GET16(data+offset+4);
+            m_region = data[offset+6];
+            m_chips = data[offset+7];
+            m_numSongs = (chunkSize > 8)?data[offset+8]:1;
+            m_startSong = (chunkSize > 9)?data[offset+9]+1:1;
+            haveInfo = true;
+         }
+         else if ( !memcmp(chunk,"DATA",4) )
+         {
+            progData = data+offset;
+            progSize = chunkSize;
+         }
+         else if ( !memcmp(chunk,"BANK",4) )
+         {
+            memcpy ( m_initBank, data+offset, (chunkSize<8)?chunkSize:8 );
+         }
+         else if ( !memcmp(chunk,"RATE",4) )
+         {
+            if ( chunkSize >= 2 )
+            {
+               m_speedNTSC = GET16(data+offset);
+            }
+            if ( chunkSize >= 4 )
+            {
+               m_speedPAL = GET16(data+offset+2);
+            }
+         }
+         else if ( !memcmp(chunk,"NEND",4) )
+         {
+            break;
+         }
+         else if ( (chunk[0] >= 'A') && (chunk[0] <= 'Z') )
+         {
+            // Chunks with upper-case IDs must be understood to play the tune.
+            return false;
+         }
+
+         offset += chunkSize;
+      }
+
+      if ( (!haveInfo) || (!progData) )
+      {
+         return false;
+      }
+   }
+   else
+   {
+      return false;
+   }
+
+   // Tunes that load below $8000 are FDS tunes, which need the FDS's
+   // RAM-backed address space.
+   if ( m_loadAddr < 0x8000 )
+   {
+      m_numSongs = 0;
+      return false;
+   }
+
+   if ( !m_numSongs )
+   {
+      m_numSongs = 1;
+   }
+   // Header's starting song is one-based.
+   m_startSong = m_startSong?m_startSong-1:0;
+   if ( m_startSong >= m_numSongs )
+   {
+      m_startSong = 0;
+   }
+   if ( !m_speedNTSC )
+   {
+      m_speedNTSC = NSF_SPEED_NTSC;
+   }
+   if ( !m_speedPAL )
+   {
+      m_speedPAL = NSF_SPEED_PAL;
+   }
+
+   m_bankswitched = false;
+   for ( bank = 0; bank < 8; bank++ )
+   {
+      if ( m_initBank[bank] )
+      {
+         m_bankswitched = true;
+      }
+   }
+
+   // Bankswitched tunes are laid out in 4KB pages starting at the
+   // 4KB page containing the load address; other tunes are placed
+   // at their load address in a flat 32KB image.
+   if ( m_bankswitched )
+   {
+      padding = m_loadAddr&MASK_4KB;
+      imageSize = padding+progSize;
+   }
+   else
+   {
+      padding = m_loadAddr-0x8000;
+      imageSize = MEM_32KB;
+      if ( progSize > imageSize-padding )
+      {
+         progSize = imageSize-padding;
+      }
+   }
+   imageSize = (imageSize+MASK_8KB)&(~MASK_8KB);
+   if ( imageSize < MEM_32KB )
+   {
+      imageSize = MEM_32KB;
+   }
+   if ( imageSize > NUM_ROM_BANKS*MEM_8KB )
+   {
+      m_numSongs = 0;
+      return false;
+   }
+
+   image = new uint8_t [ imageSize ];
+   memset ( image, 0, imageSize );
+   memcpy ( image+padding, progData, progSize );
+
+   ClearPRGBanks ();
+   ClearCHRBanks ();
+   for ( bank = 0; bank < (imageSize>>UPSHIFT_8KB); bank++ )
+   {
+      SetPRGBank ( bank, image+(bank<<UPSHIFT_8KB) );
+   }
+   DoneLoadingBanks ();
+
+   delete [] image;
+
+   m_numPages = imageSize>>UPSHIFT_4KB;
+   m_song = m_startSong;
+
+   return true;
+}
+
+void CROMMapperNSF::RESET ( bool soft )
+{
+   uint32_t slot;
+
+   // The expansion sound is reset by the mappers that emulate it.  That
+   // resets CROM too so it must be done before the NSF's view is set up.
+   if ( m_chips&NSF_CHIP_VRC6 )
+   {
+      CROMMapper024::RESET ( soft );
+   }
+   if ( m_chips&NSF_CHIP_MMC5 )
+   {
+      CROMMapper005::RESET ( soft );
+   }
+   if ( m_chips&NSF_CHIP_N163 )
+   {
+      CROMMapper019::RESET ( soft );
+   }
+
+   m_mapper = MAPPER_NSF;
+
+   CROM::RESET ( m_mapper, soft );
+
+   m_dbRegisters = NULL;
+
+   for ( slot = 0; slot < 8; slot++ )
+   {
+      REMAP ( slot, m_bankswitched?m_initBank[slot]:slot );
+   }
+
+   // Tunes expect to start with clear RAM.
+   C6502::MEMCLR ();
+   memset ( m_SRAMmemory[0], 0, MEM_8KB );
+
+   BUILDBIOS ();
+
+   m_inInit = true;
+   m_routineStart = CScheduler::CYCLES();
+   m_initCycles = 0;
+   m_playCycles = 0;
+   m_playCyclesMax = 0;
+   m_playLogCount = 0;
+
+   m_playDue = false;
+   m_playFraction = 0;
+   CScheduler::HANDLER ( SCHEDULER_EVENT_NSF_PLAY, PLAYTIMER );
+   CScheduler::CANCEL ( SCHEDULER_EVENT_NSF_PLAY );
+   PLAYTIMER ();
+   m_playDue = false;
+}
+
+void CROMMapperNSF::BUILDBIOS ( void )
+{
+   memset ( m_bios, 0, sizeof(m_bios) );
+   memcpy ( m_bios, biosTemplate, sizeof(biosTemplate) );
+
+   m_bios [ BIOS_SONG ] = m_song;
+   m_bios [ BIOS_REGION ] = (CNES::VIDEOMODE()==MODE_NTSC)?0:1;
+   m_bios [ BIOS_INIT ] = m_initAddr&0xFF;
+   m_bios [ BIOS_INIT+1 ] = m_initAddr>>8;
+   m_bios [ BIOS_PLAY ] = m_playAddr&0xFF;
+   m_bios [ BIOS_PLAY+1 ] = m_playAddr>>8;
+}
+
+void CROMMapperNSF::REMAP ( uint32_t slot, uint8_t bank )
+{
+   uint32_t page = bank%m_numPages;
+
+   m_bank [ slot ] = bank;
+   m_pPage [ slot ] = m_PRGROMmemory [ page>>1 ]+((page&1)<<UPSHIFT_4KB);
+
+   // The debugger looks at PRG-ROM through 8KB banks so show it the
+   // bank containing the page mapped into the lower half of each.
+   if ( !(slot&1) )
+   {
+      m_pPRGROMmemory [ slot>>1 ] = m_PRGROMmemory [ page>>1 ];
+   }
+}
+
+void CROMMapperNSF::PLAYTIMER ( void )
+{
+   uint32_t clock = NSF_CLOCK_NTSC;
+   uint32_t speed = m_speedNTSC;
+   uint64_t period;
+
+   // Another cartridge was loaded since the event was scheduled.
+   if ( m_mapper != MAPPER_NSF )
+   {
+      return;
+   }
+
+   m_playDue = true;
+
+   if ( CNES::VIDEOMODE() == MODE_PAL )
+   {
+      clock = NSF_CLOCK_PAL;
+      speed = m_speedPAL;
+   }
+   else if ( CNES::VIDEOMODE() == MODE_DENDY )
+   {
+      clock = NSF_CLOCK_DENDY;
+      speed = m_speedPAL;
+   }
+
+   // Carry the fractional cycle so the average play rate is exact.
+   period = ((uint64_t)speed*clock)+m_playFraction;
+   m_playFraction = period%1000000;
+
+   CScheduler::SCHEDULEIN ( SCHEDULER_EVENT_NSF_PLAY, period/1000000 );
+}
+
+void CROMMapperNSF::SYNCCPU ( void )
+{
+   if ( m_chips&NSF_CHIP_VRC6 )
+   {
+      CROMMapper024::SYNCCPU ();
+   }
+   if ( m_chips&NSF_CHIP_MMC5 )
+   {
+      CROMMapper005::SYNCCPU ();
+   }
+   if ( m_chips&NSF_CHIP_N163 )
+   {
+      CROMMapper019::SYNCCPU ();
+   }
+}
+
+uint16_t CROMMapperNSF::AMPLITUDE ( void )
+{
+   uint16_t amp = 0;
+
+   if ( m_chips&NSF_CHIP_VRC6 )
+   {
+      amp += CROMMapper024::AMPLITUDE ();
+   }
+   if ( m_chips&NSF_CHIP_MMC5 )
+   {
+      amp += CROMMapper005::AMPLITUDE ();
+   }
+   if ( m_chips&NSF_CHIP_N163 )
+   {
+      amp += CROMMapper019::AMPLITUDE ();
+   }
+
+   return amp;
+}
+
+uint32_t CROMMapperNSF::DEBUGINFO ( uint32_t addr )
+{
+   if ( (addr >= 0x5FF8) && (addr <= 0x5FFF) )
+   {
+      return m_bank [ addr-0x5FF8 ];
+   }
+
+   return HMAPPER ( addr );
+}
+
+uint32_t CROMMapperNSF::HMAPPER ( uint32_t addr )
+{
+   // The vectors point into the player BIOS.
+   if ( addr >= 0xFFFA )
+   {
+      switch ( addr )
+      {
+      case 0xFFFC:
+         return NSF_BIOS_START&0xFF;
+      case 0xFFFD:
+         return NSF_BIOS_START>>8;
+      default:
+         return (addr&1)?((NSF_BIOS_START+BIOS_RTI)>>8):((NSF_BIOS_START+BIOS_RTI)&0xFF);
+      }
+   }
+
+   return *(m_pPage[(addr&MASK_32KB)>>UPSHIFT_4KB]+(addr&MASK_4KB));
+}
+
+void CROMMapperNSF::HMAPPER ( uint32_t addr, uint8_t data )
+{
+   // Only pass on sound register writes; the rest of these mappers'
+   // registers would bank-switch things out from under the tune.
+   if ( (m_chips&NSF_CHIP_VRC6) &&
+        (addr >= 0x9000) && (addr <= 0xB002) && ((addr&MASK_4KB) <= 2) )
+   {
+      CROMMapper024::HMAPPER ( addr, data );
+   }
+   if ( (m_chips&NSF_CHIP_N163) && (addr >= 0xF800) )
+   {
+      CROMMapper019::HMAPPER ( 0xF800, data );
+   }
+}
+
+uint32_t CROMMapperNSF::LMAPPER ( uint32_t addr )
+{
+   if ( addr >= 0x6000 )
+   {
+      return CROM::SRAMVIRT ( addr );
+   }
+   else if ( (addr >= NSF_BIOS_START) && (addr <= NSF_BIOS_END) )
+   {
+      if ( addr == NSF_BIOS_PLAY_STATUS )
+      {
+         return m_playDue;
+      }
+      return m_bios [ addr-NSF_BIOS_START ];
+   }
+   else if ( (m_chips&NSF_CHIP_N163) && (addr == 0x4800) )
+   {
+      return CROMMapper019::LMAPPER ( addr );
+   }
+   else if ( (m_chips&NSF_CHIP_MMC5) &&
+             (((addr >= 0x5205) && (addr <= 0x5206)) ||
+              ((addr >= EXRAM_START) && (addr < 0x5FF6))) )
+   {
+      return CROMMapper005::LMAPPER ( addr );
+   }
+
+   return C6502::OPENBUS();
+}
+
+void CROMMapperNSF::LMAPPER ( uint32_t addr, uint8_t data )
+{
+   uint32_t cycles;
+
+   if ( addr >= 0x6000 )
+   {
+      CROM::SRAMVIRT ( addr, data );
+   }
+   else if ( addr >= 0x5FF8 )
+   {
+      REMAP ( addr-0x5FF8, data );
+   }
+   else if ( addr == NSF_BIOS_PLAY_STATUS )
+   {
+      m_playDue = false;
+      m_routineStart = CScheduler::CYCLES();
+   }
+   else if ( addr == NSF_BIOS_DONE )
+   {
+      cycles = CScheduler::CYCLES()-m_routineStart;
+      if ( m_inInit )
+      {
+         m_initCycles = cycles;
+         m_inInit = false;
+      }
+      else
+      {
+         m_playCycles = cycles;
+         if ( cycles > m_playCyclesMax )
+         {
+            m_playCyclesMax = cycles;
+         }
+         if ( m_pPlayLog && (m_playLogCount < m_playLogSize) )
+         {
+            m_pPlayLog[m_playLogCount++] = cycles;
+         }
+      }
+   }
+   else if ( (m_chips&NSF_CHIP_N163) && (addr == 0x4800) )
+   {
+      CROMMapper019::LMAPPER ( addr, data );
+   }
+   else if ( (m_chips&NSF_CHIP_MMC5) &&
+             (((addr >= 0x5000) && (addr <= 0x5015)) ||
+              ((addr >= 0x5205) && (addr <= 0x5206)) ||
+              ((addr >= EXRAM_START) && (addr < 0x5FF6))) )
+   {
+      CROMMapper005::LMAPPER ( addr, data );
+   }
+}
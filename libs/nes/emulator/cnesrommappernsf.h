@@ -0,0 +1,147 @@
+#if !defined ( ROM_MAPPERNSF_H )
+#define ROM_MAPPERNSF_H
+
+#include "cnesrom.h"
+
+// NSF expansion sound chip flags [header byte $7B].
+#define NSF_CHIP_VRC6 0x01
+#define NSF_CHIP_VRC7 0x02
+#define NSF_CHIP_FDS  0x04
+#define NSF_CHIP_MMC5 0x08
+#define NSF_CHIP_N163 0x10
+#define NSF_CHIP_S5B  0x20
+
+// Expansion sound chips the emulator core has sound emulation for.
+#define NSF_CHIPS_SUPPORTED (NSF_CHIP_VRC6|NSF_CHIP_MMC5|NSF_CHIP_N163)
+
+// The NSF player lives in a small "BIOS" in otherwise unused cartridge
+// space.  It sets up the APU, calls the tune's INIT routine and then
+// calls its PLAY routine whenever the play timer expires.  The BIOS
+// pokes the status registers to let the mapper time INIT and PLAY.
+#define NSF_BIOS_START       0x4100
+#define NSF_BIOS_END         0x41FF
+#define NSF_BIOS_PLAY_STATUS 0x41F0 // read: PLAY due, write: routine start
+#define NSF_BIOS_DONE        0x41F1 // write: routine returned
+
+// The CROMMapperNSF class is the "mapper" that an NSF runs on.  The
+// NSF image is held in PRG-ROM as 4KB pages that are mapped into the
+// CPU's $8000-$FFFF space by writes to $5FF8-$5FFF.  Expansion audio
+// register writes are handed to the mappers that already emulate the
+// sound hardware of the cartridges the chips came on.
+class CROMMapperNSF : public CROM
+{
+public:
+   CROMMapperNSF();
+   ~CROMMapperNSF();
+
+   // Parse an NSF or NSFe file and load its program into PRG-ROM.
+   // Returns false if the file isn't something the player can play.
+   static bool LOAD ( uint8_t* data, uint32_t size );
+
+   static void RESET ( bool soft );
+   static uint32_t HMAPPER ( uint32_t addr );
+   static void HMAPPER ( uint32_t addr, uint8_t data );
+   static uint32_t LMAPPER ( uint32_t addr );
+   static void LMAPPER ( uint32_t addr, uint8_t data );
+   static void SYNCCPU ( void );
+   static uint32_t DEBUGINFO ( uint32_t addr );
+   static uint16_t AMPLITUDE ( void );
+
+   // Scheduler handler for the play timer.
+   static void PLAYTIMER ( void );
+
+   // Song selection [zero-based].  Takes effect at the next reset.
+   static void SONG ( uint32_t song )
+   {
+      m_song = song;
+   }
+   static uint32_t SONG ( void )
+   {
+      return m_song;
+   }
+   static uint32_t NUMSONGS ( void )
+   {
+      return m_numSongs;
+   }
+   static uint32_t STARTSONG ( void )
+   {
+      return m_startSong;
+   }
+   static uint8_t CHIPS ( void )
+   {
+      return m_chips;
+   }
+   static bool ISPAL ( void )
+   {
+      // PAL-only tunes; dual-region tunes prefer NTSC.
+      return ( (m_region&0x03) == 0x01 );
+   }
+
+   // CPU cycles spent in the tune's routines.
+   static uint32_t INITCYCLES ( void )
+   {
+      return m_initCycles;
+   }
+   static uint32_t PLAYCYCLES ( void )
+   {
+      return m_playCycles;
+   }
+   static uint32_t PLAYCYCLESMAX ( void )
+   {
+      return m_playCyclesMax;
+   }
+
+   // Optional log of the CPU cycles spent in each call of PLAY, for
+   // profiling a driver over a whole song.  Logging stops when the log
+   // is full; passing NULL turns it off.
+   static void PLAYLOG ( uint32_t* log, uint32_t size )
+   {
+      m_pPlayLog = log;
+      m_playLogSize = size;
+      m_playLogCount = 0;
+   }
+   static uint32_t PLAYLOGCOUNT ( void )
+   {
+      return m_playLogCount;
+   }
+
+protected:
+   static void REMAP ( uint32_t slot, uint8_t bank );
+   static void BUILDBIOS ( void );
+
+   // Tune information from the header.
+   static uint16_t m_loadAddr;
+   static uint16_t m_initAddr;
+   static uint16_t m_playAddr;
+   static uint32_t m_numSongs;
+   static uint32_t m_startSong;
+   static uint32_t m_song;
+   static uint16_t m_speedNTSC;
+   static uint16_t m_speedPAL;
+   static uint8_t  m_region;
+   static uint8_t  m_chips;
+   static uint8_t  m_initBank [ 8 ];
+   static bool     m_bankswitched;
+
+   // 4KB page mapping of $8000-$FFFF.
+   static uint32_t m_numPages;
+   static uint8_t  m_bank [ 8 ];
+   static uint8_t* m_pPage [ 8 ];
+
+   // Player BIOS and play timer.
+   static uint8_t  m_bios [ MEM_256B ];
+   static bool     m_playDue;
+   static uint32_t m_playFraction;
+
+   // INIT/PLAY timing.
+   static bool     m_inInit;
+   static uint32_t m_routineStart;
+   static uint32_t m_initCycles;
+   static uint32_t m_playCycles;
+   static uint32_t m_playCyclesMax;
+   static uint32_t* m_pPlayLog;
+   static uint32_t m_playLogSize;
+   static uint32_t m_playLogCount;
+};
+
+#endif
@@ -0,0 +1,172 @@
+//    NESICIDE - an IDE for the 8-bit NES.
+//    Copyright (C) 2009  Christopher S. Pow
+
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "cnesscheduler.h"
+
+CScheduler::SchedulerEntry CScheduler::m_heap [ NUM_SCHEDULER_DOMAINS ][ NUM_SCHEDULER_EVENTS ];
+int32_t                    CScheduler::m_heapIdx [ NUM_SCHEDULER_EVENTS ];
+int32_t                    CScheduler::m_count [ NUM_SCHEDULER_DOMAINS ] = { 0, };
+SCHEDULERFUNC              CScheduler::m_handler [ NUM_SCHEDULER_EVENTS ] = { NULL, };
+uint32_t                   CScheduler::m_cycles [ NUM_SCHEDULER_DOMAINS ] = { 0, };
+
+static CScheduler __init __attribute__((unused));
+
+CScheduler::CScheduler()
+{
+   RESET ();
+}
+
+void CScheduler::RESET ( void )
+{
+   int32_t event;
+   int32_t domain;
+
+   for ( event = 0; event < NUM_SCHEDULER_EVENTS; event++ )
+   {
+      m_heapIdx [ event ] = -1;
+   }
+   for ( domain = 0; domain < NUM_SCHEDULER_DOMAINS; domain++ )
+   {
+      m_count [ domain ] = 0;
+      m_cycles [ domain ] = 0;
+   }
+}
+
+void CScheduler::SWAP ( int32_t domain, int32_t idx1, int32_t idx2 )
+{
+   SchedulerEntry* pHeap = m_heap [ domain ];
+   SchedulerEntry entry = pHeap [ idx1 ];
+
+   pHeap [ idx1 ] = pHeap [ idx2 ];
+   pHeap [ idx2 ] = entry;
+   m_heapIdx [ pHeap[idx1].event ] = idx1;
+   m_heapIdx [ pHeap[idx2].event ] = idx2;
+}
+
+void CScheduler::SIFTUP ( int32_t domain, int32_t idx )
+{
+   SchedulerEntry* pHeap = m_heap [ domain ];
+   int32_t parent;
+
+   while ( idx > 0 )
+   {
+      parent = (idx-1)>>1;
+
+      if ( ((int32_t)(pHeap[idx].cycle-pHeap[parent].cycle)) >= 0 )
+      {
+         break;
+      }
+
+      SWAP ( domain, idx, parent );
+      idx = parent;
+   }
+}
+
+void CScheduler::SIFTDOWN ( int32_t domain, int32_t idx )
+{
+   SchedulerEntry* pHeap = m_heap [ domain ];
+   int32_t count = m_count [ domain ];
+   int32_t child;
+
+   for ( ; ; )
+   {
+      child = (idx<<1)+1;
+
+      if ( child >= count )
+      {
+         break;
+      }
+
+      // Pick the sooner of the two children...
+      if ( (child+1 < count) &&
+           (((int32_t)(pHeap[child+1].cycle-pHeap[child].cycle)) < 0) )
+      {
+         child++;
+      }
+
+      if ( ((int32_t)(pHeap[child].cycle-pHeap[idx].cycle)) >= 0 )
+      {
+         break;
+      }
+
+      SWAP ( domain, idx, child );
+      idx = child;
+   }
+}
+
+void CScheduler::SCHEDULE ( int32_t event, uint32_t cycle )
+{
+   int32_t domain = DOMAIN ( event );
+   int32_t idx = m_heapIdx [ event ];
+
+   if ( idx < 0 )
+   {
+      // New event goes at the bottom of the heap...
+      idx = m_count [ domain ];
+      m_count [ domain ]++;
+      m_heap [ domain ][ idx ].event = event;
+      m_heapIdx [ event ] = idx;
+   }
+
+   m_heap [ domain ][ idx ].cycle = cycle;
+
+   // The event may have moved either direction...
+   SIFTUP ( domain, idx );
+   SIFTDOWN ( domain, m_heapIdx[event] );
+}
+
+void CScheduler::CANCEL ( int32_t event )
+{
+   int32_t domain = DOMAIN ( event );
+   int32_t idx = m_heapIdx [ event ];
+   int32_t moved;
+
+   if ( idx >= 0 )
+   {
+      m_count [ domain ]--;
+      if ( idx != m_count[domain] )
+      {
+         // Fill the hole with the last event and let it find its place...
+         SWAP ( domain, idx, m_count[domain] );
+         m_heapIdx [ event ] = -1;
+         moved = m_heap [ domain ][ idx ].event;
+         SIFTUP ( domain, idx );
+         SIFTDOWN ( domain, m_heapIdx[moved] );
+      }
+      else
+      {
+         m_heapIdx [ event ] = -1;
+      }
+   }
+}
+
+void CScheduler::DISPATCHDUE ( int32_t domain )
+{
+   int32_t event;
+
+   // Handlers usually reschedule their own event so pull the
+   // event off the queue before invoking the handler.
+   while ( m_count[domain] && (((int32_t)(m_cycles[domain]-m_heap[domain][0].cycle)) >= 0) )
+   {
+      event = m_heap [ domain ][ 0 ].event;
+      CANCEL ( event );
+
+      if ( m_handler[event] )
+      {
+         m_handler [ event ] ();
+      }
+   }
+}
@@ -0,0 +1,156 @@
+//    NESICIDE - an IDE for the 8-bit NES.
+//    Copyright (C) 2009  Christopher S. Pow
+
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#if !defined ( NESSCHEDULER_H )
+#define NESSCHEDULER_H
+
+#include "nes_emulator_core.h"
+
+// Scheduler clock domains.  Events in the CPU domain are timed in
+// CPU cycles and are dispatched from C6502::ADVANCE (by way of the
+// APU, see below).  Events in the PPU domain are timed in PPU cycles
+// and are dispatched from CPPU::EMULATE after the CPU has been given
+// its share of each PPU cycle.
+enum
+{
+   SCHEDULER_DOMAIN_CPU = 0,
+   SCHEDULER_DOMAIN_PPU,
+   NUM_SCHEDULER_DOMAINS
+};
+
+// Scheduled event identifiers.  Each component that wants to be
+// told about an "interesting" cycle ahead of time owns one or
+// more of these.  An event identifier can be scheduled at most once;
+// rescheduling it moves it.  The PPU domain events must follow the
+// CPU domain events.
+enum
+{
+   // CPU domain...
+   SCHEDULER_EVENT_APU = 0,
+   SCHEDULER_EVENT_MAPPER_IRQ,
+   SCHEDULER_EVENT_NSF_PLAY,
+   // PPU domain...
+   SCHEDULER_EVENT_PPU_NMI,
+   SCHEDULER_EVENT_PPU_OAMADDR,
+   NUM_SCHEDULER_EVENTS
+};
+
+#define FIRST_PPU_SCHEDULER_EVENT SCHEDULER_EVENT_PPU_NMI
+
+typedef void (*SCHEDULERFUNC)(void);
+
+// The CScheduler class is a timestamped event queue that lets the
+// elements of the NES (APU, PPU, mappers) tell the emulator core when
+// they next need attention instead of checking their state on every
+// cycle.  It keeps a binary min-heap of pending events per clock domain
+// keyed by that domain's cycle counter.  Components run in catch-up
+// batches whenever their event handler is invoked or whenever the CPU
+// touches them, whichever comes first.
+//
+// The CPU domain clock is advanced once per CPU cycle by the APU, since
+// the APU is the one element clocked on every CPU cycle whether or not
+// the CPU is running (it isn't after a KIL opcode).  Due events are
+// dispatched before the clock is advanced so handlers see the same
+// machine state the per-cycle checks they replace would have seen.
+// The PPU domain clock is advanced once per PPU cycle by the PPU.
+//
+// Timestamps are compared by signed difference so the roll-over of the
+// 32-bit cycle counters is not a significant event.
+class CScheduler
+{
+public:
+   CScheduler();
+
+   // Clear all pending events and restart the scheduler clocks.
+   static void RESET ( void );
+
+   // Register the handler that is invoked when an event comes due.
+   static void HANDLER ( int32_t event, SCHEDULERFUNC handler )
+   {
+      m_handler [ event ] = handler;
+   }
+
+   // Return the clock domain an event is timed in.
+   static inline int32_t DOMAIN ( int32_t event )
+   {
+      return (event >= FIRST_PPU_SCHEDULER_EVENT)?SCHEDULER_DOMAIN_PPU:SCHEDULER_DOMAIN_CPU;
+   }
+
+   // Schedule (or reschedule) an event at an absolute cycle of its domain.
+   static void SCHEDULE ( int32_t event, uint32_t cycle );
+
+   // Schedule (or reschedule) an event relative to the current cycle
+   // of its domain.
+   static void SCHEDULEIN ( int32_t event, uint32_t cycles )
+   {
+      SCHEDULE ( event, m_cycles[DOMAIN(event)]+cycles );
+   }
+
+   // Remove an event from the queue if it is pending.
+   static void CANCEL ( int32_t event );
+
+   static bool PENDING ( int32_t event )
+   {
+      return (m_heapIdx[event] >= 0);
+   }
+
+   // Return the current cycle of a domain.
+   static inline uint32_t CYCLES ( int32_t domain = SCHEDULER_DOMAIN_CPU )
+   {
+      return m_cycles [ domain ];
+   }
+
+   // Advance a domain's clock by one cycle.
+   static inline void CLOCK ( int32_t domain = SCHEDULER_DOMAIN_CPU )
+   {
+      m_cycles [ domain ]++;
+   }
+
+   // Invoke the handlers of all of a domain's events that are due.
+   // The common case of nothing being due is a single compare.
+   static inline void DISPATCH ( int32_t domain = SCHEDULER_DOMAIN_CPU )
+   {
+      if ( m_count[domain] && (((int32_t)(m_cycles[domain]-m_heap[domain][0].cycle)) >= 0) )
+      {
+         DISPATCHDUE ( domain );
+      }
+   }
+
+protected:
+   static void DISPATCHDUE ( int32_t domain );
+   static void SIFTUP ( int32_t domain, int32_t idx );
+   static void SIFTDOWN ( int32_t domain, int32_t idx );
+   static void SWAP ( int32_t domain, int32_t idx1, int32_t idx2 );
+
+   typedef struct _SchedulerEntry
+   {
+      uint32_t cycle;
+      int32_t  event;
+   } SchedulerEntry;
+
+   // The binary min-heaps of pending events and, for each event,
+   // its position in its domain's heap (-1 if it is not pending).
+   static SchedulerEntry m_heap [ NUM_SCHEDULER_DOMAINS ][ NUM_SCHEDULER_EVENTS ];
+   static int32_t        m_heapIdx [ NUM_SCHEDULER_EVENTS ];
+   static int32_t        m_count [ NUM_SCHEDULER_DOMAINS ];
+
+   static SCHEDULERFUNC  m_handler [ NUM_SCHEDULER_EVENTS ];
+
+   // Running counters of cycles seen by the scheduler.
+   static uint32_t       m_cycles [ NUM_SCHEDULER_DOMAINS ];
+};
+
+#endif
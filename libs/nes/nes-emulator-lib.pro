@@ -93,7 +93,10 @@ SOURCES += \
     emulator/cnesrommapper019.cpp \
     emulator/cnesrommapper018.cpp \
     emulator/cnesrommapper073.cpp \
-    emulator/cnesrommapper016.cpp
+    emulator/cnesrommapper016.cpp \
+    emulator/cnesscheduler.cpp \
+    emulator/cnesrommappernsf.cpp \
+    emulator/cnesmovie.cpp
 
 HEADERS +=\
    emulator/cnesrommapper068.h \
@@ -137,4 +140,7 @@ HEADERS +=\
     emulator/cnesrommapper019.h \
     emulator/cnesrommapper018.h \
     emulator/cnesrommapper073.h \
-    emulator/cnesrommapper016.h
+    emulator/cnesrommapper016.h \
+    emulator/cnesscheduler.h \
+    emulator/cnesrommappernsf.h \
+    emulator/cnesmovie.h
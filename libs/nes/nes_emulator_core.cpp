@@ -12,9 +12,13 @@
 #include "cnesrommapper016.h"
 #include "cnesrommapper028.h"
 #include "cnesrommapper069.h"
+#include "cnesrommappernsf.h"
+#include "cnesmovie.h"
 
 #include "common/cnessystempalette.h"
 
+#include <stdio.h>
+
 static char __emu_version__ [] = "V1.004"
 #if defined ( QT_NO_DEBUG )
 " RELEASE";
@@ -471,6 +475,314 @@ void nesClearAudioSamplesAvailable ( void )
    apuDataAvailable = 0;
 }
 
+bool nesLoadNSF ( uint8_t* data, uint32_t size )
+{
+   return CROMMapperNSF::LOAD(data,size);
+}
+
+uint32_t nesGetNSFNumSongs ( void )
+{
+   return CROMMapperNSF::NUMSONGS();
+}
+
+uint32_t nesGetNSFStartSong ( void )
+{
+   return CROMMapperNSF::STARTSONG();
+}
+
+uint8_t nesGetNSFExpansionChips ( void )
+{
+   return CROMMapperNSF::CHIPS();
+}
+
+bool nesNSFIsPAL ( void )
+{
+   return CROMMapperNSF::ISPAL();
+}
+
+void nesPlayNSFSong ( uint32_t song )
+{
+   CROMMapperNSF::SONG(song);
+   CNES::RESET(MAPPER_NSF,false);
+}
+
+uint32_t nesGetNSFInitCycles ( void )
+{
+   return CROMMapperNSF::INITCYCLES();
+}
+
+uint32_t nesGetNSFPlayCycles ( void )
+{
+   return CROMMapperNSF::PLAYCYCLES();
+}
+
+uint32_t nesGetNSFPlayCyclesMax ( void )
+{
+   return CROMMapperNSF::PLAYCYCLESMAX();
+}
+
+static void nesPutWAV16 ( uint8_t* buffer, uint16_t value )
+{
+   (*(buffer+0)) = value&0xFF;
+   (*(buffer+1)) = (value>>8)&0xFF;
+}
+
+static void nesPutWAV32 ( uint8_t* buffer, uint32_t value )
+{
+   nesPutWAV16(buffer,value&0xFFFF);
+   nesPutWAV16(buffer+2,value>>16);
+}
+
+static void nesWriteWAVHeader ( FILE* wav, uint32_t dataSize )
+{
+   uint8_t header [ 44 ];
+
+   // 16-bit mono PCM at the emulator core's audio output rate.
+   memcpy(header,"RIFF",4);
+   nesPutWAV32(header+4,36+dataSize);
+   memcpy(header+8,"WAVEfmt ",8);
+   nesPutWAV32(header+16,16);
+   nesPutWAV16(header+20,1);
+   nesPutWAV16(header+22,1);
+   nesPutWAV32(header+24,SDL_SAMPLE_RATE);
+   nesPutWAV32(header+28,SDL_SAMPLE_RATE*sizeof(uint16_t));
+   nesPutWAV16(header+32,sizeof(uint16_t));
+   nesPutWAV16(header+34,16);
+   memcpy(header+36,"data",4);
+   nesPutWAV32(header+40,dataSize);
+
+   fwrite(header,1,44,wav);
+}
+
+// The PPU always renders somewhere; give it a scratch TV if there's no UI.
+static bool nesStartHeadless ( void )
+{
+   bool scratchTV = false;
+
+   if ( !CPPU::TV() )
+   {
+      CPPU::TV(new int8_t[256*256*4]);
+      scratchTV = true;
+   }
+
+   return scratchTV;
+}
+
+static void nesStopHeadless ( bool scratchTV )
+{
+   if ( scratchTV )
+   {
+      delete [] CPPU::TV();
+      CPPU::TV(NULL);
+   }
+}
+
+// Starts a song without a UI in the tune's region.  The system mode that
+// was set before is returned in videoMode for nesStopHeadlessNSFSong() to
+// put back.
+static bool nesStartHeadlessNSFSong ( uint32_t song, int32_t* videoMode )
+{
+   bool scratchTV = nesStartHeadless();
+
+   (*videoMode) = CNES::VIDEOMODE();
+   CNES::VIDEOMODE(CROMMapperNSF::ISPAL()?MODE_PAL:MODE_NTSC);
+   nesPlayNSFSong(song);
+
+   return scratchTV;
+}
+
+static void nesStopHeadlessNSFSong ( bool scratchTV, int32_t videoMode )
+{
+   CNES::VIDEOMODE(videoMode);
+   nesStopHeadless(scratchTV);
+}
+
+bool nesRenderNSFSongToWAV ( const char* fileName, uint32_t song, uint32_t seconds )
+{
+   FILE*     wav;
+   uint32_t  joy [ NUM_CONTROLLERS ] = { 0, };
+   uint32_t  samples = seconds*SDL_SAMPLE_RATE;
+   uint32_t  written = 0;
+   uint32_t  count;
+   uint16_t* pSamples;
+   uint32_t  idx;
+   uint8_t   sample [ 2 ];
+   bool      scratchTV;
+   int32_t   videoMode;
+
+   if ( !CROMMapperNSF::NUMSONGS() )
+   {
+      return false;
+   }
+
+   wav = fopen(fileName,"wb");
+   if ( !wav )
+   {
+      return false;
+   }
+
+   // Placeholder header until the size of the data is known.
+   nesWriteWAVHeader(wav,0);
+
+   scratchTV = nesStartHeadlessNSFSong(song,&videoMode);
+
+   while ( written < samples )
+   {
+      CNES::RUN(joy);
+
+      // The APU's sample buffer must be consumed in whole chunks.
+      while ( (apuDataAvailable >= APU_SAMPLES) && (written < samples) )
+      {
+         pSamples = (uint16_t*)CAPU::PLAY(APU_SAMPLES);
+
+         count = samples-written;
+         if ( count > APU_SAMPLES )
+         {
+            count = APU_SAMPLES;
+         }
+         for ( idx = 0; idx < count; idx++ )
+         {
+            nesPutWAV16(sample,*(pSamples+idx));
+            fwrite(sample,1,2,wav);
+         }
+         written += count;
+      }
+   }
+
+   nesStopHeadlessNSFSong(scratchTV,videoMode);
+
+   rewind(wav);
+   nesWriteWAVHeader(wav,written*sizeof(uint16_t));
+   fclose(wav);
+
+   return true;
+}
+
+uint32_t nesProfileNSFSong ( uint32_t song, uint32_t* cycles, uint32_t calls )
+{
+   uint32_t joy [ NUM_CONTROLLERS ] = { 0, };
+   uint32_t frames = 0;
+   bool     scratchTV;
+   int32_t  videoMode;
+
+   if ( !CROMMapperNSF::NUMSONGS() )
+   {
+      return 0;
+   }
+
+   scratchTV = nesStartHeadlessNSFSong(song,&videoMode);
+   CROMMapperNSF::PLAYLOG(cycles,calls);
+
+   // A tune that stops calling PLAY [or hangs in INIT] mustn't stall
+   // the profile, so give up after a generous number of video frames.
+   while ( (CROMMapperNSF::PLAYLOGCOUNT() < calls) &&
+           (frames < (calls*2)+60) )
+   {
+      CNES::RUN(joy);
+      frames++;
+
+      // Nobody is listening; keep the APU's sample buffer drained.
+      while ( apuDataAvailable >= APU_SAMPLES )
+      {
+         CAPU::PLAY(APU_SAMPLES);
+      }
+   }
+
+   calls = CROMMapperNSF::PLAYLOGCOUNT();
+   CROMMapperNSF::PLAYLOG(NULL,0);
+   nesStopHeadlessNSFSong(scratchTV,videoMode);
+
+   return calls;
+}
+
+void nesRecordMovie ( uint32_t checksumInterval )
+{
+   CMovie::RECORD(checksumInterval);
+}
+
+bool nesSaveMovie ( const char* fileName )
+{
+   return CMovie::SAVE(fileName);
+}
+
+bool nesLoadMovie ( const char* fileName )
+{
+   return CMovie::LOAD(fileName);
+}
+
+bool nesPlayMovie ( void )
+{
+   return CMovie::PLAY();
+}
+
+void nesStopMovie ( void )
+{
+   CMovie::STOP();
+}
+
+bool nesIsMovieRecording ( void )
+{
+   return CMovie::RECORDING();
+}
+
+bool nesIsMoviePlaying ( void )
+{
+   return CMovie::PLAYING();
+}
+
+uint32_t nesGetMovieFrame ( void )
+{
+   return CMovie::FRAME();
+}
+
+uint32_t nesGetMovieLength ( void )
+{
+   return CMovie::FRAMES();
+}
+
+int32_t nesGetMovieDesyncFrame ( void )
+{
+   return CMovie::DESYNCFRAME();
+}
+
+int32_t nesVerifyMovie ( const char* fileName )
+{
+   uint32_t joy [ NUM_CONTROLLERS ] = { 0, };
+   int32_t  result;
+   bool     scratchTV;
+
+   if ( !CMovie::LOAD(fileName) )
+   {
+      return MOVIE_LOAD_FAILED;
+   }
+
+   scratchTV = nesStartHeadless();
+
+   if ( CMovie::PLAY() )
+   {
+      while ( CMovie::PLAYING() && (CMovie::DESYNCFRAME() == MOVIE_IN_SYNC) )
+      {
+         CNES::RUN(joy);
+
+         // Nobody is listening; keep the APU's sample buffer drained.
+         while ( apuDataAvailable >= APU_SAMPLES )
+         {
+            CAPU::PLAY(APU_SAMPLES);
+         }
+      }
+      result = CMovie::DESYNCFRAME();
+      CMovie::STOP();
+   }
+   else
+   {
+      result = MOVIE_WRONG_ROM;
+   }
+
+   nesStopHeadless(scratchTV);
+
+   return result;
+}
+
 uint32_t nesGetCPUCycle ( void )
 {
    return C6502::_CYCLES();
@@ -717,14 +1029,29 @@ void nesSetPPURegister ( uint32_t addr, uint32_t data )
    CPPU::_PPU(addr,data);
 }
 
-uint16_t nesGetScrollXAtXY ( int32_t x, int32_t y )
+uint8_t nesGetPPUNameTableData ( uint16_t addr )
+{
+   return CPPU::_NAMETABLE(addr);
+}
+
+uint8_t nesGetPPUPaletteData ( uint8_t addr )
+{
+   return CPPU::_PALETTE(addr);
+}
+
+uint32_t nesGetPPURegisterWriteCount ( void )
+{
+   return CPPU::_REGISTERWRITECOUNT();
+}
+
+void nesGetPPURegisterWrite ( uint32_t idx, PpuRegisterWrite* pWrite )
 {
-   return CPPU::_SCROLLX(x,y);
+   (*pWrite) = CPPU::_REGISTERWRITE(idx);
 }
 
-uint16_t nesGetScrollYAtXY ( int32_t x, int32_t y )
+void nesGetScanlineScroll ( uint16_t* x, uint16_t* y )
 {
-   return CPPU::_SCROLLY(x,y);
+   CPPU::SCANLINESCROLL(x,y);
 }
 
 void nesGetCurrentScroll ( uint8_t* x, uint8_t* y )
@@ -749,6 +1076,31 @@ void nesGetMirroring ( uint16_t* sc1, uint16_t* sc2, uint16_t* sc3, uint16_t* sc
    CPPU::_MIRROR(sc1,sc2,sc3,sc4);
 }
 
+uint32_t nesGetPPUWriteStamp ( void )
+{
+   return CPPU::_WRITESTAMP();
+}
+
+uint32_t nesGetPPUNameTableWriteStamp ( uint16_t addr )
+{
+   return CPPU::_NAMETABLEWRITESTAMP(addr);
+}
+
+uint32_t nesGetPPUPaletteWriteStamp ( void )
+{
+   return CPPU::_PALETTEWRITESTAMP();
+}
+
+uint32_t nesGetPPUOAMWriteStamp ( uint32_t sprite )
+{
+   return CPPU::_OAMWRITESTAMP(sprite);
+}
+
+uint32_t nesGetCHRMEMWriteStamp ( uint32_t addr )
+{
+   return CPPU::_CHRMEMWRITESTAMP(addr);
+}
+
 uint32_t nesGetAPUCycle ( void )
 {
    return CAPU::CYCLES();
@@ -792,6 +1144,13 @@ void nesGetAPUDACs ( uint8_t* sq1,
    CAPU::GETDACS(sq1,sq2,triangle,noise,dmc);
 }
 
+void nesGetAPUHistory ( int32_t channel,
+                        int16_t* samples,
+                        uint32_t count )
+{
+   CAPU::HISTORY(channel,samples,count);
+}
+
 void nesGetAPUDMCIRQ ( bool* enabled,
                        bool* asserted )
 {
@@ -911,6 +1270,11 @@ uint32_t nesGetPRGROMData ( uint32_t addr )
    return CROM::PRGROM(addr);
 }
 
+uint32_t nesGetPRGROMDataPhysical ( uint32_t addr )
+{
+   return CROM::PRGROMPHYS(addr);
+}
+
 uint32_t nesGetCHRMEMData ( uint32_t addr )
 {
    return CROM::CHRMEM(addr);
@@ -919,6 +1283,12 @@ uint32_t nesGetCHRMEMData ( uint32_t addr )
 void nesSetCHRMEMData ( uint32_t addr, uint32_t data )
 {
    CROM::CHRMEM(addr,data);
+   CPPU::CHRMEMWRITTEN(addr);
+}
+
+const uint8_t* nesGetCHRMEMTile ( uint32_t addr )
+{
+   return CROM::CHRTILE(addr);
 }
 
 uint32_t nesGetSRAMAbsoluteAddress ( uint32_t addr )
@@ -1103,7 +1473,6 @@ void nesGetCpuSnapshot(NESCpuStateSnapshot* pSnapshot)
 void nesGetPpuSnapshot(PpuStateSnapshot* pSnapshot)
 {
    int idx;
-   int x,y;
    pSnapshot->frame = CPPU::_FRAME();
    pSnapshot->cycle = CPPU::_CYCLES();
    for ( idx = 0; idx < NUM_PPU_REGS; idx++ )
@@ -1122,14 +1491,7 @@ void nesGetPpuSnapshot(PpuStateSnapshot* pSnapshot)
    {
       *(pSnapshot->memory+idx) = CPPU::_MEM(idx);
    }
-   for ( y = 0; y < 240; y++ )
-   {
-      for ( x = 0; x < 256; x++ )
-      {
-         *(*(pSnapshot->xOffset+x)+y) = CPPU::_SCROLLX(x,y);
-         *(*(pSnapshot->yOffset+x)+y) = CPPU::_SCROLLY(x,y);
-      }
-   }
+   CPPU::SCANLINESCROLL(pSnapshot->xScroll,pSnapshot->yScroll);
 }
 
 void nesGetApuSnapshot(ApuStateSnapshot* pSnapshot)
@@ -264,6 +264,9 @@ enum
 
 #define APU_BUFFER_PRERENDER           (APU_SAMPLES*2)   // How much rendering to do
 
+// Number of recent output samples the APU keeps for visualisers.
+#define APU_HISTORY_SIZE      (4096)
+
 #pragma pack(1)
 typedef struct
 {
@@ -283,6 +286,8 @@ typedef struct
 #define MASK_8B 0x7
 #define MEM_32B 0x20
 #define MASK_32B 0x1F
+#define MEM_64B 0x40
+#define MASK_64B 0x3F
 #define MEM_256B 0x100
 #define MASK_256B 0xFF
 #define MEM_512B 0x200
@@ -512,6 +517,61 @@ void nesSetControllerScreenPosition ( int32_t port, int32_t px, int32_t py, int3
 void nesSetControllerSpecial ( int32_t port, int32_t special );
 bool nesROMIsLoaded ( void );
 
+// NSF player interfaces.
+// An NSF or NSFe file is loaded in place of a cartridge by using nesLoadNSF().
+// A song [zero-based] is started by using nesPlayNSFSong(), after which the
+// emulator core is run by using nesRun() as usual.  VRC6, MMC5 and N163
+// expansion audio is played; nesGetNSFExpansionChips() returns the header's
+// chip flags so the UI can warn about others.  The CPU cycles spent in the
+// tune's INIT and PLAY routines are available for driver profiling.
+// nesRenderNSFSongToWAV() plays a song without a UI, switching the system
+// mode to the tune's region while it plays and writing the audio output to
+// a WAV file.
+// nesProfileNSFSong() likewise plays a song without a UI, storing the CPU
+// cycles spent in each of the first calls to PLAY; it returns the number
+// of calls that were made.
+bool nesLoadNSF ( uint8_t* data, uint32_t size );
+uint32_t nesGetNSFNumSongs ( void );
+uint32_t nesGetNSFStartSong ( void );
+uint8_t nesGetNSFExpansionChips ( void );
+bool nesNSFIsPAL ( void );
+void nesPlayNSFSong ( uint32_t song );
+uint32_t nesGetNSFInitCycles ( void );
+uint32_t nesGetNSFPlayCycles ( void );
+uint32_t nesGetNSFPlayCyclesMax ( void );
+bool nesRenderNSFSongToWAV ( const char* fileName, uint32_t song, uint32_t seconds );
+uint32_t nesProfileNSFSong ( uint32_t song, uint32_t* cycles, uint32_t calls );
+
+// Input movie interfaces.
+// A movie holds the controller input for each frame from power-on, the SHA-1
+// of the ROM it was recorded with, and checksums of the machine state taken
+// every checksum interval frames [see cnesmovie.h for the file format].
+// nesRecordMovie() and nesPlayMovie() power the system on with the loaded ROM
+// and then record, or replace, the input given to nesRun() until the movie is
+// stopped or playback reaches its end.  nesPlayMovie() plays the movie last
+// loaded with nesLoadMovie() and fails if the loaded ROM isn't the one it was
+// recorded with.  Playback uses the system mode and controllers the movie
+// was recorded with; nesStopMovie() puts back the ones set before it.
+// nesGetMovieDesyncFrame() returns the first frame at which
+// the machine state didn't match the recording, or MOVIE_IN_SYNC.
+// nesVerifyMovie() plays a movie without a UI as fast as possible, stopping
+// at the first desync; it returns the frame the desync was found at or one
+// of the MOVIE_ codes.
+#define MOVIE_IN_SYNC     -1
+#define MOVIE_LOAD_FAILED -2
+#define MOVIE_WRONG_ROM   -3
+void nesRecordMovie ( uint32_t checksumInterval );
+bool nesSaveMovie ( const char* fileName );
+bool nesLoadMovie ( const char* fileName );
+bool nesPlayMovie ( void );
+void nesStopMovie ( void );
+bool nesIsMovieRecording ( void );
+bool nesIsMoviePlaying ( void );
+uint32_t nesGetMovieFrame ( void );
+uint32_t nesGetMovieLength ( void );
+int32_t nesGetMovieDesyncFrame ( void );
+int32_t nesVerifyMovie ( const char* fileName );
+
 // Internal debug interfaces.
 extern bool __nesdebug;
 #define nesIsDebuggable() ( __nesdebug )
@@ -610,6 +670,27 @@ void nesSetCPUFlagInterrupt ( uint32_t set );
 void nesSetCPUFlagZero ( uint32_t set );
 void nesSetCPUFlagCarry ( uint32_t set );
 
+// A write to one of the PPU registers that control rendering, $2000, $2001,
+// $2005 or $2006, as kept in the PPU's register timeline.  The timeline holds
+// the writes made since the start of the current PPU frame, up to
+// PPU_REGISTER_TIMELINE_SIZE of them.  Scanline and cycle are in the PPU
+// frame, which starts at the first visible scanline.  The PPU address, its
+// latch and the fine X scroll are those left by the write, and pc is the
+// address of the instruction that made it.
+#define PPU_REGISTER_TIMELINE_SIZE 1024
+
+typedef struct
+{
+   uint16_t scanline;
+   uint16_t cycle;
+   uint16_t addr;
+   uint8_t  data;
+   uint8_t  fineX;
+   uint16_t pc;
+   uint16_t ppuAddr;
+   uint16_t ppuAddrLatch;
+} PpuRegisterWrite;
+
 // PPU debug interfaces.
 uint32_t nesGetPPUMemory ( uint32_t addr );
 void nesSetPPUMemory ( uint32_t addr, uint32_t data );
@@ -628,13 +709,26 @@ uint8_t nesGetPPUPatternData ( uint16_t addr );
 uint8_t nesGetPPUPaletteData ( uint8_t addr );
 uint32_t nesGetPPUOAM ( uint32_t addr );
 void nesSetPPUOAM ( uint32_t addr, uint32_t data );
-uint16_t nesGetScrollXAtXY ( int32_t x, int32_t y );
-uint16_t nesGetScrollYAtXY ( int32_t x, int32_t y );
+uint32_t nesGetPPURegisterWriteCount ( void );
+void nesGetPPURegisterWrite ( uint32_t idx, PpuRegisterWrite* pWrite );
+// Works out from the register timeline the scroll position each visible
+// scanline was drawn from, 0-511 across and 0-479 down the four nametables.
+void nesGetScanlineScroll ( uint16_t* x, uint16_t* y );
 void nesGetLastSprite0Hit ( uint8_t* x, uint8_t* y );
 void nesGetCurrentPixel ( uint8_t* x, uint8_t* y );
 void nesGetCurrentScroll ( uint8_t* x, uint8_t* y );
 void nesGetMirroring ( uint16_t* sc1, uint16_t* sc2, uint16_t* sc3, uint16_t* sc4 );
 
+// Write stamps for redrawing only what changed in the PPU's memories.  Every
+// write takes the next value of nesGetPPUWriteStamp(); the others return the
+// stamp of the last write to a nametable byte, the palette, a sprite, or the
+// CHR tile containing a PPU address.
+uint32_t nesGetPPUWriteStamp ( void );
+uint32_t nesGetPPUNameTableWriteStamp ( uint16_t addr );
+uint32_t nesGetPPUPaletteWriteStamp ( void );
+uint32_t nesGetPPUOAMWriteStamp ( uint32_t sprite );
+uint32_t nesGetCHRMEMWriteStamp ( uint32_t addr );
+
 // APU debug interfaces.
 uint32_t nesGetAPUCycle ( void );
 uint32_t nesGetAPURegister ( uint32_t addr );
@@ -658,6 +752,12 @@ void nesGetAPUDMCSampleInfo ( uint16_t* addr,
                               uint16_t* pos );
 void nesGetAPUDMCDMAInfo ( uint8_t* buffer,
                            bool* full );
+// Retrieves the most recent count [up to APU_HISTORY_SIZE] samples, oldest
+// first, at the audio sample rate.  Channels 0-4 are the DAC outputs in the
+// order of nesGetAPUDACs; channel NUM_APU_CHANNELS is the mixed output.
+void nesGetAPUHistory ( int32_t channel,
+                        int16_t* samples,
+                        uint32_t count );
 
 // Cartridge debug interfaces.
 uint32_t nesGetNumPRGROMBanks ( void );
@@ -672,8 +772,10 @@ void nesMapperHighWrite ( uint32_t addr, uint32_t data );
 uint32_t nesGetPRGROMAbsoluteAddress ( uint32_t addr );
 uint32_t nesGetCHRMEMAbsoluteAddress ( uint32_t addr );
 uint32_t nesGetPRGROMData ( uint32_t addr );
+uint32_t nesGetPRGROMDataPhysical ( uint32_t addr );
 uint32_t nesGetCHRMEMData ( uint32_t addr );
 void nesSetCHRMEMData ( uint32_t addr, uint32_t data );
+const uint8_t* nesGetCHRMEMTile ( uint32_t addr );
 uint32_t nesGetSRAMAbsoluteAddress ( uint32_t addr );
 uint32_t nesGetSRAMDataVirtual ( uint32_t addr );
 void nesSetSRAMDataVirtual ( uint32_t addr, uint32_t data );
@@ -710,8 +812,8 @@ typedef struct
    uint8_t oamMemory[MEM_256B];
    uint8_t paletteMemory[MEM_32B];
    uint8_t reg[NUM_PPU_REGS];
-   uint16_t xOffset[256][240];
-   uint16_t yOffset[256][240];
+   uint16_t xScroll[SCANLINES_VISIBLE];
+   uint16_t yScroll[SCANLINES_VISIBLE];
 } PpuStateSnapshot;
 
 void nesGetPpuSnapshot(PpuStateSnapshot* pSnapshot);